@@ -2,81 +2,53 @@
 //     through, each of the 4 propulsion motors and electronic speed controllers (ESCs).  
 // The Micro acts as an I2C slave (with slave address 08), and it reports 16 signed byte values
 //     (4 RPMs, 4 currents, and 8 temperatures) over I2C, which each correspond to the most 
-//     recent measurements, when info is requested by the Mega 2560 I2C master.
+//     recent measurements, when info is requested by the Mega 2560 I2C master.  Each complete set
+//     of measurements is published as a snapshot, with a sequence number, and the Mega can select
+//     which block of it to read, which comes with its age and a CRC (see ALTAIR_MicroRegisterMap.h).
+// Each snapshot also has the same measurements as 16-bit values (RPMs in RPM, currents in 10 mA, and temps in
+//     0.1 degrees C), which do not saturate as the packed bytes do, for a Mega that asks for them.
 
 #include <Wire.h>
+#include <ALTAIR_MicroRegisterMap.h>
+#include "ALTAIR_RPMCapture.h"
+#include "ALTAIR_Filters.h"
 
-// Pulse timing for measuring the 4 RPMs.
+// Pulse timing for measuring the 4 RPMs.  The 4 RPM pins are sampled together by the Timer1 compare interrupt
+//     (at RPM_SAMPLE_RATE), and the edges are timestamped into a ring buffer per motor, so that the RPMs can
+//     be computed at any time, without waiting for the pulse trains (see ALTAIR_RPMCapture.h).
 const int     rpmTimerPin[4]            =     {  5,  7, 11, 13 };
 const int     usbInputCheckPin          =       14;                // Pin 14 is actually the MISO pin on the Arduino Micro (see below)
-const int     numRPMPulsesToAverage     =       20;
-const long    numMicrosBeforeRPMTimeout =  1000000;
-const long    numMicrosPerMinute        = 60000000;
-const int     numMicrosDelayBtwReads    =       20;
-const int     numPulsesPerRevolution    =        4;
+ALTAIR_RPMCapture  rpmCapture;
+volatile uint8_t*  rpmPinInputRegister[4];                         // (read directly from the interrupt, as digitalRead() is too slow there)
+uint8_t            rpmPinBitMask[4];
 byte          packedRPM[4];
+uint16_t      extendedRPM[4];
 
 const int     currentSensorPin[4]       =     { A0, A1, A2, A3 };
 int           currentSensorValue[4];
+const int     currentSensorZeroValue    =      505;                // the ADC reading at 0 amps
+const int     currentSensorTenthsPerAmp =       33;                // i.e. 3.3 ADC counts per amp
 const int     numCurrentValsToAverage   =       20;
-float         currentInAmps[4][numCurrentValsToAverage];  // average the past 20 values
+ALTAIR_MovingAverage<int16_t, numCurrentValsToAverage>  currentFilter[4];  // average the past 20 values (of currentSensorZeroValue - the reading)
 byte          packedCurrent[4];
+int16_t       extendedCurrent[4];                                  // in units of 10 mA
 
 const int     tempSensorPin[8]          =     { A4, A5, A6, A7,    A8, A9, A10, A11  };
 int           tempSensorValue[8];
 float         tempInCelsius[8];
 byte          packedTemp[8];
+int16_t       extendedTemp[8];                                     // in units of 0.1 degrees C
 
+ALTAIR_MicroRegisterMap  registerMap;                              // what the Mega reads over I2C
 
-// get truncated (i.e. robust) mean of the pulse durations
-float averageNumMicrosPerPulse(long *rpmPulseDuration) {
-  long longestPulse = -999, secondLongestPulse = -999, shortestPulse = -999, secondShortestPulse = -999;
-  long truncatedSumOfPulseDurations, sumOfPulseDurations = 0;
-  for (int i = 0; i < numRPMPulsesToAverage; ++i) {
-     sumOfPulseDurations += abs(rpmPulseDuration[i]);
-     if (abs(rpmPulseDuration[i]) > longestPulse) {
-       secondLongestPulse = longestPulse;
-       longestPulse = abs(rpmPulseDuration[i]);
-     }
-     if (abs(rpmPulseDuration[i]) < shortestPulse || shortestPulse == -999) {
-       secondShortestPulse = shortestPulse;
-       shortestPulse = abs(rpmPulseDuration[i]);
-     }
-  }
-  truncatedSumOfPulseDurations = sumOfPulseDurations - longestPulse - secondLongestPulse - shortestPulse - secondShortestPulse;
-  return truncatedSumOfPulseDurations / (numRPMPulsesToAverage - 4.);
-}
 
-float getRPM(int pinNumber) {
-  byte presentReading = digitalRead(pinNumber);
-  unsigned long initialTime = micros();
-  unsigned long previousTime = initialTime;
-  unsigned long presentTime = initialTime;
-  long rpmPulseDuration[numRPMPulsesToAverage];
-  for (int i = 0; i < numRPMPulsesToAverage; ++i) {
-    int j = 0;
-// only consider the pulse to have ended if three digitalReads in a row differ from presentReading
-    while (1) {
-      if (digitalRead(pinNumber) != presentReading) {
-        delayMicroseconds(numMicrosDelayBtwReads);
-        if (digitalRead(pinNumber) != presentReading) {
-          delayMicroseconds(numMicrosDelayBtwReads);
-          if (digitalRead(pinNumber) != presentReading) {
-            break;
-          }
-        }
-      }
-      ++j;
-      if (j%10000 == 0) presentTime = micros();
-      if (presentTime - initialTime > numMicrosBeforeRPMTimeout) return 0.0;
-    }
-    presentTime = micros();
-    rpmPulseDuration[i] = presentTime - previousTime;
-    if (presentReading == HIGH) rpmPulseDuration[i] = -rpmPulseDuration[i];
-    previousTime = presentTime;
-    presentReading = !presentReading;
+// sample all 4 RPM pins, every 40 microseconds
+ISR(TIMER1_COMPA_vect) {
+  uint8_t levels = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    if (*rpmPinInputRegister[i] & rpmPinBitMask[i]) levels |= (1 << i);
   }
-  return numMicrosPerMinute/(numPulsesPerRevolution*averageNumMicrosPerPulse(rpmPulseDuration)); 
+  rpmCapture.sample(levels);
 }
 
 byte packRPM(float theRPM) {
@@ -109,62 +81,80 @@ byte packTemp(float theTemp) {
   return thePackedTemp;
 }
 
-byte packCurrent(float theCurrent) {
-  float scaledCurrent = theCurrent*4.;
-  byte packCurr;
-  if (scaledCurrent >= 0. && scaledCurrent < 127.) {
-    packCurr = scaledCurrent;
-  } else if (scaledCurrent >= -128. && scaledCurrent < 0.) {
-    packCurr = scaledCurrent + 256.;
-  } else if (scaledCurrent >= 127.) {
-    packCurr = 127;
-  } else {
-    packCurr = 128;
-  }
-  return packCurr;
+// pack the sum of the past numCurrentValsToAverage (currentSensorZeroValue - reading)s into quarter-amps,
+//     i.e. floor(4 x the average current), with integer math only
+byte packCurrentSum(long sumOfValues) {
+  long numerator   = sumOfValues * 4 * 10;
+  long denominator = (long) numCurrentValsToAverage * currentSensorTenthsPerAmp;
+  long quarterAmps = (numerator >= 0) ? numerator / denominator : -((denominator - 1 - numerator) / denominator);
+  if (quarterAmps > 127)  return 127;
+  if (quarterAmps < -128) return 128;
+  return (byte) quarterAmps;
+}
+
+// the same, in units of 10 mA (rounded to the nearest), for the extended block
+int16_t extendedCurrentSum(long sumOfValues) {
+  long numerator   = sumOfValues * 100 * 10;
+  long denominator = (long) numCurrentValsToAverage * currentSensorTenthsPerAmp;
+  long centiAmps   = (numerator >= 0) ? (numerator + denominator/2) / denominator : -((denominator/2 - numerator) / denominator);
+  if (centiAmps > 32767)  return 32767;
+  if (centiAmps < -32768) return -32768;
+  return (int16_t) centiAmps;
+}
+
+uint16_t extendedRPMValue(double theRPM) {
+  if (theRPM <= 0.)      return 0;
+  if (theRPM >= 65535.)  return 65535;
+  return (uint16_t) (theRPM + 0.5);
 }
 
 void setup() {
   Wire.begin(8);
   Wire.onRequest(sendInfo);
+  Wire.onReceive(receiveRegister);
   
   Serial.begin(9600);
  
-  for (int i = 0; i < 4; ++i) {
-    for (int j = 0; j < numCurrentValsToAverage; ++j) currentInAmps[i][j] = 0.;
-  }
   // Initialize digital RPM timer pins as input.  (Note that the analog-read pins don't require this initialization.)
   for (int i = 0; i < 4; ++i) {
     pinMode(rpmTimerPin[i], INPUT);
+    rpmPinInputRegister[i] = portInputRegister(digitalPinToPort(rpmTimerPin[i]));
+    rpmPinBitMask[i]       = digitalPinToBitMask(rpmTimerPin[i]);
   }
+  // Start Timer1 in CTC mode (WGM12), with no prescaling, to interrupt at RPM_SAMPLE_RATE.
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS10);
+  TCNT1  = 0;
+  OCR1A  = F_CPU / RPM_SAMPLE_RATE - 1;
+  TIMSK1 = _BV(OCIE1A);
+  interrupts();
   // Initialize special SPI MISO pin = 14 as an input (to see if device has its USB port plugged in)
   pinMode(usbInputCheckPin, INPUT);
 }
 
 void loop() {
   double rpm[4] = { 0., 0., 0., 0. };
-  float  currentRunningAverage[4] = { 0., 0., 0., 0. };
+  float  currentRunningAverage[4];
 
   for (int i = 0; i < 4; ++i) {
     currentSensorValue[i] = analogRead(currentSensorPin[i]);
-    for (int j = 0; j < numCurrentValsToAverage - 1; ++j) {
-      currentRunningAverage[i] += currentInAmps[i][j+1];
-      currentInAmps[i][j] = currentInAmps[i][j+1];
-    }
-    currentInAmps[i][numCurrentValsToAverage-1] = (505-currentSensorValue[i])/3.3;
-    currentRunningAverage[i] += currentInAmps[i][numCurrentValsToAverage-1];
-    currentRunningAverage[i] /= numCurrentValsToAverage;
-    packedCurrent[i] = packCurrent(currentRunningAverage[i]);
+    currentFilter[i].update(currentSensorZeroValue - currentSensorValue[i]);
+    packedCurrent[i] = packCurrentSum(currentFilter[i].sum());
+    extendedCurrent[i] = extendedCurrentSum(currentFilter[i].sum());
   }
   for (int i = 0; i < 8; ++i) {
     tempSensorValue[i] = analogRead(tempSensorPin[i]);
     tempInCelsius[i] = 22 + (tempSensorValue[i]-535)/2.;
     packedTemp[i] = packTemp(tempInCelsius[i]);
+    extendedTemp[i] = 220 + (tempSensorValue[i]-535)*5;           // (exactly tempInCelsius, in tenths)
   }
   for (int i = 0; i < 4; ++i) {
-    rpm[i] = getRPM(rpmTimerPin[i]);
+    rpm[i] = rpmCapture.rpm(i);
     packedRPM[i] = packRPM(rpm[i]);
+    extendedRPM[i] = extendedRPMValue(rpm[i]);
   }
+  registerMap.publish(packedRPM, packedCurrent, packedTemp, extendedRPM, extendedCurrent, extendedTemp, millis());
 
 
   if (digitalRead(usbInputCheckPin) == HIGH) {      // i.e., if the USB port is actually connected.
@@ -172,6 +162,8 @@ void loop() {
                                                     // (see e.g. https://forum.arduino.cc/index.php?topic=337715.0 ).
                                                     // I have connected this to the MF-MSMF050-2 fuse (VUSB) on the bottom of the board.
  
+        for (int i = 0; i < 4; ++i) currentRunningAverage[i] = currentFilter[i].sum() * 10. / (numCurrentValsToAverage * currentSensorTenthsPerAmp);
+
         Serial.print(currentSensorValue[0]); Serial.print(" "); 
         Serial.print(currentSensorValue[1]); Serial.print(" "); 
         Serial.print(currentSensorValue[2]); Serial.print(" "); 
@@ -212,8 +204,12 @@ void loop() {
 }
 
 void sendInfo() {
-  for (int i = 0; i < 4; ++i) Wire.write(packedRPM[i]);
-  for (int i = 0; i < 4; ++i) Wire.write(packedCurrent[i]);
-  for (int i = 0; i < 8; ++i) Wire.write(packedTemp[i]);  
+  byte response[MICRO_REGMAP_MAX_RESPONSE];
+  Wire.write(response, registerMap.respond(response, millis()));
+}
+
+void receiveRegister(int numBytes) {
+  if (Wire.available()) registerMap.select(Wire.read());
+  while (Wire.available()) Wire.read();
 }
 
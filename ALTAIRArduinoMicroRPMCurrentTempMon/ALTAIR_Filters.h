@@ -0,0 +1,117 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_Filters.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    These are small, integer-only filters for the Arduino Micro's ADC
+    readings (e.g. the 4 ESC current sensors), each one a template with its
+    length fixed at compile time, so that there is no float math and no
+    dynamic allocation.
+
+      ALTAIR_MovingAverage  the mean of the last WINDOW values, kept as a
+                            running sum over a circular buffer, so that an
+                            update is O(1) (one add, one subtract, one store)
+      ALTAIR_ExpAverage     an exponential moving average, with a smoothing
+                            factor of 1/2^SHIFT, kept in fixed point
+      ALTAIR_MedianFilter   the median of the last WINDOW values, for
+                            rejecting single-sample spikes (O(WINDOW) per
+                            update, so meant for short windows, e.g. 3 or 5)
+
+    As with the previous float arrays, the filters start out full of 0s.
+
+    This file does not depend upon the Arduino libraries, so that the
+    filters can also be run on a host computer (see
+    tools/ALTAIRCurrentFilterBench.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_Filters_h
+#define   ALTAIR_Filters_h
+
+#include  <stdint.h>
+
+/**************************************************************************/
+/*!
+    The mean of the last WINDOW values.  SUM_T must hold WINDOW times the
+    largest value (e.g. int32_t for 10-bit ADC readings).
+*/
+/**************************************************************************/
+template < typename T , uint8_t WINDOW , typename SUM_T = int32_t >
+class ALTAIR_MovingAverage {
+  public:
+    ALTAIR_MovingAverage() : _sum(0), _index(0) { for (uint8_t i = 0; i < WINDOW; ++i) _values[i] = 0; }
+
+    void     update(  T      value  ) {
+        _sum            += (SUM_T) value - _values[_index];
+        _values[_index]  = value;
+        if (++_index == WINDOW) _index = 0;
+    }
+    SUM_T    sum(                   ) const { return _sum                        ; }   // (exact, for scaling without rounding twice)
+    T        average(               ) const { return (T) (_sum / WINDOW)         ; }   // (truncated towards 0)
+    T        newest(                ) const { return _values[(_index == 0) ? WINDOW - 1 : _index - 1] ; }
+    enum   { window = WINDOW };
+
+  private:
+    T        _values[WINDOW]                                                     ;
+    SUM_T    _sum                                                                ;
+    uint8_t  _index                                                              ;  // where the next value goes (i.e. the oldest)
+};
+
+/**************************************************************************/
+/*!
+    An exponential moving average: each update moves the average 1/2^SHIFT
+    of the way to the new value.  The average is kept with SHIFT extra
+    fraction bits, so small changes are not lost to truncation.
+*/
+/**************************************************************************/
+template < typename T , uint8_t SHIFT , typename SUM_T = int32_t >
+class ALTAIR_ExpAverage {
+  public:
+    ALTAIR_ExpAverage() : _scaled(0) { }
+
+    void     update(  T      value  ) { _scaled += (SUM_T) value - (_scaled >> SHIFT)  ; }
+    SUM_T    scaled(                ) const { return _scaled                     ; }   // i.e. the average times 2^SHIFT
+    T        average(               ) const { return (T) (_scaled >> SHIFT)      ; }   // (rounded down)
+
+  private:
+    SUM_T    _scaled                                                             ;
+};
+
+/**************************************************************************/
+/*!
+    The median of the last WINDOW values (WINDOW should be odd).  A sorted
+    copy of the window is kept up to date by moving just the values between
+    the oldest one's slot and the new one's.
+*/
+/**************************************************************************/
+template < typename T , uint8_t WINDOW >
+class ALTAIR_MedianFilter {
+  public:
+    ALTAIR_MedianFilter() : _index(0) { for (uint8_t i = 0; i < WINDOW; ++i) _values[i] = _sorted[i] = 0; }
+
+    void     update(  T      value  ) {
+        T        oldest = _values[_index];
+        uint8_t  slot   = 0;
+        while (_sorted[slot] != oldest) ++slot;                                 // (it must be there)
+        while (slot > 0          && _sorted[slot - 1] > value) { _sorted[slot] = _sorted[slot - 1]; --slot; }
+        while (slot < WINDOW - 1 && _sorted[slot + 1] < value) { _sorted[slot] = _sorted[slot + 1]; ++slot; }
+        _sorted[slot]   = value;
+        _values[_index] = value;
+        if (++_index == WINDOW) _index = 0;
+    }
+    T        median(                ) const { return _sorted[WINDOW / 2]         ; }
+
+  private:
+    T        _values[WINDOW]                                                     ;  // in arrival order
+    T        _sorted[WINDOW]                                                     ;
+    uint8_t  _index                                                              ;
+};
+
+#endif    //   ifndef ALTAIR_Filters_h
@@ -0,0 +1,178 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_RPMCapture.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the Arduino Micro's capture of the 4 propulsion
+    motors' RPM pulse trains.  All 4 RPM pins are sampled together, from
+    a timer interrupt (at RPM_SAMPLE_RATE), so no pulse train is ever
+    waited for.  A level change only counts as an edge once it has been
+    seen in RPM_DEBOUNCE_SAMPLES samples in a row (as before, with the 3
+    digitalReads in a row), and each edge is then timestamped (with the
+    time of the first of those samples) into a ring buffer per motor.
+    The RPMs are computed from the ring buffers whenever they are wanted,
+    with the same truncated (i.e. robust) mean of the times between edges
+    as before.
+
+    (Timer sampling is used, rather than pin-change or input-capture
+    interrupts, because the 4 RPM pins on the Micro are on 4 different
+    kinds of interrupt, and one of them, pin 5 = PC6, has none at all.)
+
+    This file does not depend upon the Arduino libraries, so that the
+    capture can also be simulated on a host computer (see
+    tools/ALTAIRRPMCaptureSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_RPMCapture_h
+#define   ALTAIR_RPMCapture_h
+
+#include  <stdint.h>
+
+#ifdef    ARDUINO
+#include  <avr/io.h>
+#include  <avr/interrupt.h>
+#define   RPM_CAPTURE_ATOMIC_BEGIN    uint8_t savedSREG = SREG; cli();
+#define   RPM_CAPTURE_ATOMIC_END      SREG = savedSREG;
+#else
+#define   RPM_CAPTURE_ATOMIC_BEGIN
+#define   RPM_CAPTURE_ATOMIC_END
+#endif
+
+#define   RPM_NUM_MOTORS                 4
+#define   RPM_SAMPLE_RATE            25000          // in Hz, i.e. a sample every 40 microseconds
+#define   RPM_MICROS_PER_SAMPLE         (1000000L / RPM_SAMPLE_RATE)
+#define   RPM_DEBOUNCE_SAMPLES           3
+#define   RPM_EDGE_INTERVALS_TO_AVERAGE 20          // (the last 20 times between edges, i.e. 21 edges)
+#define   RPM_EDGE_INTERVALS_TO_TRIM     2          // from each end, i.e. the 2 longest and the 2 shortest
+#define   RPM_MIN_EDGE_INTERVALS         6          // fewer than this (since a timeout) reads as 0 RPM
+#define   RPM_TIMEOUT_MICROS       1000000L         // no edge for this long reads as 0 RPM (and restarts the averaging)
+#define   RPM_EDGES_PER_REVOLUTION       4
+#define   RPM_MICROS_PER_MINUTE   60000000.
+
+class ALTAIR_RPMCapture {
+  public:
+    ALTAIR_RPMCapture(                                                        ) ;
+
+    void      sample(        uint8_t        levels                            ) ;   // From the timer interrupt: bit i is the level of motor i's pin.
+    float     rpm(           uint8_t        motor                             ) ;   // Compute motor's present RPM (from the main loop).
+    uint8_t   edgeCount(     uint8_t        motor                             ) ;   // # of edges since the last timeout
+
+  private:
+    volatile uint32_t  _tick                                                    ;  // # of samples so far
+    volatile uint8_t   _levels                                                  ;  // the debounced levels
+    uint8_t            _pendingCount[RPM_NUM_MOTORS]                            ;  // # of samples in a row that differ from the debounced level
+    uint32_t           _pendingTick[RPM_NUM_MOTORS]                             ;  // the first of them
+    volatile uint32_t  _edgeTick[RPM_NUM_MOTORS][RPM_EDGE_INTERVALS_TO_AVERAGE + 1] ;  // a ring buffer of the most recent edges
+    volatile uint8_t   _edgeHead[RPM_NUM_MOTORS]                                ;  // where the next edge goes
+    volatile uint8_t   _edgeCount[RPM_NUM_MOTORS]                               ;
+};
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+inline ALTAIR_RPMCapture::ALTAIR_RPMCapture() : _tick(0), _levels(0)
+{
+    for (uint8_t m = 0; m < RPM_NUM_MOTORS; ++m) _pendingCount[m] = _edgeHead[m] = _edgeCount[m] = 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Take one sample of all 4 pins.  This is called from the timer
+         interrupt, so it is kept short: with no pin changing, it is just
+         an increment and a compare.
+*/
+/**************************************************************************/
+inline void ALTAIR_RPMCapture::sample( uint8_t levels )
+{
+    uint32_t tick    = ++_tick;
+    uint8_t  changed = (levels ^ _levels) & ((1 << RPM_NUM_MOTORS) - 1);
+    for (uint8_t m = 0; m < RPM_NUM_MOTORS; ++m) {
+        if (!(changed & (1 << m))) {
+            _pendingCount[m] = 0;                                        // (a glitch, which did not last)
+            continue;
+        }
+        if (_pendingCount[m]++ == 0) _pendingTick[m] = tick;
+        if (_pendingCount[m] < RPM_DEBOUNCE_SAMPLES) continue;
+
+        _levels          ^= (1 << m);
+        _pendingCount[m]  = 0;
+        uint8_t  head     = _edgeHead[m];
+        uint8_t  previous = (head == 0) ? RPM_EDGE_INTERVALS_TO_AVERAGE : head - 1;
+        if (_edgeCount[m] > 0 && (_pendingTick[m] - _edgeTick[m][previous]) > RPM_TIMEOUT_MICROS / RPM_MICROS_PER_SAMPLE) {
+            _edgeCount[m] = 0;                                           // (the motor had stopped: start averaging over)
+        }
+        _edgeTick[m][head] = _pendingTick[m];
+        _edgeHead[m]       = (head == RPM_EDGE_INTERVALS_TO_AVERAGE) ? 0 : head + 1;
+        if (_edgeCount[m] <= RPM_EDGE_INTERVALS_TO_AVERAGE) ++_edgeCount[m];
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Compute a motor's RPM from its most recent edges: the mean time
+         between edges, less the RPM_EDGE_INTERVALS_TO_TRIM longest and
+         shortest, as in averageNumMicrosPerPulse().  The edges are copied
+         out with interrupts off (which takes only a few microseconds).
+*/
+/**************************************************************************/
+inline float ALTAIR_RPMCapture::rpm( uint8_t motor )
+{
+    uint32_t edges[RPM_EDGE_INTERVALS_TO_AVERAGE + 1];
+    uint8_t  count, head;
+    uint32_t now;
+    RPM_CAPTURE_ATOMIC_BEGIN
+    now   = _tick;
+    count = _edgeCount[motor];
+    head  = _edgeHead[motor];
+    for (uint8_t i = 0; i <= RPM_EDGE_INTERVALS_TO_AVERAGE; ++i) edges[i] = _edgeTick[motor][i];
+    RPM_CAPTURE_ATOMIC_END
+
+    if (count < RPM_MIN_EDGE_INTERVALS + 1) return 0.;
+    uint8_t newest = (head == 0) ? RPM_EDGE_INTERVALS_TO_AVERAGE : head - 1;
+    if (now - edges[newest] > RPM_TIMEOUT_MICROS / RPM_MICROS_PER_SAMPLE) return 0.;
+
+    uint8_t  intervals = count - 1;
+    uint8_t  trim      = (intervals >= RPM_MIN_EDGE_INTERVALS + 2*RPM_EDGE_INTERVALS_TO_TRIM) ? RPM_EDGE_INTERVALS_TO_TRIM : 0;
+    uint32_t longest[RPM_EDGE_INTERVALS_TO_TRIM + 1]  = { 0 };           // (sorted, longest first; the extra is scratch)
+    uint32_t shortest[RPM_EDGE_INTERVALS_TO_TRIM + 1];                   // (sorted, shortest first)
+    for (uint8_t t = 0; t <= RPM_EDGE_INTERVALS_TO_TRIM; ++t) shortest[t] = 0xFFFFFFFF;
+    uint32_t sum       = 0;
+    uint8_t  index     = newest;
+    for (uint8_t i = 0; i < intervals; ++i) {
+        uint8_t  earlier  = (index == 0) ? RPM_EDGE_INTERVALS_TO_AVERAGE : index - 1;
+        uint32_t interval = edges[index] - edges[earlier];
+        sum += interval;
+        for (uint8_t t = 0; t < trim; ++t) {
+            if (interval > longest[t]) { for (uint8_t u = trim - 1; u > t; --u) longest[u] = longest[u-1]; longest[t] = interval; break; }
+        }
+        for (uint8_t t = 0; t < trim; ++t) {
+            if (interval < shortest[t]) { for (uint8_t u = trim - 1; u > t; --u) shortest[u] = shortest[u-1]; shortest[t] = interval; break; }
+        }
+        index = earlier;
+    }
+    for (uint8_t t = 0; t < trim; ++t) sum -= longest[t] + shortest[t];
+    float meanMicros = (float) sum * RPM_MICROS_PER_SAMPLE / (intervals - 2*trim);
+    return RPM_MICROS_PER_MINUTE / (RPM_EDGES_PER_REVOLUTION * meanMicros);
+}
+
+/**************************************************************************/
+/*!
+ @brief  The # of edges in the ring buffer (i.e. since the last timeout).
+*/
+/**************************************************************************/
+inline uint8_t ALTAIR_RPMCapture::edgeCount( uint8_t motor )
+{
+    return _edgeCount[motor];
+}
+
+#endif    //   ifndef ALTAIR_RPMCapture_h
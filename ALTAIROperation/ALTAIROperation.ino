@@ -2,121 +2,198 @@
 #include <ALTAIR_GlobalMotorControl.h>
 #include <ALTAIR_GlobalDeviceControl.h>
 #include <ALTAIR_GlobalLightControl.h>
+#include <ALTAIR_TaskScheduler.h>
+#include <ALTAIR_CommandRouter.h>
+#include <ALTAIR_HAL.h>
 
 bool           backupRadiosOn             =  true ;        // If this is set to false, then _neither_ backup radio will be on.
 bool           backupRadio2On             =  true ;        // If this is set to true, _and_ if backupRadiosOn is _also_ set to true, then backupRadio2 will be 
                                                            //    initialized and will transmit and receive.  (Otherwise, backupRadio2 will not be initialized.)
-unsigned long  previousMillis[6]                  ;
-unsigned long  commandTimeoutInterval     =  2000 ;        // in milliseconds
+bool           telemetryFanOut            =  true ;        // If this is set to true, the status goes out on every radio that is on, each at its own link's rate
+                                                           //    (and the backup radios send their station name every stationNameInterval); otherwise, it goes
+                                                           //    out on the primary radio, and the backup radios send their station name along with it.
+bool           autoRadioFailover          =  true ;        // If this is set to true, the primary radio is switched automatically, by link quality (see
+                                                           //    ALTAIR_LinkQuality.h), as well as by the 'R' and 'r' commands.
+bool           dntProtocolMode            =  true ;        // If this is set to true, the DNT900 radio is run in protocol mode (see ALTAIR_DNT900Protocol.h):
+                                                           //    each packet sent is acknowledged (and resent if need be), and each has an RSSI.
+unsigned long  lightsOnInterval           =    40 ;        // in milliseconds: how long the lights flash to show a radio transmission
+unsigned long  radioPollInterval          =   250 ;        // in milliseconds: how often the radios' link rate controllers are asked if a send is due
+unsigned long  stationNameInterval        = 10000 ;        // in milliseconds
+unsigned long  linkQualityInterval        =  1000 ;        // in milliseconds: how often the link qualities are updated (and the failover policy is checked)
+unsigned long  orientFusionInterval       =   200 ;        // in milliseconds: how often all of the orientation sensors are read, and fused (see ALTAIR_OrientFusion.h)
+unsigned long  logFlushInterval           = 30000 ;        // in milliseconds: how often the SD card log's last, partial sector is written out (at most this much is lost if the power is)
 float          compassmagHeading          =  -999.;        // will be set to the heading in degrees East of true North, uncorrected for magnetic declination angle
 
 ALTAIR_GlobalMotorControl   motorControl          ;
 ALTAIR_GlobalDeviceControl  deviceControl         ;
 ALTAIR_GlobalLightControl   lightControl          ;
+ALTAIR_TaskScheduler        taskScheduler         ;
+ALTAIR_CommandRouter        commandRouter(performCommand);
+
+int8_t                      resetLightsTaskID     ;
 
 void setup() {
 
   Serial.begin(38400);
 
+  deviceControl.telemSystem()->dnt900()->setProtocolMode(dntProtocolMode);
   deviceControl.initializeAllDevices(backupRadiosOn, backupRadio2On);
+  deviceControl.telemSystem()->setFanOut(telemetryFanOut);
   
 // normal situation: flash yellow LEDs then NO lights on (formerly it was yellow LEDs and green laser on, but that heats up the I-drive transistor too much)
   lightControl.initializeAllLightSources();
+  deviceControl.telemSystem()->shx144()->setRSSIADC(lightControl.lightSourceMon()->ads1115ADC2(), INTSPHERE_SHX_RSSI_ADC_CHANNEL);
+  deviceControl.telemSystem()->setAutoFailover(autoRadioFailover);
   
   Serial.println(F("I2C/TWI bus and device initialization complete.  Now initializing all motors ..."));
 
+// Commands sent up via any of the radios are gathered, deduplicated, and executed in priority order by the command router.
+  if (backupRadiosOn && backupRadio2On) commandRouter.addSource(deviceControl.telemSystem()->rfm23bp());
+  if (backupRadiosOn)                   commandRouter.addSource(deviceControl.telemSystem()->shx144());
+                                        commandRouter.addSource(deviceControl.telemSystem()->dnt900());
+  commandRouter.setLinkQuality(deviceControl.telemSystem()->linkQuality());
+
   if (!motorControl.initializeAllMotors())
   {
     Serial.println("Initialization of motors failed\n\r");
     while(1);
   } 
 
+// Register each of the periodic jobs of the main loop with the task scheduler (which runs them in deadline order).
+  taskScheduler.addTask( "GPS and heading"     , getGPSandHeading                    ,   400 );
+  taskScheduler.addTask( "orientation fusion"  , fuseOrientSensors                   , orientFusionInterval );
+  taskScheduler.addTask( "UM7 serial"          , serviceUM7Serial                    ,     4 );
+  taskScheduler.addTask( "Arduino Micro"       , getArduinoMicroData                 ,   450 );
+  taskScheduler.addTask( "BME280s"             , sampleBME280s                       , radioPollInterval );
+  taskScheduler.addTask( "primary radio"       , sendStatusToPrimaryRadio            , radioPollInterval );
+  if (backupRadiosOn) 
+  taskScheduler.addTask( "backup radios"       , sendStatusToBackupRadios            , radioPollInterval );
+  if (backupRadiosOn) 
+  taskScheduler.addTask( "station name"        , sendStationNameToBackupRadios       , stationNameInterval );
+  taskScheduler.addTask( "computer status"     , sendGPSCompassStatusToComputer      ,  5000 );
+  taskScheduler.addTask( "nav mast sensors"    , printNavMastSensorValsAndAdjSettings,  2000 );
+  taskScheduler.addTask( "SD card"             , storeDataOnMicroSDCard              ,  1000 );
+  taskScheduler.addTask( "SD card writes"      , writeQueuedDataToMicroSDCard        ,    20 );
+  taskScheduler.addTask( "SD card flush"       , flushMicroSDCardLog                 , logFlushInterval , logFlushInterval );
+  taskScheduler.addTask( "read commands"       , readCommands                        ,    50 );
+  taskScheduler.addTask( "link quality"        , updateLinkQuality                   , linkQualityInterval );
+  taskScheduler.addTask( "DNT900 TX queue"     , drainDNT900TxQueue                  ,    10 );
+  if (backupRadiosOn && backupRadio2On)
+  taskScheduler.addTask( "RFM23BP RX queue"    , captureRFM23BPMessages              ,    10 );
+  taskScheduler.addTask( "scheduler stats"     , printSchedulerStats                 , 60000 , 60000 );
+  resetLightsTaskID = 
+  taskScheduler.addTask( "reset lights"        , resetLights                         ,     0 );
+  taskScheduler.enableTask( resetLightsTaskID  , false );
+
   Serial.println(F("Setup complete."));
 }
 
 void loop() {
 
-  if (getGPSandHeadingAtInterval(400)) {
-//  if (getGPSandHeadingAtInterval(377)) {  // I thought setting interval to 377 might help with the DNT blocking GPS issue -- but it really was reducing dntMaxReadTries that fixed it.
-//    digitalWrite(gpsSuccessfullyLockedPin, LOW);
-//    Serial.println(F("gotten GPS"));
-//    delay(100);
-//    digitalWrite(gpsSuccessfullyLockedPin, HIGH);
-  }
-  else {
-//    Serial.println(F("failed to get GPS"));
-  }
+  ALTAIR_HAL::i2cService();          // (the queued I2C requests' callbacks: see ALTAIR_HAL.h)
+  taskScheduler.runPending();
 
-  deviceControl.sitAwareSystem()->arduinoMicro()->getDataAfterInterval(450);
+}
 
-  sendStatusToPrimaryRadioAtInterval(1000);
+void storeDataOnMicroSDCard() {
 
-//  delay(100);
-  if (backupRadiosOn) sendStationNameToBackupRadiosAtInterval(1333);
-//  delay(100);
+  deviceControl.dataStoreSystem()->storeFlightRecord( motorControl, deviceControl, lightControl );   
 
-  sendGPSCompassStatusToComputerAtInterval(5000);
+}
 
-  printNavMastSensorValsAndAdjSettingsAtInterval(2000);
+void writeQueuedDataToMicroSDCard() {
 
-  storeDataOnMicroSDCard();
-
-  readCommands();
-  
-//  delay(100);
+  deviceControl.dataStoreSystem()->serviceLog();
 
 }
 
-void storeDataOnMicroSDCard() {
+void flushMicroSDCardLog() {
 
-  deviceControl.dataStoreSystem()->storeTimestamp( deviceControl.sitAwareSystem()->gpsSensors()->primary() );   
+  deviceControl.dataStoreSystem()->flushLog();
 
 }
 
 void readCommands() {
-  byte command[2] = { 0, 0 };
-  unsigned long currentMillis = millis();
-
-  if (backupRadiosOn && backupRadio2On) deviceControl.telemSystem()->rfm23bp()->readALTAIRInfo( command );
-  if (command[0] != 0) {
-    if (command[1] != 0) {
-      if (currentMillis - previousMillis[5] > commandTimeoutInterval) {
-        Serial.print(F("RFM23BP command[0] = ")); Serial.print(command[0], HEX); Serial.print(F("  command[1] = ")); Serial.println(command[1], HEX);
-        performCommand(command[0], command[1]);
-        previousMillis[5] = currentMillis;
-      }
-    }
-  }
 
-  if (backupRadiosOn) deviceControl.telemSystem()->shx144()->readALTAIRInfo( command );
-  if (command[0] != 0) {
-    if (command[1] != 0) {
-      if (currentMillis - previousMillis[5] > commandTimeoutInterval) {
-        Serial.print(F("SHX144 command[0] = ")); Serial.print(command[0], HEX); Serial.print(F("  command[1] = ")); Serial.println(command[1], HEX);
-        performCommand(command[0], command[1]);
-        previousMillis[5] = currentMillis;
-      }
-    }
-  }
+  commandRouter.gather(      millis() );
+  commandRouter.dispatchAll( millis() );
+  commandRouter.sendAcks(            );
 
-  deviceControl.telemSystem()->dnt900()->readALTAIRInfo( command );
-  if (command[0] != 0) {
-    if (command[1] != 0) {
-      if (currentMillis - previousMillis[5] > commandTimeoutInterval) {
-        Serial.print(F("DNT900 command[0] = ")); Serial.print(command[0], HEX); Serial.print(F("  command[1] = ")); Serial.println(command[1], HEX);
-        performCommand(command[0], command[1]);
-        previousMillis[5] = currentMillis;
-      }
-    }
+}
+
+void sampleBME280s() {
+
+  deviceControl.sitAwareSystem()->sampleBME280s();
+
+}
+
+void updateLinkQuality() {
+
+  deviceControl.telemSystem()->updateLinkQuality( millis() );
+
+}
+
+void drainDNT900TxQueue() {
+
+  deviceControl.telemSystem()->dnt900()->serviceTx();
+
+}
+
+void captureRFM23BPMessages() {
+
+  deviceControl.telemSystem()->rfm23bp()->serviceRx();
+
+}
+
+void serviceUM7Serial() {
+
+// Each UM7 reply is longer than the serial RX buffer, so it is drained as it arrives (and the next request is then written)
+  deviceControl.sitAwareSystem()->orientSensors()->um7()->serviceSerial();
+
+}
+
+void fuseOrientSensors() {
+
+  deviceControl.sitAwareSystem()->orientSensors()->fuse( millis() );
+
+}
+
+void getArduinoMicroData() {
+
+  ALTAIR_ArduinoMicro* micro  = deviceControl.sitAwareSystem()->arduinoMicro();
+  ALTAIR_MotorAndESC*  motors = motorControl.propSystem()->motors();
+
+// The read that getData() queues finishes in the background, so the sensors are updated from the last one that has finished.
+  for (uint8_t m = 0; m < 4; ++m) {
+    micro->updateSensors(m, motors[m].rpmSensor(), motors[m].currentSensor(), motors[m].motorTempSensor(), motors[m].escTempSensor());
   }
+  micro->getData();
+
+}
+
+void printSchedulerStats() {
+
+  taskScheduler.printStats();
+  deviceControl.dataStoreSystem()->logger()->printStats();
+  deviceControl.telemSystem()->dnt900()->printTxStats();
+  commandRouter.printStats();
+  deviceControl.telemSystem()->printLinkStats();
+  deviceControl.sitAwareSystem()->arduinoMicro()->printStats();
+  deviceControl.sitAwareSystem()->printBME280Stats();
+  deviceControl.sitAwareSystem()->orientSensors()->fusion()->printStats();
+  deviceControl.sitAwareSystem()->gpsSensors()->monitor()->printStats();
+  if (backupRadiosOn && backupRadio2On) deviceControl.telemSystem()->rfm23bp()->printRxStats();
 
 }
 
-void printNavMastSensorValsAndAdjSettingsAtInterval(long interval) {
+void resetLights() {
+
+  lightControl.intSphereSource()->resetLights();
+  lightControl.diffLEDSource()->resetLights();
 
-  unsigned long currentMillis = millis();
-  if (currentMillis - previousMillis[4] > interval) { 
-    previousMillis[4] = currentMillis;
+}
+
+void printNavMastSensorValsAndAdjSettings() {
 
 // First, the BME280 temp/pres/hum
     deviceControl.sitAwareSystem()->bmeMastPrintInfo();
@@ -137,77 +214,106 @@ void printNavMastSensorValsAndAdjSettingsAtInterval(long interval) {
         if (Serial.available()) inputByte2 = Serial.read();
         performCommand(inputByte, inputByte2);
     } 
-  }
 }
 
 
-bool getGPSandHeadingAtInterval(long interval)
+void getGPSandHeading()
 {
-  bool retval = false;
-
-  unsigned long currentMillis = millis();
-  if (currentMillis - previousMillis[3] > interval) { 
-    previousMillis[3] = currentMillis;
     Serial.println("Getting heading and GPS");
 
      // First, get the magnetometer heading
     compassmagHeading = deviceControl.sitAwareSystem()->orientSensors()->hmc5883l()->getHeading();
 
-// Then, get the GPS
-    retval            = deviceControl.sitAwareSystem()->gpsSensors()->primary()->getGPS();
-  }
-  return retval;
+// Then, get the GPS from both receivers, and cross-check and blend them
+    deviceControl.sitAwareSystem()->gpsSensors()->poll(millis());
 }
 
-void sendStationNameToBackupRadiosAtInterval(long interval)
+void sendStationNameToBackupRadios()
 {
-  unsigned long currentMillis = millis();
-  ALTAIR_GenTelInt* backup1 = deviceControl.telemSystem()->backup1();
-  if (currentMillis - previousMillis[2] > interval) { 
-    Serial.print(F("Writing station name to the first backup radio: ")); Serial.println(backup1->radioName());
-    previousMillis[2] = currentMillis;
-    lightControl.intSphereSource()->setLightsBackupRadio();
-    lightControl.diffLEDSource()->setLightsBackupRadio();
+  ALTAIR_TelemetrySystem* telemSystem = deviceControl.telemSystem();
+  ALTAIR_GenTelInt*       backups[2]  = { telemSystem->backup1(), telemSystem->backup2() };
 
-    if (!(backup1->sendCallSign()))   Serial.println(F("Could not send call sign to backup1 radio!"));
-    if (!(backup1->sendEndMessage())) Serial.println(F("Could not send end message to backup1 radio!"));
+// (Otherwise, the station name goes along with each status that the backup radios send.)
+  if (!telemSystem->fanOut()) return;
 
-    delay(20);
+  for (uint8_t i = 0; i < (backupRadio2On ? 2 : 1); ++i) {
+    if (!(backups[i]->sendCallSign()))   { Serial.print(F("Could not send call sign to backup radio!: "));   Serial.println(backups[i]->radioName()); }
+    if (!(backups[i]->sendEndMessage())) { Serial.print(F("Could not send end message to backup radio!: ")); Serial.println(backups[i]->radioName()); }
+    telemSystem->linkRate(backups[i])->sent(millis(), backups[i]->callSignBytes(), 0);
+  }
+}
 
-    if (backupRadio2On) {
-      ALTAIR_GenTelInt* backup2 = deviceControl.telemSystem()->backup2();
 
-      if (!(backup2->sendCallSign()))   { Serial.print(F("Could not send call sign to backup2 radio!: "));   Serial.println(backup2->radioName()); }
-      if (!(backup2->sendEndMessage())) { Serial.print(F("Could not send end message to backup2 radio!: ")); Serial.println(backup2->radioName()); }
+void sendStatusToBackupRadios()
+{
+  ALTAIR_TelemetrySystem* telemSystem = deviceControl.telemSystem();
+
+// (In fan-out mode, the status goes out on the backup radios along with the primary one.)
+  if (telemSystem->fanOut()) return;
+
+  ALTAIR_GenTelInt*       backups[2]  = { telemSystem->backup1(), telemSystem->backup2() };
+  unsigned long           soonest     = radioPollInterval;
+  bool                    sentAny     = false;
+
+// Each backup radio sends its station name, and then as much of the status as its link has room for, whenever its link rate controller says so
+  for (uint8_t i = 0; i < (backupRadio2On ? 2 : 1); ++i) {
+    ALTAIR_GenTelInt*          backup = backups[i];
+    ALTAIR_LinkRateController* link   = telemSystem->linkRate(backup);
+    unsigned long              wait   = link->millisUntilDue(millis(), backup->txBacklogged());
+    if (wait > 0) {
+      if (wait < soonest) soonest = wait;
+      continue;
     }
 
-    delay(40);
-    lightControl.intSphereSource()->resetLights();
-    lightControl.diffLEDSource()->resetLights();
-
-    Serial.println(F("done with backup radios"));
-/*
-    byte command[2];
-    backup1->readALTAIRInfo( command );
-    if (command[0] != 0) {
-      if (command[1] != 0) {
-        performCommand(command[0], command[1]);
-      }
+    Serial.print(F("Writing station name and status to backup radio: ")); Serial.println(backup->radioName());
+    if (!sentAny) {
+      lightControl.intSphereSource()->setLightsBackupRadio();
+      lightControl.diffLEDSource()->setLightsBackupRadio();
     }
-*/
 
+    if (!(backup->sendCallSign()))   { Serial.print(F("Could not send call sign to backup radio!: "));   Serial.println(backup->radioName()); }
+    backup->sendAllALTAIRInfo( motorControl  ,
+                               deviceControl ,
+                               lightControl    );
+    if (!(backup->sendEndMessage())) { Serial.print(F("Could not send end message to backup radio!: ")); Serial.println(backup->radioName()); }
+
+    link->sent(millis(), backup->lastSendBytes() + backup->callSignBytes(), backup->lastSendFrames());
+    sentAny = true;
+  }
+
+  if (!sentAny) {
+// Neither is due yet: try again when the sooner of them will be
+    taskScheduler.deferCurrentTask(soonest);
+    return;
   }
+
+// Turn the lights back off after lightsOnInterval, rather than sitting in a delay() here
+  taskScheduler.runOnceAfter(resetLightsTaskID, lightsOnInterval);
+
+  Serial.println(F("done with backup radios"));
 }
 
 
-void sendStatusToPrimaryRadioAtInterval(long interval)
+void sendStatusToPrimaryRadio()
 {
-  unsigned long currentMillis = millis();
-  ALTAIR_GenTelInt* primary = deviceControl.telemSystem()->primary();
-  delay(40);
+  ALTAIR_GenTelInt*          primary = deviceControl.telemSystem()->primary();
+  ALTAIR_LinkRateController* link    = deviceControl.telemSystem()->linkRate(primary);
+
+// In fan-out mode, the status goes out on every radio that is on and due, in a single pass that never waits for a radio
+  if (deviceControl.telemSystem()->fanOut()) {
+    if (deviceControl.telemSystem()->fanOutStatus(millis(), motorControl, deviceControl, lightControl) > 0) {
+      lightControl.intSphereSource()->setLightsPrimaryRadio();
+      lightControl.diffLEDSource()->setLightsPrimaryRadio();
+      taskScheduler.runOnceAfter(resetLightsTaskID, lightsOnInterval);
+    }
+    return;
+  }
 
-  if (!primary->isBusy() && currentMillis - previousMillis[1] > interval) {
-    previousMillis[1] = currentMillis;
+// Send as soon as the link has room for it (and the radio can take it), rather than at a fixed interval, whatever the radio
+  unsigned long wait = link->millisUntilDue(millis(), primary->txBacklogged());
+  if (wait > 0) {
+    taskScheduler.deferCurrentTask(wait);
+  } else {
    
     Serial.print(F("*** Writing status to the primary radio: "));  Serial.println(primary->radioName());
     lightControl.intSphereSource()->setLightsPrimaryRadio();
@@ -217,25 +323,22 @@ void sendStatusToPrimaryRadioAtInterval(long interval)
     primary->sendAllALTAIRInfo( motorControl  ,
                                 deviceControl ,
                                 lightControl    );
+    link->sent(millis(), primary->lastSendBytes(), primary->lastSendFrames());
 
-    delay(40);
-    lightControl.intSphereSource()->resetLights();
-    lightControl.diffLEDSource()->resetLights();
+    taskScheduler.runOnceAfter(resetLightsTaskID, lightsOnInterval);
 
   }
 }
 
 
-void sendGPSCompassStatusToComputerAtInterval(long interval) {
+void sendGPSCompassStatusToComputer() {
 
-  unsigned long currentMillis = millis();
-  if (currentMillis - previousMillis[0] > interval) {
-    ALTAIR_GPSSensor* gps = deviceControl.sitAwareSystem()->gpsSensors()->primary();
-    previousMillis[0] = currentMillis;   
+    ALTAIR_GPSSensor* gps = deviceControl.sitAwareSystem()->gpsSensors()->solution();
 
     Serial.print(F("ALTAIR Latitude: "));    Serial.println(gps->lat());
     Serial.print(F("ALTAIR Longitude: "));   Serial.println(gps->lon());
     Serial.print(F("ALTAIR LatLong Age: ")); Serial.println(gps->age());
+    Serial.print(F("ALTAIR GPS Health: 0x")); Serial.println(deviceControl.sitAwareSystem()->gpsSensors()->solution()->health(), HEX);
     Serial.print(F("ALTAIR Year: "));        Serial.println(gps->year());
     Serial.print(F("ALTAIR Month: "));       Serial.println(gps->month());
     Serial.print(F("ALTAIR Day: "));         Serial.println(gps->day());
@@ -245,7 +348,6 @@ void sendGPSCompassStatusToComputerAtInterval(long interval) {
 //    Serial.print(F("ALTAIR Hundredth: "));   Serial.println(gps.time.centisecond());
 //    Serial.print(F("ALTAIR GPSTime Age: ")); Serial.println(gps.time.age());                  // no need to have this, it always reads the same thing
     Serial.print(F("ALTAIR compass magnetometer heading: ")); Serial.println(compassmagHeading);
-  }
 }
 
 
@@ -254,6 +356,7 @@ void performCommand(byte byte0, byte byte1) {
 // a motor or servo command
     case 's':
       motorControl.performCommand(byte1);
+      if (byte1 == 'C') deviceControl.dataStoreSystem()->flushLog();     // (a cutdown: the flight may be about to end abruptly)
       break;
 // a device (that is not a servo, motor, or light source) command
     case 'd':
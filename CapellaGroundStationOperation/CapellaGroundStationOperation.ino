@@ -1,18 +1,33 @@
 // Our Arduino code for operation of the Capella DNT900P-based ground station.
 
 #include <ALTAIR_DNT900.h>
+#include <ALTAIR_DownlinkDecoder.h>
+#include <ALTAIR_CommandARQ.h>
   
 const byte     dntHwResetPin                   =      4;
 const byte     dntCTSPin                       =      5;
 const byte     dntRTSPin                       =      6;
+const long     usbSerialBaudRate               = 250000;   // exact on a 16 MHz Mega, and over 6x the DNT900's 38400 baud, so the CSV keeps up
+const uint8_t  downlinkOutputFormat            = DOWNLINK_OUTPUT_CSV;    // or DOWNLINK_OUTPUT_BINARY
+const unsigned long statsInterval              =  60000;   // in milliseconds
 long           previousMillis                  =      0;
+unsigned long  previousStatsMillis             =      0;
 
-ALTAIR_DNT900  theDNT900(1, dntHwResetPin,                 // on Serial1 -- 910 MHz, Capella antenna: 6-element 63 cm Yagi, approx. 9 dBi
-                         dntCTSPin, dntRTSPin)         ;
+// Decoded records are written straight to the USB serial port.
+class SerialRecordSink : public ALTAIR_RecordSink {
+  public:
+    virtual void write(const byte* data, uint16_t length) { Serial.write(data, length); }
+};
+
+ALTAIR_DNT900          theDNT900(1, dntHwResetPin,         // on Serial1 -- 910 MHz, Capella antenna: 6-element 63 cm Yagi, approx. 9 dBi
+                                 dntCTSPin, dntRTSPin) ;
+SerialRecordSink       serialSink                      ;
+ALTAIR_DownlinkDecoder downlinkDecoder(&serialSink, downlinkOutputFormat);
+ALTAIR_CommandSender   commandSender                   ;   // resends each command until ALTAIR acknowledges it (see ALTAIR_CommandARQ.h)
 
 void setup() {
 
-  Serial.begin(38400);
+  Serial.begin(usbSerialBaudRate);
 
   Serial.println(F("Starting DNT900 radio setup..."));
   if (!theDNT900.initialize()) {
@@ -20,39 +35,44 @@ void setup() {
     while(1);
   }
   Serial.println(F("DNT900 radio setup complete."));
+  theDNT900.setCommandSender(&commandSender);
+  downlinkDecoder.setCommandSender(&commandSender);
 
   delay(100);
+  downlinkDecoder.writeCsvHeader();
 
 }
 
 void loop() {
-  byte downwardCommand[2];
-  delay(100);
-  theDNT900.readALTAIRInfo( downwardCommand, true );       // ignore any downward commands, for now
+// Decode everything that has arrived, without ever waiting (so that the 64-byte serial receive buffer can never overflow).
+  unsigned long currentMillis = millis();
+  while (theDNT900.available()) downlinkDecoder.feed(theDNT900.read(), currentMillis);
   sendCommandsToALTAIRAtInterval(2000);
+  if (currentMillis - previousStatsMillis > statsInterval) {
+    previousStatsMillis = currentMillis;
+    downlinkDecoder.writeCsvStats();
+    commandSender.printStats();
+  }
 }
 
 void sendCommandsToALTAIRAtInterval(long interval)
 {
-  unsigned long currentMillis = millis();
-//  if (digitalRead(shxBusyPin) == LOW && currentMillis - previousMillis3 > interval) {
-  if (currentMillis - previousMillis > interval) { 
-    previousMillis = currentMillis;
-
-    byte    headerByte1, headerByte2, inputByte1, inputByte2;
-    if (Serial.available()) {
-       headerByte1 = Serial.read();
-       if (headerByte1 == 'C') {
-          headerByte2 = Serial.read();
-          if (headerByte2 == '2') {
-             inputByte1 = Serial.read();
-             inputByte2 = Serial.read();
-             // send the info via the DNT
-             theDNT900.sendCommandToALTAIR(inputByte1, inputByte2);
-          }
-       }
+// queue each command typed in (as 'C', '2', and then its two bytes), while there is room in the window for it
+  if (Serial.available() >= 4 && !commandSender.full()) {
+    if (Serial.read() == 'C' && Serial.read() == '2') {
+      byte inputByte1 = Serial.read();
+      byte inputByte2 = Serial.read();
+      theDNT900.queueCommandToALTAIR(inputByte1, inputByte2);
     }
+  }
+
+// send the queued commands that are due (new ones, or ones still unacknowledged when their timers ran out) via the DNT
+  unsigned long currentMillis = millis();
+  if (theDNT900.serviceCommandsToALTAIR() > 0) previousMillis = currentMillis;
 
+// with nothing else to send, send a heartbeat, so that ALTAIR can tell that the link is still alive (see ALTAIR_LinkQuality.h)
+  if (currentMillis - previousMillis > interval) {
+    previousMillis = currentMillis;
+    theDNT900.sendHeartbeatToALTAIR();
   }
 }
-
@@ -16,8 +16,8 @@
 */
 /**************************************************************************/
 
+#include <string.h>
 #include "ALTAIR_ArduinoMicro.h"
-#include <Wire.h>
 
 /**************************************************************************/
 /*!
@@ -25,29 +25,236 @@
 */
 /**************************************************************************/
 ALTAIR_ArduinoMicro::ALTAIR_ArduinoMicro(                   ) :
-               _dataLastObtainedAtMillis(               0   ) 
+               _dataLastObtainedAtMillis(               0   ) ,
+               _microVersion(                           0   ) ,
+               _extended(                           false   ) ,
+               _haveExtended(                       false   ) ,
+               _selectedRegister(          MICRO_REG_NONE   ) ,
+               _sequence(                               0   ) ,
+               _snapshotAgeMillis(                      0   ) ,
+               _requestRegister(           MICRO_REG_NONE   ) ,
+               _gettingData(                        false   ) ,
+               _reading(                            false   ) ,
+               _lastReadOK(                         false   )
 {
+    memset(_snapshot,      0, sizeof(_snapshot));
+    memset(&_stats,        0, sizeof(_stats));
+    memset(&_request,      0, sizeof(_request));
 }
 
 /**************************************************************************/
 /*!
  @brief  Get the 16 packed data bytes over I2C from the physical Arduino 
-         Micro, and store that data in this ALTAIR_ArduinoMicro object.
+         Micro, if they were last obtained longer than interval ago.
 */
 /**************************************************************************/
 void ALTAIR_ArduinoMicro::getDataAfterInterval(    long interval  )
 {
-  unsigned long currentMillis = millis();
-  if (currentMillis - _dataLastObtainedAtMillis > interval) { 
-    _dataLastObtainedAtMillis = currentMillis;
+  unsigned long currentMillis = ALTAIR_HAL::clockMillis();
+  if (currentMillis - _dataLastObtainedAtMillis > (unsigned long) interval) { 
+    getData();
+  }
+}
 
-    Wire.requestFrom( ARDUINOMICRO_I2CADDRESS , ARDUINOMICRO_DATABYTES );
-    for (int i = 0; i < 4; ++i) _packedRPM[i]     = Wire.read();
-    for (int i = 0; i < 4; ++i) _packedCurrent[i] = Wire.read();
-    for (int i = 0; i < 8; ++i) _packedTemp[i]    = Wire.read();
+/**************************************************************************/
+/*!
+ @brief  Start getting the data over I2C from the physical Arduino Micro
+         (e.g. when called by the task scheduler, which itself takes care
+         of the interval): the packed bytes, and then the extended block
+         if it is wanted.  (These are separate reads, so the extended
+         block can be from the next snapshot along.)  The reads are queued,
+         and finish in the background; if the previous ones have not yet
+         finished, they are left to.
+*/
+/**************************************************************************/
+void ALTAIR_ArduinoMicro::getData(                                )
+{
+    if (_reading) {
+        ++_stats.busyReads;
+        return;
+    }
+    _gettingData = startRead(MICRO_REG_ALL);
+}
 
-//    for (int i = 0; i < 4; ++i) { Serial.print("_packedRPM["); Serial.print(i); Serial.print("]     = "); Serial.println(_packedRPM[i]    , HEX) ; }
-//    for (int i = 0; i < 4; ++i) { Serial.print("_packedCurrent["); Serial.print(i); Serial.print("] = "); Serial.println(_packedCurrent[i], HEX) ; }
-//    for (int i = 0; i < 8; ++i) { Serial.print("_packedTemp["); Serial.print(i); Serial.print("]    = "); Serial.println(_packedTemp[i]   , HEX) ; }
-  }
+/**************************************************************************/
+/*!
+ @brief  Read one block of the Micro's register map right now, waiting for
+         it (after any queued read).  False if it failed.
+*/
+/**************************************************************************/
+bool ALTAIR_ArduinoMicro::readRegister(    uint8_t reg    )
+{
+    if (_reading) ALTAIR_HAL::i2cFlush();
+    _gettingData = false;
+    if (!startRead(reg)) return false;
+    ALTAIR_HAL::i2cFlush();
+    return _lastReadOK;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Queue the read of one block of the Micro's register map, in one
+         request: the register is only written (first) when it differs
+         from the one already selected, as the selection stays.
+*/
+/**************************************************************************/
+bool ALTAIR_ArduinoMicro::startRead(       uint8_t reg    )
+{
+    uint8_t length = microRegisterLength(reg);
+    if (length == 0) return false;
+
+    _requestRegister    = reg;
+    _request.address    = ARDUINOMICRO_I2CADDRESS;
+    _request.writeBytes = &_requestRegister;
+    _request.numWrite   = (reg != _selectedRegister) ? 1 : 0;
+    _request.readBytes  = _response;
+    _request.numRead    = MICRO_REGMAP_OVERHEAD + length;
+    _request.callback   = readDone;
+    _request.context    = this;
+    if (!ALTAIR_HAL::i2cSubmit(&_request)) {
+        ++_stats.failedReads;
+        return false;
+    }
+    _stats.busBytes += (_request.numWrite ? 2 : 0) + 1 + _request.numRead;
+    _reading         = true;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A queued read has finished (called back from i2cService()):
+         check it, and then queue the next block, if there is one.
+*/
+/**************************************************************************/
+void ALTAIR_ArduinoMicro::readDone(  ALTAIR_HALI2CRequest* request )
+{
+    ALTAIR_ArduinoMicro* micro = (ALTAIR_ArduinoMicro*) request->context;
+    micro->_reading    = false;
+    micro->_lastReadOK = micro->finishRead();
+    if (!micro->_gettingData) return;                                // (e.g. a read by readRegister())
+    switch (micro->_requestRegister) {
+        case MICRO_REG_ALL:
+            micro->_gettingData = micro->_extended && micro->startRead(MICRO_REG_EXT_PROPULSION);
+            break;
+        case MICRO_REG_EXT_PROPULSION:
+            micro->_gettingData = micro->_lastReadOK && micro->startRead(MICRO_REG_EXT_TEMP);
+            break;
+        default:
+            if (micro->_lastReadOK) micro->_haveExtended = true;
+            micro->_gettingData = false;
+            break;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Check a finished read.  Nothing is kept unless the whole
+         response checks out.
+*/
+/**************************************************************************/
+bool ALTAIR_ArduinoMicro::finishRead(                             )
+{
+    uint8_t reg      = _requestRegister;
+    uint8_t expected = _request.numRead;
+    byte*   response = _response;
+    if (_request.status != HAL_I2C_DONE) {
+        ++_stats.failedReads;
+        _selectedRegister = MICRO_REG_NONE;                            // (the register may not have been written)
+        return false;
+    }
+    if (_request.numWrite) _selectedRegister = reg;
+    if (_request.numReceived != expected) {
+        ++_stats.failedReads;
+        return false;
+    }
+    if (response[0] != reg || microRegisterMapCRC(response, expected - 1) != response[expected - 1]) {
+        ++_stats.badReads;
+        _selectedRegister = MICRO_REG_NONE;                            // (the Micro may have reset, so select it again)
+        return false;
+    }
+    if (reg == MICRO_REG_VERSION) {
+        _microVersion = response[MICRO_REGMAP_HEADER_LENGTH];
+        return true;
+    }
+    if (response[1] == 0) return false;                              // (the Micro has not taken a snapshot yet)
+
+    memcpy(_snapshot + microRegisterOffset(reg), response + MICRO_REGMAP_HEADER_LENGTH, expected - MICRO_REGMAP_OVERHEAD);
+    if (response[1] == _sequence && reg < MICRO_REG_EXT_PROPULSION) ++_stats.repeatedReads;   // (the extended block is meant to be of the same one)
+    ++_stats.reads;
+    _sequence                 = response[1];
+    _snapshotAgeMillis        = ((uint16_t) response[2] << 8) | response[3];
+    _dataLastObtainedAtMillis = ALTAIR_HAL::clockMillis();
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Turn the reading of the extended block on or off.  It is only
+         turned on if the Micro's register map is new enough to have it
+         (its version is read again here, in case the Micro was not yet
+         running when initialize() was called).
+*/
+/**************************************************************************/
+bool ALTAIR_ArduinoMicro::setExtended(     bool on        )
+{
+    if (on && _microVersion < MICRO_REGMAP_EXTENDED_VERSION) readRegister(MICRO_REG_VERSION);
+    _extended = on && _microVersion >= MICRO_REGMAP_EXTENDED_VERSION;
+    if (!_extended) _haveExtended = false;
+    return _extended == on;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Set one motor's RPM, current, and temp sensors from the extended
+         readings, if they have been read, or else from the packed ones.
+*/
+/**************************************************************************/
+void ALTAIR_ArduinoMicro::updateSensors(   uint8_t               motor     ,
+                                           ALTAIR_RPMSensor&     rpm       ,
+                                           ALTAIR_CurrentSensor& current   ,
+                                           ALTAIR_TempSensor&    motorTemp ,
+                                           ALTAIR_TempSensor&    escTemp     )
+{
+    if (_haveExtended) {
+        rpm.setFromExtended(      extendedRPM(      motor        ));
+        current.setFromExtended(  extendedCurrent(  motor        ));
+        motorTemp.setFromExtended(extendedTemp(     2*motor      ));
+        escTemp.setFromExtended(  extendedTemp(     2*motor + 1  ));
+    } else {
+        rpm.setFromPacked(        packedRPM()[      motor        ]);
+        current.setFromPacked(    packedCurrent()[  motor        ]);
+        motorTemp.setFromPacked(  packedTemp()[     2*motor      ]);
+        escTemp.setFromPacked(    packedTemp()[     2*motor + 1  ]);
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  How old the last snapshot read is now: its age when it was read,
+         plus the time since then.
+*/
+/**************************************************************************/
+unsigned long ALTAIR_ArduinoMicro::dataAgeMillis(                 )
+{
+    return _snapshotAgeMillis + (ALTAIR_HAL::clockMillis() - _dataLastObtainedAtMillis);
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the Arduino Micro read statistics.
+*/
+/**************************************************************************/
+void ALTAIR_ArduinoMicro::printStats(                             )
+{
+    Serial.println(F("Arduino Micro statistics:"));
+    Serial.print(F("   reads good/failed/bad: "));   Serial.print(_stats.reads);  Serial.print(F("/"));
+    Serial.print(_stats.failedReads);                 Serial.print(F("/"));        Serial.println(_stats.badReads);
+    Serial.print(F("   repeated snapshots: "));       Serial.println(_stats.repeatedReads);
+    Serial.print(F("   still reading, when due: "));  Serial.println(_stats.busyReads);
+    Serial.print(F("   I2C bus bytes: "));            Serial.println(_stats.busBytes);
+    Serial.print(F("   last sequence / age (ms): ")); Serial.print(_sequence);     Serial.print(F(" / ")); Serial.println(dataAgeMillis());
+    Serial.print(F("   register map version: "));     Serial.print(_microVersion);
+    Serial.println(_extended ? F(" (extended)") : F(" (compact)"));
 }
+#endif
@@ -8,6 +8,24 @@
     and controls the 4 propulsion system RPM sensors, the 4 propulsion 
     system current sensors, and the 8 propulsion system temp sensors.
 
+    The data is read through the Micro's I2C register map (see
+    ALTAIR_MicroRegisterMap.h): each read is checked (its register echo,
+    length, and CRC) before any of it is used, and the snapshot's sequence
+    number and age are kept, so that it is known how fresh the data is.
+    A read that fails leaves the previous data in place.
+
+    Micros with version 2 (or later) of the register map also have 16-bit
+    (extended) readings, which are read as well once setExtended(true) has
+    checked the Micro's version; otherwise just the packed bytes are read.
+    updateSensors() then passes whichever ones there are on to a motor's
+    RPM, current, and temp sensors.
+
+    getData() does not wait for the bus: it queues the read (see
+    ALTAIR_HAL::i2cSubmit), and each block is checked (and the next one
+    queued) when the read has finished, called back from
+    ALTAIR_HAL::i2cService() in the main loop.  The readings are thus
+    those of the last read to have finished.  readRegister() still waits.
+
     Justin Albert  jalbert@uvic.ca     began on 18 Sep. 2018
 
     @section  HISTORY
@@ -19,28 +37,78 @@
 #ifndef   ALTAIR_ARDUINOMICRO_h
 #define   ALTAIR_ARDUINOMICRO_h
 
-#include "Arduino.h"
+#include <ALTAIR_HAL.h>
+#include <ALTAIR_MicroRegisterMap.h>
+#include "ALTAIR_RPMSensor.h"
+#include "ALTAIR_CurrentSensor.h"
+#include "ALTAIR_TempSensor.h"
 
 #define   ARDUINOMICRO_I2CADDRESS                 0x08
 #define   ARDUINOMICRO_DATABYTES                    16
 
+struct    ALTAIR_ArduinoMicroStats {
+    unsigned long        reads                                ;  // that were valid
+    unsigned long        failedReads                          ;  // not acknowledged, or short
+    unsigned long        badReads                             ;  // with a bad register echo or CRC
+    unsigned long        repeatedReads                        ;  // valid, but of a snapshot that had already been read
+    unsigned long        busBytes                             ;  // on the I2C bus, including the address bytes
+    unsigned long        busyReads                            ;  // getData() calls with the previous one's reads not yet finished
+};
+
 class ALTAIR_ArduinoMicro {
   public:
 
     ALTAIR_ArduinoMicro(                                         )    ;
 
-    virtual  void        initialize(                             )    {                         }
+    virtual  void        initialize(                             )    { readRegister(MICRO_REG_VERSION) ; }
     virtual  void        getDataAfterInterval(    long interval  )    ;
+    virtual  void        getData(                                )    ;
+             bool        readRegister(            uint8_t reg    )    ;   // Read (and check) one block, waiting; false if it failed.
+             bool        reading(                                )    { return _reading       ; }   // (a queued read not yet finished)
+
+             byte*       packedRPM(                              )    { return _snapshot + MICRO_SNAPSHOT_RPM     ; }
+             byte*       packedCurrent(                          )    { return _snapshot + MICRO_SNAPSHOT_CURRENT ; }
+             byte*       packedTemp(                             )    { return _snapshot + MICRO_SNAPSHOT_TEMP    ; }
+             uint16_t    extendedRPM(         uint8_t motor      )    { return           ALTAIR_MicroRegisterMap::getWord(_snapshot + MICRO_SNAPSHOT_EXT_RPM     + 2*motor ) ; }   // in RPM
+             int16_t     extendedCurrent(     uint8_t motor      )    { return (int16_t) ALTAIR_MicroRegisterMap::getWord(_snapshot + MICRO_SNAPSHOT_EXT_CURRENT + 2*motor ) ; }   // in 10 mA
+             int16_t     extendedTemp(        uint8_t sensor     )    { return (int16_t) ALTAIR_MicroRegisterMap::getWord(_snapshot + MICRO_SNAPSHOT_EXT_TEMP    + 2*sensor) ; }   // in 0.1 degrees C
+
+             uint8_t     microVersion(                           )    { return _microVersion  ; }   // (0 if not known)
+             bool        setExtended(             bool on        )    ;   // Read the extended block too?  False if the Micro cannot.
+             bool        extended(                               )    { return _extended      ; }
+             void        updateSensors(           uint8_t motor  ,        // Set motor #motor's (0 to 3, as in ALTAIR_PropulsionSystem)
+                                    ALTAIR_RPMSensor&     rpm     ,        //    sensors from the last readings (its motor
+                                    ALTAIR_CurrentSensor& current ,        //    temp is temp #2*motor, and its ESC temp
+                                    ALTAIR_TempSensor&    motorTemp ,      //    is #2*motor+1).
+                                    ALTAIR_TempSensor&    escTemp  )    ;
+
+             uint8_t     sequence(                               )    { return _sequence      ; }   // of the last snapshot read (0 if none yet)
+             unsigned long dataAgeMillis(                        )    ;   // how old that snapshot is now
+             bool        isFresh(    unsigned long maxAgeMillis  )    { return _sequence != 0 && dataAgeMillis() <= maxAgeMillis ; }
+
+             const ALTAIR_ArduinoMicroStats* stats(              )    { return &_stats        ; }
+             void        printStats(                             )    ;
 
-             byte*       packedRPM(                              )    { return _packedRPM     ; }
-             byte*       packedCurrent(                          )    { return _packedCurrent ; }
-             byte*       packedTemp(                             )    { return _packedTemp    ; }
-    
   private:
 
+             bool        startRead(               uint8_t reg    )    ;
+    static   void        readDone(    ALTAIR_HALI2CRequest* request )   ;
+             bool        finishRead(                             )    ;
+
     unsigned long       _dataLastObtainedAtMillis                     ;
-             byte       _packedRPM[4]                                 ;
-             byte       _packedCurrent[4]                             ;
-             byte       _packedTemp[8]                                ;
+             byte       _snapshot[MICRO_SNAPSHOT_LENGTH]              ;  // (as laid out in the Micro's register map)
+             uint8_t    _microVersion                                 ;
+             bool       _extended                                     ;
+             bool       _haveExtended                                 ;  // (i.e. the extended block has been read)
+             uint8_t    _selectedRegister                             ;  // (as far as is known)
+             uint8_t    _sequence                                     ;
+             uint16_t   _snapshotAgeMillis                            ;  // when it was read
+    ALTAIR_ArduinoMicroStats _stats                                   ;
+    ALTAIR_HALI2CRequest _request                                     ;
+             byte       _response[MICRO_REGMAP_MAX_RESPONSE]          ;
+             uint8_t    _requestRegister                              ;
+             bool       _gettingData                                  ;  // (the reads queued by getData(), one after another)
+             bool       _reading                                      ;
+             bool       _lastReadOK                                   ;
 };
 #endif    //   ifndef ALTAIR_ARDUINOMICRO_h
@@ -0,0 +1,226 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_BME280.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for each of ALTAIR's three Adafruit BME280
+    pressure/temp/humidity sensors (see ALTAIR_BME280.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "ALTAIR_BME280.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_BME280::ALTAIR_BME280(                                        ) :
+    _address(                                       BME280_I2CADDRESS ) ,
+    _temperature(                                                   0 ) ,
+    _pressure(                                                      0 ) ,
+    _humidity(                                                      0 ) ,
+    _valid(                                                     false ) ,
+    _sampleMillis(                                                  0 )
+{
+    uint8_t none[BME280_CALIB_TP_LENGTH];
+    memset(none, 0, sizeof(none));
+    setCalibration(none, none);
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Check that it is a BME280, reset it, read its calibration data,
+         and start it measuring continuously.
+*/
+/**************************************************************************/
+bool ALTAIR_BME280::begin( uint8_t address )
+{
+    _address = address;
+    uint8_t chipID = 0;
+    if (!readRegisters(BME280_REG_CHIP_ID, &chipID, 1) || chipID != BME280_CHIP_ID) return false;
+    if (!writeRegister(BME280_REG_RESET, BME280_RESET_COMMAND)) return false;
+    ALTAIR_HAL::clockDelay(10);
+    uint8_t status = BME280_STATUS_IM_UPDATE;
+    for (uint8_t tries = 0; (status & BME280_STATUS_IM_UPDATE) && tries < 10; ++tries) {
+        if (!readRegisters(BME280_REG_STATUS, &status, 1)) return false;
+        if (status & BME280_STATUS_IM_UPDATE) ALTAIR_HAL::clockDelay(10);
+    }
+
+    uint8_t calibTP[BME280_CALIB_TP_LENGTH];
+    uint8_t calibH[BME280_CALIB_H_LENGTH];
+    if (!readRegisters(BME280_REG_CALIB_TP, calibTP, BME280_CALIB_TP_LENGTH) ||
+        !readRegisters(BME280_REG_CALIB_H,  calibH,  BME280_CALIB_H_LENGTH )) return false;
+    setCalibration(calibTP, calibH);
+
+    return writeRegister(BME280_REG_CTRL_MEAS, 0x00)                         &&   // (sleep, so that the config is taken)
+           writeRegister(BME280_REG_CTRL_HUM,  BME280_CTRL_HUM_X16)          &&   // (which only takes effect with the next ctrl_meas write)
+           writeRegister(BME280_REG_CONFIG,    BME280_CONFIG_STANDBY_0_5)    &&
+           writeRegister(BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS_X16_NORMAL);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Read all of the data registers in one burst, and compensate them.
+*/
+/**************************************************************************/
+bool ALTAIR_BME280::sample(                                          )
+{
+    uint8_t data[BME280_DATA_LENGTH];
+    if (!readRegisters(BME280_REG_DATA, data, BME280_DATA_LENGTH)) {
+        ++_stats.failedSamples;
+        _temperature = 0;
+        _pressure    = 0;
+        _humidity    = 0;
+        _valid       = false;
+        return false;
+    }
+    int32_t adcP = ((int32_t) data[0] << 12) | ((int32_t) data[1] << 4) | (data[2] >> 4);
+    int32_t adcT = ((int32_t) data[3] << 12) | ((int32_t) data[4] << 4) | (data[5] >> 4);
+    int32_t adcH = ((int32_t) data[6] <<  8) |             data[7];
+    if (adcT == BME280_SKIPPED_TP || adcP == BME280_SKIPPED_TP || adcH == BME280_SKIPPED_H) {
+        ++_stats.notReady;
+        return false;
+    }
+    compensate(adcT, adcP, adcH);
+    _valid        = true;
+    _sampleMillis = ALTAIR_HAL::clockMillis();
+    ++_stats.samples;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Unpack the calibration data (little-endian, with dig_H4 and
+         dig_H5 sharing a byte).
+*/
+/**************************************************************************/
+void ALTAIR_BME280::setCalibration( const uint8_t* calibTP ,
+                                    const uint8_t* calibH   )
+{
+    _digT1 = (uint16_t) (calibTP[ 1] << 8 | calibTP[ 0]);
+    _digT2 = (int16_t)  (calibTP[ 3] << 8 | calibTP[ 2]);
+    _digT3 = (int16_t)  (calibTP[ 5] << 8 | calibTP[ 4]);
+    _digP1 = (uint16_t) (calibTP[ 7] << 8 | calibTP[ 6]);
+    _digP2 = (int16_t)  (calibTP[ 9] << 8 | calibTP[ 8]);
+    _digP3 = (int16_t)  (calibTP[11] << 8 | calibTP[10]);
+    _digP4 = (int16_t)  (calibTP[13] << 8 | calibTP[12]);
+    _digP5 = (int16_t)  (calibTP[15] << 8 | calibTP[14]);
+    _digP6 = (int16_t)  (calibTP[17] << 8 | calibTP[16]);
+    _digP7 = (int16_t)  (calibTP[19] << 8 | calibTP[18]);
+    _digP8 = (int16_t)  (calibTP[21] << 8 | calibTP[20]);
+    _digP9 = (int16_t)  (calibTP[23] << 8 | calibTP[22]);
+    _digH1 =                                calibTP[25];
+    _digH2 = (int16_t)  (calibH[1] << 8 | calibH[0]);
+    _digH3 =                              calibH[2];
+    _digH4 = (int16_t)  (((int8_t) calibH[3]) * 16 | (calibH[4] & 0x0F));
+    _digH5 = (int16_t)  (((int8_t) calibH[5]) * 16 | (calibH[4] >> 4));
+    _digH6 = (int8_t)                     calibH[6];
+}
+
+/**************************************************************************/
+/*!
+ @brief  Compensate a measurement, with the datasheet's integer formulas
+         (the 64-bit one for the pressure, as the Adafruit library uses),
+         with its left shifts of signed values written as multiplications.
+*/
+/**************************************************************************/
+void ALTAIR_BME280::compensate( int32_t adcT ,
+                                int32_t adcP ,
+                                int32_t adcH  )
+{
+    int32_t var1  = ((((adcT >> 3) - ((int32_t) _digT1 << 1))) * ((int32_t) _digT2)) >> 11;
+    int32_t var2  = (((((adcT >> 4) - ((int32_t) _digT1)) * ((adcT >> 4) - ((int32_t) _digT1))) >> 12) * ((int32_t) _digT3)) >> 14;
+    int32_t tFine = var1 + var2;
+    _temperature  = (tFine * 5 + 128) >> 8;
+
+    int64_t p1    = ((int64_t) tFine) - 128000;
+    int64_t p2    = p1 * p1 * (int64_t) _digP6;
+    p2            = p2 + ((p1 * (int64_t) _digP5) * 131072);
+    p2            = p2 + (((int64_t) _digP4) * 34359738368LL);
+    p1            = ((p1 * p1 * (int64_t) _digP3) >> 8) + ((p1 * (int64_t) _digP2) * 4096);
+    p1            = (((((int64_t) 1) << 47) + p1)) * ((int64_t) _digP1) >> 33;
+    if (p1 == 0) {
+        _pressure = 0;                                                              // (to avoid dividing by zero)
+    } else {
+        int64_t p = 1048576 - adcP;
+        p         = (((p * 2147483648LL) - p2) * 3125) / p1;
+        p1        = (((int64_t) _digP9) * (p >> 13) * (p >> 13)) >> 25;
+        p2        = (((int64_t) _digP8) * p) >> 19;
+        _pressure = (uint32_t) (((p + p1 + p2) >> 8) + (((int64_t) _digP7) * 16));
+    }
+
+    int32_t h     = (tFine - ((int32_t) 76800));
+    h             = (((((adcH << 14) - (((int32_t) _digH4) * 1048576) - (((int32_t) _digH5) * h)) + ((int32_t) 16384)) >> 15) *
+                     (((((((h * ((int32_t) _digH6)) >> 10) * (((h * ((int32_t) _digH3)) >> 11) + ((int32_t) 32768))) >> 10) +
+                        ((int32_t) 2097152)) * ((int32_t) _digH2) + 8192) >> 14));
+    h             = (h - (((((h >> 15) * (h >> 15)) >> 7) * ((int32_t) _digH1)) >> 4));
+    h             = (h < 0) ? 0 : h;
+    h             = (h > 419430400) ? 419430400 : h;
+    _humidity     = (uint32_t) (h >> 12);
+}
+
+/**************************************************************************/
+/*!
+ @brief  The altitude, from the pressure (as the Adafruit library's
+         readAltitude, but without reading the sensor again).
+*/
+/**************************************************************************/
+float ALTAIR_BME280::altitude( float seaLevelhPa )
+{
+    return 44330.f * (1.f - pow(pressure() / 100.f / seaLevelhPa, 0.1903f));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Read consecutive registers, in one transaction (with a repeated
+         start after the register address).
+*/
+/**************************************************************************/
+bool ALTAIR_BME280::readRegisters( uint8_t  reg      ,
+                                   uint8_t* bytes    ,
+                                   uint8_t  numBytes  )
+{
+    _stats.busBytes += 2 + 1 + numBytes;
+    if (!ALTAIR_HAL::i2cWrite(_address, &reg, 1, false)) return false;
+    return ALTAIR_HAL::i2cRead(_address, bytes, numBytes) == numBytes;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write one register.
+*/
+/**************************************************************************/
+bool ALTAIR_BME280::writeRegister( uint8_t reg   ,
+                                   uint8_t value  )
+{
+    uint8_t bytes[2] = { reg, value };
+    _stats.busBytes += 3;
+    return ALTAIR_HAL::i2cWrite(_address, bytes, 2);
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the sampling statistics.
+*/
+/**************************************************************************/
+void ALTAIR_BME280::printStats( const char* name )
+{
+    Serial.print(F("BME280 (")); Serial.print(name); Serial.println(F(") statistics:"));
+    Serial.print(F("   samples good/not ready/failed: ")); Serial.print(_stats.samples); Serial.print(F("/"));
+    Serial.print(_stats.notReady);                          Serial.print(F("/"));        Serial.println(_stats.failedSamples);
+    Serial.print(F("   I2C bus bytes: "));                  Serial.println(_stats.busBytes);
+    Serial.print(F("   last sample age (ms): "));           Serial.println(ALTAIR_HAL::clockMillis() - _sampleMillis);
+}
+#endif
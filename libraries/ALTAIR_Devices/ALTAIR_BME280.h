@@ -0,0 +1,133 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_BME280.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for each of ALTAIR's three Adafruit BME280
+    pressure/temp/humidity sensors, read over I2C via the HAL.
+
+    Rather than reading the temperature, pressure, and humidity each
+    separately when they are asked for (as the Adafruit library does,
+    which reads the temperature again for each of the other two, and so
+    takes 5 register reads of each sensor per telemetry frame), sample()
+    reads all 8 of the sensor's data registers in one burst (as the
+    datasheet recommends, so that they are all from the same measurement),
+    runs the compensation (the datasheet's integer formulas, with the
+    sensor's own calibration data, which is read just once, by begin())
+    once, and keeps the results, with when they were sampled.  Everything
+    else then reads the kept results, without any bus traffic.
+
+    The sensor runs in normal mode (measuring continuously, with 16x
+    oversampling and no filter, as the Adafruit library's defaults), so a
+    sample is always of its latest measurement.  A sample that finds no
+    measurement yet keeps the previous results; one that is not
+    acknowledged (e.g. with the balloon valve's connector pulled out, by a
+    cutdown) sets them all to zero, as before.
+
+    This file does not depend upon the Arduino libraries (other than via
+    the HAL), so that the sensor can also be read from a simulated bus on
+    a host computer (see tools/ALTAIRBME280Bench.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_BME280_h
+#define   ALTAIR_BME280_h
+
+#include <ALTAIR_HAL.h>
+#include "ALTAIR_I2CBus.h"
+
+#define   BME280_I2CADDRESS               0x77
+#define   BME280_I2CADDRESS_ALT           0x76
+#define   BME280_CHIP_ID                  0x60
+
+#define   BME280_REG_CALIB_TP             0x88          // dig_T1 to dig_P9, and then dig_H1 (26 bytes)
+#define   BME280_REG_CHIP_ID              0xD0
+#define   BME280_REG_RESET                0xE0
+#define   BME280_REG_CALIB_H              0xE1          // dig_H2 to dig_H6 (7 bytes)
+#define   BME280_REG_CTRL_HUM             0xF2
+#define   BME280_REG_STATUS               0xF3
+#define   BME280_REG_CTRL_MEAS            0xF4
+#define   BME280_REG_CONFIG               0xF5
+#define   BME280_REG_DATA                 0xF7          // pressure, temperature, and humidity (8 bytes)
+
+#define   BME280_CALIB_TP_LENGTH            26
+#define   BME280_CALIB_H_LENGTH              7
+#define   BME280_DATA_LENGTH                 8
+#define   BME280_RESET_COMMAND            0xB6
+#define   BME280_STATUS_IM_UPDATE         0x01          // (the calibration data is being copied)
+#define   BME280_CTRL_HUM_X16             0x05
+#define   BME280_CTRL_MEAS_X16_NORMAL     0xB7          // temperature and pressure x16, normal mode
+#define   BME280_CONFIG_STANDBY_0_5       0x00          // 0.5 ms standby, no filter
+#define   BME280_SKIPPED_TP            0x80000          // (what the data registers hold before the first measurement)
+#define   BME280_SKIPPED_H              0x8000
+
+struct    ALTAIR_BME280Stats {
+    unsigned long       samples                                             ;
+    unsigned long       notReady                                            ;  // (no measurement yet)
+    unsigned long       failedSamples                                       ;  // not acknowledged, or short
+    unsigned long       busBytes                                            ;  // on the I2C bus, including the address bytes
+};
+
+class     ALTAIR_BME280 : public ALTAIR_I2CDevice {
+  public:
+
+    ALTAIR_BME280(                                                          ) ;
+
+    bool                begin(          uint8_t               address  = BME280_I2CADDRESS ) ;   // Reset, calibrate, and start it measuring.
+    virtual bool        sample(                                                     ) ;   // Burst-read the latest measurement (e.g. when run by
+                                                                                          //    the I2C bus manager).  False if there was none.
+
+    float               temperature(                                                ) { return _temperature / 100.f       ; }   // in degrees C
+    float               pressure(                                                   ) { return _pressure / 256.f          ; }   // in Pa
+    float               humidity(                                                   ) { return _humidity / 1024.f         ; }   // in %
+    float               altitude(       float                 seaLevelhPa           ) ;   // in m
+    int32_t             rawTemperature(                                             ) { return _temperature               ; }   // in 0.01 degrees C
+    uint32_t            rawPressure(                                                ) { return _pressure                  ; }   // in 1/256 Pa
+    uint32_t            rawHumidity(                                                ) { return _humidity                  ; }   // in 1/1024 %
+
+    bool                valid(                                                      ) { return _valid                     ; }   // (false until sampled, or after a failed sample)
+    unsigned long       sampleMillis(                                               ) { return _sampleMillis              ; }   // when last sampled
+    bool                isFresh(        unsigned long         maxAgeMillis          ) { return _valid && ALTAIR_HAL::clockMillis() - _sampleMillis <= maxAgeMillis ; }
+
+    void                compensate(     int32_t               adcT                ,       // (The compensation, on its own.)
+                                        int32_t               adcP                ,
+                                        int32_t               adcH                  ) ;
+    void                setCalibration( const uint8_t*        calibTP             ,       // (As read from the calibration registers.)
+                                        const uint8_t*        calibH                ) ;
+
+    const ALTAIR_BME280Stats* stats(                                                ) { return &_stats                    ; }
+#ifdef    ARDUINO
+    void                printStats(     const char*           name                  ) ;
+#endif
+
+  private:
+    bool                readRegisters(  uint8_t               reg                 ,
+                                        uint8_t*              bytes               ,
+                                        uint8_t               numBytes              ) ;
+    bool                writeRegister(  uint8_t               reg                 ,
+                                        uint8_t               value                 ) ;
+
+    uint8_t             _address                                                    ;
+    uint16_t            _digT1                                                      ;
+    int16_t             _digT2, _digT3                                              ;
+    uint16_t            _digP1                                                      ;
+    int16_t             _digP2, _digP3, _digP4, _digP5, _digP6, _digP7, _digP8, _digP9 ;
+    uint8_t             _digH1, _digH3                                              ;
+    int16_t             _digH2, _digH4, _digH5                                      ;
+    int8_t              _digH6                                                      ;
+    int32_t             _temperature                                                ;
+    uint32_t            _pressure                                                   ;
+    uint32_t            _humidity                                                   ;
+    bool                _valid                                                      ;
+    unsigned long       _sampleMillis                                               ;
+    ALTAIR_BME280Stats  _stats                                                      ;
+};
+
+#endif    //   ifndef ALTAIR_BME280_h
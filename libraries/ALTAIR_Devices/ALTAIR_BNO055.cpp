@@ -46,6 +46,7 @@ ALTAIR_BNO055::ALTAIR_BNO055(                                   ) :
 uint8_t ALTAIR_BNO055::typeAndHealth(                           )
 {
   uint8_t system_status, self_test_results, system_error;
+  ALTAIR_HAL::i2cFlush();
   _theBNO055.getSystemStatus(&system_status, &self_test_results, &system_error);
   if (system_error == 0) {
        return ((uint8_t) bno055_healthy);
@@ -67,7 +68,7 @@ void ALTAIR_BNO055::initialize(                                 )
         Serial.println(F("Ooops, no BNO055 detected ... Check your wiring or I2C ADDR!"));
         while(1);
     }
-    delay(1000);    // is this necessary? -- why is this here??? -- I don't remember why!!!
+    ALTAIR_HAL::clockDelay(1000);    // is this necessary? -- why is this here??? -- I don't remember why!!!
     _theBNO055.setExtCrystalUse(true);
 }
 
@@ -80,6 +81,7 @@ void ALTAIR_BNO055::printInfo(                                  )
 {
     /* Get a new sensor event */ 
     sensors_event_t event; 
+    ALTAIR_HAL::i2cFlush();
     _theBNO055.getEvent(&event);
   
     /* Display the floating point data */
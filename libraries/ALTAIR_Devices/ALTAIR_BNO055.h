@@ -19,6 +19,7 @@
 #define   ALTAIR_BNO055_h
 
 #include "ALTAIR_OrientSensor.h"
+#include <ALTAIR_HAL.h>
 #include <Adafruit_BNO055.h>
 
 #define   DEFAULT_BNO055_ADAFRUITID   55
@@ -32,7 +33,8 @@ class ALTAIR_BNO055 : public ALTAIR_OrientSensor {
     Adafruit_BNO055*  theBNO055(                            ) { return                    &_theBNO055                 ; }
 
     virtual void      initialize(                           )                                                         ;
-            void      update(                               ) { _theBNO055.getEvent(      &_lastEvent                                      ); 
+            void      update(                               ) { ALTAIR_HAL::i2cFlush(     ); // (as the Adafruit library uses Wire: see ALTAIR_HAL.h)
+                                                                _theBNO055.getEvent(      &_lastEvent                                      ); 
                                                                 _accelerations = _theBNO055.getVector(Adafruit_BNO055::VECTOR_ACCELEROMETER); }
             void      printInfo(                            )                                                         ;
 
@@ -42,7 +44,7 @@ class ALTAIR_BNO055 : public ALTAIR_OrientSensor {
     int16_t            yaw(                                 ) { return  convertFloatToInt16(_lastEvent.orientation.x ); }  // *NOT* _lastEvent.orientation.z (Adafruit docs are *wrong*!!!)
     int16_t            roll(                                ) { return  convertFloatToInt16(_lastEvent.orientation.y ); }  // *NOT* _lastEvent.orientation.x (Adafruit docs are *wrong*!!!)
     int16_t            pitch(                               ) { return  convertFloatToInt16(_lastEvent.orientation.z ); }  // *NOT* _lastEvent.orientation.y (Adafruit docs are *wrong*!!!) 
-    int8_t             temperature(                         ) { return  _theBNO055.getTemp(                          ); }
+    int8_t             temperature(                         ) { ALTAIR_HAL::i2cFlush(); return _theBNO055.getTemp(           ); }
     uint8_t            typeAndHealth(                       )                                                         ;
 
     sensors_event_t    lastEvent(                           ) { return                      _lastEvent                ; }
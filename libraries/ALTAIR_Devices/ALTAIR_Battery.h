@@ -28,6 +28,7 @@
 #define   ALTAIR_BATTERY_h
 
 #include "Arduino.h"
+#include <ALTAIR_HAL.h>
 
 #define   ALTAIR_GENOPSBAT_VMON_PIN                    A3 
 #define   ALTAIR_PROPBAT_VMON_PIN                      A4  
@@ -39,7 +40,7 @@ class ALTAIR_Battery {
 
     ALTAIR_Battery(              byte   adcPin  ) : _adcPin( adcPin ) { }
 
-    float           readVoltage(                )                     { return analogRead(_adcPin) * ALTAIRBAT_VOLTSPERADU / ALTAIRBAT_VOLTAGEDIVIDER ; }
+    float           readVoltage(                )                     { return ALTAIR_HAL::adcRead(_adcPin) * ALTAIRBAT_VOLTSPERADU / ALTAIRBAT_VOLTAGEDIVIDER ; }
 
   private:
     byte           _adcPin                       ;
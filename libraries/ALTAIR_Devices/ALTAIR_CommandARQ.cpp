@@ -0,0 +1,316 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_CommandARQ.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    These are the classes for the reliable delivery of the commands sent
+    up to ALTAIR (see ALTAIR_CommandARQ.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_CommandARQ.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_CommandReceiver::ALTAIR_CommandReceiver(                      ) :
+    _historyHead(                                                   0 ) ,
+    _historyCount(                                                  0 ) ,
+    _recentCount(                                                   0 )
+{
+}
+
+/**************************************************************************/
+/*!
+ @brief  A command is a duplicate if an identical one with the same sequence
+         number was accepted within COMMAND_SEQUENCE_WINDOW.  (A command
+         with the same sequence number but different contents is new: the
+         ground station has restarted its count.)  Commands that have no
+         sequence number fall back on an identical one having been accepted
+         within UNSEQUENCED_COMMAND_WINDOW.
+*/
+/**************************************************************************/
+bool ALTAIR_CommandReceiver::isDuplicate( byte          type      ,
+                                          byte          argument  ,
+                                          uint8_t       sequence  ,
+                                          unsigned long now        )
+{
+    unsigned long window = (sequence == ARQ_NO_SEQUENCE) ? UNSEQUENCED_COMMAND_WINDOW : COMMAND_SEQUENCE_WINDOW;
+    for (uint8_t i = 0; i < _historyCount; ++i) {
+        const Accepted& previous = _history[i];
+        if (previous.sequence == sequence && previous.type == type && previous.argument == argument &&
+            (now - previous.millis) < window) return true;
+    }
+    return false;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Remember an accepted command, overwriting the oldest one.
+*/
+/**************************************************************************/
+void ALTAIR_CommandReceiver::remember( byte          type      ,
+                                       byte          argument  ,
+                                       uint8_t       sequence  ,
+                                       unsigned long now        )
+{
+    Accepted& accepted = _history[_historyHead];
+    accepted.type      = type;
+    accepted.argument  = argument;
+    accepted.sequence  = sequence;
+    accepted.millis    = now;
+    if (++_historyHead == COMMAND_HISTORY_LENGTH) _historyHead = 0;
+    if (_historyCount < COMMAND_HISTORY_LENGTH) ++_historyCount;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Forget an accepted command (which was then dropped), so that the
+         next copy of it is accepted.  (A zero type is never a command.)
+*/
+/**************************************************************************/
+void ALTAIR_CommandReceiver::forget( byte          type      ,
+                                     byte          argument  ,
+                                     uint8_t       sequence   )
+{
+    for (uint8_t i = 0; i < _historyCount; ++i) {
+        Accepted& previous = _history[i];
+        if (previous.sequence == sequence && previous.type == type && previous.argument == argument) previous.type = 0;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Put a sequence number at the head of the list to acknowledge
+         (moving it there, if it is already in the list).
+*/
+/**************************************************************************/
+void ALTAIR_CommandReceiver::acknowledge( uint8_t sequence )
+{
+    if (sequence == ARQ_NO_SEQUENCE) return;
+    uint8_t i = 0;
+    while (i < _recentCount && _recent[i] != sequence) ++i;
+    if (i == _recentCount && _recentCount < COMMAND_ACK_COUNT) ++_recentCount;
+    if (i == COMMAND_ACK_COUNT) --i;                                        // (the oldest falls off the end)
+    for (; i > 0; --i) _recent[i] = _recent[i - 1];
+    _recent[0] = sequence;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Build the acknowledgement frame, of the sequence numbers most
+         recently received (newest first).
+*/
+/**************************************************************************/
+uint8_t ALTAIR_CommandReceiver::acks( byte* frame )
+{
+    if (_recentCount == 0) return 0;
+    frame[0] = COMMAND_ACK_BYTE;
+    frame[1] = _recentCount;
+    memcpy(&frame[2], _recent, _recentCount);
+    return 2 + _recentCount;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_CommandSender::ALTAIR_CommandSender(                          ) :
+    _count(                                                         0 ) ,
+    _srtt(                                                          0 ) ,
+    _rttvar(                                                        0 ) ,
+    _rto(                                         COMMAND_INITIAL_RTO )
+{
+    resetStats();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_CommandSender::resetStats(                               )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Queue a command, to be sent (by nextToSend) right away, and then
+         again until it is acknowledged.
+*/
+/**************************************************************************/
+bool ALTAIR_CommandSender::queue( byte          type      ,
+                                  byte          argument  ,
+                                  uint8_t       sequence  ,
+                                  unsigned long now        )
+{
+    if (_count == COMMAND_WINDOW) {
+        ++_stats.refused;
+        return false;
+    }
+    Slot& slot        = _slots[_count++];
+    slot.type         = type;
+    slot.argument     = argument;
+    slot.sequence     = sequence;
+    slot.tries        = 0;
+    slot.queuedMillis = now;
+    slot.firstMillis  = now;
+    slot.dueMillis    = now;
+    ++_stats.queued;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The oldest command that is due to be sent: it is taken to have
+         been sent now, and its timer is set, for the retransmit timeout,
+         doubled for each try that it has already had.
+*/
+/**************************************************************************/
+bool ALTAIR_CommandSender::nextToSend( unsigned long now       ,
+                                       byte&         type      ,
+                                       byte&         argument  ,
+                                       uint8_t&      sequence   )
+{
+    for (uint8_t i = 0; i < _count; ++i) {
+        Slot& slot = _slots[i];
+        if ((long) (now - slot.dueMillis) < 0) continue;
+        if (slot.tries == 0) slot.firstMillis = now;
+        else                 ++_stats.retransmissions;
+        unsigned long timeout = _rto << (slot.tries < 4 ? slot.tries : 4);
+        if (timeout > COMMAND_MAX_RTO) timeout = COMMAND_MAX_RTO;
+        ++slot.tries;
+        slot.dueMillis = now + timeout;
+        type           = slot.type;
+        argument       = slot.argument;
+        sequence       = slot.sequence;
+        ++_stats.sent;
+        return true;
+    }
+    return false;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A sequence number was acknowledged: the command is done with (and,
+         if it was only sent once, its round trip is measured).
+*/
+/**************************************************************************/
+bool ALTAIR_CommandSender::acked( uint8_t       sequence  ,
+                                  unsigned long now        )
+{
+    for (uint8_t i = 0; i < _count; ++i) {
+        Slot& slot = _slots[i];
+        if (slot.sequence != sequence || slot.tries == 0) continue;
+        unsigned long latency      = now - slot.queuedMillis;
+        _stats.lastLatencyMillis   = latency;
+        _stats.totalLatencyMillis += latency;
+        if (latency > _stats.maxLatencyMillis) _stats.maxLatencyMillis = latency;
+        ++_stats.acked;
+        if (slot.tries == 1) measured(now - slot.firstMillis);             // (with a retry, it isn't known which try was acknowledged)
+        remove(i);
+        return true;
+    }
+    ++_stats.staleAcks;
+    return false;
+}
+
+/**************************************************************************/
+/*!
+ @brief  An acknowledgement frame's sequence numbers.
+*/
+/**************************************************************************/
+bool ALTAIR_CommandSender::ackFrame( const byte*   sequences  ,
+                                     uint8_t       count      ,
+                                     unsigned long now         )
+{
+    bool any = false;
+    for (uint8_t i = 0; i < count; ++i) any |= acked(sequences[i], now);
+    return any;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Give up on each command first sent COMMAND_GIVE_UP_MILLIS ago.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_CommandSender::expire( unsigned long now )
+{
+    uint8_t expired = 0;
+    for (uint8_t i = 0; i < _count; ) {
+        if (_slots[i].tries > 0 && now - _slots[i].firstMillis >= COMMAND_GIVE_UP_MILLIS) {
+            remove(i);
+            ++_stats.givenUp;
+            ++expired;
+        } else {
+            ++i;
+        }
+    }
+    return expired;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Remove a command, keeping the rest in the order queued.
+*/
+/**************************************************************************/
+void ALTAIR_CommandSender::remove( uint8_t i )
+{
+    for (--_count; i < _count; ++i) _slots[i] = _slots[i + 1];
+}
+
+/**************************************************************************/
+/*!
+ @brief  A round trip was measured: update the smoothed round-trip time
+         and its mean deviation, and the retransmit timeout (which is
+         their sum, with the deviation weighted by 4, as in RFC 6298).
+*/
+/**************************************************************************/
+void ALTAIR_CommandSender::measured( unsigned long rtt )
+{
+    if (_srtt == 0) {
+        _srtt   = rtt << 3;
+        _rttvar = rtt << 1;
+    } else {
+        long delta = (long) rtt - (long) (_srtt >> 3);
+        _srtt     += delta;
+        if (delta < 0) delta = -delta;
+        _rttvar   += delta - (long) (_rttvar >> 2);
+    }
+    _rto = (_srtt >> 3) + _rttvar;
+    if (_rto < COMMAND_MIN_RTO) _rto = COMMAND_MIN_RTO;
+    if (_rto > COMMAND_MAX_RTO) _rto = COMMAND_MAX_RTO;
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the statistics, as a '#' comment line
+         (as the ground station's other output is CSV).
+*/
+/**************************************************************************/
+void ALTAIR_CommandSender::printStats(                               )
+{
+    Serial.print(F("#commands,queued "));   Serial.print(_stats.queued);
+    Serial.print(F(",sent "));              Serial.print(_stats.sent);
+    Serial.print(F(",retransmitted "));     Serial.print(_stats.retransmissions);
+    Serial.print(F(",acked "));             Serial.print(_stats.acked);
+    Serial.print(F(",given up "));          Serial.print(_stats.givenUp);
+    Serial.print(F(",in flight "));         Serial.print(_count);
+    Serial.print(F(",latency mean/max (ms) ")); Serial.print(_stats.acked ? _stats.totalLatencyMillis / _stats.acked : 0);
+    Serial.print(F("/"));                   Serial.print(_stats.maxLatencyMillis);
+    Serial.print(F(",srtt/rto (ms) "));     Serial.print(srtt()); Serial.print(F("/")); Serial.println(_rto);
+}
+#endif
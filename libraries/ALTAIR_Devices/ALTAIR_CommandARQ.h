@@ -0,0 +1,186 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_CommandARQ.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    These are the classes for the reliable delivery of the commands that a
+    ground station sends up to ALTAIR (a selective-repeat ARQ).
+
+    Each command already carries a sequence number (see
+    ALTAIR_GenTelInt::sendCommandToALTAIR).  On ALTAIR, the command
+    router hands each command that arrives to an ALTAIR_CommandReceiver,
+    which decides whether it is new or a copy of one that has already
+    been accepted (so that each command is executed exactly once, however
+    many times it is sent, and via however many radios), and which keeps
+    a list of the sequence numbers most recently received.  Once the
+    command has been executed, that list is sent back down, via the radio
+    that it arrived on, in a command acknowledgement frame:
+
+      [COMMAND_ACK_BYTE] [# of sequence numbers] [sequence number ...]
+
+    (newest first).  Each acknowledgement repeats the previous few, so a
+    lost one is made up for by the next.
+
+    On the ground, an ALTAIR_CommandSender keeps each command that has
+    been queued until it is acknowledged (which the downlink decoder
+    reports), with up to COMMAND_WINDOW of them in flight at once.  Each
+    command is sent again whenever its retransmit timer runs out: the
+    timeout is set from the measured round-trip time (as TCP does, from
+    the commands that were acknowledged after being sent just once), and
+    doubles with each try.  A command that is still not acknowledged
+    COMMAND_GIVE_UP_MILLIS after it was first sent is given up on (which
+    is well within COMMAND_SEQUENCE_WINDOW, so that ALTAIR still
+    recognizes every copy of it).  The commands in flight are each
+    acknowledged, and sent again, individually, so one lost command does
+    not hold up the others (and they are executed as they arrive, as the
+    command router reorders them by priority anyway).
+
+    This file does not depend upon the Arduino libraries, so that the
+    ARQ can also be run over a simulated lossy link on a host computer
+    (see tools/ALTAIRCommandARQSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_CommandARQ_h
+#define   ALTAIR_CommandARQ_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   COMMAND_ACK_BYTE            0xF7          // (below the fan-out sequence byte, FANOUT_SEQUENCE_BYTE)
+#define   COMMAND_ACK_COUNT              4          // sequence numbers in each acknowledgement
+#define   ARQ_NO_SEQUENCE                0          // (= NO_COMMAND_SEQUENCE in ALTAIR_GenTelInt.h)
+
+#define   COMMAND_HISTORY_LENGTH        16          // # of recently-accepted commands that are remembered, for deduplication
+#define   COMMAND_SEQUENCE_WINDOW    30000          // in milliseconds: how long a sequence number is remembered (it wraps after 255 commands)
+#define   UNSEQUENCED_COMMAND_WINDOW  2000          // in milliseconds: identical commands without a sequence number closer together than this are duplicates
+
+#define   COMMAND_WINDOW                 4          // commands in flight at once
+#define   COMMAND_INITIAL_RTO         3000          // in milliseconds: the retransmit timeout, before any round trip has been measured
+#define   COMMAND_MIN_RTO             1000
+#define   COMMAND_MAX_RTO             8000
+#define   COMMAND_GIVE_UP_MILLIS     20000          // from when a command was first sent
+
+/**************************************************************************/
+/*!
+    On ALTAIR: which commands are new, and which sequence numbers to
+    acknowledge.
+*/
+/**************************************************************************/
+class     ALTAIR_CommandReceiver {
+  public:
+
+    ALTAIR_CommandReceiver(                                                 ) ;
+
+    bool                isDuplicate(    byte                  type                ,       // Has an identical command (with the same
+                                        byte                  argument            ,       //    sequence #) already been accepted?
+                                        uint8_t               sequence            ,
+                                        unsigned long         now                   ) ;
+    void                remember(       byte                  type                ,       // (It has been accepted.)
+                                        byte                  argument            ,
+                                        uint8_t               sequence            ,
+                                        unsigned long         now                   ) ;
+    void                forget(         byte                  type                ,       // (It was accepted, but then dropped before it
+                                        byte                  argument            ,       //    was executed, so a copy of it is welcome.)
+                                        uint8_t               sequence              ) ;
+    void                acknowledge(    uint8_t               sequence              ) ;   // (It has been executed, or is a copy of one that was.)
+    uint8_t             acks(           byte*                 frame                 ) ;   // Build the acknowledgement frame (of at most
+                                                                                          //    2 + COMMAND_ACK_COUNT bytes).  Returns its
+                                                                                          //    length (0 if nothing has been received).
+  private:
+    struct Accepted {
+        byte            type                                                        ;
+        byte            argument                                                    ;
+        uint8_t         sequence                                                    ;
+        unsigned long   millis                                                      ;
+    };
+
+    Accepted            _history[COMMAND_HISTORY_LENGTH]                            ;  // a ring of the most recently accepted commands
+    uint8_t             _historyHead                                                ;
+    uint8_t             _historyCount                                               ;
+    uint8_t             _recent[COMMAND_ACK_COUNT]                                  ;  // the sequence numbers most recently received, newest first
+    uint8_t             _recentCount                                                ;
+};
+
+struct    ALTAIR_CommandSenderStats {
+    unsigned long       queued                                              ;
+    unsigned long       refused                                             ;  // (the window was full)
+    unsigned long       sent                                                ;  // (including the retransmissions)
+    unsigned long       retransmissions                                     ;
+    unsigned long       acked                                               ;
+    unsigned long       givenUp                                             ;
+    unsigned long       staleAcks                                           ;  // of sequence numbers not (or no longer) in flight
+    unsigned long       lastLatencyMillis                                   ;  // from when a command was queued, until it was acknowledged
+    unsigned long       maxLatencyMillis                                    ;
+    unsigned long       totalLatencyMillis                                  ;  // divide by acked to get the mean
+};
+
+/**************************************************************************/
+/*!
+    On the ground: the commands in flight, and their retransmit timers.
+*/
+/**************************************************************************/
+class     ALTAIR_CommandSender {
+  public:
+
+    ALTAIR_CommandSender(                                                   ) ;
+
+    bool                queue(          byte                  type                ,       // Returns false if the window is full.
+                                        byte                  argument            ,
+                                        uint8_t               sequence            ,
+                                        unsigned long         now                   ) ;
+    bool                nextToSend(     unsigned long         now                 ,       // The next command that is due to be sent (a new
+                                        byte&                 type                ,       //    one, or one whose timer has run out), if
+                                        byte&                 argument            ,       //    any, which is then taken to have been sent.
+                                        uint8_t&              sequence              ) ;
+    bool                acked(          uint8_t               sequence            ,       // Returns true if it was in flight.
+                                        unsigned long         now                   ) ;
+    bool                ackFrame(       const byte*           sequences           ,       // (The contents of an acknowledgement frame.)
+                                        uint8_t               count               ,       //    Returns true if any were in flight.
+                                        unsigned long         now                   ) ;
+    uint8_t             expire(         unsigned long         now                   ) ;   // Give up on the commands that are too old.
+                                                                                          //    Returns the # given up on.
+    uint8_t             inFlight(                                                   ) { return _count                     ; }
+    bool                full(                                                       ) { return _count == COMMAND_WINDOW   ; }
+    unsigned long       rto(                                                        ) { return _rto                       ; }   // in milliseconds
+    unsigned long       srtt(                                                       ) { return _srtt >> 3                 ; }   // (0 until measured)
+
+    const ALTAIR_CommandSenderStats* stats(                                         ) { return &_stats                    ; }
+    void                resetStats(                                                 ) ;
+#ifdef    ARDUINO
+    void                printStats(                                                 ) ;
+#endif
+
+  private:
+    struct Slot {
+        byte            type                                                        ;
+        byte            argument                                                    ;
+        uint8_t         sequence                                                    ;
+        uint8_t         tries                                                       ;  // (0 until it is first sent)
+        unsigned long   queuedMillis                                                ;
+        unsigned long   firstMillis                                                 ;  // when it was first sent
+        unsigned long   dueMillis                                                   ;  // when it is next to be sent
+    };
+
+    void                remove(         uint8_t               i                     ) ;
+    void                measured(       unsigned long         rtt                   ) ;
+
+    Slot                _slots[COMMAND_WINDOW]                                      ;  // in the order queued
+    uint8_t             _count                                                      ;
+    unsigned long       _srtt                                                       ;  // the smoothed round-trip time, in eighths of a millisecond
+    unsigned long       _rttvar                                                     ;  // its mean deviation, in quarters of a millisecond
+    unsigned long       _rto                                                        ;
+    ALTAIR_CommandSenderStats _stats                                                ;
+};
+#endif    //   ifndef ALTAIR_CommandARQ_h
@@ -0,0 +1,267 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_CommandRouter.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR command router.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include "ALTAIR_CommandRouter.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.  The handler is called (by dispatchAll) to execute
+         each command.
+*/
+/**************************************************************************/
+ALTAIR_CommandRouter::ALTAIR_CommandRouter( ALTAIR_CommandHandler handler ) :
+    _handler(                                                 handler ) ,
+    _sourceCount(                                                   0 ) ,
+    _linkQuality(                                                NULL ) ,
+    _count(                                                         0 ) ,
+    _ackPending(                                                    0 ) ,
+    _nextOrder(                                                     0 )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Add a radio to be read by gather().
+*/
+/**************************************************************************/
+bool ALTAIR_CommandRouter::addSource( ALTAIR_GenTelInt* radio )
+{
+    if (radio == NULL || _sourceCount >= MAX_COMMAND_SOURCES) {
+        Serial.println(F("Cannot add another command source radio"));
+        return false;
+    }
+    _sources[_sourceCount++] = radio;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Read (at most) one command from each source radio, in one pass,
+         and submit each one.  (As before, a command with a zero type or
+         argument is ignored.)  Heartbeats only tell the link-quality
+         tracker that the link is alive, and go no further.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_CommandRouter::gather( unsigned long currentMillis )
+{
+    uint8_t accepted = 0;
+    for (uint8_t i = 0; i < _sourceCount; ++i) {
+        byte command[COMMAND_LENGTH] = { 0, 0, NO_COMMAND_SEQUENCE };
+        _sources[i]->readALTAIRInfo( command );
+        if (command[0] == 0 || command[1] == 0) continue;
+        ++_stats.received[i];
+        if (_linkQuality) _linkQuality->commandHeard(_sources[i]->radioType(), currentMillis);
+        if (command[0] == HEARTBEAT_COMMAND) {
+            ++_stats.heartbeats;
+            continue;
+        }
+        if (submit(command[0], command[1], command[2], i, currentMillis)) ++accepted;
+    }
+    return accepted;
+}
+
+#endif
+
+/**************************************************************************/
+/*!
+ @brief  Discard the command if it is a copy of one that has already been
+         accepted (acknowledging it again, unless it is still pending, as
+         the acknowledgement must have been lost); otherwise, insert it into
+         the queue behind every pending command of the same or higher
+         priority.  If the queue is full, the
+         newest of the lowest priority commands is dropped to make room
+         (and if that would be this command, it is dropped instead).
+*/
+/**************************************************************************/
+bool ALTAIR_CommandRouter::submit( byte          type           ,
+                                   byte          argument       ,
+                                   uint8_t       sequence       ,
+                                   int8_t        source         ,
+                                   unsigned long receivedMillis  )
+{
+    ALTAIR_Command command;
+    command.type           = type;
+    command.argument       = argument;
+    command.sequence       = sequence;
+    command.priority       = priority(type);
+    command.source         = source;
+    command.receivedMillis = receivedMillis;
+    command.order          = _nextOrder++;
+    if (source < 0) ++_stats.submitted;
+
+    if (_receiver.isDuplicate(type, argument, sequence, receivedMillis)) {
+        ++_stats.duplicates;
+        bool pending = false;
+        for (uint8_t i = 0; i < _count; ++i) pending |= (_queue[i].sequence == sequence);
+        if (!pending) acknowledge(sequence, source);
+        return false;
+    }
+
+    uint8_t position = 0;
+    while (position < _count && _queue[position].priority <= command.priority) ++position;
+    if (_count == COMMAND_QUEUE_LENGTH) {
+        ++_stats.dropped;
+        if (position == COMMAND_QUEUE_LENGTH) return false;
+        --_count;
+        const ALTAIR_Command& dropped = _queue[_count];
+        _receiver.forget(dropped.type, dropped.argument, dropped.sequence);   // (so that it is accepted when it is sent again)
+    }
+    for (uint8_t i = _count; i > position; --i) _queue[i] = _queue[i - 1];
+    _queue[position] = command;
+    ++_count;
+    _receiver.remember(type, argument, sequence, receivedMillis);
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Pop the highest priority pending command.
+*/
+/**************************************************************************/
+bool ALTAIR_CommandRouter::nextCommand( ALTAIR_Command& command )
+{
+    if (_count == 0) return false;
+    command = _queue[0];
+    for (uint8_t i = 1; i < _count; ++i) _queue[i - 1] = _queue[i];
+    --_count;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A command popped by nextCommand has been executed: acknowledge it.
+*/
+/**************************************************************************/
+void ALTAIR_CommandRouter::commandExecuted( const ALTAIR_Command& command )
+{
+    acknowledge(command.sequence, command.source);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Execute every pending command (via the handler), highest priority
+         first, and measure how long each one waited since it arrived.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_CommandRouter::dispatchAll( unsigned long currentMillis )
+{
+    uint8_t        executed = 0;
+    ALTAIR_Command command;
+    while (nextCommand(command)) {
+#ifdef    ARDUINO
+        Serial.print(sourceName(command.source)); Serial.print(F(" command[0] = ")); Serial.print(command.type, HEX);
+        Serial.print(F("  command[1] = ")); Serial.print(command.argument, HEX);
+        Serial.print(F("  sequence = "));   Serial.println(command.sequence);
+#endif
+        if (_handler) _handler(command.type, command.argument);
+        acknowledge(command.sequence, command.source);
+        unsigned long latency      = currentMillis - command.receivedMillis;
+        _stats.lastLatencyMillis   = latency;
+        _stats.totalLatencyMillis += latency;
+        if (latency > _stats.maxLatencyMillis) _stats.maxLatencyMillis = latency;
+        ++_stats.dispatched;
+        ++executed;
+    }
+    return executed;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The priority of a command type: shutting down all the propellers
+         first, then any other motor setting, and then everything else.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_CommandRouter::priority( byte type )
+{
+    switch (type) {
+        case 'x':
+        case 'X': return COMMAND_PRIORITY_SHUTDOWN;
+        case 's': return COMMAND_PRIORITY_MOTOR;
+        default:  return COMMAND_PRIORITY_OTHER;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Add a sequence number to the acknowledgements, and mark the radio
+         that it arrived on as having one to send.  (Commands without a
+         sequence number, or submitted directly, are not acknowledged.)
+*/
+/**************************************************************************/
+void ALTAIR_CommandRouter::acknowledge( uint8_t sequence ,
+                                        int8_t  source    )
+{
+    if (sequence == ARQ_NO_SEQUENCE || source < 0) return;
+    _receiver.acknowledge(sequence);
+    _ackPending |= (1 << source);
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Send the acknowledgement frame via each radio that has one to send
+         (and room for it right now, without waiting: otherwise, it is
+         sent next time).
+*/
+/**************************************************************************/
+uint8_t ALTAIR_CommandRouter::sendAcks(                            )
+{
+    byte    frame[2 + COMMAND_ACK_COUNT];
+    uint8_t length = _receiver.acks(frame);
+    uint8_t sent   = 0;
+    if (length == 0) return 0;
+    for (uint8_t i = 0; i < _sourceCount; ++i) {
+        if (!(_ackPending & (1 << i)) || _sources[i]->txRoom() < length) continue;
+        if (!_sources[i]->sendNonBlocking(frame, length)) continue;
+        _ackPending &= ~(1 << i);
+        ++_stats.acksSent;
+        ++sent;
+    }
+    return sent;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Return the name of the radio that a command arrived on.
+*/
+/**************************************************************************/
+const char* ALTAIR_CommandRouter::sourceName( int8_t source )
+{
+    if (source < 0 || source >= _sourceCount) return "Submitted";
+    return _sources[source]->radioName();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the command router statistics.
+*/
+/**************************************************************************/
+void ALTAIR_CommandRouter::printStats(                             )
+{
+    Serial.println(F("Command router statistics:"));
+    for (uint8_t i = 0; i < _sourceCount; ++i) {
+        Serial.print(F("   received via ")); Serial.print(_sources[i]->radioName()); Serial.print(F(": ")); Serial.println(_stats.received[i]);
+    }
+    Serial.print(F("   submitted directly: "));        Serial.println(_stats.submitted);
+    Serial.print(F("   heartbeats: "));                Serial.println(_stats.heartbeats);
+    Serial.print(F("   duplicates / dropped: "));      Serial.print(_stats.duplicates);    Serial.print(F(" / ")); Serial.println(_stats.dropped);
+    Serial.print(F("   dispatched / acks sent: "));    Serial.print(_stats.dispatched);    Serial.print(F(" / ")); Serial.println(_stats.acksSent);
+    Serial.print(F("   latency last/mean/max (ms): ")); Serial.print(_stats.lastLatencyMillis); Serial.print(F("/"));
+    Serial.print(_stats.dispatched ? _stats.totalLatencyMillis / _stats.dispatched : 0); Serial.print(F("/")); Serial.println(_stats.maxLatencyMillis);
+}
+#endif
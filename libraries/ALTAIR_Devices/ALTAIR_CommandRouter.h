@@ -0,0 +1,145 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_CommandRouter.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR command router, which is the single
+    path by which commands sent up from the ground stations are executed.
+    Each call to gather() reads (at most) one command from each of the
+    radios in one pass, and tags it with the radio that it arrived on.
+    Commands are deduplicated by their sequence number (since a ground
+    station may send the same command up via several radios, or send it
+    again), rather than by any timeout between them, so that no distinct
+    command is ever lost because another one arrived just before it.
+    Pending commands are then dispatched in priority order, so that a
+    shutdown ('x') is always executed before anything else.
+
+    Once a command has been executed (or a copy of one that was arrives),
+    its sequence number is acknowledged, by sendAcks(), back down via the
+    radio that it arrived on, so that the ground station stops sending it
+    (see ALTAIR_CommandARQ.h).  The deduplication is done by the same
+    ALTAIR_CommandReceiver, so that it can be exercised on a host computer.
+
+    Every command that arrives (including the heartbeats, which are
+    counted but never queued) is also reported to the link-quality
+    tracker, if one is set, as a sign that its radio's uplink is alive.
+
+    Commands can also be handed straight to submit(), e.g. from scripted
+    streams when the router is exercised on a host computer.  The reading
+    of the radios (gather(), sendAcks(), and the printouts) is only built
+    for the Arduino; the rest of this file does not depend upon the
+    Arduino libraries, so that the queueing, deduplication, and priority
+    order can be tested on a host computer (see
+    tools/ALTAIRCommandRouterTest.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_CommandRouter_h
+#define   ALTAIR_CommandRouter_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#include  "ALTAIR_GenTelInt.h"
+#else
+#include  <stdint.h>
+#include  <string.h>
+class     ALTAIR_GenTelInt;
+#endif
+#include  "ALTAIR_LinkQuality.h"
+#include  "ALTAIR_CommandARQ.h"
+
+#define   MAX_COMMAND_SOURCES              3
+#define   COMMAND_QUEUE_LENGTH             8
+
+#define   COMMAND_PRIORITY_SHUTDOWN        0        // (the lower the number, the sooner it is dispatched)
+#define   COMMAND_PRIORITY_MOTOR           1
+#define   COMMAND_PRIORITY_OTHER           2
+
+typedef   void   (*ALTAIR_CommandHandler)(      byte      type        ,
+                                                byte      argument      ) ;
+
+struct    ALTAIR_Command {
+    byte                type                                                ;
+    byte                argument                                            ;
+    uint8_t             sequence                                            ;  // NO_COMMAND_SEQUENCE if the ground station did not send one
+    uint8_t             priority                                            ;
+    int8_t              source                                              ;  // the index of the source radio (or -1 if submitted directly)
+    unsigned long       receivedMillis                                      ;
+    unsigned long       order                                               ;  // the arrival order (to keep commands of equal priority first-in, first-out)
+};
+
+struct    ALTAIR_CommandStats {
+    unsigned long       received[MAX_COMMAND_SOURCES]                       ;  // per source radio
+    unsigned long       submitted                                           ;  // directly, via submit()
+    unsigned long       heartbeats                                          ;  // (counted in received, but not queued)
+    unsigned long       duplicates                                          ;
+    unsigned long       dropped                                             ;  // because the queue was full of commands of equal or higher priority
+    unsigned long       dispatched                                          ;
+    unsigned long       acksSent                                            ;
+    unsigned long       lastLatencyMillis                                   ;  // from when a command was received, to when it was executed
+    unsigned long       maxLatencyMillis                                    ;
+    unsigned long       totalLatencyMillis                                  ;  // divide by dispatched to get the mean
+};
+
+class     ALTAIR_CommandRouter {
+  public:
+
+    ALTAIR_CommandRouter(               ALTAIR_CommandHandler handler               ) ;
+
+#ifdef    ARDUINO
+    bool                addSource(      ALTAIR_GenTelInt*     radio                 ) ;
+#endif
+    void                setLinkQuality( ALTAIR_LinkQuality*   linkQuality           ) { _linkQuality = linkQuality        ; }
+
+#ifdef    ARDUINO
+    uint8_t             gather(         unsigned long         currentMillis         ) ;   // Read a command from each source radio.  Returns the # accepted.
+#endif
+    bool                submit(         byte                  type                ,       // Deduplicate a command, and queue it by priority.
+                                        byte                  argument            ,       //    Returns false if it was a duplicate (or dropped).
+                                        uint8_t               sequence            ,
+                                        int8_t                source              ,
+                                        unsigned long         receivedMillis        ) ;
+    uint8_t             dispatchAll(    unsigned long         currentMillis         ) ;   // Execute every pending command, highest priority first.
+    bool                nextCommand(    ALTAIR_Command&       command               ) ;   // Or pop the highest priority pending command, to execute it yourself.
+    void                commandExecuted(const ALTAIR_Command& command               ) ;   //    (and then say that it has been executed).
+#ifdef    ARDUINO
+    uint8_t             sendAcks(                                                   ) ;   // Acknowledge the commands executed, via each radio that they
+                                                                                          //    arrived on.  Returns the # of acknowledgements sent.
+#endif
+
+    static uint8_t      priority(       byte                  type                  ) ;
+
+    uint8_t             pending(                                                    ) { return _count                     ; }
+    const ALTAIR_CommandStats* stats(                                               ) { return &_stats                    ; }
+    void                resetStats(                                                 ) { memset(&_stats, 0, sizeof(_stats)) ; }
+#ifdef    ARDUINO
+    void                printStats(                                                 ) ;
+#endif
+
+  private:
+    void                acknowledge(    uint8_t               sequence            ,
+                                        int8_t                source                ) ;
+#ifdef    ARDUINO
+    const char*         sourceName(     int8_t                source                ) ;
+#endif
+
+    ALTAIR_CommandHandler _handler                                                  ;
+    ALTAIR_GenTelInt*   _sources[MAX_COMMAND_SOURCES]                               ;
+    uint8_t             _sourceCount                                                ;
+    ALTAIR_LinkQuality* _linkQuality                                                ;  // (NULL if none)
+    ALTAIR_Command      _queue[COMMAND_QUEUE_LENGTH]                                ;  // sorted by priority, and then by arrival order
+    uint8_t             _count                                                      ;
+    ALTAIR_CommandReceiver _receiver                                                ;
+    uint8_t             _ackPending                                                 ;  // a bit for each source that has an acknowledgement to send
+    unsigned long       _nextOrder                                                  ;
+    ALTAIR_CommandStats _stats                                                      ;
+};
+
+#endif    //   ifndef ALTAIR_CommandRouter_h
@@ -11,7 +11,9 @@
     proportional to the current going through that line.  With no current,
     their output voltage is (V_in)/2 (where V_in = 5 V), and their output
     voltage increases or decreases by approximately 16 mV per ampere that
-    flows through the power line they surround.
+    flows through the power line they surround.  They are read by the
+    Arduino Micro, and set from its readings, either packed (in quarter-
+    amps, saturating at 31.75 A) or extended (in units of 10 mA).
 
     Justin Albert  jalbert@uvic.ca     began on 2 Sep. 2018
 
@@ -24,7 +26,12 @@
 #ifndef ALTAIR_CurrentSensor_h
 #define ALTAIR_CurrentSensor_h
 
-#include "Arduino.h"
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
 
 class ALTAIR_CurrentSensor {
   public:
@@ -33,6 +40,8 @@ class ALTAIR_CurrentSensor {
 
     float                     current(                  ) { return _current           ; }
     void                      setCurrent( float current ) {        _current = current ; }
+    void                      setFromPacked(   byte    packedCurrent ) { _current = 0.25 * (int8_t) packedCurrent ; }
+    void                      setFromExtended( int16_t centiAmps     ) { _current = 0.01 * centiAmps              ; }
 
   private:
     float                    _current                                                 ;    // in Amps
@@ -17,6 +17,7 @@
 
 #include "ALTAIR_DFRobotG6.h"
 #include "ALTAIR_UM7.h"
+#include "ALTAIR_GPSMonitor.h"
 
 
 /**************************************************************************/
@@ -28,7 +29,31 @@
 /**************************************************************************/
 bool       ALTAIR_DFRobotG6::getGPS(                       )
 {
-    return ALTAIR_UM7::getGPS( &_lat, &_lon, &_ele, &_time );
+    if (!ALTAIR_UM7::getGPS( &_lat, &_lon, &_ele, &_time )) return false;
+    _fixMillis = ALTAIR_HAL::clockMillis();
+    _hasFix    = true;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The age of the fix, in ms (GPS_NO_FIX_AGE if there has not been
+         one yet).
+*/
+/**************************************************************************/
+uint32_t   ALTAIR_DFRobotG6::age(                          )
+{
+    return _hasFix ? ALTAIR_HAL::clockMillis() - _fixMillis : GPS_NO_FIX_AGE;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Healthy if there is a fix that is not stale.
+*/
+/**************************************************************************/
+uint8_t    ALTAIR_DFRobotG6::typeAndHealth(                )
+{
+    return (age() <= GPS_STALE_MILLIS) ? (uint8_t) dfrobotg6_healthy : (uint8_t) dfrobotg6_unhealthy;
 }
 
 /**************************************************************************/
@@ -20,21 +20,22 @@
 
 #include "Arduino.h"
 #include "ALTAIR_GPSSensor.h"
+#include <ALTAIR_HAL.h>
 
 class ALTAIR_DFRobotG6 : public ALTAIR_GPSSensor {
   public:
 
-    ALTAIR_DFRobotG6(                 )  {  }
+    ALTAIR_DFRobotG6(                 )  : _lat(0.), _lon(0.), _ele(0.), _time(0.), _fixMillis(0), _hasFix(false) {  }
 
     virtual void      initialize(     )  {  }
     virtual bool      getGPS(         )  ;
-    virtual uint8_t   typeAndHealth(  )  { return ((uint8_t) dfrobotg6_healthy); }
+    virtual uint8_t   typeAndHealth(  )  ;  // Unhealthy if it has no fix, or the last one is stale.
 
     virtual double    lat(            )  { return           _lat               ; }
     virtual double    lon(            )  { return           _lon               ; }
     virtual long      ele(            )  { return           _ele               ; }  // In meters above mean sea level.
     virtual byte      hdop(           )  { return            0                 ; }  // Horizontal Degree Of Precision.  A number typically between 1 and 50.
-    virtual uint32_t  age(            )  { return            0                 ; }
+    virtual uint32_t  age(            )  ;  // In ms since the UM7 last passed on a new GPS packet.
     virtual uint16_t  year(           )  ;
     virtual uint8_t   month(          )  ;
     virtual uint8_t   day(            )  ;
@@ -49,6 +50,8 @@ class ALTAIR_DFRobotG6 : public ALTAIR_GPSSensor {
     double           _lon                ;
     double           _ele                ;
     double           _time               ;  // time in seconds since 0000 UT at the beginning of the UTC day _today_ (_not_ since 0000 UT on January 6, 1980!)
+    unsigned long    _fixMillis          ;  // clockMillis() when the last new packet was got
+    bool             _hasFix             ;
 
 };
 #endif    //   ifndef ALTAIR_DFRobotG6_h
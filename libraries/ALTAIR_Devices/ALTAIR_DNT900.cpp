@@ -7,6 +7,8 @@
     This is the telemetry interface class for the ALTAIR DNT900P
     radio transceiver, which operates at 910 MHz.  This class derives
     from the ALTAIR_GenTelInt generic telemetry interface base class.
+    (It can use the radio in transparent mode, or in protocol mode.)
+
     Justin Albert  jalbert@uvic.ca     began on 22 Oct. 2017
 
     @section  HISTORY
@@ -17,9 +19,6 @@
 
 #include "ALTAIR_DNT900.h"
 
-#define  DNT900_SERIAL_BAUDRATE    38400
-#define  DNT_MAX_SEND_TRIES      1000000
-
 /**************************************************************************/
 /*!
  @brief  Constructor.
@@ -29,7 +28,12 @@ ALTAIR_DNT900::ALTAIR_DNT900(const char serialID, const char dntHwResetPin, cons
    _serialID(serialID),
    _dntHwResetPin(dntHwResetPin),
    _dntCTSPin(dntCTSPin),
-   _dntRTSPin(dntRTSPin)
+   _dntRTSPin(dntRTSPin),
+   _uart(ALTAIR_HAL::uart(serialID)),
+   _protocolMode(false),
+   _rxHead(0),
+   _rxCount(0),
+   _rxDropped(0)
 {
 }
 
@@ -42,7 +46,12 @@ ALTAIR_DNT900::ALTAIR_DNT900() :
    _serialID(DEFAULT_DNT_SERIALID),
    _dntHwResetPin(DEFAULT_DNTHWRESETPIN),
    _dntCTSPin(DEFAULT_DNTCTSPIN),
-   _dntRTSPin(DEFAULT_DNTRTSPIN)
+   _dntRTSPin(DEFAULT_DNTRTSPIN),
+   _uart(ALTAIR_HAL::uart(DEFAULT_DNT_SERIALID)),
+   _protocolMode(false),
+   _rxHead(0),
+   _rxCount(0),
+   _rxDropped(0)
 {
 }
 
@@ -55,149 +64,365 @@ ALTAIR_DNT900::ALTAIR_DNT900() :
 /**************************************************************************/
 bool ALTAIR_DNT900::initialize(const char* aString) {
 
-    pinMode(                 _dntHwResetPin, OUTPUT);
-    pinMode(                     _dntCTSPin, INPUT);
-    pinMode(                     _dntRTSPin, OUTPUT);
+    ALTAIR_HAL::gpioMode(    _dntHwResetPin, HAL_OUTPUT);
+    ALTAIR_HAL::gpioMode(        _dntCTSPin, HAL_INPUT);
+    ALTAIR_HAL::gpioMode(        _dntRTSPin, HAL_OUTPUT);
 
-    digitalWrite(            _dntHwResetPin, LOW);
-    digitalWrite(                _dntRTSPin, HIGH);
+    ALTAIR_HAL::gpioWrite(   _dntHwResetPin, HAL_LOW);
+    ALTAIR_HAL::gpioWrite(       _dntRTSPin, HAL_HIGH);
 
-    delay(200);
+    ALTAIR_HAL::clockDelay(200);
 
 // END the hardware reset (i.e., set HwResetPin HIGH).  A Hw reset must occur every time the radio is powered up.
-    digitalWrite(            _dntHwResetPin, HIGH);
-
-  
-    switch (_serialID) {
-      case 0:
-        Serial.begin(DNT900_SERIAL_BAUDRATE);
-        break;
-      case 1:
-        Serial1.begin(DNT900_SERIAL_BAUDRATE);
-        break;
-      case 2:
-        Serial2.begin(DNT900_SERIAL_BAUDRATE);
-        break;
-      case 3:
-        Serial3.begin(DNT900_SERIAL_BAUDRATE);
-        break;
-      default:
+    ALTAIR_HAL::gpioWrite(   _dntHwResetPin, HAL_HIGH);
+
+    uart()->begin(DNT900_SERIAL_BAUDRATE);
+
+// Protocol mode: the radio takes a while to start up after its reset, so ask a few times.
+    if (_protocolMode) {
+        ALTAIR_HAL::gpioWrite(   _dntRTSPin, HAL_LOW);
+        const byte dntcfg[] = { 'D', 'N', 'T', 'C', 'F', 'G' };
+        bool       entered  = false;
+        for (uint8_t i = 0; i < DNT_ENTER_PROTOCOL_TRIES && !entered; ++i) {
+            _protocol.queueCommand(DNT_ENTER_PROTOCOL_MODE, dntcfg, sizeof(dntcfg));
+            entered = awaitReply(DNT_ENTER_PROTOCOL_MODE | DNT_REPLY);
+        }
+        if (!entered) {
+            Serial.println(F("DNT900 radio did not enter protocol mode, so it is staying in transparent mode"));
+            _protocolMode = false;
+        }
+    }
+
+    return true;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Return the UART that the transceiver is on (or, if the serial ID 
+         is not allowed, print an error and halt).
+*/
+/**************************************************************************/
+ALTAIR_HALUart* ALTAIR_DNT900::uart() {
+
+    if (_uart == NULL) {
         Serial.println(F("Unallowed serial ID provided in initialization of DNT900 radio transceiver!"));
         while(1);
-        break;
     }
-    
-    return true;
+    return _uart;
 
 }
 
 
 /**************************************************************************/
 /*!
- @brief  Send one ASCII character.  (Returns false if send is unsuccessful.)
+ @brief  Send one ASCII character.  (Returns false if the TX queue is full.)
 */
 /**************************************************************************/
 bool ALTAIR_DNT900::send(unsigned char aChar) {
 
-    int i = 0;
-    while (digitalRead(_dntCTSPin) == HIGH && i < DNT_MAX_SEND_TRIES) {
-        ++i;
-    }
-    if (i < DNT_MAX_SEND_TRIES) {
-        int retval = 0;
-/*
-        switch (_serialID) {
-          case 0:
-            retval = Serial.write(aChar);
-          case 1:
-            retval = Serial1.write(aChar);
-          case 2:
-            retval = Serial2.write(aChar);
-          case 3:
-            retval = Serial3.write(aChar);
-          default:
+    return enqueue(&aChar, 1);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send a string of ASCII characters.  (Returns false if the TX queue
+         is full.)
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900::send(const uint8_t* aString) {
+
+    return enqueue(aString, strlen((const char*) aString));
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send an array of bytes.  (Returns false if the TX queue is full.)
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900::send(const uint8_t* anArray, const uint8_t arrayLen) {
+
+    return enqueue(anArray, arrayLen);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Put a frame into the TX queue (whole, or not at all), and then
+         send as much of the queue as the transceiver will take right now.
+         Returns false (i.e. backpressure) if the frame did not fit.
 */
-        if (_serialID == 1) {
-            retval = Serial1.write(aChar);
-        } else {
-            Serial.print(F("Unallowed serial ID provided in initialization of DNT900 radio transceiver!: ")); Serial.println(_serialID, HEX);
-            while(1);
+/**************************************************************************/
+bool ALTAIR_DNT900::enqueue(const uint8_t* bytes, uint16_t numBytes) {
+
+// In protocol mode, into TxData packets (of at most DNT_PROTOCOL_MAX_DATA each), which go out at the next serviceTx()
+// (checking first that there is room for all of them, so that a frame is never left queued in part)
+    if (_protocolMode) {
+        if (!_protocol.fits(numBytes)) {
+            ++_txQueue.stats()->framesRejected;
             return false;
         }
-        if (retval == 1) return true;
-    } else {
-        Serial.println(F("Unable to write to DNT: Serial not sending and/or CTS pin is high"));
-        return false;
+        for (uint16_t offset = 0; offset < numBytes; offset += DNT_PROTOCOL_MAX_DATA) {
+            uint16_t length = numBytes - offset;
+            if (length > DNT_PROTOCOL_MAX_DATA) length = DNT_PROTOCOL_MAX_DATA;
+            _protocol.append(bytes + offset, length);
+        }
+        ++_txQueue.stats()->framesQueued;
+        return true;
     }
 
+    bool queued = _txQueue.push(bytes, numBytes, txMillis());
+    serviceTx();
+    return queued;
+
 }
 
 /**************************************************************************/
 /*!
- @brief  Send a string of ASCII characters.  (Returns false if send is 
-         unsuccessful.)
+ @brief  Write queued bytes into the UART, for as long as CTS is low and
+         the UART has room (so this never blocks).  Returns the number of
+         bytes written.
 */
 /**************************************************************************/
-bool ALTAIR_DNT900::send(const uint8_t* aString) {
+uint16_t ALTAIR_DNT900::serviceTx() {
 
-    int i = 0;
-    while (digitalRead(_dntCTSPin) == HIGH && i < DNT_MAX_SEND_TRIES) {
-        ++i;
+    if (_protocolMode) {
+        serviceRx();
+        return serviceProtocolTx();
     }
-    if (i < DNT_MAX_SEND_TRIES) {
-        switch (_serialID) {
-          case 0:
-            return Serial.write((const char*) aString);
-          case 1:
-            return Serial1.write((const char*) aString);
-          case 2:
-            return Serial2.write((const char*) aString);
-          case 3:
-            return Serial3.write((const char*) aString);
-          default:
-            Serial.println(F("Unallowed serial ID provided in initialization of DNT900 radio transceiver!"));
-            while(1);
-            return false;
+
+    uint16_t    written = 0;
+    const byte* bytes;
+    uint16_t    pending;
+    while ((pending = _txQueue.nextBytes(bytes)) > 0) {
+        if (!clearToSend()) {
+            ++_txQueue.stats()->ctsBlockedCount;
+            break;
         }
-    } else {
-        Serial.println(F("Unable to write to DNT: CTS pin is high"));
-        return false;
+        int space = uartWriteSpace();
+        if (space <= 0) break;
+        if (pending > (uint16_t) space) pending = space;
+        pending = uartWrite(bytes, pending);
+        if (pending == 0) break;
+        _txQueue.wrote(pending, txMillis());
+        written += pending;
     }
+    _txQueue.stats()->bytesSent += written;
+    return written;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  In protocol mode: give up on any packets whose replies are
+         overdue, and then write the packets out, for as long as CTS is low
+         and the UART has room.  Returns the number of bytes written.
+         (serviceTx first handles the radio's replies, so that the packets
+         that have been acknowledged are done with; awaitReply handles
+         them itself, to see the one it awaits.)
+*/
+/**************************************************************************/
+uint16_t ALTAIR_DNT900::serviceProtocolTx() {
 
+    _protocol.expire(txMillis());
+
+    uint16_t    written = 0;
+    const byte* bytes;
+    uint8_t     pending;
+    while ((pending = _protocol.nextBytes(bytes)) > 0) {
+        if (!clearToSend()) {
+            ++_txQueue.stats()->ctsBlockedCount;
+            break;
+        }
+        int space = uartWriteSpace();
+        if (space <= 0) break;
+        if (pending > space) pending = space;
+        pending = uartWrite(bytes, pending);
+        if (pending == 0) break;
+        _protocol.wrote(pending, txMillis());
+        written += pending;
+    }
+    _txQueue.stats()->bytesSent += written;
+    return written;
 
 }
 
 /**************************************************************************/
 /*!
- @brief  Send an array of bytes.  (Returns false if send is unsuccessful.)
+ @brief  In protocol mode, parse everything that the radio has sent.
+         Returns the number of bytes parsed.
 */
 /**************************************************************************/
-bool ALTAIR_DNT900::send(const uint8_t* anArray, const uint8_t arrayLen) {
+uint16_t ALTAIR_DNT900::serviceRx() {
 
-    int i = 0;
-    while ((digitalRead(_dntCTSPin) == HIGH) && (i < DNT_MAX_SEND_TRIES)) {
-        ++i;
+    uint16_t parsed = 0;
+    if (!_protocolMode) return parsed;
+    while (uartAvailable() > 0) {
+        pollRx();
+        ++parsed;
     }
-    if (i < DNT_MAX_SEND_TRIES) {
-        switch (_serialID) {
-          case 0:
-            return Serial.write(  anArray, arrayLen );
-          case 1:
-            return Serial1.write( anArray, arrayLen );
-          case 2:
-            return Serial2.write( anArray, arrayLen );
-          case 3:
-            return Serial3.write( anArray, arrayLen );
-          default:
-            Serial.println(F("Unallowed serial ID provided in initialization of DNT900 radio transceiver!"));
-            while(1);
-            return false;
+    return parsed;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Parse one byte from the radio (in protocol mode).  The data of
+         each RxData (or RxEvent) packet goes into the receive buffer, to
+         be read(), and its RSSI, and that of each acknowledgement, is
+         noted.  Returns the type of the packet completed, if any.
+*/
+/**************************************************************************/
+byte ALTAIR_DNT900::pollRx() {
+
+    int b = uartRead();
+    if (b < 0) return DNT_NO_PACKET;
+    unsigned long now    = txMillis();
+    byte          type   = _protocol.feed((byte) b, now);
+    const byte*   packet = _protocol.packet();
+    uint8_t       length = _protocol.packetLength();
+
+    if ((type == DNT_RX_DATA || type == DNT_RX_EVENT) && length >= DNT_RX_DATA_OVERHEAD - 2) {
+        noteRSSI((char) packet[4], now);
+        for (uint8_t i = DNT_RX_DATA_OVERHEAD - 2; i < length; ++i) {
+            if (_rxCount == DNT_RX_BUFFER_SIZE) { ++_rxDropped; continue; }
+            _rxBuffer[(_rxHead + _rxCount++) % DNT_RX_BUFFER_SIZE] = packet[i];
+        }
+    } else if (type == DNT_TX_DATA_REPLY && length >= 6 && packet[1] == DNT_TX_STATUS_ACK) {
+        noteRSSI((char) packet[5], now);
+    }
+    return type;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send what has been queued (e.g. a command), and wait for the
+         reply of the given type (up to DNT_COMMAND_REPLY_TIMEOUT).  (The
+         reply is then in _protocol.packet().)
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900::awaitReply(byte type) {
+
+    unsigned long start = txMillis();
+    while (txMillis() - start < DNT_COMMAND_REPLY_TIMEOUT) {
+        serviceProtocolTx();
+        while (uartAvailable() > 0) {
+            if (pollRx() == type) return true;
         }
-    } else {
-        Serial.println(F("Unable to write to DNT: CTS pin is high"));
-        return false;
     }
+    return false;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Read one of the radio's registers (span bytes of it, into value),
+         in protocol mode.
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900::getRegister(byte reg, byte bank, byte span, byte* value) {
+
+    const byte arguments[] = { reg, bank, span };
+    if (!_protocolMode || !_protocol.queueCommand(DNT_GET_REGISTER, arguments, sizeof(arguments))) return false;
+    if (!awaitReply(DNT_GET_REGISTER_REPLY)) return false;
+    const byte* reply = _protocol.packet();
+    if (_protocol.packetLength() < 4 + span || reply[1] != reg || reply[2] != bank || reply[3] != span) return false;
+    memcpy(value, &reply[4], span);
+    return true;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Set one of the radio's registers (span bytes of it, from value),
+         in protocol mode.
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900::setRegister(byte reg, byte bank, byte span, const byte* value) {
+
+    byte arguments[3 + DNT_PROTOCOL_MAX_DATA];
+    if (!_protocolMode || span > DNT_PROTOCOL_MAX_DATA) return false;
+    arguments[0] = reg;
+    arguments[1] = bank;
+    arguments[2] = span;
+    memcpy(&arguments[3], value, span);
+    if (!_protocol.queueCommand(DNT_SET_REGISTER, arguments, 3 + span)) return false;
+    return awaitReply(DNT_SET_REGISTER | DNT_REPLY);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the TX queue statistics.
+*/
+/**************************************************************************/
+void ALTAIR_DNT900::printTxStats() {
+
+    const ALTAIR_DNT900TxStats* stats = _txQueue.stats();
+
+    Serial.println(F("DNT900 TX queue statistics:"));
+    Serial.print(F("   frames queued / sent / rejected: ")); Serial.print(stats->framesQueued);    Serial.print(F(" / "));
+                                                             Serial.print(stats->framesSent);      Serial.print(F(" / "));
+                                                             Serial.println(stats->framesRejected);
+    Serial.print(F("   bytes sent: "));                      Serial.println(stats->bytesSent);
+    Serial.print(F("   queue depth now / max (bytes): "));   Serial.print(_txQueue.depth());       Serial.print(F(" / "));
+                                                             Serial.println(stats->maxQueueDepth);
+    Serial.print(F("   latency last / mean / max (ms): "));  Serial.print(stats->lastLatency);     Serial.print(F(" / "));
+                                                             Serial.print(stats->framesSent ? stats->totalLatency / stats->framesSent : 0);
+                                                             Serial.print(F(" / "));               Serial.println(stats->maxLatency);
+    Serial.print(F("   times blocked by CTS: "));            Serial.println(stats->ctsBlockedCount);
+    if (!_protocolMode) return;
+    const ALTAIR_DNT900ProtocolStats* p = _protocol.stats();
+    Serial.print(F("   packets sent / acked / retries: "));  Serial.print(p->packetsSent);         Serial.print(F(" / "));
+                                                             Serial.print(p->acked);               Serial.print(F(" / "));
+                                                             Serial.println(p->retries);
+    Serial.print(F("   failed / not linked / timed out: ")); Serial.print(p->failed);              Serial.print(F(" / "));
+                                                             Serial.print(p->notLinked);           Serial.print(F(" / "));
+                                                             Serial.println(p->timeouts);
+    Serial.print(F("   ack time last / mean / max (ms): ")); Serial.print(p->lastAckMillis);       Serial.print(F(" / "));
+                                                             Serial.print(p->acked ? p->totalAckMillis / p->acked : 0);
+                                                             Serial.print(F(" / "));               Serial.println(p->maxAckMillis);
+    Serial.print(F("   packets received / bad / errors: ")); Serial.print(p->rxPackets);           Serial.print(F(" / "));
+                                                             Serial.print(p->badPackets);          Serial.print(F(" / "));
+                                                             Serial.println(p->errors);
+    Serial.print(F("   received bytes dropped: "));          Serial.println(_rxDropped);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Is the transceiver ready to accept data (i.e. is CTS low)?
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900::clearToSend() {
+
+    return (ALTAIR_HAL::gpioRead(_dntCTSPin) == HAL_LOW);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  The number of bytes that can be written to the serial port 
+         without blocking.
+*/
+/**************************************************************************/
+int ALTAIR_DNT900::uartWriteSpace() {
+
+    return uart()->availableForWrite();
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write bytes to the serial port.  Returns the number written.
+*/
+/**************************************************************************/
+size_t ALTAIR_DNT900::uartWrite(const uint8_t* bytes, size_t numBytes) {
 
+    return uart()->write( bytes, numBytes );
 
 }
 
@@ -226,20 +451,11 @@ bool ALTAIR_DNT900::sendAsIndivChars(const uint8_t* aString) {
 /**************************************************************************/
 bool ALTAIR_DNT900::available() {
 
-    switch (_serialID) {
-      case 0:
-        return Serial.available();
-      case 1:
-        return Serial1.available();
-      case 2:
-        return Serial2.available();
-      case 3:
-        return Serial3.available();
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of DNT900 radio transceiver!"));
-        while(1);
-        return false;
+    if (_protocolMode) {
+        serviceRx();
+        return (_rxCount > 0);
     }
+    return (uartAvailable() > 0);
 
 }
 
@@ -251,7 +467,7 @@ bool ALTAIR_DNT900::available() {
 /**************************************************************************/
 bool ALTAIR_DNT900::isBusy() {
 
-    return (digitalRead(_dntCTSPin) == HIGH);
+    return (ALTAIR_HAL::gpioRead(_dntCTSPin) == HAL_HIGH);
 
 }
 
@@ -262,24 +478,20 @@ bool ALTAIR_DNT900::isBusy() {
 /**************************************************************************/
 byte ALTAIR_DNT900::read() {
 
-    digitalWrite(_dntRTSPin, LOW);
-
-    switch (_serialID) {
-      case 0:
-        return Serial.read();
-      case 1:
-        return Serial1.read();
-      case 2:
-        return Serial2.read();
-      case 3:
-        return Serial3.read();
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of DNT900 radio transceiver!"));
-        while(1);
-        return 0;
+    if (_protocolMode) {
+        if (_rxCount == 0) serviceRx();
+        if (_rxCount == 0) return 0;
+        byte b  = _rxBuffer[_rxHead];
+        _rxHead = (_rxHead + 1) % DNT_RX_BUFFER_SIZE;
+        --_rxCount;
+        return b;
     }
 
-    digitalWrite(_dntRTSPin, HIGH);
+    ALTAIR_HAL::gpioWrite(_dntRTSPin, HAL_LOW);
+
+    return uartRead();
+
+    ALTAIR_HAL::gpioWrite(_dntRTSPin, HAL_HIGH);
 
 }
 
@@ -304,18 +516,17 @@ radio_t ALTAIR_DNT900::radioType() {
 /**************************************************************************/
 /*!
  @brief  Returns the most recent Return Signal Strength Information from
-         the transceiver (i.e., from the most recent byte read).  The 
-         return value is in dBm.  However, if a value of +127 is returned, 
-         that means that the transceiver is not giving us an RSSI value
-         (possibly because a byte hasn't been read from the transceiver yet 
-         -- for example, see if perhaps data has only been written to, but   
-         not yet read so far from the transceiver, if you get a +127).
+         the transceiver (i.e., of the most recent packet received, or
+         acknowledgement of a packet sent, in protocol mode).  The return
+         value is in dBm.  However, if a value of +127 is returned, that
+         means that the transceiver is not giving us an RSSI value
+         (possibly because it is in transparent mode, which has none, or
+         because nothing has been received yet).
 */
 /**************************************************************************/
 char ALTAIR_DNT900::lastRSSI() {
 
-// NEED TO IMPLEMENT THIS PROPERLY!!!
-    return FAKE_RSSI_VAL;
+    return _lastRSSI;
 
 }
 
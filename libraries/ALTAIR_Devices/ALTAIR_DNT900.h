@@ -8,6 +8,31 @@
     radio transceiver, which operates at 910 MHz.  This class derives 
     from the ALTAIR_GenTelInt generic telemetry interface base class.
 
+    Everything sent is first put into a transmit queue, which accepts
+    whole frames immediately (or rejects them whole, if the queue is 
+    full, so the caller sees the backpressure), and which is drained 
+    into the serial port by serviceTx() whenever the transceiver's CTS 
+    line is low.  (CTS is on pin 28, which has no pin-change interrupt
+    on the Mega, so serviceTx() is called from every send(), and also
+    periodically from the task scheduler.)  The CTS line, the serial
+    port, and the clock are all accessed via protected virtual member
+    functions, so that a host-computer stand-in can override them, and
+    drive the drain behaviour deterministically.  (By default, these go
+    through ALTAIR_HAL, so the Linux simulation backend can drive them
+    too.)  The queue itself (ALTAIR_DNT900TxQueue) does not depend upon
+    the Arduino libraries, and its backpressure, and that of protocol
+    mode, are tested on a host computer (see tools/ALTAIRDNT900TxTest.cpp).
+
+    In protocol mode (see ALTAIR_DNT900Protocol.h), set before
+    initialize(), everything sent goes out in addressed TxData packets
+    instead (the frames queued together going out in a single packet,
+    at the next serviceTx()), each of which the radio acknowledges, or
+    else is sent again.  What is received comes in RxData packets, whose
+    data is read() just as in transparent mode, and whose RSSI (and that
+    of each acknowledgement) is noted for lastRSSI().  The radio's
+    registers can also be read and set.  If the radio does not enter
+    protocol mode, it is left in transparent mode.
+
     Justin Albert  jalbert@uvic.ca     began on 15 Oct. 2017
 
     @section  HISTORY
@@ -19,12 +44,21 @@
 #define ALTAIR_DNT900_h
 
 #include "ALTAIR_GenTelInt.h"
+#include <ALTAIR_HAL.h>
+#include "ALTAIR_DNT900Protocol.h"
+#include "ALTAIR_DNT900TxQueue.h"
 
 #define  DEFAULT_DNT_SERIALID          1
 #define  DEFAULT_DNTHWRESETPIN        27
 #define  DEFAULT_DNTCTSPIN            28
 #define  DEFAULT_DNTRTSPIN            29
 #define  DNT900_RADIO_NAME       "DNT900"
+#define  DNT900_SERIAL_BAUDRATE    38400
+#define  DNT_TX_BACKLOG_THRESHOLD    (3*FRAME_HEADER_LENGTH + ALTAIR_AllInfoFrame1::length + ALTAIR_AllInfoFrame2::length + ALTAIR_PropulsionFrame::length)
+                                                  // backlogged if there isn't room for a full sendAllALTAIRInfo
+#define  DNT_RX_BUFFER_SIZE           64          // in bytes: the data received in protocol mode, until it is read()
+#define  DNT_COMMAND_REPLY_TIMEOUT  1000          // in milliseconds
+#define  DNT_ENTER_PROTOCOL_TRIES      3
 
 class ALTAIR_DNT900 : public ALTAIR_GenTelInt {
   public:
@@ -35,8 +69,11 @@ class ALTAIR_DNT900 : public ALTAIR_GenTelInt {
     virtual bool    sendAsIndivChars(  const uint8_t* aString                                );
     virtual bool    sendCallSign()                                              { return true ; } // Call sign   not necessary on ISM band DNT 900.
     virtual bool    sendEndMessage()                                            { return true ; } // End message not necessary on ISM band DNT 900.
+    virtual uint8_t callSignBytes()                                             { return 0    ; } // (so neither is sent)
     virtual bool    available(                                                               );   // If a byte is available for reading, returns true.
-    virtual bool    isBusy(                                                                  );
+    virtual bool    isBusy(                                                                  );   // true if the transceiver's CTS line is high
+    virtual bool    txBacklogged(                                                            ) { return txRoom() < DNT_TX_BACKLOG_THRESHOLD ; }
+    virtual uint16_t txRoom(                                                                 ) { return _protocolMode ? _protocol.room() : txQueueFree() ; }
     virtual bool    initialize(        const char*    aString       = ""                     );
     virtual byte    read(                                                                    );
     virtual const char*   radioName(                                                         );
@@ -46,18 +83,63 @@ class ALTAIR_DNT900 : public ALTAIR_GenTelInt {
                                                                                                   // +127 means: failed to get the last RSSI value.
     virtual bool    lastSentString2()                                           { return true ; }
 
+            uint16_t serviceTx(                                                              );   // Drain the TX queue into the UART while CTS is low.  Returns # of bytes written.
+            uint16_t txQueueDepth(                                                           ) { return _txQueue.depth()                  ; }
+            uint16_t txQueueFree(                                                            ) { return _txQueue.room()                   ; }
+            const ALTAIR_DNT900TxStats* txStats(                                             ) { return _txQueue.stats()                  ; }
+            void     resetTxStats(                                                           ) { _txQueue.resetStats()                    ; }
+            void     printTxStats(                                                           );
+
+            void     setProtocolMode(   bool           on                                    ) { _protocolMode = on                       ; } // (before initialize)
+            bool     protocolMode(                                                           ) { return _protocolMode                     ; }
+            ALTAIR_DNT900Protocol* protocol(                                                 ) { return &_protocol                        ; }
+            uint16_t serviceRx(                                                              );   // In protocol mode, parse what the radio has sent.  Returns # of bytes.
+            bool     getRegister(       byte           reg            ,                            // Read (or set) one of the radio's registers, in
+                                        byte           bank           ,                            //    protocol mode, waiting for its reply (up to
+                                        byte           span           ,                            //    DNT_COMMAND_REPLY_TIMEOUT).
+                                        byte*          value                                 );
+            bool     setRegister(       byte           reg            ,
+                                        byte           bank           ,
+                                        byte           span           ,
+                                        const byte*    value                                 );
+
     ALTAIR_DNT900(const char serialID, const char     dntHwResetPin = DEFAULT_DNTHWRESETPIN, 
                                        const char     dntCTSPin     = DEFAULT_DNTCTSPIN, 
                                        const char     dntRTSPin     = DEFAULT_DNTRTSPIN      );
     ALTAIR_DNT900(                                                                           );   // No arguments => all default values.
 
   protected:
+    virtual bool    clearToSend(                                                             );   // true if CTS is low
+    virtual int     uartWriteSpace(                                                          );   // # of bytes the UART will take without blocking
+    virtual size_t  uartWrite(         const uint8_t* bytes           ,
+                                       size_t         numBytes                               );
+    virtual unsigned long txMillis(                                                          ) { return ALTAIR_HAL::clockMillis()        ; }
+    virtual int     uartAvailable(                                                           ) { return uart()->available()              ; }
+    virtual int     uartRead(                                                                ) { return uart()->read()                   ; }
 
   private:
+            bool    enqueue(           const uint8_t* bytes           ,
+                                       uint16_t       numBytes                               );
+            uint16_t serviceProtocolTx(                                                      );
+            byte    pollRx(                                                                  );   // One byte from the radio, in protocol mode: the type of
+                                                                                                  //    the packet it completed, or DNT_NO_PACKET.
+            bool    awaitReply(        byte           type                                   );
+            ALTAIR_HALUart* uart(                                                            );
+
     char           _serialID                                                                  ;
     char           _dntHwResetPin                                                             ;
     char           _dntCTSPin                                                                 ;
     char           _dntRTSPin                                                                 ;
+    ALTAIR_HALUart* _uart                                                                     ;  // (NULL if _serialID is not allowed)
+
+    ALTAIR_DNT900TxQueue _txQueue                                                             ;  // (in transparent mode)
+
+    bool           _protocolMode                                                              ;
+    ALTAIR_DNT900Protocol _protocol                                                           ;
+    byte           _rxBuffer[DNT_RX_BUFFER_SIZE]                                              ;  // (as a ring)
+    uint8_t        _rxHead                                                                    ;
+    uint8_t        _rxCount                                                                   ;
+    unsigned long  _rxDropped                                                                 ;  // bytes received with no room for them
 };
 #endif
 
@@ -0,0 +1,363 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DNT900Protocol.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the protocol mode (i.e. the API) of the DNT900P
+    radio transceiver (see ALTAIR_DNT900Protocol.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_DNT900Protocol.h"
+
+#define   RX_AWAITING_START    0
+#define   RX_AWAITING_LENGTH   1
+#define   RX_IN_PACKET         2
+#define   RX_SKIPPING          3                // (the rest of a packet too long to keep)
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_DNT900Protocol::ALTAIR_DNT900Protocol(                        ) :
+               _address(                      DNT_BASE_ADDRESS  ) ,
+               _retries(                DNT_DEFAULT_TX_RETRIES  ) ,
+               _head(                                        0  ) ,
+               _count(                                       0  ) ,
+               _rxState(                     RX_AWAITING_START  ) ,
+               _rxLength(                                    0  ) ,
+               _rxIndex(                                     0  ) ,
+               _rxMillis(                                    0  )
+{
+    resetStats();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_DNT900Protocol::resetStats(                              )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  A DNT900 address (3 bytes, least significant first).
+*/
+/**************************************************************************/
+uint32_t ALTAIR_DNT900Protocol::getAddress( const byte* bytes )
+{
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16);
+}
+
+void ALTAIR_DNT900Protocol::putAddress( byte* bytes , uint32_t address )
+{
+    bytes[0] = address       & 0xFF;
+    bytes[1] = address >>  8 & 0xFF;
+    bytes[2] = address >> 16 & 0xFF;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The newest packet, if it is a TxData packet that has not started
+         to go out yet (and so can still be added to).
+*/
+/**************************************************************************/
+ALTAIR_DNT900Protocol::Slot* ALTAIR_DNT900Protocol::openSlot(        )
+{
+    if (_count == 0) return NULL;
+    Slot& newest = slot(_count - 1);
+    return (newest.isData && newest.written == 0 && newest.attempts == 0) ? &newest : NULL;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A new packet, after all of the others (or NULL if every slot is
+         in use).
+*/
+/**************************************************************************/
+ALTAIR_DNT900Protocol::Slot* ALTAIR_DNT900Protocol::newSlot(         )
+{
+    if (_count == DNT_PROTOCOL_SLOTS) return NULL;
+    Slot& added    = slot(_count++);
+    added.length   = 0;
+    added.written  = 0;
+    added.attempts = 0;
+    added.isData   = false;
+    return &added;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Free the oldest packet.
+*/
+/**************************************************************************/
+void ALTAIR_DNT900Protocol::popFront(                                )
+{
+    _head = (_head + 1) % DNT_PROTOCOL_SLOTS;
+    --_count;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The most data that append() will take right now: the room left
+         in the TxData packet being built, or else in a new one.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_DNT900Protocol::room(                                 )
+{
+    if (_count < DNT_PROTOCOL_SLOTS) return DNT_PROTOCOL_MAX_DATA;
+    Slot* open = openSlot();
+    return open ? DNT_PROTOCOL_MAX_PACKET - open->length : 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Whether append() would take the whole of length bytes, appended
+         in pieces of (at most) DNT_PROTOCOL_MAX_DATA, one after another,
+         right now.  (So that a frame longer than one piece is either
+         queued whole, or not at all.)
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900Protocol::fits( uint16_t length )
+{
+    Slot*    open   = openSlot();
+    uint16_t inOpen = open ? DNT_PROTOCOL_MAX_PACKET - open->length : 0;
+    uint8_t  unused = DNT_PROTOCOL_SLOTS - _count;
+    while (length > 0) {
+        uint16_t piece = (length > DNT_PROTOCOL_MAX_DATA) ? DNT_PROTOCOL_MAX_DATA : length;
+        if (piece <= inOpen) inOpen -= piece;                    // (as append() does: into the packet being built, if it fits,
+        else {                                                   //    or else into a new one)
+            if (unused == 0) return false;
+            --unused;
+            inOpen = DNT_PROTOCOL_MAX_DATA - piece;
+        }
+        length -= piece;
+    }
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Add data (whole, or not at all) to the TxData packet being built,
+         if it fits, or else start a new one.  Returns false (i.e.
+         backpressure) if there is no room.
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900Protocol::append( const byte* data , uint8_t length )
+{
+    if (length == 0 || length > DNT_PROTOCOL_MAX_DATA) return false;
+    Slot* open = openSlot();
+    if (open == NULL || open->length + length > DNT_PROTOCOL_MAX_PACKET) {
+        open = newSlot();
+        if (open == NULL) return false;
+        open->isData    = true;
+        open->packet[0] = DNT_START_OF_PACKET;
+        open->packet[2] = DNT_TX_DATA;
+        putAddress(&open->packet[3], _address);
+        open->length    = DNT_TX_DATA_OVERHEAD;
+        ++_stats.packetsSent;
+    }
+    memcpy(&open->packet[open->length], data, length);
+    open->length          += length;
+    open->packet[1]        = open->length - 2;
+    ++_stats.framesSent;
+    _stats.dataBytesSent  += length;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Queue a local command to the radio (e.g. DNT_GET_REGISTER), as a
+         packet of its own.  Returns false if every slot is in use.
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900Protocol::queueCommand( byte type , const byte* arguments , uint8_t length )
+{
+    if (length > DNT_PROTOCOL_MAX_PACKET - 3) return false;
+    Slot* command = newSlot();
+    if (command == NULL) return false;
+    command->packet[0] = DNT_START_OF_PACKET;
+    command->packet[1] = length + 1;
+    command->packet[2] = type;
+    if (length > 0) memcpy(&command->packet[3], arguments, length);
+    command->length    = length + 3;
+    ++_stats.commandsSent;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The next bytes to write to the UART: the rest of the oldest
+         packet that has not (all) gone out yet.  Returns their #.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_DNT900Protocol::nextBytes( const byte*& bytes )
+{
+    for (uint8_t i = 0; i < _count; ++i) {
+        Slot& s = slot(i);
+        if (s.written == s.length) continue;
+        bytes = &s.packet[s.written];
+        return s.length - s.written;
+    }
+    return 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  numBytes of the bytes from nextBytes were written.  Once a
+         packet has all gone out, a TxData packet awaits its reply, and a
+         command is done with (once it is the oldest).
+*/
+/**************************************************************************/
+void ALTAIR_DNT900Protocol::wrote( uint8_t numBytes , unsigned long now )
+{
+    _stats.uartBytesSent += numBytes;
+    for (uint8_t i = 0; i < _count && numBytes > 0; ++i) {
+        Slot& s = slot(i);
+        if (s.written == s.length) continue;
+        uint8_t used = (numBytes < s.length - s.written) ? numBytes : s.length - s.written;
+        s.written   += used;
+        numBytes    -= used;
+        if (s.written < s.length) break;
+        s.sentMillis = now;
+        if (s.attempts++ == 0) s.firstMillis = now;
+    }
+    while (_count > 0 && !slot(0).isData && slot(0).written == slot(0).length) popFront();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Give up on the oldest TxData packets, if their replies are
+         overdue.  Returns the # given up on.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_DNT900Protocol::expire( unsigned long now )
+{
+    uint8_t expired = 0;
+    while (_count > 0) {
+        Slot& oldest = slot(0);
+        if (oldest.written < oldest.length) break;
+        if (oldest.isData && now - oldest.sentMillis < DNT_TX_REPLY_TIMEOUT) break;
+        if (oldest.isData) { ++_stats.timeouts; ++expired; }
+        popFront();
+    }
+    return expired;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A TxDataReply, for the oldest TxData packet that has gone out:
+         it is done with if it was acknowledged (or if the radio is not
+         linked, in which case sending it again now is no use), and is
+         otherwise sent again (after every other packet), up to the # of
+         retries.
+*/
+/**************************************************************************/
+void ALTAIR_DNT900Protocol::txDataReply( byte status , unsigned long now )
+{
+    while (_count > 0 && !slot(0).isData && slot(0).written == slot(0).length) popFront();
+    if (_count == 0 || !slot(0).isData || slot(0).written < slot(0).length) {
+        ++_stats.unmatchedReplies;
+        return;
+    }
+    Slot& oldest = slot(0);
+    if (status == DNT_TX_STATUS_ACK) {
+        unsigned long ackMillis  = now - oldest.firstMillis;
+        _stats.lastAckMillis     = ackMillis;
+        _stats.totalAckMillis   += ackMillis;
+        if (ackMillis > _stats.maxAckMillis) _stats.maxAckMillis = ackMillis;
+        ++_stats.acked;
+        popFront();
+        return;
+    }
+    if (status == DNT_TX_STATUS_NOT_LINKED || oldest.attempts > _retries) {
+        if (status == DNT_TX_STATUS_NOT_LINKED) ++_stats.notLinked;
+        else                                    ++_stats.failed;
+        popFront();
+        return;
+    }
+
+// Send it again, after the others (which the radio will reply to first)
+    ++_stats.retries;
+    Slot retry = oldest;
+    popFront();
+    Slot& again   = slot(_count++);
+    again         = retry;
+    again.written = 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Parse a byte from the radio.  Once it completes a packet (its
+         type, and then its arguments, are in packet()), returns its
+         type; TxDataReplies and announcements are also handled here.
+         Otherwise, returns DNT_NO_PACKET.
+*/
+/**************************************************************************/
+byte ALTAIR_DNT900Protocol::feed( byte aByte , unsigned long now )
+{
+    if (_rxState != RX_AWAITING_START && now - _rxMillis > DNT_PARSER_TIMEOUT) {
+        ++_stats.badPackets;
+        _rxState = RX_AWAITING_START;
+    }
+    _rxMillis = now;
+
+    switch (_rxState) {
+    case RX_AWAITING_START:
+        if (aByte == DNT_START_OF_PACKET) _rxState = RX_AWAITING_LENGTH;
+        return DNT_NO_PACKET;
+    case RX_AWAITING_LENGTH:
+        if (aByte == 0) {
+            ++_stats.badPackets;
+            _rxState = RX_AWAITING_START;
+            return DNT_NO_PACKET;
+        }
+        _rxLength = aByte;
+        _rxIndex  = 0;
+        _rxState  = (aByte > DNT_MAX_RX_PACKET) ? RX_SKIPPING : RX_IN_PACKET;
+        return DNT_NO_PACKET;
+    case RX_SKIPPING:
+        if (++_rxIndex == _rxLength) {
+            ++_stats.badPackets;
+            _rxState = RX_AWAITING_START;
+        }
+        return DNT_NO_PACKET;
+    default:
+        _rx[_rxIndex++] = aByte;
+        if (_rxIndex < _rxLength) return DNT_NO_PACKET;
+        _rxState = RX_AWAITING_START;
+        break;
+    }
+
+// A whole packet
+    ++_stats.rxPackets;
+    switch (_rx[0]) {
+    case DNT_TX_DATA_REPLY:
+        if (_rxLength >= 2) txDataReply(_rx[1], now);
+        break;
+    case DNT_RX_DATA:
+    case DNT_RX_EVENT:
+        if (_rxLength >= DNT_RX_DATA_OVERHEAD - 2) _stats.rxDataBytes += _rxLength - (DNT_RX_DATA_OVERHEAD - 2);
+        break;
+    case DNT_ANNOUNCE:
+        ++_stats.announcements;
+        if (_rxLength >= 2) {
+            _stats.lastAnnouncement = _rx[1];
+            if (_rx[1] >= DNT_ANNOUNCE_ERRORS) ++_stats.errors;
+        }
+        break;
+    }
+    return _rx[0];
+}
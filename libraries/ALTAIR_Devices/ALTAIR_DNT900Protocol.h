@@ -0,0 +1,192 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DNT900Protocol.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the protocol mode (i.e. the API) of the DNT900P
+    radio transceiver, as used by ALTAIR_DNT900 when it is set to
+    protocol mode.  Every message, in each direction over the UART, is a
+    packet:
+
+      [DNT_START_OF_PACKET] [length] [type] [arguments ...]
+
+    where the length counts the type and the arguments.  Data to be sent
+    over the air goes in a TxData packet, addressed to another radio (by
+    default, the base):
+
+      [0xFB] [length] [DNT_TX_DATA] [address (3 bytes, LSB first)] [data ...]
+
+    to which the radio replies, once the recipient has acknowledged it
+    (or once the radio has given up retrying), with a TxDataReply:
+
+      [0xFB] [length] [DNT_TX_DATA_REPLY] [status] [address (3 bytes)] [RSSI]
+
+    where the RSSI (in dBm) is that of the acknowledgement.  Data received
+    over the air comes in an RxData (or an RxEvent) packet, with its RSSI:
+
+      [0xFB] [length] [DNT_RX_DATA] [address (3 bytes)] [RSSI] [data ...]
+
+    So each packet is delimited by the radio itself, which means that
+    the data in it needs no extra framing, and that there is a real RSSI
+    for each packet received (and each acknowledgement).
+
+    Frames to be sent are appended to the newest TxData packet that has
+    not started to go out yet, if they fit (so that all of the frames of
+    a cycle, queued together, go out as a single, larger packet), or else
+    start a new one.  Each packet is kept until its TxDataReply: the
+    radio replies to TxData packets in the order that they were sent, so
+    each reply is matched to the oldest packet awaiting one.  A packet
+    that was not acknowledged (or that the recipient held off, for flow
+    control) is sent again, up to the number of retries set; one whose
+    reply never comes is given up on after DNT_TX_REPLY_TIMEOUT.  Local
+    commands to the radio itself (e.g. GetRegister) are sent, in order
+    with the TxData packets, as packets of their own.
+
+    This file does not depend upon the Arduino libraries, so that it can
+    also be run against an emulated DNT900 on a host computer (see
+    tools/ALTAIRDNT900Emu.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_DNT900Protocol_h
+#define   ALTAIR_DNT900Protocol_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   DNT_START_OF_PACKET         0xFB
+#define   DNT_ENTER_PROTOCOL_MODE     0x00          // (with the argument "DNTCFG")
+#define   DNT_EXIT_PROTOCOL_MODE      0x01
+#define   DNT_SOFTWARE_RESET          0x02
+#define   DNT_GET_REGISTER            0x03          // [register] [bank] [span]
+#define   DNT_SET_REGISTER            0x04          // [register] [bank] [span] [value ...]
+#define   DNT_TX_DATA                 0x05
+#define   DNT_REPLY                   0x10          // (the reply to each command is its type, plus this)
+#define   DNT_TX_DATA_REPLY           (DNT_TX_DATA      | DNT_REPLY)
+#define   DNT_GET_REGISTER_REPLY      (DNT_GET_REGISTER | DNT_REPLY)
+#define   DNT_RX_DATA                 0x26
+#define   DNT_ANNOUNCE                0x27
+#define   DNT_RX_EVENT                0x28
+#define   DNT_NO_PACKET               0xFF          // (from feed: no packet has been completed)
+
+#define   DNT_TX_STATUS_ACK           0x00
+#define   DNT_TX_STATUS_NO_ACK        0x01
+#define   DNT_TX_STATUS_NOT_LINKED    0x02
+#define   DNT_TX_STATUS_HOLD          0x03          // no acknowledgement, as the recipient is holding off (for flow control)
+#define   DNT_ANNOUNCE_ERRORS         0xE0          // (announcements from here up are errors)
+
+#define   DNT_BASE_ADDRESS        0x000000UL
+#define   DNT_BROADCAST_ADDRESS   0xFFFFFFUL
+#define   DNT_TX_DATA_OVERHEAD           6          // the start, length, type, and address bytes of a TxData packet
+#define   DNT_RX_DATA_OVERHEAD           7          // the start, length, type, address, and RSSI bytes of an RxData packet
+#define   DNT_PROTOCOL_MAX_DATA        128          // per TxData packet (room for a whole fan-out cycle; the radio takes more)
+#define   DNT_PROTOCOL_MAX_PACKET      (DNT_TX_DATA_OVERHEAD + DNT_PROTOCOL_MAX_DATA)
+#define   DNT_PROTOCOL_SLOTS             3          // packets that can be waiting to go out, or for their reply, at once
+#define   DNT_MAX_RX_PACKET            160          // the type and arguments of a received packet (longer ones are dropped)
+#define   DNT_TX_REPLY_TIMEOUT        2000          // in milliseconds, from when a TxData packet has gone out
+#define   DNT_PARSER_TIMEOUT           100          // in milliseconds: a packet received with a longer gap than this in it is dropped
+#define   DNT_DEFAULT_TX_RETRIES         2
+
+struct    ALTAIR_DNT900ProtocolStats {
+    unsigned long       packetsSent                                         ;  // TxData packets (not counting retries)
+    unsigned long       framesSent                                          ;  // (appended to them)
+    unsigned long       dataBytesSent                                       ;  // (not counting retries)
+    unsigned long       uartBytesSent                                       ;  // (including the packets' overhead, the retries, and the commands)
+    unsigned long       commandsSent                                        ;  // local commands to the radio
+    unsigned long       acked                                               ;
+    unsigned long       retries                                             ;
+    unsigned long       failed                                              ;  // not acknowledged, even after the retries
+    unsigned long       notLinked                                           ;  // (not retried)
+    unsigned long       timeouts                                            ;  // no reply at all
+    unsigned long       unmatchedReplies                                    ;  // a TxDataReply with no packet awaiting one
+    unsigned long       lastAckMillis                                       ;  // from when a packet was first sent, until it was acknowledged
+    unsigned long       maxAckMillis                                        ;
+    unsigned long       totalAckMillis                                      ;  // divide by acked to get the mean
+    unsigned long       rxPackets                                           ;  // of any type
+    unsigned long       rxDataBytes                                         ;  // in RxData and RxEvent packets
+    unsigned long       badPackets                                          ;  // dropped by the parser (e.g. timed out)
+    unsigned long       announcements                                       ;
+    unsigned long       errors                                              ;  // announcements of errors
+    byte                lastAnnouncement                                    ;
+};
+
+class     ALTAIR_DNT900Protocol {
+  public:
+
+    ALTAIR_DNT900Protocol(                                                  ) ;
+
+    void                setAddress(     uint32_t              address               ) { _address = address                 ; }   // to send to
+    uint32_t            address(                                                    ) { return _address                    ; }
+    void                setRetries(     uint8_t               retries               ) { _retries = retries                 ; }
+    uint8_t             retries(                                                    ) { return _retries                    ; }
+
+    uint8_t             room(                                                       ) ;   // The most data that append() will take now.
+    bool                fits(           uint16_t              length                ) ;   // Whether append() will take all of length bytes
+                                                                                          //    now, in pieces of DNT_PROTOCOL_MAX_DATA.
+    bool                append(         const byte*           data                ,       // Add data (whole, or not at all) to the TxData
+                                        uint8_t               length                ) ;   //    packet being built, or start a new one.
+    bool                queueCommand(   byte                  type                ,       // A local command to the radio, as a packet of
+                                        const byte*           arguments           ,       //    its own (after any TxData packets).
+                                        uint8_t               length                ) ;
+
+    uint8_t             nextBytes(      const byte*&          bytes                 ) ;   // The next bytes to write to the UART (0 if none).
+    void                wrote(          uint8_t               numBytes            ,       // (numBytes of them were written.)
+                                        unsigned long         now                   ) ;
+    uint8_t             expire(         unsigned long         now                   ) ;   // Give up on overdue replies.  Returns the # given up on.
+    bool                idle(                                                       ) { return _count == 0                 ; }   // Nothing to send, or to await.
+
+    byte                feed(           byte                  aByte               ,       // Parse a byte from the radio.  Returns the type of
+                                        unsigned long         now                   ) ;   //    the packet it completed, or DNT_NO_PACKET.
+    const byte*         packet(                                                     ) { return _rx                         ; }   // (the type, and then the arguments)
+    uint8_t             packetLength(                                               ) { return _rxLength                   ; }
+
+    static uint32_t     getAddress(     const byte*           bytes                 ) ;   // (3 bytes, LSB first)
+    static void         putAddress(     byte*                 bytes               ,
+                                        uint32_t              address               ) ;
+
+    const ALTAIR_DNT900ProtocolStats* stats(                                        ) { return &_stats                     ; }
+    void                resetStats(                                                 ) ;
+
+  private:
+    struct Slot {
+        byte            packet[DNT_PROTOCOL_MAX_PACKET]                             ;
+        uint8_t         length                                                      ;
+        uint8_t         written                                                     ;  // (bytes of it, so far)
+        uint8_t         attempts                                                    ;
+        bool            isData                                                      ;  // (a TxData packet, rather than a command)
+        unsigned long   firstMillis                                                 ;  // when it (first) went out
+        unsigned long   sentMillis                                                  ;  // when it last went out
+    };
+
+    Slot&               slot(           uint8_t               i                     ) { return _slots[(_head + i) % DNT_PROTOCOL_SLOTS] ; }   // (i from the oldest)
+    Slot*               openSlot(                                                   ) ;   // the newest, if it is a TxData packet not yet gone out
+    Slot*               newSlot(                                                    ) ;
+    void                popFront(                                                   ) ;
+    void                txDataReply(    byte                  status              ,
+                                        unsigned long         now                   ) ;
+
+    uint32_t            _address                                                    ;
+    uint8_t             _retries                                                    ;
+    Slot                _slots[DNT_PROTOCOL_SLOTS]                                  ;  // in the order that they go out (as a ring)
+    uint8_t             _head                                                       ;
+    uint8_t             _count                                                      ;
+    uint8_t             _rxState                                                    ;  // awaiting the start, the length, or the rest
+    byte                _rx[DNT_MAX_RX_PACKET]                                      ;
+    uint8_t             _rxLength                                                   ;
+    uint8_t             _rxIndex                                                    ;
+    unsigned long       _rxMillis                                                   ;  // of the last byte
+    ALTAIR_DNT900ProtocolStats _stats                                               ;
+};
+
+#endif    //   ifndef ALTAIR_DNT900Protocol_h
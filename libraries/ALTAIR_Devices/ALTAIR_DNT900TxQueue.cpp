@@ -0,0 +1,119 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DNT900TxQueue.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the transmit queue of the DNT900P radio transceiver in
+    transparent mode (see ALTAIR_DNT900TxQueue.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_DNT900TxQueue.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_DNT900TxQueue::ALTAIR_DNT900TxQueue(                          ) :
+               _head(                                        0  ) ,
+               _count(                                       0  ) ,
+               _frameHead(                                   0  ) ,
+               _frameCount(                                  0  ) ,
+               _frontSent(                                   0  )
+{
+    resetStats();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_DNT900TxQueue::resetStats(                               )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Queue a frame, whole, or not at all.  Returns false (i.e.
+         backpressure) if there is no room for it.
+*/
+/**************************************************************************/
+bool ALTAIR_DNT900TxQueue::push( const byte* bytes , uint16_t numBytes , unsigned long now )
+{
+    if (numBytes > room()) {
+        ++_stats.framesRejected;
+        return false;
+    }
+    uint16_t tail = (_head + _count) % DNT_TX_QUEUE_SIZE;
+    for (uint16_t i = 0; i < numBytes; ++i) {
+        _queue[tail] = bytes[i];
+        if (++tail == DNT_TX_QUEUE_SIZE) tail = 0;
+    }
+    _count += numBytes;
+    if (_count > _stats.maxQueueDepth) _stats.maxQueueDepth = _count;
+
+    if (_frameCount < DNT_TX_MAX_FRAMES) {
+        uint8_t frame = (_frameHead + _frameCount) % DNT_TX_MAX_FRAMES;
+        _frameLength[frame] = numBytes;
+        _frameMillis[frame] = now;
+        ++_frameCount;
+    } else {                                      // (e.g. many single-byte sends) coalesce into the newest frame, keeping its (earlier) time
+        _frameLength[(_frameHead + _frameCount - 1) % DNT_TX_MAX_FRAMES] += numBytes;
+    }
+    ++_stats.framesQueued;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The next bytes to write to the UART: the oldest queued bytes, up
+         to the end of the ring (so they are contiguous).  Returns their #.
+*/
+/**************************************************************************/
+uint16_t ALTAIR_DNT900TxQueue::nextBytes( const byte*& bytes )
+{
+    uint16_t contiguous = DNT_TX_QUEUE_SIZE - _head;
+    bytes = &_queue[_head];
+    return (_count < contiguous) ? _count : contiguous;
+}
+
+/**************************************************************************/
+/*!
+ @brief  numBytes of the bytes from nextBytes were written.  They are
+         accounted against the queued frames, oldest first, and each frame
+         that has all gone out has its latency noted.
+*/
+/**************************************************************************/
+void ALTAIR_DNT900TxQueue::wrote( uint16_t numBytes , unsigned long now )
+{
+    if (numBytes > _count) numBytes = _count;
+    _head   = (_head + numBytes) % DNT_TX_QUEUE_SIZE;
+    _count -= numBytes;
+    while (numBytes > 0 && _frameCount > 0) {
+        uint16_t frontRemaining = _frameLength[_frameHead] - _frontSent;
+        uint16_t used           = (numBytes < frontRemaining) ? numBytes : frontRemaining;
+        _frontSent += used;
+        numBytes   -= used;
+        if (_frontSent == _frameLength[_frameHead]) {
+            unsigned long latency  = now - _frameMillis[_frameHead];
+            _stats.lastLatency     = latency;
+            _stats.totalLatency   += latency;
+            if (latency > _stats.maxLatency) _stats.maxLatency = latency;
+            ++_stats.framesSent;
+            _frameHead             = (_frameHead + 1) % DNT_TX_MAX_FRAMES;
+            --_frameCount;
+            _frontSent             = 0;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DNT900TxQueue.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the transmit queue of the DNT900P radio transceiver in
+    transparent mode, as used by ALTAIR_DNT900.  It takes whole frames
+    (or rejects them whole, if there is no room, so that the caller sees
+    the backpressure), and hands them out again, oldest first, as the
+    UART can take them (via nextBytes() and wrote(), just as
+    ALTAIR_DNT900Protocol hands out its packets in protocol mode).  It
+    notes when each frame was queued, for the latency from then until
+    the frame was all written.
+
+    This file does not depend upon the Arduino libraries, so that the
+    queue's backpressure can be tested on a host computer, against a
+    simulated CTS line and UART (see tools/ALTAIRDNT900TxTest.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_DNT900TxQueue_h
+#define   ALTAIR_DNT900TxQueue_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   DNT_TX_QUEUE_SIZE           256          // in bytes
+#define   DNT_TX_MAX_FRAMES            16          // frames beyond this are coalesced into the newest queued frame
+
+struct    ALTAIR_DNT900TxStats {
+    unsigned long       framesQueued                                        ;
+    unsigned long       framesSent                                          ;
+    unsigned long       framesRejected                                      ;  // refused (whole) because the queue was full
+    unsigned long       bytesSent                                           ;
+    unsigned long       ctsBlockedCount                                     ;  // # of serviceTx() calls that found data waiting, but CTS high
+    uint16_t            maxQueueDepth                                       ;  // in bytes
+    unsigned long       lastLatency                                         ;  // in milliseconds from being queued until fully handed to the UART
+    unsigned long       maxLatency                                          ;
+    unsigned long       totalLatency                                        ;  // divide by framesSent to get the mean
+};
+
+class     ALTAIR_DNT900TxQueue {
+  public:
+
+    ALTAIR_DNT900TxQueue(                                                   ) ;
+
+    bool                push(           const byte*           bytes               ,       // Queue a frame (whole, or not at all).  Returns
+                                        uint16_t              numBytes            ,       //    false (i.e. backpressure) if it did not fit.
+                                        unsigned long         now                   ) ;
+    uint16_t            nextBytes(      const byte*&          bytes                 ) ;   // The next bytes to write to the UART (0 if none).
+    void                wrote(          uint16_t              numBytes            ,       // (numBytes of them were written.)
+                                        unsigned long         now                   ) ;
+
+    uint16_t            depth(                                                      ) { return _count                      ; }   // # of bytes queued
+    uint16_t            room(                                                       ) { return DNT_TX_QUEUE_SIZE - _count  ; }
+
+    ALTAIR_DNT900TxStats* stats(                                                    ) { return &_stats                     ; }   // (ALTAIR_DNT900 adds the UART's)
+    void                resetStats(                                                 ) ;
+
+  private:
+    byte                _queue[DNT_TX_QUEUE_SIZE]                                   ;
+    uint16_t            _head                                                       ;  // the index of the oldest queued byte
+    uint16_t            _count                                                      ;  // # of queued bytes
+    uint16_t            _frameLength[DNT_TX_MAX_FRAMES]                             ;  // the queued frames, oldest first (as a ring)
+    unsigned long       _frameMillis[DNT_TX_MAX_FRAMES]                             ;  // the time each was queued
+    uint8_t             _frameHead                                                  ;
+    uint8_t             _frameCount                                                 ;
+    uint16_t            _frontSent                                                  ;  // # of bytes of the oldest frame already written
+    ALTAIR_DNT900TxStats _stats                                                     ;
+};
+
+#endif    //   ifndef ALTAIR_DNT900TxQueue_h
@@ -0,0 +1,203 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DataLogger.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR ring-buffered, batched data logger.
+
+    This class is instantiated as a singleton via the instantiation of the
+    (also singleton) ALTAIR_DataStorageSystem class.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_DataLogger.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.  (The clock sources default to the HAL's clock.)
+*/
+/**************************************************************************/
+ALTAIR_DataLogger::ALTAIR_DataLogger( ALTAIR_LogClockSource millisClock ,
+                                      ALTAIR_LogClockSource microsClock  ) :
+    _millisClock(                                         millisClock ) ,
+    _microsClock(                                         microsClock ) ,
+    _sink(                                                       NULL ) ,
+    _tail(                                                          0 ) ,
+    _count(                                                         0 ) ,
+    _unsyncedData(                                              false ) ,
+    _syncInterval(                              DEFAULT_LOG_SYNC_INTERVAL ) ,
+    _lastSyncMillis(                                                0 ) ,
+    _rateWindowStartMillis(                                         0 ) ,
+    _rateWindowStartBytes(                                          0 ) ,
+    _bytesPerSecond(                                                0 )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Append a record to the ring buffer.  This never touches the sink,
+         so it is cheap enough to call from anywhere.  If the whole record
+         does not fit, none of it is queued, and it is counted as dropped.
+*/
+/**************************************************************************/
+bool ALTAIR_DataLogger::logRecord( uint8_t     recordType    ,
+                                   const void* payload       ,
+                                   uint8_t     payloadLength  )
+{
+    uint16_t recordLength = LOG_RECORD_HEADER_LENGTH + payloadLength;
+    if (_sink == NULL || LOG_RING_SIZE - _count < recordLength) {
+        ++_stats.droppedRecords;
+        _stats.droppedBytes += recordLength;
+        return false;
+    }
+    uint8_t  header[LOG_RECORD_HEADER_LENGTH] = { LOG_RECORD_SYNC_BYTE, recordType, payloadLength };
+    uint16_t head = (_tail + _count) % LOG_RING_SIZE;
+    for (uint16_t i = 0; i < recordLength; ++i) {
+        _ring[head] = (i < LOG_RECORD_HEADER_LENGTH) ? header[i] : ((const uint8_t*) payload)[i - LOG_RECORD_HEADER_LENGTH];
+        if (++head == LOG_RING_SIZE) head = 0;
+    }
+    _count += recordLength;
+    if (_count > _stats.maxRingFill) _stats.maxRingFill = _count;
+    ++_stats.recordsLogged;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write the oldest full sector in the ring to the sink (if there is
+         one), and then sync the sink, if that is due.  At most one sector
+         is written per call, so that each call takes a bounded time.
+*/
+/**************************************************************************/
+bool ALTAIR_DataLogger::service(                                   )
+{
+    bool wrote = false;
+    if (_count >= LOG_SECTOR_SIZE) wrote = writeOneSector();
+    if (_unsyncedData && (_millisClock() - _lastSyncMillis) >= _syncInterval) syncSink();
+    updateRate();
+    return wrote;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Pad out the partially-filled sector (with zeros), write every
+         queued sector, and sync.  (E.g. before a shutdown.)
+*/
+/**************************************************************************/
+bool ALTAIR_DataLogger::flush(                                     )
+{
+    if (_sink == NULL) return false;
+    uint16_t partial = _count % LOG_SECTOR_SIZE;
+    if (partial != 0) {
+        uint16_t padding = LOG_SECTOR_SIZE - partial;
+        uint16_t head    = (_tail + _count) % LOG_RING_SIZE;
+        memset(&_ring[head], 0, padding);          // (the padding cannot wrap, since the ring is a whole number of sectors)
+        _count              += padding;
+        _stats.paddingBytes += padding;
+    }
+    bool ok = true;
+    while (_count >= LOG_SECTOR_SIZE && ok) ok = writeOneSector();
+    syncSink();
+    return ok;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write the sector at the tail of the ring to the sink.  Since the
+         tail always sits on a sector boundary, the sector is contiguous
+         in RAM, and is handed straight to the sink without being copied.
+*/
+/**************************************************************************/
+bool ALTAIR_DataLogger::writeOneSector(                            )
+{
+    if (_sink == NULL || !_sink->isOpen()) return false;
+    unsigned long startMicros = _microsClock();
+    bool          ok          = _sink->writeSector(&_ring[_tail]);
+    unsigned long elapsed     = _microsClock() - startMicros;
+    if (!ok) {                                    // e.g. the preallocated file is full: drop the sector, rather than wedge the ring
+        ++_stats.writeErrors;
+        _stats.droppedBytes  += LOG_SECTOR_SIZE;
+    } else {
+        _stats.bytesWritten  += LOG_SECTOR_SIZE;
+        _stats.totalFlushMicros += elapsed;       // (so that the mean is over the very sectors that bytesWritten counts)
+        _unsyncedData         = true;
+    }
+    _stats.lastFlushMicros    = elapsed;
+    if (elapsed > _stats.maxFlushMicros) _stats.maxFlushMicros = elapsed;
+    _tail                     = (_tail + LOG_SECTOR_SIZE) % LOG_RING_SIZE;
+    _count                   -= LOG_SECTOR_SIZE;
+    return ok;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Sync the sink, and time how long that took.
+*/
+/**************************************************************************/
+void ALTAIR_DataLogger::syncSink(                                  )
+{
+    _lastSyncMillis = _millisClock();
+    if (_sink == NULL || !_sink->isOpen()) return;
+    unsigned long startMicros = _microsClock();
+    if (!_sink->sync()) ++_stats.writeErrors;
+    unsigned long elapsed     = _microsClock() - startMicros;
+    if (elapsed > _stats.maxSyncMicros) _stats.maxSyncMicros = elapsed;
+    ++_stats.syncCount;
+    _unsyncedData   = false;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Update the measured write rate, once per LOG_RATE_WINDOW.
+*/
+/**************************************************************************/
+void ALTAIR_DataLogger::updateRate(                                )
+{
+    unsigned long elapsed = _millisClock() - _rateWindowStartMillis;
+    if (elapsed < LOG_RATE_WINDOW) return;
+    _bytesPerSecond        = ((_stats.bytesWritten - _rateWindowStartBytes) * 1000UL) / elapsed;
+    _rateWindowStartMillis = _millisClock();
+    _rateWindowStartBytes  = _stats.bytesWritten;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the logger statistics.
+*/
+/**************************************************************************/
+void ALTAIR_DataLogger::resetStats(                                )
+{
+    memset(&_stats, 0, sizeof(_stats));
+    _rateWindowStartMillis = _millisClock();
+    _rateWindowStartBytes  = 0;
+    _bytesPerSecond        = 0;
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the logger statistics.
+*/
+/**************************************************************************/
+void ALTAIR_DataLogger::printStats(                                )
+{
+    unsigned long sectors = _stats.bytesWritten / LOG_SECTOR_SIZE;
+    Serial.println(F("Data logger statistics:"));
+    Serial.print(F("   records logged / dropped: ")); Serial.print(_stats.recordsLogged);   Serial.print(F(" / ")); Serial.println(_stats.droppedRecords);
+    Serial.print(F("   bytes written (padding): "));  Serial.print(_stats.bytesWritten);    Serial.print(F(" (")); Serial.print(_stats.paddingBytes); Serial.println(F(")"));
+    Serial.print(F("   bytes/s: "));                  Serial.println(_bytesPerSecond);
+    Serial.print(F("   sector write mean/max (us): ")); Serial.print(sectors ? _stats.totalFlushMicros / sectors : 0); Serial.print(F("/")); Serial.println(_stats.maxFlushMicros);
+    Serial.print(F("   syncs, max sync time (us): "));  Serial.print(_stats.syncCount);     Serial.print(F(", ")); Serial.println(_stats.maxSyncMicros);
+    Serial.print(F("   write errors: "));             Serial.print(_stats.writeErrors);
+    Serial.print(F("   ring high-water mark: "));     Serial.print(_stats.maxRingFill);     Serial.print(F("/")); Serial.println(LOG_RING_SIZE);
+}
+#endif
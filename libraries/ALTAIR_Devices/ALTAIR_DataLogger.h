@@ -0,0 +1,148 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DataLogger.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR ring-buffered, batched data logger.
+    Binary records are appended to a ring buffer in RAM (which is cheap,
+    and never touches the SPI bus), and the ring buffer is then drained
+    to a data sink in whole 512-byte sectors, at most one sector per call
+    to service(), with a sync of the sink at a configurable cadence.  So
+    the SD card is written in the only way that it is fast at (i.e. full,
+    aligned sectors of a preallocated, contiguous file), and never opens,
+    closes or updates the FAT in the middle of a flight.
+
+    Each record is a sync byte, a record type byte, a payload length
+    byte, and then the payload (see ALTAIR_FlightRecord.h).  Any unused
+    end of the final sector is padded with zeros, which a reader just
+    skips over (until the next sync byte).
+
+    The sink is abstract: ALTAIR_DataStorageSystem provides the microSD
+    card sink, and (when not built for an Arduino) ALTAIR_HostFileLogSink
+    below writes to a regular file.  The clock sources default to the
+    HAL's clock (see ALTAIR_HAL.h); other than printStats(), this file
+    does not depend upon the Arduino libraries, so that the logger can be
+    exercised and its throughput benchmarked on a host computer without a
+    card (see tools/ALTAIRDataLoggerBench.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_DataLogger_h
+#define   ALTAIR_DataLogger_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+#endif
+#include <ALTAIR_HAL.h>
+#include "ALTAIR_FlightRecord.h"                    // the record framing (LOG_RECORD_SYNC_BYTE, etc) and record types
+
+#define   LOG_RING_SIZE               1024          // must be a multiple of LOG_SECTOR_SIZE (so that each sector is contiguous in RAM)
+#define   DEFAULT_LOG_SYNC_INTERVAL   5000          // in milliseconds
+#define   LOG_RATE_WINDOW             5000          // in milliseconds: the window over which bytesPerSecond() is measured
+
+typedef   unsigned long   (*ALTAIR_LogClockSource)(                    )  ;
+
+/**************************************************************************/
+/*!
+    A destination for whole sectors of logged data.
+*/
+/**************************************************************************/
+class     ALTAIR_LogSink {
+  public:
+    virtual bool        writeSector(    const uint8_t* sector            ) = 0;  // write exactly LOG_SECTOR_SIZE bytes; false if failed (or full)
+    virtual bool        sync(                                            ) = 0;  // make everything written so far durable
+    virtual bool        isOpen(                                          ) = 0;
+};
+
+struct    ALTAIR_LogStats {
+    unsigned long       recordsLogged                                       ;
+    unsigned long       droppedRecords                                      ;  // records that did not fit into the ring buffer (or arrived with no sink)
+    unsigned long       droppedBytes                                        ;
+    unsigned long       bytesWritten                                        ;  // to the sink, in whole sectors (including any padding)
+    unsigned long       paddingBytes                                        ;
+    unsigned long       writeErrors                                         ;
+    unsigned long       syncCount                                           ;
+    unsigned long       lastFlushMicros                                     ;  // the time taken to write the last sector (whether or not it failed)
+    unsigned long       maxFlushMicros                                      ;  //    (likewise)
+    unsigned long       totalFlushMicros                                    ;  // of the sectors written (i.e. not the failed ones): divide by bytesWritten / LOG_SECTOR_SIZE to get the mean
+    unsigned long       maxSyncMicros                                       ;
+    uint16_t            maxRingFill                                         ;  // the high-water mark of the ring buffer, in bytes
+};
+
+class     ALTAIR_DataLogger {
+  public:
+
+    ALTAIR_DataLogger(                  ALTAIR_LogClockSource millisClock = ALTAIR_HAL::clockMillis ,
+                                        ALTAIR_LogClockSource microsClock = ALTAIR_HAL::clockMicros  ) ;
+
+    void                setSink(        ALTAIR_LogSink*       sink                  ) { _sink = sink                      ; }
+    void                setSyncInterval( unsigned long        syncInterval          ) { _syncInterval = syncInterval      ; }
+
+    bool                logRecord(      uint8_t               recordType          ,
+                                        const void*           payload             ,
+                                        uint8_t               payloadLength         ) ;   // Returns false (and counts a drop) if the ring is full.
+    bool                service(                                                    ) ;   // Write at most one full sector, and sync if due.  Returns true if a sector was written.
+    bool                flush(                                                      ) ;   // Pad out the partial sector, write everything, and sync.
+
+    uint16_t            bytesQueued(                                                ) { return _count                     ; }
+    unsigned long       bytesWritten(                                               ) { return _stats.bytesWritten        ; }
+    unsigned long       bytesPerSecond(                                             ) { return _bytesPerSecond            ; }
+    const ALTAIR_LogStats* stats(                                                   ) { return &_stats                    ; }
+    void                resetStats(                                                 ) ;
+#ifdef    ARDUINO
+    void                printStats(                                                 ) ;
+#endif
+
+  private:
+    bool                writeOneSector(                                             ) ;
+    void                syncSink(                                                   ) ;
+    void                updateRate(                                                 ) ;
+
+    ALTAIR_LogClockSource _millisClock                                              ;
+    ALTAIR_LogClockSource _microsClock                                              ;
+    ALTAIR_LogSink*     _sink                                                       ;
+    uint8_t             _ring[LOG_RING_SIZE]                                        ;
+    uint16_t            _tail                                                       ;  // the index of the oldest queued byte (always on a sector boundary)
+    uint16_t            _count                                                      ;  // # of queued bytes
+    bool                _unsyncedData                                               ;
+    unsigned long       _syncInterval                                               ;
+    unsigned long       _lastSyncMillis                                             ;
+    unsigned long       _rateWindowStartMillis                                      ;
+    unsigned long       _rateWindowStartBytes                                       ;
+    unsigned long       _bytesPerSecond                                             ;
+    ALTAIR_LogStats     _stats                                                      ;
+};
+
+#ifndef   ARDUINO
+#include  <stdio.h>
+
+/**************************************************************************/
+/*!
+    A sink that writes to a regular file on a host computer (for testing
+    and benchmarking the logger without an SD card).
+*/
+/**************************************************************************/
+class     ALTAIR_HostFileLogSink : public ALTAIR_LogSink {
+  public:
+    ALTAIR_HostFileLogSink(             const char*           path                  ) { _file = fopen(path, "wb")         ; }
+    ~ALTAIR_HostFileLogSink(                                                        ) { if (_file) fclose(_file)          ; }
+
+    virtual bool        writeSector(    const uint8_t*        sector                ) { return _file && fwrite(sector, 1, LOG_SECTOR_SIZE, _file) == LOG_SECTOR_SIZE ; }
+    virtual bool        sync(                                                       ) { return _file && fflush(_file) == 0 ; }
+    virtual bool        isOpen(                                                     ) { return _file != NULL              ; }
+
+  private:
+    FILE*              _file                                                        ;
+};
+#endif    //   ifndef ARDUINO
+
+#endif    //   ifndef ALTAIR_DataLogger_h
@@ -21,6 +21,81 @@
 
 #include "ALTAIR_DataStorageSystem.h"
 #include "ALTAIR_GPSSensor.h"
+#include "ALTAIR_GlobalDeviceControl.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_SDCardLogSink::ALTAIR_SDCardLogSink() :
+    _preallocBytes(   0     ) ,
+    _position(        0     ) ,
+    _isOpen(          false )
+{
+}
+
+/**************************************************************************/
+/*!
+ @brief  Create the log file (with the first unused file name of the form
+         of DEFAULT_SDCARD_FILENAME, so that no earlier flight's data is
+         ever overwritten), preallocated as a single contiguous extent of
+         preallocBytes, and then erase that extent.  (Preallocation does
+         not clear the clusters, which may well hold an earlier, deleted
+         log, whose records a reader would otherwise take to follow the
+         last ones of this flight.  Erased sectors read as all zeros or
+         all ones, neither of which a reader mistakes for a record.)
+         Returns false if that could not be done.
+*/
+/**************************************************************************/
+bool ALTAIR_SDCardLogSink::open(  SdFat&   sd             ,
+                                  char*    fileName       ,
+                                  uint32_t preallocBytes   )
+{
+  uint8_t n;
+  for (n = 0; n < 100; ++n) {
+    fileName[SDCARD_FILENAME_DIGITS_POS    ] = '0' + n / 10                ;
+    fileName[SDCARD_FILENAME_DIGITS_POS + 1] = '0' + n % 10                ;
+    if (!sd.exists(fileName)) break                                       ;
+  }
+  if (n == 100) return false                                              ;
+  if (!_file.createContiguous(fileName, preallocBytes)) return false      ;
+  uint32_t firstBlock, lastBlock                                          ;
+  if (!_file.contiguousRange(&firstBlock, &lastBlock))  return false      ;
+  for (uint32_t block = firstBlock; block <= lastBlock; block += SDCARD_ERASE_BLOCKS) {   // (in chunks, as some cards time out erasing too much at once)
+    uint32_t endBlock = (lastBlock - block < SDCARD_ERASE_BLOCKS) ? lastBlock : block + SDCARD_ERASE_BLOCKS - 1 ;
+    if (!sd.card()->erase(block, endBlock)) return false                 ;
+  }
+  _preallocBytes = preallocBytes                                          ;
+  _position      = 0                                                      ;
+  _isOpen        = true                                                   ;
+  return true                                                             ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write one sector at the present position of the log file.
+         Since the file is preallocated, this never has to allocate a
+         cluster (i.e. never updates the FAT).
+*/
+/**************************************************************************/
+bool ALTAIR_SDCardLogSink::writeSector( const uint8_t* sector  )
+{
+  if (!_isOpen || _position + LOG_SECTOR_SIZE > _preallocBytes) return false ;
+  if (_file.write(sector, LOG_SECTOR_SIZE) != LOG_SECTOR_SIZE)  return false ;
+  _position += LOG_SECTOR_SIZE                                             ;
+  return true                                                              ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Make sure that everything written so far is on the card.
+*/
+/**************************************************************************/
+bool ALTAIR_SDCardLogSink::sync(                          )
+{
+  return (_isOpen && _file.sync())                                         ;
+}
 
 /**************************************************************************/
 /*!
@@ -39,9 +114,9 @@ ALTAIR_DataStorageSystem::ALTAIR_DataStorageSystem()
 void ALTAIR_DataStorageSystem::initialize(                        )
 {
   Serial.println(F(  "Initializing SPI bus SD card output ..."   ))   ;
-  pinMode(            DEFAULT_SDCARD_CSPIN ,         OUTPUT       )   ;
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         HIGH         )   ;   // try adding this
-  delay(              10                                          )   ;
+  ALTAIR_HAL::gpioMode(  DEFAULT_SDCARD_CSPIN ,      HAL_OUTPUT   )   ;
+  ALTAIR_HAL::gpioWrite( DEFAULT_SDCARD_CSPIN ,      HAL_HIGH     )   ;   // try adding this
+  ALTAIR_HAL::clockDelay( 10                                      )   ;
 //  if (!_SD.begin(     DEFAULT_SDCARD_CSPIN                       )) {   // try changing this to the line below
 //  if (!_SD.begin(     DEFAULT_SDCARD_CSPIN ,  SD_SCK_MHZ(  50  ) )) {        
   if (!_SD.begin(     DEFAULT_SDCARD_CSPIN ,  SD_SCK_MHZ(  2  ) )) {        
@@ -49,35 +124,28 @@ void ALTAIR_DataStorageSystem::initialize(                        )
     _SD.initErrorPrint()                                              ;
     while(1)                                                          ;
   }
-  _theSDCardFile = _SD.open(DEFAULT_SDCARD_FILENAME, FILE_WRITE   )   ;
-  if (_theSDCardFile                                              ) {
-    Serial.println(F("SD card initialization complete."          ))   ;
+  strcpy(            _fileName ,         DEFAULT_SDCARD_FILENAME  )   ;
+  if (_sink.open(     _SD , _fileName , SDCARD_LOG_PREALLOC_MB * 1048576UL )) {
+    Serial.print(F(  "SD card initialization complete.  Logging to " ))   ;
+    Serial.println(   _fileName                                       )   ;
   } else                                                            {
-    Serial.println(F("SD card file open failed."                 ))   ;
+    Serial.println(F("SD card preallocated log file creation failed."))   ;
     while(1)                                                          ;
   }
-  _theSDCardFile.close(                                           )   ;   // try adding this
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         LOW          )   ;   // try adding this
-  byte received_byte = SPI.transfer(                 SD_SPI_BYTE  )   ;   // try adding this
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         HIGH         )   ;   // try adding this
+  _logger.setSink(   &_sink                                           )   ;
+  deselectCard(                                                       )   ;
   Serial.println(F("SPI bus and device initialization complete." ))   ;
 }
 
 /**************************************************************************/
 /*!
- @brief  Return the amount of space presently occupied by _theSDCardFile,
-         in Mb.
+ @brief  Return the amount of space presently occupied by logged data
+         (i.e. the part of the preallocated log file written so far), in Mb.
 */
 /**************************************************************************/
 uint16_t ALTAIR_DataStorageSystem::occupiedSpace(                 )
 {
-  double   filesize    = _theSDCardFile.size(                     )   ;  // in bytes
-           filesize   /=           1024.                              ;  // in kb
-           filesize   /=           1024.                              ;  // in Mb
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         LOW          )   ;   // try adding this
-  byte received_byte = SPI.transfer(                 SD_SPI_BYTE  )   ;   // try adding this
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         HIGH         )   ;   // try adding this
-  return  ((uint16_t)     filesize                                )   ;  // in Mb
+  return  ((uint16_t)    (_logger.bytesWritten() / 1048576UL)     )   ;  // in Mb
 }
 
 
@@ -105,18 +173,68 @@ uint16_t ALTAIR_DataStorageSystem::remainingSpace(                )
 
 /**************************************************************************/
 /*!
- @brief  Store a GPS timestamp.
+ @brief  Store a flight record (see ALTAIR_FlightRecord.h), containing all
+         of the info that is sent down by sendAllALTAIRInfo.  (This only 
+         queues the record in RAM; it is written to the card by 
+         serviceLog().)
 */
 /**************************************************************************/
-void   ALTAIR_DataStorageSystem::storeTimestamp( ALTAIR_GPSSensor* gps )
+void   ALTAIR_DataStorageSystem::storeFlightRecord( ALTAIR_GlobalMotorControl&  motorControl  ,
+                                                    ALTAIR_GlobalDeviceControl& deviceControl ,
+                                                    ALTAIR_GlobalLightControl&  lightControl   )
 {
-  _theSDCardFile = _SD.open(DEFAULT_SDCARD_FILENAME, FILE_WRITE   )   ;  // try opening and closing before and after
-  _theSDCardFile.print("GPS UTC time: ");  
-  _theSDCardFile.print(gps->hour());  
-  _theSDCardFile.print("   Milliseconds since CPU start: ");  
-  _theSDCardFile.println(millis());  
-  _theSDCardFile.close();                                                // i.e., add this file close line too
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         LOW          )   ;   // try adding this
-  byte received_byte = SPI.transfer(                 SD_SPI_BYTE  )   ;   // try adding this
-  digitalWrite(       DEFAULT_SDCARD_CSPIN ,         HIGH         )   ;   // try adding this
+  typedef ALTAIR_FlightRecord  FR                                     ;
+  byte              record[FR::length]                                ;
+  ALTAIR_GPSSolution* gps   = deviceControl.sitAwareSystem()->gpsSensors()->solution() ;
+  ALTAIR_GenTelInt*   radio = deviceControl.telemSystem()->primary(   ) ;   // (whose type and RSSI go into the record)
+
+  FR::version   ::put(    record , FLIGHT_RECORD_VERSION          )   ;
+  FR::cpuMillis ::put(    record , millis(                      ) )   ;
+  FR::gpsHour   ::put(    record , gps->hour(                   ) )   ;
+  FR::gpsMinute ::put(    record , gps->minute(                 ) )   ;
+  FR::gpsSecond ::put(    record , gps->second(                 ) )   ;
+  radio->fillAllInfoFrame1( record + FR::frame1::offset , deviceControl                             ) ;
+  radio->fillAllInfoFrame2( record + FR::frame2::offset , motorControl , deviceControl , lightControl ) ;
+  FR::gpsHealth ::put(    record , gps->health(                 ) )   ;
+
+  _logger.logRecord(      LOG_RECORD_FLIGHT , record , FR::length )   ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write (at most) one full sector of queued records to the card,
+         and sync the log file if that is due.
+*/
+/**************************************************************************/
+bool   ALTAIR_DataStorageSystem::serviceLog(                       )
+{
+  bool wrote = _logger.service(                                   )   ;
+  if (wrote) deselectCard(                                        )   ;
+  return wrote                                                        ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write out all queued records (padding out the last sector), and
+         sync the log file.
+*/
+/**************************************************************************/
+bool   ALTAIR_DataStorageSystem::flushLog(                         )
+{
+  bool ok    = _logger.flush(                                     )   ;
+  deselectCard(                                                   )   ;
+  return ok                                                           ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Clock a dummy byte through with the card deselected, so that it
+         releases the (shared) SPI bus.
+*/
+/**************************************************************************/
+void   ALTAIR_DataStorageSystem::deselectCard(                     )
+{
+  ALTAIR_HAL::gpioWrite( DEFAULT_SDCARD_CSPIN ,      HAL_LOW      )   ;   // try adding this
+  byte received_byte = ALTAIR_HAL::spiTransfer(      SD_SPI_BYTE  )   ;   // try adding this
+  ALTAIR_HAL::gpioWrite( DEFAULT_SDCARD_CSPIN ,      HAL_HIGH     )   ;   // try adding this
 }
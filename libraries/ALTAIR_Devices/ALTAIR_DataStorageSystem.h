@@ -8,6 +8,14 @@
     storage system, located on the onboard Adafruit MicroSD card breakout 
     board.
 
+    Data is logged as binary records via an ALTAIR_DataLogger ring buffer,
+    which is drained (by serviceLog()) in whole sectors into a file that
+    is preallocated as a single contiguous extent (and erased) when the
+    card is initialized, so that logging never updates the FAT during a
+    flight.  The main loop flushes the log (i.e. writes out its last,
+    partial sector) every so often, and at a cutdown, so that little is
+    lost if the power is.
+
     This class is instantiated as a singleton via the instantiation of the
     (also singleton) ALTAIR_GlobalDeviceControl class.
 
@@ -24,14 +32,45 @@
 
 #include "Arduino.h"
 #include <SdFat.h>
+#include "ALTAIR_DataLogger.h"
+#include <ALTAIR_HAL.h>
 
 #define   DEFAULT_SDCARD_CSPIN          24
-#define   DEFAULT_SDCARD_FILENAME    "data.txt"
+#define   DEFAULT_SDCARD_FILENAME    "ALTAIR00.BIN"  // the two digits are incremented until an unused file name is found
+#define   SDCARD_FILENAME_DIGITS_POS     6
+#define   SDCARD_LOG_PREALLOC_MB        64          // size of the preallocated, contiguous log file, in MB
+#define   SDCARD_ERASE_BLOCKS        65536          // # of 512-byte blocks erased at a time, when the log file is created
 #define   SD_SPI_BYTE                 0x00
 #define   MY_SD_CARD_SIZE             8000          // in MB
 #define   SD_FILESYS_OVERHEAD          100          // in MB  (an approximate value, for now)
 
-class     ALTAIR_GPSSensor;
+class     ALTAIR_GlobalMotorControl;
+class     ALTAIR_GlobalDeviceControl;
+class     ALTAIR_GlobalLightControl;
+
+/**************************************************************************/
+/*!
+    The microSD card sink for the data logger: whole sectors are written
+    sequentially into the preallocated, contiguous file.
+*/
+/**************************************************************************/
+class     ALTAIR_SDCardLogSink : public ALTAIR_LogSink {
+  public:
+    ALTAIR_SDCardLogSink(                                     )            ;
+
+    bool                open(       SdFat&        sd              ,
+                                    char*         fileName        ,
+                                    uint32_t      preallocBytes   )        ;
+    virtual bool        writeSector( const uint8_t* sector        )        ;
+    virtual bool        sync(                                     )        ;
+    virtual bool        isOpen(                                   )            { return _isOpen        ; }
+
+  private:
+    File               _file                                               ;
+    uint32_t           _preallocBytes                                      ;
+    uint32_t           _position                                           ;
+    bool               _isOpen                                             ;
+};
 
 class     ALTAIR_DataStorageSystem {
   public:
@@ -44,12 +83,21 @@ class     ALTAIR_DataStorageSystem {
     uint16_t            occupiedSpace(                        )            ;  // current occupied  space on the disk, in Mb
     uint16_t            remainingSpace(                       )            ;  // current remaining space on the disk, in Mb
 
-    void                storeTimestamp( ALTAIR_GPSSensor* gps )            ;
+    void                storeFlightRecord( ALTAIR_GlobalMotorControl&  motorControl  ,
+                                           ALTAIR_GlobalDeviceControl& deviceControl ,
+                                           ALTAIR_GlobalLightControl&  lightControl   ) ;
+    bool                serviceLog(                           )            ;  // call often: writes at most one sector to the card
+    bool                flushLog(                             )            ;  // write out everything that is queued (e.g. before a shutdown)
+    ALTAIR_DataLogger*  logger(                               )            { return &_logger ; }
 
   protected:
 
   private:
+    void                deselectCard(                         )            ;
+
     SdFat              _SD                                                 ;
-    File               _theSDCardFile                                      ;
+    ALTAIR_SDCardLogSink _sink                                             ;
+    ALTAIR_DataLogger  _logger                                             ;
+    char               _fileName[sizeof(DEFAULT_SDCARD_FILENAME)]          ;
 };
 #endif    //   ifndef ALTAIR_DataStorageSystem_h
@@ -0,0 +1,506 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DownlinkDecoder.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ground-station telemetry frame decoder.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_DownlinkDecoder.h"
+#ifdef    ARDUINO
+#include  <avr/pgmspace.h>
+#endif                                              // (and otherwise, as in ALTAIR_TelemetryDelta.h)
+
+#define   DECODER_AWAITING_START         0
+#define   DECODER_AWAITING_LENGTH        1
+#define   DECODER_AWAITING_DATA          2
+#define   DECODER_AWAITING_SEQUENCE      3
+#define   DECODER_AWAITING_ACK_LENGTH    4
+#define   DECODER_AWAITING_ACK           5
+
+typedef   ALTAIR_AllInfoFrame1  F1;
+typedef   ALTAIR_AllInfoFrame2  F2;
+typedef   ALTAIR_PropulsionFrame  F3;
+
+static const char csvHeader1[] PROGMEM =
+    "#frame,rxMillis,latitude,longitude,elevation,gpsAge,hdop,outPres,outTemp,outHum,inPres,inTemp,inHum,"
+    "balPres,balTemp,balHum,accelZ,accelX,accelY,yaw,pitch,roll,oSensTemp,typeInfo,"
+    "rpm1,rpm2,rpm3,rpm4,current1,current2,current3,current4\n";
+static const char csvHeader2[] PROGMEM =
+    "#frame,rxMillis,temp1,temp2,temp3,temp4,temp5,temp6,temp7,temp8,rssi,bat1V,bat2V,occSpace,"
+    "powerMot1,powerMot2,powerMot3,powerMot4,axlRotSet,axlRotAng,bleedVSet,bleedVAng,cutdwnSet,cutdwnAng,"
+    "lightStat,pd1ADRead,pd2ADRead,pd3ADRead\n";
+static const char csvHeader3[] PROGMEM =
+    "#frame,rxMillis,microSeq,microAge,rpm1,rpm2,rpm3,rpm4,current1,current2,current3,current4,"
+    "temp1,temp2,temp3,temp4,temp5,temp6,temp7,temp8\n";
+
+/**************************************************************************/
+/*!
+ @brief  Integer formatting (which, unlike print(float) or printf, is cheap
+         on an AVR).  Values that fit in 16 bits are converted with 16-bit
+         divisions, which are several times faster there than 32-bit ones.
+*/
+/**************************************************************************/
+static char* putUnsigned( char* p , uint32_t value )
+{
+    char    digits[10];
+    uint8_t n = 0;
+    if (value <= 0xFFFF) {
+        uint16_t small = (uint16_t) value;
+        do { digits[n++] = '0' + small % 10; small /= 10; } while (small);
+    } else {
+        do { digits[n++] = '0' + value % 10; value /= 10; } while (value);
+    }
+    while (n) *p++ = digits[--n];
+    *p++ = ',';
+    return p;
+}
+
+static char* putSigned(   char* p , int32_t  value )
+{
+    if (value < 0) { *p++ = '-'; return putUnsigned(p, (uint32_t) (-(value + 1)) + 1); }
+    return putUnsigned(p, (uint32_t) value);
+}
+
+static char* putFixed(    char* p , int32_t  value , uint8_t decimals )      // value / 10^decimals
+{
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; ++i) scale *= 10;
+    uint32_t magnitude = (value < 0) ? (uint32_t) (-(value + 1)) + 1 : (uint32_t) value;
+    if (value < 0) *p++ = '-';
+    p = putUnsigned(p, magnitude / scale) - 1;                                  // (overwrite its comma with the decimal point)
+    *p++ = '.';
+    uint32_t fraction = magnitude % scale;
+    for (uint32_t digit = scale / 10; digit > 0; digit /= 10) { *p++ = '0' + (fraction / digit) % 10; }
+    *p++ = ',';
+    return p;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_DownlinkDecoder::ALTAIR_DownlinkDecoder( ALTAIR_RecordSink* sink   ,
+                                                uint8_t            format  ) :
+    _sink(                                                       sink ) ,
+    _format(                                                   format ) ,
+    _state(                                    DECODER_AWAITING_START ) ,
+    _frameLength(                                                   0 ) ,
+    _frameIndex(                                                    0 ) ,
+    _isDelta(                                                   false ) ,
+    _haveKeys(                                                      0 ) ,
+    _nextSequence(                                   DOWNLINK_NO_SEQUENCE ) ,
+    _sequence(                                       DOWNLINK_NO_SEQUENCE ) ,
+    _filter(                                                         NULL ) ,
+    _commandSender(                                                  NULL )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Feed in the next byte received from the radio.  A frame is only
+         recognized by its start byte followed by one of the three frame
+         lengths (or by the delta start byte followed by a length that a
+         delta can have), so anything else that is received is skipped
+         over.  Each full frame of the first two kinds is kept, as the
+         keyframe for the deltas that follow it.  A sequence byte followed
+         by a sequence # gives the sequence # of the frame whose start byte
+         comes right after it.  A command acknowledgement byte followed by
+         a count (of 1 to COMMAND_ACK_COUNT) is followed by that many
+         command sequence #s.
+*/
+/**************************************************************************/
+bool ALTAIR_DownlinkDecoder::feed( byte          aByte          ,
+                                   unsigned long receivedMillis  )
+{
+    switch (_state) {
+      case DECODER_AWAITING_START:
+        if (aByte == FRAME_START_BYTE || aByte == DELTA_FRAME_START_BYTE) {
+            _isDelta     = (aByte == DELTA_FRAME_START_BYTE);
+            _sequence    = _nextSequence;
+            _state       = DECODER_AWAITING_LENGTH;
+        } else if (aByte == FANOUT_SEQUENCE_BYTE) {
+            _state       = DECODER_AWAITING_SEQUENCE;
+        } else if (aByte == COMMAND_ACK_BYTE) {
+            _state       = DECODER_AWAITING_ACK_LENGTH;
+        } else {
+            ++_stats.skippedBytes;
+        }
+        _nextSequence    = DOWNLINK_NO_SEQUENCE;
+        return false;
+      case DECODER_AWAITING_SEQUENCE:
+        _state           = DECODER_AWAITING_START;
+        if (aByte <= FANOUT_SEQUENCE_MASK) { _nextSequence = aByte; return false; }
+        _stats.skippedBytes += 1;                                                // (the sequence byte, and then this may be a start byte)
+        return feed(aByte, receivedMillis);
+      case DECODER_AWAITING_ACK_LENGTH:
+        _state           = DECODER_AWAITING_START;
+        if (aByte >= 1 && aByte <= COMMAND_ACK_COUNT) {
+            _frameLength = aByte;
+            _frameIndex  = 0;
+            _state       = DECODER_AWAITING_ACK;
+            return false;
+        }
+        _stats.skippedBytes += 1;                                                // (the acknowledgement byte, and then this may be a start byte)
+        return feed(aByte, receivedMillis);
+      case DECODER_AWAITING_ACK:
+        _frame[_frameIndex++] = aByte;
+        if (_frameIndex < _frameLength) return false;
+        _state = DECODER_AWAITING_START;
+        ++_stats.commandAcks;
+        if (_commandSender) _commandSender->ackFrame(_frame, _frameLength, receivedMillis);
+        return false;
+      case DECODER_AWAITING_LENGTH:
+        if (_isDelta ? (aByte >= 2 && aByte <= MAX_FRAME_DATA_LENGTH)
+                     : (aByte == F1::length || aByte == F2::length || aByte == F3::length)) {
+            _frameLength = aByte;
+            _frameIndex  = 0;
+            _state       = DECODER_AWAITING_DATA;
+        } else if (aByte != FRAME_START_BYTE && aByte != DELTA_FRAME_START_BYTE) {
+            _stats.skippedBytes += 2;
+            _state       = DECODER_AWAITING_START;
+        } else {
+            ++_stats.skippedBytes;                                               // (this may be the real start byte)
+            _isDelta     = (aByte == DELTA_FRAME_START_BYTE);
+            _sequence    = DOWNLINK_NO_SEQUENCE;
+        }
+        return false;
+      default:
+        _frame[_frameIndex++] = aByte;
+        if (_frameIndex < _frameLength) return false;
+        _state = DECODER_AWAITING_START;
+        if (_isDelta) {
+            decodeDelta(_frame, _frameLength, receivedMillis);
+        } else if (decodeFrame(_frame, _frameLength, receivedMillis)) {
+            if      (_frameLength == F1::length) { memcpy(_key1, _frame, F1::length); _haveKeys |= (1 << DELTA_FRAME_TYPE_1); }
+            else if (_frameLength == F2::length) { memcpy(_key2, _frame, F2::length); _haveKeys |= (1 << DELTA_FRAME_TYPE_2); }
+        }
+        _sequence = DOWNLINK_NO_SEQUENCE;
+        return true;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Feed in a block of bytes received from the radio.
+*/
+/**************************************************************************/
+uint16_t ALTAIR_DownlinkDecoder::feed( const byte*   data           ,
+                                       uint16_t      length         ,
+                                       unsigned long receivedMillis  )
+{
+    uint16_t frames = 0;
+    for (uint16_t i = 0; i < length; ++i) if (feed(data[i], receivedMillis)) ++frames;
+    return frames;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Check the separator bytes of a frame, and write its record
+         (unless it is a duplicate, of a frame with a sequence # that
+         another radio's decoder has already written).
+*/
+/**************************************************************************/
+bool ALTAIR_DownlinkDecoder::decodeFrame( const byte*   frameData      ,
+                                          uint8_t       frameLength    ,
+                                          unsigned long receivedMillis  )
+{
+    bool    valid;
+    uint8_t recordType;
+    switch (frameLength) {
+      case F1::length:
+        valid      = F1::separator1::check(frameData) && F1::separator2::check(frameData) && F1::separator3::check(frameData);
+        recordType = LOG_RECORD_DOWNLINK_FRAME1;
+        break;
+      case F2::length:
+        valid      = F2::separator1::check(frameData) && F2::separator2::check(frameData) && F2::separator3::check(frameData);
+        recordType = LOG_RECORD_DOWNLINK_FRAME2;
+        break;
+      case F3::length:
+        valid      = F3::separator1::check(frameData) && F3::separator2::check(frameData) && F3::separator3::check(frameData);
+        recordType = LOG_RECORD_DOWNLINK_PROPULSION;
+        break;
+      default:
+        valid      = false;
+        recordType = 0;
+        break;
+    }
+    if (!valid) {
+        ++_stats.badFrames;
+        return false;
+    }
+    uint8_t frameKind;
+    if      (recordType == LOG_RECORD_DOWNLINK_FRAME1) { ++_stats.frame1Count;     frameKind = DELTA_FRAME_TYPE_1;      }
+    else if (recordType == LOG_RECORD_DOWNLINK_FRAME2) { ++_stats.frame2Count;     frameKind = DELTA_FRAME_TYPE_2;      }
+    else                                               { ++_stats.propulsionCount; frameKind = STATUS_FRAME_PROPULSION; }
+    if (_sequence != DOWNLINK_NO_SEQUENCE && _filter != NULL && !_filter->accept(frameKind, _sequence, receivedMillis)) {
+        ++_stats.duplicates;
+        return true;
+    }
+    if (_sink == NULL) return true;
+
+    uint16_t length;
+    if (_format == DOWNLINK_OUTPUT_BINARY) {
+        _record[0] = LOG_RECORD_SYNC_BYTE;
+        _record[1] = recordType;
+        _record[2] = 4 + frameLength;
+        ALTAIR_FrameField< LOG_RECORD_HEADER_LENGTH , 4 >::put(_record, (int32_t) receivedMillis);
+        memcpy(&_record[LOG_RECORD_HEADER_LENGTH + 4], frameData, frameLength);
+        length = LOG_RECORD_HEADER_LENGTH + 4 + frameLength;
+    } else {
+        char* line = (char*) _record;
+        if      (recordType == LOG_RECORD_DOWNLINK_FRAME1) length = formatCsvFrame1(    line, frameData, receivedMillis);
+        else if (recordType == LOG_RECORD_DOWNLINK_FRAME2) length = formatCsvFrame2(    line, frameData, receivedMillis);
+        else                                               length = formatCsvPropulsion(line, frameData, receivedMillis);
+    }
+    _sink->write(_record, length);
+    _stats.recordBytes += length;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reconstruct a delta frame against its keyframe, and then decode
+         it as a full frame.
+*/
+/**************************************************************************/
+bool ALTAIR_DownlinkDecoder::decodeDelta( const byte*   delta          ,
+                                          uint8_t       deltaLength    ,
+                                          unsigned long receivedMillis  )
+{
+    uint8_t     frameType = delta[0];
+    const byte* key       = (frameType == DELTA_FRAME_TYPE_1) ? _key1 : _key2;
+    if (deltaLayout(frameType) == NULL || !(_haveKeys & (1 << frameType)) || !deltaDecode(key, delta, deltaLength, _reconstructed)) {
+        ++_stats.badDeltas;
+        return false;
+    }
+    ++_stats.deltaFrames;
+    return decodeFrame(_reconstructed, deltaLayout(frameType)->length, receivedMillis);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Format a first frame as a CSV line (in the same units as the
+         channels of tools/ALTAIRFlightLogReader).
+*/
+/**************************************************************************/
+uint16_t ALTAIR_DownlinkDecoder::formatCsvFrame1( char*         line           ,
+                                                  const byte*   d              ,
+                                                  unsigned long receivedMillis  )
+{
+    char* p = line;
+    *p++ = '1'; *p++ = ',';
+    p = putUnsigned(p, receivedMillis);
+    p = putFixed(   p, F1::latitude ::get(d), 6);                               // degrees
+    p = putFixed(   p, F1::longitude::get(d), 6);
+    p = putSigned(  p, F1::elevation::get(d));                                  // m
+    p = putUnsigned(p, F1::age      ::get(d) * 256UL);                          // ms
+    p = putUnsigned(p, F1::hdop     ::get(d));
+    p = putUnsigned(p, F1::outPres  ::get(d) * 2UL);                            // Pa
+    p = putSigned(  p, F1::outTemp  ::get(d));                                  // C
+    p = putUnsigned(p, F1::outHum   ::get(d));                                  // %
+    p = putUnsigned(p, F1::inPres   ::get(d) * 2UL);
+    p = putSigned(  p, F1::inTemp   ::get(d));
+    p = putUnsigned(p, F1::inHum    ::get(d));
+    p = putUnsigned(p, F1::balPres  ::get(d) * 2UL);
+    p = putSigned(  p, F1::balTemp  ::get(d));
+    p = putUnsigned(p, F1::balHum   ::get(d));
+    p = putUnsigned(p, F1::accelZ   ::get(d));
+    p = putUnsigned(p, F1::accelX   ::get(d));
+    p = putUnsigned(p, F1::accelY   ::get(d));
+    p = putUnsigned(p, F1::yaw      ::get(d));
+    p = putUnsigned(p, F1::pitch    ::get(d));
+    p = putUnsigned(p, F1::roll     ::get(d));
+    p = putSigned(  p, F1::oSensTemp::get(d));
+    p = putUnsigned(p, F1::typeInfo ::get(d));
+    for (uint8_t i = 0; i < 4; ++i) p = putSigned(p, F1::packedRPM::get(d, i) * 60L);        // RPM
+    for (uint8_t i = 0; i < 4; ++i) p = putFixed( p, F1::packedCur::get(d, i) * 25L, 2);     // A
+    p[-1] = '\n';
+    return p - line;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Format a second frame as a CSV line.
+*/
+/**************************************************************************/
+uint16_t ALTAIR_DownlinkDecoder::formatCsvFrame2( char*         line           ,
+                                                  const byte*   d              ,
+                                                  unsigned long receivedMillis  )
+{
+    char* p = line;
+    *p++ = '2'; *p++ = ',';
+    p = putUnsigned(p, receivedMillis);
+    for (uint8_t i = 0; i < 8; ++i) p = putFixed( p, F2::packedTemp::get(d, i) * 5L, 1);     // C
+    p = putSigned(  p, F2::rssi     ::get(d));                                  // dBm
+    p = putFixed(   p, (F2::bat1V   ::get(d) * 100000L + 909) / 1818, 3);       // V
+    p = putFixed(   p, (F2::bat2V   ::get(d) * 100000L + 909) / 1818, 3);
+    p = putUnsigned(p, F2::occSpace ::get(d));                                  // MB
+    p = putFixed(   p, F2::powerMot1::get(d), 1);
+    p = putFixed(   p, F2::powerMot2::get(d), 1);
+    p = putFixed(   p, F2::powerMot3::get(d), 1);
+    p = putFixed(   p, F2::powerMot4::get(d), 1);
+    p = putFixed(   p, F2::axlRotSet::get(d), 1);
+    p = putFixed(   p, F2::axlRotAng::get(d) * 2L, 2);                          // V
+    p = putFixed(   p, F2::bleedVSet::get(d), 1);
+    p = putFixed(   p, F2::bleedVAng::get(d) * 2L, 2);
+    p = putFixed(   p, F2::cutdwnSet::get(d), 1);
+    p = putFixed(   p, F2::cutdwnAng::get(d) * 2L, 2);
+    p = putUnsigned(p, F2::lightStat::get(d));
+    p = putUnsigned(p, F2::pd1ADRead::get(d));
+    p = putUnsigned(p, F2::pd2ADRead::get(d));
+    p = putUnsigned(p, F2::pd3ADRead::get(d));
+    p[-1] = '\n';
+    return p - line;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Format an extended propulsion frame as a CSV line.
+*/
+/**************************************************************************/
+uint16_t ALTAIR_DownlinkDecoder::formatCsvPropulsion( char*         line           ,
+                                                      const byte*   d              ,
+                                                      unsigned long receivedMillis  )
+{
+    char* p = line;
+    *p++ = '3'; *p++ = ',';
+    p = putUnsigned(p, receivedMillis);
+    p = putUnsigned(p, F3::microSeq ::get(d));
+    p = putUnsigned(p, F3::microAge ::get(d));                                  // ms
+    for (uint8_t i = 0; i < 4; ++i) p = putUnsigned(p, F3::getRPM(    d, i));      // RPM
+    for (uint8_t i = 0; i < 4; ++i) p = putFixed(   p, F3::getCurrent(d, i), 2);   // A
+    for (uint8_t i = 0; i < 8; ++i) p = putFixed(   p, F3::getTemp(   d, i), 1);   // C
+    p[-1] = '\n';
+    return p - line;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_SequenceFilter::ALTAIR_SequenceFilter(                      )
+{
+    reset();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Forget every sequence # seen.
+*/
+/**************************************************************************/
+void ALTAIR_SequenceFilter::reset(                                 )
+{
+    memset(_seen,       0, sizeof(_seen));
+    memset(_latest,     0, sizeof(_latest));
+    memset(_started,    0, sizeof(_started));
+    memset(_lastMillis, 0, sizeof(_lastMillis));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Has a frame of this kind with this sequence # not been seen yet?
+         A sequence # up to SEQUENCE_FILTER_AHEAD ahead of the latest one
+         becomes the latest (and the sequence #s in between, last seen 128
+         ago, are forgotten), and one behind it is new only if it was not
+         seen.  (So a frame that comes late via a slow radio is still
+         recognized.)
+*/
+/**************************************************************************/
+bool ALTAIR_SequenceFilter::accept( uint8_t       frameKind      ,
+                                    uint8_t       sequence       ,
+                                    unsigned long receivedMillis  )
+{
+    if (frameKind < 1 || frameKind > NUM_STATUS_FRAMES) return true;
+    uint8_t k = frameKind - 1;
+    byte*   seen = _seen[k];
+    sequence &= FANOUT_SEQUENCE_MASK;
+
+    if (!_started[k] || receivedMillis - _lastMillis[k] > SEQUENCE_FILTER_TIMEOUT) {
+        memset(seen, 0, sizeof(_seen[k]));
+        _latest[k]  = sequence;
+        _started[k] = true;
+    } else {
+        uint8_t ahead = (sequence - _latest[k]) & FANOUT_SEQUENCE_MASK;
+        if (ahead >= 1 && ahead <= SEQUENCE_FILTER_AHEAD) {
+            for (uint8_t s = 1; s <= ahead; ++s) {
+                uint8_t n = (_latest[k] + s) & FANOUT_SEQUENCE_MASK;
+                seen[n >> 3] &= ~(1 << (n & 7));
+            }
+            _latest[k] = sequence;
+        } else if (seen[sequence >> 3] & (1 << (sequence & 7))) {
+            return false;
+        }
+    }
+    seen[sequence >> 3] |= (1 << (sequence & 7));
+    _lastMillis[k]       = receivedMillis;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write '#' comment lines naming the columns of the CSV records.
+*/
+/**************************************************************************/
+void ALTAIR_DownlinkDecoder::writeCsvHeader(                       )
+{
+    if (_format != DOWNLINK_OUTPUT_CSV) return;
+    writeText(csvHeader1);
+    writeText(csvHeader2);
+    writeText(csvHeader3);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write a '#' comment line with the decoder statistics.
+*/
+/**************************************************************************/
+void ALTAIR_DownlinkDecoder::writeCsvStats(                        )
+{
+    if (_format != DOWNLINK_OUTPUT_CSV || _sink == NULL) return;
+    char* line = (char*) _record;
+    char* p    = line;
+    memcpy(p, "#stats,", 7); p += 7;
+    p = putUnsigned(p, _stats.frame1Count);
+    p = putUnsigned(p, _stats.frame2Count);
+    p = putUnsigned(p, _stats.propulsionCount);
+    p = putUnsigned(p, _stats.badFrames);
+    p = putUnsigned(p, _stats.skippedBytes);
+    p = putUnsigned(p, _stats.recordBytes);
+    p = putUnsigned(p, _stats.deltaFrames);
+    p = putUnsigned(p, _stats.badDeltas);
+    p = putUnsigned(p, _stats.duplicates);
+    p = putUnsigned(p, _stats.commandAcks);
+    p[-1] = '\n';
+    _sink->write(_record, p - line);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Write a string (which is in program memory, on an AVR) to the
+         sink, via the record buffer, in as few writes as will fit.
+*/
+/**************************************************************************/
+void ALTAIR_DownlinkDecoder::writeText( const char* text )
+{
+    if (_sink == NULL) return;
+    uint16_t length = 0;
+    char     c;
+    while ((c = pgm_read_byte(text++)) != '\0') {
+        _record[length++] = c;
+        if (length == DOWNLINK_MAX_RECORD_LENGTH) { _sink->write(_record, length); length = 0; }
+    }
+    if (length) _sink->write(_record, length);
+}
@@ -0,0 +1,171 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_DownlinkDecoder.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ground-station decoder of the telemetry
+    frames that ALTAIR sends down (via sendAllALTAIRInfo).  Bytes from the
+    radio are fed in as they arrive, one at a time, through a small state
+    machine (so nothing ever waits for the rest of a frame), and each
+    complete frame is fully unpacked, with the field definitions in
+    ALTAIR_TelemetryFrames.h, into a single record, which is handed to a
+    record sink in one write.
+
+    Records are either one CSV line per frame (formatted with integer
+    arithmetic only, i.e. with no floating point and no printf), with the
+    frame number (1 or 2, or 3 for the extended propulsion frame) and the time at which the frame was received in
+    the first two columns, or else binary records with the same framing
+    as the onboard data logger (see ALTAIR_FlightRecord.h), which are
+    barely longer than the frames themselves.
+
+    Delta frames (see ALTAIR_TelemetryDelta.h) are reconstructed against
+    the last keyframe (i.e. full frame) of their kind that was received,
+    and are then decoded just as full frames are, so the records are the
+    same whichever way the frames were sent.
+
+    Frames that were fanned out to several radios at once (see
+    ALTAIR_LinkEncoder.h) carry a sequence number.  With one decoder per
+    radio, all sharing one ALTAIR_SequenceFilter (and one sink), the
+    records from all of the radios are merged: the first copy of each
+    frame to arrive, via whichever radio, is written, and the later copies
+    are counted as duplicates and dropped.  (Each decoder still keeps its
+    radio's keyframes, for the deltas that follow on that radio.)
+
+    ALTAIR's acknowledgements of the commands sent up (see
+    ALTAIR_CommandARQ.h) arrive mixed in with the frames, and are handed
+    to the command sender, if one is set.
+
+    This file does not depend upon the Arduino libraries, so that the
+    decoder can also be run (and benchmarked) on a host computer (see
+    tools/ALTAIRDownlinkReplay.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_DownlinkDecoder_h
+#define   ALTAIR_DownlinkDecoder_h
+
+#include "ALTAIR_TelemetryFrames.h"
+#include "ALTAIR_FlightRecord.h"                    // the binary record framing, and LOG_RECORD_DOWNLINK_FRAME1, etc
+#include "ALTAIR_TelemetryDelta.h"
+#include "ALTAIR_LinkEncoder.h"                     // FANOUT_SEQUENCE_BYTE, etc
+#include "ALTAIR_CommandARQ.h"                      // COMMAND_ACK_BYTE, etc
+
+#define   DOWNLINK_OUTPUT_CSV            0
+#define   DOWNLINK_OUTPUT_BINARY         1
+#define   DOWNLINK_MAX_RECORD_LENGTH   256          // (the longest possible CSV line is under 200 characters)
+#define   DOWNLINK_NO_SEQUENCE        0xFF
+#define   SEQUENCE_FILTER_AHEAD         63          // the furthest that a new sequence # may be ahead of the latest one
+#define   SEQUENCE_FILTER_TIMEOUT    30000          // in milliseconds: after this long without a frame of a kind, its window starts over
+
+/**************************************************************************/
+/*!
+    A destination for decoded records (e.g. the USB serial port).
+*/
+/**************************************************************************/
+class     ALTAIR_RecordSink {
+  public:
+    virtual void        write(          const byte*           data                ,
+                                        uint16_t              length                ) = 0;
+};
+
+/**************************************************************************/
+/*!
+    The duplicate filter shared by the decoders of all of the radios: for
+    each kind of frame, which of the last 128 sequence #s have been seen.
+*/
+/**************************************************************************/
+class     ALTAIR_SequenceFilter {
+  public:
+
+    ALTAIR_SequenceFilter(                                                  ) ;
+
+    bool                accept(         uint8_t               frameKind           ,       // Returns false if this frame (of kind 1 to
+                                        uint8_t               sequence            ,       //    NUM_STATUS_FRAMES) has already been seen.
+                                        unsigned long         receivedMillis        ) ;
+    void                reset(                                                      ) ;
+
+  private:
+    byte                _seen[NUM_STATUS_FRAMES][(FANOUT_SEQUENCE_MASK + 1) / 8]    ;  // (bit n: sequence # n)
+    uint8_t             _latest[NUM_STATUS_FRAMES]                                  ;
+    bool                _started[NUM_STATUS_FRAMES]                                 ;
+    unsigned long       _lastMillis[NUM_STATUS_FRAMES]                              ;
+};
+
+struct    ALTAIR_DownlinkStats {
+    unsigned long       frame1Count                                         ;
+    unsigned long       frame2Count                                         ;
+    unsigned long       propulsionCount                                     ;  // extended propulsion frames
+    unsigned long       badFrames                                           ;  // the right length, but with a bad separator byte
+    unsigned long       skippedBytes                                        ;  // bytes outside of any frame (e.g. call signs, or line noise)
+    unsigned long       recordBytes                                         ;  // written to the sink
+    unsigned long       deltaFrames                                         ;  // (frame1Count and frame2Count include these)
+    unsigned long       badDeltas                                           ;  // malformed, or without the keyframe that they were against
+    unsigned long       duplicates                                          ;  // (counted above, but not written, as another radio's decoder got them first)
+    unsigned long       commandAcks                                         ;  // acknowledgement frames
+};
+
+class     ALTAIR_DownlinkDecoder {
+  public:
+
+    ALTAIR_DownlinkDecoder(             ALTAIR_RecordSink*    sink                ,
+                                        uint8_t               format       = DOWNLINK_OUTPUT_CSV ) ;
+
+    bool                feed(           byte                  aByte               ,       // Returns true if aByte completed a frame.
+                                        unsigned long         receivedMillis        ) ;
+    uint16_t            feed(           const byte*           data                ,       // Returns the # of frames completed.
+                                        uint16_t              length              ,
+                                        unsigned long         receivedMillis        ) ;
+    bool                decodeFrame(    const byte*           frameData           ,       // Decode one frame's data (i.e. after the
+                                        uint8_t               frameLength         ,       //    start and length bytes), and write its
+                                        unsigned long         receivedMillis        ) ;   //    record.  Returns false if it is invalid.
+
+    void                setSequenceFilter( ALTAIR_SequenceFilter* filter        ) { _filter = filter                   ; }
+    void                setCommandSender(  ALTAIR_CommandSender*  sender        ) { _commandSender = sender            ; }
+
+    void                writeCsvHeader(                                             ) ;   // '#' comment lines naming the columns of each frame's records
+    void                writeCsvStats(                                              ) ;   // a '#' comment line with the statistics
+
+    const ALTAIR_DownlinkStats* stats(                                              ) { return &_stats                    ; }
+
+  private:
+    uint16_t            formatCsvFrame1( char*                line                ,
+                                        const byte*           data                ,
+                                        unsigned long         receivedMillis        ) ;
+    uint16_t            formatCsvFrame2( char*                line                ,
+                                        const byte*           data                ,
+                                        unsigned long         receivedMillis        ) ;
+    uint16_t            formatCsvPropulsion( char*            line                ,
+                                        const byte*           data                ,
+                                        unsigned long         receivedMillis        ) ;
+    bool                decodeDelta(    const byte*           delta               ,
+                                        uint8_t               deltaLength         ,
+                                        unsigned long         receivedMillis        ) ;
+    void                writeText(      const char*           text                  ) ;
+
+    ALTAIR_RecordSink*  _sink                                                       ;
+    uint8_t             _format                                                     ;
+    uint8_t             _state                                                      ;  // awaiting the start byte, the length byte, data, a sequence #, or an acknowledgement
+    uint8_t             _frameLength                                                ;
+    uint8_t             _frameIndex                                                 ;
+    bool                _isDelta                                                    ;  // (the frame being received)
+    byte                _frame[MAX_FRAME_DATA_LENGTH]                               ;
+    byte                _key1[ALTAIR_AllInfoFrame1::length]                         ;  // the last keyframes received
+    byte                _key2[ALTAIR_AllInfoFrame2::length]                         ;
+    uint8_t             _haveKeys                                                   ;  // (bit n: a keyframe of type n)
+    uint8_t             _nextSequence                                               ;  // (from a sequence byte just before the start byte)
+    uint8_t             _sequence                                                   ;  // the frame's, or DOWNLINK_NO_SEQUENCE
+    ALTAIR_SequenceFilter* _filter                                                  ;
+    ALTAIR_CommandSender* _commandSender                                            ;
+    byte                _reconstructed[MAX_FRAME_DATA_LENGTH]                       ;
+    byte                _record[DOWNLINK_MAX_RECORD_LENGTH]                         ;
+    ALTAIR_DownlinkStats _stats                                                     ;
+};
+
+#endif    //   ifndef ALTAIR_DownlinkDecoder_h
@@ -0,0 +1,76 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_FlightRecord.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This file contains the format of the data logged onto the onboard
+    microSD card: the record framing that is used by ALTAIR_DataLogger,
+    and the layout of the versioned, fixed-width flight record, which
+    holds every quantity that is sent down by sendAllALTAIRInfo (in the
+    very same layout as the two telemetry frames, so that the same field
+    definitions in ALTAIR_TelemetryFrames.h decode both).
+
+    This file does not depend upon the Arduino libraries, so that it can
+    also be included by the host-side tools that read the logged data
+    (see tools/ALTAIRFlightLogReader.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_FlightRecord_h
+#define   ALTAIR_FlightRecord_h
+
+#include "ALTAIR_TelemetryFrames.h"
+
+#define   LOG_SECTOR_SIZE              512
+#define   LOG_RECORD_SYNC_BYTE        0xA5
+#define   LOG_RECORD_HEADER_LENGTH       3          // the sync byte, the record type, and then the payload length
+#define   LOG_MAX_PAYLOAD_LENGTH       255
+
+#define   LOG_RECORD_FLIGHT           0x02          // payload: an ALTAIR_FlightRecord
+#define   LOG_RECORD_DOWNLINK_FRAME1  0x03          // payload: the 4-byte (big-endian) millis() at which a ground station received
+#define   LOG_RECORD_DOWNLINK_FRAME2  0x04          //    the frame, and then the frame data (see ALTAIR_DownlinkDecoder.h)
+#define   LOG_RECORD_DOWNLINK_PROPULSION 0x05       //    (likewise, for an ALTAIR_PropulsionFrame)
+#define   FLIGHT_RECORD_VERSION          2          // increment this whenever the layout below changes
+
+/**************************************************************************/
+/*!
+    The flight record: a version byte, millis() at the time the record was
+    made, the GPS UTC time, the data of both telemetry frames, and then
+    (from version 2 on) the GPS monitor's health word (see
+    ALTAIR_GPSMonitor.h).
+
+    A new version only ever appends fields at the end, so that a record of
+    an older version is a prefix of the present layout, and its fields are
+    decoded with the very same definitions (see versionLength()).
+*/
+/**************************************************************************/
+struct ALTAIR_FlightRecord {
+    typedef ALTAIR_FrameField<                       0 , 1                  >  version     ;  // = FLIGHT_RECORD_VERSION
+    typedef ALTAIR_FrameField<           version::end  , 4                  >  cpuMillis   ;  // milliseconds since CPU start
+    typedef ALTAIR_FrameField<         cpuMillis::end  , 1                  >  gpsHour     ;  // GPS UTC time
+    typedef ALTAIR_FrameField<           gpsHour::end  , 1                  >  gpsMinute   ;
+    typedef ALTAIR_FrameField<         gpsMinute::end  , 1                  >  gpsSecond   ;
+    typedef ALTAIR_FrameByteArray<     gpsSecond::end  , ALTAIR_AllInfoFrame1::length >  frame1 ;  // decode with the ALTAIR_AllInfoFrame1 fields
+    typedef ALTAIR_FrameByteArray<        frame1::end  , ALTAIR_AllInfoFrame2::length >  frame2 ;  // decode with the ALTAIR_AllInfoFrame2 fields
+    typedef ALTAIR_FrameField<            frame2::end  , 2                  >  gpsHealth   ;  // ALTAIR_GPSMonitor::health()  (version 2 on)
+
+    enum { length = gpsHealth::end };                                                         // = 86 bytes
+
+// the length of a record of the given version (0 if there is no such version)
+    static uint8_t  versionLength(    uint8_t  recordVersion ) {
+        switch (recordVersion) {
+            case 1:  return frame2::end;                                                      // = 84 bytes
+            case 2:  return gpsHealth::end;
+            default: return 0;
+        }
+    }
+};
+
+#endif    //   ifndef ALTAIR_FlightRecord_h
@@ -0,0 +1,212 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_GPSMonitor.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR GPS consistency monitor (see
+    ALTAIR_GPSMonitor.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include "ALTAIR_GPSMonitor.h"
+
+#define   GPS_METERS_PER_DEGREE     111195.0        // (of latitude, on a spherical Earth)
+#define   GPS_SAME_FIX_MILLIS           20          // (two fixes whose ages put them closer together than this are the same fix)
+
+/**************************************************************************/
+/*!
+ @brief  Wrap a difference of longitudes into [-180, 180).
+*/
+/**************************************************************************/
+static double wrap180( double angle )
+{
+    while (angle >=  180.) angle -= 360.;
+    while (angle <  -180.) angle += 360.;
+    return angle;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_GPSMonitor::ALTAIR_GPSMonitor(                             )
+{
+    memset(_receivers, 0, sizeof(_receivers));
+    for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) _receivers[r].faults = GPS_FAULT_NOFIX;
+    _valid     = false;
+    _lat       = 0.;
+    _lon       = 0.;
+    _ele       = 0;
+    _fixMillis = 0;
+    _source    = GPS_SOURCE_NONE;
+    _health    = GPS_HEALTH_NO_SOLUTION | GPS_FAULT_NOFIX | (GPS_FAULT_NOFIX << GPS_FAULT_BITS);
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  The horizontal distance between two positions, in meters (flat
+         Earth: good to far better than the thresholds, at the distances
+         at which they matter).
+*/
+/**************************************************************************/
+double ALTAIR_GPSMonitor::metersApart( double lat1 , double lon1 , double lat2 , double lon2 )
+{
+    double north = (lat2 - lat1) * GPS_METERS_PER_DEGREE;
+    double east  = wrap180(lon2 - lon1) * GPS_METERS_PER_DEGREE * cos((lat1 + lat2) * M_PI / 360.);
+    return sqrt(north * north + east * east);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Check one receiver's fix against its history, and set its
+         faults (all but the disagreement with the other one).
+*/
+/**************************************************************************/
+void ALTAIR_GPSMonitor::check( Receiver&             receiver  ,
+                               const ALTAIR_GPSFix&  fix       ,
+                               unsigned long         nowMillis )
+{
+    uint8_t before  = receiver.faults;
+    receiver.faults = 0;
+    if (fix.age == GPS_NO_FIX_AGE) {
+        receiver.faults = GPS_FAULT_NOFIX;
+        return;
+    }
+
+    unsigned long fixMillis = nowMillis - fix.age;
+    if (!receiver.hasFix || (long) (fixMillis - receiver.fixMillis) > GPS_SAME_FIX_MILLIS) {
+        bool changed = !receiver.hasFix || fix.lat != receiver.lat || fix.lon  != receiver.lon
+                                        || fix.ele != receiver.ele || fix.time != receiver.time;
+        if (receiver.hasFix && changed) {
+            double seconds = (fixMillis - receiver.fixMillis) / 1000.;
+            if (metersApart(receiver.lat, receiver.lon, fix.lat, fix.lon) > GPS_MAX_SPEED_MPS * seconds) {
+                receiver.jumped     = true;
+                receiver.jumpMillis = nowMillis;
+                ++_stats.jumps;
+            }
+        }
+        if (changed) receiver.changeMillis = nowMillis;
+        receiver.hasFix    = true;
+        receiver.lat       = fix.lat;
+        receiver.lon       = fix.lon;
+        receiver.ele       = fix.ele;
+        receiver.time      = fix.time;
+        receiver.fixMillis = fixMillis;
+    }
+
+    if      (fix.age > GPS_STALE_MILLIS)                            receiver.faults |= GPS_FAULT_STALE;
+    else if (nowMillis - receiver.changeMillis > GPS_FROZEN_MILLIS) receiver.faults |= GPS_FAULT_FROZEN;
+    if (receiver.jumped) {
+        if (nowMillis - receiver.jumpMillis < GPS_JUMP_HOLD_MILLIS) receiver.faults |= GPS_FAULT_DIVERGED;
+        else                                                        receiver.jumped  = false;
+    }
+
+    if ((receiver.faults & GPS_FAULT_STALE ) && !(before & GPS_FAULT_STALE )) ++_stats.stale;
+    if ((receiver.faults & GPS_FAULT_FROZEN) && !(before & GPS_FAULT_FROZEN)) ++_stats.frozen;
+}
+
+/**************************************************************************/
+/*!
+ @brief  One update: check each receiver's fix, cross-check the two, and
+         form the solution from the ones that are left.
+*/
+/**************************************************************************/
+void ALTAIR_GPSMonitor::update( const ALTAIR_GPSFix*  fixes     ,
+                                uint8_t               preferred ,
+                                unsigned long         nowMillis )
+{
+    uint16_t  before = _health;
+    bool      usable[GPS_NUM_RECEIVERS];
+    for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) {
+        check(_receivers[r], fixes[r], nowMillis);
+        usable[r] = (_receivers[r].faults == 0);
+    }
+
+    Receiver& neo    = _receivers[GPS_RECEIVER_NEOM8N];
+    Receiver& g6     = _receivers[GPS_RECEIVER_DFROBOTG6];
+    _health          = 0;
+    if (usable[GPS_RECEIVER_NEOM8N] && usable[GPS_RECEIVER_DFROBOTG6] &&
+        (metersApart(neo.lat, neo.lon, g6.lat, g6.lon) > GPS_DIVERGE_METERS || labs(neo.ele - g6.ele) > GPS_DIVERGE_ELE_METERS)) {
+        uint8_t wrong;
+        if (_valid && nowMillis - _fixMillis < GPS_TRUST_MILLIS) {
+            double neoOff = metersApart(_lat, _lon, neo.lat, neo.lon) + labs(neo.ele - _ele);
+            double g6Off  = metersApart(_lat, _lon,  g6.lat,  g6.lon) + labs( g6.ele - _ele);
+            wrong         = (neoOff > g6Off) ? GPS_RECEIVER_NEOM8N : GPS_RECEIVER_DFROBOTG6;
+        } else {
+            wrong         = (preferred == GPS_RECEIVER_NEOM8N) ? GPS_RECEIVER_DFROBOTG6 : GPS_RECEIVER_NEOM8N;
+        }
+        _receivers[wrong].faults |= GPS_FAULT_DIVERGED;
+        usable[wrong]             = false;
+        _health                  |= GPS_HEALTH_DISAGREE;
+        if (!(before & GPS_HEALTH_DISAGREE)) ++_stats.disagreements;
+    }
+
+    if (usable[GPS_RECEIVER_NEOM8N] && usable[GPS_RECEIVER_DFROBOTG6]) {
+        _lat        = (neo.lat + g6.lat) / 2.;
+        _lon        = wrap180(neo.lon + wrap180(g6.lon - neo.lon) / 2.);
+        _ele        = (neo.ele + g6.ele) / 2;
+        _fixMillis  = neo.fixMillis + (long) (g6.fixMillis - neo.fixMillis) / 2;
+        _source     = GPS_SOURCE_BLENDED;
+        _valid      = true;
+        _health    |= GPS_HEALTH_BLENDED;
+        ++_stats.blended;
+    } else if (usable[GPS_RECEIVER_NEOM8N] || usable[GPS_RECEIVER_DFROBOTG6]) {
+        _source     = usable[GPS_RECEIVER_NEOM8N] ? GPS_RECEIVER_NEOM8N : GPS_RECEIVER_DFROBOTG6;
+        Receiver& r = _receivers[_source];
+        _lat        = r.lat;
+        _lon        = r.lon;
+        _ele        = r.ele;
+        _fixMillis  = r.fixMillis;
+        _valid      = true;
+        ++_stats.single;
+    } else {
+        _source     = GPS_SOURCE_NONE;
+        _health    |= GPS_HEALTH_NO_SOLUTION;
+        ++_stats.noSolution;
+    }
+
+    for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) _health |= ((uint16_t) _receivers[r].faults) << (GPS_FAULT_BITS * r);
+    ++_stats.updates;
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the solution, its health, and the
+         statistics.
+*/
+/**************************************************************************/
+void ALTAIR_GPSMonitor::printStats(                               )
+{
+    Serial.println(F("GPS monitor:"));
+    Serial.print(F("   solution: "));
+    if (!_valid) Serial.println(F("none yet"));
+    else {
+        Serial.print(_lat, 6);  Serial.print(F(", "));  Serial.print(_lon, 6);  Serial.print(F(", "));  Serial.print(_ele);
+        Serial.print(F(" m, from "));
+        if      (_source == GPS_SOURCE_BLENDED)    Serial.print(F("both"));
+        else if (_source == GPS_RECEIVER_NEOM8N)   Serial.print(F("the NEO-M8N"));
+        else if (_source == GPS_RECEIVER_DFROBOTG6) Serial.print(F("the DFRobot G6"));
+        else                                       Serial.print(F("neither (kept)"));
+        Serial.print(F(", age (ms): "));  Serial.println(millis() - _fixMillis);
+    }
+    Serial.print(F("   health: 0x"));  Serial.print(_health, HEX);
+    Serial.print(F("   (NEO-M8N faults 0x"));  Serial.print(GPS_HEALTH_FAULTS(_health, GPS_RECEIVER_NEOM8N), HEX);
+    Serial.print(F(", G6 faults 0x"));          Serial.print(GPS_HEALTH_FAULTS(_health, GPS_RECEIVER_DFROBOTG6), HEX);  Serial.println(F(")"));
+    Serial.print(F("   updates / blended / single / none: "));  Serial.print(_stats.updates);  Serial.print(F(" / "));
+    Serial.print(_stats.blended);  Serial.print(F(" / "));  Serial.print(_stats.single);  Serial.print(F(" / "));  Serial.println(_stats.noSolution);
+    Serial.print(F("   disagreements / jumps / frozen / stale: "));  Serial.print(_stats.disagreements);  Serial.print(F(" / "));
+    Serial.print(_stats.jumps);  Serial.print(F(" / "));  Serial.print(_stats.frozen);  Serial.print(F(" / "));  Serial.println(_stats.stale);
+}
+#endif
@@ -0,0 +1,173 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_GPSMonitor.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR GPS consistency monitor, which checks
+    the fixes of both GPS receivers (the NEO-M8N on the mast, and the
+    DFRobot G6 atop the payload) against their own histories and against
+    each other, and blends the ones that it trusts into one solution, so
+    that a receiver that fails does not need the operator to notice it and
+    switch to the other one ('G').
+
+    At each update (see ALTAIR_GPSSensors::poll), each receiver's fix is
+    given a set of faults:
+
+      GPS_FAULT_NOFIX     it has never had a fix
+      GPS_FAULT_STALE     its fix is older than GPS_STALE_MILLIS
+      GPS_FAULT_FROZEN    new fixes keep arriving, but neither their time
+                          nor their position has changed at all for
+                          GPS_FROZEN_MILLIS (e.g. the UM7 repeating the
+                          G6's last packet)
+      GPS_FAULT_DIVERGED  its fix jumped from its last one faster than
+                          GPS_MAX_SPEED_MPS (and GPS_JUMP_HOLD_MILLIS has
+                          not yet passed), or it disagrees with the other
+                          receiver's, and is the one that was judged wrong
+
+    The two receivers disagree when their fixes are more than
+    GPS_DIVERGE_METERS apart horizontally, or GPS_DIVERGE_ELE_METERS in
+    elevation; the one that is then judged wrong is the one that is
+    further from the last solution (or, if there is no recent solution,
+    the one that is not preferred, i.e. not ALTAIR_GPSSensors::primary()).
+
+    The solution is the mean of the fixes of the receivers with no
+    faults (the receivers do not report comparable uncertainties: the G6's
+    HDOP does not come through the UM7), or, if neither has a fix without
+    faults, the last solution, kept (so that its age grows).  health()
+    packs all of this into one 16-bit word: the faults of the NEO-M8N in
+    bits 0-3, those of the G6 in bits 4-7, and then the GPS_HEALTH_* flags.
+
+    Positions are in degrees, and elevations in meters; times are the
+    receiver's UTC time in seconds since 0000 UT (0 if it does not know),
+    and millis() on the CPU.
+
+    This file does not depend upon the Arduino libraries, so that the
+    monitor can also be run on a host computer (see
+    tools/ALTAIRGPSMonitorSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_GPSMonitor_h
+#define   ALTAIR_GPSMonitor_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+#endif
+
+#define   GPS_RECEIVER_NEOM8N                0          // the receivers (as the healthy values of gpssensor_t)
+#define   GPS_RECEIVER_DFROBOTG6             1
+#define   GPS_NUM_RECEIVERS                  2
+#define   GPS_SOURCE_BLENDED                 2          // (the solution's source, when it is the mean of both)
+#define   GPS_SOURCE_NONE                 0xFF
+
+#define   GPS_NO_FIX_AGE            0xFFFFFFFF          // the age of a receiver's fix, when it has never had one (as TinyGPS++'s)
+
+#define   GPS_FAULT_NOFIX                 0x01          // each receiver's faults (see above)
+#define   GPS_FAULT_STALE                 0x02
+#define   GPS_FAULT_FROZEN                0x04
+#define   GPS_FAULT_DIVERGED              0x08
+#define   GPS_FAULT_BITS                     4          // (the faults of receiver r are at bit GPS_FAULT_BITS*r of health())
+
+#define   GPS_HEALTH_DISAGREE            0x100          // the two receivers disagree
+#define   GPS_HEALTH_BLENDED             0x200          // the solution is the mean of both
+#define   GPS_HEALTH_NO_SOLUTION         0x400          // neither has a fix without faults (the solution is the last one, kept)
+#define   GPS_HEALTH_FAULTS(health, receiver)  (((health) >> (GPS_FAULT_BITS * (receiver))) & 0x0F)
+
+#define   GPS_STALE_MILLIS               5000
+#define   GPS_FROZEN_MILLIS             10000
+#define   GPS_MAX_SPEED_MPS              150.0          // (horizontally: well beyond the jet stream, or the descent after burst)
+#define   GPS_JUMP_HOLD_MILLIS           5000
+#define   GPS_DIVERGE_METERS             250.0
+#define   GPS_DIVERGE_ELE_METERS         150.0
+#define   GPS_TRUST_MILLIS              30000          // (a solution older than this does not judge a disagreement)
+
+/**************************************************************************/
+/*!
+    One receiver's fix, for an update.
+*/
+/**************************************************************************/
+struct    ALTAIR_GPSFix {
+    double              lat                                                 ;  // in degrees
+    double              lon                                                 ;
+    long                ele                                                 ;  // in meters above mean sea level
+    double              time                                                ;  // UTC, in seconds since 0000 UT (0 if not known)
+    uint32_t            age                                                 ;  // in ms (GPS_NO_FIX_AGE if it has never had one)
+};
+
+struct    ALTAIR_GPSMonitorStats {
+    unsigned long       updates                                             ;
+    unsigned long       blended                                             ;  // updates whose solution was the mean of both
+    unsigned long       single                                              ;  //    ... was one receiver's alone
+    unsigned long       noSolution                                          ;  //    ... was neither's
+    unsigned long       disagreements                                       ;  // (each one counted once, when it starts)
+    unsigned long       jumps                                               ;
+    unsigned long       frozen                                              ;  // (likewise)
+    unsigned long       stale                                               ;  // (likewise)
+};
+
+class     ALTAIR_GPSMonitor {
+  public:
+
+    ALTAIR_GPSMonitor(                                                      ) ;
+
+    void                update(         const ALTAIR_GPSFix*  fixes       ,       // One per receiver.
+                                        uint8_t               preferred   ,
+                                        unsigned long         nowMillis     ) ;
+
+    bool                valid(                                              ) { return _valid                      ; }   // (once there has been any solution)
+    double              lat(                                                ) { return _lat                        ; }
+    double              lon(                                                ) { return _lon                        ; }
+    long                ele(                                                ) { return _ele                        ; }
+    unsigned long       fixMillis(                                          ) { return _fixMillis                  ; }   // millis() of the solution's fix
+    uint8_t             source(                                             ) { return _source                     ; }   // a receiver, GPS_SOURCE_BLENDED or GPS_SOURCE_NONE
+    uint16_t            health(                                             ) { return _health                     ; }
+    uint8_t             faults(         uint8_t               receiver      ) { return _receivers[receiver].faults ; }
+
+    const ALTAIR_GPSMonitorStats* stats(                                    ) { return &_stats                     ; }
+#ifdef    ARDUINO
+    void                printStats(                                         ) ;
+#endif
+
+  private:
+    struct Receiver {
+        bool            hasFix                                              ;
+        double          lat                                                 ;
+        double          lon                                                 ;
+        long            ele                                                 ;
+        double          time                                                ;
+        unsigned long   fixMillis                                           ;  // millis() of the last fix (by its age)
+        unsigned long   changeMillis                                        ;  // millis() of the last fix that differed at all from the one before
+        unsigned long   jumpMillis                                          ;
+        bool            jumped                                              ;
+        uint8_t         faults                                              ;
+    };
+
+    void                check(          Receiver&             receiver    ,
+                                        const ALTAIR_GPSFix&  fix         ,
+                                        unsigned long         nowMillis     ) ;
+    double              metersApart(    double                lat1        ,      // (horizontally)
+                                        double                lon1        ,
+                                        double                lat2        ,
+                                        double                lon2          ) ;
+
+    Receiver            _receivers[     GPS_NUM_RECEIVERS                   ] ;
+    bool                _valid                                                ;
+    double              _lat                                                  ;
+    double              _lon                                                  ;
+    long                _ele                                                  ;
+    unsigned long       _fixMillis                                            ;
+    uint8_t             _source                                               ;
+    uint16_t            _health                                               ;
+    ALTAIR_GPSMonitorStats _stats                                             ;
+};
+
+#endif    //   ifndef ALTAIR_GPSMonitor_h
@@ -23,10 +23,11 @@
 /*!
  @brief  Constructor.  Constructs the two GPS receiver objects with
          their default arguments (via their respective default
-         constructors).
+         constructors), and the solution (which refers back to them).
 */
 /**************************************************************************/
-ALTAIR_GPSSensors::ALTAIR_GPSSensors(           )
+ALTAIR_GPSSensors::ALTAIR_GPSSensors(           ) :
+    _solution(                               this )
 {
     _primary  = &_neom8n                             ;
     _backup   = &_dfrobot                            ;
@@ -45,7 +46,8 @@ void ALTAIR_GPSSensors::initialize(             )
 
 /**************************************************************************/
 /*!
- @brief  Switch primary and backup GPS.
+ @brief  Switch primary and backup GPS (the primary being the one that the
+         monitor prefers, when the two disagree and it cannot tell).
 */
 /**************************************************************************/
 void ALTAIR_GPSSensors::switchToOtherGPS(       )
@@ -54,3 +56,131 @@ void ALTAIR_GPSSensors::switchToOtherGPS(       )
                       _primary       = backup(  )    ;
                       _backup        = formerPrimary ;
 }
+
+/**************************************************************************/
+/*!
+ @brief  Get the GPS from both receivers, and update the monitor with
+         their fixes.  True if there is a solution (i.e. at least one of
+         them has a fix without faults).
+*/
+/**************************************************************************/
+bool ALTAIR_GPSSensors::poll(                   unsigned long  nowMillis )
+{
+    ALTAIR_GPSSensor* receivers[GPS_NUM_RECEIVERS] = { &_neom8n , &_dfrobot } ;   // (in the order of GPS_RECEIVER_NEOM8N, etc)
+    ALTAIR_GPSFix     fixes[    GPS_NUM_RECEIVERS]                            ;
+
+    for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) {
+        receivers[r]->getGPS(                   )    ;
+        fixes[r].lat  = receivers[r]->lat(      )    ;
+        fixes[r].lon  = receivers[r]->lon(      )    ;
+        fixes[r].ele  = receivers[r]->ele(      )    ;
+        fixes[r].time = receivers[r]->time(     )    ;
+        fixes[r].age  = receivers[r]->age(      )    ;
+    }
+    _monitor.update( fixes , (_primary == &_neom8n) ? GPS_RECEIVER_NEOM8N : GPS_RECEIVER_DFROBOTG6 , nowMillis ) ;
+    return (_monitor.source() != GPS_SOURCE_NONE)    ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Poll both receivers (see ALTAIR_GPSSensors::poll).
+*/
+/**************************************************************************/
+bool      ALTAIR_GPSSolution::getGPS(           )
+{
+    return _sensors->poll( ALTAIR_HAL::clockMillis() )    ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The receiver that the solution came from (the primary one, if it
+         is blended, or if there is none).
+*/
+/**************************************************************************/
+ALTAIR_GPSSensor* ALTAIR_GPSSolution::source(   )
+{
+    switch (_sensors->monitor()->source()) {
+      case GPS_RECEIVER_NEOM8N    :  return _sensors->neom8n(  ) ;
+      case GPS_RECEIVER_DFROBOTG6 :  return _sensors->dfrobot( ) ;
+      default                     :  return _sensors->primary( ) ;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  The receiver that the date and time come from: the NEO-M8N,
+         unless it has no fix, or a stale one, and the G6 does.
+*/
+/**************************************************************************/
+ALTAIR_GPSSensor* ALTAIR_GPSSolution::clock(    )
+{
+    ALTAIR_GPSMonitor* monitor = _sensors->monitor()  ;
+    uint8_t            late    = GPS_FAULT_NOFIX | GPS_FAULT_STALE ;
+    if ((monitor->faults(GPS_RECEIVER_NEOM8N) & late) && !(monitor->faults(GPS_RECEIVER_DFROBOTG6) & late)) return _sensors->dfrobot();
+    return _sensors->neom8n(                    )     ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The type of the receiver that the solution came from, unhealthy
+         if there is no solution at present.
+*/
+/**************************************************************************/
+uint8_t   ALTAIR_GPSSolution::typeAndHealth(    )
+{
+    bool    neom8n = (source() == _sensors->neom8n())  ;
+    if (_sensors->monitor()->health() & GPS_HEALTH_NO_SOLUTION) return (uint8_t) (neom8n ? neom8n_unhealthy : dfrobotg6_unhealthy);
+    return  (uint8_t) (neom8n ? neom8n_healthy : dfrobotg6_healthy) ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The solution's position (the primary receiver's, until there
+         has been one).
+*/
+/**************************************************************************/
+double    ALTAIR_GPSSolution::lat(              )
+{
+    return _sensors->monitor()->valid() ? _sensors->monitor()->lat() : _sensors->primary()->lat() ;
+}
+
+double    ALTAIR_GPSSolution::lon(              )
+{
+    return _sensors->monitor()->valid() ? _sensors->monitor()->lon() : _sensors->primary()->lon() ;
+}
+
+long      ALTAIR_GPSSolution::ele(              )
+{
+    return _sensors->monitor()->valid() ? _sensors->monitor()->ele() : _sensors->primary()->ele() ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The HDOP of the receiver that the solution came from.
+*/
+/**************************************************************************/
+byte      ALTAIR_GPSSolution::hdop(             )
+{
+    return source()->hdop(                      )    ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The age of the solution's fix, in ms (GPS_NO_FIX_AGE until there
+         has been one).
+*/
+/**************************************************************************/
+uint32_t  ALTAIR_GPSSolution::age(              )
+{
+    return _sensors->monitor()->valid() ? ALTAIR_HAL::clockMillis() - _sensors->monitor()->fixMillis() : GPS_NO_FIX_AGE ;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The monitor's health word (see ALTAIR_GPSMonitor.h).
+*/
+/**************************************************************************/
+uint16_t  ALTAIR_GPSSolution::health(           )
+{
+    return _sensors->monitor()->health(         )    ;
+}
@@ -8,6 +8,14 @@
     mast, and the DFRobot G6 located in a small plastic housing directly 
     atop the payload).
 
+    poll() gets the GPS from both receivers, and passes their fixes to the
+    consistency monitor (see ALTAIR_GPSMonitor.h); solution() is then the
+    monitor's blended solution, as a GPS receiver of its own, which is
+    what the telemetry and the flight log use.  The primary receiver is
+    the one that the monitor prefers when the two disagree and it has no
+    recent solution to judge them by (and which supplies the solution's
+    HDOP when it is blended).
+
     Justin Albert  jalbert@uvic.ca     began on 6 Sep. 2018
 
     @section  HISTORY
@@ -22,6 +30,48 @@
 #include "Arduino.h"
 #include "ALTAIR_NEOM8N.h"
 #include "ALTAIR_DFRobotG6.h"
+#include "ALTAIR_GPSMonitor.h"
+
+class ALTAIR_GPSSensors;
+
+/**************************************************************************/
+/*!
+    The GPS monitor's solution.  Its date and time are the NEO-M8N's, or
+    the G6's if the NEO-M8N does not have them (the G6 has no date); its
+    typeAndHealth() is that of the receiver that the solution came from
+    (the primary one, if it is blended), unhealthy if there is none.
+*/
+/**************************************************************************/
+class ALTAIR_GPSSolution : public ALTAIR_GPSSensor {
+  public:
+
+    ALTAIR_GPSSolution(               ALTAIR_GPSSensors*  sensors  )  : _sensors(sensors) {  }
+
+    virtual void      initialize(     )  {  }
+    virtual bool      getGPS(         )  ;                                      // (polls both receivers)
+    virtual uint8_t   typeAndHealth(  )  ;
+
+    virtual double    lat(            )  ;
+    virtual double    lon(            )  ;
+    virtual long      ele(            )  ;  // In meters above mean sea level.
+    virtual byte      hdop(           )  ;  // Horizontal Degree Of Precision.  A number typically between 1 and 50.
+    virtual uint32_t  age(            )  ;
+    virtual uint16_t  year(           )  { return clock()->year(   ) ; }
+    virtual uint8_t   month(          )  { return clock()->month(  ) ; }
+    virtual uint8_t   day(            )  { return clock()->day(    ) ; }
+    virtual uint8_t   hour(           )  { return clock()->hour(   ) ; }
+    virtual uint8_t   minute(         )  { return clock()->minute( ) ; }
+    virtual uint8_t   second(         )  { return clock()->second( ) ; }
+    virtual double    time(           )  { return clock()->time(   ) ; }
+
+            uint16_t  health(         )  ;                                      // (see ALTAIR_GPSMonitor.h)
+
+  private:
+    ALTAIR_GPSSensor*     clock(      )  ;
+    ALTAIR_GPSSensor*     source(     )  ;
+
+    ALTAIR_GPSSensors*   _sensors        ;
+};
 
 class ALTAIR_GPSSensors {
   public:
@@ -33,13 +83,18 @@ class ALTAIR_GPSSensors {
 
     ALTAIR_GPSSensor*       primary(          )  { return  _primary ; }              
     ALTAIR_GPSSensor*       backup(           )  { return  _backup  ; } 
+    ALTAIR_GPSSolution*     solution(         )  { return &_solution; }
+    ALTAIR_GPSMonitor*      monitor(          )  { return &_monitor ; }
 
     void                    initialize(       )                     ;
     void                    switchToOtherGPS( )                     ;
+    bool                    poll(             unsigned long  nowMillis ) ;   // True if there is a solution.
 
   private:
     ALTAIR_NEOM8N          _neom8n                                  ;
     ALTAIR_DFRobotG6       _dfrobot                                 ;
+    ALTAIR_GPSMonitor      _monitor                                 ;
+    ALTAIR_GPSSolution     _solution                                ;
 
     ALTAIR_GPSSensor*      _primary                                 ; 
     ALTAIR_GPSSensor*      _backup                                  ; 
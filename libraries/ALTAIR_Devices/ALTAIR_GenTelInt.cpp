@@ -19,8 +19,9 @@
 #include "ALTAIR_GlobalDeviceControl.h"
 #include "ALTAIR_GlobalLightControl.h"
 #include "ALTAIR_ArduinoMicro.h"
-#include <Adafruit_BME280.h>
+#include <ALTAIR_HAL.h>
 
+uint8_t  ALTAIR_GenTelInt::_commandSequence  =  NO_COMMAND_SEQUENCE;
 
 /**************************************************************************/
 /*!
@@ -28,7 +29,14 @@
          transceiver-specific code) in the derived classes.
 */
 /**************************************************************************/
-ALTAIR_GenTelInt::ALTAIR_GenTelInt() 
+ALTAIR_GenTelInt::ALTAIR_GenTelInt() :
+    _reducedContent(        false                           ) ,
+    _reducedSentFrame1(     false                           ) ,
+    _lastSendBytes(         0                               ) ,
+    _lastSendFrames(        0                               ) ,
+    _lastRSSI(              FAKE_RSSI_VAL                   ) ,
+    _lastRSSIMillis(        0                               ) ,
+    _commandSender(         NULL                            )
 {
 }
 
@@ -66,185 +74,244 @@ bool ALTAIR_GenTelInt::sendAllALTAIRInfo( ALTAIR_GlobalMotorControl&  motorContr
                                           ALTAIR_GlobalDeviceControl& deviceControl ,
                                           ALTAIR_GlobalLightControl&  lightControl   ) 
 {
-    byte     sendString1[50];
-    byte     sendString2[50];
+    byte*    data         = _txFrame + FRAME_HEADER_LENGTH;  // each field is serialized directly into its place in the transmit frame
 
-    ALTAIR_GPSSensor* gps = deviceControl.sitAwareSystem()->gpsSensors()->primary();
-
-    int32_t  latitude     = gps->lat() * 1000000;  // Latitude,  in millionths of a degree.
-    int32_t  longitude    = gps->lon() * 1000000;  // Longitude, in millionths of a degree.
-    uint16_t age          = gps->age();            // Milliseconds since last GPS update (or default value USHRT_MAX if never received).
-    int16_t  elevation    = gps->ele();            // Elevation above mean sea level in meters.  NOTE: above in previous function.
-    int8_t   hdop         = gps->hdop();           // Horizontal degree of precision.  A number typically between 1 and 50.
-
-    uint16_t outPres   = (deviceControl.sitAwareSystem()->bmeMast()->readPressure()    / 2.0F) ; // in units of 2 Pa (fits nicely into a uint16_t)
-    int8_t   outTemp   =  deviceControl.sitAwareSystem()->bmeMast()->readTemperature()         ; // in degrees C
-    uint8_t  outHum    =  deviceControl.sitAwareSystem()->bmeMast()->readHumidity()            ; // in %
-    uint16_t inPres    = (deviceControl.sitAwareSystem()->bmePayload()->readPressure() / 2.0F) ; // in units of 2 Pa (fits nicely into a uint16_t)
-    int8_t   inTemp    =  deviceControl.sitAwareSystem()->bmePayload()->readTemperature()      ; // in degrees C
-    uint8_t  inHum     =  deviceControl.sitAwareSystem()->bmePayload()->readHumidity()         ; // in %
-// If the connector up to the balloon valve is unconnected, or gets pulled out on the fly (by a cutdown), the internal balloon values below will read as all zeros
-    uint16_t balPres   = (deviceControl.sitAwareSystem()->bmeBalloon()->readPressure() / 2.0F) ; // in units of 2 Pa (fits nicely into a uint16_t)
-    int8_t   balTemp   =  deviceControl.sitAwareSystem()->bmeBalloon()->readTemperature()      ; // in degrees C
-    uint8_t  balHum    =  deviceControl.sitAwareSystem()->bmeBalloon()->readHumidity()         ; // in %
-
-    ALTAIR_OrientSensor* primaryOrientSensor = deviceControl.sitAwareSystem()->orientSensors()->primary();
-    primaryOrientSensor->update();
-    uint8_t rollUInt8   = primaryOrientSensor->rollUInt8();
-    uint8_t pitchUInt8  = primaryOrientSensor->pitchUInt8();
-    uint8_t yawUInt8    = primaryOrientSensor->yawUInt8();
-    int8_t  oSensTemp   = primaryOrientSensor->temperature();
-    uint8_t typeInfo    = primaryOrientSensor->typeAndHealth() + (8 * gps->typeAndHealth()) + (32 * radioType());
-    uint8_t accelXUInt8 = primaryOrientSensor->accelXUInt8();
-    uint8_t accelYUInt8 = primaryOrientSensor->accelYUInt8();
-    uint8_t accelZUInt8 = primaryOrientSensor->accelZUInt8();
+    _txFrame[0]  = (unsigned char)  TX_START_BYTE;
+    _txFrame[1]  = (unsigned char)  ALTAIR_AllInfoFrame1::length;    // Number of bytes of data that will be sent (43).
+    fillAllInfoFrame1(data, deviceControl);
 
+    ALTAIR_GPSSensor* gps = deviceControl.sitAwareSystem()->gpsSensors()->solution();
     Serial.print("   GPS sensor type & health = "); Serial.println(gps->typeAndHealth(), HEX) ;
     Serial.print("   GPS latitude = ");    Serial.println(gps->lat())   ;
     Serial.print("   GPS longitude = ");   Serial.println(gps->lon())   ;
     Serial.print("   GPS elevation = ");   Serial.println(gps->ele())   ;
     Serial.print("   GPS sensor time = "); Serial.println(gps->time())  ;
 
-    int8_t*  packedRPM = (int8_t*)      deviceControl.sitAwareSystem()->arduinoMicro()->packedRPM();
-    int8_t*  packedCur = (int8_t*)      deviceControl.sitAwareSystem()->arduinoMicro()->packedCurrent();
-
-    sendString1[0]  = (unsigned char)  TX_START_BYTE;
-    sendString1[1]  = (unsigned char)  (0x2B);           // Number of bytes of data that will be sent (0x2B = 43).
-
-    sendString1[2]  = byte((latitude  >> 24) & 0xFF);
-    sendString1[3]  = byte((latitude  >> 16) & 0xFF);
-    sendString1[4]  = byte((latitude  >>  8) & 0xFF);
-    sendString1[5]  = byte( latitude         & 0xFF);
-
-    sendString1[6]  = byte((longitude >> 24) & 0xFF);
-    sendString1[7]  = byte((longitude >> 16) & 0xFF);
-    sendString1[8]  = byte((longitude >>  8) & 0xFF);
-    sendString1[9]  = byte( longitude        & 0xFF);
-
-    sendString1[10] = byte((elevation >>  8) & 0xFF);
-    sendString1[11] = byte( elevation        & 0xFF);
-
-    sendString1[12] = byte((age       >>  8) & 0xFF);    // only send the upper byte of age (i.e., age / 256)
-    sendString1[13] = byte( hdop             & 0xFF);
-
-    sendString1[14] =       'T'                     ;
-
-    sendString1[15] = byte((outPres   >>  8) & 0xFF);
-    sendString1[16] = byte( outPres          & 0xFF);
-    sendString1[17] = byte( outTemp          & 0xFF);
-    sendString1[18] = byte( outHum           & 0xFF);
-    sendString1[19] = byte((inPres    >>  8) & 0xFF);
-    sendString1[20] = byte( inPres           & 0xFF);
-    sendString1[21] = byte( inTemp           & 0xFF);
-    sendString1[22] = byte( inHum            & 0xFF);
-    sendString1[23] = byte((balPres   >>  8) & 0xFF);
-    sendString1[24] = byte( balPres          & 0xFF);
-    sendString1[25] = byte( balTemp          & 0xFF);
-    sendString1[26] = byte( balHum           & 0xFF);
-
-    sendString1[27] = byte( accelZUInt8      & 0xFF);
-    sendString1[28] = byte( accelXUInt8      & 0xFF);
-    sendString1[29] = byte( accelYUInt8      & 0xFF);
-
-    sendString1[30] =       'T'                     ;
-
-    sendString1[31] = byte(   yawUInt8       & 0xFF);
-    sendString1[32] = byte( pitchUInt8       & 0xFF);
-    sendString1[33] = byte(  rollUInt8       & 0xFF);
-    sendString1[34] = byte( oSensTemp        & 0xFF);
-    sendString1[35] = byte( typeInfo         & 0xFF);
-
-    for (int i = 0; i < 4; ++i)     sendString1[36+i]  =  byte(  packedRPM[i]          & 0xFF);
-    for (int i = 0; i < 4; ++i)     sendString1[40+i]  =  byte(  packedCur[i]          & 0xFF);
-
-    sendString1[44] =       'T'                     ;
-
-//    if (send(sendString1, 45)) Serial.println(F("Successfully sent sendString1"));
-    if ((radioType() != rfm23bp) || (lastSentString2())) {
-        send(sendString1, 45);
-        if (radioType() == rfm23bp) return true;
+//    if (send(_txFrame, FRAME_HEADER_LENGTH + ALTAIR_AllInfoFrame1::length)) Serial.println(F("Successfully sent frame 1"));
+// A radio whose link cannot carry both frames each time (see ALTAIR_LinkRateController), like the RFM23BP, sends them alternately.
+    bool     oneFrame     = (radioType() == rfm23bp) || _reducedContent;
+    bool     sendFrame1   = true;
+    if      (radioType() == rfm23bp) sendFrame1 = lastSentString2();
+    else if (_reducedContent) {      sendFrame1 = !_reducedSentFrame1;  _reducedSentFrame1 = sendFrame1; }
+    _lastSendBytes  = 0;
+    _lastSendFrames = 0;
+
+    if (sendFrame1) {
+        sendKeyOrDelta(DELTA_FRAME_TYPE_1);
+        if (oneFrame) return true;
     }
 
 // try moving work here (instead of a CPU-cycle-wasting delay)
 
-    int8_t*  packedTem = (int8_t*)      deviceControl.sitAwareSystem()->arduinoMicro()->packedTemp();    // in units of 0.5 degrees C! (e.g 0x2B = 21.5 degrees C)
-
-    int8_t   rssi      = lastRSSI();
-    uint8_t  bat1V     = (deviceControl.sitAwareSystem()->genOpsBatt()->readVoltage() * 18.18F) ; // in units of 55 mV (would turn over at 14 V)
-    uint8_t  bat2V     = (deviceControl.sitAwareSystem()->propBatt()->readVoltage()   * 18.18F) ; // in units of 55 mV (would turn over at 14 V)
-
-    ALTAIR_DataStorageSystem* sdCard =  deviceControl.dataStoreSystem();
-    uint16_t occSpace  =      sdCard->occupiedSpace();
-
-    uint8_t  powerMot1 = (motorControl.propSystem()->portOuterMotor()->powerSetting() * 10.0F) ; // an integer containing 10x the present power setting
-    uint8_t  powerMot2 = (motorControl.propSystem()->portInnerMotor()->powerSetting() * 10.0F) ; // an integer containing 10x the present power setting
-    uint8_t  powerMot3 = (motorControl.propSystem()->stbdInnerMotor()->powerSetting() * 10.0F) ; // an integer containing 10x the present power setting
-    uint8_t  powerMot4 = (motorControl.propSystem()->stbdOuterMotor()->powerSetting() * 10.0F) ; // an integer containing 10x the present power setting
-
-    uint8_t  axlRotSet = (motorControl.propSystem()->axleRotServo()->reportSetting()  * 10.0F) ; // an integer containing 10x the present servo setting
-    uint8_t  axlRotAng = (motorControl.propSystem()->axleRotServo()->reportPosition() * 50.0F) ; // in units of 1/50 V (i.e. 20 mV): 5.1 V is max
-    uint8_t  bleedVSet = (motorControl.bleedSystem()->reportSetting()                 * 10.0F) ; // an integer containing 10x the present servo setting
-    uint8_t  bleedVAng = (motorControl.bleedSystem()->reportPosition()                * 50.0F) ; // in units of 1/50 V (i.e. 20 mV): 5.1 V is max
-    uint8_t  cutdwnSet = (motorControl.cutdownSystem()->reportSetting()               * 10.0F) ; // an integer containing 10x the present servo setting
-    uint8_t  cutdwnAng = (motorControl.cutdownSystem()->reportPosition()              * 50.0F) ; // in units of 1/50 V (i.e. 20 mV): 5.1 V is max
-
-    uint8_t  lightStat =  lightControl.getLightStatusByte()                                                              ;
-    uint16_t pd1ADRead =  lightControl.lightSourceMon()->ads1115ADC2()->readADC_SingleEnded( INTSPHERE_PD1_ADC_CHANNEL ) ;
-    uint16_t pd2ADRead =  lightControl.lightSourceMon()->ads1115ADC2()->readADC_SingleEnded( INTSPHERE_PD2_ADC_CHANNEL ) ;
-    uint16_t pd3ADRead =  lightControl.lightSourceMon()->ads1115ADC2()->readADC_SingleEnded( INTSPHERE_PD3_ADC_CHANNEL ) ;
-
-    sendString2[0]  = (unsigned char)  TX_START_BYTE;
-    sendString2[1]  = (unsigned char)  (0x21);           // Number of bytes of data that will be sent (0x21 = 33).
+    _txFrame[0]  = (unsigned char)  TX_START_BYTE;
+    _txFrame[1]  = (unsigned char)  ALTAIR_AllInfoFrame2::length;    // Number of bytes of data that will be sent (33).
+    fillAllInfoFrame2(data, motorControl, deviceControl, lightControl);
+
+//    if (send(_txFrame, FRAME_HEADER_LENGTH + ALTAIR_AllInfoFrame2::length)) Serial.println(F("Successfully sent frame 2"));
+    sendKeyOrDelta(DELTA_FRAME_TYPE_2);
+
+// The full-resolution propulsion readings follow, if the Arduino Micro's extended readings are being read (via the 'P' device
+//    command), except on a radio that already only has room for one frame at a time.
+    if (!oneFrame && deviceControl.sitAwareSystem()->arduinoMicro()->extended()) {
+        _txFrame[0]  = (unsigned char)  TX_START_BYTE;
+        _txFrame[1]  = (unsigned char)  ALTAIR_PropulsionFrame::length;  // Number of bytes of data that will be sent (38).
+        fillPropulsionFrame(data, deviceControl);
+        if (send(_txFrame, FRAME_HEADER_LENGTH + ALTAIR_PropulsionFrame::length)) {
+            _lastSendBytes += FRAME_HEADER_LENGTH + ALTAIR_PropulsionFrame::length;
+            ++_lastSendFrames;
+        }
+    }
 
-    for (int i = 0; i < 8; ++i)     sendString2[2+i]  =  byte(  packedTem[i]          & 0xFF);
+    return true;
+}
 
-    sendString2[10] = byte(  rssi            & 0xFF);
+/**************************************************************************/
+/*!
+ @brief  Send the frame that has been built in _txFrame (of type
+         DELTA_FRAME_TYPE_1 or 2): as a keyframe, if it is time for one
+         (or if a delta would be no shorter), or else as a delta against
+         the last keyframe.  A keyframe is only kept as such once it has
+         been sent.
+*/
+/**************************************************************************/
+bool ALTAIR_GenTelInt::sendKeyOrDelta( uint8_t frameType )
+{
+    byte*    data     = _txFrame + FRAME_HEADER_LENGTH;
+    byte     encoded[FRAME_HEADER_LENGTH + MAX_FRAME_DATA_LENGTH];
+    bool     isKey;
+    uint8_t  length   = _encoder.encodeFrame(frameType, data, _txFrame[1], encoded, isKey);
+
+    if (!send(encoded, length)) return false;
+    _encoder.commitFrame(frameType, data, isKey);
+    _lastSendBytes += length;
+    ++_lastSendFrames;
+    return true;
+}
 
-    sendString2[11] = byte(  bat1V           & 0xFF);
-    sendString2[12] = byte(  bat2V           & 0xFF);
+/**************************************************************************/
+/*!
+ @brief  Send this radio's share of a fan-out cycle of the status frames
+         (built once, for all of the radios, by
+         ALTAIR_TelemetrySystem::fanOutStatus): as many of them as there
+         is room for right now, each preceded by the cycle's sequence
+         number, without waiting for the radio.  (A radio with reduced
+         content sends just one, and never the propulsion frame.)
+         Returns the # of frames sent.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_GenTelInt::fanOutStatus( const byte* frame1 , const byte* frame2 , const byte* propulsion , uint8_t sequence )
+{
+    bool oneFrame   = (radioType() == rfm23bp) || _reducedContent;
+    _encoder.beginCycle(frame1, frame2, oneFrame ? NULL : propulsion, sequence, oneFrame ? 1 : NUM_STATUS_FRAMES);
+    _lastSendBytes  = 0;
+    _lastSendFrames = 0;
+
+    byte    out[LINK_ENCODER_MAX_LENGTH];
+    uint8_t length;
+    while ((length = _encoder.nextFrame(out, txRoom())) > 0) {
+        if (!sendNonBlocking(out, length)) break;
+        _encoder.frameSent();
+        _lastSendBytes += length;
+        ++_lastSendFrames;
+    }
+    return _lastSendFrames;
+}
 
-    sendString2[13] =       'T'                     ;
+/**************************************************************************/
+/*!
+ @brief  Read the GPS, the three BME280s (as last sampled), the primary
+         orientation sensor, and the packed propulsion RPMs & currents,
+         and serialize them into data, per the layout of
+         ALTAIR_AllInfoFrame1.  (Used both 
+         for telemetry, and for the flight record on the SD card.)
+*/
+/**************************************************************************/
+void ALTAIR_GenTelInt::fillAllInfoFrame1( byte*                       data          ,
+                                          ALTAIR_GlobalDeviceControl& deviceControl  )
+{
+    typedef  ALTAIR_AllInfoFrame1  F1;
 
-    sendString2[14] = byte(( occSpace >>  8) & 0xFF);
-    sendString2[15] = byte(  occSpace        & 0xFF);
+    ALTAIR_GPSSensor* gps = deviceControl.sitAwareSystem()->gpsSensors()->solution();
 
-    sendString2[16] = byte(  powerMot1       & 0xFF);
-    sendString2[17] = byte(  powerMot2       & 0xFF);
-    sendString2[18] = byte(  powerMot3       & 0xFF);
-    sendString2[19] = byte(  powerMot4       & 0xFF);
+    uint16_t age          = gps->age();            // Milliseconds since last GPS update (or default value USHRT_MAX if never received).
 
-    sendString2[20] = byte(  axlRotSet       & 0xFF);
-    sendString2[21] = byte(  axlRotAng       & 0xFF);
-    sendString2[22] = byte(  bleedVSet       & 0xFF);
-    sendString2[23] = byte(  bleedVAng       & 0xFF);
-    sendString2[24] = byte(  cutdwnSet       & 0xFF);
-    sendString2[25] = byte(  cutdwnAng       & 0xFF);
+    F1::latitude  ::encode(data, gps->lat());      // Latitude,  in millionths of a degree.
+    F1::longitude ::encode(data, gps->lon());      // Longitude, in millionths of a degree.
+    F1::elevation ::put(   data, gps->ele());      // Elevation above mean sea level in meters.  NOTE: above in sendGPS().
+    F1::age       ::encode(data, age);             // only send the upper byte of age (i.e., age / 256)
+    F1::hdop      ::put(   data, gps->hdop());     // Horizontal degree of precision.  A number typically between 1 and 50.
+    F1::separator1::put(   data);
+
+    F1::outPres   ::encode(data, deviceControl.sitAwareSystem()->bmeMast()->pressure()          );  // in units of 2 Pa (fits nicely into a uint16_t)
+    F1::outTemp   ::encode(data, deviceControl.sitAwareSystem()->bmeMast()->temperature()       );  // in degrees C
+    F1::outHum    ::encode(data, deviceControl.sitAwareSystem()->bmeMast()->humidity()          );  // in %
+    F1::inPres    ::encode(data, deviceControl.sitAwareSystem()->bmePayload()->pressure()       );
+    F1::inTemp    ::encode(data, deviceControl.sitAwareSystem()->bmePayload()->temperature()    );
+    F1::inHum     ::encode(data, deviceControl.sitAwareSystem()->bmePayload()->humidity()       );
+// If the connector up to the balloon valve is unconnected, or gets pulled out on the fly (by a cutdown), the internal balloon values below will read as all zeros
+    F1::balPres   ::encode(data, deviceControl.sitAwareSystem()->bmeBalloon()->pressure()       );
+    F1::balTemp   ::encode(data, deviceControl.sitAwareSystem()->bmeBalloon()->temperature()    );
+    F1::balHum    ::encode(data, deviceControl.sitAwareSystem()->bmeBalloon()->humidity()       );
 
-    sendString2[26] =       'T'                     ;
+    ALTAIR_OrientSensor* primaryOrientSensor = deviceControl.sitAwareSystem()->orientSensors()->primary();
+    primaryOrientSensor->update();
+    F1::accelZ    ::put(   data, primaryOrientSensor->accelZUInt8()  );
+    F1::accelX    ::put(   data, primaryOrientSensor->accelXUInt8()  );
+    F1::accelY    ::put(   data, primaryOrientSensor->accelYUInt8()  );
+    F1::separator2::put(   data);
+    ALTAIR_OrientSensors* orientSensors      = deviceControl.sitAwareSystem()->orientSensors();   // (the fused yaw/pitch/roll)
+    F1::yaw       ::put(   data, primaryOrientSensor->convertYawInt16ToUInt8(       orientSensors->yaw()   ) );
+    F1::pitch     ::put(   data, primaryOrientSensor->convertPitchRollInt16ToUInt8( orientSensors->pitch() ) );
+    F1::roll      ::put(   data, primaryOrientSensor->convertPitchRollInt16ToUInt8( orientSensors->roll()  ) );
+    F1::oSensTemp ::put(   data, primaryOrientSensor->temperature()  );
+    F1::typeInfo  ::put(   data, primaryOrientSensor->typeAndHealth() + (8 * gps->typeAndHealth()) + (32 * radioType()));
+
+    F1::packedRPM ::put(   data, deviceControl.sitAwareSystem()->arduinoMicro()->packedRPM()     );
+    F1::packedCur ::put(   data, deviceControl.sitAwareSystem()->arduinoMicro()->packedCurrent() );
+    F1::separator3::put(   data);
+}
 
-    sendString2[27] = byte(  lightStat       & 0xFF);
-    sendString2[28] = byte(( pd1ADRead >> 8) & 0xFF);
-    sendString2[29] = byte(  pd1ADRead       & 0xFF);
-    sendString2[30] = byte(( pd2ADRead >> 8) & 0xFF);
-    sendString2[31] = byte(  pd2ADRead       & 0xFF);
-    sendString2[32] = byte(( pd3ADRead >> 8) & 0xFF);
-    sendString2[33] = byte(  pd3ADRead       & 0xFF);
+/**************************************************************************/
+/*!
+ @brief  Read the packed propulsion temps, RSSI, battery voltages, SD card
+         usage, motor & servo settings, and light source status & 
+         photodiodes, and serialize them into data, per the layout of
+         ALTAIR_AllInfoFrame2.
+*/
+/**************************************************************************/
+void ALTAIR_GenTelInt::fillAllInfoFrame2( byte*                       data          ,
+                                          ALTAIR_GlobalMotorControl&  motorControl  ,
+                                          ALTAIR_GlobalDeviceControl& deviceControl ,
+                                          ALTAIR_GlobalLightControl&  lightControl   )
+{
+    typedef  ALTAIR_AllInfoFrame2  F2;
 
-    sendString2[34] =       'T'                     ;
+    ALTAIR_DataStorageSystem* sdCard =  deviceControl.dataStoreSystem();
 
-//    if (send(sendString2, 35)) Serial.println(F("Successfully sent sendString2"));
-    send(sendString2, 35);
+    F2::packedTemp::put(   data, deviceControl.sitAwareSystem()->arduinoMicro()->packedTemp()    );  // in units of 0.5 degrees C! (e.g 0x2B = 21.5 degrees C)
+    F2::rssi      ::put(   data, lastRSSI()                                                      );
+    F2::bat1V     ::encode(data, deviceControl.sitAwareSystem()->genOpsBatt()->readVoltage()     );  // in units of 55 mV (would turn over at 14 V)
+    F2::bat2V     ::encode(data, deviceControl.sitAwareSystem()->propBatt()->readVoltage()       );  // in units of 55 mV (would turn over at 14 V)
+    F2::separator1::put(   data);
+
+    F2::occSpace  ::put(   data, sdCard->occupiedSpace()                                         );
+
+    F2::powerMot1 ::encode(data, motorControl.propSystem()->portOuterMotor()->powerSetting()     );  // an integer containing 10x the present power setting
+    F2::powerMot2 ::encode(data, motorControl.propSystem()->portInnerMotor()->powerSetting()     );
+    F2::powerMot3 ::encode(data, motorControl.propSystem()->stbdInnerMotor()->powerSetting()     );
+    F2::powerMot4 ::encode(data, motorControl.propSystem()->stbdOuterMotor()->powerSetting()     );
+
+    F2::axlRotSet ::encode(data, motorControl.propSystem()->axleRotServo()->reportSetting()      );  // an integer containing 10x the present servo setting
+    F2::axlRotAng ::encode(data, motorControl.propSystem()->axleRotServo()->reportPosition()     );  // in units of 1/50 V (i.e. 20 mV): 5.1 V is max
+    F2::bleedVSet ::encode(data, motorControl.bleedSystem()->reportSetting()                     );
+    F2::bleedVAng ::encode(data, motorControl.bleedSystem()->reportPosition()                    );
+    F2::cutdwnSet ::encode(data, motorControl.cutdownSystem()->reportSetting()                   );
+    F2::cutdwnAng ::encode(data, motorControl.cutdownSystem()->reportPosition()                  );
+    F2::separator2::put(   data);
+
+    F2::lightStat ::put(   data, lightControl.getLightStatusByte()                                                              );
+    ALTAIR_HAL::i2cFlush();                                                                                                              // (as the ADS1X15 library uses Wire)
+    F2::pd1ADRead ::put(   data, lightControl.lightSourceMon()->ads1115ADC2()->readADC_SingleEnded( INTSPHERE_PD1_ADC_CHANNEL ) );
+    F2::pd2ADRead ::put(   data, lightControl.lightSourceMon()->ads1115ADC2()->readADC_SingleEnded( INTSPHERE_PD2_ADC_CHANNEL ) );
+    F2::pd3ADRead ::put(   data, lightControl.lightSourceMon()->ads1115ADC2()->readADC_SingleEnded( INTSPHERE_PD3_ADC_CHANNEL ) );
+    F2::separator3::put(   data);
+}
 
-    return true;
+/**************************************************************************/
+/*!
+ @brief  Serialize the Arduino Micro's extended (16-bit) RPMs, currents,
+         and temps, with its snapshot sequence number and age, into data,
+         per the layout of ALTAIR_PropulsionFrame.
+*/
+/**************************************************************************/
+void ALTAIR_GenTelInt::fillPropulsionFrame( byte*                       data          ,
+                                            ALTAIR_GlobalDeviceControl& deviceControl  )
+{
+    typedef  ALTAIR_PropulsionFrame  F3;
+
+    ALTAIR_ArduinoMicro* micro = deviceControl.sitAwareSystem()->arduinoMicro();
+    unsigned long        age   = micro->dataAgeMillis();
+
+    F3::microSeq  ::put(   data, micro->sequence()                      );
+    F3::microAge  ::put(   data, (age > 0xFFFF) ? 0xFFFF : age          );
+    for (uint8_t i = 0; i < 4; ++i) F3::putRPM(    data, i, micro->extendedRPM(i)     );
+    F3::separator1::put(   data);
+    for (uint8_t i = 0; i < 4; ++i) F3::putCurrent(data, i, micro->extendedCurrent(i) );
+    F3::separator2::put(   data);
+    for (uint8_t i = 0; i < 8; ++i) F3::putTemp(   data, i, micro->extendedTemp(i)    );
+    F3::separator3::put(   data);
 }
 
 /**************************************************************************/
 /*!
- @brief  Send a command from a ground station up to ALTAIR.
+ @brief  Send a command from a ground station up to ALTAIR, tagged with a
+         sequence number (so that ALTAIR can discard the copies of it that
+         arrive via other radios, or that are sent again).
 */
 /**************************************************************************/
-bool ALTAIR_GenTelInt::sendCommandToALTAIR(byte commandByte1 , 
-                                           byte commandByte2  )
+bool ALTAIR_GenTelInt::sendCommandToALTAIR(byte    commandByte1 , 
+                                           byte    commandByte2 ,
+                                           uint8_t sequence      )
 {
 /*
            send(      (unsigned char)           RX_START_BYTE ) ;
@@ -252,13 +319,86 @@ bool ALTAIR_GenTelInt::sendCommandToALTAIR(byte commandByte1 ,
            send(                                commandByte1  ) ;
     return send(                                commandByte2  ) ;
 */
-    byte   sendString[4];
+    if (sequence == NO_COMMAND_SEQUENCE) sequence = nextCommandSequence();
+    byte   sendString[2 + COMMAND_LENGTH];
     sendString[0]  =  (unsigned char)           RX_START_BYTE   ;
-    sendString[1]  =  (unsigned char)          (0x02)           ;
+    sendString[1]  =  (unsigned char)           COMMAND_LENGTH  ;
     sendString[2]  =                            commandByte1    ;
     sendString[3]  =                            commandByte2    ;
-    if (send(sendString, 4)) { Serial.print(radioName()); Serial.println(F("  successfully sent sendString")); }
-    return true;
+    sendString[4]  =                            sequence        ;
+    bool   sent    =  send(sendString, 2 + COMMAND_LENGTH);
+    Serial.print(F("#")); Serial.print(radioName()); Serial.print(F(" command sequence ")); Serial.print(sequence);
+    Serial.println(sent ? F(" sent (awaiting its acknowledgement)") : F(" could not be sent"));
+    return sent;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Queue a command to be sent up to ALTAIR by
+         serviceCommandsToALTAIR, until it is acknowledged (or, without a
+         command sender, just send it once, right now).
+*/
+/**************************************************************************/
+bool ALTAIR_GenTelInt::queueCommandToALTAIR(byte commandByte1 ,
+                                            byte commandByte2  )
+{
+    if (_commandSender == NULL) return sendCommandToALTAIR(commandByte1, commandByte2);
+    return _commandSender->queue(commandByte1, commandByte2, nextCommandSequence(), ALTAIR_HAL::clockMillis());
+}
+
+/**************************************************************************/
+/*!
+ @brief  Give up on the queued commands that have gone unacknowledged for
+         too long, and then send each one that is due (a new one, or one
+         whose retransmit timer has run out).  Call this often.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_GenTelInt::serviceCommandsToALTAIR()
+{
+    if (_commandSender == NULL) return 0;
+    unsigned long now     = ALTAIR_HAL::clockMillis();
+    uint8_t       givenUp = _commandSender->expire(now);
+    if (givenUp > 0) { Serial.print(F("#")); Serial.print(givenUp); Serial.println(F(" command(s) given up on, unacknowledged")); }
+
+    uint8_t sent = 0;
+    byte    type;
+    byte    argument;
+    uint8_t sequence;
+    while (_commandSender->nextToSend(now, type, argument, sequence)) {
+        sendCommandToALTAIR(type, argument, sequence);
+        ++sent;
+    }
+    return sent;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send a heartbeat up to ALTAIR (which only counts it, towards the
+         link's command rate).  Unlike sendCommandToALTAIR, this prints
+         nothing, so that it can be sent every couple of seconds.
+*/
+/**************************************************************************/
+bool ALTAIR_GenTelInt::sendHeartbeatToALTAIR()
+{
+    byte   sendString[2 + COMMAND_LENGTH];
+    sendString[0]  =  (unsigned char)           RX_START_BYTE   ;
+    sendString[1]  =  (unsigned char)           COMMAND_LENGTH  ;
+    sendString[2]  =                            HEARTBEAT_COMMAND ;
+    sendString[3]  =                            1               ;    // (a zero argument would be ignored)
+    sendString[4]  =                            NO_COMMAND_SEQUENCE ;
+    return send(sendString, 2 + COMMAND_LENGTH);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Return the next command sequence number (which runs from 1 to 255,
+         and then wraps around, skipping NO_COMMAND_SEQUENCE).
+*/
+/**************************************************************************/
+uint8_t ALTAIR_GenTelInt::nextCommandSequence()
+{
+    if (++_commandSequence == NO_COMMAND_SEQUENCE) ++_commandSequence;
+    return _commandSequence;
 }
 
 
@@ -348,6 +488,7 @@ void ALTAIR_GenTelInt::readALTAIRInfo(  byte command[],  bool isGroundStation )
     if (isGroundStation)  startByte      =  TX_START_BYTE ;
                 command[0]               =              0 ;
                 command[1]               =              0 ;
+                command[2]               = NO_COMMAND_SEQUENCE ;
     if (!isBusy()) {
 //      Serial.print(F("Reading radio: "));  Serial.println(radioName());
       while (true) {
@@ -392,6 +533,8 @@ void ALTAIR_GenTelInt::readALTAIRInfo(  byte command[],  bool isGroundStation )
       if (termLength == termIndex && termLength > 0) {
         command[0] = term[0];
         command[1] = term[1];
+        if (termLength >= COMMAND_LENGTH) command[2] = term[2];    // (older ground stations send no sequence number)
+        termReceived();
         if (isGroundStation) groundStationPrintRxInfo(term, termLength);
         termLength = termIndex = hasBegun = 0;    
         return;
@@ -469,40 +612,12 @@ void ALTAIR_GenTelInt::groundStationPrintRxInfo(  byte  term[] ,  int termLength
     Serial.println();  
 //    Serial.println("\"");  
 
- if (termLength > 42) {
-/*
-      Serial.print(F("Transmitter station GMT time: "));  
-      Serial.print(term[0], DEC); Serial.print(":"); 
-      if (term[1] < 10) Serial.print("0"); Serial.print(term[1], DEC); Serial.print(":"); 
-      if (term[2] < 10) Serial.print("0"); Serial.println(term[2], DEC);
-
-//      if (termLength > 42) {
-*/
-        long lat = 0;
-        long lon = 0;
-        int  ele = 0;
-        int  age = 0;
-
-        lat  = ((unsigned long) term[0])  << 24;
-        lat |= ((unsigned long) term[1])  << 16;
-        lat |= ((unsigned long) term[2])  << 8;
-        lat |= ((unsigned long) term[3]);
-    
-        lon  = ((unsigned long) term[4]) << 24;
-        lon |= ((unsigned long) term[5]) << 16;
-        lon |= ((unsigned long) term[6]) << 8;
-        lon |= ((unsigned long) term[7]);
-
-        ele |= ((unsigned int)  term[8]) << 8;
-        ele |= ((unsigned int)  term[9]);
-
-        age  = (                term[10]);
-
-        Serial.print(F("Latitude:  ")); Serial.println(lat);
-        Serial.print(F("Longitude: ")); Serial.println(lon);
-        Serial.print(F("Elevation above SL (in m): ")); Serial.println(ele);
-        Serial.print(F("GPS age (in units of 256 milliseconds): ")); Serial.println(age);
-//      }
+ if (termLength == ALTAIR_AllInfoFrame1::length) {
+        typedef ALTAIR_AllInfoFrame1 F1;
+        Serial.print(F("Latitude:  ")); Serial.println(F1::latitude ::get(term));
+        Serial.print(F("Longitude: ")); Serial.println(F1::longitude::get(term));
+        Serial.print(F("Elevation above SL (in m): ")); Serial.println(F1::elevation::get(term));
+        Serial.print(F("GPS age (in units of 256 milliseconds): ")); Serial.println(F1::age::get(term));
     }
     Serial.flush();
 }
@@ -11,6 +11,13 @@
     given transceiver) is abstracted to and available within this 
     interface.  Note that when necessary, inputs default to those
     for the DNT900. 
+
+    The two sendAllALTAIRInfo frames are sent as keyframes (i.e. in full)
+    every so often, and as deltas against them in between (see
+    ALTAIR_TelemetryDelta.h).  Each radio keeps its own keyframes (in its
+    ALTAIR_LinkEncoder), so that switching the primary radio starts the
+    new one off with keyframes, and so that the status can be fanned out
+    to all of the radios at once (see fanOutStatus).
     Justin Albert  jalbert@uvic.ca     began on 8 Oct. 2017
 
     @section  HISTORY
@@ -23,12 +30,18 @@
 #define  ALTAIR_GenTelInt_h
 
 #include "Arduino.h"
+#include "ALTAIR_TelemetryFrames.h"
+#include "ALTAIR_LinkEncoder.h"
+#include "ALTAIR_CommandARQ.h"
 
 #define  FAKE_RSSI_VAL     127
 #define  MAX_TERM_LENGTH   255
 #define  MAX_READ_TRIES    100
-#define  TX_START_BYTE    0xFA
+#define  TX_START_BYTE    FRAME_START_BYTE
 #define  RX_START_BYTE    0xFC
+#define  COMMAND_LENGTH      3            // a command sent up to ALTAIR: its type, its argument, and then its sequence number
+#define  NO_COMMAND_SEQUENCE 0            // the sequence number of a command from a ground station that does not send one
+#define  HEARTBEAT_COMMAND  'h'           // sent up by a ground station that has nothing else to send (see ALTAIR_LinkQuality.h)
 #define  CALL_SIGN_STRING     " VE7XJA STATION ALTAIR "
 #define  END_MESSAGE_STRING   " OVER "
 
@@ -51,17 +64,47 @@ class ALTAIR_GenTelInt {
             bool         sendAllALTAIRInfo( ALTAIR_GlobalMotorControl&  motorControl    ,
                                             ALTAIR_GlobalDeviceControl& deviceControl   ,
                                             ALTAIR_GlobalLightControl&  lightControl            )    ;
-            bool         sendCommandToALTAIR(        byte               commandByte1    ,
-                                                     byte               commandByte2            )    ;  
+            void         fillAllInfoFrame1(          byte*              data            ,              // Serialize the present ALTAIR info per
+                                            ALTAIR_GlobalDeviceControl& deviceControl           )    ; //    ALTAIR_AllInfoFrame1, into data.
+            void         fillAllInfoFrame2(          byte*              data            ,              // Serialize the present ALTAIR info per
+                                            ALTAIR_GlobalMotorControl&  motorControl    ,              //    ALTAIR_AllInfoFrame2, into data.
+                                            ALTAIR_GlobalDeviceControl& deviceControl   ,
+                                            ALTAIR_GlobalLightControl&  lightControl            )    ;
+            void         fillPropulsionFrame(        byte*              data            ,              // Serialize the Arduino Micro's extended readings
+                                            ALTAIR_GlobalDeviceControl& deviceControl           )    ; //    per ALTAIR_PropulsionFrame, into data.
+            uint8_t      fanOutStatus(      const    byte*              frame1          ,              // Send as many of the status frames as there is
+                                            const    byte*              frame2          ,              //    room for now, with the fan-out cycle's
+                                            const    byte*              propulsion      ,              //    sequence number.  Returns the # sent.
+                                                     uint8_t            sequence                )    ;
+            void         setDeltaKeyframeInterval(   uint8_t            interval                ) { _encoder.setKeyframeInterval(interval) ; } // A keyframe every interval-th time each
+            uint8_t      deltaKeyframeInterval(                                                 ) { return _encoder.keyframeInterval()     ; } //    frame is sent (1: always in full).
+            void         setReducedContent(          bool               reduced                 ) { _reducedContent = reduced     ; } // Send one frame per sendAllALTAIRInfo,
+            bool         reducedContent(                                                        ) { return _reducedContent        ; } //    alternately (as the RFM23BP always does)?
+            uint16_t     lastSendBytes(                                                         ) { return _lastSendBytes         ; } // What the last sendAllALTAIRInfo sent
+            uint8_t      lastSendFrames(                                                        ) { return _lastSendFrames        ; } //    (in bytes, with headers, and frames).
+            bool         sendCommandToALTAIR(        byte               commandByte1    ,              // If sequence is NO_COMMAND_SEQUENCE, the next
+                                                     byte               commandByte2    ,              //    sequence number is used (pass the same one to
+                                                     uint8_t            sequence        = NO_COMMAND_SEQUENCE ) ; //    send one command up via several radios).
+    static  uint8_t      nextCommandSequence(                                                   )    ;
+            bool         sendHeartbeatToALTAIR(                                                 )    ; // (quietly, with no sequence number)
+            void         setCommandSender(           ALTAIR_CommandSender* sender                ) { _commandSender = sender      ; } // Send commands reliably (see ALTAIR_CommandARQ.h).
+            bool         queueCommandToALTAIR(       byte               commandByte1    ,              // Queue a command to be sent (and sent again until
+                                                     byte               commandByte2            )    ; //    it is acknowledged).  False if the window is full.
+            uint8_t      serviceCommandsToALTAIR(                                               )    ; // Send the queued commands that are due.  Returns the # sent.
     virtual bool         sendStart(                                                             ) { return send((unsigned char)  TX_START_BYTE      ) ; }
     virtual bool         sendAsIndivChars(  const    uint8_t*           aString                 ) = 0;
     virtual bool         sendCallSign(                                                          ) { return send((const uint8_t*) CALL_SIGN_STRING   ) ; }
     virtual bool         sendEndMessage(                                                        ) { return send((const uint8_t*) END_MESSAGE_STRING ) ; }
+    virtual uint8_t      callSignBytes(                                                         ) { return sizeof(CALL_SIGN_STRING) - 1 + sizeof(END_MESSAGE_STRING) - 1 ; } // (both)
     virtual bool         available(                                                             ) = 0; // If a byte is available for reading, returns true.
     virtual bool         isBusy(                                                                ) = 0;
+    virtual bool         txBacklogged(                                                          ) { return isBusy() ; } // If a new frame cannot be sent (or queued) now, returns true.
+    virtual uint16_t     txRoom(                                                                ) { return txBacklogged() ? 0 : LINK_ENCODER_MAX_LENGTH ; } // The most bytes that can be sent now without waiting.
+    virtual bool         sendNonBlocking(   const    uint8_t*           anArray         ,              // Send an array of bytes (of at most txRoom())
+                                            const    uint8_t            arrayLen                ) { return send(anArray, arrayLen) ; } //    without waiting for it to go out.
     virtual bool         initialize(        const    char*              aString         = ""    ) = 0;
     virtual byte         read(                                                                  ) = 0;
-    virtual void         readALTAIRInfo(             byte               command[]       ,              // Read a command sent up, and/or any info sent down.
+    virtual void         readALTAIRInfo(             byte               command[]       ,              // Read a command sent up (into COMMAND_LENGTH bytes), and/or any info sent down.
                                                      bool               isGroundStation = false )    ;
             void         printALTAIRInfo(                                                       )    ; // Just print out (to USB Serial) any info sent down from ALTAIR.
     virtual const char*  radioName(                                                             ) = 0;
@@ -69,9 +112,13 @@ class ALTAIR_GenTelInt {
     virtual char         lastRSSI(                                                              ) = 0; // The RSSI value of the most recently received 
                                                                                                        // message.  Return value is in dBm, response of 
                                                                                                        // +127 means failed to get the last RSSI value.
+            void         noteRSSI(                   char               dBm             ,              // An RSSI reading, of something just received,
+                                                     unsigned long      now                     ) { _lastRSSI = dBm ; _lastRSSIMillis = now ; } // for lastRSSI.
+            unsigned long lastRSSIMillis(                                                       ) { return _lastRSSIMillis        ; } // (when lastRSSI was read)
     virtual bool         lastSentString2(                                                       ) = 0;
 
   protected:
+    virtual void         termReceived(                                                          ) { }  // (called by readALTAIRInfo, with the carrier likely still up)
             bool         sendBareGPS(                uint8_t            hour            ,
                                                      uint8_t            minute          ,
                                                      uint8_t            second          ,
@@ -85,10 +132,22 @@ class ALTAIR_GenTelInt {
                                                      int32_t            longitude               )    ;
             bool         sendBareGPSEle(             int16_t            elevation               )    ;
 
+            bool         sendKeyOrDelta(             uint8_t            frameType               )    ; // Send the frame in _txFrame, in full or as a delta.
             void         groundStationPrintRxInfo(   byte               term[]          ,
                                                      int                termLength              )    ;
     ALTAIR_GenTelInt(                                                                           )    ;
 
+            byte         _txFrame[FRAME_HEADER_LENGTH + MAX_FRAME_DATA_LENGTH]                           ; // the frame being built by sendAllALTAIRInfo
+    static  uint8_t      _commandSequence                                                                ; // shared by all of a ground station's radios
+            ALTAIR_LinkEncoder _encoder                                                                  ; // this link's keyframes
+            bool         _reducedContent                                                                 ;
+            bool         _reducedSentFrame1                                                              ; // (which frame the last reduced send was)
+            uint16_t     _lastSendBytes                                                                  ;
+            uint8_t      _lastSendFrames                                                                 ;
+            char         _lastRSSI                                                                       ; // (FAKE_RSSI_VAL until a reading is noted)
+            unsigned long _lastRSSIMillis                                                                ;
+            ALTAIR_CommandSender* _commandSender                                                         ; // (NULL: each command is sent just once)
+
   private:
   
 };
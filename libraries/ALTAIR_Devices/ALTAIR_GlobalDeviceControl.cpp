@@ -74,6 +74,31 @@ void ALTAIR_GlobalDeviceControl::performCommand(       byte                  com
     case 'r':
       _telemSystem.switchToBackup2();
        break;
+    case 'P':
+      if (!_sitAwareSystem.arduinoMicro()->setExtended(true)) Serial.println(F("The Arduino Micro does not have extended readings"));
+       break;
+    case 'p':
+      _sitAwareSystem.arduinoMicro()->setExtended(false);
+       break;
+    case 'K':
+    case 'k':
+      // (keyframes plus deltas, or full frames only)
+      _telemSystem.dnt900( )->setDeltaKeyframeInterval((commandByte == 'K') ? DEFAULT_DELTA_KEYFRAME_INTERVAL : 1);
+      _telemSystem.shx144( )->setDeltaKeyframeInterval((commandByte == 'K') ? DEFAULT_DELTA_KEYFRAME_INTERVAL : 1);
+      _telemSystem.rfm23bp()->setDeltaKeyframeInterval((commandByte == 'K') ? DEFAULT_DELTA_KEYFRAME_INTERVAL : 1);
+       break;
+    case 'F':
+      _telemSystem.setFanOut(true);
+       break;
+    case 'f':
+      _telemSystem.setFanOut(false);
+       break;
+    case 'A':
+      _telemSystem.setAutoFailover(true);
+       break;
+    case 'a':
+      _telemSystem.setAutoFailover(false);
+       break;
     default :
        break;
   }
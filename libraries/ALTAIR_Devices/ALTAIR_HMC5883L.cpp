@@ -50,7 +50,8 @@ void ALTAIR_HMC5883L::initialize(                              )
 /**************************************************************************/
 float ALTAIR_HMC5883L::getHeading(                             )
 {
-    /* Get a new sensor event */
+    /* Get a new sensor event (after the queued I2C requests, as the Adafruit library uses Wire) */
+    ALTAIR_HAL::i2cFlush();
     _theHMC5883.getEvent(&_lastEvent);
 
     // Hold the module so that Z is pointing 'up' and you can measure the heading with x&y
@@ -19,6 +19,7 @@
 #define   ALTAIR_HMC5883L_h
 
 #include "ALTAIR_OrientSensor.h"
+#include <ALTAIR_HAL.h>
 #include <Adafruit_HMC5883_U.h>
 
 #define   HMC5883L_SENSORID    12345
@@ -29,7 +30,7 @@ class ALTAIR_HMC5883L : public ALTAIR_OrientSensor {
     ALTAIR_HMC5883L(                                        );
 
     virtual void               initialize(                  );
-            void               update(                      ) { _theHMC5883.getEvent(     &_lastEvent               ); }
+            void               update(                      ) { ALTAIR_HAL::i2cFlush(); _theHMC5883.getEvent( &_lastEvent ); }  // (flushed, as the Adafruit library uses Wire)
 
             float              getHeading(                  );
 
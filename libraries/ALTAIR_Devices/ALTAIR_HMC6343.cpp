@@ -49,6 +49,7 @@ void ALTAIR_HMC6343::initialize(                              )
 /**************************************************************************/
 void ALTAIR_HMC6343::printInfo(                              )
 {
+    ALTAIR_HAL::i2cFlush(    );
     _theHMC6343.readHeading( );
     printHeadingData(        );
     _theHMC6343.readAccel(   );
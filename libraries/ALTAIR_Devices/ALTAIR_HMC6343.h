@@ -19,6 +19,7 @@
 #define   ALTAIR_HMC6343_h
 
 #include "ALTAIR_OrientSensor.h"
+#include <ALTAIR_HAL.h>
 #include <SFE_HMC6343.h>
 
 class ALTAIR_HMC6343 : public ALTAIR_OrientSensor {
@@ -27,7 +28,7 @@ class ALTAIR_HMC6343 : public ALTAIR_OrientSensor {
     ALTAIR_HMC6343(                     )                                                                                   ;
 
     virtual void      initialize(       )                                                                                   ;
-            void      update(           ) {                                                    _theHMC6343.readHeading(    ); 
+            void      update(           ) { ALTAIR_HAL::i2cFlush(                           ); _theHMC6343.readHeading(    );   // (flushed, as SFE_HMC6343 uses Wire) 
                                                                                                _theHMC6343.readAccel(      ); 
                                                                                                _theHMC6343.readTilt(       ); }
 
@@ -0,0 +1,121 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_I2CBus.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR I2C bus manager (see ALTAIR_I2CBus.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_I2CBus.h"
+
+#define   I2CBUS_DONE          TCA9548A_UNKNOWN      // (marks a queued transaction that has been run)
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_I2CBus::ALTAIR_I2CBus(                                        ) :
+    _count(                                                         0 )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Queue a device's transaction, with the multiplexer channel that it
+         needs, to be run by runQueued().
+*/
+/**************************************************************************/
+bool ALTAIR_I2CBus::queue( ALTAIR_I2CDevice* device  ,
+                           char              channel  )
+{
+    if (device == NULL || _count >= I2CBUS_QUEUE_LENGTH ||
+        channel > TCA9548A_MAXLOC || channel < TCA9548A_ANYCHANNEL) {
+        ++_stats.unqueued;
+        return false;
+    }
+    _devices[_count]  = device;
+    _channels[_count] = channel;
+    ++_count;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Run every queued transaction, grouped by channel: those that can
+         run on the channel already selected first, and then each other
+         channel's, in the order in which they were first queued.  If a
+         channel cannot be selected, its transactions are not run (as
+         they might reach a different device), and count as failed.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_I2CBus::runQueued(                                    )
+{
+    uint8_t succeeded = runChannel(ALTAIR_TCA9548A::selected());
+    for (uint8_t i = 0; i < _count; ++i) {
+        char channel = _channels[i];
+        if (channel == I2CBUS_DONE) continue;
+        ++_stats.muxSelects;
+        if (ALTAIR_TCA9548A::tcaselect(channel)) {
+            succeeded += runChannel(channel);
+            continue;
+        }
+        for (uint8_t j = i; j < _count; ++j) {
+            if (_channels[j] != channel) continue;
+            _channels[j] = I2CBUS_DONE;
+            ++_stats.failed;
+        }
+    }
+    _count = 0;
+    ++_stats.sweeps;
+    return succeeded;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Run each queued transaction that can run with this channel
+         selected (including those that can run on any channel).
+*/
+/**************************************************************************/
+uint8_t ALTAIR_I2CBus::runChannel( char channel )
+{
+    uint8_t succeeded = 0;
+    for (uint8_t i = 0; i < _count; ++i) {
+        if (_channels[i] == I2CBUS_DONE) continue;
+        if (_channels[i] != channel && _channels[i] != TCA9548A_ANYCHANNEL) continue;
+        _channels[i] = I2CBUS_DONE;
+        ++_stats.transactions;
+        if (_devices[i]->sample()) ++succeeded;
+        else                       ++_stats.failed;
+    }
+    return succeeded;
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the bus manager and multiplexer
+         statistics.
+*/
+/**************************************************************************/
+void ALTAIR_I2CBus::printStats(                                      )
+{
+    const ALTAIR_TCA9548AStats* mux = ALTAIR_TCA9548A::stats();
+    Serial.println(F("I2C bus statistics:"));
+    Serial.print(F("   sweeps / transactions / failed: ")); Serial.print(_stats.sweeps);     Serial.print(F(" / "));
+    Serial.print(_stats.transactions);                      Serial.print(F(" / "));          Serial.println(_stats.failed);
+    Serial.print(F("   mux selects / writes / elided / failed: ")); Serial.print(_stats.muxSelects); Serial.print(F(" / "));
+    Serial.print(mux->writes); Serial.print(F(" / ")); Serial.print(mux->elided); Serial.print(F(" / ")); Serial.println(mux->failedWrites);
+    Serial.print(F("   not queued: "));                     Serial.println(_stats.unqueued);
+}
+#endif
@@ -0,0 +1,86 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_I2CBus.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR I2C bus manager, which runs a sweep of
+    I2C devices' transactions (e.g. the BME280s' samples), some of them on
+    the main bus and some behind the TCA9548A multiplexer.
+
+    Each transaction is queued with the multiplexer channel that it needs:
+    a channel (0 to 7); TCA9548A_EVERYTHINGELSE, for a device on the main
+    bus which shares its address with a device behind the multiplexer (as
+    the nav mast BME280 does with the one inside the gondola); or
+    TCA9548A_ANYCHANNEL, for a device on the main bus which does not.
+    runQueued() then runs them grouped by channel: first those that can
+    run on the channel that is already selected, and then each other
+    channel's (in the order in which they were first queued), so that a
+    sweep selects each channel it needs at most once, and not at all if
+    it was already selected.  The channel is left selected afterwards (as
+    ALTAIR_TCA9548A remembers which one that is), so the next sweep starts
+    with that channel's transactions.
+
+    Devices that are not queued here (e.g. the Arduino Micro) can be
+    talked to whichever channel is selected, as long as no device behind
+    the multiplexer shares their address.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_I2CBus_h
+#define   ALTAIR_I2CBus_h
+
+#include <ALTAIR_HAL.h>
+#include "ALTAIR_TCA9548A.h"
+
+#define   I2CBUS_QUEUE_LENGTH          8
+
+/**************************************************************************/
+/*!
+    A device with a transaction to run on the bus (e.g. a sample).
+*/
+/**************************************************************************/
+class     ALTAIR_I2CDevice {
+  public:
+    virtual bool        sample(                                                     ) = 0;   // False if it failed (or there was nothing new).
+};
+
+struct    ALTAIR_I2CBusStats {
+    unsigned long       sweeps                                              ;
+    unsigned long       transactions                                        ;
+    unsigned long       failed                                              ;  // transactions that returned false
+    unsigned long       muxSelects                                          ;  // channels needed by a sweep, other than the one already selected
+    unsigned long       unqueued                                            ;  // transactions queued with the queue full, or with no such channel
+};
+
+class     ALTAIR_I2CBus {
+  public:
+
+    ALTAIR_I2CBus(                                                          ) ;
+
+    bool                queue(          ALTAIR_I2CDevice*     device              ,
+                                        char                  channel               ) ;   // TCA9548A_MINLOC to _MAXLOC, _EVERYTHINGELSE or _ANYCHANNEL
+    uint8_t             runQueued(                                                  ) ;   // Run (and then clear) the queue.  Returns the # that succeeded.
+    uint8_t             queued(                                                     ) { return _count                     ; }
+
+    const ALTAIR_I2CBusStats* stats(                                                ) { return &_stats                    ; }
+#ifdef    ARDUINO
+    void                printStats(                                                 ) ;
+#endif
+
+  private:
+    uint8_t             runChannel(     char                  channel               ) ;
+
+    ALTAIR_I2CDevice*   _devices[       I2CBUS_QUEUE_LENGTH                         ] ;
+    char                _channels[      I2CBUS_QUEUE_LENGTH                         ] ;
+    uint8_t             _count                                                      ;
+    ALTAIR_I2CBusStats  _stats                                                      ;
+};
+
+#endif    //   ifndef ALTAIR_I2CBus_h
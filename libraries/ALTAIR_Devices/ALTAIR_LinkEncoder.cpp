@@ -0,0 +1,160 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_LinkEncoder.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the encoder of the status frames for a single
+    telemetry radio link (see ALTAIR_LinkEncoder.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_LinkEncoder.h"
+
+static const uint8_t statusFrameLengths[NUM_STATUS_FRAMES] = { ALTAIR_AllInfoFrame1::length, ALTAIR_AllInfoFrame2::length, ALTAIR_PropulsionFrame::length };
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.  (The first frame of each kind is a keyframe.)
+*/
+/**************************************************************************/
+ALTAIR_LinkEncoder::ALTAIR_LinkEncoder(                           ) :
+               _keyframeInterval(  DEFAULT_DELTA_KEYFRAME_INTERVAL   ) ,
+               _cycleSequence(                          0   ) ,
+               _cycleMaxFrames(                         0   ) ,
+               _cycleStart(                             0   ) ,
+               _cycleVisited(           NUM_STATUS_FRAMES   ) ,
+               _cycleSent(                              0   ) ,
+               _pending(                                0   ) ,
+               _pendingIsKey(                       false   ) ,
+               _resumeAt(                               0   )
+{
+    _framesSinceKey[0] = _framesSinceKey[1] = DELTA_NO_KEYFRAME;
+    memset(_cycleFrames, 0, sizeof(_cycleFrames));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send a keyframe every interval-th time that each frame is sent,
+         and deltas in between (or, with an interval of 0 or 1, always
+         send the frames in full).  The next frames are keyframes.
+*/
+/**************************************************************************/
+void ALTAIR_LinkEncoder::setKeyframeInterval( uint8_t interval )
+{
+    _keyframeInterval  = interval;
+    _framesSinceKey[0] = _framesSinceKey[1] = DELTA_NO_KEYFRAME;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Encode a frame (of type DELTA_FRAME_TYPE_1 or 2, or
+         STATUS_FRAME_PROPULSION, which is always sent in full): as a
+         keyframe, if it is time for one (or if a delta would be no
+         shorter), or else as a delta against the last keyframe.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_LinkEncoder::encodeFrame( uint8_t frameType , const byte* data , uint8_t length , byte* out , bool& isKey )
+{
+    if (frameType == DELTA_FRAME_TYPE_1 || frameType == DELTA_FRAME_TYPE_2) {
+        const byte* key   = (frameType == DELTA_FRAME_TYPE_1) ? _key1 : _key2;
+        uint8_t     since = _framesSinceKey[frameType - 1];
+        if (since != DELTA_NO_KEYFRAME && since + 1 < _keyframeInterval) {
+            uint8_t deltaLength = deltaEncode(frameType, key, data, out + FRAME_HEADER_LENGTH, length - 1);
+            if (deltaLength > 0) {
+                out[0] = DELTA_FRAME_START_BYTE;
+                out[1] = deltaLength;
+                isKey  = false;
+                return FRAME_HEADER_LENGTH + deltaLength;
+            }
+        }
+    }
+    out[0] = FRAME_START_BYTE;
+    out[1] = length;
+    memcpy(out + FRAME_HEADER_LENGTH, data, length);
+    isKey  = true;
+    return FRAME_HEADER_LENGTH + length;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A frame from encodeFrame has been sent: a keyframe is kept as
+         such only now.
+*/
+/**************************************************************************/
+void ALTAIR_LinkEncoder::commitFrame( uint8_t frameType , const byte* data , bool isKey )
+{
+    if (frameType != DELTA_FRAME_TYPE_1 && frameType != DELTA_FRAME_TYPE_2) return;
+    uint8_t& since = _framesSinceKey[frameType - 1];
+    if (isKey) {
+        memcpy((frameType == DELTA_FRAME_TYPE_1) ? _key1 : _key2, data, statusFrameLengths[frameType - 1]);
+        since = 0;
+    } else {
+        ++since;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Start a fan-out cycle.  The frames are offered in turn, starting
+         with the first one that was not sent on the last cycle.
+*/
+/**************************************************************************/
+void ALTAIR_LinkEncoder::beginCycle( const byte* frame1 , const byte* frame2 , const byte* propulsion , uint8_t sequence , uint8_t maxFrames )
+{
+    _cycleFrames[0] = frame1;
+    _cycleFrames[1] = frame2;
+    _cycleFrames[2] = propulsion;
+    _cycleSequence  = sequence & FANOUT_SEQUENCE_MASK;
+    _cycleMaxFrames = maxFrames;
+    _cycleStart     = _resumeAt;
+    _cycleVisited   = 0;
+    _cycleSent      = 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Encode the next frame of the cycle, with its sequence number,
+         into out (which must have room for LINK_ENCODER_MAX_LENGTH bytes).
+         Returns its length, or 0 if the cycle is over, or if the frame
+         would be longer than room (in which case it is the first frame
+         of the next cycle).
+*/
+/**************************************************************************/
+uint8_t ALTAIR_LinkEncoder::nextFrame( byte* out , uint16_t room )
+{
+    while (_cycleVisited < NUM_STATUS_FRAMES) {
+        uint8_t index = (_cycleStart + _cycleVisited) % NUM_STATUS_FRAMES;
+        if (_cycleFrames[index] == NULL) { ++_cycleVisited; continue; }
+        _resumeAt = index;
+        if (_cycleSent >= _cycleMaxFrames) return 0;
+
+        out[0] = FANOUT_SEQUENCE_BYTE;
+        out[1] = _cycleSequence;
+        uint8_t length = FANOUT_SEQUENCE_LENGTH + encodeFrame(index + 1, _cycleFrames[index], statusFrameLengths[index], out + FANOUT_SEQUENCE_LENGTH, _pendingIsKey);
+        if (length > room) return 0;
+        _pending = index;
+        return length;
+    }
+    return 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The frame from nextFrame was sent.
+*/
+/**************************************************************************/
+void ALTAIR_LinkEncoder::frameSent(                                )
+{
+    commitFrame(_pending + 1, _cycleFrames[_pending], _pendingIsKey);
+    ++_cycleVisited;
+    ++_cycleSent;
+    _resumeAt = (_pending + 1) % NUM_STATUS_FRAMES;
+}
@@ -0,0 +1,97 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_LinkEncoder.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the encoder of the status frames for a single
+    telemetry radio link.  Each radio has one, which keeps that link's
+    keyframes, and encodes each frame either in full or as a delta
+    against them (see ALTAIR_TelemetryDelta.h).
+
+    For the fan-out of the status to all of the radios at once (see
+    ALTAIR_TelemetrySystem::fanOutStatus), the frames are built just
+    once, and then each radio's encoder is given the same frames, and
+    hands back, one at a time, as many of them as the radio has room for
+    right now (its MTU, e.g. the room in its transmit queue, or in one
+    packet), so that nothing ever has to wait for a radio.  The frames
+    that do not fit (or that a link with reduced content has no room
+    for) are sent first on the next cycle.  Each fanned-out frame is
+    preceded by the cycle's sequence number:
+
+      [FANOUT_SEQUENCE_BYTE] [sequence (0 to 127)] [the frame, full or delta ...]
+
+    so that a ground station that receives the same frame via several
+    radios can tell that it is the same one (see ALTAIR_SequenceFilter in
+    ALTAIR_DownlinkDecoder.h).  (The sequence number is kept below 0x80,
+    so that it can never be mistaken for a start byte.)
+
+    This file does not depend upon the Arduino libraries, so that the
+    encoder can also be run on a host computer (see
+    tools/ALTAIRFanOutSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_LinkEncoder_h
+#define   ALTAIR_LinkEncoder_h
+
+#include "ALTAIR_TelemetryFrames.h"
+#include "ALTAIR_TelemetryDelta.h"
+
+#define   FANOUT_SEQUENCE_BYTE        0xF8
+#define   FANOUT_SEQUENCE_LENGTH         2          // the sequence byte, and the sequence number
+#define   FANOUT_SEQUENCE_MASK        0x7F
+#define   STATUS_FRAME_PROPULSION        3          // (the status frames are DELTA_FRAME_TYPE_1, DELTA_FRAME_TYPE_2, and this)
+#define   NUM_STATUS_FRAMES              3
+#define   LINK_ENCODER_MAX_LENGTH     (FANOUT_SEQUENCE_LENGTH + FRAME_HEADER_LENGTH + MAX_FRAME_DATA_LENGTH)
+
+class     ALTAIR_LinkEncoder {
+  public:
+
+    ALTAIR_LinkEncoder(                                                                ) ;
+
+    void                    setKeyframeInterval( uint8_t          interval              ) ;   // A keyframe every interval-th time each frame is
+    uint8_t                 keyframeInterval(                                          ) { return _keyframeInterval              ; } //    sent (1: always in full).
+
+    uint8_t                 encodeFrame(    uint8_t               frameType       ,           // Encode a frame (with its start and length
+                                            const byte*           data            ,           //    bytes) into out, in full or as a delta,
+                                            uint8_t               length          ,           //    and return its length.  Nothing changes
+                                            byte*                 out             ,           //    until it is committed, once it is sent.
+                                            bool&                 isKey             ) ;
+    void                    commitFrame(    uint8_t               frameType       ,
+                                            const byte*           data            ,
+                                            bool                  isKey             ) ;
+
+    void                    beginCycle(     const byte*           frame1          ,           // Start a fan-out cycle, of the given frames
+                                            const byte*           frame2          ,           //    (propulsion may be NULL), and of at most
+                                            const byte*           propulsion      ,           //    maxFrames frames.
+                                            uint8_t               sequence        ,
+                                            uint8_t               maxFrames         ) ;
+    uint8_t                 nextFrame(      byte*                 out             ,           // The next frame of the cycle (with its sequence
+                                            uint16_t              room              ) ;       //    number), or 0 if there is none, or no room.
+    void                    frameSent(                                                 ) ;   // (The frame from nextFrame was sent.)
+
+  private:
+
+    byte                   _key1[ALTAIR_AllInfoFrame1::length]                          ;  // the last keyframes sent
+    byte                   _key2[ALTAIR_AllInfoFrame2::length]                          ;
+    uint8_t                _framesSinceKey[2]                                           ;  // (DELTA_NO_KEYFRAME if none has been sent)
+    uint8_t                _keyframeInterval                                            ;
+
+    const byte*            _cycleFrames[NUM_STATUS_FRAMES]                              ;
+    uint8_t                _cycleSequence                                               ;
+    uint8_t                _cycleMaxFrames                                              ;
+    uint8_t                _cycleStart                                                  ;  // the index of the first frame to offer
+    uint8_t                _cycleVisited                                                ;  // # of frames offered and sent (or skipped)
+    uint8_t                _cycleSent                                                   ;
+    uint8_t                _pending                                                     ;  // the index of the frame from nextFrame
+    bool                   _pendingIsKey                                                ;
+    uint8_t                _resumeAt                                                    ;  // the index to start the next cycle with
+};
+#endif    //   ifndef ALTAIR_LinkEncoder_h
@@ -0,0 +1,267 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_LinkQuality.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the link-quality tracker of the telemetry radios
+    (see ALTAIR_LinkQuality.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_LinkQuality.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.  (Every link starts out with a full command rate,
+         so that nothing fails over before anything has been heard.)
+*/
+/**************************************************************************/
+ALTAIR_LinkQuality::ALTAIR_LinkQuality(                            ) :
+               _periodStarted(                          false   ) ,
+               _periodStartMillis(                          0   ) ,
+               _switched(                               false   ) ,
+               _failing(                                false   ) ,
+               _failingSinceMillis(                         0   ) ,
+               _returnTo(                                  -1   ) ,
+               _returnSinceMillis(                          0   )
+{
+    for (uint8_t i = 0; i < LINK_QUALITY_MAX_LINKS; ++i) {
+        _rssiFloor[i]       = -110;
+        _rssiGood[i]        =  -80;
+        _listening[i]       = false;
+        _rssiAverage[i]     = 0;
+        _haveRSSI[i]        = false;
+        _rssiMillis[i]      = 0;
+        _commandRate[i]     = 0xFFFF;
+        _heardThisPeriod[i] = false;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Set the radio's sensitivity (where its RSSI margin is 0), and the
+         RSSI at which its margin is full.
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::configure( uint8_t link , int8_t rssiFloor , int8_t rssiGood )
+{
+    if (link >= LINK_QUALITY_MAX_LINKS || rssiGood <= rssiFloor) return;
+    _rssiFloor[link] = rssiFloor;
+    _rssiGood[link]  = rssiGood;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Is the radio on (and so judged, and a candidate to switch to)?
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::setListening( uint8_t link , bool on )
+{
+    if (link < LINK_QUALITY_MAX_LINKS) _listening[link] = on;
+}
+
+/**************************************************************************/
+/*!
+ @brief  An RSSI reading (in dBm) of something that the radio received,
+         into the link's running average (which follows a quarter of the
+         way towards each new reading).
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::rssiHeard( uint8_t link , int8_t dBm , unsigned long now )
+{
+    if (link >= LINK_QUALITY_MAX_LINKS || dBm == LINK_NO_RSSI) return;
+    int16_t reading = (int16_t) dBm * 16;
+    if (_haveRSSI[link]) _rssiAverage[link] += (reading - _rssiAverage[link]) / 4;
+    else                 _rssiAverage[link]  =  reading;
+    _haveRSSI[link]   = true;
+    _rssiMillis[link] = now;
+    ++_stats.rssiSamples[link];
+}
+
+/**************************************************************************/
+/*!
+ @brief  A command (or a heartbeat) came up via the link.
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::commandHeard( uint8_t link , unsigned long now )
+{
+    if (link >= LINK_QUALITY_MAX_LINKS) return;
+    update(now);
+    _heardThisPeriod[link] = true;
+    ++_stats.commandsHeard[link];
+}
+
+/**************************************************************************/
+/*!
+ @brief  Close each heartbeat period that is over: each link's command
+         rate follows a quarter of the way towards whether or not it heard
+         anything in it.  (After a long gap, just one period is closed.)
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::update( unsigned long now )
+{
+    if (!_periodStarted) {
+        _periodStarted     = true;
+        _periodStartMillis = now;
+        return;
+    }
+    while (now - _periodStartMillis >= LINK_HEARTBEAT_PERIOD) {
+        for (uint8_t i = 0; i < LINK_QUALITY_MAX_LINKS; ++i) {
+            int32_t target       = _heardThisPeriod[i] ? 0xFFFF : 0;
+            _commandRate[i]      = (uint16_t) (_commandRate[i] + (target - (int32_t) _commandRate[i]) / 4);
+            _heardThisPeriod[i]  = false;
+        }
+        ++_stats.periods;
+        if (now - _periodStartMillis >= 8 * (unsigned long) LINK_HEARTBEAT_PERIOD) _periodStartMillis  = now;
+        else                                                                   _periodStartMillis += LINK_HEARTBEAT_PERIOD;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  The running average of the link's RSSI (in dBm).
+*/
+/**************************************************************************/
+int8_t ALTAIR_LinkQuality::rssi( uint8_t link )
+{
+    if (link >= LINK_QUALITY_MAX_LINKS || !_haveRSSI[link]) return LINK_NO_RSSI;
+    return (int8_t) (_rssiAverage[link] / 16);
+}
+
+/**************************************************************************/
+/*!
+ @brief  The link's score: the mean of its RSSI margin and its command
+         rate (each 0 to 255), of whichever of them are known.  An RSSI
+         that is stale counts as no margin if another link has heard the
+         ground since, and is left out if none has.
+*/
+/**************************************************************************/
+int16_t ALTAIR_LinkQuality::score( uint8_t link , unsigned long now )
+{
+    if (link >= LINK_QUALITY_MAX_LINKS) return LINK_SCORE_UNKNOWN;
+    int16_t total = 0;
+    uint8_t parts = 0;
+
+    if (_haveRSSI[link]) {
+        if (now - _rssiMillis[link] <= LINK_RSSI_STALE_MILLIS) {
+            int32_t margin = ((int32_t) _rssiAverage[link] - 16 * _rssiFloor[link]) * 255 / (16 * (_rssiGood[link] - _rssiFloor[link]));
+            total += (margin < 0) ? 0 : (margin > 255) ? 255 : (int16_t) margin;
+            ++parts;
+        } else {
+            for (uint8_t i = 0; i < LINK_QUALITY_MAX_LINKS; ++i) {
+                if (i != link && _listening[i] && _haveRSSI[i] && now - _rssiMillis[i] <= LINK_RSSI_STALE_MILLIS) { ++parts; break; }
+            }
+        }
+    }
+    if (_stats.periods > 0) {
+        total += commandRate(link);
+        ++parts;
+    }
+    return (parts == 0) ? LINK_SCORE_UNKNOWN : total / parts;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The failover policy (see ALTAIR_LinkQuality.h): returns the link
+         to switch the primary radio to now, or -1 to stay on the primary
+         link.  (The caller then does the switch, and calls
+         primaryChanged.)
+*/
+/**************************************************************************/
+int8_t ALTAIR_LinkQuality::choosePrimary( uint8_t primary , unsigned long now )
+{
+    if (primary >= LINK_QUALITY_MAX_LINKS) return -1;
+    if (_switched && now - _stats.lastSwitchMillis < LINK_MIN_DWELL_MILLIS) {
+        _failing  = false;
+        _returnTo = -1;
+        return -1;
+    }
+    int16_t primaryScore = score(primary, now);
+
+// The most preferred of the other links that is good, or else the best of them (the more preferred one, on a tie)
+// (so that it does not fail over to one backup, only to return to the other one later)
+    int8_t  best      = -1;
+    int16_t bestScore = LINK_SCORE_UNKNOWN;
+    for (uint8_t i = 0; i < LINK_QUALITY_MAX_LINKS; ++i) {
+        if (i == primary || !_listening[i]) continue;
+        int16_t s = score(i, now);
+        if (bestScore >= LINK_GOOD_SCORE) break;
+        if (s > bestScore) { best = i; bestScore = s; }
+    }
+
+// Fail over, if the primary link has been failing for long enough, and another is clearly better
+    if (primaryScore != LINK_SCORE_UNKNOWN && primaryScore < LINK_FAILOVER_SCORE && best >= 0 && bestScore >= primaryScore + LINK_SWITCH_MARGIN) {
+        if (!_failing) {
+            _failing            = true;
+            _failingSinceMillis = now;
+        } else if (now - _failingSinceMillis >= LINK_FAILOVER_HOLD_MILLIS) {
+            ++_stats.failovers;
+            return best;
+        }
+    } else {
+        _failing = false;
+    }
+
+// Return to the most preferred link that has been good (and not clearly worse than the primary) for long enough
+    int8_t preferred = -1;
+    for (uint8_t i = 0; i < primary; ++i) {
+        if (!_listening[i]) continue;
+        int16_t s = score(i, now);
+        if (s >= LINK_GOOD_SCORE && s + LINK_SWITCH_MARGIN >= primaryScore) { preferred = i; break; }
+    }
+    if (preferred < 0) {
+        _returnTo = -1;
+    } else if (preferred != _returnTo) {
+        _returnTo          = preferred;
+        _returnSinceMillis = now;
+    } else if (now - _returnSinceMillis >= LINK_RETURN_HOLD_MILLIS) {
+        ++_stats.returns;
+        return preferred;
+    }
+    return -1;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The primary radio has been switched (by the policy, or by hand).
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::primaryChanged( unsigned long now )
+{
+    _switched               = true;
+    _stats.lastSwitchMillis = now;
+    _failing                = false;
+    _returnTo               = -1;
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) each link's quality, and the failover
+         statistics.
+*/
+/**************************************************************************/
+void ALTAIR_LinkQuality::printStats( const char* const* linkNames )
+{
+    unsigned long now = millis();
+    Serial.println(F("Link quality:"));
+    for (uint8_t i = 0; i < LINK_QUALITY_MAX_LINKS; ++i) {
+        if (!_listening[i]) continue;
+        Serial.print(F("   "));                  Serial.print(linkNames[i]);
+        Serial.print(F(": score "));             Serial.print(score(i, now));
+        Serial.print(F(", RSSI (dBm) "));        Serial.print(rssi(i));
+        Serial.print(F(", command rate "));      Serial.print(commandRate(i));
+        Serial.print(F(", samples/commands "));  Serial.print(_stats.rssiSamples[i]); Serial.print(F("/")); Serial.println(_stats.commandsHeard[i]);
+    }
+    Serial.print(F("   failovers / returns: ")); Serial.print(_stats.failovers); Serial.print(F(" / ")); Serial.println(_stats.returns);
+}
+#endif
@@ -0,0 +1,131 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_LinkQuality.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the link-quality tracker of the telemetry radios,
+    and the policy that picks the primary radio from it.  For each link
+    (by radio_t), it keeps:
+
+      - a running average of the RSSI of what the radio receives (the
+        DNT900's from its protocol-mode replies, the RFM23BP's from each
+        packet, and the SHX144's from its analog RSSI output, via the
+        ADS1115 ADC), as a margin above the radio's sensitivity;
+      - the command rate: the share of heartbeat periods (of
+        LINK_HEARTBEAT_PERIOD) in which at least one command came up via
+        the link.  (The ground stations send a HEARTBEAT_COMMAND whenever
+        they have nothing else to send, so that a silent link shows up.)
+
+    The link's score (0 to 255) is the mean of the two.  An RSSI that
+    has gone stale, while another link is still hearing the ground,
+    counts as none at all.
+
+    The failover policy has hysteresis, so that a marginal link does not
+    make the primary radio flap back and forth: it fails over only once
+    the primary link's score has stayed below LINK_FAILOVER_SCORE for
+    LINK_FAILOVER_HOLD_MILLIS, and only to a link that is at least
+    LINK_SWITCH_MARGIN better (the most preferred one that is good, if
+    any is); it returns to a preferred link (the lower
+    the radio_t, the more preferred, i.e. the DNT900 first) only once that
+    link has stayed at or above LINK_GOOD_SCORE (and no more than
+    LINK_SWITCH_MARGIN worse than the primary) for LINK_RETURN_HOLD_MILLIS;
+    and it never switches again
+    within LINK_MIN_DWELL_MILLIS of the last switch.
+
+    This file does not depend upon the Arduino libraries, so that the
+    tracker and the policy can also be run on a host computer (see
+    tools/ALTAIRFailoverSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_LinkQuality_h
+#define   ALTAIR_LinkQuality_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   LINK_QUALITY_MAX_LINKS         3
+#define   LINK_NO_RSSI                 127          // (as FAKE_RSSI_VAL)
+#define   LINK_SCORE_UNKNOWN            -1          // nothing has been heard, on any link, to judge it by
+#define   LINK_HEARTBEAT_PERIOD       4000          // in milliseconds (twice the ground stations' heartbeat interval)
+#define   LINK_RSSI_STALE_MILLIS     10000
+#define   LINK_FAILOVER_SCORE           80
+#define   LINK_GOOD_SCORE              180
+#define   LINK_SWITCH_MARGIN            40
+#define   LINK_FAILOVER_HOLD_MILLIS   5000
+#define   LINK_RETURN_HOLD_MILLIS    60000
+#define   LINK_MIN_DWELL_MILLIS      20000
+
+struct    ALTAIR_LinkQualityStats {
+    unsigned long       rssiSamples[LINK_QUALITY_MAX_LINKS]                 ;
+    unsigned long       commandsHeard[LINK_QUALITY_MAX_LINKS]               ;  // (including heartbeats)
+    unsigned long       periods                                             ;  // heartbeat periods closed
+    unsigned long       failovers                                           ;  // away from a failing primary link
+    unsigned long       returns                                             ;  // back to a preferred link
+    unsigned long       lastSwitchMillis                                    ;  // (including switches by hand)
+};
+
+class     ALTAIR_LinkQuality {
+  public:
+
+    ALTAIR_LinkQuality(                                                                ) ;
+
+    void                    configure(      uint8_t               link            ,           // The radio's sensitivity, and the RSSI at
+                                            int8_t                rssiFloor       ,           //    which its margin is full (in dBm).
+                                            int8_t                rssiGood          ) ;
+    void                    setListening(   uint8_t               link            ,           // (Only links that are on are judged.)
+                                            bool                  on                ) ;
+
+    void                    rssiHeard(      uint8_t               link            ,
+                                            int8_t                dBm             ,
+                                            unsigned long         now               ) ;
+    void                    commandHeard(   uint8_t               link            ,
+                                            unsigned long         now               ) ;
+    void                    update(         unsigned long         now               ) ;   // Close any heartbeat periods that are over.
+
+    int16_t                 score(          uint8_t               link            ,           // 0 to 255, or LINK_SCORE_UNKNOWN
+                                            unsigned long         now               ) ;
+    int8_t                  rssi(           uint8_t               link              ) ;   // the average, or LINK_NO_RSSI
+    uint8_t                 commandRate(    uint8_t               link              ) { return _commandRate[link] >> 8  ; } // (0 to 255)
+
+    int8_t                  choosePrimary(  uint8_t               primary         ,           // The link to switch to now, or -1 to stay
+                                            unsigned long         now               ) ;       //    on the primary one.
+    void                    primaryChanged( unsigned long         now               ) ;   // (Starts the dwell over.)
+
+    const ALTAIR_LinkQualityStats* stats(                                              ) { return &_stats                       ; }
+#ifdef    ARDUINO
+    void                    printStats(     const char* const*    linkNames         ) ;
+#endif
+
+  private:
+
+    int8_t                 _rssiFloor[LINK_QUALITY_MAX_LINKS]                          ;
+    int8_t                 _rssiGood[LINK_QUALITY_MAX_LINKS]                           ;
+    bool                   _listening[LINK_QUALITY_MAX_LINKS]                          ;
+    int16_t                _rssiAverage[LINK_QUALITY_MAX_LINKS]                        ;  // in sixteenths of a dBm
+    bool                   _haveRSSI[LINK_QUALITY_MAX_LINKS]                           ;
+    unsigned long          _rssiMillis[LINK_QUALITY_MAX_LINKS]                         ;  // of the last sample
+    uint16_t               _commandRate[LINK_QUALITY_MAX_LINKS]                        ;  // in 1/65536ths
+    bool                   _heardThisPeriod[LINK_QUALITY_MAX_LINKS]                    ;
+    bool                   _periodStarted                                              ;
+    unsigned long          _periodStartMillis                                          ;
+
+    bool                   _switched                                                   ;  // (since which the dwell runs)
+    bool                   _failing                                                    ;
+    unsigned long          _failingSinceMillis                                         ;
+    int8_t                 _returnTo                                                   ;  // (-1 if none)
+    unsigned long          _returnSinceMillis                                          ;
+    ALTAIR_LinkQualityStats _stats                                                     ;
+};
+#endif    //   ifndef ALTAIR_LinkQuality_h
@@ -0,0 +1,163 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_LinkRateController.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the rate controller of a single telemetry radio
+    link (see ALTAIR_LinkRateController.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_LinkRateController.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.  (The link does nothing useful until configured.)
+*/
+/**************************************************************************/
+ALTAIR_LinkRateController::ALTAIR_LinkRateController(            ) :
+               _content(                LINK_CONTENT_FULL   ) ,
+               _credit(                                 0   ) ,
+               _lastRefillMillis(                       0   ) ,
+               _lastSendMillis(                         0   ) ,
+               _lastIntervalMillis(                     0   ) ,
+               _haveSent(                           false   ) ,
+               _windowStartMillis(                      0   ) ,
+               _windowFrames(                           0   ) ,
+               _windowBytes(                            0   )
+{
+    memset(&_config,       0, sizeof(_config));
+    memset(&_stats,        0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Set the link's throughput, overhead, target load and minimum
+         interval, and choose its content: full, if both frames (as
+         keyframes, i.e. fullSendBytes, plus their overhead) fit within
+         the target load at the nominal interval, and reduced otherwise.
+*/
+/**************************************************************************/
+void ALTAIR_LinkRateController::configure( const ALTAIR_LinkConfig& config , uint16_t fullSendBytes )
+{
+    _config             = config;
+    uint32_t budget     = (uint32_t) _config.bytesPerSecond * _config.loadPercent / 100;              // in bytes per second
+    uint32_t fullCost   = ((uint32_t) fullSendBytes + 2 * _config.frameOverhead) * 1000 / LINK_NOMINAL_INTERVAL;
+    _content            = (fullCost <= budget) ? LINK_CONTENT_FULL : LINK_CONTENT_REDUCED;
+    _credit             = 0;
+    _haveSent           = false;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Pay back the credit, at the target load's rate, up to zero.
+*/
+/**************************************************************************/
+void ALTAIR_LinkRateController::refill( unsigned long now )
+{
+    uint32_t      rate    = (uint32_t) _config.bytesPerSecond * _config.loadPercent / 100;           // in thousandths of a byte per millisecond
+    unsigned long elapsed = now - _lastRefillMillis;
+    _lastRefillMillis     = now;
+    if (_credit >= 0) return;
+    if (rate == 0) return;
+    if (elapsed >= (uint32_t) (-_credit) / rate + 1) _credit  = 0;
+    else                                             _credit += (int32_t) (elapsed * rate);
+    if (_credit > 0) _credit = 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  How long until the next send is due: when the credit is back to
+         zero, and the minimum interval since the last send has passed.
+         If one is due now, but the radio is busy, then it is
+         LINK_BUSY_RETRY_MILLIS.
+*/
+/**************************************************************************/
+unsigned long ALTAIR_LinkRateController::millisUntilDue( unsigned long now , bool busy )
+{
+    refill(now);
+    unsigned long wait  = 0;
+    unsigned long since = now - _lastSendMillis;
+    if (_haveSent && since < _config.minIntervalMillis) wait = _config.minIntervalMillis - since;
+    uint32_t      rate  = (uint32_t) _config.bytesPerSecond * _config.loadPercent / 100;
+    if (_credit < 0 && rate > 0) {
+        unsigned long creditWait = ((uint32_t) (-_credit) + rate - 1) / rate;
+        if (creditWait > wait) wait = creditWait;
+    }
+    if (wait == 0 && busy) {
+        ++_stats.busyDeferrals;
+        return LINK_BUSY_RETRY_MILLIS;
+    }
+    return wait;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Account for a send (of bytes in all, in frames), i.e. debit its
+         bytes and overhead, and update the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_LinkRateController::sent( unsigned long now , uint16_t bytes , uint8_t frames )
+{
+    refill(now);
+    uint32_t onAir = (uint32_t) bytes + (uint32_t) frames * _config.frameOverhead;
+    _credit       -= (int32_t) (onAir * 1000);
+
+    if (_haveSent) _lastIntervalMillis = now - _lastSendMillis;
+    else           _windowStartMillis  = now;
+    _lastSendMillis  = now;
+    _haveSent        = true;
+
+    unsigned long window = now - _windowStartMillis;
+    if (window >= LINK_STATS_WINDOW_MILLIS) {
+        _stats.framesPerSecond = 1000.f * _windowFrames / window;
+        _stats.utilization     = (_config.bytesPerSecond > 0) ? 1000.f * _windowBytes / window / _config.bytesPerSecond : 0.f;
+        _windowStartMillis     = now;
+        _windowFrames          = 0;
+        _windowBytes           = 0;
+    }
+    _windowFrames   += frames;
+    _windowBytes    += onAir;
+
+    ++_stats.sends;
+    _stats.frames   += frames;
+    _stats.bytes    += onAir;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_LinkRateController::resetStats(                        )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the link's rate statistics.
+*/
+/**************************************************************************/
+void ALTAIR_LinkRateController::printStats( const char* radioName )
+{
+    Serial.print(F("Link rate statistics for the ")); Serial.print(radioName);
+    Serial.println((_content == LINK_CONTENT_FULL) ? F(" (full content):") : F(" (reduced content):"));
+    Serial.print(F("   sends/frames/bytes: "));      Serial.print(_stats.sends);  Serial.print(F("/"));
+    Serial.print(_stats.frames);                     Serial.print(F("/"));        Serial.println(_stats.bytes);
+    Serial.print(F("   busy deferrals: "));          Serial.println(_stats.busyDeferrals);
+    Serial.print(F("   last interval (ms): "));      Serial.println(_lastIntervalMillis);
+    Serial.print(F("   frames per second: "));       Serial.println(_stats.framesPerSecond);
+    Serial.print(F("   utilization (%): "));         Serial.print(100.f * _stats.utilization);
+    Serial.print(F(" (target "));                    Serial.print(_config.loadPercent); Serial.println(F(")"));
+}
+#endif
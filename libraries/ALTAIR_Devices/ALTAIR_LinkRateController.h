@@ -0,0 +1,112 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_LinkRateController.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the rate controller of a single telemetry radio
+    link.  Each radio gets one (see ALTAIR_TelemetrySystem), configured
+    with its link's throughput, the bytes of overhead that each frame
+    costs on the air, and the share of the link (the target load) that
+    telemetry may take up.  The controller then works as a token bucket:
+    each send is debited its bytes (plus overhead), the credit is paid
+    back at the target load's rate, and the next send is due once the
+    credit is back to zero (and at least the link's minimum interval has
+    passed, and the radio is not busy).  So the rate follows the bytes
+    that are actually sent: a radio sending short delta frames sends
+    more often than one sending keyframes, and the DNT900 sends at its
+    minimum interval, whereas the SHX144 is held to what 1200 baud can
+    carry.
+
+    If the link cannot carry a full send (both frames, as keyframes) at
+    the nominal interval, the controller's content is reduced, i.e. just
+    one of the two frames is sent each time, alternately (which is what
+    the RFM23BP has always done).
+
+    The achieved frames per second and utilization (of the link's whole
+    throughput, including the overhead) are worked out over windows of
+    LINK_STATS_WINDOW_MILLIS.
+
+    This file does not depend upon the Arduino libraries, so that the
+    controller can also be run on a host computer (see
+    tools/ALTAIRLinkRateSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_LinkRateController_h
+#define   ALTAIR_LinkRateController_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   LINK_CONTENT_FULL              0          // every frame, each send
+#define   LINK_CONTENT_REDUCED           1          // one frame per send, alternately
+#define   LINK_BUSY_RETRY_MILLIS        50          // how soon to try again if the radio is busy
+#define   LINK_NOMINAL_INTERVAL       1000          // in milliseconds: the least that a full-content link must manage
+#define   LINK_STATS_WINDOW_MILLIS   10000
+
+struct    ALTAIR_LinkConfig {
+    uint16_t            bytesPerSecond                                      ;  // the link's throughput
+    uint8_t             frameOverhead                                       ;  // bytes on the air per frame, beyond the frame itself
+    uint8_t             loadPercent                                         ;  // the share of the link that telemetry may use
+    uint16_t            minIntervalMillis                                   ;  // between sends
+};
+
+struct    ALTAIR_LinkStats {
+    unsigned long       sends                                               ;
+    unsigned long       frames                                              ;
+    unsigned long       bytes                                               ;  // (including the overhead)
+    unsigned long       busyDeferrals                                       ;  // # of times a send was due, but the radio was busy
+    float               framesPerSecond                                     ;  // over the last whole window
+    float               utilization                                         ;  // (as a fraction of bytesPerSecond)
+};
+
+class     ALTAIR_LinkRateController {
+  public:
+
+    ALTAIR_LinkRateController(                                                         ) ;
+
+    void                    configure(      const ALTAIR_LinkConfig&  config          ,
+                                            uint16_t                  fullSendBytes     ) ;   // the bytes of a full send, of keyframes
+    unsigned long           millisUntilDue( unsigned long             now             ,       // 0 if a send is due now.
+                                            bool                      busy              ) ;
+    void                    sent(           unsigned long             now             ,       // Account for a send of bytes, in frames.
+                                            uint16_t                  bytes           ,
+                                            uint8_t                   frames            ) ;
+
+    uint8_t                 content(                                                   ) { return _content                      ; }
+    const ALTAIR_LinkConfig* config(                                                   ) { return &_config                      ; }
+    const ALTAIR_LinkStats* stats(                                                     ) { return &_stats                       ; }
+    unsigned long           lastIntervalMillis(                                        ) { return _lastIntervalMillis           ; }
+    void                    resetStats(                                                ) ;
+#ifdef    ARDUINO
+    void                    printStats(     const char*               radioName         ) ;
+#endif
+
+  private:
+
+    void                    refill(         unsigned long             now               ) ;
+
+    ALTAIR_LinkConfig      _config                                                    ;
+    uint8_t                _content                                                   ;
+    int32_t                _credit                                                    ;  // in thousandths of a byte (never above 0)
+    unsigned long          _lastRefillMillis                                          ;
+    unsigned long          _lastSendMillis                                            ;
+    unsigned long          _lastIntervalMillis                                        ;
+    bool                   _haveSent                                                  ;
+    unsigned long          _windowStartMillis                                         ;
+    unsigned long          _windowFrames                                              ;
+    unsigned long          _windowBytes                                               ;
+    ALTAIR_LinkStats       _stats                                                     ;
+};
+#endif    //   ifndef ALTAIR_LinkRateController_h
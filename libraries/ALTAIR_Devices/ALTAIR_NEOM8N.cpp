@@ -15,51 +15,108 @@
 */
 /**************************************************************************/
 
+#include <string.h>
 #include "ALTAIR_NEOM8N.h"
-#include <Wire.h>
+#include "ALTAIR_GPSMonitor.h"
 
 /**************************************************************************/
 /*!
- @brief  Get the GPS, and place the data in the _gps TinyGPSPlus data
-         member.  Return true if successful.
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_NEOM8N::ALTAIR_NEOM8N(                                  ) :
+    _code(                              NEOM8N_INITCODE      ) ,
+    _bytesLeft(                                            0 ) ,
+    _fetching(                                         false ) ,
+    _encoded(                                          false )
+{
+    memset(&_request, 0, sizeof(_request));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Start a fetch of the GPS data (unless one is still going), which
+         is encoded into the _gps TinyGPSPlus data member as it arrives.
+         Return true if the fetches that have finished since the last call
+         encoded a sentence.
 */
 /**************************************************************************/
 bool      ALTAIR_NEOM8N::getGPS(              )
 {
-    bool retval = false;
+    bool retval = _encoded;
+    _encoded    = false;
+    if (!_fetching) _fetching = startRead( NEOM8N_INITCODE , NEOM8N_INITBYTES );
+    return retval;
+}
 
-    Wire.beginTransmission( NEOM8N_I2CADDRESS );
-    Wire.write(             NEOM8N_INITCODE   );
-    Wire.endTransmission(                     );
-    uint8_t i2cErr = Wire.requestFrom( NEOM8N_I2CADDRESS , NEOM8N_INITBYTES );
-    if (i2cErr == 0) return false; // got some TWI error. Return
+/**************************************************************************/
+/*!
+ @brief  Queue a request that writes the code, and then reads numBytes
+         (after a repeated start).  False if the queue is full.
+*/
+/**************************************************************************/
+bool      ALTAIR_NEOM8N::startRead( uint8_t  code ,  uint8_t  numBytes  )
+{
+    _code               = code;
+    _request.address    = NEOM8N_I2CADDRESS;
+    _request.writeBytes = &_code;
+    _request.numWrite   = 1;
+    _request.readBytes  = _buffer;
+    _request.numRead    = numBytes;
+    _request.callback   = readDone;
+    _request.context    = this;
+    return ALTAIR_HAL::i2cSubmit(&_request);
+}
 
-    uint16_t totalBytes = Wire.read() << 8;
-    totalBytes         |= Wire.read();
-    if (!totalBytes) return false; // GPS not ready to send data. Return
-    Serial.print(F("GPS is ready to transfer ")); Serial.print(totalBytes, DEC); Serial.println(F(" bytes"));
+/**************************************************************************/
+/*!
+ @brief  A read has finished (called from ALTAIR_HAL::i2cService()): take
+         the # of bytes waiting, or encode the bytes read, and then queue
+         the next read, until there are none left.
+*/
+/**************************************************************************/
+void      ALTAIR_NEOM8N::readDone( ALTAIR_HALI2CRequest*  request  )
+{
+    ALTAIR_NEOM8N* gps = (ALTAIR_NEOM8N*) request->context;
+    gps->_fetching     = false;
+    if (request->status != HAL_I2C_DONE || request->numReceived != request->numRead) return;   // got some TWI error. Return
 
-    while (totalBytes) {
-        uint8_t bytes2Read = totalBytes;
-        if (totalBytes > NEOM8N_MAXBUFFERSIZE) bytes2Read = NEOM8N_MAXBUFFERSIZE;
-//         Serial.print(bytes2Read);Serial.print("here5.5");
-        Wire.beginTransmission(    NEOM8N_I2CADDRESS );
-        Wire.write(                NEOM8N_GETGPSCODE );
-        Wire.endTransmission(                        );
-        i2cErr = Wire.requestFrom( (uint8_t) NEOM8N_I2CADDRESS , bytes2Read);
-        if (i2cErr == 0) return false; // got some TWI error. Return
-//         Serial.print("here6 ");
-        for (uint8_t i = 0; i < bytes2Read; i++) {
-            uint8_t theByte = Wire.read();
-            if (theByte == NEOM8N_ERRORBYTE) return false; // got some TWI error. Return
-//             retval = _gps.encode(theByte);
-//             Serial.write(char(theByte));
-            bool isEncoded = _gps.encode(theByte);
-            retval |= isEncoded;
+    if (gps->_code == NEOM8N_INITCODE) {
+        gps->_bytesLeft = ((uint16_t) gps->_buffer[0] << 8) | gps->_buffer[1];
+        if (!gps->_bytesLeft) return;                                                          // GPS not ready to send data. Return
+        Serial.print(F("GPS is ready to transfer ")); Serial.print(gps->_bytesLeft, DEC); Serial.println(F(" bytes"));
+    } else {
+        for (uint8_t i = 0; i < request->numReceived; i++) {
+            uint8_t theByte = gps->_buffer[i];
+            if (theByte == NEOM8N_ERRORBYTE) return;                                           // got some TWI error. Return
+            gps->_encoded |= gps->_gps.encode(theByte);
         }
-        totalBytes -= bytes2Read;
-//         delay(50);                    // this delay appears to fix mysterious occasional freezes in this while loop
+        gps->_bytesLeft -= request->numReceived;
+        if (!gps->_bytesLeft) return;
     }
 
-    return retval;
+    uint8_t bytes2Read = (gps->_bytesLeft > NEOM8N_MAXBUFFERSIZE) ? NEOM8N_MAXBUFFERSIZE : gps->_bytesLeft;
+    gps->_fetching     = gps->startRead( NEOM8N_GETGPSCODE , bytes2Read );
+}
+
+/**************************************************************************/
+/*!
+ @brief  Healthy if there is a fix that is not stale.
+*/
+/**************************************************************************/
+uint8_t   ALTAIR_NEOM8N::typeAndHealth(       )
+{
+    return (_gps.location.isValid() && _gps.location.age() <= GPS_STALE_MILLIS) ? (uint8_t) neom8n_healthy : (uint8_t) neom8n_unhealthy;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The UTC time of the fix, in seconds since 0000 UT (0 if there has
+         not been one).
+*/
+/**************************************************************************/
+double    ALTAIR_NEOM8N::time(                )
+{
+    if (!_gps.time.isValid()) return 0.0;
+    return _gps.time.hour() * 3600. + _gps.time.minute() * 60. + _gps.time.second() + _gps.time.centisecond() / 100.;
 }
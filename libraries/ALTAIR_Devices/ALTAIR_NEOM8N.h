@@ -7,6 +7,13 @@
     This is the class for the ALTAIR NEO-M8N GPS receiver, located on the
     mast.
 
+    It is read over I2C via the HAL's queue of requests (see ALTAIR_HAL.h),
+    so that the main loop does not wait on the bus: each getGPS() call
+    starts a fetch (first the # of bytes waiting, and then up to 32 bytes
+    at a time of them, each read's callback queueing the next), unless the
+    last one is still going, and returns whether the fetches that have
+    finished since the last call encoded a sentence.
+
     Justin Albert  jalbert@uvic.ca     began on 6 Sep. 2018
 
     @section  HISTORY
@@ -20,6 +27,7 @@
 
 #include "Arduino.h"
 #include "ALTAIR_GPSSensor.h"
+#include <ALTAIR_HAL.h>
 #include <TinyGPS++.h>
 
 #define   NEOM8N_I2CADDRESS         0x42
@@ -32,11 +40,11 @@
 class ALTAIR_NEOM8N : public ALTAIR_GPSSensor {
   public:
 
-    ALTAIR_NEOM8N(                    )    {                                          }
+    ALTAIR_NEOM8N(                    )                                             ;
 
     virtual void      initialize(     )    {                                          }
     virtual bool      getGPS(         )                                             ;
-    virtual uint8_t   typeAndHealth(  )    { return ((uint8_t) neom8n_healthy      ); }
+    virtual uint8_t   typeAndHealth(  )                                             ;  // Unhealthy if it has no fix, or the last one is stale.
 
     virtual double    lat(            )    { return           _gps.location.lat(   ); }
     virtual double    lon(            )    { return           _gps.location.lng(   ); }
@@ -49,11 +57,21 @@ class ALTAIR_NEOM8N : public ALTAIR_GPSSensor {
     virtual uint8_t   hour(           )    { return           _gps.time.hour(      ); }
     virtual uint8_t   minute(         )    { return           _gps.time.minute(    ); }
     virtual uint8_t   second(         )    { return           _gps.time.second(    ); }
-    virtual double    time(           )    { return           0.0                   ; }
+    virtual double    time(           )                                             ;  // In seconds since 0000 UT (as the G6's).
+
+            bool      fetching(       )    { return           _fetching             ; }  // (a fetch is queued, or in progress)
 
   private:
+            bool      startRead(      uint8_t  code ,  uint8_t  numBytes  )         ;
+    static  void      readDone(       ALTAIR_HALI2CRequest*     request   )         ;
 
-    TinyGPSPlus      _gps;
+    TinyGPSPlus           _gps                                  ;
+    ALTAIR_HALI2CRequest  _request                              ;
+    uint8_t               _code                                 ;  // (written by _request: NEOM8N_INITCODE or NEOM8N_GETGPSCODE)
+    uint8_t               _buffer[      NEOM8N_MAXBUFFERSIZE ]  ;
+    uint16_t              _bytesLeft                            ;  // (of the fetch in progress)
+    bool                  _fetching                             ;
+    bool                  _encoded                              ;  // (since the last getGPS() call)
 
 };
 #endif    //   ifndef ALTAIR_NEOM8N_h
@@ -0,0 +1,169 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_OrientFusion.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR orientation fusion engine (see
+    ALTAIR_OrientFusion.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include "ALTAIR_OrientFusion.h"
+
+// Each type of sensor's uncertainty (1 sigma, in degrees) in yaw, pitch and roll, by orientsensor_t (0 => it does not measure it).
+static const float sensorSigma[ORIENT_FUSION_NUM_TYPES][ORIENT_FUSION_NUM_AXES] = {
+    { 2.5 , 1.0 , 1.0 },          // BNO055  (its own fusion of accel/gyro/mag)
+    { 3.0 , 2.0 , 2.0 },          // UM7     (likewise, but inside the swinging payload)
+    { 2.0 , 1.0 , 1.0 },          // HMC6343 (tilt-compensated heading)
+    { 5.0 , 0.  , 0.  },          // HMC5883L (the heading, from the raw mag, with no tilt compensation)
+};
+
+/**************************************************************************/
+/*!
+ @brief  Wrap an angle (or a difference of angles) into [-180, 180).
+*/
+/**************************************************************************/
+static float wrap180( float angle )
+{
+    while (angle >=  180.) angle -= 360.;
+    while (angle <  -180.) angle += 360.;
+    return angle;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_OrientFusion::ALTAIR_OrientFusion(                         )
+{
+    reset();
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Forget the estimate (the next update starts it afresh).
+*/
+/**************************************************************************/
+void ALTAIR_OrientFusion::reset(                                  )
+{
+    for (uint8_t axis = 0; axis < ORIENT_FUSION_NUM_AXES; ++axis) {
+        _angle[axis]    = 0.;
+        _variance[axis] = ORIENT_FUSION_MAX_SIGMA * ORIENT_FUSION_MAX_SIGMA;
+        _valid[axis]    = false;
+    }
+    _started     = false;
+    _lastMillis  = 0;
+    _sensorsUsed = 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  One update: let the uncertainty grow with the time since the
+         last one, and then fold in each healthy sensor's readings.
+*/
+/**************************************************************************/
+void ALTAIR_OrientFusion::update( const ALTAIR_OrientReading* readings    ,
+                                  uint8_t                     numReadings ,
+                                  unsigned long               nowMillis   )
+{
+    float seconds = _started ? (nowMillis - _lastMillis) / 1000. : 0.;
+    float growth  = ORIENT_FUSION_SLEW_DEG_PER_S * ORIENT_FUSION_SLEW_DEG_PER_S * seconds;
+    for (uint8_t axis = 0; axis < ORIENT_FUSION_NUM_AXES; ++axis) {
+        _variance[axis] += growth;
+        if (_variance[axis] > ORIENT_FUSION_MAX_SIGMA * ORIENT_FUSION_MAX_SIGMA) _variance[axis] = ORIENT_FUSION_MAX_SIGMA * ORIENT_FUSION_MAX_SIGMA;
+    }
+    _started     = true;
+    _lastMillis  = nowMillis;
+    _sensorsUsed = 0;
+
+    for (uint8_t i = 0; i < numReadings; ++i) {
+        const ALTAIR_OrientReading& reading = readings[i];
+        ++_stats.readings;
+        if (reading.typeAndHealth >= ORIENT_FUSION_NUM_TYPES) {
+            ++_stats.unhealthy;
+            continue;
+        }
+        const float* sigma    = sensorSigma[reading.typeAndHealth];
+        int16_t      value[]  = { reading.yaw, reading.pitch, reading.roll };
+        bool         used     = false;
+        for (uint8_t axis = 0; axis < ORIENT_FUSION_NUM_AXES; ++axis) {
+            if (!(reading.axes & (1 << axis)) || sigma[axis] == 0.) continue;
+            if (fold(axis, value[axis] / ORIENT_FUSION_UNITS_PER_DEGREE, sigma[axis] * sigma[axis])) used = true;
+            else                                                                                      ++_stats.rejected;
+        }
+        if (used) ++_sensorsUsed;
+    }
+    ++_stats.updates;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Fold one measurement of one angle into its estimate (the first
+         one just starts it).
+*/
+/**************************************************************************/
+bool ALTAIR_OrientFusion::fold( uint8_t axis , float measured , float variance )
+{
+    if (axis != ORIENT_FUSION_PITCH) measured = wrap180(measured);
+    if (!_valid[axis]) {
+        _angle[axis]    = measured;
+        _variance[axis] = variance;
+        _valid[axis]    = true;
+    } else {
+        float innovation = (axis == ORIENT_FUSION_PITCH) ? measured - _angle[axis] : wrap180(measured - _angle[axis]);
+        float total      = _variance[axis] + variance;
+        if (innovation * innovation > ORIENT_FUSION_GATE_SIGMAS * ORIENT_FUSION_GATE_SIGMAS * total) return false;
+        float gain       = _variance[axis] / total;
+        _angle[axis]    += gain * innovation;
+        _variance[axis] *= 1. - gain;
+    }
+    if (axis == ORIENT_FUSION_YAW) {
+        _angle[axis] = wrap180(_angle[axis]);
+        if (_angle[axis] < 0.) _angle[axis] += 360.;                 // (0 to 360, as the sensors give it)
+    } else if (axis == ORIENT_FUSION_ROLL) {
+        _angle[axis] = wrap180(_angle[axis]);
+    }
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The uncertainty (1 sigma) of an angle's estimate, in degrees.
+*/
+/**************************************************************************/
+float ALTAIR_OrientFusion::sigma( uint8_t axis )
+{
+    return sqrt(_variance[axis]);
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the estimate, and the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_OrientFusion::printStats(                             )
+{
+    const char* names[] = { "yaw", "pitch", "roll" };
+    Serial.println(F("Orientation fusion:"));
+    for (uint8_t axis = 0; axis < ORIENT_FUSION_NUM_AXES; ++axis) {
+        Serial.print(F("   "));  Serial.print(names[axis]);  Serial.print(F(" (deg): "));
+        if (!_valid[axis]) { Serial.println(F("none yet")); continue; }
+        Serial.print(_angle[axis], 1);  Serial.print(F(" +/- "));  Serial.println(sigma(axis), 1);
+    }
+    Serial.print(F("   sensors used: "));                            Serial.println(_sensorsUsed);
+    Serial.print(F("   updates / readings / unhealthy / rejected: ")); Serial.print(_stats.updates); Serial.print(F(" / "));
+    Serial.print(_stats.readings);  Serial.print(F(" / "));  Serial.print(_stats.unhealthy);  Serial.print(F(" / "));  Serial.println(_stats.rejected);
+}
+#endif
@@ -0,0 +1,123 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_OrientFusion.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR orientation fusion engine, which
+    combines the yaw, pitch and roll of all of the orientation sensors
+    that are healthy (the BNO055, UM7 and HMC6343, and the HMC5883L's
+    heading) into one estimate of each, with its uncertainty.
+
+    Each angle has its own (one-dimensional) Kalman filter, run at a fixed
+    rate (see ALTAIR_OrientSensors::fuse): at each update, the estimate's
+    variance first grows by how far the payload could have turned since
+    the last one (ORIENT_FUSION_SLEW_DEG_PER_S), and then each sensor's
+    reading of the angle is folded in, weighted by the inverse of its
+    variance, which is set by its type (from typeAndHealth(), see the table
+    in ALTAIR_OrientFusion.cpp).  A sensor that reports itself unhealthy
+    is not used at all; nor is a reading that is more than
+    ORIENT_FUSION_GATE_SIGMAS from the estimate (e.g. a sensor that has
+    locked up, without knowing it), unless nothing has been used for so
+    long that the estimate's own uncertainty has grown to take it in.
+
+    The angles are in degrees: the yaw from 0 to 360, the pitch from -90
+    to 90, and the roll from -180 to 180.  The readings, and yaw(), etc,
+    are in the units of ALTAIR_OrientSensor (2^15/360 per degree).
+
+    This file does not depend upon the Arduino libraries, so that the
+    engine can also be run on a host computer (see
+    tools/ALTAIROrientFusionBench.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_OrientFusion_h
+#define   ALTAIR_OrientFusion_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+#endif
+
+#define   ORIENT_FUSION_YAW                   0          // the axes
+#define   ORIENT_FUSION_PITCH                 1
+#define   ORIENT_FUSION_ROLL                  2
+#define   ORIENT_FUSION_NUM_AXES              3
+#define   ORIENT_AXIS_YAW                  0x01          // as a mask, for the axes that a reading has
+#define   ORIENT_AXIS_PITCH                0x02
+#define   ORIENT_AXIS_ROLL                 0x04
+#define   ORIENT_AXIS_ALL                  0x07
+
+#define   ORIENT_FUSION_NUM_TYPES             4          // the healthy values of orientsensor_t (each unhealthy one is 4 more)
+#define   ORIENT_FUSION_UNITS_PER_DEGREE   91.02222      // as SHRTMAX_DIVBY_360, in ALTAIR_OrientSensor.h
+#define   ORIENT_FUSION_SLEW_DEG_PER_S     15.0          // (the process noise: a random walk, of this many degrees in a second)
+#define   ORIENT_FUSION_GATE_SIGMAS         4.0
+#define   ORIENT_FUSION_MAX_SIGMA         180.0          // (the uncertainty never grows beyond this)
+
+/**************************************************************************/
+/*!
+    One orientation sensor's readings, for an update.
+*/
+/**************************************************************************/
+struct    ALTAIR_OrientReading {
+    int16_t             yaw                                                 ;  // as from ALTAIR_OrientSensor::yaw(), etc
+    int16_t             pitch                                               ;
+    int16_t             roll                                                ;
+    uint8_t             typeAndHealth                                       ;  // as from ALTAIR_OrientSensor::typeAndHealth()
+    uint8_t             axes                                                ;  // the ones that it measures (ORIENT_AXIS_YAW, etc)
+};
+
+struct    ALTAIR_OrientFusionStats {
+    unsigned long       updates                                             ;
+    unsigned long       readings                                            ;
+    unsigned long       unhealthy                                           ;  // readings from a sensor that said it was unhealthy
+    unsigned long       rejected                                            ;  // angles that were too far from the estimate
+};
+
+class     ALTAIR_OrientFusion {
+  public:
+
+    ALTAIR_OrientFusion(                                                    ) ;
+
+    void                reset(                                              ) ;   // Forget the estimate.
+    void                update(         const ALTAIR_OrientReading* readings ,
+                                        uint8_t               numReadings ,
+                                        unsigned long         nowMillis     ) ;
+
+    bool                valid(          uint8_t               axis          ) { return _valid[axis]                ; }   // (once any sensor has measured it)
+    float               degrees(        uint8_t               axis          ) { return _angle[axis]                ; }
+    float               sigma(          uint8_t               axis          ) ;   // the uncertainty (1 sigma), in degrees
+    int16_t             yaw(                                                ) { return toUnits(ORIENT_FUSION_YAW)  ; }
+    int16_t             pitch(                                              ) { return toUnits(ORIENT_FUSION_PITCH); }
+    int16_t             roll(                                               ) { return toUnits(ORIENT_FUSION_ROLL) ; }
+    uint8_t             sensorsUsed(                                        ) { return _sensorsUsed                ; }   // by the last update
+    unsigned long       lastUpdateMillis(                                   ) { return _lastMillis                 ; }
+
+    const ALTAIR_OrientFusionStats* stats(                                  ) { return &_stats                     ; }
+#ifdef    ARDUINO
+    void                printStats(                                         ) ;
+#endif
+
+  private:
+    bool                fold(           uint8_t               axis        ,       // False if it was rejected.
+                                        float                 measured    ,
+                                        float                 variance      ) ;
+    int16_t             toUnits(        uint8_t               axis          ) { return (int16_t) (_angle[axis] * ORIENT_FUSION_UNITS_PER_DEGREE); }
+
+    float               _angle[         ORIENT_FUSION_NUM_AXES              ] ;
+    float               _variance[      ORIENT_FUSION_NUM_AXES              ] ;  // in degrees squared
+    bool                _valid[         ORIENT_FUSION_NUM_AXES              ] ;
+    bool                _started                                              ;
+    unsigned long       _lastMillis                                           ;
+    uint8_t             _sensorsUsed                                          ;
+    ALTAIR_OrientFusionStats _stats                                           ;
+};
+
+#endif    //   ifndef ALTAIR_OrientFusion_h
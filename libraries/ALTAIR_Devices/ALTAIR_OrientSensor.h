@@ -21,8 +21,14 @@
 #ifndef  ALTAIR_OrientSensor_h
 #define  ALTAIR_OrientSensor_h
 
+#ifdef   ARDUINO
 #include "Arduino.h"
 #include <Adafruit_Sensor.h>
+#else
+#include <stdint.h>
+typedef  uint8_t   byte;
+#define  SENSORS_GRAVITY_EARTH      (9.80665F)               // as in Adafruit_Sensor.h (for the UM7, when built on a host computer)
+#endif
 
 #define  SHRTMAX_DIVBY_360          91.02222                 // = 2^15 / 360.
 
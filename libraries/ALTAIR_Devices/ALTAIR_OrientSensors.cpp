@@ -47,6 +47,45 @@ void ALTAIR_OrientSensors::initialize(            )
      _hmc6343.initialize(                         )     ;
 }
 
+/**************************************************************************/
+/*!
+ @brief  Read all four of the orientation sensors, and fold the healthy
+         ones' readings into the fused estimate.  (The HMC5883L gives
+         just its heading, as the yaw.)
+*/
+/**************************************************************************/
+void ALTAIR_OrientSensors::fuse(  unsigned long nowMillis  )
+{
+    ALTAIR_OrientSensor*  sensors[]  = { &_bno055, &_um7, &_hmc6343 };
+    ALTAIR_OrientReading  readings[4];
+    for (uint8_t i = 0; i < 3; ++i) {
+        sensors[i]->update();
+        readings[i].yaw           = sensors[i]->yaw();
+        readings[i].pitch         = sensors[i]->pitch();
+        readings[i].roll          = sensors[i]->roll();
+        readings[i].typeAndHealth = sensors[i]->typeAndHealth();
+        readings[i].axes          = ORIENT_AXIS_ALL;
+    }
+    float heading = _hmc5883l.getHeading();                           // (-180 to 180)
+    if (heading < 0.) heading += 360.;
+    readings[3].yaw           = _hmc5883l.convertFloatToInt16(heading);
+    readings[3].pitch         = 0;
+    readings[3].roll          = 0;
+    readings[3].typeAndHealth = _hmc5883l.typeAndHealth();
+    readings[3].axes          = ORIENT_AXIS_YAW;
+    _fusion.update(readings, 4, nowMillis);
+}
+
+/**************************************************************************/
+/*!
+ @brief  The fused yaw, pitch and roll (or the primary sensor's, until
+         any sensor has measured them).
+*/
+/**************************************************************************/
+int16_t ALTAIR_OrientSensors::yaw(                 ) { return _fusion.valid(ORIENT_FUSION_YAW)   ? _fusion.yaw()   : _primary->yaw()   ; }
+int16_t ALTAIR_OrientSensors::pitch(               ) { return _fusion.valid(ORIENT_FUSION_PITCH) ? _fusion.pitch() : _primary->pitch() ; }
+int16_t ALTAIR_OrientSensors::roll(                ) { return _fusion.valid(ORIENT_FUSION_ROLL)  ? _fusion.roll()  : _primary->roll()  ; }
+
 /**************************************************************************/
 /*!
  @brief  Switch to backup orientation sensor #1.
@@ -10,6 +10,15 @@
     the Sparkfun HMC6343 (accel/mag), located on the mast; and 4) the
     compass HMC5883L magnetometer (just mag), located inside the mast.
 
+    fuse() (called by the task scheduler, at a fixed rate) reads all four,
+    and combines the yaw, pitch and roll of those that are healthy into
+    one estimate of each, with its uncertainty (see ALTAIR_OrientFusion.h).
+    yaw(), pitch() and roll() give that estimate, or else (until a sensor
+    has measured it) the primary sensor's reading.  The primary and backup
+    sensors (as switched by the 'O' and 'o' commands) still give the
+    accelerations, the temperature, and the type and health that go down
+    in the telemetry.
+
     Justin Albert  jalbert@uvic.ca     began on 6 Sep. 2018
 
     @section  HISTORY
@@ -26,6 +35,7 @@
 #include "ALTAIR_UM7.h"
 #include "ALTAIR_HMC6343.h"
 #include "ALTAIR_HMC5883L.h"
+#include "ALTAIR_OrientFusion.h"
 
 class ALTAIR_OrientSensors {
   public:
@@ -41,7 +51,13 @@ class ALTAIR_OrientSensors {
     ALTAIR_OrientSensor*    backup1(         ) { return  _backup1  ; }
     ALTAIR_OrientSensor*    backup2(         ) { return  _backup2  ; }
 
+    ALTAIR_OrientFusion*    fusion(          ) { return &_fusion   ; }
+    int16_t                 yaw(             )                     ;   // the fused estimate (in the units of ALTAIR_OrientSensor), or
+    int16_t                 pitch(           )                     ;   //    else the primary sensor's
+    int16_t                 roll(            )                     ;
+
     void                    initialize(      )                     ;
+    void                    fuse(  unsigned long nowMillis )       ;   // Read all of the sensors, and update the fused estimate.
     void                    switchToBackup1( )                     ;
     void                    switchToBackup2( )                     ;
 
@@ -50,6 +66,7 @@ class ALTAIR_OrientSensors {
     ALTAIR_UM7             _um7                                    ;
     ALTAIR_HMC6343         _hmc6343                                ;
     ALTAIR_HMC5883L        _hmc5883l                               ;
+    ALTAIR_OrientFusion    _fusion                                 ;
 
     ALTAIR_OrientSensor*   _primary                                ; 
     ALTAIR_OrientSensor*   _backup1                                ; 
@@ -18,6 +18,7 @@
 /**************************************************************************/
 
 #include "ALTAIR_RFM23BP.h"
+#include "ALTAIR_DownlinkDecoder.h"
 
 /**************************************************************************/
 /*!
@@ -27,7 +28,8 @@
 ALTAIR_RFM23BP::ALTAIR_RFM23BP(byte RFM23_chipselectpin  , byte RFM23_interruptpin  ) :
                    _theRFM23BP(     RFM23_chipselectpin  ,      RFM23_interruptpin  ) ,
           _RFM23_chipselectpin(     RFM23_chipselectpin                             ) ,
-          _lastSentString2(         false                                           )
+          _lastSentString2(         false                                           ) ,
+          _downlinkDecoder(         NULL                                            )
 {
 }
 
@@ -39,7 +41,8 @@ ALTAIR_RFM23BP::ALTAIR_RFM23BP(byte RFM23_chipselectpin  , byte RFM23_interruptp
 ALTAIR_RFM23BP::ALTAIR_RFM23BP(                                                     ) :
                    _theRFM23BP( DEFAULT_RFM_CHIPSELECTPIN, DEFAULT_RFM_INTERRUPTPIN ) ,
           _RFM23_chipselectpin( DEFAULT_RFM_CHIPSELECTPIN                           ) ,
-          _lastSentString2(     false                                               )
+          _lastSentString2(     false                                               ) ,
+          _downlinkDecoder(     NULL                                                )
 {
 }
 
@@ -52,11 +55,11 @@ ALTAIR_RFM23BP::ALTAIR_RFM23BP(
 /**************************************************************************/
 bool ALTAIR_RFM23BP::initialize(const char* aString) {
 
-    pinMode(               _RFM23_chipselectpin ,  OUTPUT       )   ;
+    ALTAIR_HAL::gpioMode(  _RFM23_chipselectpin ,  HAL_OUTPUT   )   ;
     bool   initBool      = _theRFM23BP.init(                    )   ;
-    digitalWrite(          _RFM23_chipselectpin ,  LOW          )   ;   // try adding this
-    byte   received_byte =  SPI.transfer(          RFM_SPI_BYTE )   ;   // try adding this
-    digitalWrite(          _RFM23_chipselectpin ,  HIGH         )   ;   // try adding this
+    ALTAIR_HAL::gpioWrite( _RFM23_chipselectpin ,  HAL_LOW      )   ;   // try adding this
+    byte   received_byte =  ALTAIR_HAL::spiTransfer( RFM_SPI_BYTE )   ;   // try adding this
+    ALTAIR_HAL::gpioWrite( _RFM23_chipselectpin ,  HAL_HIGH     )   ;   // try adding this
     return initBool                                                 ;
 }
 
@@ -90,9 +93,9 @@ bool ALTAIR_RFM23BP::send(const uint8_t* aString) {
     if (stringLen <= _theRFM23BP.maxMessageLength(                 )) {
         _theRFM23BP.send(       aString,               stringLen    )   ;
         _theRFM23BP.waitPacketSent(                                 )   ;
-        digitalWrite(          _RFM23_chipselectpin ,  LOW          )   ;   // try adding this
-        byte   received_byte =  SPI.transfer(          RFM_SPI_BYTE )   ;   // try adding this
-        digitalWrite(          _RFM23_chipselectpin ,  HIGH         )   ;   // try adding this
+        ALTAIR_HAL::gpioWrite( _RFM23_chipselectpin ,  HAL_LOW      )   ;   // try adding this
+        byte   received_byte =  ALTAIR_HAL::spiTransfer( RFM_SPI_BYTE )   ;   // try adding this
+        ALTAIR_HAL::gpioWrite( _RFM23_chipselectpin ,  HAL_HIGH     )   ;   // try adding this
         return true;
     } else {
         return false;
@@ -110,9 +113,9 @@ bool ALTAIR_RFM23BP::send(const uint8_t* anArray, const uint8_t arrayLen) {
     if (arrayLen <= _theRFM23BP.maxMessageLength(                  )) {
         _theRFM23BP.send(       anArray,               arrayLen     )   ;
         _theRFM23BP.waitPacketSent(                                 )   ;
-        digitalWrite(          _RFM23_chipselectpin ,  LOW          )   ;   // try adding this
-        byte   received_byte =  SPI.transfer(          RFM_SPI_BYTE )   ;   // try adding this
-        digitalWrite(          _RFM23_chipselectpin ,  HIGH         )   ;   // try adding this
+        ALTAIR_HAL::gpioWrite( _RFM23_chipselectpin ,  HAL_LOW      )   ;   // try adding this
+        byte   received_byte =  ALTAIR_HAL::spiTransfer( RFM_SPI_BYTE )   ;   // try adding this
+        ALTAIR_HAL::gpioWrite( _RFM23_chipselectpin ,  HAL_HIGH     )   ;   // try adding this
         return true;
     } else {
         return false;
@@ -139,13 +142,58 @@ bool ALTAIR_RFM23BP::sendAsIndivChars(const unsigned char* aString) {
 
 /**************************************************************************/
 /*!
- @brief  If a byte is currently available for reading, returns true.
+ @brief  If a message is currently available for reading, returns true.
          Otherwise, returns false.
 */
 /**************************************************************************/
 bool ALTAIR_RFM23BP::available() {
 
-    return _theRFM23BP.available();
+    serviceRx();
+    return (_rxQueue.depth() > 0);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  If the RH_RF22 interrupt handler has captured a new message, move
+         it into the message queue (which frees the RH_RF22 to receive the
+         next one), truncated to RFM_RX_MAX_MESSAGE_LENGTH.  This never
+         waits.  Returns true if a message was queued.
+*/
+/**************************************************************************/
+bool ALTAIR_RFM23BP::serviceRx() {
+
+    if (!radioAvailable()) return false;
+
+// Straight into the queue's next slot (or, if the queue is full, nowhere: recv() then just frees the RH_RF22)
+    byte*         slot = _rxQueue.back();
+    byte          none;
+    unsigned char length = slot ? RFM_RX_MAX_MESSAGE_LENGTH : 0;
+    if (!radioRecv(slot ? slot : &none, &length)) return false;
+    unsigned long now    = rxMillis();
+    if (!_rxQueue.push(length, now)) return false;
+    noteRSSI(lastRSSI(), now);
+    return true;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the receive queue statistics.
+*/
+/**************************************************************************/
+void ALTAIR_RFM23BP::printRxStats() {
+
+    const ALTAIR_RFM23BPRxStats* stats = _rxQueue.stats();
+
+    Serial.println(F("RFM23BP RX queue statistics:"));
+    Serial.print(F("   messages received / dropped / invalid: ")); Serial.print(stats->messagesReceived);    Serial.print(F(" / "));
+                                                                  Serial.print(stats->messagesDropped);     Serial.print(F(" / "));
+                                                                  Serial.println(stats->messagesInvalid);
+    Serial.print(F("   queue depth now / max: "));                Serial.print(_rxQueue.depth());           Serial.print(F(" / "));
+                                                                  Serial.println(stats->maxQueueDepth);
+    Serial.print(F("   queue latency last / max (ms): "));        Serial.print(stats->lastQueueLatency);    Serial.print(F(" / "));
+                                                                  Serial.println(stats->maxQueueLatency);
 
 }
 
@@ -161,6 +209,42 @@ bool ALTAIR_RFM23BP::isBusy() {
 
 }
 
+/**************************************************************************/
+/*!
+ @brief  If a packet is still being sent, returns true.
+*/
+/**************************************************************************/
+bool ALTAIR_RFM23BP::txBacklogged() {
+
+    return (_theRFM23BP.mode() == RHGenericDriver::RHModeTx);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  The # of bytes that can be sent now without waiting: one
+         packet's worth, unless a packet is still being sent.
+*/
+/**************************************************************************/
+uint16_t ALTAIR_RFM23BP::txRoom() {
+
+    return txBacklogged() ? 0 : _theRFM23BP.maxMessageLength();
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send an array of bytes as one packet, without waiting for it to
+         go out.  (Returns false if send is unsuccessful.)
+*/
+/**************************************************************************/
+bool ALTAIR_RFM23BP::sendNonBlocking(const uint8_t* anArray, const uint8_t arrayLen) {
+
+    if (arrayLen > _theRFM23BP.maxMessageLength() || txBacklogged()) return false;
+    return _theRFM23BP.send(anArray, arrayLen);
+
+}
+
 /**************************************************************************/
 /*!
  @brief  Read a single ASCII character
@@ -168,9 +252,9 @@ bool ALTAIR_RFM23BP::isBusy() {
 /**************************************************************************/
 byte ALTAIR_RFM23BP::read() {
 
-   unsigned char buffer[RH_RF22_FIFO_SIZE];
-   unsigned char length;
-   bool          messageRecvd = _theRFM23BP.recv(buffer, &length);
+   unsigned char buffer[RFM_RX_MAX_MESSAGE_LENGTH];
+   unsigned char length = sizeof(buffer);
+   bool          messageRecvd = readMessage(buffer, &length);
    if (messageRecvd) {
        return buffer[0];
    } else {
@@ -181,60 +265,56 @@ byte ALTAIR_RFM23BP::read() {
 
 /**************************************************************************/
 /*!
- @brief  Read the full message received
+ @brief  Pop the oldest received message from the queue.  (On input,
+         length is the size of buffer; on output, it is the length of the
+         message.)  Returns false if no message has been received.
 */
 /**************************************************************************/
 bool ALTAIR_RFM23BP::readMessage(unsigned char* buffer, unsigned char* length) {
 
-   return _theRFM23BP.recv(buffer, length);
+   serviceRx();
+   return _rxQueue.pop(buffer, length, rxMillis());
 
 }
 
 /**************************************************************************/
 /*!
  @brief  Read a command sent up to ALTAIR from a ground station, or data
-         sent down from ALTAIR to a ground station.
+         sent down from ALTAIR to a ground station.  This pops already-
+         received messages from the queue, and never waits for one to
+         arrive.  (command[] is left as zeros if none has.)  On a ground
+         station, every message is fed to the downlink decoder (so the
+         status frames, fanned out or not, and the command
+         acknowledgements, are all decoded there), and command[] is
+         always left as zeros.
 */
 /**************************************************************************/
 void ALTAIR_RFM23BP::readALTAIRInfo(  byte command[],  bool isGroundStation )
 {
-    byte        buffer[MAX_TERM_LENGTH]                   ;
+    byte        buffer[RFM_RX_MAX_MESSAGE_LENGTH]         ;
     byte        bufferLength                              ;
-    byte        term[MAX_TERM_LENGTH]    =             "" ;
-    int         termIndex                =              0 ;
-    int         termLength               =              0 ;
-    long        readTry                  =              0 ;
-    byte        startByte                =  RX_START_BYTE ;
-    if (isGroundStation)  startByte      =  TX_START_BYTE ;
                 command[0]               =              0 ;
                 command[1]               =              0 ;
+                command[2]               = NO_COMMAND_SEQUENCE ;
     while (true) {
-//        Serial.println(F("here1"));
-        while (!available() && readTry < MAX_READ_TRIES) {
-          ++readTry;
-           delay(5);
+        bufferLength = sizeof(buffer);
+        if (!readMessage(buffer, &bufferLength)) break;
+        if (isGroundStation) {
+            if (!_downlinkDecoder) ++_rxQueue.stats()->messagesInvalid;
+            else                   _downlinkDecoder->feed(buffer, bufferLength, rxMillis());
+            continue;
         }
-        if (readTry < MAX_READ_TRIES) {
-//            Serial.print(F("here2: ")); Serial.println(readTry);
-            bool readSuccess = readMessage(buffer, &bufferLength);
-            if (readSuccess && (buffer[0] == startByte) && (buffer[1] < MAX_TERM_LENGTH)) {
-//              Serial.println(F("here3"));
-              termLength = ((int) (buffer[1]));
-              for (termIndex = 0; termIndex < termLength; ++termIndex) {
-                term[termIndex] = buffer[termIndex+2];
-//                if (isGroundStation) Serial.println(term[termIndex], HEX);
-              }
-//              Serial.print(F("term[0] = ")); Serial.print(term[0], HEX); Serial.print(F("  term[1] = ")); Serial.println(term[1], HEX);
-              command[0] = term[0];
-              command[1] = term[1];
-              if (isGroundStation) groundStationPrintRxInfo(term, termLength);
-              break;
-            }
-        } else {
-//          Serial.println(F("Radio is not available for reading"));
-          break;
+        int termLength = ((int) (buffer[1]));
+        if ((bufferLength >= 2) && (buffer[0] == RX_START_BYTE) && (termLength >= 2) && (termLength + 2 <= bufferLength)) {
+            byte* term = buffer + 2;
+//            Serial.print(F("term[0] = ")); Serial.print(term[0], HEX); Serial.print(F("  term[1] = ")); Serial.println(term[1], HEX);
+            command[0] = term[0];
+            command[1] = term[1];
+            if (termLength >= COMMAND_LENGTH) command[2] = term[2];
+            break;
         }
-    } 
+        ++_rxQueue.stats()->messagesInvalid;
+    }
     return;
 }
 
@@ -8,6 +8,21 @@
     radio transceiver, which operates at 433 MHz.  This class derives 
     from the ALTAIR_GenTelInt generic telemetry interface base class.
 
+    Received messages are captured by the RH_RF22 interrupt handler, and
+    then moved by serviceRx() (which only checks the flag set by that
+    handler, and so never waits) straight into the next slot of a small
+    message queue (see ALTAIR_RFM23BPRxQueue.h), from which
+    readALTAIRInfo() pops them.  On ALTAIR, readALTAIRInfo() looks for
+    a command in each; on a ground station, it feeds each to the
+    downlink decoder (see setDownlinkDecoder(), and
+    ALTAIR_DownlinkDecoder.h), which takes the status frames whether
+    they were fanned out (i.e. preceded by a sequence #) or not, and
+    ALTAIR's command acknowledgements.  The RH_RF22 calls, and the
+    clock, are accessed via protected virtual member functions, so that
+    a host computer simulation of message arrival can override them; the
+    chip select pin, the SPI bus, and (by default) the clock go through
+    ALTAIR_HAL.
+
     Justin Albert  jalbert@uvic.ca     began on 15 Oct. 2017
 
     @section  HISTORY
@@ -20,11 +35,17 @@
 
 #include "ALTAIR_GenTelInt.h"
 #include <RH_RF22.h>
+#include <ALTAIR_HAL.h>
+#include "ALTAIR_RFM23BPRxQueue.h"
+
+class    ALTAIR_DownlinkDecoder;
 
 #define  DEFAULT_RFM_CHIPSELECTPIN    26
 #define  DEFAULT_RFM_INTERRUPTPIN      2
 #define  RFM23BP_RADIO_NAME     "RFM23BP"
 #define  RFM_SPI_BYTE               0x00
+#define  RFM23BP_DATA_RATE          2400          // in bits per second (RH_RF22's default modem config, GFSK_Rb2_4Fd36)
+#define  RFM23BP_PACKET_OVERHEAD      13          // bytes per packet: preamble, sync word, headers, length, and CRC
 
 class ALTAIR_RFM23BP : public ALTAIR_GenTelInt {
   public:
@@ -35,6 +56,10 @@ class ALTAIR_RFM23BP : public ALTAIR_GenTelInt {
     virtual bool    sendAsIndivChars(  const uint8_t* aString                                );
     virtual bool    available(                                                               ); // If a byte is available for reading, returns true.
     virtual bool    isBusy(                                                                  );
+    virtual bool    txBacklogged(                                                            ); // true while a packet is still being sent
+    virtual uint16_t txRoom(                                                                 ); // one packet's worth, if none is being sent
+    virtual bool    sendNonBlocking(   const uint8_t* anArray         ,                         // (one packet, which is left to go out
+                                       const uint8_t  arrayLen                               ); //    by itself)
     virtual bool    initialize(        const char*    aString         = ""                   );
     virtual byte    read(                                                                    );
     virtual bool    readMessage(       unsigned char* buffer, 
@@ -48,17 +73,31 @@ class ALTAIR_RFM23BP : public ALTAIR_GenTelInt {
                                                                                                 // failed to get the last RSSI value.
     virtual bool    lastSentString2(                                                         );
 
+            bool    serviceRx(                                                               ); // Move a newly received message (if any) into the queue.
+            uint8_t rxQueueDepth(                                                            ) { return _rxQueue.depth()    ; }
+            const ALTAIR_RFM23BPRxStats* rxStats(                                            ) { return _rxQueue.stats()    ; }
+            void    printRxStats(                                                            );
+            void    setDownlinkDecoder( ALTAIR_DownlinkDecoder* decoder                      ) { _downlinkDecoder = decoder ; } // (a ground station's:
+                                                                                                //    without one, what is received is dropped)
+
     ALTAIR_RFM23BP(                    byte           RFM23_chipselectpin, 
                                        byte           RFM23_interruptpin                     );
     ALTAIR_RFM23BP(                                                                          ); // No arguments => all default values.
 
   protected:
+    virtual bool    radioAvailable(                                                          ) { return _theRFM23BP.available()          ; }
+    virtual bool    radioRecv(         unsigned char* buffer          ,
+                                       unsigned char* length                                 ) { return _theRFM23BP.recv(buffer, length) ; }
+    virtual unsigned long rxMillis(                                                          ) { return ALTAIR_HAL::clockMillis()        ; }
 
   private:
     // this class is basically just a container for the RadioHead RH_RF22 class
     RH_RF22    _theRFM23BP                                                                    ;
     byte       _RFM23_chipselectpin                                                           ;
     bool       _lastSentString2                                                               ;
+
+    ALTAIR_RFM23BPRxQueue _rxQueue                                                            ;
+    ALTAIR_DownlinkDecoder* _downlinkDecoder                                                  ;
   
 };
 #endif
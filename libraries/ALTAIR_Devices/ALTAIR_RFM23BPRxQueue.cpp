@@ -0,0 +1,94 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_RFM23BPRxQueue.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the receive queue of the RFM23BP radio transceiver (see
+    ALTAIR_RFM23BPRxQueue.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "ALTAIR_RFM23BPRxQueue.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_RFM23BPRxQueue::ALTAIR_RFM23BPRxQueue(                        ) :
+               _head(                                        0  ) ,
+               _count(                                       0  )
+{
+    resetStats();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_RFM23BPRxQueue::resetStats(                              )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  The slot to receive the next message into, or NULL if the queue
+         is full.
+*/
+/**************************************************************************/
+byte* ALTAIR_RFM23BPRxQueue::back(                                   )
+{
+    if (_count == RFM_RX_QUEUE_LENGTH) return NULL;
+    return _message[(_head + _count) % RFM_RX_QUEUE_LENGTH];
+}
+
+/**************************************************************************/
+/*!
+ @brief  A message was received into back(), or (if the queue was full)
+         dropped.  Returns false if it was dropped.
+*/
+/**************************************************************************/
+bool ALTAIR_RFM23BPRxQueue::push( uint8_t length , unsigned long now )
+{
+    ++_stats.messagesReceived;
+    if (_count == RFM_RX_QUEUE_LENGTH) {
+        ++_stats.messagesDropped;
+        return false;
+    }
+    uint8_t slot  = (_head + _count) % RFM_RX_QUEUE_LENGTH;
+    _length[slot] = (length > RFM_RX_MAX_MESSAGE_LENGTH) ? RFM_RX_MAX_MESSAGE_LENGTH : length;
+    _millis[slot] = now;
+    ++_count;
+    if (_count > _stats.maxQueueDepth) _stats.maxQueueDepth = _count;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Pop the oldest message, noting how long it was queued.  Returns
+         false if there is none.
+*/
+/**************************************************************************/
+bool ALTAIR_RFM23BPRxQueue::pop( byte* buffer , uint8_t* length , unsigned long now )
+{
+    if (_count == 0) return false;
+    if (_length[_head] < *length) *length = _length[_head];
+    memcpy(buffer, _message[_head], *length);
+    unsigned long latency   = now - _millis[_head];
+    _stats.lastQueueLatency = latency;
+    if (latency > _stats.maxQueueLatency) _stats.maxQueueLatency = latency;
+    _head = (_head + 1) % RFM_RX_QUEUE_LENGTH;
+    --_count;
+    return true;
+}
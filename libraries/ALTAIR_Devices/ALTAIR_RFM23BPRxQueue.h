@@ -0,0 +1,74 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_RFM23BPRxQueue.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the receive queue of the RFM23BP radio transceiver, as used
+    by ALTAIR_RFM23BP.  Each message that the RH_RF22 interrupt handler
+    has captured is received straight into the next free slot of the
+    queue (see back()), so no larger buffer is needed on the stack; a
+    message longer than a slot (i.e. than the longest frame that
+    ALTAIR_LinkEncoder sends, with its fan-out sequence #) is truncated
+    by the RH_RF22's recv(), and one that arrives when the queue is full
+    is dropped (and counted).
+    Messages are then popped, oldest first, with the time each spent
+    queued noted.
+
+    This file does not depend upon the Arduino libraries, so that the
+    queue can be run against a simulation of the RH_RF22's message
+    arrival on a host computer (see tools/ALTAIRRFM23BPRxSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_RFM23BPRxQueue_h
+#define   ALTAIR_RFM23BPRxQueue_h
+
+#include  "ALTAIR_LinkEncoder.h"                 // LINK_ENCODER_MAX_LENGTH
+
+#define   RFM_RX_QUEUE_LENGTH           4          // # of messages
+#define   RFM_RX_MAX_MESSAGE_LENGTH    LINK_ENCODER_MAX_LENGTH   // a whole fanned-out frame, with its sequence # (longer messages are truncated)
+
+struct    ALTAIR_RFM23BPRxStats {
+    unsigned long       messagesReceived                                    ;
+    unsigned long       messagesDropped                                     ;  // arrived when the queue was full
+    unsigned long       messagesInvalid                                     ;  // popped, but without the expected start byte & length
+    uint8_t             maxQueueDepth                                       ;
+    unsigned long       lastQueueLatency                                    ;  // in milliseconds from capture until popped
+    unsigned long       maxQueueLatency                                     ;
+};
+
+class     ALTAIR_RFM23BPRxQueue {
+  public:
+
+    ALTAIR_RFM23BPRxQueue(                                                  ) ;
+
+    byte*               back(                                                       ) ;   // Where to receive the next message (into at most
+                                                                                          //    RFM_RX_MAX_MESSAGE_LENGTH bytes), or NULL if full.
+    bool                push(           uint8_t               length              ,       // A message of length bytes was received into back()
+                                        unsigned long         now                   ) ;   //    (or dropped, if it was NULL).  False if dropped.
+    bool                pop(            byte*                 buffer              ,       // The oldest message.  (On input, length is the size
+                                        uint8_t*              length              ,       //    of buffer; on output, it is the length of the
+                                        unsigned long         now                   ) ;   //    message.)  False if there is none.
+
+    uint8_t             depth(                                                      ) { return _count                      ; }   // # of messages queued
+
+    ALTAIR_RFM23BPRxStats* stats(                                                   ) { return &_stats                     ; }   // (ALTAIR_RFM23BP counts the invalid ones)
+    void                resetStats(                                                 ) ;
+
+  private:
+    byte                _message[RFM_RX_QUEUE_LENGTH][RFM_RX_MAX_MESSAGE_LENGTH]    ;
+    uint8_t             _length[RFM_RX_QUEUE_LENGTH]                                ;
+    unsigned long       _millis[RFM_RX_QUEUE_LENGTH]                                ;  // the time each message was captured
+    uint8_t             _head                                                       ;  // the index of the oldest queued message
+    uint8_t             _count                                                      ;
+    ALTAIR_RFM23BPRxStats _stats                                                    ;
+};
+
+#endif    //   ifndef ALTAIR_RFM23BPRxQueue_h
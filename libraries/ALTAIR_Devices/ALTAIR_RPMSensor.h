@@ -11,7 +11,9 @@
     (and only four) objects of this ALTAIR_RPMSensor class should end up 
     instantiated; they will each be instantiated by their respective 
     ALTAIR_MotorAndESC object upon the singleton instantiation of the
-    ALTAIR_PropulsionSystem object.
+    ALTAIR_PropulsionSystem object.  They are set from the Arduino Micro's
+    readings, either packed (whole revolutions per second, saturating at
+    127) or extended (whole RPM).
 
     Justin Albert  jalbert@uvic.ca     began on 2 Sep. 2018
 
@@ -24,7 +26,12 @@
 #ifndef ALTAIR_RPMSensor_h
 #define ALTAIR_RPMSensor_h
 
-#include "Arduino.h"
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
 
 class ALTAIR_RPMSensor {
   public:
@@ -33,6 +40,8 @@ class ALTAIR_RPMSensor {
 
     float                    rpm(              )     { return _rpm       ; }
     void                     setRPM( float rpm )     {        _rpm = rpm ; }
+    void                     setFromPacked(   byte     packedRPS )  { _rpm = 60. * (int8_t) packedRPS ; }
+    void                     setFromExtended( uint16_t rpm       )  { _rpm = rpm                      ; }
 
   private:
     float                   _rpm                                         ;
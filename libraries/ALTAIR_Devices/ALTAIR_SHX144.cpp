@@ -15,8 +15,11 @@
 */
 /**************************************************************************/
 
+#include <string.h>
 #include "ALTAIR_SHX144.h"
 #include <SoftwareSerial.h>
+#include <Adafruit_ADS1X15.h>
+#include <ALTAIR_HAL.h>
 
 /**************************************************************************/
 /*!
@@ -25,9 +28,12 @@
 /**************************************************************************/
 ALTAIR_SHX144::ALTAIR_SHX144(const char serialID, const char fakeShxProgramRxPin, const char shxProgramPin, const char shxBusyPin) :
     _serialID(serialID) ,
+    _uart(ALTAIR_HAL::uart(serialID)) ,
     _fakeShxProgramRxPin(fakeShxProgramRxPin) ,
     _shxProgramPin(shxProgramPin) ,
-    _shxBusyPin(shxBusyPin)
+    _shxBusyPin(shxBusyPin) ,
+    _rssiADC(NULL) ,
+    _rssiChannel(0)
 {
 }
 
@@ -38,9 +44,12 @@ ALTAIR_SHX144::ALTAIR_SHX144(const char serialID, const char fakeShxProgramRxPin
 /**************************************************************************/
 ALTAIR_SHX144::ALTAIR_SHX144() :
     _serialID(DEFAULT_SHX_SERIALID) ,
+    _uart(ALTAIR_HAL::uart(DEFAULT_SHX_SERIALID)) ,
     _fakeShxProgramRxPin(DEFAULT_FAKESHXPROGRAMRXPIN) ,
     _shxProgramPin(DEFAULT_SHXPROGRAMPIN) ,
-    _shxBusyPin(DEFAULT_SHXBUSYPIN)
+    _shxBusyPin(DEFAULT_SHXBUSYPIN) ,
+    _rssiADC(NULL) ,
+    _rssiChannel(0)
 {
 }
 
@@ -55,9 +64,9 @@ bool ALTAIR_SHX144::initialize(const char* aString) {
 
     SoftwareSerial shxProgramSerial(_fakeShxProgramRxPin, _shxProgramPin);
 
-    pinMode(           _fakeShxProgramRxPin, INPUT);
-    pinMode(                 _shxProgramPin, OUTPUT);
-    pinMode(                    _shxBusyPin, INPUT);
+    ALTAIR_HAL::gpioMode(  _fakeShxProgramRxPin, HAL_INPUT);
+    ALTAIR_HAL::gpioMode(        _shxProgramPin, HAL_OUTPUT);
+    ALTAIR_HAL::gpioMode(           _shxBusyPin, HAL_INPUT);
 
     shxProgramSerial.begin(SHX144_PROGRAM_BAUDRATE);
   
@@ -78,32 +87,15 @@ bool ALTAIR_SHX144::initialize(const char* aString) {
         while(1);
     }
 
-    delay(200);
+    ALTAIR_HAL::clockDelay(200);
 
     shxProgramSerial.end();
 
-    digitalWrite(            _shxProgramPin, HIGH);  // The PGM pin is _active LOW_, so one must return it to its default
-                                                     //  (i.e.: internal 47k pull-up to 4V) HIGH state in order to move
-                                                     //  from programming mode to serial modem mode.
-
-    switch (_serialID) {
-      case 0:
-        Serial.begin(SHX144_SERIAL_BAUDRATE);
-        break;
-      case 1:
-        Serial1.begin(SHX144_SERIAL_BAUDRATE);
-        break;
-      case 2:
-        Serial2.begin(SHX144_SERIAL_BAUDRATE);
-        break;
-      case 3:
-        Serial3.begin(SHX144_SERIAL_BAUDRATE);
-        break;
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
-        while(1);
-        break;
-    }
+    ALTAIR_HAL::gpioWrite(   _shxProgramPin, HAL_HIGH);  // The PGM pin is _active LOW_, so one must return it to its default
+                                                         //  (i.e.: internal 47k pull-up to 4V) HIGH state in order to move
+                                                         //  from programming mode to serial modem mode.
+
+    uart()->begin(SHX144_SERIAL_BAUDRATE);
     
     return true;
 
@@ -113,25 +105,28 @@ bool ALTAIR_SHX144::initialize(const char* aString) {
 
 /**************************************************************************/
 /*!
- @brief  Send one ASCII character.  (Returns false if send is unsuccessful.)
+ @brief  Return the UART that the transceiver is on (or, if the serial ID 
+         is not allowed, print an error and halt).
 */
 /**************************************************************************/
-bool ALTAIR_SHX144::send(unsigned char aChar) {
+ALTAIR_HALUart* ALTAIR_SHX144::uart() {
 
-    switch (_serialID) {
-      case 0:
-        return Serial.write(aChar);
-      case 1:
-        return Serial1.write(aChar);
-      case 2:
-        return Serial2.write(aChar);
-      case 3:
-        return Serial3.write(aChar);
-      default:
+    if (_uart == NULL) {
         Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
         while(1);
-        return false;
     }
+    return _uart;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  Send one ASCII character.  (Returns false if send is unsuccessful.)
+*/
+/**************************************************************************/
+bool ALTAIR_SHX144::send(unsigned char aChar) {
+
+    return uart()->write(&aChar, 1);
 
 }
 
@@ -143,20 +138,7 @@ bool ALTAIR_SHX144::send(unsigned char aChar) {
 /**************************************************************************/
 bool ALTAIR_SHX144::send(const uint8_t* aString) {
 
-    switch (_serialID) {
-      case 0:
-        return Serial.write((const char*) aString);
-      case 1:
-        return Serial1.write((const char*) aString);
-      case 2:
-        return Serial2.write((const char*) aString);
-      case 3:
-        return Serial3.write((const char*) aString);
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
-        while(1);
-        return false;
-    }
+    return uart()->write(aString, strlen((const char*) aString));
 
 }
 
@@ -167,20 +149,7 @@ bool ALTAIR_SHX144::send(const uint8_t* aString) {
 /**************************************************************************/
 bool ALTAIR_SHX144::send(const uint8_t* anArray, const uint8_t arrayLen) {
 
-    switch (_serialID) {
-      case 0:
-        return Serial.write(  anArray, arrayLen );
-      case 1:
-        return Serial1.write( anArray, arrayLen );
-      case 2:
-        return Serial2.write( anArray, arrayLen );
-      case 3:
-        return Serial3.write( anArray, arrayLen );
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
-        while(1);
-        return false;
-    }
+    return uart()->write(anArray, arrayLen);
 
 }
 
@@ -194,32 +163,12 @@ bool ALTAIR_SHX144::send(const uint8_t* anArray, const uint8_t arrayLen) {
 /**************************************************************************/
 bool ALTAIR_SHX144::sendAsIndivChars(const uint8_t* aString) {
 
-    switch (_serialID) {
-      case 0:
-        for (int i = 0; aString[i] != 0; ++i) {
-            Serial.write(aString[i]);
-        }
-        return Serial.write(0);
-      case 1:
-        for (int i = 0; aString[i] != 0; ++i) {
-            Serial1.write(aString[i]);
-        }
-        return Serial1.write(0);
-      case 2:
-        for (int i = 0; aString[i] != 0; ++i) {
-            Serial2.write(aString[i]);
-        }
-        return Serial2.write(0);
-      case 3:
-        for (int i = 0; aString[i] != 0; ++i) {
-            Serial3.write(aString[i]);
-        }
-        return Serial3.write(0);
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
-        while(1);
-        return false;
+    ALTAIR_HALUart* port = uart();
+    for (int i = 0; aString[i] != 0; ++i) {
+        port->write(&aString[i], 1);
     }
+    const uint8_t nullChar = 0;
+    return port->write(&nullChar, 1);
 
 }
 
@@ -231,20 +180,7 @@ bool ALTAIR_SHX144::sendAsIndivChars(const uint8_t* aString) {
 /**************************************************************************/
 bool ALTAIR_SHX144::available() {
 
-    switch (_serialID) {
-      case 0:
-        return Serial.available();
-      case 1:
-        return Serial1.available();
-      case 2:
-        return Serial2.available();
-      case 3:
-        return Serial3.available();
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
-        while(1);
-        return false;
-    }
+    return uart()->available();
 
 }
 
@@ -256,7 +192,21 @@ bool ALTAIR_SHX144::available() {
 /**************************************************************************/
 bool ALTAIR_SHX144::isBusy() {
 
-    return (digitalRead(_shxBusyPin) == HIGH);
+    return (ALTAIR_HAL::gpioRead(_shxBusyPin) == HAL_HIGH);
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  The # of bytes that can be sent now without waiting, i.e. the
+         room in the UART's transmit buffer (or 0, if the SHX transceiver
+         is busy).
+*/
+/**************************************************************************/
+uint16_t ALTAIR_SHX144::txRoom() {
+
+    if (isBusy() || _uart == NULL) return 0;
+    return _uart->availableForWrite();
 
 }
 
@@ -267,20 +217,7 @@ bool ALTAIR_SHX144::isBusy() {
 /**************************************************************************/
 byte ALTAIR_SHX144::read() {
 
-    switch (_serialID) {
-      case 0:
-        return Serial.read();
-      case 1:
-        return Serial1.read();
-      case 2:
-        return Serial2.read();
-      case 3:
-        return Serial3.read();
-      default:
-        Serial.println(F("Unallowed serial ID provided in initialization of SHX1 radio transceiver!"));
-        while(1);
-        return 0;
-    }
+    return uart()->read();
 
 }
 
@@ -305,17 +242,35 @@ radio_t ALTAIR_SHX144::radioType() {
 /**************************************************************************/
 /*!
  @brief  Returns the most recent Return Signal Strength Information from
-         the transceiver (i.e., from the most recent byte read).  The 
-         return value is in dBm.  However, if a value of +127 is returned, 
-         that means that the transceiver is not giving us an RSSI value
-         (possibly because a byte hasn't been read from the transceiver yet 
-         -- for example, see if perhaps data has only been written to, but   
-         not yet read so far from the transceiver, if you get a +127).
+         the transceiver (i.e., read from its analog RSSI output just after
+         the most recent message was received).  The return value is in
+         dBm.  However, if a value of +127 is returned, that means that the
+         transceiver is not giving us an RSSI value (possibly because no
+         message has been received yet, or because no ADC channel has been
+         set with setRSSIADC).
 */
 /**************************************************************************/
 char ALTAIR_SHX144::lastRSSI() {
 
-// NEED TO IMPLEMENT THIS PROPERLY!!!
-    return FAKE_RSSI_VAL;
+    return _lastRSSI;
+
+}
+
+/**************************************************************************/
+/*!
+ @brief  A message was just received: read the analog RSSI output (via the
+         ADS1115, at its default gain of 0.1875 mV per count), and convert
+         it to dBm.
+*/
+/**************************************************************************/
+void ALTAIR_SHX144::termReceived() {
+
+    if (_rssiADC == NULL) return;
+    ALTAIR_HAL::i2cFlush();                                          // (as the ADS1X15 library uses Wire)
+    int32_t millivolts = (int32_t) _rssiADC->readADC_SingleEnded(_rssiChannel) * 3 / 16;
+    int32_t dBm        = SHX144_RSSI_FLOOR_DBM + (millivolts - SHX144_RSSI_FLOOR_MV) / SHX144_RSSI_MV_PER_DB;
+    if (dBm < -128) dBm = -128;
+    if (dBm >  0)   dBm =  0;
+    noteRSSI((char) dBm, ALTAIR_HAL::clockMillis());
 
 }
@@ -8,6 +8,9 @@
     radio transceiver, which operates at 144 MHz.  This class derives 
     from the ALTAIR_GenTelInt generic telemetry interface base class.
 
+    Its serial port, pins and clock are accessed through ALTAIR_HAL (all
+    but the software serial port that programs it, at initialization).
+
     Justin Albert  jalbert@uvic.ca     began on 15 Oct. 2017
 
     @section  HISTORY
@@ -19,6 +22,7 @@
 #define ALTAIR_SHX144_h
 
 #include "ALTAIR_GenTelInt.h"
+#include <ALTAIR_HAL.h>
 
 #define  SHX144_PROGRAM_BAUDRATE    2400
 #define  SHX144_SERIAL_BAUDRATE     1200
@@ -28,6 +32,11 @@
 #define  DEFAULT_SHXPROGRAMPIN        25
 #define  DEFAULT_SHXBUSYPIN           23
 #define  SHX144_RADIO_NAME       "SHX144"
+#define  SHX144_RSSI_FLOOR_MV       500          // the SHX1's analog RSSI output at SHX144_RSSI_FLOOR_DBM, rising by
+#define  SHX144_RSSI_FLOOR_DBM     -125          //    SHX144_RSSI_MV_PER_DB (nominal values from its datasheet's RSSI
+#define  SHX144_RSSI_MV_PER_DB       20          //    curve; calibrate against a signal generator)
+
+class Adafruit_ADS1X15;
 
 class ALTAIR_SHX144 : public ALTAIR_GenTelInt {
   public:
@@ -38,6 +47,7 @@ class ALTAIR_SHX144 : public ALTAIR_GenTelInt {
     virtual bool    sendAsIndivChars(  const uint8_t* aString                                );
     virtual bool    available(                                                               ); // If a byte is available for reading, returns true.
     virtual bool    isBusy(                                                                  );
+    virtual uint16_t txRoom(                                                                 ); // the room in the UART's transmit buffer (0 if busy)
     virtual bool    initialize(        const char*    aString = ""                           );
     virtual byte    read(                                                                    );
     virtual const char*   radioName(                                                         );
@@ -47,6 +57,9 @@ class ALTAIR_SHX144 : public ALTAIR_GenTelInt {
                                                                                                 // failed to get the last RSSI value.
     virtual bool    lastSentString2()                                           { return true ; }
 
+            void    setRSSIADC(        Adafruit_ADS1X15* adc          ,                         // The ADC channel that the analog RSSI output
+                                       uint8_t        channel                                ) { _rssiADC = adc ; _rssiChannel = channel ; } // is wired to.
+
     ALTAIR_SHX144(                     const char     serialID, 
                                        const char     fakeShxProgramRxPin, 
                                        const char     shxProgramPin, 
@@ -54,13 +67,18 @@ class ALTAIR_SHX144 : public ALTAIR_GenTelInt {
     ALTAIR_SHX144(                                                                           ); // No arguments => all default values.
 
   protected:
+    virtual void    termReceived(                                                            ); // (reads the RSSI, while the carrier is likely still up)
+            ALTAIR_HALUart* uart(                                                            );
 
   private:
 
     char           _serialID                                                                  ;
+    ALTAIR_HALUart* _uart                                                                     ;  // (NULL if _serialID is not allowed)
     char           _fakeShxProgramRxPin                                                       ;
     char           _shxProgramPin                                                             ;
     char           _shxBusyPin                                                                ;
+    Adafruit_ADS1X15* _rssiADC                                                                ;  // (NULL if none)
+    uint8_t        _rssiChannel                                                               ;
 };
 #endif
 
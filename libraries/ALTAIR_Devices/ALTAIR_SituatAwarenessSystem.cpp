@@ -53,7 +53,7 @@ void ALTAIR_SituatAwarenessSystem::initialize(             )
      Serial.println(F("BME280 pressure/temp/humidity sensors initialization..."));
      bool status1, status2, status3, statusall;    
      status1 = _bmeMast.begin(                            );
-     status2 = _bmeBalloon.begin( 0x76                    );
+     status2 = _bmeBalloon.begin( BME280_I2CADDRESS_ALT   );
      ALTAIR_TCA9548A::tcaselect(  TCA9548A_BME280PAYLOAD  );
      status3 = _bmePayload.begin(                         );
      ALTAIR_TCA9548A::tcaselect(  TCA9548A_EVERYTHINGELSE );
@@ -71,26 +71,57 @@ void ALTAIR_SituatAwarenessSystem::initialize(             )
 
 /**************************************************************************/
 /*!
- @brief  Print out temp/pressure/humidity info from a BME280 sensor.
+ @brief  Burst-read each of the three BME280s (the one inside the gondola
+         via its I2C multiplexer channel), and keep their readings.  The
+         bus manager runs them grouped by channel, so that (other than at
+         the first sweep) just one multiplexer write is needed per sweep.
 */
 /**************************************************************************/
-void ALTAIR_SituatAwarenessSystem::bme280PrintInfo( Adafruit_BME280*   bme280 )
+uint8_t ALTAIR_SituatAwarenessSystem::sampleBME280s(      )
+{
+     _i2cBus.queue( &_bmeMast,     TCA9548A_EVERYTHINGELSE );   // (the same address as the gondola's)
+     _i2cBus.queue( &_bmeBalloon,  TCA9548A_ANYCHANNEL     );
+     _i2cBus.queue( &_bmePayload,  TCA9548A_BME280PAYLOAD  );
+     return _i2cBus.runQueued();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the three BME280s' sampling statistics,
+         and the I2C bus manager's.
+*/
+/**************************************************************************/
+void ALTAIR_SituatAwarenessSystem::printBME280Stats(      )
+{
+     _bmeMast.printStats(    "nav mast"      );
+     _bmeBalloon.printStats( "balloon valve" );
+     _bmePayload.printStats( "gondola"       );
+     _i2cBus.printStats(                     );
+}
+
+/**************************************************************************/
+/*!
+ @brief  Print out temp/pressure/humidity info from a BME280 sensor (as
+         last sampled).
+*/
+/**************************************************************************/
+void ALTAIR_SituatAwarenessSystem::bme280PrintInfo( ALTAIR_BME280*     bme280 )
 {
     Serial.print(F("Mast Temperature = "));
-    Serial.print(bme280->readTemperature());
+    Serial.print(bme280->temperature());
     Serial.println(F(" *C"));
 
     Serial.print(F("Mast Pressure = "));
 
-    Serial.print(bme280->readPressure() / 100.0F);
+    Serial.print(bme280->pressure() / 100.0F);
     Serial.println(F(" hPa"));
 
     Serial.print(F("Mast Approx. Altitude = "));
-    Serial.print(bme280->readAltitude(SEALEVELPRESSURE_HPA));
+    Serial.print(bme280->altitude(SEALEVELPRESSURE_HPA));
     Serial.println(F(" m"));
 
     Serial.print(F("Mast Humidity = "));
-    Serial.print(bme280->readHumidity());
+    Serial.print(bme280->humidity());
     Serial.println(F(" %"));
     
     Serial.println();
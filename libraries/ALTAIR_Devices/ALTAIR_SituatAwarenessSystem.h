@@ -16,6 +16,14 @@
     the many (primarily LM333) other temperature sensors located at 
     various places within and around ALTAIR.
 
+    The three BME280s are read by one sampling service, sampleBME280s()
+    (called by the task scheduler), which burst-reads each one and keeps
+    its compensated readings (see ALTAIR_BME280.h).  Everything else (the
+    telemetry frames, the flight record, and the printouts) reads those,
+    and never the sensors themselves.  It queues the three samples with the
+    I2C bus manager (see ALTAIR_I2CBus.h), which selects the multiplexer
+    channel that each one needs, with as few channel switches as possible.
+
     This class is instantiated as a singleton via the instantiation of the
     (also singleton) ALTAIR_GlobalDeviceControl class.
 
@@ -35,8 +43,8 @@
 #include "ALTAIR_OrientSensors.h"
 #include "ALTAIR_ArduinoMicro.h"
 #include "ALTAIR_Battery.h"
-#include <Adafruit_Sensor.h>
-#include <Adafruit_BME280.h>
+#include "ALTAIR_BME280.h"
+#include "ALTAIR_I2CBus.h"
 
 #define   SEALEVELPRESSURE_HPA       (1013.25)
 
@@ -54,9 +62,12 @@ class ALTAIR_SituatAwarenessSystem {
     ALTAIR_Battery*          genOpsBatt(                 ) { return &_genOpsBattery           ; }
     ALTAIR_Battery*          propBatt(                   ) { return &_propBattery             ; }
 
-    Adafruit_BME280*         bmeMast(                    ) { return &_bmeMast                 ; }
-    Adafruit_BME280*         bmeBalloon(                 ) { return &_bmeBalloon              ; }
-    Adafruit_BME280*         bmePayload(                 ) { return &_bmePayload              ; }
+    ALTAIR_BME280*           bmeMast(                    ) { return &_bmeMast                 ; }
+    ALTAIR_BME280*           bmeBalloon(                 ) { return &_bmeBalloon              ; }
+    ALTAIR_BME280*           bmePayload(                 ) { return &_bmePayload              ; }
+    ALTAIR_I2CBus*           i2cBus(                     ) { return &_i2cBus                  ; }
+    uint8_t                  sampleBME280s(              )                                    ; // Sample all three.  Returns the # that had a new measurement.
+    void                     printBME280Stats(           )                                    ;
 
     void                     bmeMastPrintInfo(           ) { bme280PrintInfo( &_bmeMast     ) ; }
     void                     bmeBalloonPrintInfo(        ) { bme280PrintInfo( &_bmeBalloon  ) ; }
@@ -69,7 +80,7 @@ class ALTAIR_SituatAwarenessSystem {
 
   protected:
 
-    void                     bme280PrintInfo(                Adafruit_BME280*   bme280      ) ;
+    void                     bme280PrintInfo(                ALTAIR_BME280*     bme280      ) ;
 
   private:
     ALTAIR_GPSSensors        _gpsSensors                                                      ;
@@ -81,9 +92,10 @@ class ALTAIR_SituatAwarenessSystem {
     ALTAIR_Battery           _genOpsBattery                                                   ;
     ALTAIR_Battery           _propBattery                                                     ;
 
-    Adafruit_BME280          _bmeMast                                                         ;
-    Adafruit_BME280          _bmeBalloon                                                      ;
-    Adafruit_BME280          _bmePayload                                                      ;
+    ALTAIR_BME280            _bmeMast                                                         ;
+    ALTAIR_BME280            _bmeBalloon                                                      ;
+    ALTAIR_BME280            _bmePayload                                                      ;  // (behind the I2C multiplexer)
+    ALTAIR_I2CBus            _i2cBus                                                          ;
 
 };
 #endif    //   ifndef ALTAIR_SituatAwarenessSystem_h
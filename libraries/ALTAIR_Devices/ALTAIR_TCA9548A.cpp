@@ -5,8 +5,8 @@
     @license  GPL
 
     This is the class for the ALTAIR Adafruit TCA9548A 1-to-8 I2C
-    multiplexer breakout board.  It is a static class, with one static
-    member function (tcaselect), and thus should never be instantiated.
+    multiplexer breakout board.  It is a static class, with static member
+    functions (tcaselect, etc), and thus should never be instantiated.
 
     Justin Albert  jalbert@uvic.ca     began on 9 Sep. 2018
 
@@ -17,8 +17,9 @@
 /**************************************************************************/
 
 #include "ALTAIR_TCA9548A.h"
-#include <Wire.h>
 
+char                  ALTAIR_TCA9548A::_selected = TCA9548A_UNKNOWN;
+ALTAIR_TCA9548AStats  ALTAIR_TCA9548A::_stats    = { 0, 0, 0 };
 
 /**************************************************************************/
 /*!
@@ -32,19 +33,24 @@ ALTAIR_TCA9548A::ALTAIR_TCA9548A()
 
 /**************************************************************************/
 /*!
- @brief  Select I2C TCA mux location
+ @brief  Select I2C TCA mux location (unless it is already selected)
 */
 /**************************************************************************/
-void ALTAIR_TCA9548A::tcaselect(char tcaLocation) {
-
-    if (tcaLocation > TCA9548A_MAXLOC || tcaLocation < TCA9548A_EVERYTHINGELSE ) return;
- 
-    Wire.beginTransmission( TCA9548A_I2CADDRESS     ) ;
-    if ( tcaLocation ==     TCA9548A_EVERYTHINGELSE ) {
-        Wire.write(         TCA9548A_MINLOC         ) ;
-    } else                                            {
-        Wire.write(         1 << tcaLocation        ) ;
+bool ALTAIR_TCA9548A::tcaselect(char tcaLocation) {
+
+    if (tcaLocation > TCA9548A_MAXLOC || tcaLocation < TCA9548A_EVERYTHINGELSE ) return false;
+    if (tcaLocation == _selected) {
+        ++_stats.elided;
+        return true;
     }
-    Wire.endTransmission(                           ) ;  
-}
 
+    uint8_t channels = ( tcaLocation == TCA9548A_EVERYTHINGELSE ) ? TCA9548A_MINLOC : ( 1 << tcaLocation );
+    ++_stats.writes;
+    if (!ALTAIR_HAL::i2cWrite( TCA9548A_I2CADDRESS , &channels , 1 )) {
+        ++_stats.failedWrites;
+        _selected = TCA9548A_UNKNOWN;
+        return false;
+    }
+    _selected = tcaLocation;
+    return true;
+}
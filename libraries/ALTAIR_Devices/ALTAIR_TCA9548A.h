@@ -4,9 +4,17 @@
     @author   Justin Albert (jalbert@uvic.ca)
     @license  GPL
 
-    This is the class for the ALTAIR Adafruit TCA9548A 1-to-8 I2C 
-    multiplexer breakout board.  It is a static class, with one static 
-    member function (tcaselect), and thus should never be instantiated.
+    This is the class for the ALTAIR Adafruit TCA9548A 1-to-8 I2C
+    multiplexer breakout board.  It is a static class, with static member
+    functions (tcaselect, etc), and thus should never be instantiated.
+
+    It remembers which channel is selected, so that tcaselect only writes
+    to the multiplexer when the channel changes.  If a write is not
+    acknowledged (or the multiplexer may have been reset, in which case
+    invalidate() should be called), the channel is unknown, and the next
+    tcaselect always writes.  It talks to the multiplexer via the HAL, so
+    that it can also be run on a host computer (see
+    tools/ALTAIRMuxSweepSim.cpp).
 
     Justin Albert  jalbert@uvic.ca     began on 9 Sep. 2018
 
@@ -18,23 +26,34 @@
 #ifndef ALTAIR_TCA9548A_h
 #define ALTAIR_TCA9548A_h
 
-#include "Arduino.h"
+#include <ALTAIR_HAL.h>
 
 #define  TCA9548A_I2CADDRESS        0x70
 #define  TCA9548A_MINLOC               0
 #define  TCA9548A_MAXLOC               7
 #define  TCA9548A_BME280PAYLOAD        0
 #define  TCA9548A_EVERYTHINGELSE      -1
+#define  TCA9548A_ANYCHANNEL          -2          // (for a device on the main bus whose address no channel's devices share)
+#define  TCA9548A_UNKNOWN             -3          // (the selected channel, before the first write, or after a failed one)
+
+struct   ALTAIR_TCA9548AStats {
+    unsigned long   writes                              ;   // to the multiplexer
+    unsigned long   elided                              ;   // tcaselect calls for the channel already selected
+    unsigned long   failedWrites                        ;   // not acknowledged
+};
 
 class ALTAIR_TCA9548A {
   public:
-    static  void    tcaselect(      char           tcaLocation      );
+    static  bool    tcaselect(      char           tcaLocation      );   // False if the write was not acknowledged.
+    static  char    selected(                                       ) { return _selected   ; }
+    static  void    invalidate(                                     ) { _selected = TCA9548A_UNKNOWN ; }
+    static  const ALTAIR_TCA9548AStats* stats(                      ) { return &_stats     ; }
 
   protected:
     ALTAIR_TCA9548A(                                                );    // This class shouldn't ever be instantiated.
 
   private:
-  
+    static  char                  _selected                         ;
+    static  ALTAIR_TCA9548AStats  _stats                            ;
 };
 #endif
-
@@ -0,0 +1,222 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_TelemetryDelta.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This file contains the keyframe-plus-delta encoding of the two
+    sendAllALTAIRInfo telemetry frames.  Every so often (and whenever a
+    delta would not be any shorter) a frame is sent in full, as before;
+    this is the keyframe.  In between, each frame is sent as a delta
+    against the last keyframe of its kind:
+
+      [DELTA_FRAME_START_BYTE] [length] [frame type] [key check] [bitmap ...] [varints ...] [CRC-8]
+
+    where bit i of the bitmap (LSB first) is set if field i of the frame
+    (as laid out in ALTAIR_TelemetryFrames.h) differs from the keyframe,
+    and then, for each field that does, the difference (modulo the
+    field's width, as a signed number) is zigzag-encoded and sent as a
+    varint (7 bits per byte, least significant first, with the top bit
+    set on all but the last byte).  The key check is the CRC-8 (polynomial
+    0x07) of the keyframe that the delta is against, so that a delta is
+    not applied to the wrong keyframe (e.g. because a keyframe was lost),
+    and the final CRC-8 is of the whole reconstructed frame, so that a
+    corrupted delta is rejected rather than decoded into nonsense.
+
+    Since each delta is against the keyframe, rather than against the
+    previous delta, a lost delta only loses that one frame.
+
+    This file does not depend upon the Arduino libraries, so that it can
+    also be run on a host computer (see tools/ALTAIRDeltaDownlinkSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_TelemetryDelta_h
+#define   ALTAIR_TelemetryDelta_h
+
+#include "ALTAIR_TelemetryFrames.h"
+#ifdef    ARDUINO
+#include  <avr/pgmspace.h>
+#else
+#ifndef   PROGMEM
+#define   PROGMEM
+#define   pgm_read_byte(address)   (*(const uint8_t*) (address))
+#endif
+#endif
+
+#define   DELTA_FRAME_START_BYTE         0xF9
+#define   DELTA_FRAME_TYPE_1                1          // (the frame type byte of a delta: which frame it is of)
+#define   DELTA_FRAME_TYPE_2                2
+#define   DEFAULT_DELTA_KEYFRAME_INTERVAL  10          // i.e. a keyframe of each frame every 10th time it is sent
+#define   DELTA_NO_KEYFRAME              0xFF          // (for the sender: no keyframe has been sent yet)
+
+/**************************************************************************/
+/*!
+    The widths of the fields of each frame, in order (each byte of a
+    byte array being a field of its own).
+*/
+/**************************************************************************/
+static const uint8_t deltaFrame1Widths[] PROGMEM = {
+    ALTAIR_AllInfoFrame1::latitude  ::width , ALTAIR_AllInfoFrame1::longitude ::width , ALTAIR_AllInfoFrame1::elevation ::width ,
+    ALTAIR_AllInfoFrame1::age       ::width , ALTAIR_AllInfoFrame1::hdop      ::width , ALTAIR_AllInfoFrame1::separator1::width ,
+    ALTAIR_AllInfoFrame1::outPres   ::width , ALTAIR_AllInfoFrame1::outTemp   ::width , ALTAIR_AllInfoFrame1::outHum    ::width ,
+    ALTAIR_AllInfoFrame1::inPres    ::width , ALTAIR_AllInfoFrame1::inTemp    ::width , ALTAIR_AllInfoFrame1::inHum     ::width ,
+    ALTAIR_AllInfoFrame1::balPres   ::width , ALTAIR_AllInfoFrame1::balTemp   ::width , ALTAIR_AllInfoFrame1::balHum    ::width ,
+    ALTAIR_AllInfoFrame1::accelZ    ::width , ALTAIR_AllInfoFrame1::accelX    ::width , ALTAIR_AllInfoFrame1::accelY    ::width ,
+    ALTAIR_AllInfoFrame1::separator2::width , ALTAIR_AllInfoFrame1::yaw       ::width , ALTAIR_AllInfoFrame1::pitch     ::width ,
+    ALTAIR_AllInfoFrame1::roll      ::width , ALTAIR_AllInfoFrame1::oSensTemp ::width , ALTAIR_AllInfoFrame1::typeInfo  ::width ,
+    1, 1, 1, 1,                                                                           // packedRPM
+    1, 1, 1, 1,                                                                           // packedCur
+    ALTAIR_AllInfoFrame1::separator3::width
+};
+
+static const uint8_t deltaFrame2Widths[] PROGMEM = {
+    1, 1, 1, 1, 1, 1, 1, 1,                                                               // packedTemp
+    ALTAIR_AllInfoFrame2::rssi      ::width , ALTAIR_AllInfoFrame2::bat1V     ::width , ALTAIR_AllInfoFrame2::bat2V     ::width ,
+    ALTAIR_AllInfoFrame2::separator1::width , ALTAIR_AllInfoFrame2::occSpace  ::width ,
+    ALTAIR_AllInfoFrame2::powerMot1 ::width , ALTAIR_AllInfoFrame2::powerMot2 ::width , ALTAIR_AllInfoFrame2::powerMot3 ::width ,
+    ALTAIR_AllInfoFrame2::powerMot4 ::width , ALTAIR_AllInfoFrame2::axlRotSet ::width , ALTAIR_AllInfoFrame2::axlRotAng ::width ,
+    ALTAIR_AllInfoFrame2::bleedVSet ::width , ALTAIR_AllInfoFrame2::bleedVAng ::width , ALTAIR_AllInfoFrame2::cutdwnSet ::width ,
+    ALTAIR_AllInfoFrame2::cutdwnAng ::width , ALTAIR_AllInfoFrame2::separator2::width , ALTAIR_AllInfoFrame2::lightStat ::width ,
+    ALTAIR_AllInfoFrame2::pd1ADRead ::width , ALTAIR_AllInfoFrame2::pd2ADRead ::width , ALTAIR_AllInfoFrame2::pd3ADRead ::width ,
+    ALTAIR_AllInfoFrame2::separator3::width
+};
+
+struct    ALTAIR_DeltaLayout {
+    const uint8_t*      widths                                              ;  // (in program memory, on an AVR)
+    uint8_t             numFields                                           ;
+    uint8_t             length                                              ;  // of the full frame's data
+};
+
+/**************************************************************************/
+/*!
+ @brief  The layout of a frame type (or NULL, for one that has no deltas).
+*/
+/**************************************************************************/
+inline const ALTAIR_DeltaLayout* deltaLayout( uint8_t frameType )
+{
+    static const ALTAIR_DeltaLayout layout1 = { deltaFrame1Widths, sizeof(deltaFrame1Widths), ALTAIR_AllInfoFrame1::length };
+    static const ALTAIR_DeltaLayout layout2 = { deltaFrame2Widths, sizeof(deltaFrame2Widths), ALTAIR_AllInfoFrame2::length };
+    if (frameType == DELTA_FRAME_TYPE_1) return &layout1;
+    if (frameType == DELTA_FRAME_TYPE_2) return &layout2;
+    return NULL;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The CRC-8 (polynomial 0x07, initial value 0) of some bytes.
+*/
+/**************************************************************************/
+inline uint8_t deltaCRC( const byte* data , uint8_t length )
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit) crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+    }
+    return crc;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A big-endian field of width bytes, as an unsigned number.
+*/
+/**************************************************************************/
+inline uint32_t deltaGetField( const byte* data , uint8_t width )
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < width; ++i) value = (value << 8) | data[i];
+    return value;
+}
+
+inline void deltaPutField( byte* data , uint8_t width , uint32_t value )
+{
+    for (uint8_t i = width; i > 0; --i) { data[i - 1] = (byte) (value & 0xFF); value >>= 8; }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Encode frame (of the given type) as a delta against key, into
+         delta (i.e. everything after the start and length bytes).
+         Returns its length, or 0 if it would be longer than maxLength
+         (in which case the frame should be sent in full instead).
+*/
+/**************************************************************************/
+inline uint8_t deltaEncode( uint8_t frameType , const byte* key , const byte* frame , byte* delta , uint8_t maxLength )
+{
+    const ALTAIR_DeltaLayout* layout = deltaLayout(frameType);
+    if (layout == NULL) return 0;
+    uint8_t bitmapLength = (layout->numFields + 7) / 8;
+    uint8_t length       = 2 + bitmapLength;
+    if (length + 1 > maxLength) return 0;
+    delta[0] = frameType;
+    delta[1] = deltaCRC(key, layout->length);
+    for (uint8_t i = 0; i < bitmapLength; ++i) delta[2 + i] = 0;
+
+    uint8_t offset = 0;
+    for (uint8_t f = 0; f < layout->numFields; ++f) {
+        uint8_t  width = pgm_read_byte(layout->widths + f);
+        uint32_t diff  = deltaGetField(frame + offset, width) - deltaGetField(key + offset, width);
+        offset += width;
+        if (width < 4) diff &= (((uint32_t) 1) << (8 * width)) - 1;
+        if (diff == 0) continue;
+        if (width < 4 && (diff & (((uint32_t) 1) << (8 * width - 1)))) diff |= ~((((uint32_t) 1) << (8 * width)) - 1);   // (as a signed difference)
+        uint32_t zigzag = (diff << 1) ^ (uint32_t) ((int32_t) diff >> 31);
+        delta[2 + f / 8] |= (byte) (1 << (f % 8));
+        do {
+            if (length + 1 >= maxLength) return 0;                          // (leaving room for the CRC)
+            byte b  = zigzag & 0x7F;
+            zigzag >>= 7;
+            delta[length++] = zigzag ? (b | 0x80) : b;
+        } while (zigzag);
+    }
+    delta[length++] = deltaCRC(frame, layout->length);
+    return length;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reconstruct a frame (of the type in delta[0]) from a delta and
+         that type's last keyframe.  Returns false (and leaves frame
+         undefined) if the delta is malformed, if it is against some
+         other keyframe, or if its CRC fails.
+*/
+/**************************************************************************/
+inline bool deltaDecode( const byte* key , const byte* delta , uint8_t deltaLength , byte* frame )
+{
+    const ALTAIR_DeltaLayout* layout = deltaLayout(delta[0]);
+    if (layout == NULL) return false;
+    uint8_t bitmapLength = (layout->numFields + 7) / 8;
+    uint8_t at           = 2 + bitmapLength;
+    if (deltaLength < at + 1 || delta[1] != deltaCRC(key, layout->length)) return false;
+    deltaLength -= 1;                                                       // (the CRC)
+
+    uint8_t offset = 0;
+    for (uint8_t f = 0; f < layout->numFields; ++f) {
+        uint8_t  width = pgm_read_byte(layout->widths + f);
+        uint32_t value = deltaGetField(key + offset, width);
+        if (delta[2 + f / 8] & (1 << (f % 8))) {
+            uint32_t zigzag = 0;
+            uint8_t  shift  = 0;
+            byte     b;
+            do {
+                if (at >= deltaLength || shift > 28) return false;
+                b       = delta[at++];
+                zigzag |= ((uint32_t) (b & 0x7F)) << shift;
+                shift  += 7;
+            } while (b & 0x80);
+            value += (zigzag >> 1) ^ (uint32_t) -(int32_t) (zigzag & 1);
+        }
+        deltaPutField(frame + offset, width, value);
+        offset += width;
+    }
+    return at == deltaLength && deltaCRC(frame, layout->length) == delta[deltaLength];
+}
+
+#endif    //   ifndef ALTAIR_TelemetryDelta_h
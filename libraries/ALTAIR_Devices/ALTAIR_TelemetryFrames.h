@@ -0,0 +1,229 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_TelemetryFrames.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This file contains the declarative, compile-time layout of the
+    telemetry frames that ALTAIR sends down to the ground stations (via
+    ALTAIR_GenTelInt::sendAllALTAIRInfo), and that the ground stations
+    decode (via ALTAIR_GenTelInt::groundStationPrintRxInfo).  Since both
+    sides use these same field definitions, they cannot drift apart.
+
+    Each field is a type that knows its own offset (within the frame's
+    data, i.e. just after the start byte and the length byte), width,
+    signedness, scale factor, and byte order.  Each field starts where
+    the previous one ends, so all offsets, as well as the length of each
+    frame, are computed by the compiler, and fields are serialized
+    directly into the transmit buffer without any intermediate copies.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_TelemetryFrames_h
+#define   ALTAIR_TelemetryFrames_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else                                         // (so that the host-side tools can decode frames and flight records)
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   FRAME_START_BYTE        0xFA        // (= TX_START_BYTE in ALTAIR_GenTelInt.h)
+#define   FRAME_HEADER_LENGTH        2        // the start byte, and then the length byte
+#define   FRAME_SEPARATOR          'T'
+
+/**************************************************************************/
+/*!
+    A single numeric field.  The value that is transmitted is the physical
+    value multiplied by SCALE_NUM / SCALE_DEN (and then truncated to an
+    integer); decode() undoes that scaling.  encode() scales an integer
+    value with integer arithmetic, and a floating-point one at its own
+    precision (on the Mega, a double is a float anyway; on a host, the
+    latitude and longitude keep all of their digits).
+*/
+/**************************************************************************/
+template < uint8_t OFFSET         ,
+           uint8_t WIDTH          ,
+           bool    IS_SIGNED      = false ,
+           int32_t SCALE_NUM      = 1     ,
+           int32_t SCALE_DEN      = 1     ,
+           bool    IS_BIG_ENDIAN  = true    >
+struct ALTAIR_FrameField {
+    enum { offset = OFFSET , width = WIDTH , end = OFFSET + WIDTH };
+
+    static void     put(          byte*  frameData , int32_t raw  ) {
+        for (uint8_t i = 0; i < WIDTH; ++i) {
+            uint8_t shift = 8 * (IS_BIG_ENDIAN ? (WIDTH - 1 - i) : i);
+            frameData[OFFSET + i] = byte((raw >> shift) & 0xFF);
+        }
+    }
+    static int32_t  get(    const byte*  frameData                ) {
+        uint32_t raw = 0;
+        for (uint8_t i = 0; i < WIDTH; ++i) {
+            uint8_t shift = 8 * (IS_BIG_ENDIAN ? (WIDTH - 1 - i) : i);
+            raw |= ((uint32_t) frameData[OFFSET + i]) << shift;
+        }
+        if (IS_SIGNED && WIDTH < 4 && (raw & (((uint32_t) 1) << (8*WIDTH - 1)))) raw |= ~((((uint32_t) 1) << (8*WIDTH)) - 1);  // sign-extend
+        return (int32_t) raw;
+    }
+    template < typename T >
+    static void     encode(       byte*  frameData , T       value) {
+        if      ((T) 0.5 == 0  ) put(frameData, (int32_t) value * SCALE_NUM / SCALE_DEN);                 // an integer (e.g. the GPS age): integer arithmetic
+        else if (SCALE_DEN == 1) put(frameData, (int32_t) (value * SCALE_NUM));                          // (in the value's own precision, so that a double latitude is not first rounded to a float)
+        else                     put(frameData, (int32_t) (value * ((T) SCALE_NUM / SCALE_DEN)));
+    }
+    static double   decode( const byte*  frameData                ) { return get(frameData) * ((double) SCALE_DEN / SCALE_NUM); }
+};
+
+/**************************************************************************/
+/*!
+    A run of COUNT consecutive single-byte values (e.g. the packed RPMs).
+*/
+/**************************************************************************/
+template < uint8_t OFFSET , uint8_t COUNT >
+struct ALTAIR_FrameByteArray {
+    enum { offset = OFFSET , width = COUNT , end = OFFSET + COUNT };
+
+    static void     put(          byte*  frameData , const byte* values ) { for (uint8_t i = 0; i < COUNT; ++i) frameData[OFFSET + i] = values[i]; }
+    static int8_t   get(    const byte*  frameData , uint8_t     index  ) { return (int8_t) frameData[OFFSET + index]; }
+};
+
+/**************************************************************************/
+/*!
+    A fixed 'T' separator byte.
+*/
+/**************************************************************************/
+template < uint8_t OFFSET >
+struct ALTAIR_FrameSeparator {
+    enum { offset = OFFSET , width = 1 , end = OFFSET + 1 };
+
+    static void     put(          byte*  frameData                ) { frameData[OFFSET] = FRAME_SEPARATOR; }
+    static bool     check(  const byte*  frameData                ) { return (frameData[OFFSET] == FRAME_SEPARATOR); }
+};
+
+/**************************************************************************/
+/*!
+    The first sendAllALTAIRInfo frame: GPS, the three BME280s, the
+    primary orientation sensor (with the fused yaw/pitch/roll of all of
+    them), and the packed propulsion RPMs/currents.
+*/
+/**************************************************************************/
+struct ALTAIR_AllInfoFrame1 {
+    typedef ALTAIR_FrameField<                       0 , 4 , true , 1000000 >  latitude    ;  // in millionths of a degree
+    typedef ALTAIR_FrameField<          latitude::end  , 4 , true , 1000000 >  longitude   ;  // in millionths of a degree
+    typedef ALTAIR_FrameField<         longitude::end  , 2 , true           >  elevation   ;  // in meters above mean sea level
+    typedef ALTAIR_FrameField<         elevation::end  , 1 , false, 1 , 256 >  age         ;  // in units of 256 milliseconds
+    typedef ALTAIR_FrameField<               age::end  , 1                  >  hdop        ;
+    typedef ALTAIR_FrameSeparator<          hdop::end                       >  separator1  ;
+    typedef ALTAIR_FrameField<        separator1::end  , 2 , false, 1 , 2   >  outPres     ;  // in units of 2 Pa
+    typedef ALTAIR_FrameField<           outPres::end  , 1 , true           >  outTemp     ;  // in degrees C
+    typedef ALTAIR_FrameField<           outTemp::end  , 1                  >  outHum      ;  // in %
+    typedef ALTAIR_FrameField<            outHum::end  , 2 , false, 1 , 2   >  inPres      ;
+    typedef ALTAIR_FrameField<            inPres::end  , 1 , true           >  inTemp      ;
+    typedef ALTAIR_FrameField<            inTemp::end  , 1                  >  inHum       ;
+    typedef ALTAIR_FrameField<             inHum::end  , 2 , false, 1 , 2   >  balPres     ;
+    typedef ALTAIR_FrameField<           balPres::end  , 1 , true           >  balTemp     ;
+    typedef ALTAIR_FrameField<           balTemp::end  , 1                  >  balHum      ;
+    typedef ALTAIR_FrameField<            balHum::end  , 1                  >  accelZ      ;  // as from ALTAIR_OrientSensor::accelZUInt8(), etc
+    typedef ALTAIR_FrameField<            accelZ::end  , 1                  >  accelX      ;
+    typedef ALTAIR_FrameField<            accelX::end  , 1                  >  accelY      ;
+    typedef ALTAIR_FrameSeparator<        accelY::end                       >  separator2  ;
+    typedef ALTAIR_FrameField<        separator2::end  , 1                  >  yaw         ;  // as from ALTAIR_OrientSensor::convertYawInt16ToUInt8(), etc, of the fused estimate
+    typedef ALTAIR_FrameField<               yaw::end  , 1                  >  pitch       ;
+    typedef ALTAIR_FrameField<             pitch::end  , 1                  >  roll        ;
+    typedef ALTAIR_FrameField<              roll::end  , 1 , true           >  oSensTemp   ;  // in degrees C
+    typedef ALTAIR_FrameField<         oSensTemp::end  , 1                  >  typeInfo    ;  // orient. sensor + 8 * GPS sensor + 32 * radio type & health
+    typedef ALTAIR_FrameByteArray<      typeInfo::end  , 4                  >  packedRPM   ;
+    typedef ALTAIR_FrameByteArray<     packedRPM::end  , 4                  >  packedCur   ;
+    typedef ALTAIR_FrameSeparator<     packedCur::end                       >  separator3  ;
+
+    enum { length = separator3::end };                                                        // = 43 bytes of data
+};
+
+/**************************************************************************/
+/*!
+    The second sendAllALTAIRInfo frame: the packed propulsion temps, RSSI,
+    battery voltages, SD card usage, motor and servo settings, and the
+    light source status and photodiode readings.
+*/
+/**************************************************************************/
+struct ALTAIR_AllInfoFrame2 {
+    typedef ALTAIR_FrameByteArray<                   0 , 8                  >  packedTemp  ;  // in units of 0.5 degrees C
+    typedef ALTAIR_FrameField<        packedTemp::end  , 1 , true           >  rssi        ;  // in dBm
+    typedef ALTAIR_FrameField<              rssi::end  , 1 , false, 1818, 100 > bat1V      ;  // in units of 55 mV
+    typedef ALTAIR_FrameField<             bat1V::end  , 1 , false, 1818, 100 > bat2V      ;
+    typedef ALTAIR_FrameSeparator<         bat2V::end                       >  separator1  ;
+    typedef ALTAIR_FrameField<        separator1::end  , 2                  >  occSpace    ;  // in Mb
+    typedef ALTAIR_FrameField<          occSpace::end  , 1 , false, 10      >  powerMot1   ;  // 10x the power setting
+    typedef ALTAIR_FrameField<         powerMot1::end  , 1 , false, 10      >  powerMot2   ;
+    typedef ALTAIR_FrameField<         powerMot2::end  , 1 , false, 10      >  powerMot3   ;
+    typedef ALTAIR_FrameField<         powerMot3::end  , 1 , false, 10      >  powerMot4   ;
+    typedef ALTAIR_FrameField<         powerMot4::end  , 1 , false, 10      >  axlRotSet   ;  // 10x the servo setting
+    typedef ALTAIR_FrameField<         axlRotSet::end  , 1 , false, 50      >  axlRotAng   ;  // in units of 20 mV
+    typedef ALTAIR_FrameField<         axlRotAng::end  , 1 , false, 10      >  bleedVSet   ;
+    typedef ALTAIR_FrameField<         bleedVSet::end  , 1 , false, 50      >  bleedVAng   ;
+    typedef ALTAIR_FrameField<         bleedVAng::end  , 1 , false, 10      >  cutdwnSet   ;
+    typedef ALTAIR_FrameField<         cutdwnSet::end  , 1 , false, 50      >  cutdwnAng   ;
+    typedef ALTAIR_FrameSeparator<     cutdwnAng::end                       >  separator2  ;
+    typedef ALTAIR_FrameField<        separator2::end  , 1                  >  lightStat   ;
+    typedef ALTAIR_FrameField<         lightStat::end  , 2                  >  pd1ADRead   ;
+    typedef ALTAIR_FrameField<         pd1ADRead::end  , 2                  >  pd2ADRead   ;
+    typedef ALTAIR_FrameField<         pd2ADRead::end  , 2                  >  pd3ADRead   ;
+    typedef ALTAIR_FrameSeparator<     pd3ADRead::end                       >  separator3  ;
+
+    enum { length = separator3::end };                                                        // = 33 bytes of data
+};
+
+/**************************************************************************/
+/*!
+    The extended propulsion frame, which is only sent (after the second
+    frame) when the Arduino Micro's 16-bit readings are being read (see
+    ALTAIR_ArduinoMicro::setExtended): the Micro's snapshot sequence
+    number and age, and then the RPMs, currents and temps at full
+    resolution, rather than as the packed bytes of the first two frames.
+*/
+/**************************************************************************/
+struct ALTAIR_PropulsionFrame {
+    typedef ALTAIR_FrameField<                       0 , 1                  >  microSeq    ;  // the Micro's snapshot sequence number
+    typedef ALTAIR_FrameField<          microSeq::end  , 2                  >  microAge    ;  // in ms
+    typedef ALTAIR_FrameField<          microAge::end  , 2                  >  rpm1        ;  // in RPM
+    typedef ALTAIR_FrameField<              rpm1::end  , 2                  >  rpm2        ;
+    typedef ALTAIR_FrameField<              rpm2::end  , 2                  >  rpm3        ;
+    typedef ALTAIR_FrameField<              rpm3::end  , 2                  >  rpm4        ;
+    typedef ALTAIR_FrameSeparator<          rpm4::end                       >  separator1  ;
+    typedef ALTAIR_FrameField<        separator1::end  , 2 , true , 100     >  current1    ;  // in units of 10 mA
+    typedef ALTAIR_FrameField<          current1::end  , 2 , true , 100     >  current2    ;
+    typedef ALTAIR_FrameField<          current2::end  , 2 , true , 100     >  current3    ;
+    typedef ALTAIR_FrameField<          current3::end  , 2 , true , 100     >  current4    ;
+    typedef ALTAIR_FrameSeparator<      current4::end                       >  separator2  ;
+    typedef ALTAIR_FrameField<        separator2::end  , 2 , true , 10      >  temp1       ;  // in units of 0.1 degrees C
+    typedef ALTAIR_FrameField<             temp1::end  , 2 , true , 10      >  temp2       ;
+    typedef ALTAIR_FrameField<             temp2::end  , 2 , true , 10      >  temp3       ;
+    typedef ALTAIR_FrameField<             temp3::end  , 2 , true , 10      >  temp4       ;
+    typedef ALTAIR_FrameField<             temp4::end  , 2 , true , 10      >  temp5       ;
+    typedef ALTAIR_FrameField<             temp5::end  , 2 , true , 10      >  temp6       ;
+    typedef ALTAIR_FrameField<             temp6::end  , 2 , true , 10      >  temp7       ;
+    typedef ALTAIR_FrameField<             temp7::end  , 2 , true , 10      >  temp8       ;
+    typedef ALTAIR_FrameSeparator<         temp8::end                       >  separator3  ;
+
+    enum { length = separator3::end };                                                        // = 38 bytes of data
+
+// (the RPMs, currents and temps are each consecutive, so they can also be got by index)
+    static void     putRPM(           byte*  frameData , uint8_t i , uint16_t value ) { ALTAIR_FrameField< rpm1::offset , 2 >::put(frameData + 2*i, value); }
+    static uint16_t getRPM(     const byte*  frameData , uint8_t i                  ) { return (uint16_t) ALTAIR_FrameField< rpm1::offset , 2 >::get(frameData + 2*i); }
+    static void     putCurrent(       byte*  frameData , uint8_t i , int16_t  value ) { ALTAIR_FrameField< current1::offset , 2 , true >::put(frameData + 2*i, value); }
+    static int16_t  getCurrent( const byte*  frameData , uint8_t i                  ) { return (int16_t) ALTAIR_FrameField< current1::offset , 2 , true >::get(frameData + 2*i); }
+    static void     putTemp(          byte*  frameData , uint8_t i , int16_t  value ) { ALTAIR_FrameField< temp1::offset , 2 , true >::put(frameData + 2*i, value); }
+    static int16_t  getTemp(    const byte*  frameData , uint8_t i                  ) { return (int16_t) ALTAIR_FrameField< temp1::offset , 2 , true >::get(frameData + 2*i); }
+};
+
+#define   MAX_FRAME_DATA_LENGTH       ALTAIR_AllInfoFrame1::length
+
+#endif    //   ifndef ALTAIR_TelemetryFrames_h
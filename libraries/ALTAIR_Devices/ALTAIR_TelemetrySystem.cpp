@@ -23,6 +23,26 @@
 /**************************************************************************/
 
 #include "ALTAIR_TelemetrySystem.h"
+#include "ALTAIR_GlobalMotorControl.h"
+#include "ALTAIR_GlobalDeviceControl.h"
+#include "ALTAIR_GlobalLightControl.h"
+#include "ALTAIR_ArduinoMicro.h"
+#include <ALTAIR_HAL.h>
+
+// Each radio's link: its throughput, its overhead per frame, the share of it for telemetry, and the minimum interval between sends.
+// (The RFM23BP's send waits until its packet is out, so it is kept to a small share of its link.)
+static const ALTAIR_LinkConfig linkConfigs[NUM_TELEMETRY_RADIOS] = {
+    { DNT900_SERIAL_BAUDRATE / 10 ,                        0 , 50 ,  250 },      // dnt900  (the UART is slower than the RF link)
+    { SHX144_SERIAL_BAUDRATE / 10 ,                        0 , 60 ,  500 },      // shx144
+    { RFM23BP_DATA_RATE / 8       ,  RFM23BP_PACKET_OVERHEAD , 25 , 1000 },      // rfm23bp
+};
+
+// Each radio's sensitivity, and the RSSI at which its link has a full margin (in dBm), for its link quality.
+static const int8_t linkQualityConfigs[NUM_TELEMETRY_RADIOS][2] = {
+    { -108 , -78 },                                                              // dnt900
+    { -118 , -88 },                                                              // shx144
+    { -116 , -86 },                                                              // rfm23bp
+};
 
 /**************************************************************************/
 /*!
@@ -36,6 +56,12 @@ ALTAIR_TelemetrySystem::ALTAIR_TelemetrySystem()
     _primaryRadio       = &_dnt900  ;
     _firstBackupRadio   = &_shx144  ;
     _secondBackupRadio  = &_rfm23bp ;
+    _fanOut             = false     ;
+    _statusSequence     = 0         ;
+    _autoFailover       = false     ;
+    memset(_radioOn,      0, sizeof(_radioOn));
+    memset(_rssiMillis,   0, sizeof(_rssiMillis));
+    memset(&_fanOutStats, 0, sizeof(_fanOutStats));
 }
 
 /**************************************************************************/
@@ -45,12 +71,22 @@ ALTAIR_TelemetrySystem::ALTAIR_TelemetrySystem()
 /**************************************************************************/
 void ALTAIR_TelemetrySystem::initialize( bool backupRadiosOn , bool backupRadio2On )
 {
+  ALTAIR_GenTelInt* radios[NUM_TELEMETRY_RADIOS] = { &_dnt900, &_shx144, &_rfm23bp };
+  for (uint8_t i = 0; i < NUM_TELEMETRY_RADIOS; ++i) {
+    ALTAIR_LinkRateController* link   = linkRate(radios[i]);
+    ALTAIR_LinkConfig          config = linkConfigs[radios[i]->radioType()];
+    if (radios[i] == &_dnt900 && _dnt900.protocolMode()) config.frameOverhead = DNT_TX_DATA_OVERHEAD;   // (at most: frames sent together share a packet)
+    link->configure(config, 2 * FRAME_HEADER_LENGTH + ALTAIR_AllInfoFrame1::length + ALTAIR_AllInfoFrame2::length);
+    radios[i]->setReducedContent(link->content() == LINK_CONTENT_REDUCED);
+  }
+
   Serial.println(F("Starting DNT900 radio setup..."));
   if (!_dnt900.initialize()) {
     Serial.println(F("DNT900 radio init failed"));
     while(1);
   }
   Serial.println(F("DNT900 radio setup complete."));
+  _radioOn[_dnt900.radioType() ] = true;
 
   if (backupRadiosOn) {
     Serial.println(F("Starting SHX1 serial modem radio setup..."));
@@ -59,9 +95,10 @@ void ALTAIR_TelemetrySystem::initialize( bool backupRadiosOn , bool backupRadio2
       while(1);
     }
     Serial.println(F("SHX1 serial modem radio setup complete."));
+    _radioOn[_shx144.radioType() ] = true;
 
 //    delay(100);
-    delay(10);
+    ALTAIR_HAL::clockDelay(10);
 
     if (backupRadio2On) {
       Serial.println(F("Initializing SPI bus RFM23BP radio (433 MHz, antenna on top of gondola) ..."));
@@ -69,8 +106,15 @@ void ALTAIR_TelemetrySystem::initialize( bool backupRadiosOn , bool backupRadio2
         Serial.println(F("RFM23BP radio init failed"));
         while(1);
       }
+      _radioOn[_rfm23bp.radioType()] = true;
     }
   }
+
+  for (uint8_t i = 0; i < NUM_TELEMETRY_RADIOS; ++i) {
+    radio_t type = radios[i]->radioType();
+    _linkQuality.configure(   type, linkQualityConfigs[type][0], linkQualityConfigs[type][1]);
+    _linkQuality.setListening(type, _radioOn[type]);
+  }
 }
 
 /**************************************************************************/
@@ -95,6 +139,7 @@ void ALTAIR_TelemetrySystem::switchToBackup1(                              )
      } else {
                    _firstBackupRadio  = &_dnt900;
      }
+     _linkQuality.primaryChanged(ALTAIR_HAL::clockMillis());
 }
 
 /**************************************************************************/
@@ -111,6 +156,116 @@ void ALTAIR_TelemetrySystem::switchToBackup2(                              )
      } else {
                   _secondBackupRadio  = &_shx144;
      }
+     _linkQuality.primaryChanged(ALTAIR_HAL::clockMillis());
+}
+
+/**************************************************************************/
+/*!
+ @brief  Switch the primary radio to the given one (which must be one of
+         the backups).
+*/
+/**************************************************************************/
+void ALTAIR_TelemetrySystem::switchPrimaryTo( ALTAIR_GenTelInt* radio     )
+{
+     if      (radio == backup1()) switchToBackup1();
+     else if (radio == backup2()) switchToBackup2();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Feed each radio's latest RSSI reading (if it has a new one) to
+         the link-quality tracker, close any heartbeat periods that are
+         over, and then (with automatic failover on) switch the primary
+         radio, if the failover policy says to.  Returns true if it
+         switched.
+*/
+/**************************************************************************/
+bool ALTAIR_TelemetrySystem::updateLinkQuality( unsigned long now          )
+{
+     ALTAIR_GenTelInt* radios[NUM_TELEMETRY_RADIOS] = { &_dnt900, &_shx144, &_rfm23bp };
+     for (uint8_t i = 0; i < NUM_TELEMETRY_RADIOS; ++i) {
+         radio_t       type       = radios[i]->radioType();
+         unsigned long rssiMillis = radios[i]->lastRSSIMillis();
+         char          rssi       = radios[i]->lastRSSI();
+         if (!_radioOn[type] || rssiMillis == _rssiMillis[type] || rssi == FAKE_RSSI_VAL) continue;
+         _linkQuality.rssiHeard(type, rssi, rssiMillis);
+         _rssiMillis[type] = rssiMillis;
+     }
+     _linkQuality.update(now);
+     if (!_autoFailover) return false;
+
+     int8_t target = _linkQuality.choosePrimary(_primaryRadio->radioType(), now);
+     if (target < 0) return false;
+     Serial.print(F("link quality: switching the primary radio from ")); Serial.print(_primaryRadio->radioName());
+     Serial.print(F(" to "));                                             Serial.println(radios[target]->radioName());
+     switchPrimaryTo(radios[target]);
+     return true;
 }
 
+/**************************************************************************/
+/*!
+ @brief  One fan-out cycle: if any radio that is on is due to send (per
+         its link rate controller), build the status frames, just once,
+         and hand them to each such radio in turn, to send as many of
+         them as it has room for right now.  (Frame 2's RSSI is the
+         primary radio's.)  Returns the # of radios that sent.
+*/
+/**************************************************************************/
+uint8_t ALTAIR_TelemetrySystem::fanOutStatus( unsigned long               now           ,
+                                              ALTAIR_GlobalMotorControl&  motorControl  ,
+                                              ALTAIR_GlobalDeviceControl& deviceControl ,
+                                              ALTAIR_GlobalLightControl&  lightControl   )
+{
+     ALTAIR_GenTelInt* radios[NUM_TELEMETRY_RADIOS] = { &_dnt900, &_shx144, &_rfm23bp };
+     unsigned long     startMicros = ALTAIR_HAL::clockMicros();
+     bool              built       = false;
+     bool              extended    = false;
+     uint8_t           sentTo      = 0;
+
+     for (uint8_t i = 0; i < NUM_TELEMETRY_RADIOS; ++i) {
+         ALTAIR_GenTelInt*          radio = radios[i];
+         ALTAIR_LinkRateController* link  = linkRate(radio);
+         if (!_radioOn[radio->radioType()] || link->millisUntilDue(now, radio->txBacklogged()) > 0) continue;
+         if (!built) {
+             _primaryRadio->fillAllInfoFrame1(_status1, deviceControl);
+             _primaryRadio->fillAllInfoFrame2(_status2, motorControl, deviceControl, lightControl);
+             extended = deviceControl.sitAwareSystem()->arduinoMicro()->extended();
+             if (extended) _primaryRadio->fillPropulsionFrame(_statusPropulsion, deviceControl);
+             _statusSequence = (_statusSequence + 1) & FANOUT_SEQUENCE_MASK;
+             built           = true;
+         }
+         if (radio->fanOutStatus(_status1, _status2, extended ? _statusPropulsion : NULL, _statusSequence) > 0) {
+             link->sent(now, radio->lastSendBytes(), radio->lastSendFrames());
+             ++sentTo;
+         }
+     }
 
+     if (built) {
+         unsigned long elapsed     = ALTAIR_HAL::clockMicros() - startMicros;
+         ++_fanOutStats.cycles;
+         _fanOutStats.radioSends  += sentTo;
+         _fanOutStats.lastMicros   = elapsed;
+         _fanOutStats.totalMicros += elapsed;
+         if (elapsed > _fanOutStats.maxMicros) _fanOutStats.maxMicros = elapsed;
+     }
+     return sentTo;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) each radio's link rate statistics.
+*/
+/**************************************************************************/
+void ALTAIR_TelemetrySystem::printLinkStats(                               )
+{
+     linkRate(&_dnt900 )->printStats(_dnt900.radioName() );
+     linkRate(&_shx144 )->printStats(_shx144.radioName() );
+     linkRate(&_rfm23bp)->printStats(_rfm23bp.radioName());
+     const char* names[NUM_TELEMETRY_RADIOS] = { _dnt900.radioName(), _shx144.radioName(), _rfm23bp.radioName() };
+     _linkQuality.printStats(names);
+     if (_fanOutStats.cycles == 0) return;
+     Serial.println(F("Fan-out statistics:"));
+     Serial.print(F("   cycles / radio sends: "));         Serial.print(_fanOutStats.cycles); Serial.print(F(" / ")); Serial.println(_fanOutStats.radioSends);
+     Serial.print(F("   time last/mean/max (us): "));      Serial.print(_fanOutStats.lastMicros); Serial.print(F("/"));
+     Serial.print(_fanOutStats.totalMicros / _fanOutStats.cycles); Serial.print(F("/")); Serial.println(_fanOutStats.maxMicros);
+}
@@ -11,6 +11,26 @@
     the payload), and the RFM23BP (which operates at 440 MHz, and has its
     half-wave antenna on the topside of the payload).
 
+    Each radio has its own link rate controller (see
+    ALTAIR_LinkRateController.h), configured from its link's throughput,
+    which decides how often it sends, and whether it sends both telemetry
+    frames each time or just one (alternately).
+
+    In fan-out mode, the status frames are built just once per cycle, and
+    are then pushed to every radio that is on (and whose link is due), in
+    a single pass that never waits for a radio: each radio's encoder
+    sends as many of them as the radio has room for right now, each with
+    the cycle's sequence number, so that the ground stations can merge
+    what they receive via the different radios (see ALTAIR_LinkEncoder.h).
+    So if the primary radio's link fades, the status still gets through
+    on the others, without waiting for an 'R' or 'r' command.
+
+    Each radio's link quality (its RSSI, and how reliably commands and
+    heartbeats come up via it) is tracked (see ALTAIR_LinkQuality.h), and
+    with automatic failover on, updateLinkQuality switches the primary
+    radio to the best link once the primary's has been failing for long
+    enough, and back to a preferred radio once its link has recovered.
+
     This class is instantiated as a singleton via the instantiation of the
     (also singleton) ALTAIR_GlobalDeviceControl class.
 
@@ -29,6 +49,22 @@
 #include "ALTAIR_DNT900.h"
 #include "ALTAIR_SHX144.h"
 #include "ALTAIR_RFM23BP.h"
+#include "ALTAIR_LinkRateController.h"
+#include "ALTAIR_LinkQuality.h"
+
+#define   NUM_TELEMETRY_RADIOS    3
+
+class     ALTAIR_GlobalMotorControl;
+class     ALTAIR_GlobalDeviceControl;
+class     ALTAIR_GlobalLightControl;
+
+struct    ALTAIR_FanOutStats {
+    unsigned long       cycles                                                      ;  // in which the frames were built
+    unsigned long       radioSends                                                  ;  // # of (cycle, radio) pairs with a frame sent
+    unsigned long       lastMicros                                                  ;  // spent in the last cycle
+    unsigned long       maxMicros                                                   ;
+    unsigned long       totalMicros                                                 ;  // divide by cycles to get the mean
+};
 
 class     ALTAIR_TelemetrySystem {
   public:
@@ -43,14 +79,32 @@ class     ALTAIR_TelemetrySystem {
     ALTAIR_GenTelInt*        backup1(        ) { return   _firstBackupRadio                   ; }
     ALTAIR_GenTelInt*        backup2(        ) { return  _secondBackupRadio                   ; }
 
+    ALTAIR_LinkRateController* linkRate( ALTAIR_GenTelInt* radio ) { return &_linkRate[radio->radioType()] ; }
+
     void                     initialize(         bool    backupRadiosOn    = true ,
                                                  bool    backupRadio2On    = true           ) ;
     void                     switchToBackup1()                                                ;
     void                     switchToBackup2()                                                ;
+    void                     printLinkStats()                                                 ;
+
+    ALTAIR_LinkQuality*      linkQuality(                                                   ) { return &_linkQuality                   ; }
+    void                     setAutoFailover(    bool    on                                 ) { _autoFailover = on                     ; }
+    bool                     autoFailover(                                                  ) { return _autoFailover                   ; }
+    bool                     updateLinkQuality(  unsigned long               now          ) ; // Returns true if it switched the primary radio.
+
+    void                     setFanOut(          bool    on                                 ) { _fanOut = on                           ; }
+    bool                     fanOut(                                                        ) { return _fanOut                         ; }
+    uint8_t                  fanOutStatus(       unsigned long               now          ,   // Returns the # of radios that sent.
+                                                 ALTAIR_GlobalMotorControl&  motorControl ,
+                                                 ALTAIR_GlobalDeviceControl& deviceControl,
+                                                 ALTAIR_GlobalLightControl&  lightControl ) ;
+    const ALTAIR_FanOutStats* fanOutStats(                                                  ) { return &_fanOutStats                   ; }
 
   protected:
 
   private:
+    void                     switchPrimaryTo(    ALTAIR_GenTelInt*           radio        ) ;
+
     ALTAIR_DNT900            _dnt900                                                          ;
     ALTAIR_SHX144            _shx144                                                          ;
     ALTAIR_RFM23BP           _rfm23bp                                                         ;
@@ -59,5 +113,17 @@ class     ALTAIR_TelemetrySystem {
     ALTAIR_GenTelInt*         _firstBackupRadio                                               ;
     ALTAIR_GenTelInt*        _secondBackupRadio                                               ;
 
+    ALTAIR_LinkRateController _linkRate[NUM_TELEMETRY_RADIOS]                                 ;  // (by radio_t)
+    bool                     _radioOn[NUM_TELEMETRY_RADIOS]                                  ;  // (by radio_t) initialized
+    bool                     _fanOut                                                          ;
+    uint8_t                  _statusSequence                                                  ;
+    byte                     _status1[ALTAIR_AllInfoFrame1::length]                           ;  // the status frames of the last fan-out cycle
+    byte                     _status2[ALTAIR_AllInfoFrame2::length]                           ;
+    byte                     _statusPropulsion[ALTAIR_PropulsionFrame::length]                ;
+    ALTAIR_FanOutStats       _fanOutStats                                                     ;
+    ALTAIR_LinkQuality       _linkQuality                                                     ;
+    bool                     _autoFailover                                                    ;
+    unsigned long            _rssiMillis[NUM_TELEMETRY_RADIOS]                               ;  // (by radio_t) of the last RSSI fed to _linkQuality
+
 };
 #endif    //   ifndef ALTAIR_TelemetrySystem_h
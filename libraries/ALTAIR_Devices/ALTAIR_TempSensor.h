@@ -4,7 +4,10 @@
     @author   Justin Albert (jalbert@uvic.ca)
     @license  GPL
 
-    This is the class of each temperature sensor in ALTAIR. 
+    This is the class of each temperature sensor in ALTAIR.  The 8
+    propulsion system ones are read by the Arduino Micro, and set from its
+    readings, either packed (in half-degrees, saturating at 63.5 degrees C)
+    or extended (in tenths of a degree).
 
     Justin Albert  jalbert@uvic.ca     began on 2 Sep. 2018
 
@@ -17,7 +20,12 @@
 #ifndef ALTAIR_TempSensor_h
 #define ALTAIR_TempSensor_h
 
-#include "Arduino.h"
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
 
 class ALTAIR_TempSensor {
   public:
@@ -26,6 +34,8 @@ class ALTAIR_TempSensor {
 
     float                   temp(               )  { return _temp        ; }
     void                    setTemp( float temp )  {        _temp = temp ; }
+    void                    setFromPacked(   byte    packedTemp ) { _temp = 0.5 * (int8_t) packedTemp ; }
+    void                    setFromExtended( int16_t deciC      ) { _temp = 0.1 * deciC               ; }
 
   private:
     float                  _temp                                         ;   // in degrees Celsius
@@ -17,10 +17,14 @@
 */
 /**************************************************************************/
 
+#include <string.h>
 #include "ALTAIR_UM7.h"
 
 #define   RX_READ_LENGTH     200
 #define   RX_READ_ATTEMPTS   500
+#define   RX_READ_TIMEOUT   1000          // in milliseconds (as Stream::readBytes())
+
+ALTAIR_UM7* ALTAIR_UM7::_theUM7 = 0;
 
 /**************************************************************************/
 /*!
@@ -28,8 +32,17 @@
 */
 /**************************************************************************/
 ALTAIR_UM7::ALTAIR_UM7(  const char serialID ) :
-    _serialID(                      serialID )
+    _serialID(                      serialID ) ,
+    _uart(ALTAIR_HAL::uart(         serialID)) ,
+    _dataPacketMillis(                     0 ) ,
+    _healthPacketMillis(                   0 ) ,
+    _gpsPacketMillis(                      0 ) ,
+    _gpsPacketMillisLastReturned(          0 )
 {
+    memset(&_lastGoodDataPacket,   0, sizeof(_lastGoodDataPacket)  );
+    memset(&_lastGoodHealthPacket, 0, sizeof(_lastGoodHealthPacket));
+    memset(&_lastGoodGPSPacket,    0, sizeof(_lastGoodGPSPacket)   );
+    _theUM7 = this;
 }
 
 /**************************************************************************/
@@ -38,34 +51,65 @@ ALTAIR_UM7::ALTAIR_UM7(  const char serialID ) :
 */
 /**************************************************************************/
 ALTAIR_UM7::ALTAIR_UM7(                      ) :
-    _serialID(          DEFAULT_UM7_SERIALID )
+    _serialID(          DEFAULT_UM7_SERIALID ) ,
+    _uart(ALTAIR_HAL::uart(DEFAULT_UM7_SERIALID)) ,
+    _dataPacketMillis(                     0 ) ,
+    _healthPacketMillis(                   0 ) ,
+    _gpsPacketMillis(                      0 ) ,
+    _gpsPacketMillisLastReturned(          0 )
 {
+    memset(&_lastGoodDataPacket,   0, sizeof(_lastGoodDataPacket)  );
+    memset(&_lastGoodHealthPacket, 0, sizeof(_lastGoodHealthPacket));
+    memset(&_lastGoodGPSPacket,    0, sizeof(_lastGoodGPSPacket)   );
+    _theUM7 = this;
 }
 
 /**************************************************************************/
 /*!
- @brief  Initialization (starts serial and checks health).  
+ @brief  Return the UART that the UM7 is connected to (or, if the serial
+         ID is not allowed, print an error and halt).
 */
 /**************************************************************************/
-void ALTAIR_UM7::initialize()
+ALTAIR_HALUart* ALTAIR_UM7::uart()
 {
-    switch (_serialID) {
-      case 0:
-        Serial.begin(  115200, SERIAL_8N1 );
-        break;
-      case 1:
-        Serial1.begin( 115200, SERIAL_8N1 );
-        break;
-      case 2:
-        Serial2.begin( 115200, SERIAL_8N1 );
-        break;
-      case 3:
-        Serial3.begin( 115200, SERIAL_8N1 );
-        break;
-      default:
+    if (_uart == NULL) {
+#ifdef    ARDUINO
         Serial.println(F("Unallowed serial ID provided in initialization of UM7 orientation sensor!"));
+#endif
         while(1);
     }
+    return _uart;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Read up to length bytes, waiting (as Stream::readBytes() does)
+         for up to RX_READ_TIMEOUT for each.  Returns the # read.
+*/
+/**************************************************************************/
+static int readBytes( ALTAIR_HALUart* port, byte* bytes, int length )
+{
+    int           nRead      = 0;
+    unsigned long lastMillis = ALTAIR_HAL::clockMillis();
+    while (nRead < length && ALTAIR_HAL::clockMillis() - lastMillis < RX_READ_TIMEOUT) {
+      if (port->available()) {
+        bytes[nRead++] = port->read();
+        lastMillis     = ALTAIR_HAL::clockMillis();
+      } else {
+        ALTAIR_HAL::clockDelay(1);
+      }
+    }
+    return nRead;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Initialization (starts serial and checks health).  
+*/
+/**************************************************************************/
+void ALTAIR_UM7::initialize()
+{
+    uart()->begin( UM7_BAUD_RATE );
     setIncomingGPSBaudRate();
     checkUM7Health();
 }
@@ -79,8 +123,7 @@ void ALTAIR_UM7::checkUM7Health()
 {
     byte tx_data[7];
     byte rx_data[RX_READ_LENGTH];
-    int  returnVal, nAttempts = 0;
-    bool dataReceived = false;
+    int  returnVal, rx_length = 0, nAttempts = 0;
     struct UM7packet new_packet;
     tx_data[0] = 's';  // Send
     tx_data[1] = 'n';  // New
@@ -89,48 +132,19 @@ void ALTAIR_UM7::checkUM7Health()
     tx_data[4] = 0x55; // address of DREG_HEALTH sensor health info register
     tx_data[5] = 0x01; // checksum high byte
     tx_data[6] = 0xA6; // checksum low byte  
+    ALTAIR_HALUart* port = uart();
     while (nAttempts < RX_READ_ATTEMPTS) {
-      switch (_serialID) {
-        case 0:
-          if (Serial.available()) {
-            Serial.write(  tx_data, 7 );
-            Serial.readBytes(  rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          } 
-          break;
-        case 1:
-          if (Serial1.available()) {
-            Serial1.write( tx_data, 7 );
-            Serial1.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 2:
-          if (Serial2.available()) {
-            Serial2.write( tx_data, 7 );
-            Serial2.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 3:
-          if (Serial3.available()) {
-            Serial3.write( tx_data, 7 );
-            Serial3.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        default:
-          Serial.println(F("Unallowed serial ID provided in initialization of UM7 orientation sensor!"));
-          while(1);
-      }
-      if (dataReceived) {
+      if (port->available()) {
+        port->write( tx_data, 7 );
+        rx_length = readBytes( port, rx_data, RX_READ_LENGTH );
         break;
       } else {
         ++nAttempts;
       }
     }
-    returnVal  = parse_serial_data(rx_data, RX_READ_LENGTH, tx_data[4], &new_packet);
+    returnVal  = parse_serial_data(rx_data, rx_length, tx_data[4], &new_packet);
     if ( returnVal == 0 ) {
+#ifdef    ARDUINO
       // Extract health info ...
       float sats_used_byte = -999., hdop_byte = -999., sats_in_view_byte = -999., sensors_byte = -999.;
       sats_used_byte    = new_packet.data[0];
@@ -140,6 +154,7 @@ void ALTAIR_UM7::checkUM7Health()
       // ... and print it out.
       Serial.print("sats_used_byte = "); Serial.print(sats_used_byte); Serial.print("    hdop_byte = "); Serial.print(hdop_byte);
          Serial.print("    sats_in_view_byte = "); Serial.print(sats_in_view_byte); Serial.print("    sensors_byte = "); Serial.println(sensors_byte);
+#endif
     }
 }
 
@@ -152,7 +167,6 @@ void ALTAIR_UM7::setIncomingGPSBaudRate()
 {
     byte tx_data[11];
     int  nAttempts = 0;
-    bool dataSent  = false;
     tx_data[0]  = 's';  // Send
     tx_data[1]  = 'n';  // New
     tx_data[2]  = 'p';  // Packet
@@ -164,37 +178,10 @@ void ALTAIR_UM7::setIncomingGPSBaudRate()
     tx_data[8]  = 0x00; // 
     tx_data[9]  = 0x02; // checksum high byte
     tx_data[10] = 0x24; // checksum low byte  
+    ALTAIR_HALUart* port = uart();
     while (nAttempts < RX_READ_ATTEMPTS) {
-      switch (_serialID) {
-        case 0:
-          if (Serial.availableForWrite() >= 11) {
-            Serial.write(  tx_data, 11 );
-            dataSent = true;
-          } 
-          break;
-        case 1:
-          if (Serial1.availableForWrite() >= 11) {
-            Serial1.write( tx_data, 11 );
-            dataSent = true;
-          }
-          break;
-        case 2:
-          if (Serial2.availableForWrite() >= 11) {
-            Serial2.write( tx_data, 11 );
-            dataSent = true;
-          }
-          break;
-        case 3:
-          if (Serial3.availableForWrite() >= 11) {
-            Serial3.write( tx_data, 11 );
-            dataSent = true;
-          }
-          break;
-        default:
-          Serial.println(F("Unallowed serial ID provided in initialization of UM7 orientation sensor!"));
-          while(1);
-      }
-      if (dataSent) {
+      if (port->availableForWrite() >= 11) {
+        port->write( tx_data, 11 );
         break;
       } else {
         ++nAttempts;
@@ -204,141 +191,122 @@ void ALTAIR_UM7::setIncomingGPSBaudRate()
 
 /**************************************************************************/
 /*!
- @brief  Get the main data packet (containing the orientation and acceleration 
-         info).  This can then be followed by the static member fuctions 
-         (for example, getYaw(struct UM7packet dataPacket)) that parse the 
-         data packet into its individual pieces of info.
+ @brief  Read every byte that is presently waiting in the serial RX
+         buffer (which the UART receive interrupt fills in the background)
+         into the packet parser, and keep the latest good data, health,
+         and GPS packets.  This never waits for bytes that have not yet
+         arrived, and it also catches any packets that the UM7 broadcasts
+         without having been asked.  Then, if the reply to the last request
+         is in (or has timed out), the next request that is wanted is
+         written, so that only one reply is ever on its way: the RX buffer
+         cannot hold even that one, so this must be called every few
+         milliseconds (as ALTAIROperation's "UM7 serial" task does).
 */
 /**************************************************************************/
-struct UM7packet ALTAIR_UM7::getDataPacket() {
-
-    byte tx_data[20];
-    byte rx_data[RX_READ_LENGTH];
-    int  returnVal, nAttempts = 0;
-    bool dataReceived = false;
-    tx_data[0] = 's';  // Send
-    tx_data[1] = 'n';  // New
-    tx_data[2] = 'p';  // Packet
-    tx_data[3] = 0x7C; // get a batch of 16 register words (= 64 bytes)
-    tx_data[4] = 0x65; // start with the processed accelerometer info: address of DREG_ACCEL_PROC_X register
-    tx_data[5] = 0x02; // checksum high byte
-    tx_data[6] = 0x32; // checksum low byte
-
-    while (nAttempts < RX_READ_ATTEMPTS) {
-      switch (_serialID) {
-        case 0:
-          if (Serial.available()) {
-            Serial.write(  tx_data, 7 );
-            Serial.readBytes(  rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
+void ALTAIR_UM7::serviceSerial() {
+
+    ALTAIR_HALUart* port   = uart();
+    int             nBytes = 0;
+    while (port->available() && nBytes < UM7_MAX_BYTES_PER_SERVICE) {
+      ++nBytes;
+      if (!_parser.parseByte(port->read(), &_newPacket)) continue;
+      _requests.arrived(_newPacket.Address, ALTAIR_HAL::clockMillis());
+      switch (_newPacket.Address) {
+        case UM7_DATA_ADDRESS:
+          if (_newPacket.data_length < UM7_DATA_MINLENGTH)   break;
+          memcpy(&_lastGoodDataPacket,   &_newPacket, sizeof(_newPacket));
+          _dataPacketMillis   = ALTAIR_HAL::clockMillis();
           break;
-        case 1:
-          if (Serial1.available()) {
-            Serial1.write( tx_data, 7 );
-            Serial1.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
+        case UM7_HEALTH_ADDRESS:
+          if (_newPacket.data_length < UM7_HEALTH_MINLENGTH) break;
+          memcpy(&_lastGoodHealthPacket, &_newPacket, sizeof(_newPacket));
+          _healthPacketMillis = ALTAIR_HAL::clockMillis();
           break;
-        case 2:
-          if (Serial2.available()) {
-            Serial2.write( tx_data, 7 );
-            Serial2.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 3:
-          if (Serial3.available()) {
-            Serial3.write( tx_data, 7 );
-            Serial3.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
+        case UM7_GPS_ADDRESS:
+          if (_newPacket.data_length < UM7_GPS_MINLENGTH)    break;
+          memcpy(&_lastGoodGPSPacket,    &_newPacket, sizeof(_newPacket));
+          _gpsPacketMillis    = ALTAIR_HAL::clockMillis();
           break;
         default:
-          Serial.println(F("Unallowed serial ID provided in initialization of UM7 orientation sensor!"));
-          while(1);
-      }
-      if (dataReceived) {
-        break;
-      } else {
-        ++nAttempts;
+          break;
       }
     }
-    returnVal = parse_serial_data(rx_data, RX_READ_LENGTH, tx_data[4], &_dataPacket);
-    if ( returnVal != 0 ) { Serial.print(F("A bad data packet has been returned by the UM7 orientation sensor! -- with returnVal: ")); Serial.println(returnVal, HEX); }
-    else                  { memcpy(&_lastGoodDataPacket, &_dataPacket, sizeof(_dataPacket)); }
 
-    return _dataPacket;
+    byte address = _requests.due(ALTAIR_HAL::clockMillis());
+    if (address != UM7_NO_REQUEST && requestPacket(batchPT(address), address)) _requests.sent(ALTAIR_HAL::clockMillis());
 }
 
 /**************************************************************************/
 /*!
- @brief  Get the heath packet (containing the sensor status and health
-         info).  This can then be followed by the static member fuctions
-         (for example, getHDOP(struct UM7packet healthPacket)) that parse the
-         health packet into its individual pieces of info.
+ @brief  The packet type of the batch read that starts at address: 15
+         register words (= 60 bytes) for the data and health batches, and
+         12 (= 48 bytes) for the GPS batch.
+*/
+/**************************************************************************/
+byte ALTAIR_UM7::batchPT( byte address ) {
+
+    return (address == UM7_GPS_ADDRESS) ? 0x70 : 0x7C;
+}
 
+/**************************************************************************/
+/*!
+ @brief  Ask the UM7 for a (batch) register read, without waiting for the
+         reply -- the reply is picked up later by serviceSerial().  If the
+         serial TX buffer is too full to take the whole request without
+         blocking, the request is simply skipped (and false is returned).
 */
 /**************************************************************************/
-struct UM7packet ALTAIR_UM7::getHealthPacket() {
+bool ALTAIR_UM7::requestPacket( byte PT, byte address ) {
 
-    byte tx_data[7];
-    byte rx_data[RX_READ_LENGTH];
-    int  returnVal, nAttempts = 0; 
-    bool dataReceived = false;
+    byte         tx_data[7];
+    unsigned int checksum = 's' + 'n' + 'p' + PT + address;
     tx_data[0] = 's';  // Send
     tx_data[1] = 'n';  // New
     tx_data[2] = 'p';  // Packet
-    tx_data[3] = 0x7C; // get a batch of 16 register words (= 64 bytes)
-    tx_data[4] = 0x55; // address of DREG_HEALTH sensor health info register
-    tx_data[5] = 0x02; // checksum high byte
-    tx_data[6] = 0x22; // checksum low byte  
+    tx_data[3] = PT;
+    tx_data[4] = address;
+    tx_data[5] = (checksum >> 8) & 0xFF; // checksum high byte
+    tx_data[6] =  checksum       & 0xFF; // checksum low byte
+
+    ALTAIR_HALUart* port = uart();
+    if (port->availableForWrite() < 7) return false;
+    port->write( tx_data, 7 );
+    return true;
+}
 
-    while (nAttempts < RX_READ_ATTEMPTS) {
-      switch (_serialID) {
-        case 0:
-          if (Serial.available()) {
-            Serial.write( tx_data, 7 );
-            Serial.readBytes(  rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 1:
-          if (Serial1.available()) {
-            Serial1.write( tx_data, 7 );
-            Serial1.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 2:
-          if (Serial2.available()) {
-            Serial2.write( tx_data, 7 );
-            Serial2.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 3:
-          if (Serial3.available()) {
-            Serial3.write( tx_data, 7 );
-            Serial3.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        default:
-          Serial.println(F("Unallowed serial ID provided in initialization of UM7 orientation sensor!"));
-          while(1);
-      }
-      if (dataReceived) {
-        break;
-      } else {
-        ++nAttempts;
-      }
-    }
-    returnVal = parse_serial_data(rx_data, RX_READ_LENGTH, tx_data[4], &_healthPacket);
-    if ( returnVal != 0 ) { Serial.print(F("A bad health packet has been returned by the UM7 orientation sensor! -- with returnVal: ")); Serial.println(returnVal, HEX); }
-    else                  { memcpy(&_lastGoodHealthPacket, &_healthPacket, sizeof(_healthPacket)); }
+/**************************************************************************/
+/*!
+ @brief  Get the main data packet (containing the orientation and acceleration 
+         info).  This can then be followed by the static member fuctions 
+         (for example, getYaw(struct UM7packet dataPacket)) that parse the 
+         data packet into its individual pieces of info.  This returns the
+         latest good data packet received so far, and asks for the next one
+         (which is requested as soon as no other reply is on its way).
+*/
+/**************************************************************************/
+struct UM7packet ALTAIR_UM7::getDataPacket() {
 
-    return _healthPacket;
+    _requests.want( UM7_DATA_ADDRESS );         // a batch of 15 register words (= 60 bytes), starting with DREG_ACCEL_PROC_X
+    serviceSerial();
+    return _lastGoodDataPacket;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Get the heath packet (containing the sensor status and health
+         info).  This can then be followed by the static member fuctions
+         (for example, getHDOP(struct UM7packet healthPacket)) that parse the
+         health packet into its individual pieces of info.  This returns the
+         latest good health packet received so far, and asks for the next
+         one (which is requested as soon as no other reply is on its way).
+
+*/
+/**************************************************************************/
+struct UM7packet ALTAIR_UM7::getHealthPacket() {
+
+    _requests.want( UM7_HEALTH_ADDRESS );       // a batch of 15 register words (= 60 bytes), starting with DREG_HEALTH
+    serviceSerial();
+    return _lastGoodHealthPacket;
 }
 
 /**************************************************************************/
@@ -463,75 +431,30 @@ byte ALTAIR_UM7::getnSensors( struct UM7packet healthPacket ) {
 /**************************************************************************/
 /*!
  @brief  Get the GPS (which is, in practice, through the DFRobot G6 GPS
-         sensor that is attached via serial to the UM7).
+         sensor that is attached via serial to the UM7).  This fills in
+         the latest good GPS packet received so far, asks for the next
+         one, and returns true only if that packet is new since the
+         previous call.
 */
 /**************************************************************************/
 bool ALTAIR_UM7::getGPS( double *lat, double* lon, double* ele, double* time ) {
 
-    byte tx_data[20];
-    byte rx_data[RX_READ_LENGTH];
-    struct UM7packet new_packet;
-    int  returnVal, nAttempts = 0;
-    bool dataReceived = false;
-    tx_data[0] = 's';  // Send
-    tx_data[1] = 'n';  // New
-    tx_data[2] = 'p';  // Packet
-    tx_data[3] = 0x70; // get a batch of 12 register words (= 48 bytes)
-    tx_data[4] = 0x7D; // start with the GPS latitude info: address of DREG_GPS_LATITUDE register
-    tx_data[5] = 0x02; // checksum high byte
-    tx_data[6] = 0x3E; // checksum low byte
+    if (!_theUM7) return false;
 
-    while (nAttempts < RX_READ_ATTEMPTS) {
-      switch ( DEFAULT_UM7_SERIALID ) {
-        case 0:
-          if (Serial.available()) {
-            Serial.write(  tx_data, 7 );
-            Serial.readBytes(  rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 1:
-          if (Serial1.available()) {
-            Serial1.write( tx_data, 7 );
-            Serial1.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 2:
-          if (Serial2.available()) {
-            Serial2.write( tx_data, 7 );
-            Serial2.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        case 3:
-          if (Serial3.available()) {
-            Serial3.write( tx_data, 7 );
-            Serial3.readBytes( rx_data, RX_READ_LENGTH );
-            dataReceived = true;
-          }
-          break;
-        default:
-          Serial.println(F("Unallowed serial ID provided in initialization of UM7 orientation sensor!"));
-          while(1);
-      }
-      if (dataReceived) {
-        break;
-      } else {
-        ++nAttempts;
-      }
-    }
-    returnVal = parse_serial_data(rx_data, RX_READ_LENGTH, tx_data[4], &new_packet);
-    if ( returnVal != 0 ) { 
-        Serial.print(F("A bad GPS packet has been returned by the UM7 orientation sensor! -- with returnVal: ")); Serial.println(returnVal, HEX); 
-        return false;
-    }
-    *lat  = convertBytesToFloat(  new_packet.data     );
-    *lon  = convertBytesToFloat(&(new_packet.data[4] ));
-    *ele  = convertBytesToFloat(&(new_packet.data[8] ));
-    *time = convertBytesToFloat(&(new_packet.data[20]));
+    _theUM7->_requests.want( UM7_GPS_ADDRESS );         // a batch of 12 register words (= 48 bytes), starting with DREG_GPS_LATITUDE
+    _theUM7->serviceSerial();
 
-    return true;
+    if (_theUM7->_gpsPacketMillis == 0) return false;   // no good GPS packet has been received yet
+
+    byte* data = _theUM7->_lastGoodGPSPacket.data;
+    *lat  = convertBytesToFloat(  data     );
+    *lon  = convertBytesToFloat(&(data[4] ));
+    *ele  = convertBytesToFloat(&(data[8] ));
+    *time = convertBytesToFloat(&(data[20]));
+
+    bool isNew = (_theUM7->_gpsPacketMillis != _theUM7->_gpsPacketMillisLastReturned);
+    _theUM7->_gpsPacketMillisLastReturned = _theUM7->_gpsPacketMillis;
+    return isNew;
 }
 
 /**************************************************************************/
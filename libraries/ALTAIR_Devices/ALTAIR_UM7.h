@@ -12,6 +12,13 @@
     additional information such as acceleration, temperature, and 
     device health).  Essentially all device functionality is 
     available via this interface.
+
+    The UM7's serial port, and the clock, are accessed through
+    ALTAIR_HAL, so that (other than the diagnostics that it prints) this
+    class does not depend upon the Arduino libraries, and the driver
+    itself can be run against the Linux simulation backend's UART (see
+    tools/ALTAIRUM7SerialSim.cpp).
+
     Justin Albert  jalbert@uvic.ca     began on 21 Nov. 2017
 
     @section  HISTORY
@@ -23,18 +30,21 @@
 #ifndef      ALTAIR_UM7_h
 #define      ALTAIR_UM7_h
 
-#include    "Arduino.h"
 #include    "ALTAIR_OrientSensor.h"
+#include    <ALTAIR_HAL.h>
+#include    "ALTAIR_UM7Parser.h"
+#include    "ALTAIR_UM7Requests.h"
 
 #define      DEFAULT_UM7_SERIALID         3
+#define      UM7_BAUD_RATE           115200
 
-struct UM7packet {
-             byte      Address;
-             byte      PT;             // Packet Type
-    unsigned int       Checksum;
-             byte      data_length;
-             byte      data[75];
-};
+#define      UM7_DATA_ADDRESS          0x65       // DREG_ACCEL_PROC_X: the start of the processed accel/Euler angle data batch
+#define      UM7_HEALTH_ADDRESS        0x55       // DREG_HEALTH: the start of the health/temperature batch
+#define      UM7_GPS_ADDRESS           0x7D       // DREG_GPS_LATITUDE: the start of the GPS batch
+#define      UM7_DATA_MINLENGTH          50       // a data   packet must reach the yaw bytes         (data[48], data[49])
+#define      UM7_HEALTH_MINLENGTH        44       // a health packet must reach the temperature bytes (data[40] to data[43])
+#define      UM7_GPS_MINLENGTH           24       // a GPS    packet must reach the GPS time bytes    (data[20] to data[23])
+#define      UM7_MAX_BYTES_PER_SERVICE  128       // so that one call to serviceSerial() can't run away with loop()
 
 typedef union {
              byte      array[4];
@@ -46,10 +56,21 @@ class ALTAIR_UM7 : public ALTAIR_OrientSensor {
     ALTAIR_UM7(                           const  char       serialID           );
     ALTAIR_UM7(                                                                );  // default constructor => default argument to constructor
 
-    struct   UM7packet getDataPacket(                                          );
-    struct   UM7packet getHealthPacket(                                        );
-             void      update(                                                 ) {        getDataPacket();                           getHealthPacket(); }
-
+    struct   UM7packet getDataPacket(                                          );  // Non-blocking: returns the latest good data   packet, and asks for a new one.
+    struct   UM7packet getHealthPacket(                                        );  // Non-blocking: returns the latest good health packet, and asks for a new one.
+             void      update(                                                 ) {        getDataPacket();                           getHealthPacket(); }  // (the health request waits for the data reply)
+
+             void      serviceSerial(                                          );  // Feed all bytes waiting in the serial RX buffer into the packet parser, and write the
+                                                                                   //    next request that is wanted, once the last one's reply is in.  Call this every few
+                                                                                   //    ms: a reply does not fit in the RX buffer (see ALTAIR_UM7Requests.h).
+             bool      requestPacket(            byte       PT              ,
+                                                 byte       address            );  // Write a (non-blocking) `snp' register read request.  False if skipped.
+    static   byte      batchPT(                  byte       address            );  // The packet type of the batch read that starts at address.
+    ALTAIR_UM7Parser*  parser(                                                 ) { return &_parser                ; }
+    ALTAIR_UM7Requests* requests(                                              ) { return &_requests              ; }
+    unsigned long      dataPacketMillis(                                       ) { return _dataPacketMillis       ; }  // clockMillis() when the latest good packet of each kind arrived
+    unsigned long      healthPacketMillis(                                     ) { return _healthPacketMillis     ; }  //   (0 => none has arrived yet).
+    unsigned long      gpsPacketMillis(                                        ) { return _gpsPacketMillis        ; }
 
     static   float     getYaw(            struct UM7packet  dataPacket         );
     static   float     getPitch(          struct UM7packet  dataPacket         );
@@ -68,7 +89,7 @@ class ALTAIR_UM7 : public ALTAIR_OrientSensor {
     static   bool      getGPS(                   double*    lat, 
                                                  double*    lon,
                                                  double*    ele,
-                                                 double*    time               );
+                                                 double*    time               );  // Non-blocking: returns true if a new GPS packet has arrived since the last call.
 
     static   float     convertBytesToFloat(      byte*      data               );
 
@@ -92,12 +113,23 @@ class ALTAIR_UM7 : public ALTAIR_OrientSensor {
 
   protected:
 
+    ALTAIR_HALUart*    uart(                                                   );
+
   private:
+    static   ALTAIR_UM7* _theUM7                                                ;  // The UM7 is a singleton; this lets the (static) getGPS() reach it.
+
              char      _serialID                                                ;
-    struct   UM7packet _dataPacket                                              ;
-    struct   UM7packet _healthPacket                                            ;
+    ALTAIR_HALUart*    _uart                                                    ;  // (NULL if _serialID is not allowed)
+    ALTAIR_UM7Parser   _parser                                                  ;
+    ALTAIR_UM7Requests _requests                                                ;
+    struct   UM7packet _newPacket                                               ;
     struct   UM7packet _lastGoodDataPacket                                      ;
     struct   UM7packet _lastGoodHealthPacket                                    ;
+    struct   UM7packet _lastGoodGPSPacket                                       ;
+    unsigned long      _dataPacketMillis                                        ;
+    unsigned long      _healthPacketMillis                                      ;
+    unsigned long      _gpsPacketMillis                                         ;
+    unsigned long      _gpsPacketMillisLastReturned                             ;
 };
 
 #endif
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_UM7Parser.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the incremental parser of the CH Robotics UM7's
+    `snp' packet stream (see ALTAIR_UM7Parser.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_UM7Parser.h"
+
+/**************************************************************************/
+/*!
+ @brief  Parser constructor.  
+*/
+/**************************************************************************/
+ALTAIR_UM7Parser::ALTAIR_UM7Parser(          ) :
+    _state(                     um7_waitForS ) ,
+    _bytesParsed(                          0 ) ,
+    _packetsParsed(                        0 ) ,
+    _checksumErrors(                       0 ) ,
+    _framingErrors(                        0 )
+{
+}
+
+/**************************************************************************/
+/*!
+ @brief  Feed one byte into the parser state machine.  Returns true when
+         the byte completes a packet with a good checksum, in which case
+         the packet has been copied into *packet.  (The state machine
+         follows the same packet layout that parse_serial_data() does:
+         `snp', packet type, address, 0 to 60 data bytes, and a 2-byte
+         checksum that is the sum of all the preceding bytes.)
+*/
+/**************************************************************************/
+bool ALTAIR_UM7Parser::parseByte( byte b, struct UM7packet* packet )
+{
+   ++_bytesParsed;
+   switch (_state) {
+      case um7_waitForS:
+         if (b == 's') _state = um7_waitForN;
+         return false;
+      case um7_waitForN:
+         _state = (b == 'n') ? um7_waitForP : ((b == 's') ? um7_waitForN : um7_waitForS);
+         if (_state == um7_waitForS) ++_framingErrors;
+         return false;
+      case um7_waitForP:
+         _state = (b == 'p') ? um7_waitForPT : ((b == 's') ? um7_waitForN : um7_waitForS);
+         if (_state == um7_waitForS) ++_framingErrors;
+         return false;
+      case um7_waitForPT: {
+         _PT = b;
+// See parse_serial_data() below for the meaning of the individual bits of the PT byte.
+         byte packet_has_data = (_PT >> 7) & 0x01;
+         byte packet_is_batch = (_PT >> 6) & 0x01;
+         byte batch_length    = (_PT >> 2) & 0x0F;
+         _dataLength          = packet_has_data ? (packet_is_batch ? 4*batch_length : 4) : 0;
+         _state               = um7_waitForAddress;
+         return false;
+      }
+      case um7_waitForAddress:
+         _address          = b;
+         _dataIndex        = 0;
+         _computedChecksum = 's' + 'n' + 'p' + _PT + _address;
+         _state            = (_dataLength > 0) ? um7_waitForData : um7_waitForChecksum1;
+         return false;
+      case um7_waitForData:
+         _data[_dataIndex++] = b;
+         _computedChecksum  += b;
+         if (_dataIndex == _dataLength) _state = um7_waitForChecksum1;
+         return false;
+      case um7_waitForChecksum1:
+         _receivedChecksum = ((unsigned int) b) << 8;
+         _state            = um7_waitForChecksum2;
+         return false;
+      case um7_waitForChecksum2:
+         _receivedChecksum |= b;
+         _state             = um7_waitForS;
+         if (_receivedChecksum != _computedChecksum) {
+            ++_checksumErrors;
+            return false;
+         }
+         packet->Address     = _address;
+         packet->PT          = _PT;
+         packet->Checksum    = _receivedChecksum;
+         packet->data_length = _dataLength;
+         memcpy(packet->data, _data, _dataLength);
+         ++_packetsParsed;
+         return true;
+      default:
+         _state = um7_waitForS;
+         return false;
+   }
+}
@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_UM7Parser.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the incremental parser of the CH Robotics UM7's
+    `snp' packet stream (see ALTAIR_UM7.h), which is fed the bytes as they
+    arrive from the serial port.
+
+    This file does not depend upon the Arduino libraries, so that the
+    parser can also be run on a host computer (see
+    tools/ALTAIRUM7ParserTest.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef      ALTAIR_UM7Parser_h
+#define      ALTAIR_UM7Parser_h
+
+#ifdef       ARDUINO
+#include    "Arduino.h"
+#else
+#include    <stdint.h>
+typedef      uint8_t   byte;
+#endif
+
+struct UM7packet {
+             byte      Address;
+             byte      PT;             // Packet Type
+    unsigned int       Checksum;
+             byte      data_length;
+             byte      data[75];
+};
+
+typedef enum { um7_waitForS        = 0,
+               um7_waitForN        = 1,
+               um7_waitForP        = 2,
+               um7_waitForPT       = 3,
+               um7_waitForAddress  = 4,
+               um7_waitForData     = 5,
+               um7_waitForChecksum1= 6,
+               um7_waitForChecksum2= 7 } um7parserstate_t;
+
+/**************************************************************************/
+/*!
+    Incremental (byte-at-a-time) parser of the UM7 `snp' packet stream.
+    Bytes are fed in one by one as they arrive (e.g. from the serial RX
+    ring buffer, which is filled by the UART receive interrupt), and a
+    packet is handed back each time one completes with a good checksum,
+    so packets that are split across calls, and any corrupt bytes in
+    between, are handled without ever waiting on the serial port.
+*/
+/**************************************************************************/
+class ALTAIR_UM7Parser {
+  public:
+    ALTAIR_UM7Parser(                                                          );
+
+             bool      parseByte(                byte       b               ,
+                                          struct UM7packet* packet             );  // Returns true when *packet has just been filled with a complete, good packet.
+             void      reset(                                                  ) { _state = um7_waitForS; }
+
+    unsigned long      bytesParsed(                                            ) { return _bytesParsed      ; }
+    unsigned long      packetsParsed(                                          ) { return _packetsParsed    ; }
+    unsigned long      checksumErrors(                                         ) { return _checksumErrors   ; }
+    unsigned long      framingErrors(                                          ) { return _framingErrors    ; }
+
+  private:
+             um7parserstate_t _state                                            ;
+             byte      _PT                                                      ;
+             byte      _address                                                 ;
+             byte      _dataLength                                              ;
+             byte      _dataIndex                                               ;
+    unsigned int       _computedChecksum                                        ;
+    unsigned int       _receivedChecksum                                        ;
+             byte      _data[75]                                                ;
+    unsigned long      _bytesParsed                                             ;
+    unsigned long      _packetsParsed                                           ;
+    unsigned long      _checksumErrors                                          ;
+    unsigned long      _framingErrors                                           ;
+};
+
+#endif    //   ifndef ALTAIR_UM7Parser_h
@@ -0,0 +1,105 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_UM7Requests.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the request pacing of the CH Robotics UM7 orientation sensor
+    (see ALTAIR_UM7Requests.h).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_UM7Requests.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+ALTAIR_UM7Requests::ALTAIR_UM7Requests(                              ) :
+               _wantedCount(                                 0  ) ,
+               _pending(                        UM7_NO_REQUEST  ) ,
+               _sentMillis(                                  0  )
+{
+    resetStats();
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics.
+*/
+/**************************************************************************/
+void ALTAIR_UM7Requests::resetStats(                                 )
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+ @brief  Ask for the batch starting at address.  It is requested once the
+         batches wanted before it have been, and if it is already wanted
+         (or is the one on its way), it is not asked for twice.
+*/
+/**************************************************************************/
+void ALTAIR_UM7Requests::want( byte address )
+{
+    if (address == _pending) return;
+    for (uint8_t i = 0; i < _wantedCount; ++i) if (_wanted[i] == address) return;
+    if (_wantedCount < UM7_MAX_WANTED_REQUESTS) _wanted[_wantedCount++] = address;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The address of the batch to request now: the longest wanted, if
+         no reply is on its way.  A reply that has not arrived within
+         UM7_REPLY_TIMEOUT is taken to be lost (and counted).
+*/
+/**************************************************************************/
+byte ALTAIR_UM7Requests::due( unsigned long now )
+{
+    if (_pending != UM7_NO_REQUEST) {
+        if (now - _sentMillis < UM7_REPLY_TIMEOUT) return UM7_NO_REQUEST;
+        ++_stats.replyTimeouts;
+        _pending = UM7_NO_REQUEST;
+    }
+    return (_wantedCount > 0) ? _wanted[0] : UM7_NO_REQUEST;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The request that due() returned was written to the UM7: its reply
+         is now on its way.
+*/
+/**************************************************************************/
+void ALTAIR_UM7Requests::sent( unsigned long now )
+{
+    if (_wantedCount == 0) return;
+    _pending    = _wanted[0];
+    _sentMillis = now;
+    --_wantedCount;
+    for (uint8_t i = 0; i < _wantedCount; ++i) _wanted[i] = _wanted[i + 1];
+    ++_stats.requestsSent;
+}
+
+/**************************************************************************/
+/*!
+ @brief  A packet from address arrived.  If it is the reply on its way,
+         the next wanted batch can be requested.
+*/
+/**************************************************************************/
+void ALTAIR_UM7Requests::arrived( byte address , unsigned long now )
+{
+    if (address != _pending) return;
+    _pending = UM7_NO_REQUEST;
+    unsigned long elapsed = now - _sentMillis;
+    _stats.lastReplyMillis = elapsed;
+    if (elapsed > _stats.maxReplyMillis) _stats.maxReplyMillis = elapsed;
+    ++_stats.repliesReceived;
+}
@@ -0,0 +1,77 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_UM7Requests.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the request pacing of the CH Robotics UM7 orientation sensor,
+    as used by ALTAIR_UM7.  Each batch read that is wanted (data, health,
+    or GPS) waits here until the reply to the previous one has arrived (or
+    has timed out), so that at most one reply is ever on its way.  Each
+    reply is 55 to 67 bytes, which at 115200 baud arrives in about 6 ms,
+    and the Mega's serial RX ring buffer only holds 63 bytes: so even one
+    reply must be drained as it arrives (by calling serviceSerial() every
+    few milliseconds), and two back to back would overflow the ring
+    unless it were drained faster still.
+
+    This file does not depend upon the Arduino libraries, so that the
+    pacing can be run against a simulation of the UM7's serial line on a
+    host computer (see tools/ALTAIRUM7SerialSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_UM7Requests_h
+#define   ALTAIR_UM7Requests_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   UM7_MAX_WANTED_REQUESTS       3          // one of each kind (data, health, GPS)
+#define   UM7_REPLY_TIMEOUT            25          // in milliseconds (a reply takes about 6 ms to arrive)
+#define   UM7_NO_REQUEST                0          // (no UM7 batch starts at register 0)
+
+struct    ALTAIR_UM7RequestStats {
+    unsigned long       requestsSent                                        ;
+    unsigned long       repliesReceived                                     ;
+    unsigned long       replyTimeouts                                       ;
+    unsigned long       lastReplyMillis                                     ;  // from the request being written until its reply was parsed
+    unsigned long       maxReplyMillis                                      ;
+};
+
+class     ALTAIR_UM7Requests {
+  public:
+
+    ALTAIR_UM7Requests(                                                     ) ;
+
+    void                want(           byte                  address               ) ;   // Ask for the batch starting at address (once, however often asked).
+    byte                due(            unsigned long         now                   ) ;   // The address to request now, or UM7_NO_REQUEST if a reply is still
+                                                                                          //    on its way (and has not timed out) or if nothing is wanted.
+    void                sent(           unsigned long         now                   ) ;   // The request that due() returned was written.
+    void                arrived(        byte                  address             ,       // A packet from address arrived (whether it was asked for,
+                                        unsigned long         now                   ) ;   //    or broadcast).
+
+    byte                pending(                                                    ) { return _pending                    ; }   // (UM7_NO_REQUEST if none)
+    uint8_t             wanted(                                                     ) { return _wantedCount                ; }
+
+    ALTAIR_UM7RequestStats* stats(                                                  ) { return &_stats                     ; }
+    void                resetStats(                                                 ) ;
+
+  private:
+    byte                _wanted[UM7_MAX_WANTED_REQUESTS]                            ;  // first-in, first-out
+    uint8_t             _wantedCount                                                ;
+    byte                _pending                                                    ;
+    unsigned long       _sentMillis                                                 ;
+    ALTAIR_UM7RequestStats _stats                                                   ;
+};
+
+#endif    //   ifndef ALTAIR_UM7Requests_h
@@ -0,0 +1,152 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_HAL.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the ALTAIR hardware abstraction layer: a thin set of calls for
+    the clock, GPIO, the ADC, the timers' PWM output compare units, the
+    UARTs, I2C and SPI, which the ALTAIR libraries use instead of talking
+    to Serial1-3, Wire, SPI, or the AVR timer registers directly.
+
+    There are two backends.  When built for an Arduino, ALTAIR_HAL_AVR.cpp
+    just calls the Arduino core (or writes the timer registers), so the
+    flight code is unchanged.  Otherwise, ALTAIR_HAL_Linux.cpp simulates
+    the hardware on a host computer (see ALTAIR_HALSim.h), with a clock
+    that only advances when told to (or when simulated bus traffic takes
+    time), so that code which uses the HAL can be run, profiled and
+    timed, deterministically, off-target.
+
+    Besides the blocking I2C calls, there is a queue of I2C requests (each
+    a write, e.g. of a register address, then a read after a repeated
+    start, or either one alone), which are transferred in the background
+    while the main loop gets on with other work (e.g. the radios and the
+    SD card), and each one's callback is then called by i2cService(), from
+    the main loop.  On the Mega, the transfer is driven by the TWI state
+    machine in ALTAIR_HAL_AVR.cpp: from the TWI interrupt, if built with
+    ALTAIR_HAL_TWI_ISR defined (which can only be done when nothing links
+    in the Wire library, as it has its own TWI interrupt); otherwise (as
+    now, since the BNO055, HMC6343, HMC5883L and ADS1115 libraries all use
+    Wire), by i2cService() stepping it whenever the TWI hardware has
+    finished a byte.  Either way, the queue is drained (by i2cFlush())
+    before the bus is used in any other way, so that nothing else ever
+    talks across a queued transfer.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_HAL_h
+#define   ALTAIR_HAL_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stddef.h>
+#include  <stdint.h>
+#endif
+
+#define   HAL_INPUT                  0          // (the same values as the Arduino core's INPUT, OUTPUT, etc)
+#define   HAL_OUTPUT                 1
+#define   HAL_INPUT_PULLUP           2
+#define   HAL_LOW                    0
+#define   HAL_HIGH                   1
+
+#define   HAL_MAX_UARTS              4          // Serial, and Serial1 to Serial3, on the Mega
+
+#define   HAL_I2C_QUEUE_LENGTH       8          // (a power of 2)
+#define   HAL_I2C_QUEUED             0          // an I2C request's status
+#define   HAL_I2C_ACTIVE             1
+#define   HAL_I2C_DONE               2
+#define   HAL_I2C_NACK               3          // (not acknowledged, by the address or a byte written, or the arbitration was lost)
+
+#define   HAL_PWM_CHANNEL_A       0x01          // output compare units, as a mask for pwmBegin()
+#define   HAL_PWM_CHANNEL_B       0x02
+#define   HAL_PWM_CHANNEL_C       0x04
+
+/**************************************************************************/
+/*!
+    A UART (i.e. one of the serial ports).
+*/
+/**************************************************************************/
+class     ALTAIR_HALUart {
+  public:
+    virtual void        begin(          unsigned long         baudRate              ) = 0;
+    virtual int         available(                                                  ) = 0;   // # of received bytes waiting to be read
+    virtual int         read(                                                       ) = 0;   // -1 if there are none
+    virtual size_t      write(          const uint8_t*        bytes               ,
+                                        size_t                numBytes              ) = 0;
+    virtual int         availableForWrite(                                          ) = 0;   // # of bytes that can be written without blocking
+};
+
+/**************************************************************************/
+/*!
+    A queued I2C request.  Its owner keeps it (and its bytes) until the
+    callback has been called.
+*/
+/**************************************************************************/
+struct    ALTAIR_HALI2CRequest;
+typedef   void (*ALTAIR_HALI2CCallback)( ALTAIR_HALI2CRequest* request );
+
+struct    ALTAIR_HALI2CRequest {
+    uint8_t               address                                           ;
+    const uint8_t*        writeBytes                                        ;  // written first (if numWrite > 0)
+    uint8_t               numWrite                                          ;
+    uint8_t*              readBytes                                         ;  // and then read (if numRead > 0)
+    uint8_t               numRead                                           ;
+    ALTAIR_HALI2CCallback callback                                          ;  // (or NULL)
+    void*                 context                                           ;  // (for the callback)
+    volatile uint8_t      status                                            ;  // HAL_I2C_QUEUED, etc
+    volatile uint8_t      numReceived                                       ;
+};
+
+class     ALTAIR_HAL {
+  public:
+// The clock
+    static unsigned long clockMillis(                                               ) ;
+    static unsigned long clockMicros(                                               ) ;
+    static void         clockDelay(     unsigned long         milliseconds          ) ;
+
+// GPIO, and the ADC
+    static void         gpioMode(       uint8_t               pin                 ,
+                                        uint8_t               mode                  ) ;   // HAL_INPUT, etc
+    static void         gpioWrite(      uint8_t               pin                 ,
+                                        uint8_t               level                 ) ;   // HAL_LOW or HAL_HIGH
+    static uint8_t      gpioRead(       uint8_t               pin                   ) ;
+    static uint16_t     adcRead(        uint8_t               pin                   ) ;   // 0 to 1023
+
+// PWM, from a 16-bit timer's output compare units, in fast 9-bit PWM mode at clk/256 (i.e. 122 Hz)
+    static bool         pwmBegin(       uint8_t               timer               ,       // 1, 3, 4 or 5
+                                        uint8_t               channels              ) ;   // HAL_PWM_CHANNEL_A | ..., to enable
+    static void         pwmWrite(       uint8_t               timer               ,
+                                        uint8_t               channel             ,       // HAL_PWM_CHANNEL_A, B or C
+                                        uint16_t              compareValue          ) ;   // 0 to 511
+
+// The UARTs
+    static ALTAIR_HALUart* uart(        uint8_t               serialID              ) ;   // NULL if there is no such UART
+
+// I2C (as the bus master)
+    static void         i2cBegin(                                                   ) ;
+    static bool         i2cWrite(       uint8_t               address             ,       // Returns false if not acknowledged.
+                                        const uint8_t*        bytes               ,
+                                        uint8_t               numBytes            ,
+                                        bool                  sendStop     = true   ) ;
+    static uint8_t      i2cRead(        uint8_t               address             ,       // Returns the # of bytes read.
+                                        uint8_t*              bytes               ,
+                                        uint8_t               numBytes              ) ;
+    static bool         i2cSubmit(      ALTAIR_HALI2CRequest* request               ) ;   // Queue a request.  False if the queue is full.
+    static void         i2cService(                                                 ) ;   // Call the callbacks of the finished requests (and step the
+                                                                                          //    transfer, without the TWI interrupt).  From loop().
+    static bool         i2cIdle(                                                    ) ;   // Nothing queued (or waiting for its callback)?
+    static void         i2cFlush(                                                   ) ;   // Wait for every queued request, and call its callback.
+
+// SPI (as the bus master)
+    static void         spiBegin(                                                   ) ;
+    static uint8_t      spiTransfer(    uint8_t               aByte                 ) ;
+};
+
+#endif    //   ifndef ALTAIR_HAL_h
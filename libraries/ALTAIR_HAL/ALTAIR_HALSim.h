@@ -0,0 +1,164 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_HALSim.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the control interface of the Linux (i.e. host computer)
+    simulation backend of the ALTAIR hardware abstraction layer.  A test
+    or benchmark uses it to set the simulated clock, drive the input pins
+    and ADC channels, inject bytes into (and collect bytes from) the
+    UARTs, attach simulated I2C and SPI devices, and read back what the
+    code under test did (e.g. the PWM compare values that it set).
+
+    The simulated clock only moves when told to, or when simulated bus
+    traffic takes time: each I2C byte, SPI byte and ADC conversion adds
+    about what it takes on the Mega, so the simulated time that a piece of
+    code takes approximates its time on target (less its CPU time, which
+    is measured separately, in host time).  The bus activity is counted
+    as well (see ALTAIR_HALSimStats).
+
+    Queued I2C requests (see ALTAIR_HAL::i2cSubmit) take the same bus time,
+    but in the background: a request is transferred while the clock moves
+    on for other reasons, and is finished (i.e. its device is talked to,
+    and its callback is called) by the first i2cService() at or after the
+    time that it would have finished, as with the TWI interrupt.  With
+    setI2CPolled(true), the transfer instead only moves on by one byte per
+    i2cService() call (and only once that byte's time has passed), as on
+    the Mega without the TWI interrupt.  The blocking I2C calls first drain
+    the queue (moving the clock on to when it would have been drained).
+
+    To build a test or benchmark against it (with no ARDUINO defined):
+
+      g++ -std=c++11 -O2 -I<libraries>/ALTAIR_HAL mytest.cpp <libraries>/ALTAIR_HAL/ALTAIR_HAL_Linux.cpp
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_HALSim_h
+#define   ALTAIR_HALSim_h
+
+#ifndef   ARDUINO
+
+#include "ALTAIR_HAL.h"
+
+#define   HAL_SIM_MAX_PINS              70          // as on the Mega
+#define   HAL_SIM_MAX_ADC_CHANNELS      16
+#define   HAL_SIM_MAX_TIMERS             6
+#define   HAL_SIM_UART_BUFFER_SIZE    1024
+#define   HAL_SIM_UART_TX_SPACE         63          // what availableForWrite() returns when the TX buffer is empty (as on the Mega)
+
+#define   HAL_SIM_I2C_MICROS_PER_BYTE   90          // at 100 kHz, with the address and (n)ack overheads
+#define   HAL_SIM_SPI_MICROS_PER_BYTE    2          // at 4 MHz, with the loop overheads
+#define   HAL_SIM_ADC_MICROS           112          // one conversion, at the default prescaler
+
+/**************************************************************************/
+/*!
+    A simulated I2C device (e.g. a model of a sensor's registers).
+*/
+/**************************************************************************/
+class     ALTAIR_HALSimI2CDevice {
+  public:
+    virtual bool        i2cWrite(       const uint8_t*        bytes               ,
+                                        uint8_t               numBytes              ) = 0;   // Return false to NACK.
+    virtual uint8_t     i2cRead(        uint8_t*              bytes               ,
+                                        uint8_t               numBytes              ) = 0;   // Return the # of bytes supplied.
+};
+
+/**************************************************************************/
+/*!
+    A simulated SPI device (only one can be attached; chip selects are
+    just GPIO writes).
+*/
+/**************************************************************************/
+class     ALTAIR_HALSimSPIDevice {
+  public:
+    virtual uint8_t     spiTransfer(    uint8_t               aByte                 ) = 0;
+};
+
+/**************************************************************************/
+/*!
+    A simulated UART: what the code under test writes is collected in the
+    TX buffer, and bytes that are injected are read back by it.
+*/
+/**************************************************************************/
+class     ALTAIR_HALSimUart : public ALTAIR_HALUart {
+  public:
+    ALTAIR_HALSimUart(                                                              ) ;
+
+    virtual void        begin(          unsigned long         baudRate              ) { _baudRate = baudRate              ; }
+    virtual int         available(                                                  ) { return _rxCount                   ; }
+    virtual int         read(                                                       ) ;
+    virtual size_t      write(          const uint8_t*        bytes               ,
+                                        size_t                numBytes              ) ;
+    virtual int         availableForWrite(                                          ) { return _txSpace                   ; }
+
+    size_t              inject(         const uint8_t*        bytes               ,       // (for the simulation) Returns the # that fit.
+                                        size_t                numBytes              ) ;
+    size_t              collect(        uint8_t*              bytes               ,       // (for the simulation) Take what was written.
+                                        size_t                maxBytes              ) ;
+    void                setTxSpace(     int                   txSpace               ) { _txSpace = txSpace                ; }
+    unsigned long       baudRate(                                                   ) { return _baudRate                  ; }
+    size_t              txCount(                                                    ) { return _txCount                   ; }
+
+  private:
+    uint8_t             _rx[HAL_SIM_UART_BUFFER_SIZE]                               ;
+    uint8_t             _tx[HAL_SIM_UART_BUFFER_SIZE]                               ;
+    size_t              _rxHead                                                     ;
+    size_t              _rxCount                                                    ;
+    size_t              _txHead                                                     ;
+    size_t              _txCount                                                    ;  // (the oldest bytes are overwritten, if not collected)
+    int                 _txSpace                                                    ;
+    unsigned long       _baudRate                                                   ;
+};
+
+struct    ALTAIR_HALSimStats {
+    unsigned long       gpioWrites                                          ;
+    unsigned long       gpioReads                                           ;
+    unsigned long       adcReads                                            ;
+    unsigned long       pwmWrites                                           ;
+    unsigned long       uartBytesWritten                                    ;
+    unsigned long       uartBytesRead                                       ;
+    unsigned long       i2cTransactions                                     ;
+    unsigned long       i2cBytes                                            ;
+    unsigned long       i2cNacks                                            ;
+    unsigned long       i2cRequests                                         ;  // queued
+    unsigned long long  i2cBusyMicros                                       ;  // transferring bytes (blocking, or queued)
+    unsigned long       spiBytes                                            ;
+};
+
+class     ALTAIR_HALSim {
+  public:
+    static void         reset(                                                      ) ;   // Clear every pin, device, buffer, stat, and the clock.
+
+    static void         setMicros(      unsigned long long    micros                ) ;
+    static void         advanceMicros(  unsigned long long    micros                ) ;
+    static unsigned long long micros(                                               ) ;
+
+    static void         setPin(         uint8_t               pin                 ,       // Drive an input pin.
+                                        uint8_t               level                 ) ;
+    static uint8_t      pin(            uint8_t               pin                   ) ;   // The level last written to (or driven on) a pin.
+    static uint8_t      pinMode(        uint8_t               pin                   ) ;
+    static void         setADC(         uint8_t               pin                 ,
+                                        uint16_t              value                 ) ;
+    static uint16_t     pwmCompare(     uint8_t               timer               ,
+                                        uint8_t               channel               ) ;
+    static uint8_t      pwmChannels(    uint8_t               timer                 ) ;   // the channels enabled by pwmBegin()
+
+    static ALTAIR_HALSimUart* uart(     uint8_t               serialID              ) ;
+    static void         attachI2C(      uint8_t               address             ,
+                                        ALTAIR_HALSimI2CDevice* device              ) ;
+    static void         attachSPI(      ALTAIR_HALSimSPIDevice* device              ) ;
+    static void         setI2CPolled(   bool                  polled                ) ;   // (see above)
+
+    static ALTAIR_HALSimStats* stats(                                               ) ;
+};
+
+#endif    //   ifndef ARDUINO
+
+#endif    //   ifndef ALTAIR_HALSim_h
@@ -0,0 +1,349 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_HAL_AVR.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the AVR (i.e. Arduino Mega 2560) backend of the ALTAIR
+    hardware abstraction layer.  Each call maps straight onto the Arduino
+    core, or onto the timer (or TWI) registers.
+
+    The queued I2C requests are transferred by a TWI master state machine
+    (twiStep), which is run either by the TWI interrupt (if built with
+    ALTAIR_HAL_TWI_ISR defined, e.g. -DALTAIR_HAL_TWI_ISR, in which case
+    the Wire library must not be linked in, and the blocking I2C calls go
+    via the queue too), or else by i2cService(), whenever the TWI hardware
+    has finished a byte.  In the latter case it leaves the TWI interrupt
+    disabled (so that Wire's interrupt never sees its transfers), and the
+    blocking I2C calls (which use Wire) first drain the queue.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#ifdef    ARDUINO
+
+#include "ALTAIR_HAL.h"
+#include <SPI.h>
+#include <util/twi.h>
+#include <util/atomic.h>
+#ifndef   ALTAIR_HAL_TWI_ISR
+#include <Wire.h>
+#define   TWI_ENABLE               ( _BV(TWEN)              )
+#else
+#define   TWI_ENABLE               ( _BV(TWEN) | _BV(TWIE)  )
+#endif
+
+#define   TWI_FREQUENCY            100000UL
+#define   TWI_TIMEOUT_MICROS        25000UL          // (with no progress at all: the bus is stuck, e.g. a device holding SDA low)
+#define   TWI_INDEX(i)             ((i) & (HAL_I2C_QUEUE_LENGTH - 1))
+
+/**************************************************************************/
+/*!
+    A hardware serial port.
+*/
+/**************************************************************************/
+class     ALTAIR_AVRUart : public ALTAIR_HALUart {
+  public:
+    ALTAIR_AVRUart(                     HardwareSerial&       serial                ) : _serial(serial)                     { }
+
+    virtual void        begin(          unsigned long         baudRate              ) { _serial.begin(baudRate)           ; }
+    virtual int         available(                                                  ) { return _serial.available()        ; }
+    virtual int         read(                                                       ) { return _serial.read()             ; }
+    virtual size_t      write(          const uint8_t*        bytes               ,
+                                        size_t                numBytes              ) { return _serial.write(bytes, numBytes) ; }
+    virtual int         availableForWrite(                                          ) { return _serial.availableForWrite() ; }
+
+  private:
+    HardwareSerial&    _serial                                                      ;
+};
+
+static ALTAIR_AVRUart  uart0(Serial);
+#ifdef    HAVE_HWSERIAL1
+static ALTAIR_AVRUart  uart1(Serial1);
+#endif
+#ifdef    HAVE_HWSERIAL2
+static ALTAIR_AVRUart  uart2(Serial2);
+#endif
+#ifdef    HAVE_HWSERIAL3
+static ALTAIR_AVRUart  uart3(Serial3);
+#endif
+
+unsigned long ALTAIR_HAL::clockMillis(                              ) { return millis()                            ; }
+unsigned long ALTAIR_HAL::clockMicros(                              ) { return micros()                            ; }
+void          ALTAIR_HAL::clockDelay(  unsigned long milliseconds   ) { delay(milliseconds)                        ; }
+
+void          ALTAIR_HAL::gpioMode(    uint8_t pin , uint8_t mode   ) { pinMode(pin, mode)                         ; }
+void          ALTAIR_HAL::gpioWrite(   uint8_t pin , uint8_t level  ) { digitalWrite(pin, level)                   ; }
+uint8_t       ALTAIR_HAL::gpioRead(    uint8_t pin                  ) { return digitalRead(pin)                    ; }
+uint16_t      ALTAIR_HAL::adcRead(     uint8_t pin                  ) { return analogRead(pin)                     ; }
+
+/**************************************************************************/
+/*!
+ @brief  Put a timer into fast 9-bit PWM mode (WGMn2 and WGMn1), with a
+         clk/256 prescaler (CSn2), and enable non-inverting output on the
+         given compare units.  (Timers 0 and 2 are 8-bit, and timer 0 runs
+         millis(), so only the 16-bit timers are allowed.)
+*/
+/**************************************************************************/
+bool ALTAIR_HAL::pwmBegin( uint8_t timer , uint8_t channels )
+{
+    switch (timer) {
+      case 1:
+        TCCR1A = ((channels & HAL_PWM_CHANNEL_A) ? _BV(COM1A1) : 0) | ((channels & HAL_PWM_CHANNEL_B) ? _BV(COM1B1) : 0) |
+                 ((channels & HAL_PWM_CHANNEL_C) ? _BV(COM1C1) : 0) | _BV(WGM12) | _BV(WGM11);
+        TCCR1B = _BV(CS12);
+        return true;
+      case 3:
+        TCCR3A = ((channels & HAL_PWM_CHANNEL_A) ? _BV(COM3A1) : 0) | ((channels & HAL_PWM_CHANNEL_B) ? _BV(COM3B1) : 0) |
+                 ((channels & HAL_PWM_CHANNEL_C) ? _BV(COM3C1) : 0) | _BV(WGM32) | _BV(WGM31);
+        TCCR3B = _BV(CS32);
+        return true;
+      case 4:
+        TCCR4A = ((channels & HAL_PWM_CHANNEL_A) ? _BV(COM4A1) : 0) | ((channels & HAL_PWM_CHANNEL_B) ? _BV(COM4B1) : 0) |
+                 ((channels & HAL_PWM_CHANNEL_C) ? _BV(COM4C1) : 0) | _BV(WGM42) | _BV(WGM41);
+        TCCR4B = _BV(CS42);
+        return true;
+      case 5:
+        TCCR5A = ((channels & HAL_PWM_CHANNEL_A) ? _BV(COM5A1) : 0) | ((channels & HAL_PWM_CHANNEL_B) ? _BV(COM5B1) : 0) |
+                 ((channels & HAL_PWM_CHANNEL_C) ? _BV(COM5C1) : 0) | _BV(WGM52) | _BV(WGM51);
+        TCCR5B = _BV(CS52);
+        return true;
+      default:
+        Serial.println(F("Unallowed timer provided for PWM output!"));
+        return false;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Set the output compare register of one channel of a timer.
+*/
+/**************************************************************************/
+void ALTAIR_HAL::pwmWrite( uint8_t timer , uint8_t channel , uint16_t compareValue )
+{
+    volatile uint16_t* reg = NULL;
+    switch (timer) {
+      case 1: reg = (channel == HAL_PWM_CHANNEL_A) ? &OCR1A : (channel == HAL_PWM_CHANNEL_B) ? &OCR1B : &OCR1C; break;
+      case 3: reg = (channel == HAL_PWM_CHANNEL_A) ? &OCR3A : (channel == HAL_PWM_CHANNEL_B) ? &OCR3B : &OCR3C; break;
+      case 4: reg = (channel == HAL_PWM_CHANNEL_A) ? &OCR4A : (channel == HAL_PWM_CHANNEL_B) ? &OCR4B : &OCR4C; break;
+      case 5: reg = (channel == HAL_PWM_CHANNEL_A) ? &OCR5A : (channel == HAL_PWM_CHANNEL_B) ? &OCR5B : &OCR5C; break;
+      default:
+        Serial.println(F("Unallowed timer provided for PWM output!"));
+        return;
+    }
+    *reg = compareValue;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Return the UART with the given serial ID (0 for Serial, 1 for
+         Serial1, etc).
+*/
+/**************************************************************************/
+ALTAIR_HALUart* ALTAIR_HAL::uart( uint8_t serialID )
+{
+    switch (serialID) {
+      case 0:  return &uart0;
+#ifdef    HAVE_HWSERIAL1
+      case 1:  return &uart1;
+#endif
+#ifdef    HAVE_HWSERIAL2
+      case 2:  return &uart2;
+#endif
+#ifdef    HAVE_HWSERIAL3
+      case 3:  return &uart3;
+#endif
+      default: return NULL;
+    }
+}
+
+static ALTAIR_HALI2CRequest* volatile twiQueue[HAL_I2C_QUEUE_LENGTH];
+static volatile uint8_t  twiTail;                  // the oldest request, whose callback has not been called yet
+static volatile uint8_t  twiActive;                // the one being transferred (== twiEnd, if none)
+static volatile uint8_t  twiEnd;                   // where the next one goes
+static volatile uint8_t  twiWritten;               // (of the active one's bytes to write)
+static volatile bool     twiReading;               // (i.e. in its read, after the repeated start)
+
+/**************************************************************************/
+/*!
+ @brief  Start the active request (after a STOP, if one is due).
+*/
+/**************************************************************************/
+static void twiBegin( bool afterStop )
+{
+    ALTAIR_HALI2CRequest* request = twiQueue[TWI_INDEX(twiActive)];
+    request->status = HAL_I2C_ACTIVE;
+    twiWritten      = 0;
+    twiReading      = (request->numWrite == 0 && request->numRead > 0);
+    if (!afterStop) while (TWCR & _BV(TWSTO)) { }                                   // (the last request's STOP, which must not be cut short)
+    TWCR            = TWI_ENABLE | _BV(TWINT) | _BV(TWSTA) | (afterStop ? _BV(TWSTO) : 0);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Finish the active request, and either start the next one or
+         release the bus.
+*/
+/**************************************************************************/
+static void twiFinish( uint8_t status )
+{
+    twiQueue[TWI_INDEX(twiActive)]->status = status;
+    ++twiActive;
+    if (twiActive != twiEnd) twiBegin(true);
+    else                     TWCR = TWI_ENABLE | _BV(TWINT) | _BV(TWSTO);
+}
+
+/**************************************************************************/
+/*!
+ @brief  The TWI master state machine: one step, each time the TWI
+         hardware has finished (i.e. TWINT is set).
+*/
+/**************************************************************************/
+static void twiStep(                                                )
+{
+    if (twiActive == twiEnd) return;
+    ALTAIR_HALI2CRequest* request = twiQueue[TWI_INDEX(twiActive)];
+    switch (TW_STATUS) {
+        case TW_START:
+        case TW_REP_START:
+            TWDR = (request->address << 1) | (twiReading ? TW_READ : TW_WRITE);
+            TWCR = TWI_ENABLE | _BV(TWINT);
+            break;
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (twiWritten < request->numWrite) {
+                TWDR = request->writeBytes[twiWritten++];
+                TWCR = TWI_ENABLE | _BV(TWINT);
+            } else if (request->numRead > 0) {
+                twiReading = true;
+                TWCR = TWI_ENABLE | _BV(TWINT) | _BV(TWSTA);                    // (a repeated start)
+            } else {
+                twiFinish(HAL_I2C_DONE);
+            }
+            break;
+        case TW_MR_DATA_ACK:
+            request->readBytes[request->numReceived++] = TWDR;
+            // fall through (to acknowledge the next byte, unless it is the last)
+        case TW_MR_SLA_ACK:
+            TWCR = TWI_ENABLE | _BV(TWINT) | ((request->numReceived + 1 < request->numRead) ? _BV(TWEA) : 0);
+            break;
+        case TW_MR_DATA_NACK:
+            request->readBytes[request->numReceived++] = TWDR;
+            twiFinish(HAL_I2C_DONE);
+            break;
+        default:                                                                    // (not acknowledged, the arbitration lost, or a bus error)
+            twiFinish(HAL_I2C_NACK);
+            break;
+    }
+}
+
+#ifdef    ALTAIR_HAL_TWI_ISR
+ISR(TWI_vect)
+{
+    twiStep();
+}
+#endif
+
+void     ALTAIR_HAL::i2cBegin(                                      )
+{
+#ifdef    ALTAIR_HAL_TWI_ISR
+    digitalWrite(SDA, HIGH);                                                        // (the internal pull-ups, as Wire.begin() does)
+    digitalWrite(SCL, HIGH);
+    TWSR = 0;
+    TWBR = ((F_CPU / TWI_FREQUENCY) - 16) / 2;
+    TWCR = TWI_ENABLE;
+#else
+    Wire.begin();
+#endif
+}
+
+bool     ALTAIR_HAL::i2cSubmit( ALTAIR_HALI2CRequest* request       )
+{
+    if (request == NULL) return false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if ((uint8_t) (twiEnd - twiTail) >= HAL_I2C_QUEUE_LENGTH) return false;
+        request->status      = HAL_I2C_QUEUED;
+        request->numReceived = 0;
+        twiQueue[TWI_INDEX(twiEnd)] = request;
+        bool idle = (twiActive == twiEnd);
+        ++twiEnd;
+        if (idle) twiBegin(false);
+    }
+    return true;
+}
+
+void     ALTAIR_HAL::i2cService(                                    )
+{
+#ifndef   ALTAIR_HAL_TWI_ISR
+    if (twiActive != twiEnd && (TWCR & _BV(TWINT))) twiStep();
+#endif
+    while (twiTail != twiActive) {
+        ALTAIR_HALI2CRequest* request = twiQueue[TWI_INDEX(twiTail)];
+        ++twiTail;                                                                  // (first, as the callback may submit another)
+        if (request->callback) request->callback(request);
+    }
+}
+
+bool     ALTAIR_HAL::i2cIdle(                                       ) { return twiTail == twiEnd                   ; }
+
+void     ALTAIR_HAL::i2cFlush(                                      )
+{
+    uint8_t       active = twiActive;
+    unsigned long since  = micros();
+    while (!i2cIdle()) {
+        i2cService();
+        if (twiActive != active || twiActive == twiEnd) {
+            active = twiActive;
+            since  = micros();
+        } else if (micros() - since > TWI_TIMEOUT_MICROS) {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                TWCR = 0;                                                           // (reset the TWI hardware, and give up on the request)
+                twiFinish(HAL_I2C_NACK);
+            }
+            since = micros();
+        }
+    }
+    while (TWCR & _BV(TWSTO)) { }                                                   // (the last STOP)
+}
+
+bool     ALTAIR_HAL::i2cWrite( uint8_t address , const uint8_t* bytes , uint8_t numBytes , bool sendStop )
+{
+#ifdef    ALTAIR_HAL_TWI_ISR
+    ALTAIR_HALI2CRequest request = { address, bytes, numBytes, NULL, 0, NULL, NULL, 0, 0 };   // (always with a STOP)
+    i2cFlush();
+    if (!i2cSubmit(&request)) return false;
+    i2cFlush();
+    return request.status == HAL_I2C_DONE;
+#else
+    i2cFlush();
+    Wire.beginTransmission(address);
+    Wire.write(bytes, numBytes);
+    return (Wire.endTransmission(sendStop) == 0);
+#endif
+}
+
+uint8_t  ALTAIR_HAL::i2cRead(  uint8_t address , uint8_t* bytes , uint8_t numBytes )
+{
+#ifdef    ALTAIR_HAL_TWI_ISR
+    ALTAIR_HALI2CRequest request = { address, NULL, 0, bytes, numBytes, NULL, NULL, 0, 0 };
+    i2cFlush();
+    if (!i2cSubmit(&request)) return 0;
+    i2cFlush();
+    return request.numReceived;
+#else
+    i2cFlush();
+    uint8_t received = Wire.requestFrom(address, numBytes);
+    for (uint8_t i = 0; i < received; ++i) bytes[i] = Wire.read();
+    return received;
+#endif
+}
+
+void     ALTAIR_HAL::spiBegin(                                      ) { SPI.begin()                                ; }
+uint8_t  ALTAIR_HAL::spiTransfer( uint8_t aByte                     ) { return SPI.transfer(aByte)                 ; }
+
+#endif    //   ifdef ARDUINO
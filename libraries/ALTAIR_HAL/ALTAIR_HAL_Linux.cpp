@@ -0,0 +1,334 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_HAL_Linux.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the Linux (i.e. host computer) simulation backend of the
+    ALTAIR hardware abstraction layer.  (See ALTAIR_HALSim.h.)
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#ifndef   ARDUINO
+
+#include <string.h>
+#include "ALTAIR_HALSim.h"
+
+static unsigned long long        simMicros                                            ;
+static uint8_t                   simPinLevel[HAL_SIM_MAX_PINS]                        ;
+static uint8_t                   simPinMode[HAL_SIM_MAX_PINS]                         ;
+static uint16_t                  simADC[HAL_SIM_MAX_ADC_CHANNELS]                     ;
+static uint16_t                  simPWM[HAL_SIM_MAX_TIMERS][3]                        ;
+static uint8_t                   simPWMChannels[HAL_SIM_MAX_TIMERS]                   ;
+static ALTAIR_HALSimUart         simUart[HAL_MAX_UARTS]                               ;
+static ALTAIR_HALSimI2CDevice*   simI2C[128]                                          ;
+static ALTAIR_HALSimSPIDevice*   simSPI                                               ;
+static ALTAIR_HALSimStats        simStats                                             ;
+static ALTAIR_HALI2CRequest*     simQueue[HAL_I2C_QUEUE_LENGTH]                       ;
+static uint8_t                   simQueueTail                                         ;  // (as in ALTAIR_HAL_AVR.cpp)
+static uint8_t                   simQueueActive                                       ;
+static uint8_t                   simQueueEnd                                          ;
+static unsigned long long        simActiveDueMicros                                   ;  // when the active request (or, if polled, its current byte) is done
+static uint8_t                   simActiveBytesLeft                                   ;  // (if polled)
+static bool                      simI2CPolled                                         ;
+
+#define   SIM_QUEUE_INDEX(i)     ((i) & (HAL_I2C_QUEUE_LENGTH - 1))
+
+static uint8_t channelIndex( uint8_t channel ) { return (channel == HAL_PWM_CHANNEL_A) ? 0 : (channel == HAL_PWM_CHANNEL_B) ? 1 : 2; }
+
+/**************************************************************************/
+/*!
+ @brief  The simulated UART.
+*/
+/**************************************************************************/
+ALTAIR_HALSimUart::ALTAIR_HALSimUart() :
+    _rxHead(                                                        0 ) ,
+    _rxCount(                                                       0 ) ,
+    _txHead(                                                        0 ) ,
+    _txCount(                                                       0 ) ,
+    _txSpace(                                   HAL_SIM_UART_TX_SPACE ) ,
+    _baudRate(                                                      0 )
+{
+    memset(_rx, 0, sizeof(_rx));
+    memset(_tx, 0, sizeof(_tx));
+}
+
+int    ALTAIR_HALSimUart::read(                                            )
+{
+    if (_rxCount == 0) return -1;
+    uint8_t b = _rx[_rxHead];
+    _rxHead   = (_rxHead + 1) % HAL_SIM_UART_BUFFER_SIZE;
+    --_rxCount;
+    ++simStats.uartBytesRead;
+    return b;
+}
+
+size_t ALTAIR_HALSimUart::write(   const uint8_t* bytes , size_t numBytes   )
+{
+    for (size_t i = 0; i < numBytes; ++i) {
+        _tx[(_txHead + _txCount) % HAL_SIM_UART_BUFFER_SIZE] = bytes[i];
+        if (_txCount < HAL_SIM_UART_BUFFER_SIZE) ++_txCount;
+        else                                     _txHead = (_txHead + 1) % HAL_SIM_UART_BUFFER_SIZE;
+    }
+    simStats.uartBytesWritten += numBytes;
+    return numBytes;
+}
+
+size_t ALTAIR_HALSimUart::inject(  const uint8_t* bytes , size_t numBytes   )
+{
+    size_t i = 0;
+    for (; i < numBytes && _rxCount < HAL_SIM_UART_BUFFER_SIZE; ++i) {
+        _rx[(_rxHead + _rxCount) % HAL_SIM_UART_BUFFER_SIZE] = bytes[i];
+        ++_rxCount;
+    }
+    return i;
+}
+
+size_t ALTAIR_HALSimUart::collect( uint8_t* bytes       , size_t maxBytes   )
+{
+    size_t i = 0;
+    for (; i < maxBytes && _txCount > 0; ++i) {
+        bytes[i] = _tx[_txHead];
+        _txHead  = (_txHead + 1) % HAL_SIM_UART_BUFFER_SIZE;
+        --_txCount;
+    }
+    return i;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The HAL itself.
+*/
+/**************************************************************************/
+unsigned long ALTAIR_HAL::clockMillis(                              ) { return (unsigned long) (simMicros / 1000)  ; }
+unsigned long ALTAIR_HAL::clockMicros(                              ) { return (unsigned long)  simMicros          ; }
+void          ALTAIR_HAL::clockDelay(  unsigned long milliseconds   ) { simMicros += 1000ULL * milliseconds        ; }
+
+void ALTAIR_HAL::gpioMode(  uint8_t pin , uint8_t mode  )
+{
+    if (pin >= HAL_SIM_MAX_PINS) return;
+    simPinMode[pin] = mode;
+    if (mode == HAL_INPUT_PULLUP) simPinLevel[pin] = HAL_HIGH;
+}
+
+void ALTAIR_HAL::gpioWrite( uint8_t pin , uint8_t level )
+{
+    ++simStats.gpioWrites;
+    if (pin < HAL_SIM_MAX_PINS) simPinLevel[pin] = level ? HAL_HIGH : HAL_LOW;
+}
+
+uint8_t ALTAIR_HAL::gpioRead( uint8_t pin )
+{
+    ++simStats.gpioReads;
+    return (pin < HAL_SIM_MAX_PINS) ? simPinLevel[pin] : HAL_LOW;
+}
+
+uint16_t ALTAIR_HAL::adcRead( uint8_t pin )
+{
+    ++simStats.adcReads;
+    simMicros += HAL_SIM_ADC_MICROS;
+    return simADC[pin % HAL_SIM_MAX_ADC_CHANNELS];                              // (so that A0 = 54 and channel 0 are the same)
+}
+
+bool ALTAIR_HAL::pwmBegin( uint8_t timer , uint8_t channels )
+{
+    if (timer == 0 || timer == 2 || timer >= HAL_SIM_MAX_TIMERS) return false;
+    simPWMChannels[timer] = channels;
+    return true;
+}
+
+void ALTAIR_HAL::pwmWrite( uint8_t timer , uint8_t channel , uint16_t compareValue )
+{
+    if (timer >= HAL_SIM_MAX_TIMERS) return;
+    ++simStats.pwmWrites;
+    simPWM[timer][channelIndex(channel)] = compareValue;
+}
+
+ALTAIR_HALUart* ALTAIR_HAL::uart( uint8_t serialID )
+{
+    return (serialID < HAL_MAX_UARTS) ? &simUart[serialID] : NULL;
+}
+
+void ALTAIR_HAL::i2cBegin(                                          ) { }
+
+// (A repeated start takes the same bus time as a stop and a start, and the
+//  simulated devices do not tell them apart, so sendStop is not needed.)
+bool ALTAIR_HAL::i2cWrite( uint8_t address , const uint8_t* bytes , uint8_t numBytes , bool /* sendStop */ )
+{
+    i2cFlush();
+    ++simStats.i2cTransactions;
+    simStats.i2cBytes      += numBytes + 1;
+    simStats.i2cBusyMicros += HAL_SIM_I2C_MICROS_PER_BYTE * (numBytes + 1);
+    simMicros              += HAL_SIM_I2C_MICROS_PER_BYTE * (numBytes + 1);
+    ALTAIR_HALSimI2CDevice* device = simI2C[address & 0x7F];
+    if (device == NULL || !device->i2cWrite(bytes, numBytes)) {
+        ++simStats.i2cNacks;
+        return false;
+    }
+    return true;
+}
+
+uint8_t ALTAIR_HAL::i2cRead( uint8_t address , uint8_t* bytes , uint8_t numBytes )
+{
+    i2cFlush();
+    ++simStats.i2cTransactions;
+    simStats.i2cBytes      += numBytes + 1;
+    simStats.i2cBusyMicros += HAL_SIM_I2C_MICROS_PER_BYTE * (numBytes + 1);
+    simMicros              += HAL_SIM_I2C_MICROS_PER_BYTE * (numBytes + 1);
+    ALTAIR_HALSimI2CDevice* device = simI2C[address & 0x7F];
+    if (device == NULL) {
+        ++simStats.i2cNacks;
+        return 0;
+    }
+    return device->i2cRead(bytes, numBytes);
+}
+
+/**************************************************************************/
+/*!
+ @brief  The bytes on the bus for a queued request: its write (with the
+         address byte), and its read (likewise).
+*/
+/**************************************************************************/
+static uint8_t simRequestBytes( const ALTAIR_HALI2CRequest* request )
+{
+    uint8_t bytes = 0;
+    if (request->numWrite > 0 || request->numRead == 0) bytes += request->numWrite + 1;
+    if (request->numRead  > 0)                          bytes += request->numRead  + 1;
+    return bytes;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Start the active request at startMicros.
+*/
+/**************************************************************************/
+static void simBeginRequest( unsigned long long startMicros )
+{
+    ALTAIR_HALI2CRequest* request = simQueue[SIM_QUEUE_INDEX(simQueueActive)];
+    request->status    = HAL_I2C_ACTIVE;
+    simActiveBytesLeft = simRequestBytes(request);
+    simActiveDueMicros = startMicros + HAL_SIM_I2C_MICROS_PER_BYTE * (simI2CPolled ? 1 : simActiveBytesLeft);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Finish the active request: talk to its device (the write, and
+         then the read), and start the next one at endMicros.
+*/
+/**************************************************************************/
+static void simFinishRequest( unsigned long long endMicros )
+{
+    ALTAIR_HALI2CRequest*   request = simQueue[SIM_QUEUE_INDEX(simQueueActive)];
+    ALTAIR_HALSimI2CDevice* device  = simI2C[request->address & 0x7F];
+    bool                    acked   = (device != NULL);
+    if (request->numWrite > 0 || request->numRead == 0) {
+        ++simStats.i2cTransactions;
+        simStats.i2cBytes += request->numWrite + 1;
+        acked = acked && device->i2cWrite(request->writeBytes, request->numWrite);
+    }
+    if (acked && request->numRead > 0) {
+        ++simStats.i2cTransactions;
+        simStats.i2cBytes   += request->numRead + 1;
+        request->numReceived = device->i2cRead(request->readBytes, request->numRead);
+    }
+    if (!acked) ++simStats.i2cNacks;
+    simStats.i2cBusyMicros += HAL_SIM_I2C_MICROS_PER_BYTE * simRequestBytes(request);
+    request->status = acked ? HAL_I2C_DONE : HAL_I2C_NACK;
+    ++simQueueActive;
+    if (simQueueActive != simQueueEnd) simBeginRequest(endMicros);
+}
+
+bool ALTAIR_HAL::i2cSubmit( ALTAIR_HALI2CRequest* request           )
+{
+    if (request == NULL || (uint8_t) (simQueueEnd - simQueueTail) >= HAL_I2C_QUEUE_LENGTH) return false;
+    request->status      = HAL_I2C_QUEUED;
+    request->numReceived = 0;
+    simQueue[SIM_QUEUE_INDEX(simQueueEnd)] = request;
+    bool idle = (simQueueActive == simQueueEnd);
+    ++simQueueEnd;
+    ++simStats.i2cRequests;
+    if (idle) simBeginRequest(simMicros);
+    return true;
+}
+
+void ALTAIR_HAL::i2cService(                                        )
+{
+    if (simI2CPolled) {
+        if (simQueueActive != simQueueEnd && simMicros >= simActiveDueMicros) {   // (one byte per call, as TWINT is polled)
+            if (--simActiveBytesLeft == 0) simFinishRequest(simMicros);
+            else                           simActiveDueMicros = simMicros + HAL_SIM_I2C_MICROS_PER_BYTE;
+        }
+    } else {
+        while (simQueueActive != simQueueEnd && simMicros >= simActiveDueMicros) simFinishRequest(simActiveDueMicros);
+    }
+    while (simQueueTail != simQueueActive) {
+        ALTAIR_HALI2CRequest* request = simQueue[SIM_QUEUE_INDEX(simQueueTail)];
+        ++simQueueTail;
+        if (request->callback) request->callback(request);
+    }
+}
+
+bool ALTAIR_HAL::i2cIdle(                                           ) { return simQueueTail == simQueueEnd ; }
+
+void ALTAIR_HAL::i2cFlush(                                          )
+{
+    while (!i2cIdle()) {
+        if (simQueueActive != simQueueEnd && simMicros < simActiveDueMicros) simMicros = simActiveDueMicros;
+        i2cService();
+    }
+}
+
+void ALTAIR_HAL::spiBegin(                                          ) { }
+
+uint8_t ALTAIR_HAL::spiTransfer( uint8_t aByte )
+{
+    ++simStats.spiBytes;
+    simMicros += HAL_SIM_SPI_MICROS_PER_BYTE;
+    return simSPI ? simSPI->spiTransfer(aByte) : 0xFF;
+}
+
+/**************************************************************************/
+/*!
+ @brief  The simulation controls.
+*/
+/**************************************************************************/
+void ALTAIR_HALSim::reset(                                          )
+{
+    simMicros = 0;
+    memset(simPinLevel,    0, sizeof(simPinLevel));
+    memset(simPinMode,     0, sizeof(simPinMode));
+    memset(simADC,         0, sizeof(simADC));
+    memset(simPWM,         0, sizeof(simPWM));
+    memset(simPWMChannels, 0, sizeof(simPWMChannels));
+    memset(simI2C,         0, sizeof(simI2C));
+    memset(&simStats,      0, sizeof(simStats));
+    simSPI = NULL;
+    simQueueTail = simQueueActive = simQueueEnd = 0;
+    simI2CPolled = false;
+    for (uint8_t i = 0; i < HAL_MAX_UARTS; ++i) simUart[i] = ALTAIR_HALSimUart();
+}
+
+void                ALTAIR_HALSim::setMicros(     unsigned long long micros ) { simMicros  = micros                          ; }
+void                ALTAIR_HALSim::advanceMicros( unsigned long long micros ) { simMicros += micros                          ; }
+unsigned long long  ALTAIR_HALSim::micros(                                  ) { return simMicros                             ; }
+
+void     ALTAIR_HALSim::setPin(     uint8_t pin , uint8_t  level    ) { if (pin < HAL_SIM_MAX_PINS) simPinLevel[pin] = level ? HAL_HIGH : HAL_LOW ; }
+uint8_t  ALTAIR_HALSim::pin(        uint8_t pin                     ) { return (pin < HAL_SIM_MAX_PINS) ? simPinLevel[pin] : HAL_LOW         ; }
+uint8_t  ALTAIR_HALSim::pinMode(    uint8_t pin                     ) { return (pin < HAL_SIM_MAX_PINS) ? simPinMode[pin]  : HAL_INPUT       ; }
+void     ALTAIR_HALSim::setADC(     uint8_t pin , uint16_t value    ) { simADC[pin % HAL_SIM_MAX_ADC_CHANNELS] = value                       ; }
+uint16_t ALTAIR_HALSim::pwmCompare( uint8_t timer , uint8_t channel ) { return (timer < HAL_SIM_MAX_TIMERS) ? simPWM[timer][channelIndex(channel)] : 0 ; }
+uint8_t  ALTAIR_HALSim::pwmChannels( uint8_t timer                  ) { return (timer < HAL_SIM_MAX_TIMERS) ? simPWMChannels[timer] : 0     ; }
+
+ALTAIR_HALSimUart*  ALTAIR_HALSim::uart(      uint8_t serialID      ) { return (serialID < HAL_MAX_UARTS) ? &simUart[serialID] : NULL       ; }
+void     ALTAIR_HALSim::attachI2C(  uint8_t address , ALTAIR_HALSimI2CDevice* device ) { simI2C[address & 0x7F] = device                     ; }
+void     ALTAIR_HALSim::attachSPI(  ALTAIR_HALSimSPIDevice* device  ) { simSPI = device                                                      ; }
+void     ALTAIR_HALSim::setI2CPolled( bool polled                   ) { simI2CPolled = polled                                                ; }
+ALTAIR_HALSimStats* ALTAIR_HALSim::stats(                           ) { return &simStats                                                     ; }
+
+#endif    //   ifndef ARDUINO
@@ -63,17 +63,17 @@ ALTAIR_DiffLEDLightSource::ALTAIR_DiffLEDLightSource(                          )
 /**************************************************************************/
 void ALTAIR_DiffLEDLightSource::initialize(                                   )
 {
-  pinMode(_yellowLEDsPin, OUTPUT);
-  pinMode(_redLEDsPin,    OUTPUT);
-  pinMode(_blueLEDsPin,   OUTPUT);
-  pinMode(_greenLEDsPin,  OUTPUT);
+  ALTAIR_HAL::gpioMode(_yellowLEDsPin, HAL_OUTPUT);
+  ALTAIR_HAL::gpioMode(_redLEDsPin,    HAL_OUTPUT);
+  ALTAIR_HAL::gpioMode(_blueLEDsPin,   HAL_OUTPUT);
+  ALTAIR_HAL::gpioMode(_greenLEDsPin,  HAL_OUTPUT);
 
   setInitialized(               );
 
 // Normal situation: flash yellow LEDs then NO lights on (formerly it was yellow LEDs and green  
 // laser on, but that heats up the I-drive transistor too much).
   flashYellowLEDs(              );
-  delay(                  20    );
+  ALTAIR_HAL::clockDelay(       20    );
   resetLights(                  );
 }
 
@@ -86,10 +86,10 @@ void ALTAIR_DiffLEDLightSource::initialize(                                   )
 void ALTAIR_DiffLEDLightSource::resetLights(                              )
 {
   if (isInitialized(                   )) {
-      digitalWrite(_yellowLEDsPin, _yellowLEDsState ); 
-      digitalWrite(_redLEDsPin,    _redLEDsState    ); 
-      digitalWrite(_blueLEDsPin,   _blueLEDsState   ); 
-      digitalWrite(_greenLEDsPin,  _greenLEDsState  ); 
+      ALTAIR_HAL::gpioWrite(_yellowLEDsPin, _yellowLEDsState ); 
+      ALTAIR_HAL::gpioWrite(_redLEDsPin,    _redLEDsState    ); 
+      ALTAIR_HAL::gpioWrite(_blueLEDsPin,   _blueLEDsState   ); 
+      ALTAIR_HAL::gpioWrite(_greenLEDsPin,  _greenLEDsState  ); 
   }
 }
 
@@ -158,7 +158,7 @@ void ALTAIR_DiffLEDLightSource::turnOffLEDs(                                  )
 void ALTAIR_DiffLEDLightSource::flashYellowLEDs(                   )
 {
   if (isInitialized(                   )) {
-      digitalWrite(_yellowLEDsPin, !_yellowLEDsState ); 
+      ALTAIR_HAL::gpioWrite(_yellowLEDsPin, !_yellowLEDsState ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -171,7 +171,7 @@ void ALTAIR_DiffLEDLightSource::flashYellowLEDs(                   )
 void ALTAIR_DiffLEDLightSource::flashRedLEDs(                                )
 {
   if (isInitialized(                   )) {
-      digitalWrite(_redLEDsPin,    !_redLEDsState    );
+      ALTAIR_HAL::gpioWrite(_redLEDsPin,    !_redLEDsState    );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -184,7 +184,7 @@ void ALTAIR_DiffLEDLightSource::flashRedLEDs(                                )
 void ALTAIR_DiffLEDLightSource::flashBlueLEDs(                                )
 {
   if (isInitialized(                   )) {
-      digitalWrite(_blueLEDsPin,   !_blueLEDsState  ); 
+      ALTAIR_HAL::gpioWrite(_blueLEDsPin,   !_blueLEDsState  ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -198,7 +198,7 @@ void ALTAIR_DiffLEDLightSource::turnOnBlueLEDs(     )
 {
   if (isInitialized(                               )) {
      _blueLEDsState   = HIGH ;   // turn these LEDs on (HIGH is the voltage level)
-      digitalWrite(_blueLEDsPin,   _blueLEDsState   );
+      ALTAIR_HAL::gpioWrite(_blueLEDsPin,   _blueLEDsState   );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -212,7 +212,7 @@ void ALTAIR_DiffLEDLightSource::turnOffBlueLEDs(    )
 {
   if (isInitialized(                               )) {
      _blueLEDsState   = LOW  ;   // turn these LEDs off (LOW is the voltage level)
-      digitalWrite(_blueLEDsPin,   _blueLEDsState   );
+      ALTAIR_HAL::gpioWrite(_blueLEDsPin,   _blueLEDsState   );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -226,7 +226,7 @@ void ALTAIR_DiffLEDLightSource::turnOnGreenLEDs(     )
 {
   if (isInitialized(                                )) {
      _greenLEDsState   = HIGH ;   // turn these LEDs on (HIGH is the voltage level)
-      digitalWrite(_greenLEDsPin,   _greenLEDsState  );
+      ALTAIR_HAL::gpioWrite(_greenLEDsPin,   _greenLEDsState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -240,7 +240,7 @@ void ALTAIR_DiffLEDLightSource::turnOffGreenLEDs(    )
 {
   if (isInitialized(                                )) {
      _greenLEDsState   = LOW  ;   // turn these LEDs off (LOW is the voltage level)
-      digitalWrite(_greenLEDsPin,   _greenLEDsState  );
+      ALTAIR_HAL::gpioWrite(_greenLEDsPin,   _greenLEDsState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -254,7 +254,7 @@ void ALTAIR_DiffLEDLightSource::turnOnYellowLEDs(     )
 {
   if (isInitialized(                                )) {
      _yellowLEDsState   = HIGH ;   // turn these LEDs on (HIGH is the voltage level)
-      digitalWrite(_yellowLEDsPin,   _yellowLEDsState  );
+      ALTAIR_HAL::gpioWrite(_yellowLEDsPin,   _yellowLEDsState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -268,7 +268,7 @@ void ALTAIR_DiffLEDLightSource::turnOffYellowLEDs(    )
 {
   if (isInitialized(                                )) {
      _yellowLEDsState   = LOW  ;   // turn these LEDs off (LOW is the voltage level)
-      digitalWrite(_yellowLEDsPin,   _yellowLEDsState  );
+      ALTAIR_HAL::gpioWrite(_yellowLEDsPin,   _yellowLEDsState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -282,7 +282,7 @@ void ALTAIR_DiffLEDLightSource::turnOnRedLEDs(     )
 {
   if (isInitialized(                                )) {
      _redLEDsState   = HIGH ;   // turn these LEDs on (HIGH is the voltage level)
-      digitalWrite(_redLEDsPin,   _redLEDsState  );
+      ALTAIR_HAL::gpioWrite(_redLEDsPin,   _redLEDsState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -296,7 +296,7 @@ void ALTAIR_DiffLEDLightSource::turnOffRedLEDs(    )
 {
   if (isInitialized(                                )) {
      _redLEDsState   = LOW  ;   // turn these LEDs off (LOW is the voltage level)
-      digitalWrite(_redLEDsPin,   _redLEDsState  );
+      ALTAIR_HAL::gpioWrite(_redLEDsPin,   _redLEDsState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
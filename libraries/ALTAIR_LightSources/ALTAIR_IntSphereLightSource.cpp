@@ -65,10 +65,10 @@ ALTAIR_IntSphereLightSource::ALTAIR_IntSphereLightSource(
 /**************************************************************************/
 void ALTAIR_IntSphereLightSource::initialize(                                          )
 {
-  pinMode(_green532nmLaserPin, OUTPUT);
-  pinMode(_red670nmLaserPin,   OUTPUT);
-  pinMode(_red635nmLaserPin,   OUTPUT);
-  pinMode(_blue440nmLaserPin,  OUTPUT);
+  ALTAIR_HAL::gpioMode(_green532nmLaserPin, HAL_OUTPUT);
+  ALTAIR_HAL::gpioMode(_red670nmLaserPin,   HAL_OUTPUT);
+  ALTAIR_HAL::gpioMode(_red635nmLaserPin,   HAL_OUTPUT);
+  ALTAIR_HAL::gpioMode(_blue440nmLaserPin,  HAL_OUTPUT);
 
   setInitialized(                    );
 
@@ -84,10 +84,10 @@ void ALTAIR_IntSphereLightSource::initialize(
 void ALTAIR_IntSphereLightSource::resetLights(                                         )
 {
   if (isInitialized(                       )) {
-      digitalWrite(_green532nmLaserPin, _green532nmLaserState );
-      digitalWrite(_red670nmLaserPin,   _red670nmLaserState   );
-      digitalWrite(_red635nmLaserPin,   _red635nmLaserState   );
-      digitalWrite(_blue440nmLaserPin,  _blue440nmLaserState  );
+      ALTAIR_HAL::gpioWrite(_green532nmLaserPin, _green532nmLaserState );
+      ALTAIR_HAL::gpioWrite(_red670nmLaserPin,   _red670nmLaserState   );
+      ALTAIR_HAL::gpioWrite(_red635nmLaserPin,   _red635nmLaserState   );
+      ALTAIR_HAL::gpioWrite(_blue440nmLaserPin,  _blue440nmLaserState  );
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -156,7 +156,7 @@ void ALTAIR_IntSphereLightSource::turnOffLasers(
 void ALTAIR_IntSphereLightSource::flashBlueLaser(                                     )
 {
   if (isInitialized(                        )) {
-      digitalWrite(_blue440nmLaserPin,  !_blue440nmLaserState); 
+      ALTAIR_HAL::gpioWrite(_blue440nmLaserPin,  !_blue440nmLaserState); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -169,7 +169,7 @@ void ALTAIR_IntSphereLightSource::flashBlueLaser(
 void ALTAIR_IntSphereLightSource::flashRed635nmLaser(                                 )
 {
   if (isInitialized(                        )) {
-      digitalWrite(_red635nmLaserPin,  !_red635nmLaserState); 
+      ALTAIR_HAL::gpioWrite(_red635nmLaserPin,  !_red635nmLaserState); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -183,7 +183,7 @@ void ALTAIR_IntSphereLightSource::turnOnBlueLaser(           )
 {
   if (isInitialized(                                        )) {
      _blue440nmLaserState              = HIGH                 ;  // turn this laser on (HIGH is the voltage level)
-      digitalWrite(_blue440nmLaserPin,  _blue440nmLaserState ); 
+      ALTAIR_HAL::gpioWrite(_blue440nmLaserPin,  _blue440nmLaserState ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -197,7 +197,7 @@ void ALTAIR_IntSphereLightSource::turnOffBlueLaser(          )
 {
   if (isInitialized(                                        )) {
      _blue440nmLaserState              = LOW                  ;  // turn this laser off (LOW is the voltage level)
-      digitalWrite(_blue440nmLaserPin,  _blue440nmLaserState ); 
+      ALTAIR_HAL::gpioWrite(_blue440nmLaserPin,  _blue440nmLaserState ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -211,7 +211,7 @@ void ALTAIR_IntSphereLightSource::turnOnGreenLaser(          )
 {
   if (isInitialized(                                        )) {
      _green532nmLaserState             = HIGH                 ;  // turn this laser on (HIGH is the voltage level)
-      digitalWrite(_green532nmLaserPin, _green532nmLaserState); 
+      ALTAIR_HAL::gpioWrite(_green532nmLaserPin, _green532nmLaserState); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -225,7 +225,7 @@ void ALTAIR_IntSphereLightSource::turnOffGreenLaser(         )
 {
   if (isInitialized(                                        )) {
      _green532nmLaserState             = LOW                  ;  // turn this laser off (LOW is the voltage level)
-      digitalWrite(_green532nmLaserPin, _green532nmLaserState); 
+      ALTAIR_HAL::gpioWrite(_green532nmLaserPin, _green532nmLaserState); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -239,7 +239,7 @@ void ALTAIR_IntSphereLightSource::turnOnRed635nmLaser(       )
 {
   if (isInitialized(                                        )) {
      _red635nmLaserState               = HIGH                 ;  // turn this laser on (HIGH is the voltage level)
-      digitalWrite(_red635nmLaserPin,   _red635nmLaserState  ); 
+      ALTAIR_HAL::gpioWrite(_red635nmLaserPin,   _red635nmLaserState  ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -253,7 +253,7 @@ void ALTAIR_IntSphereLightSource::turnOffRed635nmLaser(      )
 {
   if (isInitialized(                                        )) {
      _red635nmLaserState               = LOW                  ;  // turn this laser off (LOW is the voltage level)
-      digitalWrite(_red635nmLaserPin,   _red635nmLaserState  ); 
+      ALTAIR_HAL::gpioWrite(_red635nmLaserPin,   _red635nmLaserState  ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -267,7 +267,7 @@ void ALTAIR_IntSphereLightSource::turnOnRed670nmLaser(       )
 {
   if (isInitialized(                                        )) {
      _red670nmLaserState               = HIGH                 ;  // turn this laser on (HIGH is the voltage level)
-      digitalWrite(_red670nmLaserPin,   _red670nmLaserState  ); 
+      ALTAIR_HAL::gpioWrite(_red670nmLaserPin,   _red670nmLaserState  ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
@@ -281,7 +281,7 @@ void ALTAIR_IntSphereLightSource::turnOffRed670nmLaser(      )
 {
   if (isInitialized(                                        )) {
      _red670nmLaserState               = LOW                  ;  // turn this laser off (LOW is the voltage level)
-      digitalWrite(_red670nmLaserPin,   _red670nmLaserState  ); 
+      ALTAIR_HAL::gpioWrite(_red670nmLaserPin,   _red670nmLaserState  ); 
   }
 // There probably should be some sort of error if the light source is not initialized yet...
 }
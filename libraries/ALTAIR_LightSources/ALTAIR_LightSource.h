@@ -27,6 +27,7 @@
 #define ALTAIR_LightSource_h
 
 #include "Arduino.h"
+#include <ALTAIR_HAL.h>
 
 class ALTAIR_LightSource {
   public:
@@ -0,0 +1,253 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_MicroRegisterMap.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the I2C register map of the Arduino Micro propulsion monitor
+    (the I2C slave at address 0x08), shared by the Micro's own sketch and
+    by ALTAIR_ArduinoMicro on the Mega (the I2C master).
+
+    The Micro's loop() fills in one snapshot (4 packed RPMs, 4 packed
+    currents, and 8 packed temps) while the I2C interrupt answers from the
+    other one, which is complete; publish() then swaps them, with a single
+    byte store.  So a read can never see a snapshot half-way through being
+    updated, as it could when the I2C interrupt sent the arrays that loop()
+    was writing.
+
+    The master selects a register (i.e. a block of the snapshot) by writing
+    its number; the selection stays until it is changed, so reading the
+    same block again is just a read.  Each response is:
+
+      [register] [sequence] [age (ms), MSB] [age, LSB] [block ...] [CRC-8]
+
+    where the register is echoed (so that a Micro that has reset, and lost
+    the selection, is noticed), the sequence number counts the snapshots
+    (1 to 255, then 1 again; 0 means that there has not been one yet), the
+    age is how long ago the snapshot was taken, and the CRC-8 (polynomial
+    0x07) covers everything before it.  Until a register is selected, the
+    Micro answers with the bare 16 bytes, as it did before.
+
+    From version 2, each snapshot also has an extended block of 16-bit
+    (big-endian) values, which do not saturate as the packed bytes do (at
+    127 revolutions per second, 31.75 A, and 63.5 degrees C):
+
+      RPMs          unsigned, in RPM
+      currents      signed, in units of 10 mA
+      temps         signed, in units of 0.1 degrees C
+
+    It is read in two halves (each block must fit in the Wire library's
+    32-byte buffer, with the header and CRC), and only when the master
+    has checked MICRO_REG_VERSION.
+
+    This file does not depend upon the Arduino libraries, so that both
+    ends can also be modelled on a host computer (see
+    tools/ALTAIRMicroRegisterMapSim.cpp).
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_MicroRegisterMap_h
+#define   ALTAIR_MicroRegisterMap_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+typedef   uint8_t   byte;
+#endif
+
+#define   MICRO_REGMAP_VERSION           2
+#define   MICRO_REGMAP_EXTENDED_VERSION  2          // the first version with the extended block
+
+#define   MICRO_SNAPSHOT_RPM             0          // the offsets into the snapshot
+#define   MICRO_SNAPSHOT_CURRENT         4
+#define   MICRO_SNAPSHOT_TEMP            8
+#define   MICRO_SNAPSHOT_COMPACT_LENGTH 16
+#define   MICRO_SNAPSHOT_EXT_RPM        16          // (2 bytes each, from here on)
+#define   MICRO_SNAPSHOT_EXT_CURRENT    24
+#define   MICRO_SNAPSHOT_EXT_TEMP       32
+#define   MICRO_SNAPSHOT_LENGTH         48
+
+#define   MICRO_REG_ALL               0x00          // the whole compact snapshot (16 bytes)
+#define   MICRO_REG_RPM               0x01          // the 4 packed RPMs
+#define   MICRO_REG_CURRENT           0x02          // the 4 packed currents
+#define   MICRO_REG_TEMP              0x03          // the 8 packed temps
+#define   MICRO_REG_PROPULSION        0x04          // the RPMs and the currents (8 bytes)
+#define   MICRO_REG_EXT_PROPULSION    0x05          // the extended RPMs and currents (16 bytes)
+#define   MICRO_REG_EXT_TEMP          0x06          // the extended temps (16 bytes)
+#define   MICRO_REG_VERSION           0x0F          // MICRO_REGMAP_VERSION (1 byte)
+#define   MICRO_REG_LEGACY            0xFF          // the whole compact snapshot, bare (the default, until a register is selected)
+#define   MICRO_REG_NONE              0xFE          // (for the master: no register known to be selected)
+
+#define   MICRO_REGMAP_HEADER_LENGTH     4          // the register, sequence, and age
+#define   MICRO_REGMAP_OVERHEAD          5          // ... and the CRC
+#define   MICRO_REGMAP_MAX_BLOCK        16
+#define   MICRO_REGMAP_MAX_RESPONSE     (MICRO_REGMAP_OVERHEAD + MICRO_REGMAP_MAX_BLOCK)
+
+/**************************************************************************/
+/*!
+ @brief  The CRC-8 (polynomial 0x07, initial value 0) of some bytes.
+*/
+/**************************************************************************/
+inline uint8_t microRegisterMapCRC( const byte* data , uint8_t length )
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit) crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+    }
+    return crc;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Where a register's block is in the snapshot, and how long it is
+         (0 for MICRO_REG_VERSION, or for a register that does not exist).
+*/
+/**************************************************************************/
+inline uint8_t microRegisterOffset( uint8_t reg )
+{
+    switch (reg) {
+      case MICRO_REG_CURRENT:    return MICRO_SNAPSHOT_CURRENT;
+      case MICRO_REG_TEMP:       return MICRO_SNAPSHOT_TEMP;
+      case MICRO_REG_EXT_PROPULSION: return MICRO_SNAPSHOT_EXT_RPM;
+      case MICRO_REG_EXT_TEMP:   return MICRO_SNAPSHOT_EXT_TEMP;
+      default:                   return MICRO_SNAPSHOT_RPM;
+    }
+}
+
+inline uint8_t microRegisterLength( uint8_t reg )
+{
+    switch (reg) {
+      case MICRO_REG_ALL:        return MICRO_SNAPSHOT_COMPACT_LENGTH;
+      case MICRO_REG_RPM:        return 4;
+      case MICRO_REG_CURRENT:    return 4;
+      case MICRO_REG_TEMP:       return 8;
+      case MICRO_REG_PROPULSION: return 8;
+      case MICRO_REG_EXT_PROPULSION: return 16;
+      case MICRO_REG_EXT_TEMP:   return 16;
+      case MICRO_REG_VERSION:    return 1;
+      default:                   return 0;
+    }
+}
+
+/**************************************************************************/
+/*!
+    The Micro's (i.e. the slave's) end: the double-buffered snapshot.
+*/
+/**************************************************************************/
+class     ALTAIR_MicroRegisterMap {
+  public:
+    ALTAIR_MicroRegisterMap(                                                        ) ;
+
+    void                publish(        const byte*           packedRPM           ,       // From loop(): copy in a new snapshot, then
+                                        const byte*           packedCurrent       ,       //    make it the one that is read.
+                                        const byte*           packedTemp          ,
+                                        const uint16_t*       rpm                 ,       // (the extended values: in RPM,
+                                        const int16_t*        current             ,       //    in 10 mA,
+                                        const int16_t*        temp                ,       //    and in 0.1 degrees C)
+                                        unsigned long         currentMillis         ) ;
+    void                select(         uint8_t               reg                   ) ;   // From the I2C receive interrupt.
+    uint8_t             respond(        byte*                 response            ,       // From the I2C request interrupt: returns
+                                        unsigned long         currentMillis         ) ;   //    the # of bytes to send.
+    uint8_t             sequence(                                                   ) { return _snapshot[_front].sequence ; }
+
+    static void         putWord(        byte*                 data                ,       // (big-endian)
+                                        uint16_t              value                 ) { data[0] = (byte) (value >> 8); data[1] = (byte) (value & 0xFF) ; }
+    static uint16_t     getWord(        const byte*           data                  ) { return ((uint16_t) data[0] << 8) | data[1] ; }
+
+  private:
+    struct Snapshot {
+        byte            data[MICRO_SNAPSHOT_LENGTH]                                 ;
+        uint8_t         sequence                                                    ;
+        unsigned long   takenMillis                                                 ;
+    };
+    Snapshot            _snapshot[2]                                                ;
+    volatile uint8_t    _front                                                      ;  // the one that is read
+    volatile uint8_t    _register                                                   ;
+};
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.
+*/
+/**************************************************************************/
+inline ALTAIR_MicroRegisterMap::ALTAIR_MicroRegisterMap() : _front(0), _register(MICRO_REG_LEGACY)
+{
+    for (uint8_t s = 0; s < 2; ++s) {
+        for (uint8_t i = 0; i < MICRO_SNAPSHOT_LENGTH; ++i) _snapshot[s].data[i] = 0;
+        _snapshot[s].sequence    = 0;
+        _snapshot[s].takenMillis = 0;
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Fill in the back snapshot, and then swap it to the front.  (The
+         I2C interrupt only ever reads the front one, and the swap is one
+         byte store, so no interrupt can see a half-written snapshot.)
+*/
+/**************************************************************************/
+inline void ALTAIR_MicroRegisterMap::publish( const byte*     packedRPM , const byte*    packedCurrent , const byte*    packedTemp ,
+                                              const uint16_t* rpm       , const int16_t* current       , const int16_t* temp       ,
+                                              unsigned long   currentMillis )
+{
+    uint8_t   back     = 1 - _front;
+    Snapshot& snapshot = _snapshot[back];
+    for (uint8_t i = 0; i < 4; ++i) snapshot.data[MICRO_SNAPSHOT_RPM     + i] = packedRPM[i];
+    for (uint8_t i = 0; i < 4; ++i) snapshot.data[MICRO_SNAPSHOT_CURRENT + i] = packedCurrent[i];
+    for (uint8_t i = 0; i < 8; ++i) snapshot.data[MICRO_SNAPSHOT_TEMP    + i] = packedTemp[i];
+    for (uint8_t i = 0; i < 4; ++i) putWord(snapshot.data + MICRO_SNAPSHOT_EXT_RPM     + 2*i, rpm[i]);
+    for (uint8_t i = 0; i < 4; ++i) putWord(snapshot.data + MICRO_SNAPSHOT_EXT_CURRENT + 2*i, (uint16_t) current[i]);
+    for (uint8_t i = 0; i < 8; ++i) putWord(snapshot.data + MICRO_SNAPSHOT_EXT_TEMP    + 2*i, (uint16_t) temp[i]);
+    snapshot.sequence    = (_snapshot[_front].sequence == 255) ? 1 : _snapshot[_front].sequence + 1;
+    snapshot.takenMillis = currentMillis;
+    _front = back;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Select the register that the following reads will get (an
+         unknown one gets just the header and the CRC, which the master
+         will reject).
+*/
+/**************************************************************************/
+inline void ALTAIR_MicroRegisterMap::select( uint8_t reg )
+{
+    _register = reg;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Build the response to a read of the selected register.
+*/
+/**************************************************************************/
+inline uint8_t ALTAIR_MicroRegisterMap::respond( byte* response , unsigned long currentMillis )
+{
+    const Snapshot& snapshot = _snapshot[_front];
+    uint8_t         reg      = _register;
+    if (reg == MICRO_REG_LEGACY) {
+        for (uint8_t i = 0; i < MICRO_SNAPSHOT_COMPACT_LENGTH; ++i) response[i] = snapshot.data[i];
+        return MICRO_SNAPSHOT_COMPACT_LENGTH;
+    }
+    unsigned long age    = currentMillis - snapshot.takenMillis;
+    uint8_t       length = microRegisterLength(reg);
+    uint8_t       offset = microRegisterOffset(reg);
+    if (age > 0xFFFF) age = 0xFFFF;
+    response[0] = reg;
+    response[1] = snapshot.sequence;
+    response[2] = (byte) (age >> 8);
+    response[3] = (byte) (age & 0xFF);
+    if (reg == MICRO_REG_VERSION) response[MICRO_REGMAP_HEADER_LENGTH] = MICRO_REGMAP_VERSION;
+    else for (uint8_t i = 0; i < length; ++i) response[MICRO_REGMAP_HEADER_LENGTH + i] = snapshot.data[offset + i];
+    response[MICRO_REGMAP_HEADER_LENGTH + length] = microRegisterMapCRC(response, MICRO_REGMAP_HEADER_LENGTH + length);
+    return MICRO_REGMAP_OVERHEAD + length;
+}
+
+#endif    //   ifndef ALTAIR_MicroRegisterMap_h
@@ -69,6 +69,6 @@ float ALTAIR_BleedSystem::minSafeSetting(                                    )
 /**************************************************************************/
 void ALTAIR_BleedSystem::resetPWMRegister(                                   )
 {
-    BLEEDVALVE_SERVO_PWMOUTPUT_REG  =   PWM_PEDESTAL_VALUE + 2*reportSetting() ;
+    ALTAIR_HAL::pwmWrite( SERVO_MOTORS_PWM_TIMER , BLEEDVALVE_SERVO_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*reportSetting() );
 }
 
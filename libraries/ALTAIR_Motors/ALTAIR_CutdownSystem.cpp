@@ -65,6 +65,6 @@ float ALTAIR_CutdownSystem::minSafeSetting(                             )
 /**************************************************************************/
 void ALTAIR_CutdownSystem::resetPWMRegister(                            )
 {
-    CUTDOWN_SERVO_PWMOUTPUT_REG  = PWM_PEDESTAL_VALUE + 2*reportSetting() ;
+    ALTAIR_HAL::pwmWrite( SERVO_MOTORS_PWM_TIMER , CUTDOWN_SERVO_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*reportSetting() );
 }
 
@@ -139,7 +139,6 @@ void ALTAIR_GlobalMotorControl::initializeServoControlRegisters(
 //  TCCR3A = _BV(COM3A1) | _BV(COM3B1) | _BV(COM3C1) | _BV(WGM32) | _BV(WGM31);
 //  TCCR3B = _BV(CS32);
 
-  SERVO_MOTORS_PWMTIMER_REG_A = _BV(COM4A1) | _BV(COM4B1) | _BV(COM4C1) | _BV(WGM42) | _BV(WGM41);
-  SERVO_MOTORS_PWMTIMER_REG_B = _BV(CS42);
+  ALTAIR_HAL::pwmBegin( SERVO_MOTORS_PWM_TIMER , HAL_PWM_CHANNEL_A | HAL_PWM_CHANNEL_B | HAL_PWM_CHANNEL_C );
 
 }
@@ -112,16 +112,16 @@ void ALTAIR_MotorAndESC::resetPWMRegister(                         )
 {
   switch(_location) {
     case portOuter:
-      PORT_MOTOR_PWMOUTPUT_REG_A  = PWM_PEDESTAL_VALUE + 2*_powerSetting ;
+      ALTAIR_HAL::pwmWrite( PORT_MOTOR_PWM_TIMER , PORT_OUTER_MOTOR_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*_powerSetting );
       break                                                              ;
     case portInner:
-      PORT_MOTOR_PWMOUTPUT_REG_B  = PWM_PEDESTAL_VALUE + 2*_powerSetting ;
+      ALTAIR_HAL::pwmWrite( PORT_MOTOR_PWM_TIMER , PORT_INNER_MOTOR_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*_powerSetting );
       break                                                              ;
     case stbdInner:
-      STBD_MOTOR_PWMOUTPUT_REG_B  = PWM_PEDESTAL_VALUE + 2*_powerSetting ;
+      ALTAIR_HAL::pwmWrite( STBD_MOTOR_PWM_TIMER , STBD_INNER_MOTOR_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*_powerSetting );
       break                                                              ;
     case stbdOuter:
-      STBD_MOTOR_PWMOUTPUT_REG_A  = PWM_PEDESTAL_VALUE + 2*_powerSetting ;
+      ALTAIR_HAL::pwmWrite( STBD_MOTOR_PWM_TIMER , STBD_OUTER_MOTOR_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*_powerSetting );
   }
 }
 
@@ -28,6 +28,7 @@
 #define   ALTAIR_MotorAndESC_h
 
 #include "Arduino.h"
+#include <ALTAIR_HAL.h>
 #include "ALTAIR_RPMSensor.h"
 #include "ALTAIR_CurrentSensor.h"
 #include "ALTAIR_TempSensor.h"
@@ -43,7 +44,7 @@ class ALTAIR_MotorAndESC {
 
     ALTAIR_MotorAndESC()                                                           ;
 
-    void                     initializePinMode()     { pinMode(_pwmPin, OUTPUT)    ; }
+    void                     initializePinMode()     { ALTAIR_HAL::gpioMode(_pwmPin, HAL_OUTPUT) ; }
     void                     initializePWMRegister()                               ;
     bool                     isInitialized()         { return  _isInitialized      ; }
     bool                     isRunning()             { return (_powerSetting > 0.) ; }
@@ -5,7 +5,7 @@
     @license  GPL
 
     This class contains all the #defines for all the servo and propulsion
-    motor fixed connections; the PWM registers; and the max, min, and 
+    motor fixed connections; the PWM timers and channels; and the max, min, and 
     default settings.
 
     Justin Albert  jalbert@uvic.ca     began on 1 Sep. 2018
@@ -19,6 +19,7 @@
 #ifndef   ALTAIR_MotorPWMSettings_h
 #define   ALTAIR_MotorPWMSettings_h
 
+#include  <ALTAIR_HAL.h>
 
 #define   PORT_OUTER_MOTOR_PWM_PIN      45         // The pulse-width modulation digital output pin of  
 #define   PORT_INNER_MOTOR_PWM_PIN      46         // the Arduino Mega 2560 that controls a given motor.
@@ -50,22 +51,18 @@
 #define   PWM_PEDESTAL_VALUE            34         // If the content of the PWM output register is increased
                                                    // above this value, then the motor starts to spin.
 
-#define   PORT_MOTOR_PWMTIMER_REG_A        TCCR5A  // ATmega 2560 timer-counter control register 5A, etc.
-#define   PORT_MOTOR_PWMTIMER_REG_B        TCCR5B
-#define   STBD_MOTOR_PWMTIMER_REG_A        TCCR1A
-#define   STBD_MOTOR_PWMTIMER_REG_B        TCCR1B
+#define   PORT_MOTOR_PWM_TIMER             5       // ATmega 2560 timer-counter 5 (set up and written via ALTAIR_HAL), etc.
+#define   STBD_MOTOR_PWM_TIMER             1
+#define   SERVO_MOTORS_PWM_TIMER           4
 
-#define   SERVO_MOTORS_PWMTIMER_REG_A      TCCR4A  // ATmega 2560 timer-counter control register 4A, etc.
-#define   SERVO_MOTORS_PWMTIMER_REG_B      TCCR4B
+#define   PORT_OUTER_MOTOR_PWM_CHANNEL     HAL_PWM_CHANNEL_A  // output compare register 5A, etc.
+#define   PORT_INNER_MOTOR_PWM_CHANNEL     HAL_PWM_CHANNEL_B
+#define   STBD_OUTER_MOTOR_PWM_CHANNEL     HAL_PWM_CHANNEL_A
+#define   STBD_INNER_MOTOR_PWM_CHANNEL     HAL_PWM_CHANNEL_B
 
-#define   PORT_MOTOR_PWMOUTPUT_REG_A        OCR5A  // ATmega 2560 output control register 5A, etc.
-#define   PORT_MOTOR_PWMOUTPUT_REG_B        OCR5B
-#define   STBD_MOTOR_PWMOUTPUT_REG_A        OCR1A
-#define   STBD_MOTOR_PWMOUTPUT_REG_B        OCR1B
-
-#define   PROPAXLEROT_SERVO_PWMOUTPUT_REG   OCR4A  // ATmega 2560 output control register 4A, etc.
-#define   BLEEDVALVE_SERVO_PWMOUTPUT_REG    OCR4B 
-#define   CUTDOWN_SERVO_PWMOUTPUT_REG       OCR4C
+#define   PROPAXLEROT_SERVO_PWM_CHANNEL    HAL_PWM_CHANNEL_A  // output compare register 4A, etc.
+#define   BLEEDVALVE_SERVO_PWM_CHANNEL     HAL_PWM_CHANNEL_B
+#define   CUTDOWN_SERVO_PWM_CHANNEL        HAL_PWM_CHANNEL_C
 
 
 #endif    //   ifndef ALTAIR_MotorPWMSettings_h
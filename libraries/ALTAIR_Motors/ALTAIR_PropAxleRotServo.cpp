@@ -65,6 +65,6 @@ float ALTAIR_PropAxleRotServo::minSafeSetting(                              )
 /**************************************************************************/
 void ALTAIR_PropAxleRotServo::resetPWMRegister(                             )
 {
-    PROPAXLEROT_SERVO_PWMOUTPUT_REG  = PWM_PEDESTAL_VALUE + 2*reportSetting() ;
+    ALTAIR_HAL::pwmWrite( SERVO_MOTORS_PWM_TIMER , PROPAXLEROT_SERVO_PWM_CHANNEL , PWM_PEDESTAL_VALUE + 2*reportSetting() );
 }
 
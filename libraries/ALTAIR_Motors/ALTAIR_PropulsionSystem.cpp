@@ -64,10 +64,8 @@ void ALTAIR_PropulsionSystem::initializePinModes(
 /**************************************************************************/
 void ALTAIR_PropulsionSystem::initializePropControlRegisters(                            )
 {
-    PORT_MOTOR_PWMTIMER_REG_A = _BV(COM5A1) | _BV(COM5B1) | _BV(WGM52) | _BV(WGM51);
-    PORT_MOTOR_PWMTIMER_REG_B = _BV(CS52);                                    
-    STBD_MOTOR_PWMTIMER_REG_A = _BV(COM1A1) | _BV(COM1B1) | _BV(WGM12) | _BV(WGM11);
-    STBD_MOTOR_PWMTIMER_REG_B = _BV(CS12);
+    ALTAIR_HAL::pwmBegin( PORT_MOTOR_PWM_TIMER , HAL_PWM_CHANNEL_A | HAL_PWM_CHANNEL_B );
+    ALTAIR_HAL::pwmBegin( STBD_MOTOR_PWM_TIMER , HAL_PWM_CHANNEL_A | HAL_PWM_CHANNEL_B );
 }
 
 /**************************************************************************/
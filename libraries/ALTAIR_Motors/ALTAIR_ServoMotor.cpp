@@ -130,8 +130,8 @@ bool ALTAIR_ServoMotor::setSettingTo(   float  newSetting  )
 /**************************************************************************/
 void ALTAIR_ServoMotor::initializePinMode(                                   )
 {
-    pinMode(_pwmPin    , OUTPUT )        ;
-    pinMode(_posADCPin ,  INPUT )        ;
+    ALTAIR_HAL::gpioMode(_pwmPin    , HAL_OUTPUT )        ;
+    ALTAIR_HAL::gpioMode(_posADCPin ,  HAL_INPUT )        ;
 }
 
 /**************************************************************************/
@@ -30,6 +30,7 @@
 #define ALTAIR_ServoMotor_h
 
 #include "Arduino.h"
+#include <ALTAIR_HAL.h>
 
 #define   ALTAIRSERVO_VOLTSPERADU                        (0.0049)
 
@@ -49,7 +50,7 @@ class ALTAIR_ServoMotor {
     bool                     halfDecrementSetting(                       )                                                             ;   // Decrease setting by 0.5.  Returns true if successful.
     bool                     setSettingTo(          float newSetting     )                                                             ;   // Returns true if successful.
 
-    float                    reportPosition(                             ) {  return  ALTAIRSERVO_VOLTSPERADU * analogRead(_posADCPin) ; } // Determine and report present position (in volts).
+    float                    reportPosition(                             ) {  return  ALTAIRSERVO_VOLTSPERADU * ALTAIR_HAL::adcRead(_posADCPin) ; } // Determine and report present position (in volts).
 
     void                     initializePinMode(                          )                                                             ;
     void                     initializePWMRegister(                      )                                                             ;
@@ -0,0 +1,285 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_TaskScheduler.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR cooperative (i.e. non-preemptive)
+    task scheduler.
+
+    This class should be instantiated as a singleton.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First release
+*/
+/**************************************************************************/
+
+#include <string.h>
+#include "ALTAIR_TaskScheduler.h"
+
+/**************************************************************************/
+/*!
+ @brief  Constructor.  (The clock source defaults to the HAL's clock.)
+*/
+/**************************************************************************/
+ALTAIR_TaskScheduler::ALTAIR_TaskScheduler( ALTAIR_ClockSource clock ) :
+    _clock(                                                    clock ) ,
+    _numTasks(                                                     0 ) ,
+    _runQueueLength(                                               0 ) ,
+    _currentTask(                                            NO_TASK )
+{
+}
+
+/**************************************************************************/
+/*!
+ @brief  Register a task that is to be run every period milliseconds,
+         starting firstDelay milliseconds from now.  A period of 0 makes
+         a one-shot task, which runs once and is then disabled until it
+         is rescheduled via runOnceAfter().  Returns the task ID (to be
+         used with the other member functions), or NO_TASK if the task
+         table is already full.
+*/
+/**************************************************************************/
+int8_t ALTAIR_TaskScheduler::addTask( const char*          name       ,
+                                      ALTAIR_TaskCallback  callback   ,
+                                      unsigned long        period     ,
+                                      unsigned long        firstDelay  )
+{
+    if (_numTasks >= MAX_SCHEDULED_TASKS) {
+#ifdef    ARDUINO
+        Serial.print(F("Task scheduler is full, could not add task: ")); Serial.println(name);
+#endif
+        return NO_TASK;
+    }
+    int8_t       taskID   = _numTasks++;
+    ALTAIR_Task& task     = _tasks[taskID];
+    task.name             = name;
+    task.callback         = callback;
+    task.deadline         = now() + firstDelay;
+    task.enabled          = true;
+    task.deferred         = false;
+    task.queued           = false;
+    memset(&task.stats, 0, sizeof(task.stats));
+    task.stats.period     = period;
+
+    insertInRunQueue(taskID);
+    return taskID;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Schedule a task to run once, delayMillis from now.  (For a
+         periodic task, its regular period then resumes from that run.)
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::runOnceAfter( int8_t taskID, unsigned long delayMillis )
+{
+    if (taskID < 0 || taskID >= _numTasks) return;
+    removeFromRunQueue(taskID);
+    _tasks[taskID].deadline = now() + delayMillis;
+    _tasks[taskID].enabled  = true;
+    insertInRunQueue(taskID);
+}
+
+/**************************************************************************/
+/*!
+ @brief  May only be called from within a running task: the task will be
+         retried delayMillis from now, instead of after its full period
+         (e.g. because the radio it wanted to use was busy).  The run
+         is not counted in the task statistics.
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::deferCurrentTask( unsigned long delayMillis )
+{
+    if (_currentTask == NO_TASK) return;
+    _tasks[_currentTask].deadline = now() + delayMillis;
+    _tasks[_currentTask].deferred = true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Enable (or disable) a task.  A re-enabled task is due at once.
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::enableTask( int8_t taskID, bool enable )
+{
+    if (taskID < 0 || taskID >= _numTasks) return;
+    if (_tasks[taskID].enabled == enable)  return;
+    _tasks[taskID].enabled = enable;
+    if (enable) {
+        _tasks[taskID].deadline = now();
+        insertInRunQueue(taskID);
+    } else {
+        removeFromRunQueue(taskID);
+    }
+}
+
+/**************************************************************************/
+/*!
+ @brief  Is the given task due to run?  (The subtraction keeps this
+         correct when millis() turns over, after about 50 days.)
+*/
+/**************************************************************************/
+bool ALTAIR_TaskScheduler::isDue( int8_t taskID, unsigned long currentMillis )
+{
+    return ((long) (currentMillis - _tasks[taskID].deadline) >= 0);
+}
+
+/**************************************************************************/
+/*!
+ @brief  Run the task at the head of the run queue (i.e. with the
+         earliest deadline), if it is due, and then reschedule it.
+*/
+/**************************************************************************/
+bool ALTAIR_TaskScheduler::runNext(                                 )
+{
+    while (_runQueueLength > 0 && !_tasks[_runQueue[0]].enabled) removeFromRunQueue(_runQueue[0]);   // (a disabled task is never left queued; but never run one)
+    if (_runQueueLength == 0) return false;
+
+    unsigned long currentMillis = now();
+    int8_t        taskID        = _runQueue[0];
+    if (!isDue(taskID, currentMillis)) return false;
+
+    ALTAIR_Task&  task          = _tasks[taskID];
+    removeFromRunQueue(taskID);
+
+    unsigned long jitter        = currentMillis - task.deadline;
+    task.deferred               = false;
+    _currentTask                = taskID;
+    task.callback();
+    _currentTask                = NO_TASK;
+    unsigned long finishMillis  = now();
+
+// If the task rescheduled (runOnceAfter, enableTask) or disabled itself, that stands.
+    bool          rescheduled   = task.queued || !task.enabled;
+
+    if (task.deferred) {                                // the task asked to be retried soon; it has not really run
+        if (!rescheduled) insertInRunQueue(taskID);
+        return true;
+    }
+
+    ALTAIR_TaskStats& stats     = task.stats;
+    ++stats.runCount;
+    stats.lastJitter            = jitter;
+    stats.totalJitter          += jitter;
+    if (jitter > stats.maxJitter)                stats.maxJitter  = jitter;
+    stats.lastRunTime           = finishMillis - currentMillis;
+    if (stats.lastRunTime > stats.maxRunTime)    stats.maxRunTime = stats.lastRunTime;
+    bool          overran       = (stats.period != 0 && stats.lastRunTime > stats.period);
+
+    if (rescheduled || stats.period == 0) {
+        if (overran) ++stats.overrunCount;
+        if (!rescheduled) task.enabled = false;        // one-shot task: disable it until it is rescheduled
+        return true;
+    }
+
+// Keep the cadence fixed to the original deadlines (so that no drift accumulates), but
+// skip over (and count as an overrun) any whole periods that have already been missed.
+    task.deadline              += stats.period;
+    if (isDue(taskID, finishMillis)) {
+        overran                 = true;
+        task.deadline           = finishMillis + stats.period - ((finishMillis - task.deadline) % stats.period);
+    }
+    if (overran) ++stats.overrunCount;
+    insertInRunQueue(taskID);
+    return true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Run each task that is presently due, in deadline order.  Each
+         task runs at most once per call, so that one task that is behind
+         cannot monopolize a pass through loop().
+*/
+/**************************************************************************/
+uint8_t ALTAIR_TaskScheduler::runPending(                           )
+{
+    uint8_t       nRun          = 0;
+    uint8_t       nDue          = 0;
+    unsigned long currentMillis = now();
+    for (uint8_t i = 0; i < _runQueueLength; ++i) {
+        if (!isDue(_runQueue[i], currentMillis)) break;
+        ++nDue;
+    }
+    while (nRun < nDue && runNext()) ++nRun;
+    return nRun;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Reset the statistics of all tasks.
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::resetStats(                              )
+{
+    for (uint8_t i = 0; i < _numTasks; ++i) {
+        unsigned long period = _tasks[i].stats.period;
+        memset(&_tasks[i].stats, 0, sizeof(_tasks[i].stats));
+        _tasks[i].stats.period = period;
+    }
+}
+
+#ifdef    ARDUINO
+/**************************************************************************/
+/*!
+ @brief  Print out (to USB Serial) the statistics of all tasks.
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::printStats(                              )
+{
+    Serial.println(F("Task scheduler statistics (period, runs, overruns, mean/max jitter, last/max run time; all in ms):"));
+    for (uint8_t i = 0; i < _numTasks; ++i) {
+        const ALTAIR_TaskStats& stats = _tasks[i].stats;
+        Serial.print(F("   "));  Serial.print(_tasks[i].name);
+        Serial.print(F(": "));   Serial.print(stats.period);
+        Serial.print(F("  "));   Serial.print(stats.runCount);
+        Serial.print(F("  "));   Serial.print(stats.overrunCount);
+        Serial.print(F("  "));   Serial.print(stats.runCount ? stats.totalJitter / stats.runCount : 0);
+        Serial.print(F("/"));    Serial.print(stats.maxJitter);
+        Serial.print(F("  "));   Serial.print(stats.lastRunTime);
+        Serial.print(F("/"));    Serial.println(stats.maxRunTime);
+    }
+}
+#endif
+
+/**************************************************************************/
+/*!
+ @brief  Insert a task into the run queue, keeping the queue sorted by
+         deadline.  (The queue is short, so an insertion sort is fine.)  A
+         task that is already in it is moved to its new deadline.
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::insertInRunQueue( int8_t taskID )
+{
+    if (!_tasks[taskID].enabled) return;
+    if (_tasks[taskID].queued) removeFromRunQueue(taskID);
+    uint8_t position = _runQueueLength;
+    while (position > 0 &&
+           (long) (_tasks[taskID].deadline - _tasks[_runQueue[position-1]].deadline) < 0) {
+        _runQueue[position] = _runQueue[position-1];
+        --position;
+    }
+    _runQueue[position] = taskID;
+    ++_runQueueLength;
+    _tasks[taskID].queued = true;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Remove a task from the run queue (if it is there).
+*/
+/**************************************************************************/
+void ALTAIR_TaskScheduler::removeFromRunQueue( int8_t taskID )
+{
+    for (uint8_t i = 0; i < _runQueueLength; ++i) {
+        if (_runQueue[i] == taskID) {
+            for (uint8_t j = i; j + 1 < _runQueueLength; ++j) _runQueue[j] = _runQueue[j+1];
+            --_runQueueLength;
+            _tasks[taskID].queued = false;
+            return;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIR_TaskScheduler.h
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is the class for the ALTAIR cooperative (i.e. non-preemptive)
+    task scheduler.  Each periodic job of the main loop (GPS polling,
+    reading the Arduino Micro, sending telemetry, SD card logging, reading
+    uplinked commands, etc) registers itself here with a period, and the
+    scheduler runs whichever registered tasks have come due, in order of
+    their deadlines, every time runPending() is called from loop().  The
+    scheduler keeps per-task period, jitter (i.e. lateness) and overrun
+    statistics, so that a slow task that starves the others is visible.
+
+    Time is read through a clock source function pointer, which defaults
+    to the HAL's clock (see ALTAIR_HAL.h: millis() on the Mega, and the
+    simulated clock of the Linux backend), so that another simulated
+    clock can also be substituted when this class is built for (and
+    tested on) a host computer.  Other than printStats(), this file does
+    not depend upon the Arduino libraries (see
+    tools/ALTAIRSchedulerTest.cpp).
+
+    This class should be instantiated as a singleton.
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#ifndef   ALTAIR_TaskScheduler_h
+#define   ALTAIR_TaskScheduler_h
+
+#ifdef    ARDUINO
+#include  "Arduino.h"
+#else
+#include  <stdint.h>
+#endif
+#include  <ALTAIR_HAL.h>
+
+// Each task costs 44 bytes of RAM on the Mega (a 43-byte table entry, plus its run queue entry), so the
+// table is only as big as ALTAIROperation needs: raise this when it registers another task.
+#define   MAX_SCHEDULED_TASKS         19
+#define   NO_TASK                     -1
+
+typedef   void            (*ALTAIR_TaskCallback)(                      )  ;
+typedef   unsigned long   (*ALTAIR_ClockSource)(                       )  ;
+
+struct ALTAIR_TaskStats {
+    unsigned long  period                                                 ;  // in milliseconds (0 => a one-shot task)
+    unsigned long  runCount                                               ;
+    unsigned long  overrunCount                                           ;  // # of runs that took longer than the period, or that missed a whole period
+    unsigned long  lastJitter                                             ;  // in milliseconds late, relative to the deadline
+    unsigned long  maxJitter                                              ;
+    unsigned long  totalJitter                                            ;  // divide by runCount to get the mean
+    unsigned long  lastRunTime                                            ;  // in milliseconds spent inside the task
+    unsigned long  maxRunTime                                             ;
+};
+
+class ALTAIR_TaskScheduler {
+  public:
+
+    ALTAIR_TaskScheduler(               ALTAIR_ClockSource   clock       = ALTAIR_HAL::clockMillis ) ;
+
+    int8_t                  addTask(    const char*          name                 ,
+                                        ALTAIR_TaskCallback  callback             ,
+                                        unsigned long        period               ,
+                                        unsigned long        firstDelay  = 0       ) ;   // Returns the task ID, or NO_TASK if the table is full.
+    void                    runOnceAfter(     int8_t         taskID               ,
+                                        unsigned long        delayMillis           ) ;   // (Re)schedule a task a single time, delayMillis from now.
+    void                    deferCurrentTask( unsigned long  delayMillis           ) ;   // Called from within a task: retry it after delayMillis, without counting this as a run.
+    void                    enableTask(       int8_t         taskID               ,
+                                              bool           enable      = true    ) ;
+
+    bool                    runNext(                                               ) ;   // Run the single earliest-deadline task that is due.  Returns true if one ran.
+    uint8_t                 runPending(                                            ) ;   // Run every task that is due now, in deadline order.  Returns the # that ran.
+
+    unsigned long           now(                                                   ) { return _clock()                       ; }
+    uint8_t                 numTasks(                                              ) { return _numTasks                      ; }
+    int8_t                  currentTask(                                           ) { return _currentTask                   ; }
+    const char*             taskName(         int8_t         taskID                ) { return _tasks[taskID].name            ; }
+    const ALTAIR_TaskStats* taskStats(        int8_t         taskID                ) { return &_tasks[taskID].stats          ; }
+    void                    resetStats(                                            ) ;
+#ifdef    ARDUINO
+    void                    printStats(                                            ) ;
+#endif
+
+  private:
+
+    struct ALTAIR_Task {
+        const char*          name                                                 ;
+        ALTAIR_TaskCallback  callback                                             ;
+        unsigned long        deadline                                             ;
+        bool                 enabled                                              ;
+        bool                 deferred                                             ;
+        bool                 queued                                               ;  // (it is in _runQueue)
+        ALTAIR_TaskStats     stats                                                ;
+    };
+
+    void                    insertInRunQueue( int8_t         taskID                ) ;
+    void                    removeFromRunQueue( int8_t       taskID                ) ;
+    bool                    isDue(            int8_t         taskID               ,
+                                              unsigned long  currentMillis         ) ;
+
+    ALTAIR_ClockSource     _clock                                                 ;
+    ALTAIR_Task            _tasks[MAX_SCHEDULED_TASKS]                            ;
+    int8_t                 _runQueue[MAX_SCHEDULED_TASKS]                         ;  // enabled task IDs, sorted by deadline (earliest first)
+    uint8_t                _numTasks                                              ;
+    uint8_t                _runQueueLength                                        ;
+    int8_t                 _currentTask                                           ;
+};
+#endif    //   ifndef ALTAIR_TaskScheduler_h
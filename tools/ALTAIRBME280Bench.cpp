@@ -0,0 +1,302 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRBME280Bench.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) benchmark of the
+    sampling of the three BME280 pressure/temp/humidity sensors, with the
+    very same ALTAIR_BME280 as in the flight code, reading simulated
+    BME280s (models of their registers) on the HAL's simulated I2C bus,
+    which counts each transaction and byte, and the time that they take.
+
+    It compares, per telemetry cycle (i.e. per frame 1 built) and per
+    second of flight:
+
+      - the previous way: each frame read the temperature, pressure, and
+        humidity of each sensor separately, via the Adafruit library (whose
+        bus traffic is mirrored here: the pressure and humidity each read
+        the temperature again first), as did each flight record, and each
+        printout of the nav mast sensor;
+      - the sampling service: one burst read of each sensor's 8 data
+        registers per cycle (plus selecting the gondola sensor's I2C
+        multiplexer channel, and then deselecting it), after which every
+        reading comes from the kept results.
+
+    It checks that the integer compensation (with the calibration data
+    read from the sensor by begin()) agrees with the datasheet's
+    floating-point formulas, and that a sample that finds no measurement
+    keeps the previous readings, while one that is not acknowledged sets
+    them to zero.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_Devices -o ALTAIRBME280Bench ALTAIRBME280Bench.cpp ../libraries/ALTAIR_Devices/ALTAIR_BME280.cpp ../libraries/ALTAIR_HAL/ALTAIR_HAL_Linux.cpp
+
+    To use:
+
+      ALTAIRBME280Bench [# of random measurements to check]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+
+#include "ALTAIR_HALSim.h"
+#include "ALTAIR_BME280.h"
+
+// As in ALTAIROperation.ino, and ALTAIR_TCA9548A.h.
+#define  TELEMETRY_CYCLES_PER_SECOND    4           // (radioPollInterval = 250 ms)
+#define  FLIGHT_RECORDS_PER_SECOND      1
+#define  PRINTOUTS_PER_SECOND         0.5
+#define  TCA9548A_I2CADDRESS         0x70
+#define  NUM_BME280S                    3
+
+// A typical sensor's calibration data (as the datasheet's example).
+static const uint16_t T1 = 27504;  static const int16_t T2 = 26435, T3 = -1000;
+static const uint16_t P1 = 36477;  static const int16_t P2 = -10685, P3 = 3024, P4 = 2855, P5 = 140, P6 = -7, P7 = 15500, P8 = -14600, P9 = 6000;
+static const uint8_t  H1 = 75,     H3 = 0;
+static const int16_t  H2 = 362,    H4 = 313, H5 = 50;
+static const int8_t   H6 = 30;
+
+/**************************************************************************/
+/*!
+    A simulated BME280: its registers, with an auto-incrementing register
+    pointer, as on the real thing.
+*/
+/**************************************************************************/
+class SimBME280 : public ALTAIR_HALSimI2CDevice {
+  public:
+    SimBME280() : _pointer(0) {
+        memset(_registers, 0, sizeof(_registers));
+        _registers[BME280_REG_CHIP_ID] = BME280_CHIP_ID;
+        uint8_t* tp = _registers + BME280_REG_CALIB_TP;
+        const uint16_t words[12] = { T1, (uint16_t) T2, (uint16_t) T3, P1, (uint16_t) P2, (uint16_t) P3, (uint16_t) P4,
+                                     (uint16_t) P5, (uint16_t) P6, (uint16_t) P7, (uint16_t) P8, (uint16_t) P9 };
+        for (int i = 0; i < 12; ++i) { tp[2*i] = words[i] & 0xFF; tp[2*i + 1] = words[i] >> 8; }
+        tp[25] = H1;
+        uint8_t* h = _registers + BME280_REG_CALIB_H;
+        h[0] = H2 & 0xFF;  h[1] = (uint16_t) H2 >> 8;  h[2] = H3;
+        h[3] = (uint8_t) (H4 >> 4);  h[4] = (uint8_t) ((H4 & 0x0F) | ((H5 & 0x0F) << 4));  h[5] = (uint8_t) (H5 >> 4);  h[6] = (uint8_t) H6;
+        setMeasurement(BME280_SKIPPED_TP, BME280_SKIPPED_TP, BME280_SKIPPED_H);
+    }
+    void setMeasurement( int32_t adcT , int32_t adcP , int32_t adcH ) {
+        uint8_t* d = _registers + BME280_REG_DATA;
+        d[0] = adcP >> 12;  d[1] = adcP >> 4;  d[2] = (adcP & 0x0F) << 4;
+        d[3] = adcT >> 12;  d[4] = adcT >> 4;  d[5] = (adcT & 0x0F) << 4;
+        d[6] = adcH >> 8;   d[7] = adcH;
+    }
+    uint8_t ctrlMeas() { return _registers[BME280_REG_CTRL_MEAS]; }
+    uint8_t ctrlHum()  { return _registers[BME280_REG_CTRL_HUM];  }
+
+    virtual bool i2cWrite( const uint8_t* bytes , uint8_t numBytes ) {
+        if (numBytes == 0) return true;
+        _pointer = bytes[0];
+        for (uint8_t i = 1; i < numBytes; ++i) {
+            if (_pointer != BME280_REG_RESET) _registers[_pointer] = bytes[i];
+            ++_pointer;
+        }
+        return true;
+    }
+    virtual uint8_t i2cRead( uint8_t* bytes , uint8_t numBytes ) {
+        for (uint8_t i = 0; i < numBytes; ++i) bytes[i] = _registers[_pointer++];
+        return numBytes;
+    }
+
+  private:
+    uint8_t _registers[256];
+    uint8_t _pointer;
+};
+
+/**************************************************************************/
+/*!
+    The TCA9548A multiplexer (just acknowledging the channel selections).
+*/
+/**************************************************************************/
+class SimMux : public ALTAIR_HALSimI2CDevice {
+  public:
+    virtual bool    i2cWrite( const uint8_t* , uint8_t ) { return true; }
+    virtual uint8_t i2cRead(  uint8_t* , uint8_t )       { return 0;    }
+};
+
+/**************************************************************************/
+/*!
+    The datasheet's floating-point compensation (section 8.1).
+*/
+/**************************************************************************/
+static void referenceCompensation( int32_t adcT , int32_t adcP , int32_t adcH , double& t , double& p , double& h ) {
+    double var1  = (adcT / 16384.0 - T1 / 1024.0) * T2;
+    double var2  = (adcT / 131072.0 - T1 / 8192.0) * (adcT / 131072.0 - T1 / 8192.0) * T3;
+    double tFine = var1 + var2;
+    t            = tFine / 5120.0;
+
+    var1 = tFine / 2.0 - 64000.0;
+    var2 = var1 * var1 * P6 / 32768.0;
+    var2 = var2 + var1 * P5 * 2.0;
+    var2 = var2 / 4.0 + P4 * 65536.0;
+    var1 = (P3 * var1 * var1 / 524288.0 + P2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * P1;
+    p    = 1048576.0 - adcP;
+    p    = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = P9 * p * p / 2147483648.0;
+    var2 = p * P8 / 32768.0;
+    p    = p + (var1 + var2 + P7) / 16.0;
+
+    h = tFine - 76800.0;
+    h = (adcH - (H4 * 64.0 + H5 / 16384.0 * h)) * (H2 / 65536.0 * (1.0 + H6 / 67108864.0 * h * (1.0 + H3 / 67108864.0 * h)));
+    h = h * (1.0 - H1 * h / 524288.0);
+    h = (h > 100.0) ? 100.0 : (h < 0.0) ? 0.0 : h;
+}
+
+/**************************************************************************/
+/*!
+    The previous way's bus traffic: the Adafruit library's register reads
+    (each a write of the register address, and then a read).
+*/
+/**************************************************************************/
+static void adafruitRead( uint8_t address , uint8_t reg , uint8_t numBytes ) {
+    uint8_t bytes[3];
+    ALTAIR_HAL::i2cWrite(address, &reg, 1);
+    ALTAIR_HAL::i2cRead( address, bytes, numBytes);
+}
+static void adafruitReadTemperature( uint8_t address ) { adafruitRead(address, 0xFA, 3); }
+static void adafruitReadPressure(    uint8_t address ) { adafruitReadTemperature(address); adafruitRead(address, 0xF7, 3); }
+static void adafruitReadHumidity(    uint8_t address ) { adafruitReadTemperature(address); adafruitRead(address, 0xFD, 2); }
+
+struct Cost { double transactions, bytes, micros; };
+
+static Cost measure( void (*what)( ALTAIR_BME280* sensors ) , ALTAIR_BME280* sensors ) {
+    const ALTAIR_HALSimStats* stats  = ALTAIR_HALSim::stats();
+    unsigned long             before = stats->i2cTransactions, bytesBefore = stats->i2cBytes;
+    unsigned long long        start  = ALTAIR_HALSim::micros();
+    what(sensors);
+    Cost cost = { (double) (stats->i2cTransactions - before), (double) (stats->i2cBytes - bytesBefore), (double) (ALTAIR_HALSim::micros() - start) };
+    return cost;
+}
+
+static const uint8_t addresses[NUM_BME280S] = { BME280_I2CADDRESS, BME280_I2CADDRESS_ALT, BME280_I2CADDRESS };   // mast, balloon, gondola
+
+// The previous way: a frame 1 (or flight record) read each value of each sensor separately, and so did the nav mast printout.
+static void previousFrame( ALTAIR_BME280* ) {
+    for (int s = 0; s < NUM_BME280S; ++s) {
+        adafruitReadPressure(addresses[s]);
+        adafruitReadTemperature(addresses[s]);
+        adafruitReadHumidity(addresses[s]);
+    }
+}
+static void previousPrintout( ALTAIR_BME280* ) {
+    adafruitReadTemperature(addresses[0]);
+    adafruitReadPressure(addresses[0]);
+    adafruitReadPressure(addresses[0]);                                             // (readAltitude)
+    adafruitReadHumidity(addresses[0]);
+}
+
+// The sampling service (as ALTAIR_SituatAwarenessSystem::sampleBME280s), and then reading the kept results.
+static void sampleAll( ALTAIR_BME280* sensors ) {
+    uint8_t select = 1, deselect = 0;
+    sensors[0].sample();
+    sensors[1].sample();
+    ALTAIR_HAL::i2cWrite(TCA9548A_I2CADDRESS, &select,   1);
+    sensors[2].sample();
+    ALTAIR_HAL::i2cWrite(TCA9548A_I2CADDRESS, &deselect, 1);
+}
+static volatile float sink;
+static void cachedFrame( ALTAIR_BME280* sensors ) {
+    for (int s = 0; s < NUM_BME280S; ++s) sink = sensors[s].pressure() + sensors[s].temperature() + sensors[s].humidity();
+}
+
+int main( int argc , char** argv )
+{
+    long         numChecks = (argc > 1) ? atol(argv[1]) : 100000;
+    std::mt19937 random(17102026);
+    bool         ok = true;
+
+    ALTAIR_HALSim::reset();
+    SimBME280     mast, balloon;
+    SimMux        mux;
+    ALTAIR_HALSim::attachI2C(BME280_I2CADDRESS,     &mast);                        // (the gondola's sensor, behind the multiplexer,
+    ALTAIR_HALSim::attachI2C(BME280_I2CADDRESS_ALT, &balloon);                     //    answers at the same address here)
+    ALTAIR_HALSim::attachI2C(TCA9548A_I2CADDRESS,   &mux);
+    ALTAIR_BME280 sensors[NUM_BME280S];
+    for (int s = 0; s < NUM_BME280S; ++s) {
+        if (!sensors[s].begin(addresses[s])) { printf("begin() failed\n"); ok = false; }
+    }
+    bool configured = (mast.ctrlMeas() == BME280_CTRL_MEAS_X16_NORMAL && mast.ctrlHum() == BME280_CTRL_HUM_X16);
+    printf("begin(): %s\n", configured ? "configured for x16 oversampling, in normal mode" : "NOT configured");
+    ok &= configured;
+
+// No measurement yet: nothing is kept.
+    bool notReady = !sensors[0].sample() && !sensors[0].valid() && sensors[0].stats()->notReady == 1;
+
+// The compensation, against the datasheet's floating-point formulas.
+    std::uniform_int_distribution<int32_t> rawT(380000, 600000), rawP(200000, 500000), rawH(15000, 45000);
+    double maxT = 0., maxP = 0., maxH = 0.;
+    for (long i = 0; i < numChecks; ++i) {
+        int32_t adcT = rawT(random), adcP = rawP(random), adcH = rawH(random);
+        if (adcT == BME280_SKIPPED_TP || adcH == BME280_SKIPPED_H) continue;        // (those mean a measurement skipped)
+        mast.setMeasurement(adcT, adcP, adcH);
+        if (!sensors[0].sample()) { ok = false; break; }
+        double t, p, h;
+        referenceCompensation(adcT, adcP, adcH, t, p, h);
+        maxT = fmax(maxT, fabs(sensors[0].temperature() - t));
+        maxP = fmax(maxP, fabs(sensors[0].pressure()    - p));
+        maxH = fmax(maxH, fabs(sensors[0].humidity()    - h));
+    }
+    bool accurate = (maxT <= 0.01 && maxP <= 1.0 && maxH <= 0.05);
+    printf("compensation vs the datasheet's floating point, over %ld random measurements:\n", numChecks);
+    printf("  max difference: %.4f C, %.3f Pa, %.4f %%  %s\n", maxT, maxP, maxH, accurate ? "ok" : "FAILED");
+    ok &= accurate;
+
+// A measurement that was not ready keeps the previous readings; one not acknowledged zeroes them.
+    mast.setMeasurement(519888, 415148, 30000);
+    sensors[0].sample();
+    float kept = sensors[0].pressure();
+    mast.setMeasurement(BME280_SKIPPED_TP, BME280_SKIPPED_TP, BME280_SKIPPED_H);
+    bool keeps = notReady && !sensors[0].sample() && sensors[0].valid() && sensors[0].pressure() == kept;
+    ALTAIR_HALSim::attachI2C(BME280_I2CADDRESS_ALT, NULL);                          // (the balloon valve's connector pulled out)
+    bool zeroes = !sensors[1].sample() && !sensors[1].valid() && sensors[1].pressure() == 0.f && sensors[1].temperature() == 0.f;
+    ALTAIR_HALSim::attachI2C(BME280_I2CADDRESS_ALT, &balloon);
+    printf("a sample with no measurement keeps the readings: %s;  one not acknowledged zeroes them: %s\n\n", keeps ? "ok" : "FAILED", zeroes ? "ok" : "FAILED");
+    ok &= keeps && zeroes;
+
+// The bus traffic.
+    mast.setMeasurement(519888, 415148, 30000);
+    balloon.setMeasurement(519888, 415148, 30000);
+    Cost previous = measure(previousFrame,    sensors);
+    Cost printout = measure(previousPrintout, sensors);
+    Cost sampled  = measure(sampleAll,        sensors);
+    Cost cached   = measure(cachedFrame,      sensors);
+    double perSecondPrevious = previous.bytes * (TELEMETRY_CYCLES_PER_SECOND + FLIGHT_RECORDS_PER_SECOND) + printout.bytes * PRINTOUTS_PER_SECOND;
+    double perSecondSampled  = sampled.bytes  *  TELEMETRY_CYCLES_PER_SECOND;
+    double microsPrevious    = previous.micros * (TELEMETRY_CYCLES_PER_SECOND + FLIGHT_RECORDS_PER_SECOND) + printout.micros * PRINTOUTS_PER_SECOND;
+    double microsSampled     = sampled.micros  *  TELEMETRY_CYCLES_PER_SECOND;
+
+    printf("per telemetry cycle (frame 1, all three sensors):    transactions    bytes    bus time (us)\n");
+    printf("  previous (separate reads, via the Adafruit library)  %8.0f  %9.0f  %12.0f\n", previous.transactions, previous.bytes, previous.micros);
+    printf("  sampling service (3 burst reads, and the mux)        %8.0f  %9.0f  %12.0f\n", sampled.transactions,  sampled.bytes,  sampled.micros);
+    printf("  reading the kept results                             %8.0f  %9.0f  %12.0f\n", cached.transactions,   cached.bytes,   cached.micros);
+    printf("  saved                                                %8.0f  %9.0f  %12.0f  (%.0f%% of the bytes)\n",
+           previous.transactions - sampled.transactions, previous.bytes - sampled.bytes, previous.micros - sampled.micros,
+           100. * (previous.bytes - sampled.bytes) / previous.bytes);
+    printf("  (the nav mast printout previously added %.0f transactions, %.0f bytes, %.0f us, every 2 s; now none)\n\n",
+           printout.transactions, printout.bytes, printout.micros);
+    printf("per second (%d telemetry cycles, %d flight record, and the printout every 2 s, against %d samples):\n",
+           TELEMETRY_CYCLES_PER_SECOND, FLIGHT_RECORDS_PER_SECOND, TELEMETRY_CYCLES_PER_SECOND);
+    printf("  previous: %.0f bytes, %.1f ms of bus time;  sampling service: %.0f bytes, %.1f ms\n",
+           perSecondPrevious, microsPrevious / 1000., perSecondSampled, microsSampled / 1000.);
+    printf("  temperature compensations per sensor per cycle: previously 5 (3 of them for the pressure and humidity), now 1\n");
+    bool saves = (sampled.bytes < previous.bytes / 2 && cached.transactions == 0);
+    ok &= saves;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRCommandARQSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the reliable delivery of the commands sent up to ALTAIR (see
+    ALTAIR_CommandARQ.h), with the very same ALTAIR_CommandSender as the
+    ground station, and the very same ALTAIR_CommandReceiver as the
+    command router on ALTAIR.
+
+    The operator types commands at random (a Poisson process), which are
+    queued, and sent, by the ground station, as in
+    CapellaGroundStationOperation.ino (with a heartbeat whenever nothing
+    else has been sent for a couple of seconds).  The uplink loses each
+    packet with the scenario's probability, delays the rest by a random
+    time, and now and then delivers a second copy of one, later on (as
+    when it also arrives via another radio).  ALTAIR reads one command
+    every READ_COMMANDS_INTERVAL, and then executes it, and sends its
+    acknowledgements, as ALTAIR_CommandRouter::gather, dispatchAll, and
+    sendAcks do (mirrored here, as the router itself needs the radios).
+    The downlink loses, and delays, the acknowledgements in the same way
+    (they also wait behind the telemetry frames).
+
+    For each loss rate, it reports:
+
+      - the fraction of the commands executed on ALTAIR, against the
+        fraction that would get through if each were sent just once;
+      - the percentiles of the delivery latency (from when the operator
+        typed a command, to when ALTAIR executed it), and of the
+        acknowledgement latency (from when it was queued, to when the
+        ground station had its acknowledgement);
+      - the retransmissions, and the commands given up on.
+
+    It checks that no command is ever executed twice, that every command
+    acknowledged was executed, and that every command gets through (with
+    nothing given up on) at modest loss rates.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRCommandARQSim ALTAIRCommandARQSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandARQ.cpp
+
+    To use:
+
+      ALTAIRCommandARQSim [# of hours per loss rate]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_CommandARQ.h"
+
+// As in ALTAIROperation.ino, CapellaGroundStationOperation.ino, and ALTAIR_GenTelInt.h.
+#define  STEP_MILLIS                10
+#define  READ_COMMANDS_INTERVAL     50
+#define  HEARTBEAT_INTERVAL       2000
+#define  HEARTBEAT_COMMAND         'h'
+#define  NO_COMMAND_SEQUENCE         0
+#define  OPERATOR_MEAN_INTERVAL   2000            // in milliseconds, between the commands typed
+#define  UPLINK_MIN_DELAY           40            // in milliseconds
+#define  UPLINK_MAX_DELAY          160
+#define  DOWNLINK_MIN_DELAY         40
+#define  DOWNLINK_MAX_DELAY        400            // (behind the telemetry frames)
+#define  SECOND_COPY_PROBABILITY  0.05
+#define  SECOND_COPY_MAX_DELAY    3000
+
+/**************************************************************************/
+/*!
+    A packet in flight, on either link.
+*/
+/**************************************************************************/
+struct Packet {
+    unsigned long arrivalMillis;
+    byte          data[2 + COMMAND_ACK_COUNT];     // a command (type, argument, sequence #), or an acknowledgement frame
+    uint8_t       length;
+    bool operator<( const Packet& other ) const { return arrivalMillis > other.arrivalMillis; }   // (the earliest first, in a priority queue)
+};
+
+struct Command {
+    byte          type;
+    byte          argument;
+    uint8_t       sequence;
+    unsigned long typedMillis;
+    unsigned long queuedMillis;
+    unsigned long firstSentMillis;
+    bool          sent;
+    int           executions;
+    unsigned long executedMillis;
+    bool          acked;
+    unsigned long ackedMillis;
+    bool          givenUp;
+};
+
+struct Result {
+    long                commands, executed, acked, givenUp, doublyExecuted, ackedNotExecuted, unaccounted;
+    long                sent, retransmissions, duplicatesSeen, staleAcks;
+    std::vector<double> delivery, ack;
+    unsigned long       finalRto, finalSrtt;
+};
+
+static double percentile( std::vector<double>& values , double p ) {
+    if (values.empty()) return 0.;
+    size_t i = (size_t) (p * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + i, values.end());
+    return values[i];
+}
+
+/**************************************************************************/
+/*!
+    One run, at one loss rate (on each link).
+*/
+/**************************************************************************/
+static Result simulate( double loss , unsigned long seconds , unsigned seed ) {
+    std::mt19937                           random(seed);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::exponential_distribution<double>  typing(1. / OPERATOR_MEAN_INTERVAL);
+    std::uniform_int_distribution<int>     upDelay(UPLINK_MIN_DELAY, UPLINK_MAX_DELAY), downDelay(DOWNLINK_MIN_DELAY, DOWNLINK_MAX_DELAY);
+    std::uniform_int_distribution<int>     copyDelay(UPLINK_MAX_DELAY, SECOND_COPY_MAX_DELAY), anyByte(1, 255);
+
+    std::vector<Command>        commands;
+    std::deque<size_t>          typed;                                      // typed in, but not yet queued (the window was full)
+    std::map<uint8_t, size_t>   inFlight;                                   // by sequence #
+    std::vector<Packet>         uplink, downlink;                           // (heaps)
+    uint8_t                     commandSequence = 0;                        // as ALTAIR_GenTelInt::nextCommandSequence
+    unsigned long               nextTyped       = (unsigned long) typing(random);
+    unsigned long               lastSentMillis  = 0;
+    ALTAIR_CommandSender        sender;
+
+    std::deque<Packet>          rxBuffer;                                   // ALTAIR's radio's receive buffer
+    std::vector<Command*>       pending;                                    // the router's queue (all of equal priority here)
+    std::map<uint8_t, size_t>   bySequence;                                 // (to tell which command ALTAIR has executed)
+    bool                        ackPending      = false;
+    ALTAIR_CommandReceiver      receiver;
+    long                        duplicatesSeen  = 0;
+
+    auto transmit = [&]( std::vector<Packet>& link , const byte* data , uint8_t length , unsigned long arrival ) {
+        Packet packet;
+        packet.arrivalMillis = arrival;
+        packet.length        = length;
+        std::copy(data, data + length, packet.data);
+        link.push_back(packet);
+        std::push_heap(link.begin(), link.end());
+    };
+    auto sendUp = [&]( byte type , byte argument , uint8_t sequence , unsigned long now ) {
+        byte data[3] = { type, argument, sequence };
+        if (uniform(random) >= loss) transmit(uplink, data, 3, now + upDelay(random));
+        if (uniform(random) <  SECOND_COPY_PROBABILITY && uniform(random) >= loss) transmit(uplink, data, 3, now + copyDelay(random));
+        lastSentMillis = now;
+    };
+
+    for (unsigned long now = 0; now <= seconds * 1000UL; now += STEP_MILLIS) {
+
+// The uplink: into ALTAIR's receive buffer.
+        while (!uplink.empty() && uplink.front().arrivalMillis <= now) {
+            rxBuffer.push_back(uplink.front());
+            std::pop_heap(uplink.begin(), uplink.end());
+            uplink.pop_back();
+        }
+
+// ALTAIR: as the "read commands" task (gather, dispatchAll, and then sendAcks).
+        if (now % READ_COMMANDS_INTERVAL == 0) {
+            if (!rxBuffer.empty()) {
+                Packet packet = rxBuffer.front();
+                rxBuffer.pop_front();
+                byte type = packet.data[0], argument = packet.data[1];
+                uint8_t sequence = packet.data[2];
+                if (type != HEARTBEAT_COMMAND) {
+                    if (receiver.isDuplicate(type, argument, sequence, now)) {
+                        ++duplicatesSeen;
+                        bool queued = false;
+                        for (size_t i = 0; i < pending.size(); ++i) queued |= (pending[i]->sequence == sequence);
+                        if (!queued) { receiver.acknowledge(sequence); ackPending = true; }
+                    } else {
+                        Command& command = commands[bySequence[sequence]];
+                        if (command.type == type && command.argument == argument) pending.push_back(&command);
+                        receiver.remember(type, argument, sequence, now);
+                    }
+                }
+            }
+            for (size_t i = 0; i < pending.size(); ++i) {
+                if (pending[i]->executions++ == 0) pending[i]->executedMillis = now;
+                receiver.acknowledge(pending[i]->sequence);
+                ackPending = true;
+            }
+            pending.clear();
+            byte    frame[2 + COMMAND_ACK_COUNT];
+            uint8_t length = receiver.acks(frame);
+            if (ackPending && length > 0) {
+                if (uniform(random) >= loss) transmit(downlink, frame, length, now + downDelay(random));
+                ackPending = false;
+            }
+        }
+
+// The downlink: the acknowledgements, as the ground station's decoder hands them to the sender.
+        while (!downlink.empty() && downlink.front().arrivalMillis <= now) {
+            const Packet& packet = downlink.front();
+            for (uint8_t i = 0; i < packet.data[1]; ++i) {
+                uint8_t sequence = packet.data[2 + i];
+                if (!sender.acked(sequence, now)) continue;
+                Command& command = commands[inFlight[sequence]];
+                command.acked       = true;
+                command.ackedMillis = now;
+                inFlight.erase(sequence);
+            }
+            std::pop_heap(downlink.begin(), downlink.end());
+            downlink.pop_back();
+        }
+
+// The operator (who stops typing in time for the last commands to be done with).
+        while (nextTyped <= now && now + COMMAND_SEQUENCE_WINDOW < seconds * 1000UL) {
+            Command command = { (byte) anyByte(random), (byte) anyByte(random), NO_COMMAND_SEQUENCE, nextTyped, 0, 0, false, 0, 0, false, 0, false };
+            if (command.type == HEARTBEAT_COMMAND) command.type = 'x';
+            commands.push_back(command);
+            typed.push_back(commands.size() - 1);
+            nextTyped += (unsigned long) typing(random) + 1;
+        }
+
+// The ground station: as CapellaGroundStationOperation.ino (and ALTAIR_GenTelInt::serviceCommandsToALTAIR).
+        while (!typed.empty() && !sender.full()) {
+            Command& command = commands[typed.front()];
+            if (++commandSequence == NO_COMMAND_SEQUENCE) ++commandSequence;
+            command.sequence     = commandSequence;
+            command.queuedMillis = now;
+            sender.queue(command.type, command.argument, command.sequence, now);
+            inFlight[command.sequence]   = typed.front();
+            bySequence[command.sequence] = typed.front();
+            typed.pop_front();
+        }
+        uint8_t expired = sender.expire(now);
+        for (std::map<uint8_t, size_t>::iterator i = inFlight.begin(); i != inFlight.end(); ) {
+            Command& command = commands[i->second];
+            if (command.sent && now - command.firstSentMillis >= COMMAND_GIVE_UP_MILLIS) {
+                command.givenUp = true;
+                --expired;
+                inFlight.erase(i++);
+            } else {
+                ++i;
+            }
+        }
+        if (expired != 0) { fprintf(stderr, "the sender gave up on other commands than expected\n"); exit(2); }
+        byte    type, argument;
+        uint8_t sequence;
+        while (sender.nextToSend(now, type, argument, sequence)) {
+            Command& command = commands[inFlight[sequence]];
+            if (!command.sent) { command.sent = true; command.firstSentMillis = now; }
+            sendUp(type, argument, sequence, now);
+        }
+        if (now - lastSentMillis > HEARTBEAT_INTERVAL) sendUp(HEARTBEAT_COMMAND, 1, NO_COMMAND_SEQUENCE, now);
+    }
+
+    Result result = {};
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const Command& command = commands[i];
+        ++result.commands;
+        if (command.executions > 0) { ++result.executed; result.delivery.push_back(command.executedMillis - command.typedMillis); }
+        if (command.executions > 1)                      ++result.doublyExecuted;
+        if (command.acked) { ++result.acked; result.ack.push_back(command.ackedMillis - command.queuedMillis); }
+        if (command.acked && command.executions == 0)    ++result.ackedNotExecuted;
+        if (command.givenUp)                             ++result.givenUp;
+        if (!command.acked && !command.givenUp && inFlight.count(command.sequence) == 0) ++result.unaccounted;
+    }
+    const ALTAIR_CommandSenderStats* stats = sender.stats();
+    result.sent            = stats->sent;
+    result.retransmissions = stats->retransmissions;
+    result.staleAcks       = stats->staleAcks;
+    result.duplicatesSeen  = duplicatesSeen;
+    result.finalRto        = sender.rto();
+    result.finalSrtt       = sender.srtt();
+    if ((long) stats->acked != result.acked || (long) stats->givenUp != result.givenUp) {
+        fprintf(stderr, "the sender's statistics disagree with the simulation\n");
+        exit(2);
+    }
+    return result;
+}
+
+int main( int argc , char** argv )
+{
+    double        hours     = (argc > 1) ? atof(argv[1]) : 4.;
+    unsigned long seconds   = (unsigned long) (hours * 3600.);
+    const double  losses[4] = { 0., 0.10, 0.30, 0.50 };
+    bool          ok        = true;
+    printf("%.1f hours per loss rate; a command typed every %d ms on average; a window of %d commands; uplink delay %d-%d ms, downlink %d-%d ms\n\n",
+           hours, OPERATOR_MEAN_INTERVAL, COMMAND_WINDOW, UPLINK_MIN_DELAY, UPLINK_MAX_DELAY, DOWNLINK_MIN_DELAY, DOWNLINK_MAX_DELAY);
+
+    for (int l = 0; l < 4; ++l) {
+        Result r = simulate(losses[l], seconds, l + 1);
+        double delivered = (double) r.executed / r.commands;
+        printf("%.0f%% packet loss on each link:\n", 100. * losses[l]);
+        printf("  %ld commands: %ld executed on ALTAIR (%.3f%%, against %.1f%% if each were sent just once), %ld acknowledged, %ld given up on\n",
+               r.commands, r.executed, 100. * delivered, 100. * (1. - losses[l]), r.acked, r.givenUp);
+        printf("  delivery latency (ms):        p50 %6.0f  p90 %6.0f  p99 %6.0f  max %6.0f\n",
+               percentile(r.delivery, .50), percentile(r.delivery, .90), percentile(r.delivery, .99), percentile(r.delivery, 1.));
+        printf("  acknowledgement latency (ms): p50 %6.0f  p90 %6.0f  p99 %6.0f  max %6.0f\n",
+               percentile(r.ack, .50), percentile(r.ack, .90), percentile(r.ack, .99), percentile(r.ack, 1.));
+        printf("  sent %ld (%.2f per command), retransmissions %ld, copies seen (and discarded) on ALTAIR %ld, stale acknowledgements %ld\n",
+               r.sent, (double) r.sent / r.commands, r.retransmissions, r.duplicatesSeen, r.staleAcks);
+        printf("  final smoothed RTT %lu ms, retransmit timeout %lu ms\n", r.finalSrtt, r.finalRto);
+        bool good = (r.doublyExecuted == 0 && r.ackedNotExecuted == 0 && r.unaccounted == 0);
+        if (losses[l] <= 0.10) good &= (r.executed == r.commands && r.givenUp == 0);
+        else if (losses[l] <= 0.30) good &= (delivered >= 0.995);
+        if (losses[l] == 0.)   good &= (r.retransmissions == 0);
+        printf("  executed twice: %ld, acknowledged but never executed: %ld, unaccounted for: %ld\n  %s\n\n",
+               r.doublyExecuted, r.ackedNotExecuted, r.unaccounted, good ? "ok" : "FAILED");
+        ok &= good;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
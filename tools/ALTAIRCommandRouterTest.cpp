@@ -0,0 +1,177 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRCommandRouterTest.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) test of the
+    command router (ALTAIR_CommandRouter, the very same code that executes
+    every command sent up to ALTAIR), with commands handed to submit(), as
+    gather() does with those read from the radios.
+
+    It checks:
+
+      - the priority order: every pending shutdown ('x' or 'X') is
+        executed first, then every motor setting ('s'), and then
+        everything else, each in the order that it arrived, both for a
+        fixed batch and for random ones (against a stable sort by
+        priority), via dispatchAll() and via nextCommand();
+      - that a shutdown that arrives when the queue is full still gets
+        in (the newest of the lowest priority commands is dropped, and
+        counted, and accepted when it is sent again), while a command
+        that arrives when the queue is full of higher priority commands
+        is itself dropped;
+      - that a copy of a command (with the same sequence number) is
+        executed only once;
+      - the latency statistics.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRCommandRouterTest ALTAIRCommandRouterTest.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandRouter.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandARQ.cpp
+
+    To use:
+
+      ALTAIRCommandRouterTest
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "ALTAIR_CommandRouter.h"
+
+#define  RANDOM_BATCHES   20000
+#define  SOURCE               0          // (as if every command arrived on the first radio)
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+static std::string executed;                                     // the types of the commands executed, in order
+
+static void handler( byte type , byte ) { executed += (char) type; }
+
+static uint8_t       sequence = 0;
+static unsigned long now      = 0;
+
+static bool submit( ALTAIR_CommandRouter& router , char type , uint8_t seq = 0 ) {
+    if (seq == 0) {
+        if (++sequence == ARQ_NO_SEQUENCE) ++sequence;
+        seq = sequence;
+    }
+    return router.submit((byte) type, 1, seq, SOURCE, now);
+}
+
+// What the order should be: a stable sort by priority.
+static std::string byPriority( const std::string& arrived ) {
+    std::string expected = arrived;
+    std::stable_sort(expected.begin(), expected.end(),
+                     []( char a , char b ) { return ALTAIR_CommandRouter::priority(a) < ALTAIR_CommandRouter::priority(b); });
+    return expected;
+}
+
+int main( )
+{
+// A fixed batch.
+    printf("Priority order\n");
+    {
+        ALTAIR_CommandRouter router(handler);
+        const std::string    arrived = "bsxcSX2s";                      // ('S' is not a motor setting: only 's' is)
+        executed.clear();
+        for (size_t i = 0; i < arrived.size(); ++i) submit(router, arrived[i]);
+        check(router.pending() == arrived.size(),                        "every command is queued");
+        router.dispatchAll(now);
+        printf("    arrived %s, executed %s\n", arrived.c_str(), executed.c_str());
+        check(executed == "xXssbcS2",                                    "x and X first, then s, then everything else, each in arrival order");
+        check(ALTAIR_CommandRouter::priority('x') == COMMAND_PRIORITY_SHUTDOWN && ALTAIR_CommandRouter::priority('X') == COMMAND_PRIORITY_SHUTDOWN &&
+              ALTAIR_CommandRouter::priority('s') == COMMAND_PRIORITY_MOTOR && ALTAIR_CommandRouter::priority('c') == COMMAND_PRIORITY_OTHER,
+                                                                         "... as priority() says");
+    }
+
+// Random batches, interleaved with dispatching.
+    printf("Random batches\n");
+    {
+        static const char    types[] = "xXsssabcdlmnCS";
+        std::mt19937         random(17102026);
+        bool                 allInOrder = true, popInOrder = true;
+        unsigned long        commands   = 0;
+        for (int batch = 0; batch < RANDOM_BATCHES; ++batch) {
+            ALTAIR_CommandRouter router(handler);
+            std::string          arrived;
+            int                  length = 1 + random() % COMMAND_QUEUE_LENGTH;
+            for (int i = 0; i < length; ++i) arrived += types[random() % (sizeof(types) - 1)];
+            for (size_t i = 0; i < arrived.size(); ++i) submit(router, arrived[i]);
+            commands += arrived.size();
+            if (batch % 2 == 0) {
+                executed.clear();
+                router.dispatchAll(now);
+                if (executed != byPriority(arrived)) allInOrder = false;
+            } else {
+                std::string    popped;
+                ALTAIR_Command command;
+                while (router.nextCommand(command)) {
+                    popped += (char) command.type;
+                    router.commandExecuted(command);
+                }
+                if (popped != byPriority(arrived)) popInOrder = false;
+            }
+            now += 1000;
+        }
+        printf("    %d batches, %lu commands\n", RANDOM_BATCHES, commands);
+        check(allInOrder,                                                "dispatchAll() executes each batch in priority order, first-in first-out");
+        check(popInOrder,                                                "... as does nextCommand()");
+    }
+
+// A full queue.
+    printf("A full queue\n");
+    {
+        ALTAIR_CommandRouter router(handler);
+        for (int i = 0; i < COMMAND_QUEUE_LENGTH; ++i) submit(router, 'a' + i);
+        uint8_t newest = sequence;
+        check(submit(router, 'x') && router.pending() == COMMAND_QUEUE_LENGTH && router.stats()->dropped == 1,
+                                                                         "a shutdown still gets into a full queue (dropping a command, counted)");
+        executed.clear();
+        router.dispatchAll(now);
+        check(executed == "xabcdefg",                                    "... the newest of the lowest priority; the shutdown runs first");
+        executed.clear();
+        check(submit(router, 'h', newest) && router.dispatchAll(now) == 1 && executed == "h",
+                                                                         "... and the dropped command is accepted when it is sent again");
+
+        for (int i = 0; i < COMMAND_QUEUE_LENGTH; ++i) submit(router, (i % 2) ? 'x' : 'X');
+        check(!submit(router, 'b') && router.stats()->dropped == 2,      "a command that arrives when the queue is full of shutdowns is dropped");
+        check(!submit(router, 'x') && router.stats()->dropped == 3,      "... as is one more shutdown (the older ones go first)");
+        executed.clear();
+        router.dispatchAll(now);
+        check(executed == "XxXxXxXx",                                    "... and the shutdowns that were queued are all executed, in order");
+    }
+
+// Duplicates, and latency.
+    printf("Duplicates, and latency\n");
+    {
+        ALTAIR_CommandRouter router(handler);
+        now = 100000;
+        submit(router, 's', 42);
+        check(!submit(router, 's', 42) && router.stats()->duplicates == 1, "a copy of a pending command is not queued again");
+        executed.clear();
+        now += 250;
+        router.dispatchAll(now);
+        check(!submit(router, 's', 42) && router.stats()->duplicates == 2, "... nor of one already executed");
+        check(executed == "s" && router.stats()->dispatched == 1,        "... so it is executed once");
+        check(router.stats()->lastLatencyMillis == 250 && router.stats()->maxLatencyMillis == 250,
+                                                                         "its latency, from being received to being executed, is noted");
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRCurrentFilterBench.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) benchmark of the
+    Arduino Micro's ESC current filter: the previous float running average
+    (which shifted all 20 values of each channel along by one, and summed
+    them again, on every pass of loop()) against the O(1) fixed-point
+    ALTAIR_MovingAverage that replaced it (and the ALTAIR_ExpAverage and
+    ALTAIR_MedianFilter alternatives).  It feeds each one the same ADC
+    traces and checks that the packed (quarter-amp) currents are the same,
+    byte for byte.
+
+    The only differences allowed are where the exact average is precisely
+    on a quarter-amp boundary: there, the previous float sum could come
+    out a hair either side of the boundary, whereas the fixed-point sum is
+    exact.  These are counted separately.
+
+    The traces are either synthesized (idle noise, throttle ramps and
+    steps, and saturation at both ends of the ADC), or recorded: i.e. the
+    Micro's own USB serial output, in which the first 4 numbers of every
+    line of 12 numbers are the 4 current sensors' ADC readings.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../ALTAIRArduinoMicroRPMCurrentTempMon -o ALTAIRCurrentFilterBench ALTAIRCurrentFilterBench.cpp
+
+    To use:
+
+      ALTAIRCurrentFilterBench [recorded Micro serial output files ...]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define  HAVE_CYCLE_COUNTER
+#endif
+
+#include "ALTAIR_Filters.h"
+
+typedef  unsigned char  byte;
+typedef  std::vector< std::vector<int> >  Trace;                 // [sample][channel]
+
+const int     currentSensorZeroValue    =      505;              // (as in the sketch)
+const int     currentSensorTenthsPerAmp =       33;
+const int     numCurrentValsToAverage   =       20;
+
+/**************************************************************************/
+/*!
+    The previous filter and packing, line for line.
+*/
+/**************************************************************************/
+static byte packCurrent( float theCurrent ) {
+    float scaledCurrent = theCurrent*4.;
+    byte packCurr;
+    if (scaledCurrent >= 0. && scaledCurrent < 127.) {
+        packCurr = scaledCurrent;
+    } else if (scaledCurrent >= -128. && scaledCurrent < 0.) {
+        packCurr = scaledCurrent + 256.;
+    } else if (scaledCurrent >= 127.) {
+        packCurr = 127;
+    } else {
+        packCurr = 128;
+    }
+    return packCurr;
+}
+
+struct OldFilter {
+    OldFilter() { memset(currentInAmps, 0, sizeof(currentInAmps)); }
+    byte update( int currentSensorValue ) {
+        float currentRunningAverage = 0.;
+        for (int j = 0; j < numCurrentValsToAverage - 1; ++j) {
+            currentRunningAverage += currentInAmps[j+1];
+            currentInAmps[j] = currentInAmps[j+1];
+        }
+        currentInAmps[numCurrentValsToAverage-1] = (505-currentSensorValue)/3.3;
+        currentRunningAverage += currentInAmps[numCurrentValsToAverage-1];
+        currentRunningAverage /= numCurrentValsToAverage;
+        return packCurrent(currentRunningAverage);
+    }
+    float currentInAmps[numCurrentValsToAverage];
+};
+
+/**************************************************************************/
+/*!
+    The new filter and packing (packCurrentSum() is as in the sketch).
+*/
+/**************************************************************************/
+static byte packCurrentSum( long sumOfValues ) {
+    long numerator   = sumOfValues * 4 * 10;
+    long denominator = (long) numCurrentValsToAverage * currentSensorTenthsPerAmp;
+    long quarterAmps = (numerator >= 0) ? numerator / denominator : -((denominator - 1 - numerator) / denominator);
+    if (quarterAmps > 127)  return 127;
+    if (quarterAmps < -128) return 128;
+    return (byte) quarterAmps;
+}
+
+static bool onQuarterAmpBoundary( long sumOfValues ) {
+    return ((sumOfValues * 4 * 10) % ((long) numCurrentValsToAverage * currentSensorTenthsPerAmp)) == 0;
+}
+
+/**************************************************************************/
+/*!
+    The traces.
+*/
+/**************************************************************************/
+static int clampADC( double value ) { return (value < 0.) ? 0 : (value > 1023.) ? 1023 : (int) value; }
+
+static Trace synthesize( unsigned seed , long numSamples ) {
+    std::mt19937                     random(seed);
+    std::normal_distribution<double> noise(0., 3.);
+    std::uniform_int_distribution<int> anyValue(0, 1023);
+    Trace trace(numSamples, std::vector<int>(4));
+    for (long k = 0; k < numSamples; ++k) {
+        long   phase = (k / 5000) % 5;
+        double level;
+        switch (phase) {
+          case 0:  level = currentSensorZeroValue;                                         break;   // idle
+          case 1:  level = currentSensorZeroValue - 330. * (k % 5000) / 5000.;             break;   // throttle ramp, to 100 A
+          case 2:  level = ((k / 250) % 2) ? currentSensorZeroValue - 200. : currentSensorZeroValue + 30.; break;   // steps (and reverse current)
+          case 3:  level = ((k / 1000) % 2) ? -50. : 1100.;                                break;   // saturated, at both ends
+          default: level = -1.;                                                            break;   // anything at all
+        }
+        for (int c = 0; c < 4; ++c) trace[k][c] = (level < 0.) ? anyValue(random) : clampADC(level + noise(random) + 2*c);
+    }
+    return trace;
+}
+
+static Trace readRecorded( const char* fileName ) {
+    Trace trace;
+    FILE* file = fopen(fileName, "r");
+    if (!file) { fprintf(stderr, "Could not open %s\n", fileName); return trace; }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        std::vector<int> numbers;
+        char* p = line;
+        char* end;
+        for (long n = strtol(p, &end, 10); end != p; n = strtol(p, &end, 10)) { numbers.push_back((int) n); p = end; }
+        if (numbers.size() == 12 && strchr(line, '.') == NULL) trace.push_back(std::vector<int>(numbers.begin(), numbers.begin() + 4));
+    }
+    fclose(file);
+    return trace;
+}
+
+/**************************************************************************/
+/*!
+    Timing: cycles per update of one channel, on this host (or nanoseconds,
+    where there is no cycle counter).
+*/
+/**************************************************************************/
+static uint64_t now() {
+#ifdef    HAVE_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+template < class FILTER , class UPDATE >
+static double time( const Trace& trace , UPDATE update ) {
+    FILTER   filter[4];
+    unsigned checksum = 0;
+    uint64_t start = now();
+    for (size_t k = 0; k < trace.size(); ++k) {
+        for (int c = 0; c < 4; ++c) checksum += update(filter[c], trace[k][c]);
+    }
+    uint64_t stop = now();
+    if (checksum == 0xFFFFFFFF) printf(" ");                          // (so that none of it is optimized away)
+    return (double) (stop - start) / (4. * trace.size());
+}
+
+int main( int argc , char** argv )
+{
+    std::vector<Trace>        traces;
+    std::vector<std::string>  names;
+    for (int i = 1; i < argc; ++i) { traces.push_back(readRecorded(argv[i])); names.push_back(argv[i]); }
+    if (traces.empty()) {
+        for (unsigned seed = 1; seed <= 4; ++seed) { traces.push_back(synthesize(seed, 250000)); names.push_back("synthesized #" + std::to_string(seed)); }
+    }
+
+    bool ok = true;
+    printf("%-24s  %9s  %10s  %14s\n", "trace", "samples", "mismatches", "(on boundary)");
+    for (size_t t = 0; t < traces.size(); ++t) {
+        OldFilter                                               oldFilter[4];
+        ALTAIR_MovingAverage<int16_t, numCurrentValsToAverage>  newFilter[4];
+        long mismatches = 0, boundaries = 0;
+        for (size_t k = 0; k < traces[t].size(); ++k) {
+            for (int c = 0; c < 4; ++c) {
+                byte oldPacked = oldFilter[c].update(traces[t][k][c]);
+                newFilter[c].update(currentSensorZeroValue - traces[t][k][c]);
+                byte newPacked = packCurrentSum(newFilter[c].sum());
+                if (oldPacked == newPacked) continue;
+                if (onQuarterAmpBoundary(newFilter[c].sum())) ++boundaries;
+                else                                          ++mismatches;
+            }
+        }
+        printf("%-24s  %9zu  %10ld  %14ld\n", names[t].c_str(), traces[t].size() * 4, mismatches, boundaries);
+        if (mismatches > 0) ok = false;
+    }
+
+#ifdef    HAVE_CYCLE_COUNTER
+    const char* unit = "cycles";
+#else
+    const char* unit = "ns";
+#endif
+    const Trace& trace = traces[0];
+    typedef ALTAIR_MovingAverage<int16_t, numCurrentValsToAverage>  MovingAverage;
+    typedef ALTAIR_ExpAverage<int16_t, 3>                           ExpAverage;
+    typedef ALTAIR_MedianFilter<int16_t, 5>                         MedianFilter;
+    double oldTime    = time<OldFilter>(    trace, [](OldFilter& f,     int v) { return f.update(v); });
+    double movingTime = time<MovingAverage>(trace, [](MovingAverage& f, int v) { f.update(currentSensorZeroValue - v); return packCurrentSum(f.sum()); });
+    double expTime    = time<ExpAverage>(   trace, [](ExpAverage& f,    int v) { f.update(currentSensorZeroValue - v); return (byte) f.average(); });
+    double medianTime = time<MedianFilter>( trace, [](MedianFilter& f,  int v) { f.update(currentSensorZeroValue - v); return (byte) f.median(); });
+    printf("\nhost %s per update (filter and pack, one channel):\n", unit);
+    printf("  previous float running average (20)   %7.1f\n", oldTime);
+    printf("  ALTAIR_MovingAverage (20) + packing     %7.1f   (%.1fx faster)\n", movingTime, oldTime / movingTime);
+    printf("  ALTAIR_ExpAverage (1/8)                 %7.1f\n", expTime);
+    printf("  ALTAIR_MedianFilter (5)                 %7.1f\n", medianTime);
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
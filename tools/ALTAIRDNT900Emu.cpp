@@ -0,0 +1,699 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRDNT900Emu.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) test of the
+    DNT900 protocol-mode driver, with the very same ALTAIR_DNT900Protocol
+    class as in the flight code, against an emulated DNT900 radio.
+
+    The driver's glue (as in ALTAIR_DNT900, which depends upon the Arduino
+    libraries) is mirrored here: the AVR's serial TX and RX buffers (of
+    63 bytes each), CTS, the buffer of data received, and the noting of
+    each RSSI.  The emulated radio has the DNT900's UART (at 38400 baud,
+    in each direction, with CTS raised when its input buffer fills), its
+    startup time after a reset, its own parser of protocol-mode packets
+    (and, until it is sent EnterProtocolMode, transparent mode), a
+    register file (for GetRegister and SetRegister), and its RF link:
+    each packet takes some air time per attempt, each attempt (and each
+    acknowledgement) is lost with the given probability, and the radio
+    makes up to RADIO_ATTEMPTS attempts of its own before replying with
+    a TxDataReply (with the status, and the RSSI of the acknowledgement).
+    The remote radio sends the payload an uplink packet (an RxData packet,
+    with its RSSI) every UPLINK_INTERVAL, and now and then some garbage
+    (a truncated packet, after which it pauses) to test the resync.
+
+    The ground station parses the frames out of the data that gets
+    through, and reports which of them were delivered.  It reports:
+
+      - with the flight's load (a fan-out cycle of three frames every
+        RADIO_POLL_INTERVAL), at 0%, 10%, and 30% loss per attempt: the
+        frames delivered, the UART overhead, the retries, and the time to
+        each acknowledgement, in protocol mode, and the frames delivered
+        in transparent mode (with the radio's own retries only);
+      - with the link saturated: the throughput in each mode;
+      - that every TxData packet is accounted for (acknowledged, failed,
+        not linked, or timed out), and that every acknowledgement was
+        matched to its packet;
+      - with the radio reset in the middle of a flight, and with its link
+        down for a while: the backpressure (frames refused, rather than
+        queued without bound), and the recovery;
+      - that the registers read back what was set, and that each uplink
+        packet, and its RSSI, was received.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRDNT900Emu ALTAIRDNT900Emu.cpp ../libraries/ALTAIR_Devices/ALTAIR_DNT900Protocol.cpp
+
+    To use:
+
+      ALTAIRDNT900Emu [# of seconds per scenario]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "ALTAIR_DNT900Protocol.h"
+
+typedef  std::vector<byte>  Bytes;
+
+// As in ALTAIR_DNT900.h and ALTAIROperation.ino (which depend upon the Arduino libraries).
+#define  UART_BYTES_PER_MILLI      3.84          // 38400 baud
+#define  SERIAL_BUFFER              63          // (SERIAL_TX_BUFFER_SIZE - 1, and likewise for RX)
+#define  DNT_TX_QUEUE_SIZE         256
+#define  DNT_TX_BACKLOG_THRESHOLD  120
+#define  DNT_RX_BUFFER_SIZE         64
+#define  DNT_COMMAND_REPLY_TIMEOUT 1000
+#define  DNT_ENTER_PROTOCOL_TRIES    3
+#define  RADIO_POLL_INTERVAL       250
+#define  FRAME_LENGTHS             { 45 , 35 , 40 }   // (a fan-out cycle's frames, with their headers)
+
+// The emulated radio.
+#define  RADIO_STARTUP_MILLIS     1200          // after a reset, before it takes any input (so the first EnterProtocolMode is lost)
+#define  RADIO_UART_BUFFER         256
+#define  RADIO_CTS_THRESHOLD       192          // CTS is raised with more than this in its input buffer
+#define  RADIO_RF_QUEUE              2          // packets waiting to go out on the air
+#define  RADIO_ATTEMPTS              3          // its own attempts per packet
+#define  RADIO_TRANSPARENT_GAP       2          // in milliseconds: in transparent mode, a gap this long ends a packet
+#define  UPLINK_INTERVAL          1000          // in milliseconds
+#define  UPLINK_LENGTH               8
+#define  GARBAGE_INTERVAL         7000          // in milliseconds
+#define  GARBAGE_PAUSE             150          // in milliseconds (so that the parser times out)
+#define  FRAME_START              0xFA
+
+static unsigned long attemptMillis( size_t length ) { return 6 + length / 20; }   // the air time of one attempt
+
+/**************************************************************************/
+/*!
+    The ground station: frames, parsed out of the data that got through
+    (with a gap wherever a packet was lost, so that a frame cut by it is
+    dropped).  Each frame is [FRAME_START] [length] [id (3 bytes)] and
+    then filler (never FRAME_START) that depends upon its id.
+*/
+/**************************************************************************/
+static void makeFrame( byte* frame , uint8_t length , long id ) {
+    frame[0] = FRAME_START;
+    frame[1] = length;
+    ALTAIR_DNT900Protocol::putAddress(&frame[2], id);
+    for (uint8_t i = 5; i < length; ++i) frame[i] = 0x20 + (id + i) % 90;
+}
+
+struct Ground {
+    std::set<long> delivered;
+    long           duplicates, corrupt;
+    Bytes          partial;
+    Ground() : duplicates(0), corrupt(0) {}
+    void gap() { partial.clear(); }
+    void chunk( const byte* data , size_t length ) {
+        for (size_t i = 0; i < length; ++i) {
+            if (partial.empty() && data[i] != FRAME_START) { ++corrupt; continue; }
+            partial.push_back(data[i]);
+            if (partial.size() < 2 || partial.size() < partial[1]) continue;
+            long id = ALTAIR_DNT900Protocol::getAddress(&partial[2]);
+            byte expected[256];
+            makeFrame(expected, partial[1], id);
+            if (memcmp(expected, &partial[0], partial.size()) != 0) ++corrupt;
+            else if (!delivered.insert(id).second)                  ++duplicates;
+            partial.clear();
+        }
+    }
+};
+
+/**************************************************************************/
+/*!
+    The emulated DNT900.
+*/
+/**************************************************************************/
+struct RfPacket { Bytes data; bool isProtocol; };
+
+struct Radio {
+    std::mt19937                           random;
+    double                                 loss;
+    bool                                   protocol;
+    unsigned long                          readyMillis, linkDownFrom, linkDownUntil, resetAt;
+    std::deque<byte>                       uartIn, out;                 // (from the payload, and to it)
+    double                                 outDrained;
+    unsigned long                          outHoldUntil;
+    int                                    junkLeft;                    // (bytes of garbage still to go out, before the pause)
+    Bytes                                  parsing, building;           // (a protocol-mode packet, and a transparent-mode one)
+    unsigned long                          lastInMillis;
+    std::deque<RfPacket>                   rf;
+    bool                                   busy;
+    unsigned long                          busyUntil;
+    bool                                   busyDelivered, busyAcked;
+    char                                   busyRSSI;
+    byte                                   regs[4][256];
+    Ground*                                ground;
+    long                                   acked, notLinked, overruns, uplinks, garbage, lastUplinkRSSI, attempts;
+    std::uniform_real_distribution<double> uniform;
+
+    Radio( unsigned seed , double lossRate , Ground* g ) :
+        random(seed), loss(lossRate), protocol(false), readyMillis(RADIO_STARTUP_MILLIS), linkDownFrom(~0UL), linkDownUntil(0),
+        resetAt(~0UL), outDrained(0.), outHoldUntil(0), junkLeft(0), lastInMillis(0), busy(false), busyUntil(0), busyDelivered(false),
+        busyAcked(false), busyRSSI(0), ground(g), acked(0), notLinked(0), overruns(0), uplinks(0), garbage(0), lastUplinkRSSI(0),
+        attempts(0), uniform(0., 1.) {
+        for (int b = 0; b < 4; ++b) for (int r = 0; r < 256; ++r) regs[b][r] = (byte) (b * 37 + r * 11);
+    }
+
+    bool ctsHigh( unsigned long now ) const { return now < readyMillis || uartIn.size() > RADIO_CTS_THRESHOLD; }
+    void fromPayload( byte aByte , unsigned long now ) {
+        if (now < readyMillis) return;                                          // (still starting up)
+        if (uartIn.size() == RADIO_UART_BUFFER) { ++overruns; return; }
+        uartIn.push_back(aByte);
+    }
+    void reply( const Bytes& packet ) {
+        out.push_back(DNT_START_OF_PACKET);
+        out.push_back(packet.size());
+        out.insert(out.end(), packet.begin(), packet.end());
+    }
+    char rssi() { return (char) (-80 - (int) (12. * uniform(random))); }
+
+// A whole protocol-mode packet from the payload (its type, and then its arguments).
+    void command( const Bytes& packet ) {
+        if (packet.empty()) return;
+        switch (packet[0]) {
+        case DNT_TX_DATA:
+            rf.push_back(RfPacket{ Bytes(packet.begin() + 4, packet.end()), true });
+            break;
+        case DNT_GET_REGISTER: {
+            Bytes r(packet.begin(), packet.begin() + 4);
+            r[0] = DNT_GET_REGISTER_REPLY;
+            for (int i = 0; i < packet[3]; ++i) r.push_back(regs[packet[2] & 3][(packet[1] + i) & 0xFF]);
+            reply(r);
+            break;
+        }
+        case DNT_SET_REGISTER:
+            for (int i = 0; i < packet[3]; ++i) regs[packet[2] & 3][(packet[1] + i) & 0xFF] = packet[4 + i];
+            reply(Bytes(1, DNT_SET_REGISTER | DNT_REPLY));
+            break;
+        }
+    }
+
+    void step( unsigned long now ) {
+        if (now == resetAt) {                                                   // (e.g. a brownout): everything is lost
+            protocol = false; readyMillis = now + RADIO_STARTUP_MILLIS; busy = false;
+            uartIn.clear(); out.clear(); rf.clear(); parsing.clear(); building.clear();
+        }
+        if (now == readyMillis && resetAt != ~0UL) { protocol = true; reply(Bytes{ DNT_ANNOUNCE, 0xA0 }); }   // (it keeps its protocol-mode setting)
+        if (now < readyMillis) return;
+
+// Its input, for as long as its RF queue has room.
+        while (!uartIn.empty() && rf.size() < RADIO_RF_QUEUE) {
+            byte b = uartIn.front();
+            uartIn.pop_front();
+            lastInMillis = now;
+            if (!protocol) {
+                static const byte enter[] = { DNT_START_OF_PACKET, 0x07, DNT_ENTER_PROTOCOL_MODE, 'D', 'N', 'T', 'C', 'F', 'G' };
+                building.push_back(b);
+                if (building.size() >= sizeof(enter) && memcmp(&building[building.size() - sizeof(enter)], enter, sizeof(enter)) == 0) {
+                    protocol = true;
+                    building.clear();
+                    reply(Bytes(1, DNT_ENTER_PROTOCOL_MODE | DNT_REPLY));
+                } else if (building.size() == DNT_PROTOCOL_MAX_DATA) {
+                    rf.push_back(RfPacket{ building, false });
+                    building.clear();
+                }
+                continue;
+            }
+            if (parsing.empty() && b != DNT_START_OF_PACKET) continue;
+            parsing.push_back(b);
+            if (parsing.size() >= 2 && parsing.size() == (size_t) parsing[1] + 2) {
+                command(Bytes(parsing.begin() + 2, parsing.end()));
+                parsing.clear();
+            }
+        }
+        if (!protocol && !building.empty() && now - lastInMillis >= RADIO_TRANSPARENT_GAP && rf.size() < RADIO_RF_QUEUE) {
+            rf.push_back(RfPacket{ building, false });
+            building.clear();
+        }
+
+// The RF link: each packet, with the radio's own attempts, and then its reply.
+        bool linkDown = now >= linkDownFrom && now < linkDownUntil;
+        if (busy && now >= busyUntil) {
+            RfPacket& p = rf.front();
+            if (busyDelivered) ground->chunk(&p.data[0], p.data.size());
+            else               ground->gap();
+            if (p.isProtocol) {
+                Bytes r{ DNT_TX_DATA_REPLY, (byte) (busyAcked ? DNT_TX_STATUS_ACK : DNT_TX_STATUS_NO_ACK), 0, 0, 0, (byte) busyRSSI };
+                reply(r);
+                acked += busyAcked;
+            }
+            rf.pop_front();
+            busy = false;
+        }
+        if (!busy && !rf.empty()) {
+            if (linkDown) {
+                if (rf.front().isProtocol) { reply(Bytes{ DNT_TX_DATA_REPLY, DNT_TX_STATUS_NOT_LINKED, 0, 0, 0, 0 }); ++notLinked; }
+                else                       ground->gap();
+                rf.pop_front();
+            } else {
+                unsigned long t = 0;
+                busyDelivered   = busyAcked = false;
+                for (int a = 0; a < RADIO_ATTEMPTS && !busyAcked; ++a) {
+                    t += attemptMillis(rf.front().data.size());
+                    ++attempts;
+                    bool got       = uniform(random) >= loss;
+                    busyDelivered |= got;                                       // (the remote radio drops its own repeats)
+                    busyAcked      = got && uniform(random) >= loss;
+                }
+                busyRSSI  = rssi();
+                busy      = true;
+                busyUntil = now + t;
+            }
+        }
+
+// The uplink, and now and then some garbage.
+        if (protocol && !linkDown && now % UPLINK_INTERVAL == 500) {
+            char  r = rssi();
+            Bytes packet{ DNT_RX_DATA, 0, 0, 0, (byte) r };
+            for (int i = 0; i < UPLINK_LENGTH; ++i) packet.push_back((byte) (uplinks + i));
+            reply(packet);
+            ++uplinks;
+            lastUplinkRSSI = r;
+        }
+        if (protocol && now % GARBAGE_INTERVAL == 3100 && out.empty()) {
+            static const byte junk[] = { 0x55, 0x00, DNT_START_OF_PACKET, 0x20, DNT_RX_DATA, 1, 2 };
+            out.insert(out.end(), junk, junk + sizeof(junk));
+            junkLeft = sizeof(junk);
+            ++garbage;
+        }
+    }
+
+// Its output to the payload, at the UART's rate.
+    void toPayload( unsigned long now , std::deque<byte>& payloadRx , long& payloadOverruns ) {
+        outDrained += UART_BYTES_PER_MILLI;
+        while (outDrained >= 1. && !out.empty() && now >= outHoldUntil) {
+            if (payloadRx.size() == SERIAL_BUFFER) ++payloadOverruns;
+            else                                   payloadRx.push_back(out.front());
+            out.pop_front();
+            outDrained -= 1.;
+            if (junkLeft > 0 && --junkLeft == 0) outHoldUntil = now + GARBAGE_PAUSE;
+        }
+        if (out.empty()) outDrained = 0.;
+    }
+};
+
+/**************************************************************************/
+/*!
+    The payload's side: as ALTAIR_DNT900 (in protocol mode, or else its TX
+    queue in transparent mode), on the AVR's serial buffers.
+*/
+/**************************************************************************/
+struct World;
+
+struct Dnt {
+    World*                 world;
+    bool                   _protocolMode;
+    ALTAIR_DNT900Protocol  _protocol;
+    std::deque<byte>       txBuffer, rxBuffer;                              // the AVR's serial buffers
+    std::deque<byte>       txQueue;                                         // (transparent mode)
+    byte                   _rxBuffer[DNT_RX_BUFFER_SIZE];
+    uint8_t                _rxHead, _rxCount;
+    long                   _rxDropped, serialOverruns, framesQueued, framesRejected, ctsBlockedCount, bytesSent;
+    char                   _lastRSSI;
+    unsigned long          _lastRSSIMillis;
+
+    Dnt( World* w , bool protocolMode ) :
+        world(w), _protocolMode(protocolMode), _rxHead(0), _rxCount(0), _rxDropped(0), serialOverruns(0), framesQueued(0),
+        framesRejected(0), ctsBlockedCount(0), bytesSent(0), _lastRSSI(127), _lastRSSIMillis(0) {}
+
+    unsigned long txMillis();
+    bool          clearToSend();
+    void          tick();                                                   // (the emulator's time moves on, where the flight code spins)
+    int           uartWriteSpace() { return SERIAL_BUFFER - txBuffer.size(); }
+    size_t        uartWrite( const byte* bytes , size_t n ) { txBuffer.insert(txBuffer.end(), bytes, bytes + n); return n; }
+    int           uartAvailable() { return rxBuffer.size(); }
+    int           uartRead() { if (rxBuffer.empty()) return -1; byte b = rxBuffer.front(); rxBuffer.pop_front(); return b; }
+    void          noteRSSI( char dBm , unsigned long now ) { _lastRSSI = dBm; _lastRSSIMillis = now; }
+    uint16_t      txRoom() { return _protocolMode ? _protocol.room() : DNT_TX_QUEUE_SIZE - txQueue.size(); }
+    bool          txBacklogged() { return txRoom() < DNT_TX_BACKLOG_THRESHOLD; }
+
+// As ALTAIR_DNT900::initialize, once the radio is out of its reset.
+    bool initialize() {
+        if (!_protocolMode) return true;
+        const byte dntcfg[] = { 'D', 'N', 'T', 'C', 'F', 'G' };
+        bool       entered  = false;
+        for (uint8_t i = 0; i < DNT_ENTER_PROTOCOL_TRIES && !entered; ++i) {
+            _protocol.queueCommand(DNT_ENTER_PROTOCOL_MODE, dntcfg, sizeof(dntcfg));
+            entered = awaitReply(DNT_ENTER_PROTOCOL_MODE | DNT_REPLY);
+        }
+        if (!entered) _protocolMode = false;
+        return entered;
+    }
+
+// As ALTAIR_DNT900::enqueue.
+    bool enqueue( const byte* bytes , uint16_t numBytes ) {
+        if (_protocolMode) {
+            if (!_protocol.fits(numBytes)) {
+                ++framesRejected;
+                return false;
+            }
+            for (uint16_t offset = 0; offset < numBytes; offset += DNT_PROTOCOL_MAX_DATA) {
+                uint16_t length = numBytes - offset;
+                if (length > DNT_PROTOCOL_MAX_DATA) length = DNT_PROTOCOL_MAX_DATA;
+                _protocol.append(bytes + offset, length);
+            }
+            ++framesQueued;
+            return true;
+        }
+        if (numBytes > txRoom()) {
+            ++framesRejected;
+            serviceTx();
+            return false;
+        }
+        txQueue.insert(txQueue.end(), bytes, bytes + numBytes);
+        ++framesQueued;
+        serviceTx();
+        return true;
+    }
+
+// As ALTAIR_DNT900::serviceTx.
+    uint16_t serviceTx() {
+        if (_protocolMode) {
+            serviceRx();
+            return serviceProtocolTx();
+        }
+        uint16_t written = 0;
+        while (!txQueue.empty()) {
+            if (!clearToSend()) { ++ctsBlockedCount; break; }
+            int space = uartWriteSpace();
+            if (space <= 0) break;
+            int n = std::min((int) txQueue.size(), space);
+            for (int i = 0; i < n; ++i) { txBuffer.push_back(txQueue.front()); txQueue.pop_front(); }
+            written += n;
+        }
+        bytesSent += written;
+        return written;
+    }
+
+// As ALTAIR_DNT900::serviceProtocolTx (serviceTx handles the replies first).
+    uint16_t serviceProtocolTx() {
+        _protocol.expire(txMillis());
+        uint16_t    written = 0;
+        const byte* bytes;
+        uint8_t     pending;
+        while ((pending = _protocol.nextBytes(bytes)) > 0) {
+            if (!clearToSend()) { ++ctsBlockedCount; break; }
+            int space = uartWriteSpace();
+            if (space <= 0) break;
+            if (pending > space) pending = space;
+            pending = uartWrite(bytes, pending);
+            if (pending == 0) break;
+            _protocol.wrote(pending, txMillis());
+            written += pending;
+        }
+        bytesSent += written;
+        return written;
+    }
+
+// As ALTAIR_DNT900::serviceRx and pollRx.
+    uint16_t serviceRx() {
+        uint16_t parsed = 0;
+        if (!_protocolMode) return parsed;
+        while (uartAvailable() > 0) { pollRx(); ++parsed; }
+        return parsed;
+    }
+    byte pollRx() {
+        int b = uartRead();
+        if (b < 0) return DNT_NO_PACKET;
+        unsigned long now    = txMillis();
+        byte          type   = _protocol.feed((byte) b, now);
+        const byte*   packet = _protocol.packet();
+        uint8_t       length = _protocol.packetLength();
+        if ((type == DNT_RX_DATA || type == DNT_RX_EVENT) && length >= DNT_RX_DATA_OVERHEAD - 2) {
+            noteRSSI((char) packet[4], now);
+            for (uint8_t i = DNT_RX_DATA_OVERHEAD - 2; i < length; ++i) {
+                if (_rxCount == DNT_RX_BUFFER_SIZE) { ++_rxDropped; continue; }
+                _rxBuffer[(_rxHead + _rxCount++) % DNT_RX_BUFFER_SIZE] = packet[i];
+            }
+        } else if (type == DNT_TX_DATA_REPLY && length >= 6 && packet[1] == DNT_TX_STATUS_ACK) {
+            noteRSSI((char) packet[5], now);
+        }
+        return type;
+    }
+
+// As ALTAIR_DNT900::awaitReply, getRegister, and setRegister.
+    bool awaitReply( byte type ) {
+        unsigned long start = txMillis();
+        while (txMillis() - start < DNT_COMMAND_REPLY_TIMEOUT) {
+            serviceProtocolTx();
+            while (uartAvailable() > 0) {
+                if (pollRx() == type) return true;
+            }
+            tick();
+        }
+        return false;
+    }
+    bool getRegister( byte reg , byte bank , byte span , byte* value ) {
+        const byte arguments[] = { reg, bank, span };
+        if (!_protocolMode || !_protocol.queueCommand(DNT_GET_REGISTER, arguments, sizeof(arguments))) return false;
+        if (!awaitReply(DNT_GET_REGISTER_REPLY)) return false;
+        const byte* reply = _protocol.packet();
+        if (_protocol.packetLength() < 4 + span || reply[1] != reg || reply[2] != bank || reply[3] != span) return false;
+        memcpy(value, &reply[4], span);
+        return true;
+    }
+    bool setRegister( byte reg , byte bank , byte span , const byte* value ) {
+        byte arguments[3 + DNT_PROTOCOL_MAX_DATA];
+        if (!_protocolMode || span > DNT_PROTOCOL_MAX_DATA) return false;
+        arguments[0] = reg; arguments[1] = bank; arguments[2] = span;
+        memcpy(&arguments[3], value, span);
+        if (!_protocol.queueCommand(DNT_SET_REGISTER, arguments, 3 + span)) return false;
+        return awaitReply(DNT_SET_REGISTER | DNT_REPLY);
+    }
+
+// As ALTAIR_DNT900::available and read.
+    bool available() {
+        if (_protocolMode) { serviceRx(); return _rxCount > 0; }
+        return uartAvailable() > 0;
+    }
+    byte read() {
+        if (_protocolMode) {
+            if (_rxCount == 0) serviceRx();
+            if (_rxCount == 0) return 0;
+            byte b  = _rxBuffer[_rxHead];
+            _rxHead = (_rxHead + 1) % DNT_RX_BUFFER_SIZE;
+            --_rxCount;
+            return b;
+        }
+        return uartRead();
+    }
+};
+
+/**************************************************************************/
+/*!
+    The payload and the radio, a millisecond at a time.
+*/
+/**************************************************************************/
+struct World {
+    unsigned long now;
+    Ground        ground;
+    Radio         radio;
+    Dnt           dnt;
+    double        txDrained;
+    Bytes         uplink;                                                   // (the data read from the radio)
+    World( unsigned seed , double loss , bool protocolMode ) : now(0), radio(seed, loss, &ground), dnt(this, protocolMode), txDrained(0.) {}
+    void tick() {
+        txDrained += UART_BYTES_PER_MILLI;
+        while (txDrained >= 1. && !dnt.txBuffer.empty()) {
+            radio.fromPayload(dnt.txBuffer.front(), now);
+            dnt.txBuffer.pop_front();
+            txDrained -= 1.;
+        }
+        if (dnt.txBuffer.empty()) txDrained = 0.;
+        radio.step(now);
+        radio.toPayload(now, dnt.rxBuffer, dnt.serialOverruns);
+        ++now;
+    }
+};
+
+unsigned long Dnt::txMillis()    { return world->now; }
+bool          Dnt::clearToSend() { return !world->radio.ctsHigh(world->now); }
+void          Dnt::tick()        { world->tick(); }
+
+struct Result {
+    long   built, skipped, delivered, deliveredInTime, duplicates, corrupt, uplinkBytes, rejected, markId;
+    double seconds;
+};
+
+/**************************************************************************/
+/*!
+    Run for the given # of seconds: with the flight's load (a fan-out
+    cycle every RADIO_POLL_INTERVAL, skipped while the radio is
+    backlogged), or else saturated (frames queued whenever there is
+    room).  Then stop queueing, and let everything that was sent finish.
+    (markId is the id of the last frame built before the time mark.)
+*/
+/**************************************************************************/
+static Result run( World& world , long seconds , bool saturate , unsigned long mark = ~0UL ) {
+    Result        result;
+    memset(&result, 0, sizeof(result));
+    const uint8_t lengths[] = FRAME_LENGTHS;
+    byte          frame[256];
+    long          id  = 1;
+    unsigned long end = world.now + seconds * 1000;
+    while (world.now < end) {
+        if (world.now == mark) result.markId = id - 1;
+        if (saturate) {
+            makeFrame(frame, lengths[id % 3], id);
+            while (world.dnt.txRoom() >= lengths[id % 3] && world.dnt.enqueue(frame, lengths[id % 3])) {
+                ++result.built;
+                ++id;
+                makeFrame(frame, lengths[id % 3], id);
+            }
+        } else if (world.now % RADIO_POLL_INTERVAL == 0 && world.dnt.txBacklogged()) {
+            ++result.skipped;
+        } else if (world.now % RADIO_POLL_INTERVAL == 0) {
+            for (int f = 0; f < 3; ++f, ++id) {
+                makeFrame(frame, lengths[f], id);
+                ++result.built;
+                if (!world.dnt.enqueue(frame, lengths[f])) { ++id; break; }   // (as fanOutStatus does)
+            }
+        }
+        world.dnt.serviceTx();
+        while (world.dnt.available()) world.uplink.push_back(world.dnt.read());
+        world.tick();
+    }
+    result.seconds         = seconds;
+    result.deliveredInTime = world.ground.delivered.size();
+    for (unsigned long drain = world.now + 5000; world.now < drain; world.tick()) {
+        world.dnt.serviceTx();
+        while (world.dnt.available()) world.uplink.push_back(world.dnt.read());
+    }
+    result.delivered   = world.ground.delivered.size();
+    result.duplicates  = world.ground.duplicates;
+    result.corrupt     = world.ground.corrupt;
+    result.rejected    = world.dnt.framesRejected;
+    result.uplinkBytes = world.uplink.size();
+    return result;
+}
+
+// Start up the radio, and (in protocol mode) put it into protocol mode.
+static bool start( World& world ) {
+    if (world.dnt._protocolMode) return world.dnt.initialize();
+    while (world.radio.ctsHigh(world.now)) world.tick();
+    return true;
+}
+
+// Every TxData packet is acknowledged, failed, not linked, or timed out; every acknowledgement matched.
+static bool accounted( World& world ) {
+    const ALTAIR_DNT900ProtocolStats* s = world.dnt._protocol.stats();
+    return world.dnt._protocol.idle() && s->acked + s->failed + s->notLinked + s->timeouts == s->packetsSent &&
+           s->unmatchedReplies == 0 && (long) s->acked == world.radio.acked;
+}
+
+// Each uplink packet's data, in order, with nothing lost.
+static bool uplinkIntact( World& world ) {
+    if ((long) world.uplink.size() != world.radio.uplinks * UPLINK_LENGTH) return false;
+    for (size_t i = 0; i < world.uplink.size(); ++i) {
+        if (world.uplink[i] != (byte) (i / UPLINK_LENGTH + i % UPLINK_LENGTH)) return false;
+    }
+    return true;
+}
+
+static void printProtocolStats( World& world ) {
+    const ALTAIR_DNT900ProtocolStats* s = world.dnt._protocol.stats();
+    printf("    packets %lu (%.1f frames each), acked %lu, retries %lu, failed %lu, not linked %lu, timed out %lu\n",
+           s->packetsSent, s->packetsSent ? (double) s->framesSent / s->packetsSent : 0., s->acked, s->retries, s->failed, s->notLinked, s->timeouts);
+    printf("    UART overhead %.1f%% (of %lu bytes), ack time mean %.0f ms, max %lu ms; received %lu packets, %lu bad, %lu announcements\n",
+           100. * (s->uartBytesSent - s->dataBytesSent) / std::max(1UL, s->uartBytesSent), s->uartBytesSent,
+           s->acked ? (double) s->totalAckMillis / s->acked : 0., s->maxAckMillis, s->rxPackets, s->badPackets, s->announcements);
+}
+
+int main( int argc , char** argv )
+{
+    long seconds = (argc > 1) ? atol(argv[1]) : 600;
+    bool ok      = true;
+    printf("%ld s per scenario; a fan-out cycle of %d bytes every %d ms, on a 38400-baud UART; the radio makes up to %d attempts per packet\n\n",
+           seconds, 45 + 35 + 40, RADIO_POLL_INTERVAL, RADIO_ATTEMPTS);
+
+// The flight's load, at each loss rate, in each mode.
+    const double losses[] = { 0., 0.1, 0.3 };
+    for (int l = 0; l < 3; ++l) {
+        World  protocol(l + 1, losses[l], true), transparent(l + 1, losses[l], false);
+        bool   entered = start(protocol);
+        start(transparent);
+        Result p = run(protocol, seconds, false), t = run(transparent, seconds, false);
+        printf("the flight's load, with %.0f%% of the attempts (and acknowledgements) lost:\n", 100. * losses[l]);
+        printf("  protocol mode:    %ld of %ld frames delivered (%.3f%%), %ld duplicates, %ld refused\n",
+               p.delivered, p.built, 100. * p.delivered / p.built, p.duplicates, p.rejected);
+        printProtocolStats(protocol);
+        printf("  transparent mode: %ld of %ld frames delivered (%.3f%%)\n", t.delivered, t.built, 100. * t.delivered / t.built);
+        printf("  uplink: %ld packets, last RSSI noted %d dBm (sent %ld dBm), %ld bytes read, %ld dropped; %ld garbage bursts\n",
+               protocol.radio.uplinks, protocol.dnt._lastRSSI, protocol.radio.lastUplinkRSSI, p.uplinkBytes, protocol.dnt._rxDropped, protocol.radio.garbage);
+        bool good = entered && accounted(protocol) && uplinkIntact(protocol) && p.corrupt == 0 && t.corrupt == 0 &&
+                    p.rejected == 0 && protocol.dnt.serialOverruns == 0 && protocol.radio.overruns == 0 &&
+                    protocol.dnt._protocol.stats()->badPackets + 1 >= (unsigned long) protocol.radio.garbage &&
+                    p.delivered >= t.delivered && (l > 0 || p.delivered == p.built);
+        printf("  %s\n\n", good ? "ok" : "FAILED");
+        ok &= good;
+    }
+
+// Saturated: the throughput.
+    for (int l = 0; l < 3; l += 2) {
+        World  protocol(11, losses[l], true), transparent(11, losses[l], false);
+        start(protocol);
+        start(transparent);
+        Result p = run(protocol, seconds / 10, true), t = run(transparent, seconds / 10, true);
+        double pRate = p.deliveredInTime * 40. / p.seconds, tRate = t.deliveredInTime * 40. / t.seconds;   // (the frames average 40 bytes)
+        printf("saturated, with %.0f%% lost:\n  protocol mode %.0f bytes/s (%.1f%% delivered), transparent mode %.0f bytes/s (%.1f%% delivered)\n",
+               100. * losses[l], pRate, 100. * p.delivered / p.built, tRate, 100. * t.delivered / t.built);
+        printProtocolStats(protocol);
+        bool good = accounted(protocol) && p.corrupt == 0 && (l > 0 || (pRate >= 0.9 * tRate && p.delivered == p.built));
+        printf("  %s\n\n", good ? "ok" : "FAILED");
+        ok &= good;
+    }
+
+// The radio reset, and its link down, in the middle of a flight: backpressure, and recovery.
+    for (int scenario = 0; scenario < 2; ++scenario) {
+        World world(21, 0.1, true);
+        bool  entered = start(world);
+        if (scenario == 0) world.radio.resetAt = (world.now / RADIO_POLL_INTERVAL + 240) * RADIO_POLL_INTERVAL + 20;   // (with a packet part way out)
+        else             { world.radio.linkDownFrom = world.now + 60000; world.radio.linkDownUntil = world.now + 70000; }
+        unsigned long after = world.now + (scenario == 0 ? 60000 + RADIO_STARTUP_MILLIS : 70000) + DNT_TX_REPLY_TIMEOUT;
+        Result r = run(world, 120, false, after);
+        long   late = 0;
+        for (long id : world.ground.delivered) late += (id > r.markId);
+        printf("%s:\n  %ld of %ld frames delivered (%ld of %ld of them afterwards), %ld cycles skipped while backlogged, %ld frames refused\n",
+               scenario == 0 ? "the radio reset (and silent for its startup) 1 minute in" : "the link down for 10 s, 1 minute in",
+               r.delivered, r.built, late, r.built - r.markId, r.skipped, r.rejected);
+        printProtocolStats(world);
+        bool good = entered && accounted(world) && late >= 0.95 * (r.built - r.markId) &&
+                    world.dnt.txBuffer.size() <= SERIAL_BUFFER && world.radio.overruns == 0 &&
+                    (scenario == 0 ? r.skipped > 0 && world.dnt._protocol.stats()->timeouts > 0 && world.dnt._protocol.stats()->announcements == 1
+                                   : world.dnt._protocol.stats()->notLinked > 0);
+        printf("  %s\n\n", good ? "ok" : "FAILED");
+        ok &= good;
+    }
+
+// The registers, with data in flight.
+    {
+        World world(31, 0.1, true);
+        bool  good = start(world);
+        run(world, 2, false);
+        const byte set[4] = { 0x12, 0x34, 0x56, 0x78 };
+        byte       got[4], before[4];
+        good &= world.dnt.getRegister(0x20, 1, 4, before) && memcmp(before, &world.radio.regs[1][0x20], 4) == 0;
+        good &= world.dnt.setRegister(0x20, 1, 4, set)    && world.dnt.getRegister(0x20, 1, 4, got) && memcmp(got, set, 4) == 0;
+        good &= accounted(world);
+        printf("registers: read, set, and read back (with data in flight): %s\n\n", good ? "ok" : "FAILED");
+        ok &= good;
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,427 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRDNT900TxTest.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) test of the
+    DNT900's transmit backpressure, with the very same TX queue (in
+    transparent mode) and TxData packets (in protocol mode) as in the
+    flight code, ALTAIR_DNT900TxQueue and ALTAIR_DNT900Protocol, on a
+    simulated clock, against a simulated CTS line and UART.
+
+    ALTAIR_DNT900's enqueue() and serviceTx() (which depend upon the
+    Arduino libraries) are mirrored here, over the protected virtual
+    member functions that they go through: clearToSend() is the simulated
+    CTS line, and uartWriteSpace() and uartWrite() are the AVR's 63-byte
+    serial TX buffer, which drains to the radio at 38400 baud.  The main
+    loop calls serviceTx() every DNT900_TX_SERVICE_INTERVAL (as the "DNT900
+    TX queue" task does), as well as on every send.
+
+    It checks:
+
+      - with the flight's load, and CTS low: that every frame goes out,
+        byte for byte, in order, with little latency;
+      - with CTS held high for a while: that nothing is written to the
+        UART, that each serviceTx() that finds data waiting is counted as
+        blocked, that the frames that do not fit are rejected whole (so
+        that what the radio gets is exactly the frames accepted), that
+        the latency of the frames held up is noted, and that the queue
+        drains once CTS is low again;
+      - with the UART's buffer full: the same, but not counted as CTS;
+      - that many small sends, beyond the frames that the queue keeps
+        track of, are coalesced, and still all go out, in order;
+      - in protocol mode: that fits() agrees with what append() would
+        take, in every state of the TxData packets, and that a frame
+        longer than a packet is queued whole or not at all (where piece
+        by piece, as before, part of it would have been queued).
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRDNT900TxTest ALTAIRDNT900TxTest.cpp ../libraries/ALTAIR_Devices/ALTAIR_DNT900TxQueue.cpp ../libraries/ALTAIR_Devices/ALTAIR_DNT900Protocol.cpp
+
+    To use:
+
+      ALTAIRDNT900TxTest
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_DNT900TxQueue.h"
+#include "ALTAIR_DNT900Protocol.h"
+
+typedef  std::vector<byte>  Bytes;
+
+// As in ALTAIROperation.ino, and the AVR's serial port.
+#define  DNT900_TX_SERVICE_INTERVAL   10          // in milliseconds (the "DNT900 TX queue" task)
+#define  RADIO_POLL_INTERVAL         250          // in milliseconds: a fan-out cycle's frames are sent this often
+#define  FRAME_LENGTHS               { 45 , 35 , 40 }   // (a cycle's frames, with their headers)
+#define  UART_BYTES_PER_MILLI       3.84          // 38400 baud
+#define  SERIAL_BUFFER                63          // (SERIAL_TX_BUFFER_SIZE - 1)
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+/**************************************************************************/
+/*!
+    The simulated clock, CTS line and UART, and the DNT900's driver, as
+    ALTAIR_DNT900 (enqueue and serviceTx), with the flight code's queue
+    and protocol.
+*/
+/**************************************************************************/
+struct Dnt {
+    unsigned long          now;
+    bool                   ctsHigh, uartStuck;
+    std::deque<byte>       txBuffer;                                        // the AVR's serial TX buffer
+    double                 drained;
+    Bytes                  radio;                                           // what the radio has received over the UART
+    bool                   _protocolMode;
+    ALTAIR_DNT900TxQueue   _txQueue;
+    ALTAIR_DNT900Protocol  _protocol;
+    unsigned long          serviceCalls, blockedCalls, bytesWrittenWhileHigh;
+
+    Dnt( bool protocolMode ) : now(0), ctsHigh(false), uartStuck(false), drained(0.), _protocolMode(protocolMode),
+                               serviceCalls(0), blockedCalls(0), bytesWrittenWhileHigh(0) {}
+
+    unsigned long txMillis() { return now; }
+    bool          clearToSend() { return !ctsHigh; }
+    int           uartWriteSpace() { return uartStuck ? 0 : SERIAL_BUFFER - (int) txBuffer.size(); }
+    size_t        uartWrite( const byte* bytes , size_t n ) {
+        txBuffer.insert(txBuffer.end(), bytes, bytes + n);
+        if (ctsHigh) bytesWrittenWhileHigh += n;
+        return n;
+    }
+
+// As ALTAIR_DNT900::enqueue.
+    bool enqueue( const byte* bytes , uint16_t numBytes ) {
+        if (_protocolMode) {
+            if (!_protocol.fits(numBytes)) {
+                ++_txQueue.stats()->framesRejected;
+                return false;
+            }
+            for (uint16_t offset = 0; offset < numBytes; offset += DNT_PROTOCOL_MAX_DATA) {
+                uint16_t length = numBytes - offset;
+                if (length > DNT_PROTOCOL_MAX_DATA) length = DNT_PROTOCOL_MAX_DATA;
+                _protocol.append(bytes + offset, length);
+            }
+            ++_txQueue.stats()->framesQueued;
+            return true;
+        }
+        bool queued = _txQueue.push(bytes, numBytes, txMillis());
+        serviceTx();
+        return queued;
+    }
+
+// As ALTAIR_DNT900::serviceTx (with a count of the calls that found data waiting, but CTS high).
+    uint16_t serviceTx() {
+        ++serviceCalls;
+        const byte* peek;
+        if (ctsHigh && (_protocolMode ? _protocol.nextBytes(peek) : _txQueue.nextBytes(peek)) > 0) ++blockedCalls;
+        if (_protocolMode) return serviceProtocolTx();
+        uint16_t    written = 0;
+        const byte* bytes;
+        uint16_t    pending;
+        while ((pending = _txQueue.nextBytes(bytes)) > 0) {
+            if (!clearToSend()) {
+                ++_txQueue.stats()->ctsBlockedCount;
+                break;
+            }
+            int space = uartWriteSpace();
+            if (space <= 0) break;
+            if (pending > (uint16_t) space) pending = space;
+            pending = uartWrite(bytes, pending);
+            if (pending == 0) break;
+            _txQueue.wrote(pending, txMillis());
+            written += pending;
+        }
+        _txQueue.stats()->bytesSent += written;
+        return written;
+    }
+
+// As ALTAIR_DNT900::serviceProtocolTx.
+    uint16_t serviceProtocolTx() {
+        _protocol.expire(txMillis());
+        uint16_t    written = 0;
+        const byte* bytes;
+        uint8_t     pending;
+        while ((pending = _protocol.nextBytes(bytes)) > 0) {
+            if (!clearToSend()) {
+                ++_txQueue.stats()->ctsBlockedCount;
+                break;
+            }
+            int space = uartWriteSpace();
+            if (space <= 0) break;
+            if (pending > space) pending = space;
+            pending = uartWrite(bytes, pending);
+            if (pending == 0) break;
+            _protocol.wrote(pending, txMillis());
+            written += pending;
+        }
+        _txQueue.stats()->bytesSent += written;
+        return written;
+    }
+
+// A millisecond: the UART drains to the radio, and the scheduler's task runs when due.
+    void tick() {
+        ++now;
+        drained += UART_BYTES_PER_MILLI;
+        while (drained >= 1. && !txBuffer.empty()) {
+            radio.push_back(txBuffer.front());
+            txBuffer.pop_front();
+            drained -= 1.;
+        }
+        if (txBuffer.empty()) drained = 0.;
+        if (now % DNT900_TX_SERVICE_INTERVAL == 0) serviceTx();
+    }
+
+// A TxDataReply (acknowledging the oldest packet awaiting one), from the radio.
+    void ack() {
+        const byte reply[] = { DNT_START_OF_PACKET, 6, DNT_TX_DATA_REPLY, DNT_TX_STATUS_ACK, 0, 0, 0, (byte) -60 };
+        for (size_t i = 0; i < sizeof(reply); ++i) _protocol.feed(reply[i], now);
+    }
+};
+
+/**************************************************************************/
+/*!
+    A frame: its length, a count, and then filler, all of which depend
+    upon its id (so that a frame cut short, or out of order, shows).
+*/
+/**************************************************************************/
+static Bytes makeFrame( uint16_t length , long id ) {
+    Bytes frame(length);
+    for (uint16_t i = 0; i < length; ++i) frame[i] = (byte) (id * 31 + i * 7 + (i == 0 ? length : 0));
+    return frame;
+}
+
+/**************************************************************************/
+/*!
+    Run the flight's load (a fan-out cycle of frames every
+    RADIO_POLL_INTERVAL) until the given time, noting the frames that were
+    accepted.
+*/
+/**************************************************************************/
+static void runLoad( Dnt& dnt , unsigned long until , long& id , Bytes& accepted , unsigned long* rejected = NULL ) {
+    static const uint16_t lengths[] = FRAME_LENGTHS;
+    while (dnt.now < until) {
+        if (dnt.now % RADIO_POLL_INTERVAL == 0) {
+            for (size_t f = 0; f < sizeof(lengths) / sizeof(lengths[0]); ++f) {
+                Bytes frame = makeFrame(lengths[f], id++);
+                if (dnt.enqueue(&frame[0], frame.size())) accepted.insert(accepted.end(), frame.begin(), frame.end());
+                else if (rejected)                        ++*rejected;
+            }
+        }
+        dnt.tick();
+    }
+}
+
+/**************************************************************************/
+/*!
+    The data in the TxData packets that the radio received.
+*/
+/**************************************************************************/
+static Bytes txDataReceived( const Bytes& uart , unsigned long* packets ) {
+    Bytes  data;
+    size_t i = 0;
+    *packets = 0;
+    while (i + 2 < uart.size() && uart[i] == DNT_START_OF_PACKET && uart[i + 2] == DNT_TX_DATA) {
+        size_t length = uart[i + 1] + 2;
+        if (i + length > uart.size()) break;
+        data.insert(data.end(), uart.begin() + i + DNT_TX_DATA_OVERHEAD, uart.begin() + i + length);
+        i += length;
+        ++*packets;
+    }
+    return (i == uart.size()) ? data : Bytes();
+}
+
+/**************************************************************************/
+/*!
+    Transparent mode.
+*/
+/**************************************************************************/
+static void testTransparent( ) {
+    printf("Transparent mode, with the flight's load and CTS low\n");
+    {
+        Dnt   dnt(false);
+        Bytes accepted;
+        long  id = 0;
+        runLoad(dnt, 60000, id, accepted);
+        while (dnt.now < 61000) dnt.tick();
+        const ALTAIR_DNT900TxStats* stats = dnt._txQueue.stats();
+        printf("    %lu frames, %lu bytes; latency mean / max %.1f / %lu ms; queue high-water mark %u / %d bytes\n", stats->framesSent,
+               stats->bytesSent, stats->framesSent ? (double) stats->totalLatency / stats->framesSent : 0., stats->maxLatency,
+               stats->maxQueueDepth, DNT_TX_QUEUE_SIZE);
+        check(dnt.radio == accepted && stats->framesRejected == 0,           "every frame goes out, byte for byte, in order");
+        check(stats->framesSent == stats->framesQueued,                      "... each counted as sent");
+        check(stats->maxLatency <= (SERIAL_BUFFER + 45) / UART_BYTES_PER_MILLI + DNT900_TX_SERVICE_INTERVAL,
+                                                                             "... with no more latency than the UART's buffer (and a frame) takes");
+        check(stats->ctsBlockedCount == 0,                                   "... and no CTS stalls");
+    }
+
+    printf("CTS held high for 2 s\n");
+    {
+        Dnt           dnt(false);
+        Bytes         accepted;
+        long          id       = 0;
+        unsigned long rejected = 0;
+        runLoad(dnt, 10000, id, accepted);
+        dnt.ctsHigh = true;
+        unsigned long blockedBefore = dnt.blockedCalls;
+        unsigned long ctsBefore     = dnt._txQueue.stats()->ctsBlockedCount;
+        runLoad(dnt, 12000, id, accepted, &rejected);
+        const ALTAIR_DNT900TxStats* stats = dnt._txQueue.stats();
+        printf("    %lu frames rejected; %lu serviceTx calls blocked; queue %u bytes (high-water mark %u)\n", rejected,
+               stats->ctsBlockedCount - ctsBefore, dnt._txQueue.depth(), stats->maxQueueDepth);
+        check(dnt.bytesWrittenWhileHigh == 0,                                "nothing is written to the UART while CTS is high");
+        check(stats->ctsBlockedCount - ctsBefore == dnt.blockedCalls - blockedBefore && dnt.blockedCalls > blockedBefore,
+                                                                             "each serviceTx that finds data waiting is counted as blocked");
+        check(rejected > 0 && stats->framesRejected == rejected,             "the frames that do not fit are rejected, and counted");
+        check(stats->maxQueueDepth <= DNT_TX_QUEUE_SIZE && dnt._txQueue.room() < 45,
+                                                                             "... once the queue is (all but) full");
+        dnt.ctsHigh = false;
+        unsigned long released = dnt.now;
+        while (dnt._txQueue.depth() > 0 && dnt.now < released + 1000) dnt.tick();
+        unsigned long drainMillis = dnt.now - released;
+        runLoad(dnt, 20000, id, accepted);
+        while (dnt.now < 21000) dnt.tick();
+        printf("    drained in %lu ms once CTS was low; latency max %lu ms\n", drainMillis, stats->maxLatency);
+        check(drainMillis <= DNT_TX_QUEUE_SIZE / UART_BYTES_PER_MILLI + 2 * DNT900_TX_SERVICE_INTERVAL,
+                                                                             "the queue drains as fast as the UART goes, once CTS is low");
+        check(dnt.radio == accepted,                                         "the radio gets exactly the frames accepted, whole, in order");
+        check(stats->maxLatency >= 2000 - RADIO_POLL_INTERVAL,               "the latency of the frames held up is noted");
+        check(stats->framesSent == stats->framesQueued && dnt._txQueue.depth() == 0,
+                                                                             "... and every frame accepted was sent");
+    }
+
+    printf("The UART's buffer full for 1 s\n");
+    {
+        Dnt           dnt(false);
+        Bytes         accepted;
+        long          id       = 0;
+        unsigned long rejected = 0;
+        runLoad(dnt, 5000, id, accepted);
+        dnt.uartStuck = true;
+        runLoad(dnt, 6000, id, accepted, &rejected);
+        dnt.uartStuck = false;
+        runLoad(dnt, 10000, id, accepted);
+        while (dnt.now < 11000) dnt.tick();
+        check(rejected > 0 && dnt._txQueue.stats()->ctsBlockedCount == 0,   "frames are rejected whole, and not counted as CTS stalls");
+        check(dnt.radio == accepted,                                         "... and the radio gets exactly the frames accepted");
+    }
+
+    printf("Many small sends\n");
+    {
+        Dnt   dnt(false);
+        Bytes sent;
+        dnt.ctsHigh = true;
+        for (int i = 0; i < 3 * DNT_TX_MAX_FRAMES; ++i) {
+            byte b = (byte) ('a' + i % 26);
+            dnt.enqueue(&b, 1);
+            sent.push_back(b);
+        }
+        dnt.ctsHigh = false;
+        while (dnt.now < 1000) dnt.tick();
+        const ALTAIR_DNT900TxStats* stats = dnt._txQueue.stats();
+        check(dnt.radio == sent && stats->framesQueued == 3 * DNT_TX_MAX_FRAMES,
+                                                                             "single-byte sends all go out, in order");
+        check(stats->framesSent == DNT_TX_MAX_FRAMES,                        "... those beyond DNT_TX_MAX_FRAMES coalesced into the newest frame");
+    }
+}
+
+/**************************************************************************/
+/*!
+    Protocol mode.
+*/
+/**************************************************************************/
+static void testProtocol( ) {
+    printf("Protocol mode: fits() against append()\n");
+    {
+        std::mt19937  random(17102026);
+        Dnt           dnt(true);
+        unsigned long trials = 0, disagreements = 0, fitted = 0;
+        for (int step = 0; step < 200000; ++step) {
+            uint16_t length = 1 + random() % (3 * DNT_PROTOCOL_MAX_DATA + 40);
+            ALTAIR_DNT900Protocol copy  = dnt._protocol;
+            bool                  takes = true;
+            Bytes                 frame = makeFrame(length, step);
+            for (uint16_t offset = 0; offset < length && takes; offset += DNT_PROTOCOL_MAX_DATA) {
+                uint16_t piece = (length - offset > DNT_PROTOCOL_MAX_DATA) ? DNT_PROTOCOL_MAX_DATA : length - offset;
+                takes = copy.append(&frame[offset], piece);
+            }
+            ++trials;
+            if (dnt._protocol.fits(length) != takes) ++disagreements;
+            if (takes) ++fitted;
+
+            switch (random() % 4) {                                        // (and then move the packets on, at random)
+            case 0:  if (length <= 60) dnt.enqueue(&frame[0], length);  break;
+            case 1:  dnt.serviceTx();  break;
+            case 2:  dnt.ack();        break;
+            default: dnt.tick();       break;
+            }
+        }
+        printf("    %lu states, of which %lu fit\n", trials, fitted);
+        check(disagreements == 0 && fitted > 0 && fitted < trials,          "fits() says exactly whether append() takes every piece of a frame");
+    }
+
+    printf("Protocol mode: frames longer than a packet, with CTS high\n");
+    {
+        Dnt           dnt(true);
+        Bytes         accepted;
+        unsigned long partial = 0, leaked = 0;
+        long          id      = 0;
+        dnt.ctsHigh = true;
+        for (int i = 0; i < 6; ++i) {
+            Bytes                 frame = makeFrame(200, id++);
+            ALTAIR_DNT900Protocol before = dnt._protocol;                   // (what appending piece by piece, as before, would have queued)
+            for (uint16_t offset = 0; offset < frame.size() && before.append(&frame[offset], (frame.size() - offset > DNT_PROTOCOL_MAX_DATA) ?
+                                                                                 DNT_PROTOCOL_MAX_DATA : frame.size() - offset); offset += DNT_PROTOCOL_MAX_DATA) {}
+            unsigned long dataBefore = dnt._protocol.stats()->dataBytesSent;
+            if (dnt.enqueue(&frame[0], frame.size())) accepted.insert(accepted.end(), frame.begin(), frame.end());
+            else {
+                unsigned long wouldHave = before.stats()->dataBytesSent - dataBefore;
+                if (wouldHave > 0 && wouldHave < frame.size()) partial += wouldHave;
+                leaked += dnt._protocol.stats()->dataBytesSent - dataBefore;
+            }
+            while (dnt.now % RADIO_POLL_INTERVAL != 0) dnt.tick();
+            dnt.tick();
+        }
+        const ALTAIR_DNT900TxStats* stats = dnt._txQueue.stats();
+        printf("    %lu of 6 accepted (piece by piece, %lu bytes of those rejected would have been queued)\n", stats->framesQueued, partial);
+        check(stats->framesRejected > 0 && leaked == 0 && dnt._protocol.stats()->dataBytesSent == accepted.size(),
+                                                                             "a frame that does not fit is rejected whole: none of it is queued");
+        check(partial > 0,                                                   "... where piece by piece, as before, part of it would have been");
+        check(dnt.bytesWrittenWhileHigh == 0 && stats->ctsBlockedCount == dnt.blockedCalls && dnt.blockedCalls > 0,
+                                                                             "nothing is written to the UART while CTS is high (and that is counted)");
+        dnt.ctsHigh = false;
+        const byte* pending;
+        for (int i = 0; i < 2000; ++i) {
+            dnt.tick();
+            if (dnt.txBuffer.empty() && dnt._protocol.nextBytes(pending) == 0 && !dnt._protocol.idle()) dnt.ack();   // (once it is all out)
+        }
+        unsigned long packets;
+        check(txDataReceived(dnt.radio, &packets) == accepted && dnt._protocol.idle(),
+                                                                             "once CTS is low, the radio gets exactly the frames accepted, whole");
+    }
+}
+
+int main( )
+{
+    testTransparent();
+    testProtocol();
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRDataLoggerBench.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) test and
+    benchmark of the ring-buffered data logger (ALTAIR_DataLogger, the very
+    same code that logs the flight records to the microSD card), with
+    ALTAIR_HostFileLogSink (i.e. a regular file) in place of the card.
+
+    It checks:
+
+      - that every record logged (and serviced out, sector by sector, as
+        the main loop does) is in the file, in order and intact, once the
+        log is flushed, and that the file is a whole number of sectors;
+      - that a flush writes out the last, partial sector (so that a
+        periodic flush bounds what a power loss can cost);
+      - that a record that does not fit into the ring is dropped whole,
+        and counted;
+      - that failed sector writes are counted as errors, and kept out of
+        the mean sector write time (which is over the sectors written).
+
+    It reports the logger's throughput on the host (records and bytes per
+    second, with the sector write and sync times of the file), and the
+    ring's headroom at the flight's logging rate.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_Devices -o ALTAIRDataLoggerBench ALTAIRDataLoggerBench.cpp ../libraries/ALTAIR_Devices/ALTAIR_DataLogger.cpp
+
+    To use:
+
+      ALTAIRDataLoggerBench [log file (default /tmp/ALTAIRDataLoggerBench.bin)] [# of records]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_DataLogger.h"
+
+typedef  ALTAIR_FlightRecord  FR;
+
+#define  DEFAULT_LOG_FILE      "/tmp/ALTAIRDataLoggerBench.bin"
+#define  DEFAULT_NUM_RECORDS   200000
+#define  FLIGHT_RECORDS_PER_S       1.0     // (storeDataOnMicroSDCard, in ALTAIROperation.ino)
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+// The host's clocks (for the benchmark), and simulated ones (for the checks).
+static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+static unsigned long hostMillis( ) { return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(); }
+static unsigned long hostMicros( ) { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(); }
+static unsigned long simMillis = 0, simMicros = 0;
+static unsigned long simMillisClock( ) { return simMillis; }
+static unsigned long simMicrosClock( ) { return simMicros; }
+
+typedef std::vector<uint8_t>  Bytes;
+
+/**************************************************************************/
+/*!
+    A flight record, with its version, its millis(), and random data.
+*/
+/**************************************************************************/
+static Bytes makeRecord( std::mt19937& random , unsigned long n ) {
+    Bytes record(FR::length);
+    for (size_t i = 0; i < record.size(); ++i) record[i] = (uint8_t) random();
+    FR::version  ::put(&record[0], FLIGHT_RECORD_VERSION);
+    FR::cpuMillis::put(&record[0], n);
+    return record;
+}
+
+/**************************************************************************/
+/*!
+    Read a log file back: each record is a sync byte, a type, a length and
+    a payload, and anything else (i.e. padding) is skipped.
+*/
+/**************************************************************************/
+static std::vector<Bytes> readBack( const char* path , long* fileSize ) {
+    std::vector<Bytes> records;
+    FILE*              file = fopen(path, "rb");
+    Bytes              data;
+    int                c;
+    while (file && (c = fgetc(file)) != EOF) data.push_back((uint8_t) c);
+    if (file) fclose(file);
+    *fileSize = data.size();
+    for (size_t i = 0; i + LOG_RECORD_HEADER_LENGTH <= data.size(); ) {
+        size_t length = data[i + 2];
+        if (data[i] != LOG_RECORD_SYNC_BYTE || data[i + 1] != LOG_RECORD_FLIGHT || i + LOG_RECORD_HEADER_LENGTH + length > data.size()) { ++i;  continue; }
+        records.push_back(Bytes(data.begin() + i + LOG_RECORD_HEADER_LENGTH, data.begin() + i + LOG_RECORD_HEADER_LENGTH + length));
+        i += LOG_RECORD_HEADER_LENGTH + length;
+    }
+    return records;
+}
+
+/**************************************************************************/
+/*!
+    A sink that fails every so often, and takes (simulated) time to write.
+*/
+/**************************************************************************/
+class FlakySink : public ALTAIR_LogSink {
+  public:
+    FlakySink( ) : writes(0) {}
+    virtual bool writeSector( const uint8_t* ) {
+        bool fails = (++writes % 4 == 0);
+        simMicros += fails ? 50000 : 1000;                   // (a failure, e.g. a timeout, is slow)
+        return !fails;
+    }
+    virtual bool sync(   ) { simMicros += 5000;  return true; }
+    virtual bool isOpen( ) { return true; }
+    unsigned long writes;
+};
+
+int main( int argc , char** argv )
+{
+    const char*   path       = (argc > 1) ? argv[1] : DEFAULT_LOG_FILE;
+    long          numRecords = (argc > 2) ? atol(argv[2]) : DEFAULT_NUM_RECORDS;
+    std::mt19937  random(17102026);
+
+// Every record, in order and intact.
+    printf("Logging %ld flight records (%d bytes each) to %s\n", numRecords, (int) FR::length, path);
+    std::vector<Bytes> logged;
+    double             seconds;
+    {
+        ALTAIR_HostFileLogSink sink(path);
+        ALTAIR_DataLogger      logger(hostMillis, hostMicros);
+        logger.setSink(&sink);
+        check(sink.isOpen(),                                                 "the log file is open");
+        for (long n = 0; n < numRecords; ++n) logged.push_back(makeRecord(random, n));
+        auto begin = std::chrono::steady_clock::now();
+        for (long n = 0; n < numRecords; ++n) {
+            while (!logger.logRecord(LOG_RECORD_FLIGHT, &logged[n][0], FR::length)) logger.service();   // (as fast as the ring drains)
+            logger.service();
+        }
+        logger.flush();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        const ALTAIR_LogStats* stats   = logger.stats();
+        unsigned long          sectors = stats->bytesWritten / LOG_SECTOR_SIZE;
+        printf("    %.0f records/s, %.1f MB/s; sector write mean / max %.1f / %lu us; %lu syncs, max %lu us; ring high-water mark %u / %d\n",
+               numRecords / seconds, stats->bytesWritten / seconds / 1048576., sectors ? (double) stats->totalFlushMicros / sectors : 0.,
+               stats->maxFlushMicros, stats->syncCount, stats->maxSyncMicros, stats->maxRingFill, LOG_RING_SIZE);
+        printf("    (the flight logs %.0f record/s: %.0f times less than that; the ring holds %d records, i.e. %.0f s with no writes at all)\n",
+               FLIGHT_RECORDS_PER_S, numRecords / seconds / FLIGHT_RECORDS_PER_S,
+               LOG_RING_SIZE / (LOG_RECORD_HEADER_LENGTH + FR::length), LOG_RING_SIZE / (LOG_RECORD_HEADER_LENGTH + FR::length) / FLIGHT_RECORDS_PER_S);
+        check(stats->recordsLogged == (unsigned long) numRecords && stats->droppedRecords == 0 && stats->writeErrors == 0,
+                                                                             "every record is logged, with no drops or errors");
+        check(logger.bytesQueued() == 0,                                     "after the flush, nothing is left in the ring");
+    }
+    long               fileSize;
+    std::vector<Bytes> read = readBack(path, &fileSize);
+    bool               same = (read.size() == logged.size());
+    for (size_t i = 0; same && i < read.size(); ++i) same = (read[i] == logged[i]);
+    check(same,                                                              "every record is in the file, in order and intact");
+    check(fileSize % LOG_SECTOR_SIZE == 0,                                   "the file is a whole number of sectors");
+
+// A flush writes out the last, partial sector.
+    printf("Flushing\n");
+    {
+        ALTAIR_HostFileLogSink sink(path);
+        ALTAIR_DataLogger      logger(simMillisClock, simMicrosClock);
+        logger.setSink(&sink);
+        int perSector = LOG_SECTOR_SIZE / (LOG_RECORD_HEADER_LENGTH + FR::length);
+        for (int n = 0; n < perSector; ++n) logger.logRecord(LOG_RECORD_FLIGHT, &logged[n][0], FR::length);
+        logger.service();
+        sink.sync();
+        check(readBack(path, &fileSize).size() == 0,                         "a partial sector is not written by service()");
+        logger.flush();
+        check(readBack(path, &fileSize).size() == (size_t) perSector && fileSize == LOG_SECTOR_SIZE,
+                                                                             "... but is by flush(), padded out to a whole sector");
+        check(logger.stats()->paddingBytes == (unsigned long) LOG_SECTOR_SIZE - perSector * (LOG_RECORD_HEADER_LENGTH + FR::length),
+                                                                             "... and the padding is counted");
+    }
+
+// A record that does not fit is dropped whole.
+    printf("A full ring\n");
+    {
+        ALTAIR_HostFileLogSink sink(path);
+        ALTAIR_DataLogger      logger(simMillisClock, simMicrosClock);
+        logger.setSink(&sink);
+        int fit = LOG_RING_SIZE / (LOG_RECORD_HEADER_LENGTH + FR::length);
+        for (int n = 0; n < fit + 3; ++n) logger.logRecord(LOG_RECORD_FLIGHT, &logged[n][0], FR::length);
+        check(logger.stats()->recordsLogged == (unsigned long) fit && logger.stats()->droppedRecords == 3,
+                                                                             "records that do not fit into the ring are dropped, and counted");
+        logger.flush();
+        std::vector<Bytes> kept = readBack(path, &fileSize);
+        check(kept.size() == (size_t) fit && kept.back() == logged[fit - 1], "... whole (the file holds only the ones that fit)");
+    }
+
+// Failed writes.
+    printf("Failed sector writes\n");
+    {
+        FlakySink         sink;
+        ALTAIR_DataLogger logger(simMillisClock, simMicrosClock);
+        logger.setSink(&sink);
+        simMillis = simMicros = 0;
+        for (long n = 0; n < 1000; ++n) {
+            logger.logRecord(LOG_RECORD_FLIGHT, &logged[n][0], FR::length);
+            logger.service();
+            simMillis += 1000;
+        }
+        logger.flush();
+        const ALTAIR_LogStats* stats   = logger.stats();
+        unsigned long          sectors = stats->bytesWritten / LOG_SECTOR_SIZE;
+        printf("    %lu sectors attempted, %lu written, %lu errors; sector write mean %.1f us, max %lu us\n", sink.writes, sectors,
+               stats->writeErrors, sectors ? (double) stats->totalFlushMicros / sectors : 0., stats->maxFlushMicros);
+        check(stats->writeErrors == sink.writes / 4 && sectors == sink.writes - sink.writes / 4,
+                                                                             "each failed write is counted as an error, and not as written");
+        check(sectors && stats->totalFlushMicros == 1000 * sectors,          "the mean sector write time is over the sectors written (only)");
+        check(stats->maxFlushMicros == 50000,                                "... while the maximum includes the failed ones");
+    }
+
+    remove(path);
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRDeltaDownlinkSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the keyframe-plus-delta downlink (see ALTAIR_TelemetryDelta.h).  It
+    builds both sendAllALTAIRInfo frames once per second over a simulated
+    flight (ascent, float, motor runs, and sensor noise), sends them as
+    ALTAIR_GenTelInt::sendKeyOrDelta does, and decodes them with the very
+    same ALTAIR_DownlinkDecoder that the ground stations run.  It checks:
+
+      - that every frame is reconstructed exactly, byte for byte;
+      - that, with frames lost on the way down, no frame is ever
+        reconstructed wrongly (the lost ones, and the deltas against lost
+        keyframes, are simply missing);
+      - how many frames get through wrongly with bits flipped on the way
+        down (which is reported, but not checked, since full frames have
+        no check of their own beyond their separators);
+      - the average bytes per frame (including the start and length
+        bytes), for each keyframe interval, against full frames only, and
+        what that is at the SHX144's 1200 baud.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRDeltaDownlinkSim ALTAIRDeltaDownlinkSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_DownlinkDecoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_LinkEncoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandARQ.cpp
+
+    To use:
+
+      ALTAIRDeltaDownlinkSim [seconds of flight]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_DownlinkDecoder.h"
+
+typedef  ALTAIR_AllInfoFrame1  F1;
+typedef  ALTAIR_AllInfoFrame2  F2;
+typedef  std::vector<byte>     Bytes;
+
+#define  SHX144_BAUD_RATE       1200.0          // (10 bits per byte on the wire)
+
+/**************************************************************************/
+/*!
+    The simulated flight: both frames' data, for each second.
+*/
+/**************************************************************************/
+struct Second { byte frame1[F1::length]; byte frame2[F2::length]; };
+
+static std::vector<Second> simulateFlight( long seconds , unsigned seed ) {
+    std::mt19937                     random(seed);
+    std::normal_distribution<double> noise(0., 1.);
+    std::vector<Second>              flight(seconds);
+    double lat = 48.4634, lon = -123.3117, ele = 10., yaw = 0., occSpace = 120.;
+    for (long t = 0; t < seconds; ++t) {
+        byte* d = flight[t].frame1;
+        double climb   = (ele < 25000.) ? 5. : 0.05 * noise(random);          // ascent, and then float
+        ele           += climb;
+        lat           += (3. + noise(random)) * 1e-6 * 9.;                     // ~ 3 m/s north
+        lon           += (10. + noise(random)) * 1e-6 * 13.5;                  // ~ 10 m/s east
+        yaw            = fmod(yaw + 0.5 + 2. * noise(random) + 256., 256.);
+        bool   motors  = (t % 1200) < 60;                                     // a 1-minute motor run every 20 minutes
+        double outTemp = (ele < 11000.) ? 15. - 0.0065 * ele : -56.5 + 0.001 * (ele - 11000.);
+        double outPres = 101325. * exp(-ele / 8000.);
+
+        F1::latitude  ::encode(d, lat);
+        F1::longitude ::encode(d, lon);
+        F1::elevation ::put(   d, (int32_t) ele);
+        F1::age       ::encode(d, (float) (random() % 1000));
+        F1::hdop      ::put(   d, 1 + (random() % 20 == 0));
+        F1::separator1::put(   d);
+        F1::outPres   ::encode(d, outPres);
+        F1::outTemp   ::encode(d, outTemp + 0.3 * noise(random));
+        F1::outHum    ::encode(d, (ele < 11000.) ? 60. - ele / 200. + noise(random) : 2.);
+        F1::inPres    ::encode(d, 101000. + 20. * noise(random));
+        F1::inTemp    ::encode(d, 24. + 0.3 * noise(random));
+        F1::inHum     ::encode(d, 35.);
+        F1::balPres   ::put(   d, 0);                                           // (the balloon valve connector is unconnected)
+        F1::balTemp   ::put(   d, 0);
+        F1::balHum    ::put(   d, 0);
+        F1::accelZ    ::put(   d, (int32_t) (128 + 64 + 2. * noise(random)) & 0xFF);
+        F1::accelX    ::put(   d, (int32_t) (128 + 2. * noise(random)) & 0xFF);
+        F1::accelY    ::put(   d, (int32_t) (128 + 2. * noise(random)) & 0xFF);
+        F1::separator2::put(   d);
+        F1::yaw       ::put(   d, (int32_t) yaw & 0xFF);
+        F1::pitch     ::put(   d, (int32_t) (128 + 3. * noise(random)) & 0xFF);
+        F1::roll      ::put(   d, (int32_t) (128 + 3. * noise(random)) & 0xFF);
+        F1::oSensTemp ::put(   d, 30);
+        F1::typeInfo  ::put(   d, 0x01 + 8 * 0x01);
+        byte rpm[4], current[4];
+        for (int m = 0; m < 4; ++m) {
+            rpm[m]     = motors ? (byte) (80 + 2. * noise(random)) : 0;
+            current[m] = motors ? (byte) (40 + 2. * noise(random)) : (byte) (int8_t) (random() % 3 - 1);
+        }
+        F1::packedRPM ::put(   d, rpm);
+        F1::packedCur ::put(   d, current);
+        F1::separator3::put(   d);
+
+        d = flight[t].frame2;
+        byte temp[8];
+        for (int i = 0; i < 8; ++i) temp[i] = (byte) (int8_t) (2. * (20. + (motors ? 15. : 0.) + 0.3 * noise(random)));
+        occSpace += 0.01;
+        F2::packedTemp::put(   d, temp);
+        F2::rssi      ::put(   d, (int32_t) (-90 + 3. * noise(random)));
+        F2::bat1V     ::encode(d, 12.4 - t * 2e-5 + 0.03 * noise(random));
+        F2::bat2V     ::encode(d, (motors ? 11.8 : 12.3) - t * 3e-5 + 0.03 * noise(random));
+        F2::separator1::put(   d);
+        F2::occSpace  ::put(   d, (int32_t) occSpace);
+        F2::powerMot1 ::encode(d, motors ? 3. : 0.);
+        F2::powerMot2 ::encode(d, motors ? 3. : 0.);
+        F2::powerMot3 ::encode(d, motors ? 3. : 0.);
+        F2::powerMot4 ::encode(d, motors ? 3. : 0.);
+        F2::axlRotSet ::encode(d, 5.);
+        F2::axlRotAng ::encode(d, 2.5 + 0.02 * noise(random));
+        F2::bleedVSet ::encode(d, 0.);
+        F2::bleedVAng ::encode(d, 0.5);
+        F2::cutdwnSet ::encode(d, 0.);
+        F2::cutdwnAng ::encode(d, 0.5);
+        F2::separator2::put(   d);
+        F2::lightStat ::put(   d, 0x11);
+        F2::pd1ADRead ::put(   d, (int32_t) (12000 + 5. * noise(random)));
+        F2::pd2ADRead ::put(   d, (int32_t) (11500 + 5. * noise(random)));
+        F2::pd3ADRead ::put(   d, (int32_t) (300 + 5. * noise(random)));
+        F2::separator3::put(   d);
+    }
+    return flight;
+}
+
+/**************************************************************************/
+/*!
+    The sender: as ALTAIR_GenTelInt::sendKeyOrDelta, with the very same
+    ALTAIR_LinkEncoder (and every send succeeding).
+*/
+/**************************************************************************/
+struct Sender {
+    Sender( uint8_t interval ) { encoder.setKeyframeInterval(interval); }
+
+    Bytes sendKeyOrDelta( uint8_t frameType , const byte* data , uint8_t length ) {
+        byte    out[FRAME_HEADER_LENGTH + MAX_FRAME_DATA_LENGTH];
+        bool    isKey;
+        uint8_t outLength = encoder.encodeFrame(frameType, data, length, out, isKey);
+        encoder.commitFrame(frameType, data, isKey);
+        return Bytes(out, out + outLength);
+    }
+
+    ALTAIR_LinkEncoder encoder;
+};
+
+/**************************************************************************/
+/*!
+    The ground station's output: binary records, checked against the
+    frames that were sent (each record's time being the frame's index).
+*/
+/**************************************************************************/
+class CheckingSink : public ALTAIR_RecordSink {
+  public:
+    CheckingSink( const std::vector<Bytes>& sent ) : records(0), wrong(0), _sent(sent) {}
+    virtual void write( const byte* data , uint16_t length ) {
+        ++records;
+        unsigned long index = ALTAIR_FrameField< LOG_RECORD_HEADER_LENGTH , 4 >::get(data);
+        const byte*   frame = data + LOG_RECORD_HEADER_LENGTH + 4;
+        uint16_t      size  = length - LOG_RECORD_HEADER_LENGTH - 4;
+        if (index >= _sent.size() || size != _sent[index].size() || memcmp(frame, &_sent[index][0], size) != 0) ++wrong;
+    }
+    long records, wrong;
+  private:
+    const std::vector<Bytes>& _sent;
+};
+
+struct Result { double bytesPerFrame; long frames, records, wrong, badDeltas; };
+
+static Result run( const std::vector<Second>& flight , uint8_t interval , double lossChance , double flipChance , std::mt19937& random ) {
+    std::uniform_real_distribution<double> chance(0., 1.);
+    std::vector<Bytes> sent;                                                // (the frames' data, by index)
+    Sender             sender(interval);
+    long               bytes = 0;
+    Bytes              link;
+    std::vector<long>  indexAt;                                             // (the index of the frame that each link byte is part of)
+    for (size_t t = 0; t < flight.size(); ++t) {
+        for (uint8_t type = DELTA_FRAME_TYPE_1; type <= DELTA_FRAME_TYPE_2; ++type) {
+            const byte* data   = (type == DELTA_FRAME_TYPE_1) ? flight[t].frame1 : flight[t].frame2;
+            uint8_t     length = (type == DELTA_FRAME_TYPE_1) ? (uint8_t) F1::length : (uint8_t) F2::length;
+            Bytes       onAir  = sender.sendKeyOrDelta(type, data, length);
+            bytes += onAir.size();
+            sent.push_back(Bytes(data, data + length));
+            if (chance(random) < lossChance) continue;
+            if (chance(random) < flipChance) onAir[random() % onAir.size()] ^= (byte) (1 << (random() % 8));
+            link.insert(link.end(), onAir.begin(), onAir.end());
+            indexAt.insert(indexAt.end(), onAir.size(), (long) sent.size() - 1);
+        }
+    }
+    CheckingSink           sink(sent);
+    ALTAIR_DownlinkDecoder decoder(&sink, DOWNLINK_OUTPUT_BINARY);
+    for (size_t i = 0; i < link.size(); ++i) decoder.feed(link[i], indexAt[i]);
+    Result result;
+    result.frames        = (long) sent.size();
+    result.bytesPerFrame = (double) bytes / sent.size();
+    result.records       = sink.records;
+    result.wrong         = sink.wrong;
+    result.badDeltas     = decoder.stats()->badDeltas;
+    return result;
+}
+
+int main( int argc , char** argv )
+{
+    long         seconds = (argc > 1) ? atol(argv[1]) : 3 * 3600;
+    std::mt19937 random(17102026);
+    bool         ok      = true;
+
+    long fields = 0, width1 = 0, width2 = 0;
+    for (uint8_t f = 0; f < deltaLayout(DELTA_FRAME_TYPE_1)->numFields; ++f) width1 += deltaFrame1Widths[f];
+    for (uint8_t f = 0; f < deltaLayout(DELTA_FRAME_TYPE_2)->numFields; ++f) width2 += deltaFrame2Widths[f];
+    fields = deltaLayout(DELTA_FRAME_TYPE_1)->numFields + deltaLayout(DELTA_FRAME_TYPE_2)->numFields;
+    if (width1 != F1::length || width2 != F2::length) { printf("the field widths do not add up to the frame lengths!\n"); ok = false; }
+
+    std::vector<Second> flight = simulateFlight(seconds, 1);
+    printf("%ld seconds of simulated flight (%ld frames, %ld fields)\n\n", seconds, 2 * seconds, fields);
+    printf("  keyframe interval   bytes/frame   reduction   SHX144 link use   reconstructed   wrong\n");
+    double fullBytes = 0.;
+    const uint8_t intervals[] = { 1, 5, DEFAULT_DELTA_KEYFRAME_INTERVAL, 20, 30 };
+    for (size_t i = 0; i < sizeof(intervals); ++i) {
+        Result r = run(flight, intervals[i], 0., 0., random);
+        if (intervals[i] == 1) fullBytes = r.bytesPerFrame;
+        printf("  %17d   %11.1f   %8.1f%%   %14.1f%%   %13ld   %5ld%s\n", intervals[i], r.bytesPerFrame, 100. * (1. - r.bytesPerFrame / fullBytes),
+               100. * r.bytesPerFrame * 2. * 10. / SHX144_BAUD_RATE, r.records, r.wrong, (intervals[i] == 1) ? "   (full frames only)" : "");
+        if (r.records != r.frames || r.wrong > 0 || r.badDeltas > 0) ok = false;
+    }
+
+    printf("\nwith a lossy link (keyframe interval %d):\n", DEFAULT_DELTA_KEYFRAME_INTERVAL);
+    printf("  frames lost   bits flipped   reconstructed   rejected deltas   wrong\n");
+    const double losses[][2] = { { 0.02, 0. }, { 0.10, 0. }, { 0.02, 0.02 } };
+    for (size_t i = 0; i < sizeof(losses) / sizeof(losses[0]); ++i) {
+        Result r = run(flight, DEFAULT_DELTA_KEYFRAME_INTERVAL, losses[i][0], losses[i][1], random);
+        printf("  %10.0f%%   %11.0f%%   %13ld   %15ld   %5ld\n", 100. * losses[i][0], 100. * losses[i][1], r.records, r.badDeltas, r.wrong);
+        if (r.wrong > 0 && losses[i][1] == 0.) ok = false;
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRDownlinkReplay.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) tool that
+    replays a captured downlink (i.e. the raw bytes received by a ground
+    station's radio) through the very same ALTAIR_DownlinkDecoder that the
+    ground stations run, and benchmarks it.  The decode rate is compared
+    both with the real frame rate (one pair of sendAllALTAIRInfo frames per
+    second), and with the most frames that the radio link could possibly
+    carry (i.e. back-to-back frames at the DNT900's 38400 baud).  It can
+    also synthesize a capture, if there is no real one at hand.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRDownlinkReplay ALTAIRDownlinkReplay.cpp ../libraries/ALTAIR_Devices/ALTAIR_DownlinkDecoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandARQ.cpp
+
+    To use:
+
+      ALTAIRDownlinkReplay synth  <capture file> <seconds of flight>
+      ALTAIRDownlinkReplay replay <capture file> [csv|binary] [repeats] [output file]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "ALTAIR_DownlinkDecoder.h"
+
+typedef  ALTAIR_AllInfoFrame1  F1;
+typedef  ALTAIR_AllInfoFrame2  F2;
+
+#define  REAL_FRAMES_PER_SECOND        2.0          // the primary radio sends both frames once per second
+#define  LINK_BAUD_RATE            38400.0          // the DNT900's serial rate (10 bits per byte on the wire)
+#define  GROUND_USB_BAUD_RATE     250000.0          // the ground station's USB serial rate
+
+/**************************************************************************/
+/*!
+    A sink that counts the bytes of the records (and optionally writes
+    them to a file).
+*/
+/**************************************************************************/
+class CountingSink : public ALTAIR_RecordSink {
+  public:
+    CountingSink( FILE* file ) : bytes(0), records(0), _file(file) {}
+    virtual void write( const byte* data , uint16_t length ) {
+        bytes += length;
+        ++records;
+        if (_file) fwrite(data, 1, length, _file);
+    }
+    unsigned long long  bytes;
+    unsigned long long  records;
+  private:
+    FILE*               _file;
+};
+
+/**************************************************************************/
+/*!
+ @brief  Write a synthetic capture: a pair of frames per simulated second,
+         with plausibly varying values, and a little line noise between
+         some of them.
+*/
+/**************************************************************************/
+static int synthesize( const char* path , long seconds )
+{
+    FILE* file = fopen(path, "wb");
+    if (!file) { perror(path); return 1; }
+    srand(1);
+    byte frame[FRAME_HEADER_LENGTH + MAX_FRAME_DATA_LENGTH];
+    for (long s = 0; s < seconds; ++s) {
+        byte* d = frame + FRAME_HEADER_LENGTH;
+        memset(frame, 0, sizeof(frame));
+        frame[0] = FRAME_START_BYTE;
+        frame[1] = F1::length;
+        F1::latitude ::encode(d,  48.463 + 0.00001 * s);
+        F1::longitude::encode(d, -123.312 - 0.00002 * s);
+        F1::elevation::put(d, 20 + s / 2);
+        F1::age      ::put(d, rand() % 4);
+        F1::hdop     ::put(d, 1 + rand() % 3);
+        F1::separator1::put(d);
+        F1::outPres  ::encode(d, 101325.0 - 5.0 * s);
+        F1::outTemp  ::put(d, 15 - s / 300);
+        F1::outHum   ::put(d, 40 + rand() % 5);
+        F1::inPres   ::encode(d, 101325.0 - 5.0 * s);
+        F1::inTemp   ::put(d, 25);
+        F1::inHum    ::put(d, 30);
+        F1::balPres  ::encode(d, 101400.0 - 5.0 * s);
+        F1::balTemp  ::put(d, 10 - s / 300);
+        F1::balHum   ::put(d, 20);
+        F1::accelZ   ::put(d, 128 + rand() % 8);
+        F1::accelX   ::put(d, 128 + rand() % 8);
+        F1::accelY   ::put(d, 128 + rand() % 8);
+        F1::separator2::put(d);
+        F1::yaw      ::put(d, s % 256);
+        F1::pitch    ::put(d, 128);
+        F1::roll     ::put(d, 128);
+        F1::oSensTemp::put(d, 22);
+        F1::typeInfo ::put(d, 0x21);
+        for (int i = 0; i < 4; ++i) { d[F1::packedRPM::offset + i] = 50 + rand() % 10; d[F1::packedCur::offset + i] = 8 + rand() % 4; }
+        F1::separator3::put(d);
+        fwrite(frame, 1, FRAME_HEADER_LENGTH + F1::length, file);
+
+        memset(frame, 0, sizeof(frame));
+        frame[0] = FRAME_START_BYTE;
+        frame[1] = F2::length;
+        for (int i = 0; i < 8; ++i) d[F2::packedTemp::offset + i] = 40 + rand() % 10;
+        F2::rssi     ::put(d, -60 - rand() % 30);
+        F2::bat1V    ::encode(d, 12.6 - 0.0001 * s);
+        F2::bat2V    ::encode(d, 12.5 - 0.0001 * s);
+        F2::separator1::put(d);
+        F2::occSpace ::put(d, s / 10);
+        F2::powerMot1::encode(d, 0.5);
+        F2::powerMot2::encode(d, 0.5);
+        F2::powerMot3::encode(d, 0.5);
+        F2::powerMot4::encode(d, 0.5);
+        F2::axlRotSet::encode(d, 0.2);
+        F2::axlRotAng::encode(d, 1.5);
+        F2::bleedVSet::encode(d, 0.0);
+        F2::bleedVAng::encode(d, 0.7);
+        F2::cutdwnSet::encode(d, 0.0);
+        F2::cutdwnAng::encode(d, 0.7);
+        F2::separator2::put(d);
+        F2::lightStat::put(d, s % 4);
+        F2::pd1ADRead::put(d, rand() % 1024);
+        F2::pd2ADRead::put(d, rand() % 1024);
+        F2::pd3ADRead::put(d, rand() % 1024);
+        F2::separator3::put(d);
+        fwrite(frame, 1, FRAME_HEADER_LENGTH + F2::length, file);
+
+        if (s % 10 == 0) fputs(" OVER ", file);                               // noise that the decoder must skip
+    }
+    fclose(file);
+    printf("wrote %ld seconds (%ld frames) of synthetic downlink to %s\n", seconds, 2 * seconds, path);
+    return 0;
+}
+
+/**************************************************************************/
+/*!
+ @brief  Replay a capture through the decoder (repeats times over), and
+         report the decode rate.
+*/
+/**************************************************************************/
+static int replay( const char* path , uint8_t format , long repeats , const char* outPath )
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) { perror(path); return 1; }
+    std::vector<byte> capture;
+    byte   chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) capture.insert(capture.end(), chunk, chunk + n);
+    fclose(file);
+
+    FILE* out = NULL;
+    if (outPath && !(out = fopen(outPath, "wb"))) { perror(outPath); return 1; }
+    CountingSink           sink(out);
+    ALTAIR_DownlinkDecoder decoder(&sink, format);
+    decoder.writeCsvHeader();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long r = 0; r < repeats; ++r) {
+        unsigned long receivedMillis = 0;
+        for (size_t i = 0; i < capture.size(); i += 64) {                        // (a serial receive buffer's worth at a time)
+            size_t length = std::min((size_t) 64, capture.size() - i);
+            decoder.feed(&capture[i], (uint16_t) length, receivedMillis);
+            receivedMillis += 17;                                               // (64 bytes at 38400 baud)
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (out) fclose(out);
+
+    const ALTAIR_DownlinkStats* stats = decoder.stats();
+    double frames          = (double) (stats->frame1Count + stats->frame2Count);
+    double framesPerSecond = frames / elapsed;
+    double bytesPerFrame   = (2.0 * FRAME_HEADER_LENGTH + F1::length + F2::length) / 2.0;
+    double linkFrameRate   = (LINK_BAUD_RATE / 10.0) / bytesPerFrame;
+    double recordBytesPerFrame = frames ? sink.bytes / frames : 0;
+    printf("capture: %zu bytes, replayed %ld times\n", capture.size(), repeats);
+    printf("frames: %lu + %lu, bad frames: %lu, skipped bytes: %lu\n",
+           stats->frame1Count, stats->frame2Count, stats->badFrames, stats->skippedBytes);
+    printf("records: %llu, %llu bytes (%.1f bytes per frame)\n", sink.records, sink.bytes, recordBytesPerFrame);
+    printf("decode time: %.3f s, %.0f frames/s\n", elapsed, framesPerSecond);
+    printf("   = %.0fx the real frame rate (%.0f frames/s)\n", framesPerSecond / REAL_FRAMES_PER_SECOND, REAL_FRAMES_PER_SECOND);
+    printf("   = %.0fx the link's back-to-back frame rate (%.1f frames/s)\n", framesPerSecond / linkFrameRate, linkFrameRate);
+    printf("output at the link's back-to-back frame rate: %.0f bytes/s (of %.0f at the USB serial rate)\n",
+           linkFrameRate * recordBytesPerFrame, GROUND_USB_BAUD_RATE / 10.0);
+    return 0;
+}
+
+int main( int argc , char** argv )
+{
+    if (argc >= 4 && strcmp(argv[1], "synth") == 0) return synthesize(argv[2], atol(argv[3]));
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        uint8_t format  = (argc >= 4 && strcmp(argv[3], "binary") == 0) ? DOWNLINK_OUTPUT_BINARY : DOWNLINK_OUTPUT_CSV;
+        long    repeats = (argc >= 5) ? atol(argv[4]) : 1;
+        return replay(argv[2], format, repeats > 0 ? repeats : 1, (argc >= 6) ? argv[5] : NULL);
+    }
+    fprintf(stderr, "usage: %s synth <capture file> <seconds>\n"
+                    "       %s replay <capture file> [csv|binary] [repeats] [output file]\n", argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,253 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRFailoverSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the automatic failover of the primary telemetry radio (see
+    ALTAIR_TelemetrySystem::updateLinkQuality), with the very same
+    ALTAIR_LinkQuality tracker and failover policy as in the flight code.
+
+    Each radio's uplink is modelled as a fading link: its mean RSSI (per
+    scenario), plus slow shadowing (a random walk that relaxes back to
+    the mean, with a correlation time of a few seconds), plus fast fading
+    on each message.  A message gets through with a probability that
+    rises smoothly through the radio's sensitivity.  Each link's ground
+    station sends a heartbeat every GROUND_HEARTBEAT_INTERVAL (as the
+    ground stations do when they have no command to send), and each one
+    that gets through is reported to the tracker (as the command router
+    does), along with its RSSI (as the radios note it, and as
+    updateLinkQuality then feeds it to the tracker, every
+    LINK_QUALITY_INTERVAL).
+
+    Each scenario is run with many random seeds.  It reports:
+
+      - with the DNT900 going into a deep fade: the time to recovery
+        (from the start of the fade until the primary radio is switched
+        to a backup), and the time to return to the DNT900 once its link
+        has recovered;
+      - with short dropouts of the DNT900: that none of them makes the
+        primary radio switch;
+      - with the DNT900's link marginal (wandering about its sensitivity):
+        the # of switches per hour, and that there is no flapping;
+
+    and that no switch is ever made while every link is good.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRFailoverSim ALTAIRFailoverSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_LinkQuality.cpp
+
+    To use:
+
+      ALTAIRFailoverSim [# of seeds per scenario]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_LinkQuality.h"
+
+// As in ALTAIR_TelemetrySystem.cpp, ALTAIROperation.ino, and CapellaGroundStationOperation.ino.
+#define  NUM_RADIOS                   3
+#define  LINK_QUALITY_INTERVAL     1000            // = linkQualityInterval in ALTAIROperation.ino
+#define  GROUND_HEARTBEAT_INTERVAL 2000
+#define  STEP_MILLIS                 50
+#define  SHADOWING_SIGMA            4.0            // in dB
+#define  SHADOWING_MILLIS          5000            // its correlation time
+#define  FAST_FADING_SIGMA          2.5            // in dB, per message
+#define  DELIVERY_WIDTH             1.5            // in dB: how sharply the delivery probability rises through the sensitivity
+
+static const char*  radioNames[NUM_RADIOS]            = { "DNT900", "SHX144", "RFM23BP" };
+static const int8_t linkQualityConfigs[NUM_RADIOS][2] = { { -108 , -78 }, { -118 , -88 }, { -116 , -86 } };
+
+/**************************************************************************/
+/*!
+    A scenario: each link's mean RSSI (in dBm) at each moment.
+*/
+/**************************************************************************/
+struct Scenario {
+    const char*   name;
+    unsigned long seconds;
+    double      (*meanRSSI)( int radio , unsigned long now );
+};
+
+static const double nominalRSSI[NUM_RADIOS] = { -86. , -97. , -98. };
+
+#define  FADE_START   300000UL
+#define  FADE_END     900000UL
+
+static double deepFade( int radio , unsigned long now ) {
+    if (radio == 0 && now >= FADE_START && now < FADE_END) return -125.;
+    return nominalRSSI[radio];
+}
+static double shortDropouts( int radio , unsigned long now ) {
+    if (radio == 0 && now % 120000UL < 3000UL) return -130.;               // a 3-second dropout every 2 minutes
+    return nominalRSSI[radio];
+}
+static double marginal( int radio , unsigned long now ) {
+    if (radio == 0) return -100. + 9. * sin(2. * M_PI * now / 240000.);    // down to about the DNT900's sensitivity, and back, every 4 minutes
+    return nominalRSSI[radio];
+}
+static double allGood( int radio , unsigned long ) {
+    return nominalRSSI[radio];
+}
+
+/**************************************************************************/
+/*!
+    The outcome of one run: when the primary radio was switched, and to
+    which radio.
+*/
+/**************************************************************************/
+struct Switch { unsigned long millis; int to; };
+
+static std::vector<Switch> simulate( const Scenario& scenario , unsigned seed ) {
+    std::mt19937                           random(seed);
+    std::normal_distribution<double>       noise(0., 1.);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+
+    ALTAIR_LinkQuality linkQuality;
+    for (int r = 0; r < NUM_RADIOS; ++r) {
+        linkQuality.configure(   r, linkQualityConfigs[r][0], linkQualityConfigs[r][1]);
+        linkQuality.setListening(r, true);
+    }
+    double        shadowing[NUM_RADIOS]      = { 0., 0., 0. };
+    unsigned long heartbeatPhase[NUM_RADIOS];                               // (the ground stations are not in step)
+    int8_t        lastRSSI[NUM_RADIOS];                                     // as the radios note it
+    unsigned long lastRSSIMillis[NUM_RADIOS] = { 0, 0, 0 };
+    unsigned long fedRSSIMillis[NUM_RADIOS]  = { 0, 0, 0 };                 // as updateLinkQuality feeds it
+    for (int r = 0; r < NUM_RADIOS; ++r) heartbeatPhase[r] = (unsigned long) (uniform(random) * GROUND_HEARTBEAT_INTERVAL) / STEP_MILLIS * STEP_MILLIS;
+
+    std::vector<Switch> switches;
+    int                 primary = 0;
+    const double        relax   = (double) STEP_MILLIS / SHADOWING_MILLIS;
+    for (unsigned long now = STEP_MILLIS; now <= scenario.seconds * 1000UL; now += STEP_MILLIS) {
+        for (int r = 0; r < NUM_RADIOS; ++r) {
+            shadowing[r] += -relax * shadowing[r] + SHADOWING_SIGMA * sqrt(2. * relax) * noise(random);
+            if (now % GROUND_HEARTBEAT_INTERVAL != heartbeatPhase[r]) continue;
+            double rssi = scenario.meanRSSI(r, now) + shadowing[r] + FAST_FADING_SIGMA * noise(random);
+            if (uniform(random) >= 1. / (1. + exp(-(rssi - linkQualityConfigs[r][0]) / DELIVERY_WIDTH))) continue;
+            linkQuality.commandHeard(r, now);                               // (as ALTAIR_CommandRouter::gather)
+            lastRSSI[r]       = (int8_t) std::max(-128., std::min(0., floor(rssi + 0.5)));
+            lastRSSIMillis[r] = now;
+        }
+        if (now % LINK_QUALITY_INTERVAL != 0) continue;
+
+// As ALTAIR_TelemetrySystem::updateLinkQuality.
+        for (int r = 0; r < NUM_RADIOS; ++r) {
+            if (lastRSSIMillis[r] == fedRSSIMillis[r]) continue;
+            linkQuality.rssiHeard(r, lastRSSI[r], lastRSSIMillis[r]);
+            fedRSSIMillis[r] = lastRSSIMillis[r];
+        }
+        linkQuality.update(now);
+        int8_t target = linkQuality.choosePrimary(primary, now);
+        if (target < 0) continue;
+        primary = target;
+        linkQuality.primaryChanged(now);
+        Switch aSwitch = { now, target };
+        switches.push_back(aSwitch);
+    }
+    return switches;
+}
+
+/**************************************************************************/
+/*!
+    Summaries, over all of the seeds.
+*/
+/**************************************************************************/
+static void printTimes( const char* what , std::vector<double> seconds ) {
+    if (seconds.empty()) { printf("  %s: never\n", what); return; }
+    std::sort(seconds.begin(), seconds.end());
+    double total = 0.;
+    for (size_t i = 0; i < seconds.size(); ++i) total += seconds[i];
+    printf("  %s (s): mean %.1f, median %.1f, 95th percentile %.1f, max %.1f\n", what,
+           total / seconds.size(), seconds[seconds.size() / 2], seconds[seconds.size() * 95 / 100], seconds.back());
+}
+
+static unsigned long shortestDwell( const std::vector<Switch>& switches ) {
+    unsigned long shortest = ~0UL;
+    for (size_t i = 1; i < switches.size(); ++i) shortest = std::min(shortest, switches[i].millis - switches[i - 1].millis);
+    return shortest;
+}
+
+int main( int argc , char** argv )
+{
+    int  seeds = (argc > 1) ? atoi(argv[1]) : 200;
+    bool ok    = true;
+    printf("%d seeds per scenario; heartbeats every %d ms on each link, and the link quality updated every %d ms\n\n",
+           seeds, GROUND_HEARTBEAT_INTERVAL, LINK_QUALITY_INTERVAL);
+
+// A deep fade of the DNT900, from 5 to 15 minutes in: the time to recovery, and the time to return.
+    {
+        Scenario            scenario = { "the DNT900 in a deep fade for 10 minutes", 1500, deepFade };
+        std::vector<double> recovery, back;
+        long                missed = 0, early = 0, notBack = 0, extra = 0;
+        for (int s = 0; s < seeds; ++s) {
+            std::vector<Switch> switches = simulate(scenario, s + 1);
+            size_t i = 0;
+            while (i < switches.size() && switches[i].millis < FADE_START) { ++early; ++i; }
+            if (i == switches.size() || switches[i].millis >= FADE_END) { ++missed; continue; }
+            recovery.push_back((switches[i].millis - FADE_START) / 1000.);
+            ++i;
+            while (i < switches.size() && switches[i].millis < FADE_END) { ++extra; ++i; }
+            if (i == switches.size() || switches[i].to != 0) { ++notBack; continue; }
+            back.push_back((switches[i].millis - FADE_END) / 1000.);
+            extra += switches.size() - i - 1;
+        }
+        printf("%s:\n", scenario.name);
+        printTimes("time to recovery (from the start of the fade to the switch to a backup)", recovery);
+        printTimes("time to return (from the end of the fade to the switch back to the DNT900)", back);
+        printf("  switches before the fade: %ld, fades never failed over: %ld, never returned: %ld, other switches: %ld\n", early, missed, notBack, extra);
+        bool good = (early == 0 && missed == 0 && notBack == 0 && extra == 0 &&
+                     *std::max_element(recovery.begin(), recovery.end()) <= 30. &&
+                     *std::max_element(back.begin(),     back.end())     <= 180.);
+        printf("  %s\n\n", good ? "ok" : "FAILED");
+        ok &= good;
+    }
+
+// Short dropouts of the DNT900, and all links good: no switches at all.
+    Scenario quiet[2] = { { "3-second dropouts of the DNT900 every 2 minutes, for 2 hours", 7200, shortDropouts },
+                          { "all three links good, for 2 hours",                             7200, allGood       } };
+    for (int q = 0; q < 2; ++q) {
+        long switches = 0;
+        for (int s = 0; s < seeds; ++s) switches += simulate(quiet[q], s + 1).size();
+        printf("%s:\n  switches: %ld\n  %s\n\n", quiet[q].name, switches, switches == 0 ? "ok" : "FAILED");
+        ok &= (switches == 0);
+    }
+
+// A marginal DNT900 link: some switches, but no flapping.
+    {
+        Scenario      scenario = { "the DNT900's link wandering about its sensitivity, for 2 hours", 7200, marginal };
+        long          switches = 0, maxSwitches = 0;
+        unsigned long shortest = ~0UL;
+        for (int s = 0; s < seeds; ++s) {
+            std::vector<Switch> run = simulate(scenario, s + 1);
+            switches   += run.size();
+            maxSwitches = std::max(maxSwitches, (long) run.size());
+            shortest    = std::min(shortest, shortestDwell(run));
+        }
+        double perHour = switches / (2. * seeds);
+        printf("%s:\n  switches per hour: mean %.1f, most in one run %.1f;  shortest time between switches: ",
+               scenario.name, perHour, maxSwitches / 2.);
+        if (shortest == ~0UL) printf("(never two)\n");
+        else                  printf("%.0f s\n", shortest / 1000.);
+        bool good = (shortest >= LINK_MIN_DWELL_MILLIS && maxSwitches / 2. <= 2. * 3600. / 240.);   // (at most a failover and a return per swing)
+        printf("  %s\n\n", good ? "ok" : "FAILED");
+        ok &= good;
+    }
+
+    for (int r = 0; r < NUM_RADIOS; ++r) printf("%s: nominal RSSI %.0f dBm, sensitivity %d dBm\n", radioNames[r], nominalRSSI[r], linkQualityConfigs[r][0]);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
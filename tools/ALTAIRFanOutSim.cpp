@@ -0,0 +1,364 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRFanOutSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the fan-out of the status to all three telemetry radios at once (see
+    ALTAIR_TelemetrySystem::fanOutStatus), with the very same
+    ALTAIR_LinkEncoder and ALTAIR_LinkRateController for each radio as in
+    the flight code, and the very same ALTAIR_DownlinkDecoder on the
+    ground.  Each radio is modelled by what it has room for right now (the
+    DNT900's 256-byte transmit queue, the SHX144's 63-byte UART buffer
+    while its busy line is low, and one 50-byte RFM23BP packet while none
+    is being sent), and its bytes go out on the air at its link's
+    throughput.  The fan-out is polled every radioPollInterval, as the
+    sketch does, over a simulated flight.
+
+    On the ground, each radio has its own decoder, and they all share one
+    ALTAIR_SequenceFilter and one record sink.  It checks that:
+
+      - every record is exactly one of the frames that was built, and no
+        frame is ever written twice (however many radios it came down);
+      - nearly every frame built reaches the ground, via some radio;
+      - with the DNT900 faded out (everything that it sends lost) for
+        much of the flight, the frames still reach the ground, via the
+        backup radios, with no long gaps;
+
+    and it reports the CPU time (on this host) spent per fan-out cycle:
+    the due checks, and the encoding and the hand-over of the frames to
+    all of the radios (but not the building of the frames, which on the
+    Arduino is the reading of the sensors).
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRFanOutSim ALTAIRFanOutSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_LinkEncoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_LinkRateController.cpp ../libraries/ALTAIR_Devices/ALTAIR_DownlinkDecoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandARQ.cpp
+
+    To use:
+
+      ALTAIRFanOutSim [seconds of flight]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "ALTAIR_LinkEncoder.h"
+#include "ALTAIR_LinkRateController.h"
+#include "ALTAIR_DownlinkDecoder.h"
+
+typedef  ALTAIR_AllInfoFrame1    F1;
+typedef  ALTAIR_AllInfoFrame2    F2;
+typedef  ALTAIR_PropulsionFrame  F3;
+typedef  std::vector<byte>       Bytes;
+
+// As in ALTAIR_TelemetrySystem.cpp (and the radios' headers, which depend upon the Arduino libraries).
+#define  NUM_RADIOS                3
+#define  RADIO_POLL_INTERVAL     250            // = radioPollInterval in ALTAIROperation.ino
+#define  DNT_TX_QUEUE_SIZE       256
+#define  DNT_TX_BACKLOG_THRESHOLD (3 * FRAME_HEADER_LENGTH + F1::length + F2::length + F3::length)
+#define  SHX_UART_BUFFER          63            // (SERIAL_TX_BUFFER_SIZE - 1)
+#define  RFM_MAX_MESSAGE_LENGTH   50            // RH_RF22_MAX_MESSAGE_LEN
+#define  FULL_SEND_BYTES         (2 * FRAME_HEADER_LENGTH + F1::length + F2::length)
+
+static const char*             radioNames[NUM_RADIOS]  = { "DNT900", "SHX144", "RFM23BP" };
+static const ALTAIR_LinkConfig linkConfigs[NUM_RADIOS] = {
+    { 38400 / 10 ,  0 , 50 ,  250 },
+    {  1200 / 10 ,  0 , 60 ,  500 },
+    {  2400 / 8  , 13 , 25 , 1000 },
+};
+
+/**************************************************************************/
+/*!
+    The simulated flight: the three frames' data, for each fan-out poll.
+*/
+/**************************************************************************/
+struct Snapshot { byte frame1[F1::length]; byte frame2[F2::length]; byte propulsion[F3::length]; };
+
+static std::vector<Snapshot> simulateFlight( long polls , unsigned seed ) {
+    std::mt19937                     random(seed);
+    std::normal_distribution<double> noise(0., 1.);
+    std::vector<Snapshot>            flight(polls);
+    const double dt = RADIO_POLL_INTERVAL / 1000.;
+    double lat = 48.4634, lon = -123.3117, ele = 10., yaw = 0.;
+    for (long p = 0; p < polls; ++p) {
+        long   t       = (long) (p * dt);
+        bool   motors  = (t % 1200) < 60;                                     // a 1-minute motor run every 20 minutes
+        ele           += dt * ((ele < 25000.) ? 5. : 0.05 * noise(random));
+        lat           += dt * (3.  + noise(random)) * 1e-6 * 9.;
+        lon           += dt * (10. + noise(random)) * 1e-6 * 13.5;
+        yaw            = fmod(yaw + dt * (0.5 + 2. * noise(random)) + 256., 256.);
+        double outTemp = (ele < 11000.) ? 15. - 0.0065 * ele : -56.5 + 0.001 * (ele - 11000.);
+
+        byte* d = flight[p].frame1;
+        memset(d, 0, F1::length);
+        F1::latitude  ::encode(d, lat);
+        F1::longitude ::encode(d, lon);
+        F1::elevation ::put(   d, (int32_t) ele);
+        F1::age       ::encode(d, (float) (random() % 1000));
+        F1::hdop      ::put(   d, 1);
+        F1::separator1::put(   d);
+        F1::outPres   ::encode(d, 101325. * exp(-ele / 8000.));
+        F1::outTemp   ::encode(d, outTemp + 0.3 * noise(random));
+        F1::outHum    ::encode(d, 35.);
+        F1::inPres    ::encode(d, 101000. + 20. * noise(random));
+        F1::inTemp    ::encode(d, 24. + 0.3 * noise(random));
+        F1::inHum     ::encode(d, 35.);
+        F1::accelZ    ::put(   d, (int32_t) (192 + 2. * noise(random)) & 0xFF);
+        F1::accelX    ::put(   d, (int32_t) (128 + 2. * noise(random)) & 0xFF);
+        F1::accelY    ::put(   d, (int32_t) (128 + 2. * noise(random)) & 0xFF);
+        F1::separator2::put(   d);
+        F1::yaw       ::put(   d, (int32_t) yaw & 0xFF);
+        F1::pitch     ::put(   d, (int32_t) (128 + 3. * noise(random)) & 0xFF);
+        F1::roll      ::put(   d, (int32_t) (128 + 3. * noise(random)) & 0xFF);
+        F1::oSensTemp ::put(   d, 30);
+        F1::typeInfo  ::put(   d, 0x09);
+        F1::separator3::put(   d);
+
+        d = flight[p].frame2;
+        memset(d, 0, F2::length);
+        byte temp[8];
+        for (int i = 0; i < 8; ++i) temp[i] = (byte) (int8_t) (2. * (20. + (motors ? 15. : 0.) + 0.3 * noise(random)));
+        F2::packedTemp::put(   d, temp);
+        F2::rssi      ::put(   d, (int32_t) (-90 + 3. * noise(random)));
+        F2::bat1V     ::encode(d, 12.4 - t * 2e-5 + 0.03 * noise(random));
+        F2::bat2V     ::encode(d, (motors ? 11.8 : 12.3) - t * 3e-5 + 0.03 * noise(random));
+        F2::separator1::put(   d);
+        F2::occSpace  ::put(   d, (int32_t) (120 + t / 100));
+        F2::axlRotSet ::encode(d, 5.);
+        F2::axlRotAng ::encode(d, 2.5 + 0.02 * noise(random));
+        F2::separator2::put(   d);
+        F2::lightStat ::put(   d, 0x11);
+        F2::pd1ADRead ::put(   d, (int32_t) (12000 + 5. * noise(random)));
+        F2::pd2ADRead ::put(   d, (int32_t) (11500 + 5. * noise(random)));
+        F2::pd3ADRead ::put(   d, (int32_t) (300 + 5. * noise(random)));
+        F2::separator3::put(   d);
+
+        d = flight[p].propulsion;
+        memset(d, 0, F3::length);
+        F3::microSeq  ::put(   d, p & 0xFF);
+        F3::microAge  ::put(   d, p & 0xFFFF);                                // (which makes each one different)
+        for (uint8_t i = 0; i < 4; ++i) {
+            F3::putRPM(    d, i, motors ? (uint16_t) (4800 + 50. * noise(random)) : 0);
+            F3::putCurrent(d, i, motors ? (int16_t)  (1000 + 20. * noise(random)) : 0);
+        }
+        for (uint8_t i = 0; i < 8; ++i) F3::putTemp(d, i, (int16_t) (10. * (20. + (motors ? 15. : 0.) + 0.3 * noise(random))));
+        F3::separator1::put(   d);
+        F3::separator2::put(   d);
+        F3::separator3::put(   d);
+    }
+    return flight;
+}
+
+/**************************************************************************/
+/*!
+    A radio: its link's encoder and rate controller, what it has room for
+    right now (as its txRoom, txBacklogged and sendNonBlocking do), and
+    the bytes that are waiting to go out on the air.
+*/
+/**************************************************************************/
+struct Radio {
+    int                        index;
+    bool                       reduced;
+    ALTAIR_LinkEncoder         encoder;
+    ALTAIR_LinkRateController  link;
+    std::deque<byte>           queue;                                       // (including any packet overhead, as 0s)
+    double                     drained;                                     // (the fraction of a byte drained so far)
+    unsigned long              lastSendBytes, lastSendFrames;
+
+    bool txBacklogged() const {
+        if (index == 0) return DNT_TX_QUEUE_SIZE - queue.size() < DNT_TX_BACKLOG_THRESHOLD;
+        return !queue.empty();                                              // (the SHX144's busy line, or the RFM23BP still sending)
+    }
+    uint16_t txRoom() const {
+        if (index == 0) return DNT_TX_QUEUE_SIZE - queue.size();
+        if (index == 1) return queue.empty() ? SHX_UART_BUFFER : 0;
+        return queue.empty() ? RFM_MAX_MESSAGE_LENGTH : 0;
+    }
+    bool sendNonBlocking( const byte* data , uint8_t length ) {
+        if (length > txRoom()) return false;
+        if (index == 2) queue.insert(queue.end(), linkConfigs[2].frameOverhead, 0);
+        queue.insert(queue.end(), data, data + length);
+        return true;
+    }
+
+// As ALTAIR_GenTelInt::fanOutStatus.
+    uint8_t fanOutStatus( const byte* frame1 , const byte* frame2 , const byte* propulsion , uint8_t sequence ) {
+        bool oneFrame = (index == 2) || reduced;
+        encoder.beginCycle(frame1, frame2, oneFrame ? NULL : propulsion, sequence, oneFrame ? 1 : NUM_STATUS_FRAMES);
+        lastSendBytes = lastSendFrames = 0;
+        byte    out[LINK_ENCODER_MAX_LENGTH];
+        uint8_t length;
+        while ((length = encoder.nextFrame(out, txRoom())) > 0) {
+            if (!sendNonBlocking(out, length)) break;
+            encoder.frameSent();
+            lastSendBytes += length;
+            ++lastSendFrames;
+        }
+        return lastSendFrames;
+    }
+};
+
+/**************************************************************************/
+/*!
+    The ground station's output: binary records, each of which is looked
+    up among the frames that were built.
+*/
+/**************************************************************************/
+class MergingSink : public ALTAIR_RecordSink {
+  public:
+    MergingSink() : records(0), wrong(0), duplicates(0), maxGap(0), _lastMillis(0) {}
+    void built( const byte* data , uint8_t length , long poll ) {
+        if (!_polls.insert(std::make_pair(Bytes(data, data + length), poll)).second) ++ambiguous;
+    }
+    virtual void write( const byte* data , uint16_t length ) {
+        ++records;
+        unsigned long millis = ALTAIR_FrameField< LOG_RECORD_HEADER_LENGTH , 4 >::get(data);
+        const byte*   frame  = data + LOG_RECORD_HEADER_LENGTH + 4;
+        std::map<Bytes, long>::iterator it = _polls.find(Bytes(frame, frame + length - LOG_RECORD_HEADER_LENGTH - 4));
+        if (it == _polls.end())               ++wrong;
+        else if (!_written.insert(it).second) ++duplicates;
+        if (millis - _lastMillis > maxGap) maxGap = millis - _lastMillis;
+        _lastMillis = millis;
+    }
+    size_t delivered() const { return _written.size(); }
+    long          records, wrong, duplicates;
+    static long   ambiguous;
+    unsigned long maxGap;                                                   // in ms, between records
+  private:
+    struct Less { bool operator()( std::map<Bytes, long>::iterator a , std::map<Bytes, long>::iterator b ) const { return a->first < b->first; } };
+    std::map<Bytes, long>                                 _polls;
+    std::set<std::map<Bytes, long>::iterator, Less>       _written;
+    unsigned long                                         _lastMillis;
+};
+long MergingSink::ambiguous = 0;
+
+struct Result {
+    long          cycles, built, records, wrong, duplicates, filtered, frames[NUM_RADIOS];
+    size_t        delivered;
+    unsigned long maxGap;
+    double        meanMicros, maxMicros;
+};
+
+/**************************************************************************/
+/*!
+    Fly, with the DNT900 faded out (everything that it sends lost) from
+    fadeStart to fadeEnd (in seconds).
+*/
+/**************************************************************************/
+static Result simulate( const std::vector<Snapshot>& flight , long fadeStart , long fadeEnd ) {
+    Radio radios[NUM_RADIOS];
+    for (int r = 0; r < NUM_RADIOS; ++r) {
+        radios[r].index = r; radios[r].drained = 0.; radios[r].lastSendBytes = radios[r].lastSendFrames = 0;
+        radios[r].link.configure(linkConfigs[r], FULL_SEND_BYTES);
+        radios[r].reduced = (radios[r].link.content() == LINK_CONTENT_REDUCED);
+    }
+    MergingSink            sink;
+    ALTAIR_SequenceFilter  filter;
+    ALTAIR_DownlinkDecoder decoders[NUM_RADIOS] = { ALTAIR_DownlinkDecoder(&sink, DOWNLINK_OUTPUT_BINARY),
+                                                    ALTAIR_DownlinkDecoder(&sink, DOWNLINK_OUTPUT_BINARY),
+                                                    ALTAIR_DownlinkDecoder(&sink, DOWNLINK_OUTPUT_BINARY) };
+    for (int r = 0; r < NUM_RADIOS; ++r) decoders[r].setSequenceFilter(&filter);
+
+    Result  result;
+    memset(&result, 0, sizeof(result));
+    uint8_t sequence    = 0;
+    double  totalMicros = 0.;
+    unsigned long end   = flight.size() * RADIO_POLL_INTERVAL;
+    for (unsigned long now = 0; now < end; ++now) {
+        bool faded = (long) (now / 1000) >= fadeStart && (long) (now / 1000) < fadeEnd;
+        for (int r = 0; r < NUM_RADIOS; ++r) {                              // the bytes going out on the air, and down to the ground
+            Radio& radio = radios[r];
+            radio.drained += linkConfigs[r].bytesPerSecond / 1000.;
+            while (radio.drained >= 1. && !radio.queue.empty()) {
+                byte aByte = radio.queue.front();
+                radio.queue.pop_front();
+                radio.drained -= 1.;
+                if (!(r == 0 && faded)) decoders[r].feed(aByte, now);
+            }
+            if (radio.queue.empty()) radio.drained = 0.;
+        }
+        if (now % RADIO_POLL_INTERVAL != 0) continue;
+
+// As ALTAIR_TelemetrySystem::fanOutStatus (with the building of the frames left out of the timing).
+        const Snapshot& snapshot = flight[now / RADIO_POLL_INTERVAL];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool    built = false;
+        for (int r = 0; r < NUM_RADIOS; ++r) {
+            Radio& radio = radios[r];
+            if (radio.link.millisUntilDue(now, radio.txBacklogged()) > 0) continue;
+            if (!built) {
+                sequence = (sequence + 1) & FANOUT_SEQUENCE_MASK;
+                built    = true;
+            }
+            if (radio.fanOutStatus(snapshot.frame1, snapshot.frame2, snapshot.propulsion, sequence) > 0) {
+                radio.link.sent(now, radio.lastSendBytes, radio.lastSendFrames);
+                result.frames[r] += radio.lastSendFrames;
+            }
+        }
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (!built) continue;
+        ++result.cycles;
+        totalMicros += micros;
+        if (micros > result.maxMicros) result.maxMicros = micros;
+        long poll = now / RADIO_POLL_INTERVAL;
+        sink.built(snapshot.frame1,     F1::length, poll);
+        sink.built(snapshot.frame2,     F2::length, poll);
+        sink.built(snapshot.propulsion, F3::length, poll);
+        result.built += 3;
+    }
+    result.records    = sink.records;
+    result.wrong      = sink.wrong;
+    result.duplicates = sink.duplicates;
+    result.delivered  = sink.delivered();
+    result.maxGap     = sink.maxGap;
+    result.meanMicros = result.cycles ? totalMicros / result.cycles : 0.;
+    for (int r = 0; r < NUM_RADIOS; ++r) result.filtered += decoders[r].stats()->duplicates;
+    return result;
+}
+
+static bool report( const char* name , const Result& r , double minDelivered , unsigned long maxGap ) {
+    bool ok = (r.wrong == 0 && r.duplicates == 0 && r.delivered >= minDelivered * r.built && r.maxGap <= maxGap);
+    printf("%s:\n", name);
+    printf("  fan-out cycles: %ld, frames built: %ld, delivered: %zu (%.1f%%), records: %ld, wrong: %ld, written twice: %ld\n",
+           r.cycles, r.built, r.delivered, 100. * r.delivered / r.built, r.records, r.wrong, r.duplicates);
+    printf("  frames sent: %s %ld, %s %ld, %s %ld;  copies dropped by the sequence filter: %ld;  longest gap: %lu ms\n",
+           radioNames[0], r.frames[0], radioNames[1], r.frames[1], radioNames[2], r.frames[2], r.filtered, r.maxGap);
+    printf("  CPU time per fan-out cycle (this host): mean %.2f us, max %.2f us\n", r.meanMicros, r.maxMicros);
+    printf("  %s\n\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main( int argc , char** argv )
+{
+    long seconds = (argc > 1) ? atol(argv[1]) : 3600;
+    bool ok      = true;
+
+    std::vector<Snapshot> flight = simulateFlight(seconds * 1000 / RADIO_POLL_INTERVAL, 1);
+    printf("%ld seconds of simulated flight, with the status fanned out every %d ms\n\n", seconds, RADIO_POLL_INTERVAL);
+
+    Result normal = simulate(flight, 0, 0);
+    ok &= report("all three radios", normal, 0.95, 2 * RADIO_POLL_INTERVAL);
+
+    Result faded  = simulate(flight, seconds / 5, 4 * seconds / 5);
+    ok &= report("with the DNT900 faded out for the middle 60% of the flight", faded, 0.20, 5000);
+    if (MergingSink::ambiguous > 0) { printf("%ld frames were built twice, byte for byte!\n", MergingSink::ambiguous); ok = false; }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
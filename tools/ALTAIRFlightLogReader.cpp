@@ -0,0 +1,275 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRFlightLogReader.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) tool for the
+    post-flight analysis of the binary flight records logged onto the
+    onboard microSD card (see ALTAIR_FlightRecord.h).  It memory-maps an
+    ALTAIRnn.BIN file, builds an index of every flight record sorted by
+    the time at which it was made, and then extracts any time window
+    (found via binary search, so in O(log n)) and any set of channels, as
+    CSV.  Records are decoded with the very same field definitions that
+    the flight code uses to encode them.  Records of an older version
+    (which, since a version only ever appends fields, are a prefix of the
+    present layout) are decoded too, with the channels that they lack
+    left empty, as are records of a newer version (by their prefix, i.e.
+    without the fields that this reader does not know of); records of an
+    unknown version, or of the wrong length, are skipped, and counted.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRFlightLogReader ALTAIRFlightLogReader.cpp
+
+    To use:
+
+      ALTAIRFlightLogReader ALTAIR00.BIN info
+      ALTAIRFlightLogReader ALTAIR00.BIN channels
+      ALTAIRFlightLogReader ALTAIR00.BIN window <start ms> <end ms> [channel ...]
+
+    (Times are in milliseconds since CPU start, as per the cpuMillis
+    channel.  With no channels listed, every channel is output.)
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+
+#include "ALTAIR_FlightRecord.h"
+
+typedef  ALTAIR_FlightRecord   FR;
+typedef  ALTAIR_AllInfoFrame1  F1;
+typedef  ALTAIR_AllInfoFrame2  F2;
+
+/**************************************************************************/
+/*!
+    Decoders for each kind of channel.  Each takes a pointer to the
+    payload of a flight record, and returns the value in physical units.
+*/
+/**************************************************************************/
+template <class FIELD>                   double recordField( const byte* r ) { return (uint32_t) FIELD::get(r)                        ; }
+template <class FIELD>                   double frame1Field( const byte* r ) { return FIELD::decode(r + FR::frame1::offset)            ; }
+template <class FIELD>                   double frame2Field( const byte* r ) { return FIELD::decode(r + FR::frame2::offset)            ; }
+template <class ARRAY, int I, int NUM, int DEN>
+                                         double frame1Byte(  const byte* r ) { return ARRAY::get(r + FR::frame1::offset, I) * NUM / (double) DEN ; }
+template <class ARRAY, int I, int NUM, int DEN>
+                                         double frame2Byte(  const byte* r ) { return ARRAY::get(r + FR::frame2::offset, I) * NUM / (double) DEN ; }
+
+struct Channel {
+    const char*  name                                           ;
+    const char*  units                                          ;
+    double     (*decode)(             const byte* record      ) ;
+    uint8_t      sinceVersion                                   ;  // the first version of the flight record that has it
+};
+
+static const Channel channels[] = {
+    { "cpuMillis"  , "ms"        , recordField< FR::cpuMillis  >                  , 1 },
+    { "gpsHour"    , "h"         , recordField< FR::gpsHour    >                  , 1 },
+    { "gpsMinute"  , "min"       , recordField< FR::gpsMinute  >                  , 1 },
+    { "gpsSecond"  , "s"         , recordField< FR::gpsSecond  >                  , 1 },
+    { "gpsHealth"  , ""          , recordField< FR::gpsHealth  >                  , 2 },
+    { "latitude"   , "deg"       , frame1Field< F1::latitude   >                  , 1 },
+    { "longitude"  , "deg"       , frame1Field< F1::longitude  >                  , 1 },
+    { "elevation"  , "m"         , frame1Field< F1::elevation  >                  , 1 },
+    { "gpsAge"     , "ms"        , frame1Field< F1::age        >                  , 1 },
+    { "hdop"       , ""          , frame1Field< F1::hdop       >                  , 1 },
+    { "outPres"    , "Pa"        , frame1Field< F1::outPres    >                  , 1 },
+    { "outTemp"    , "C"         , frame1Field< F1::outTemp    >                  , 1 },
+    { "outHum"     , "%"         , frame1Field< F1::outHum     >                  , 1 },
+    { "inPres"     , "Pa"        , frame1Field< F1::inPres     >                  , 1 },
+    { "inTemp"     , "C"         , frame1Field< F1::inTemp     >                  , 1 },
+    { "inHum"      , "%"         , frame1Field< F1::inHum      >                  , 1 },
+    { "balPres"    , "Pa"        , frame1Field< F1::balPres    >                  , 1 },
+    { "balTemp"    , "C"         , frame1Field< F1::balTemp    >                  , 1 },
+    { "balHum"     , "%"         , frame1Field< F1::balHum     >                  , 1 },
+    { "accelZ"     , "raw"       , frame1Field< F1::accelZ     >                  , 1 },
+    { "accelX"     , "raw"       , frame1Field< F1::accelX     >                  , 1 },
+    { "accelY"     , "raw"       , frame1Field< F1::accelY     >                  , 1 },
+    { "yaw"        , "raw"       , frame1Field< F1::yaw        >                  , 1 },
+    { "pitch"      , "raw"       , frame1Field< F1::pitch      >                  , 1 },
+    { "roll"       , "raw"       , frame1Field< F1::roll       >                  , 1 },
+    { "oSensTemp"  , "C"         , frame1Field< F1::oSensTemp  >                  , 1 },
+    { "typeInfo"   , "raw"       , frame1Field< F1::typeInfo   >                  , 1 },
+    { "rpm1"       , "RPM"       , frame1Byte<  F1::packedRPM  , 0 , 60 , 1 >     , 1 },
+    { "rpm2"       , "RPM"       , frame1Byte<  F1::packedRPM  , 1 , 60 , 1 >     , 1 },
+    { "rpm3"       , "RPM"       , frame1Byte<  F1::packedRPM  , 2 , 60 , 1 >     , 1 },
+    { "rpm4"       , "RPM"       , frame1Byte<  F1::packedRPM  , 3 , 60 , 1 >     , 1 },
+    { "current1"   , "A"         , frame1Byte<  F1::packedCur  , 0 ,  1 , 4 >     , 1 },
+    { "current2"   , "A"         , frame1Byte<  F1::packedCur  , 1 ,  1 , 4 >     , 1 },
+    { "current3"   , "A"         , frame1Byte<  F1::packedCur  , 2 ,  1 , 4 >     , 1 },
+    { "current4"   , "A"         , frame1Byte<  F1::packedCur  , 3 ,  1 , 4 >     , 1 },
+    { "temp1"      , "C"         , frame2Byte<  F2::packedTemp , 0 ,  1 , 2 >     , 1 },
+    { "temp2"      , "C"         , frame2Byte<  F2::packedTemp , 1 ,  1 , 2 >     , 1 },
+    { "temp3"      , "C"         , frame2Byte<  F2::packedTemp , 2 ,  1 , 2 >     , 1 },
+    { "temp4"      , "C"         , frame2Byte<  F2::packedTemp , 3 ,  1 , 2 >     , 1 },
+    { "temp5"      , "C"         , frame2Byte<  F2::packedTemp , 4 ,  1 , 2 >     , 1 },
+    { "temp6"      , "C"         , frame2Byte<  F2::packedTemp , 5 ,  1 , 2 >     , 1 },
+    { "temp7"      , "C"         , frame2Byte<  F2::packedTemp , 6 ,  1 , 2 >     , 1 },
+    { "temp8"      , "C"         , frame2Byte<  F2::packedTemp , 7 ,  1 , 2 >     , 1 },
+    { "rssi"       , "dBm"       , frame2Field< F2::rssi       >                  , 1 },
+    { "bat1V"      , "V"         , frame2Field< F2::bat1V      >                  , 1 },
+    { "bat2V"      , "V"         , frame2Field< F2::bat2V      >                  , 1 },
+    { "occSpace"   , "MB"        , frame2Field< F2::occSpace   >                  , 1 },
+    { "powerMot1"  , ""          , frame2Field< F2::powerMot1  >                  , 1 },
+    { "powerMot2"  , ""          , frame2Field< F2::powerMot2  >                  , 1 },
+    { "powerMot3"  , ""          , frame2Field< F2::powerMot3  >                  , 1 },
+    { "powerMot4"  , ""          , frame2Field< F2::powerMot4  >                  , 1 },
+    { "axlRotSet"  , ""          , frame2Field< F2::axlRotSet  >                  , 1 },
+    { "axlRotAng"  , "V"         , frame2Field< F2::axlRotAng  >                  , 1 },
+    { "bleedVSet"  , ""          , frame2Field< F2::bleedVSet  >                  , 1 },
+    { "bleedVAng"  , "V"         , frame2Field< F2::bleedVAng  >                  , 1 },
+    { "cutdwnSet"  , ""          , frame2Field< F2::cutdwnSet  >                  , 1 },
+    { "cutdwnAng"  , "V"         , frame2Field< F2::cutdwnAng  >                  , 1 },
+    { "lightStat"  , "raw"       , frame2Field< F2::lightStat  >                  , 1 },
+    { "pd1ADRead"  , "ADC"       , frame2Field< F2::pd1ADRead  >                  , 1 },
+    { "pd2ADRead"  , "ADC"       , frame2Field< F2::pd2ADRead  >                  , 1 },
+    { "pd3ADRead"  , "ADC"       , frame2Field< F2::pd3ADRead  >                  , 1 },
+};
+static const int numChannels = sizeof(channels) / sizeof(channels[0]);
+
+struct IndexEntry {
+    uint32_t     cpuMillis                                      ;
+    const byte*  record                                         ;  // points at the record's payload, within the mapped file
+    uint8_t      version                                        ;
+    bool operator<( const IndexEntry& other ) const { return cpuMillis < other.cpuMillis; }
+};
+
+/**************************************************************************/
+/*!
+ @brief  Scan the whole (mapped) file once, and index every valid flight
+         record (of any known version) by time.  Zero padding (and
+         anything else that is not a valid record) is skipped over, a byte
+         at a time, until the next sync byte.  Records of other types are
+         skipped over whole.  A flight record whose version is unknown, or
+         whose length is not that of its version, is counted in
+         unknownRecords, and skipped a byte at a time (as it may just be
+         a stray sync byte).  A record of a newer version than this reader
+         knows is indexed as one of the present version.
+*/
+/**************************************************************************/
+static void buildIndex( const byte* data, size_t size, std::vector<IndexEntry>& index, size_t& skippedBytes, size_t& otherRecords,
+                        size_t& unknownRecords, size_t& newerRecords, size_t* versionRecords )
+{
+    size_t i = 0;
+    skippedBytes = otherRecords = unknownRecords = newerRecords = 0;
+    while (i + LOG_RECORD_HEADER_LENGTH <= size) {
+        if (data[i] != LOG_RECORD_SYNC_BYTE) { ++i; ++skippedBytes; continue; }
+        uint8_t type   = data[i+1];
+        uint8_t length = data[i+2];
+        const byte* payload = data + i + LOG_RECORD_HEADER_LENGTH;
+        if (i + LOG_RECORD_HEADER_LENGTH + length > size) break;
+        if (type == LOG_RECORD_FLIGHT) {
+            uint8_t version = (length > 0) ? FR::version::get(payload) : 0;
+            bool    newer   = (version > FLIGHT_RECORD_VERSION && length > FR::length);     // (its prefix is the present layout)
+            if (newer) version = FLIGHT_RECORD_VERSION;
+            if (FR::versionLength(version) == 0 || (!newer && length != FR::versionLength(version))) {
+                ++unknownRecords; ++i; ++skippedBytes; continue;
+            }
+            IndexEntry entry = { (uint32_t) FR::cpuMillis::get(payload), payload, version };
+            index.push_back(entry);
+            if (newer) ++newerRecords;
+            else       ++versionRecords[version];
+        } else {
+            ++otherRecords;
+        }
+        i += LOG_RECORD_HEADER_LENGTH + length;
+    }
+    skippedBytes += size - std::min(i, size);
+    if (!std::is_sorted(index.begin(), index.end())) std::stable_sort(index.begin(), index.end());
+}
+
+/**************************************************************************/
+/*!
+ @brief  Look up a channel by name.  Returns -1 if there is none.
+*/
+/**************************************************************************/
+static int findChannel( const char* name )
+{
+    for (int c = 0; c < numChannels; ++c) if (strcmp(channels[c].name, name) == 0) return c;
+    return -1;
+}
+
+static int usage( const char* program )
+{
+    fprintf(stderr, "usage: %s <file> info\n"
+                    "       %s <file> channels\n"
+                    "       %s <file> window <start ms> <end ms> [channel ...]\n", program, program, program);
+    return 1;
+}
+
+int main( int argc, char** argv )
+{
+    if (argc < 3) return usage(argv[0]);
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0) { perror(argv[1]); return 1; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { fprintf(stderr, "%s: empty or unreadable file\n", argv[1]); return 1; }
+    size_t size = st.st_size;
+    const byte* data = (const byte*) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) { perror("mmap"); return 1; }
+    madvise((void*) data, size, MADV_SEQUENTIAL);
+
+    std::vector<IndexEntry> index;
+    size_t skippedBytes, otherRecords, unknownRecords, newerRecords;
+    size_t versionRecords[FLIGHT_RECORD_VERSION + 1] = { 0 };
+    buildIndex(data, size, index, skippedBytes, otherRecords, unknownRecords, newerRecords, versionRecords);
+    if (unknownRecords) fprintf(stderr, "%s: skipped %zu flight records of an unknown version (or length)\n", argv[1], unknownRecords);
+
+    if (strcmp(argv[2], "info") == 0) {
+        printf("file size:              %zu bytes\n", size);
+        printf("flight records:         %zu\n", index.size());
+        for (int v = 1; v <= FLIGHT_RECORD_VERSION; ++v) if (versionRecords[v]) printf("   of version %d:         %zu\n", v, versionRecords[v]);
+        if (newerRecords) printf("   of newer versions:   %zu (read as version %d)\n", newerRecords, FLIGHT_RECORD_VERSION);
+        printf("   of unknown versions: %zu (skipped)\n", unknownRecords);
+        printf("other records:          %zu\n", otherRecords);
+        printf("skipped bytes:          %zu\n", skippedBytes);
+        if (!index.empty()) printf("time span:              %u to %u ms (%.1f s)\n", index.front().cpuMillis, index.back().cpuMillis,
+                                   (index.back().cpuMillis - index.front().cpuMillis) / 1000.);
+    } else if (strcmp(argv[2], "channels") == 0) {
+        for (int c = 0; c < numChannels; ++c) printf("%-12s %s\n", channels[c].name, channels[c].units);
+    } else if (strcmp(argv[2], "window") == 0 && argc >= 5) {
+        IndexEntry start = { (uint32_t) strtoul(argv[3], NULL, 0), NULL, 0 };
+        IndexEntry end   = { (uint32_t) strtoul(argv[4], NULL, 0), NULL, 0 };
+        std::vector<int> selected;
+        for (int a = 5; a < argc; ++a) {
+            int c = findChannel(argv[a]);
+            if (c < 0) { fprintf(stderr, "unknown channel: %s\n", argv[a]); return 1; }
+            selected.push_back(c);
+        }
+        if (selected.empty()) for (int c = 0; c < numChannels; ++c) selected.push_back(c);
+
+        std::vector<IndexEntry>::const_iterator first = std::lower_bound(index.cbegin(), index.cend(), start);
+        std::vector<IndexEntry>::const_iterator last  = std::upper_bound(first,          index.cend(), end);
+        for (size_t s = 0; s < selected.size(); ++s) printf("%s%s", s ? "," : "", channels[selected[s]].name);
+        printf("\n");
+        for (std::vector<IndexEntry>::const_iterator e = first; e != last; ++e) {
+            for (size_t s = 0; s < selected.size(); ++s) {
+                const Channel& channel = channels[selected[s]];
+                if (s) printf(",");
+                if (e->version >= channel.sinceVersion) printf("%.9g", channel.decode(e->record));    // (a channel that an older record lacks is left empty)
+            }
+            printf("\n");
+        }
+    } else {
+        return usage(argv[0]);
+    }
+
+    munmap((void*) data, size);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,414 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRGPSMonitorSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the GPS consistency monitor (ALTAIR_GPSMonitor, the very same code that
+    runs on the Mega), replaying a trace of both GPS receivers' fixes, at
+    the rate at which ALTAIROperation.ino polls them.
+
+    The trace is a text file, one line per poll:
+
+      millis  truthLat truthLon truthEle  injected  (lat lon ele time age) x 2
+
+    with the truth (or "-", if it is not known, as in a trace from the
+    payload itself), the faults that were injected (as a health word: see
+    ALTAIR_GPSMonitor.h; or "-"), and then the NEO-M8N's fix (as decoded
+    from its NMEA sentences by TinyGPS++) and the DFRobot G6's (as passed
+    on by the UM7), as ALTAIR_GPSSensors::poll() gets them.  If the trace
+    file given does not exist, a two-hour one is made up and written to it
+    (or, with no file given, just made up): a flight from Victoria, rising
+    at 5 m/s into a wind that grows with altitude, with each receiver's
+    own noise (the G6's position in single precision, as the UM7's
+    registers hold it), and these faults injected:
+
+      - the G6 has no fix for the first 90 s (a cold start);
+      - the NEO-M8N drops out (its sentences stop) from 20:00 to 22:00;
+      - the UM7 keeps passing on the G6's last packet from 35:00 to 40:00;
+      - the NEO-M8N's position is 2 km off from 50:00 to 53:00;
+      - the G6 drops out from 65:00 to 66:30;
+      - the G6's elevation is 600 m off from 80:00 to 82:00;
+      - both drop out from 95:00 to 96:00.
+
+    It reports:
+
+      - the cost of an update (in host time);
+      - for each injected fault: how long it took the monitor to flag it,
+        how long the flag took to clear after the fault ended, and the
+        worst error of the solution meanwhile;
+      - against the truth (if known): the RMS and worst error of the
+        solution, and of the NEO-M8N's fix alone (the primary receiver,
+        which is what the telemetry used to send), horizontally and in
+        elevation, while there is a solution;
+      - the false alarms: the polls on which a receiver was flagged,
+        though nothing was injected (nor had been, in the last
+        RECOVERY_SECONDS).
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRGPSMonitorSim ALTAIRGPSMonitorSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_GPSMonitor.cpp
+
+    To use:
+
+      ALTAIRGPSMonitorSim [trace file]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_GPSMonitor.h"
+
+#define  TRACE_SECONDS               7200
+#define  POLL_MILLIS                  400           // as the "GPS and heading" task, in ALTAIROperation.ino
+#define  TIMING_PASSES                 20
+#define  METERS_PER_DEGREE       111195.0
+#define  START_LAT                48.4634           // (Victoria)
+#define  START_LON              -123.3117
+#define  START_ELE                     20
+#define  START_UTC_SECONDS        57600.0           // (16:00 UT)
+#define  RECOVERY_SECONDS              15
+
+struct TraceLine {
+    unsigned long  millis;
+    bool           haveTruth;
+    double         truthLat, truthLon, truthEle;
+    bool           haveInjected;
+    uint16_t       injected;
+    ALTAIR_GPSFix  fixes[GPS_NUM_RECEIVERS];
+};
+
+// The faults injected into the made-up trace (see above).
+struct Injection {
+    uint8_t  receiver;
+    uint8_t  fault;
+    double   begin, end;                           // in s
+    double   north, up;                            // (offsets, in m, for GPS_FAULT_DIVERGED)
+};
+
+static const Injection injections[] = {
+    { GPS_RECEIVER_DFROBOTG6 , GPS_FAULT_NOFIX    ,    0. ,   90. ,    0. ,   0. },
+    { GPS_RECEIVER_NEOM8N    , GPS_FAULT_STALE    , 1200. , 1320. ,    0. ,   0. },
+    { GPS_RECEIVER_DFROBOTG6 , GPS_FAULT_FROZEN   , 2100. , 2400. ,    0. ,   0. },
+    { GPS_RECEIVER_NEOM8N    , GPS_FAULT_DIVERGED , 3000. , 3180. , 2000. ,   0. },
+    { GPS_RECEIVER_DFROBOTG6 , GPS_FAULT_STALE    , 3900. , 3990. ,    0. ,   0. },
+    { GPS_RECEIVER_DFROBOTG6 , GPS_FAULT_DIVERGED , 4800. , 4920. ,    0. , 600. },
+    { GPS_RECEIVER_NEOM8N    , GPS_FAULT_STALE    , 5700. , 5760. ,    0. ,   0. },
+    { GPS_RECEIVER_DFROBOTG6 , GPS_FAULT_STALE    , 5700. , 5760. ,    0. ,   0. },
+};
+#define  NUM_INJECTIONS  (sizeof(injections) / sizeof(injections[0]))
+
+// How long the monitor may take to flag each fault (in s): the threshold, plus a fix and a poll.
+static double detectLimit( uint8_t fault ) {
+    switch (fault) {
+      case GPS_FAULT_STALE  : return (GPS_STALE_MILLIS  + 1000 + POLL_MILLIS) / 1000.;
+      case GPS_FAULT_FROZEN : return (GPS_FROZEN_MILLIS + 1000 + POLL_MILLIS) / 1000.;
+      default               : return (                    1000 + POLL_MILLIS) / 1000.;
+    }
+}
+
+static const char* faultName( uint8_t fault ) {
+    switch (fault) {
+      case GPS_FAULT_NOFIX  : return "no fix";
+      case GPS_FAULT_STALE  : return "dropout";
+      case GPS_FAULT_FROZEN : return "frozen";
+      default               : return "diverged";
+    }
+}
+
+static const char* receiverName( uint8_t receiver ) { return (receiver == GPS_RECEIVER_NEOM8N) ? "NEO-M8N" : "G6"; }
+
+/**************************************************************************/
+/*!
+    The flight: rising at 5 m/s to 30 km, drifting east in a wind that
+    grows to 25 m/s at 12 km, and north at 3 m/s.
+*/
+/**************************************************************************/
+static void truthAt( double t , double* lat , double* lon , double* ele ) {
+    double top   = (30000. - START_ELE) / 5.;
+    double rise  = (t < top) ? t : top;
+    *ele         = START_ELE + 5. * rise;
+    double windy = 12000. / 5.;                                                // (the time at which it reaches 12 km)
+    double east  = (t < windy) ? 5. * t + 20. * t * t / (2. * windy) : 5. * windy + 10. * windy + 25. * (t - windy);
+    double north = 3. * t;
+    *lat         = START_LAT + north / METERS_PER_DEGREE;
+    *lon         = START_LON + east  / (METERS_PER_DEGREE * cos(START_LAT * M_PI / 180.));
+}
+
+static const Injection* injected( uint8_t receiver , uint8_t fault , double t ) {
+    for (size_t i = 0; i < NUM_INJECTIONS; ++i) {
+        const Injection& in = injections[i];
+        if (in.receiver == receiver && in.fault == fault && t >= in.begin && t < in.end) return &in;
+    }
+    return NULL;
+}
+
+/**************************************************************************/
+/*!
+    Make up a trace (see above).
+*/
+/**************************************************************************/
+static std::vector<TraceLine> makeTrace( ) {
+    std::mt19937                     random(17102026);
+    std::normal_distribution<double> gauss(0., 1.);
+    std::vector<TraceLine>           trace;
+
+    const double   phase[GPS_NUM_RECEIVERS]   = { 0.   , 0.3  };                // (of each receiver's 1 Hz fixes, in s)
+    const double   latency[GPS_NUM_RECEIVERS] = { 0.10 , 0.15 };                // (from the fix, to when the Mega has it)
+    const double   sigmaH[GPS_NUM_RECEIVERS]  = { 2.   , 4.   };                // (1 sigma, in m)
+    const double   sigmaV[GPS_NUM_RECEIVERS]  = { 4.   , 8.   };
+    ALTAIR_GPSFix  last[GPS_NUM_RECEIVERS];
+    double         lastArrival[GPS_NUM_RECEIVERS];
+    bool           hasFix[GPS_NUM_RECEIVERS]  = { false , false };
+    double         nextFix[GPS_NUM_RECEIVERS] = { phase[0] , phase[1] };
+
+    for (unsigned long ms = 0; ms <= 1000UL * TRACE_SECONDS; ms += POLL_MILLIS) {
+        double     t = ms / 1000.;
+        TraceLine  line;
+        line.millis       = ms;
+        line.haveTruth    = true;
+        line.haveInjected = true;
+        line.injected     = 0;
+        truthAt(t, &line.truthLat, &line.truthLon, &line.truthEle);
+
+        for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) {
+            while (nextFix[r] + latency[r] <= t) {                              // (each fix that has arrived since the last poll)
+                double fixT = nextFix[r];
+                nextFix[r] += 1.;
+                if (injected(r, GPS_FAULT_NOFIX, fixT) || injected(r, GPS_FAULT_STALE, fixT)) continue;
+                lastArrival[r] = fixT + latency[r];
+                if (injected(r, GPS_FAULT_FROZEN, fixT) && hasFix[r]) continue;  // (the same packet again: only its arrival is new)
+                double lat, lon, ele;
+                truthAt(fixT, &lat, &lon, &ele);
+                const Injection* off = injected(r, GPS_FAULT_DIVERGED, fixT);
+                double north = sigmaH[r] * gauss(random) + (off ? off->north : 0.);
+                double east  = sigmaH[r] * gauss(random);
+                ele         += sigmaV[r] * gauss(random) + (off ? off->up : 0.);
+                lat         += north / METERS_PER_DEGREE;
+                lon         += east  / (METERS_PER_DEGREE * cos(lat * M_PI / 180.));
+                if (r == GPS_RECEIVER_DFROBOTG6) { lat = (float) lat;  lon = (float) lon; }   // (the UM7's registers are floats)
+                last[r].lat  = lat;
+                last[r].lon  = lon;
+                last[r].ele  = (long) ele;
+                last[r].time = START_UTC_SECONDS + fixT;
+                hasFix[r]    = true;
+            }
+            line.fixes[r]     = last[r];
+            line.fixes[r].age = hasFix[r] ? (uint32_t) lround((t - lastArrival[r]) * 1000.) : GPS_NO_FIX_AGE;
+            if (!hasFix[r]) {                                                   // (as before any receiver's first fix, injected or not)
+                line.fixes[r].lat = 0.;  line.fixes[r].lon = 0.;  line.fixes[r].ele = 0;  line.fixes[r].time = 0.;
+                line.injected    |= GPS_FAULT_NOFIX << (GPS_FAULT_BITS * r);
+            }
+
+            for (size_t i = 0; i < NUM_INJECTIONS; ++i) {
+                const Injection& in = injections[i];
+                if (in.receiver == r && t >= in.begin && t < in.end) line.injected |= in.fault << (GPS_FAULT_BITS * r);
+            }
+        }
+        trace.push_back(line);
+    }
+    return trace;
+}
+
+static bool readTrace( const char* fileName , std::vector<TraceLine>& trace ) {
+    FILE* file = fopen(fileName, "r");
+    if (file == NULL) return false;
+    char text[512];
+    while (fgets(text, sizeof(text), file)) {
+        if (text[0] == '#') continue;
+        TraceLine     line;
+        char          truth[3][32], injected[32];
+        unsigned long age[GPS_NUM_RECEIVERS];
+        int           n = sscanf(text, "%lu %31s %31s %31s %31s %lf %lf %ld %lf %lu %lf %lf %ld %lf %lu", &line.millis, truth[0], truth[1], truth[2], injected,
+                                 &line.fixes[0].lat, &line.fixes[0].lon, &line.fixes[0].ele, &line.fixes[0].time, &age[0],
+                                 &line.fixes[1].lat, &line.fixes[1].lon, &line.fixes[1].ele, &line.fixes[1].time, &age[1]);
+        if (n != 15) continue;
+        line.haveTruth    = (truth[0][0] != '-');
+        line.truthLat     = line.haveTruth ? atof(truth[0]) : 0.;
+        line.truthLon     = line.haveTruth ? atof(truth[1]) : 0.;
+        line.truthEle     = line.haveTruth ? atof(truth[2]) : 0.;
+        line.haveInjected = (injected[0] != '-');
+        line.injected     = line.haveInjected ? (uint16_t) strtoul(injected, NULL, 16) : 0;
+        for (int r = 0; r < GPS_NUM_RECEIVERS; ++r) line.fixes[r].age = (uint32_t) age[r];
+        trace.push_back(line);
+    }
+    fclose(file);
+    return true;
+}
+
+static void writeTrace( const char* fileName , const std::vector<TraceLine>& trace ) {
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL) return;
+    fprintf(file, "# millis truthLat truthLon truthEle injected (lat lon ele time age) x 2: NEO-M8N G6\n");
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const TraceLine& line = trace[i];
+        fprintf(file, "%lu %.7f %.7f %.1f %04X", line.millis, line.truthLat, line.truthLon, line.truthEle, line.injected);
+        for (int r = 0; r < GPS_NUM_RECEIVERS; ++r) {
+            const ALTAIR_GPSFix& fix = line.fixes[r];
+            fprintf(file, "  %.7f %.7f %ld %.2f %lu", fix.lat, fix.lon, fix.ele, fix.time, (unsigned long) fix.age);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+static double metersApart( double lat1 , double lon1 , double lat2 , double lon2 ) {
+    double north = (lat2 - lat1) * METERS_PER_DEGREE;
+    double east  = (lon2 - lon1) * METERS_PER_DEGREE * cos((lat1 + lat2) * M_PI / 360.);
+    return sqrt(north * north + east * east);
+}
+
+struct Errors {
+    Errors() : n(0), sumSquares(0.), worst(0.) {}
+    void add( double error ) {
+        ++n;
+        sumSquares += error * error;
+        if (fabs(error) > worst) worst = fabs(error);
+    }
+    double rms( ) const { return n ? sqrt(sumSquares / n) : 0.; }
+    long   n;
+    double sumSquares, worst;
+};
+
+// One run of polls with a fault injected into one receiver.
+struct Event {
+    uint8_t  receiver, fault;
+    size_t   begin, end;                           // (the polls: [begin, end))
+    double   detected, cleared;                    // (in s after the begin, and after the end; -1 if never)
+    double   worst;                                // (the solution's horizontal error, meanwhile)
+};
+
+int main( int argc , char** argv )
+{
+    std::vector<TraceLine> trace;
+    const char*            fileName = (argc > 1) ? argv[1] : NULL;
+    if (fileName == NULL || !readTrace(fileName, trace)) {
+        trace = makeTrace();
+        if (fileName) writeTrace(fileName, trace);
+        printf("A made-up trace of %zu polls (%d s)%s%s\n\n", trace.size(), TRACE_SECONDS, fileName ? ", written to " : "", fileName ? fileName : "");
+    } else {
+        printf("Replaying %zu polls from %s\n\n", trace.size(), fileName);
+    }
+    if (trace.empty()) { printf("Nothing to replay.\n"); return 1; }
+
+// The cost of an update.
+    double sink  = 0.;
+    auto   begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < TIMING_PASSES; ++pass) {
+        ALTAIR_GPSMonitor monitor;
+        for (size_t i = 0; i < trace.size(); ++i) {
+            monitor.update(trace[i].fixes, GPS_RECEIVER_NEOM8N, trace[i].millis);
+            sink += monitor.lat();
+        }
+    }
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    printf("Cost (host): %.1f ns per update   (%s)\n\n", nanos / ((double) TIMING_PASSES * trace.size()), sink != 0. ? "ok" : "-");
+
+// The events: each run of polls with a fault injected into one receiver.
+    std::vector<Event> events;
+    for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) {
+        for (size_t i = 0; i < trace.size(); ++i) {
+            uint8_t fault = GPS_HEALTH_FAULTS(trace[i].injected, r);
+            if (!fault || (i > 0 && GPS_HEALTH_FAULTS(trace[i - 1].injected, r) == fault)) continue;
+            Event event = { r, fault, i, i, -1., -1., 0. };
+            while (event.end < trace.size() && GPS_HEALTH_FAULTS(trace[event.end].injected, r) == fault) ++event.end;
+            events.push_back(event);
+        }
+    }
+
+// Replay the trace.
+    ALTAIR_GPSMonitor monitor;
+    Errors            solutionH, solutionV, primaryH, primaryV;
+    long              falseAlarms = 0, noSolution = 0, checked = 0;
+    std::vector<unsigned long> lastInjected(GPS_NUM_RECEIVERS, 0);
+    std::vector<bool>          everInjected(GPS_NUM_RECEIVERS, false);
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const TraceLine& line = trace[i];
+        monitor.update(line.fixes, GPS_RECEIVER_NEOM8N, line.millis);
+        if (monitor.health() & GPS_HEALTH_NO_SOLUTION) ++noSolution;
+
+        double errorH = 0.;
+        if (line.haveTruth && monitor.valid()) errorH = metersApart(line.truthLat, line.truthLon, monitor.lat(), monitor.lon());
+        if (line.haveTruth && !(monitor.health() & GPS_HEALTH_NO_SOLUTION)) {
+            solutionH.add(errorH);
+            solutionV.add(monitor.ele() - line.truthEle);
+            const ALTAIR_GPSFix& neo = line.fixes[GPS_RECEIVER_NEOM8N];
+            if (neo.age != GPS_NO_FIX_AGE) {
+                primaryH.add(metersApart(line.truthLat, line.truthLon, neo.lat, neo.lon));
+                primaryV.add(neo.ele - line.truthEle);
+            }
+        }
+
+        for (size_t e = 0; e < events.size(); ++e) {
+            Event& event = events[e];
+            bool   flagged = (monitor.faults(event.receiver) & event.fault) != 0;
+            double since   = (line.millis - trace[event.begin].millis) / 1000.;
+            if (i >= event.begin && i < event.end) {
+                if (flagged && event.detected < 0.) event.detected = since;
+                if (!(monitor.health() & GPS_HEALTH_NO_SOLUTION) && errorH > event.worst) event.worst = errorH;
+            }
+            if (i >= event.end && event.cleared < 0. && !monitor.faults(event.receiver)) {
+                event.cleared = (event.end < trace.size()) ? (line.millis - trace[event.end].millis) / 1000. : 0.;
+            }
+        }
+
+        if (!line.haveInjected) continue;
+        ++checked;
+        for (uint8_t r = 0; r < GPS_NUM_RECEIVERS; ++r) {
+            if (GPS_HEALTH_FAULTS(line.injected, r)) { lastInjected[r] = line.millis;  everInjected[r] = true;  continue; }
+            bool recovering = everInjected[r] && line.millis - lastInjected[r] < 1000UL * RECOVERY_SECONDS;
+            if (monitor.faults(r) && !recovering) ++falseAlarms;
+        }
+    }
+
+    const ALTAIR_GPSMonitorStats* stats = monitor.stats();
+    printf("Updates / blended / single / none: %lu / %lu / %lu / %lu\n", stats->updates, stats->blended, stats->single, stats->noSolution);
+    printf("Disagreements / jumps / frozen / stale: %lu / %lu / %lu / %lu\n\n", stats->disagreements, stats->jumps, stats->frozen, stats->stale);
+
+    bool ok = true;
+    if (!events.empty()) {
+        printf("Injected fault            at (s)   for (s)   flagged after (s)   cleared after (s)   worst solution error (m)\n");
+        for (size_t e = 0; e < events.size(); ++e) {
+            const Event& event = events[e];
+            char         name[32];
+            snprintf(name, sizeof(name), "%s %s", receiverName(event.receiver), faultName(event.fault));
+            double at  = trace[event.begin].millis / 1000.;
+            double dur = ((event.end < trace.size() ? trace[event.end].millis : trace.back().millis + POLL_MILLIS) - trace[event.begin].millis) / 1000.;
+            printf("  %-20s %8.0f %9.0f %15.1f %19.1f %22.1f\n", name, at, dur, event.detected, event.cleared, event.worst);
+            if (event.detected < 0. || event.detected > detectLimit(event.fault)) ok = false;   // (flagged, in time)
+            if (event.end < trace.size() && (event.cleared < 0. || event.cleared > RECOVERY_SECONDS)) ok = false;   // (and cleared, once it is over)
+        }
+        printf("\nFalse alarms: %ld of %ld polls   (no solution: %ld polls)\n\n", falseAlarms, checked, noSolution);
+        if (falseAlarms)                                                ok = false;
+    }
+
+    if (solutionH.n == 0) {
+        printf("(No truth in the trace, so no accuracy.)\n");
+        printf("\n%s\n", ok ? "PASS" : "FAIL");
+        return ok ? 0 : 1;
+    }
+    printf("Error (m), while there is a solution         RMS      worst\n");
+    printf("  solution      horizontal            %9.1f  %9.1f\n", solutionH.rms(), solutionH.worst);
+    printf("                elevation             %9.1f  %9.1f\n", solutionV.rms(), solutionV.worst);
+    printf("  NEO-M8N alone horizontal            %9.1f  %9.1f\n", primaryH.rms(),  primaryH.worst);
+    printf("                elevation             %9.1f  %9.1f\n", primaryV.rms(),  primaryV.worst);
+    if (solutionH.rms() >= primaryH.rms() || solutionV.rms() >= primaryV.rms()) ok = false;   // (better than the primary alone)
+    if (solutionH.worst > GPS_DIVERGE_METERS)                                   ok = false;   // (and no faulty receiver ever drags it far off)
+    if (solutionV.worst > GPS_DIVERGE_ELE_METERS)                               ok = false;
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRLinkRateSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the three telemetry links, each paced by its own
+    ALTAIR_LinkRateController (the very same class as in the flight code),
+    against the old fixed schedule (the status to the primary radio every
+    1000 ms, and just the station name to the backup radios every 1333
+    ms).  Each radio is modelled as a transmit queue that drains at its
+    link's throughput (and is busy, or backlogged, as the real radio would
+    be), and the sends are polled as the sketch's radio tasks do.  The
+    frames are keyframes every 10th time, and deltas (of a spread of
+    lengths, as measured by tools/ALTAIRDeltaDownlinkSim.cpp) in between.
+
+    For each link it reports the content, the frames per second and the
+    utilization, and checks that:
+
+      - no link is driven beyond its target load, nor its queue beyond
+        what it can hold;
+      - the DNT900 sends full content at its minimum interval;
+      - the SHX144 sends reduced content, and uses most of its share;
+      - every link sends more frames than with the old fixed schedule.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRLinkRateSim ALTAIRLinkRateSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_LinkRateController.cpp
+
+    To use:
+
+      ALTAIRLinkRateSim [seconds]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+
+#include "ALTAIR_TelemetryFrames.h"
+#include "ALTAIR_TelemetryDelta.h"
+#include "ALTAIR_LinkRateController.h"
+
+typedef  ALTAIR_AllInfoFrame1  F1;
+typedef  ALTAIR_AllInfoFrame2  F2;
+
+// As in ALTAIR_TelemetrySystem.cpp (and the radios' headers, which depend upon the Arduino libraries).
+#define  NUM_RADIOS                3
+#define  RADIO_POLL_INTERVAL     250            // = radioPollInterval in ALTAIROperation.ino
+#define  CALL_SIGN_BYTES          29            // " VE7XJA STATION ALTAIR " and " OVER "
+#define  DNT_TX_QUEUE_SIZE       256
+#define  DNT_TX_BACKLOG_THRESHOLD (3 * FRAME_HEADER_LENGTH + F1::length + F2::length + ALTAIR_PropulsionFrame::length)
+#define  FULL_SEND_BYTES         (2 * FRAME_HEADER_LENGTH + F1::length + F2::length)
+
+static const char*             radioNames[NUM_RADIOS]  = { "DNT900", "SHX144", "RFM23BP" };
+static const ALTAIR_LinkConfig linkConfigs[NUM_RADIOS] = {
+    { 38400 / 10 ,  0 , 50 ,  250 },
+    {  1200 / 10 ,  0 , 60 ,  500 },
+    {  2400 / 8  , 13 , 25 , 1000 },
+};
+
+/**************************************************************************/
+/*!
+    A radio: its transmit queue, which drains at the link's throughput,
+    and its frames, as keyframes and deltas.
+*/
+/**************************************************************************/
+struct Radio {
+    int                        index;
+    bool                       primary;
+    bool                       reduced;
+    ALTAIR_LinkRateController  link;
+    double                     queue;                                       // bytes waiting to go out on the air
+    double                     maxQueue;
+    uint8_t                    sinceKey[2];
+    bool                       sentFrame1;
+    unsigned long              frames, bytes;
+
+    bool busy() const {
+        if (index == 0) return DNT_TX_QUEUE_SIZE - queue < DNT_TX_BACKLOG_THRESHOLD;        // (txBacklogged)
+        return queue > 0.;                                                                  // (the SHX144's busy line, or the RFM23BP still sending)
+    }
+    uint16_t frameBytes( int type , std::mt19937& random ) {
+        uint8_t& since = sinceKey[type];
+        since = (since + 1) % DEFAULT_DELTA_KEYFRAME_INTERVAL;
+        if (since == 0) return FRAME_HEADER_LENGTH + ((type == 0) ? (int) F1::length : (int) F2::length);
+        return FRAME_HEADER_LENGTH + 16 + random() % 10;
+    }
+};
+
+struct Result { double framesPerSecond[NUM_RADIOS], utilization[NUM_RADIOS], maxQueue[NUM_RADIOS]; uint8_t content[NUM_RADIOS]; unsigned long busy[NUM_RADIOS]; };
+
+static Result simulate( long seconds , bool controlled , std::mt19937& random ) {
+    Radio         radios[NUM_RADIOS];
+    unsigned long nextPoll[NUM_RADIOS];
+    for (int r = 0; r < NUM_RADIOS; ++r) {
+        Radio& radio = radios[r];
+        radio.index = r; radio.primary = (r == 0); radio.queue = radio.maxQueue = 0.;
+        radio.sinceKey[0] = radio.sinceKey[1] = DEFAULT_DELTA_KEYFRAME_INTERVAL - 1;
+        radio.sentFrame1 = false; radio.frames = radio.bytes = 0;
+        radio.link.configure(linkConfigs[r], FULL_SEND_BYTES);
+        radio.reduced = (r == 2) || (radio.link.content() == LINK_CONTENT_REDUCED);
+        nextPoll[r] = 0;
+    }
+    for (unsigned long now = 0; now < (unsigned long) seconds * 1000; ++now) {
+        for (int r = 0; r < NUM_RADIOS; ++r) {
+            Radio& radio = radios[r];
+            radio.queue -= linkConfigs[r].bytesPerSecond / 1000.;
+            if (radio.queue < 0.) radio.queue = 0.;
+            if (now < nextPoll[r]) continue;
+
+            uint16_t bytes = 0;
+            uint8_t  frames = 0;
+            if (controlled) {
+                unsigned long wait = radio.link.millisUntilDue(now, radio.busy());
+                if (wait > 0) { nextPoll[r] = now + wait; continue; }
+                bool sendFrame1 = true;
+                if (radio.reduced) { sendFrame1 = !radio.sentFrame1; radio.sentFrame1 = sendFrame1; }
+                if (sendFrame1)                    { bytes += radio.frameBytes(0, random); ++frames; }
+                if (!sendFrame1 || !radio.reduced) { bytes += radio.frameBytes(1, random); ++frames; }
+                if (!radio.primary && r != 0) bytes += CALL_SIGN_BYTES;
+                radio.link.sent(now, bytes, frames);
+                nextPoll[r] = now + RADIO_POLL_INTERVAL;
+            } else if (radio.primary) {                                     // the old schedule: all the status, every 1000 ms
+                if (radio.busy()) { nextPoll[r] = now + 50; continue; }
+                bytes  = radio.frameBytes(0, random) + radio.frameBytes(1, random);
+                frames = 2;
+                nextPoll[r] = now + 1000;
+            } else {                                                        // ... and just the station name, every 1333 ms
+                bytes  = (r != 0) ? CALL_SIGN_BYTES : 0;
+                nextPoll[r] = now + 1333;
+            }
+            double onAir  = bytes + frames * linkConfigs[r].frameOverhead;
+            radio.queue  += onAir;
+            radio.frames += frames;
+            radio.bytes  += (unsigned long) onAir;
+            if (radio.queue > radio.maxQueue) radio.maxQueue = radio.queue;
+        }
+    }
+    Result result;
+    for (int r = 0; r < NUM_RADIOS; ++r) {
+        result.framesPerSecond[r] = (double) radios[r].frames / seconds;
+        result.utilization[r]     = (double) radios[r].bytes / seconds / linkConfigs[r].bytesPerSecond;
+        result.maxQueue[r]        = radios[r].maxQueue;
+        result.content[r]         = radios[r].link.content();
+        result.busy[r]            = radios[r].link.stats()->busyDeferrals;
+    }
+    return result;
+}
+
+int main( int argc , char** argv )
+{
+    long         seconds = (argc > 1) ? atol(argv[1]) : 600;
+    std::mt19937 random(17102026);
+    bool         ok      = true;
+
+    Result before = simulate(seconds, false, random);
+    Result after  = simulate(seconds, true,  random);
+
+    printf("%ld seconds, with the DNT900 as the primary radio:\n\n", seconds);
+    printf("  %-8s  %9s  %8s  %15s  %15s  %12s  %14s  %14s\n", "radio", "bytes/s", "content", "fixed frames/s", "fixed use", "frames/s", "use (target)", "busy deferrals");
+    for (int r = 0; r < NUM_RADIOS; ++r) {
+        bool reduced = (r == 2) || (after.content[r] == LINK_CONTENT_REDUCED);
+        printf("  %-8s  %9d  %8s  %15.2f  %14.1f%%  %12.2f  %7.1f%% (%2d)  %14lu\n", radioNames[r], linkConfigs[r].bytesPerSecond, reduced ? "reduced" : "full",
+               before.framesPerSecond[r], 100. * before.utilization[r], after.framesPerSecond[r], 100. * after.utilization[r], linkConfigs[r].loadPercent, after.busy[r]);
+        if (after.utilization[r] > linkConfigs[r].loadPercent / 100. + 0.01)                    { printf("  %s is over its target load!\n", radioNames[r]);   ok = false; }
+        if (r == 0 ? after.maxQueue[r] > DNT_TX_QUEUE_SIZE : after.maxQueue[r] > FULL_SEND_BYTES + 2 * CALL_SIGN_BYTES) { printf("  %s's queue grew too long!\n", radioNames[r]); ok = false; }
+        if (after.framesPerSecond[r] <= before.framesPerSecond[r])                              { printf("  %s sends no more than before!\n", radioNames[r]); ok = false; }
+    }
+    if (after.content[0] != LINK_CONTENT_FULL || after.framesPerSecond[0] < 0.95 * 2. * 1000. / linkConfigs[0].minIntervalMillis) ok = false;
+    if (after.content[1] != LINK_CONTENT_REDUCED || after.utilization[1] < 0.75 * linkConfigs[1].loadPercent / 100.)              ok = false;
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRMicroRegisterMapSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) model of both
+    ends of the Arduino Micro's I2C link: the Micro's register map (the very
+    same ALTAIR_MicroRegisterMap that the Micro runs) as a simulated I2C
+    device on the HAL's simulated bus, read by the Mega's very same
+    ALTAIR_ArduinoMicro.  The previous arrangement (the Micro's I2C
+    interrupt sending the arrays that loop() was part-way through writing,
+    and the Mega reading 16 bytes blindly) is modelled alongside it.
+
+    It checks:
+
+      - torn reads: each snapshot that the Micro's loop() writes has all 16
+        bytes the same, so a read with mixed bytes was torn (and likewise
+        for the 12 words of the extended block, which must also be of the
+        same snapshot as the packed bytes read just before them);
+      - bus faults: bit flips, short reads, and the Micro resetting (and
+        losing the selected register), none of which may be accepted;
+      - freshness: the age that the Mega works out, against the truth;
+      - the bytes on the bus, per read and per second, for each way of
+        reading the data.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_MicroRegisterMap -I../libraries/ALTAIR_Devices -o ALTAIRMicroRegisterMapSim ALTAIRMicroRegisterMapSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_ArduinoMicro.cpp ../libraries/ALTAIR_HAL/ALTAIR_HAL_Linux.cpp
+
+    To use:
+
+      ALTAIRMicroRegisterMapSim [# of reads]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+#include "ALTAIR_HALSim.h"
+#include "ALTAIR_ArduinoMicro.h"
+
+#define  READ_INTERVAL_MILLIS         450           // as scheduled in ALTAIROperation.ino
+#define  MICRO_LOOP_MILLIS              3           // the Micro's loop() (12 analogReads, the RPMs, and packing)
+
+/**************************************************************************/
+/*!
+    The simulated Micro.  Its loop() writes the 16 packed bytes of each new
+    snapshot one at a time, and a read can arrive after any of them.  (In
+    the sketch, the packed currents, temps and RPMs are each written as
+    soon as they are measured, i.e. spread across the whole of loop(), so
+    a read at a random time mostly finds a mixture.)
+*/
+/**************************************************************************/
+class SimMicro : public ALTAIR_HALSimI2CDevice {
+  public:
+    SimMicro( bool previousFirmware , std::mt19937& random ) :
+        flipChance(0.), shortChance(0.), resetChance(0.),
+        _previous(previousFirmware), _random(random), _generation(0), _written(MICRO_SNAPSHOT_COMPACT_LENGTH), _publishedMillis(0), _publishedGeneration(0) { memset(_packed, 0, sizeof(_packed)); }
+
+// loop(): write some of the next snapshot's bytes (16 finishes it, and publishes it).
+    void loopWrites( uint8_t numBytes ) {
+        for (uint8_t i = 0; i < numBytes; ++i) {
+            if (_written == MICRO_SNAPSHOT_COMPACT_LENGTH) { ++_generation; _written = 0; }
+            _packed[_written++] = (byte) _generation;
+            if (_written == MICRO_SNAPSHOT_COMPACT_LENGTH && !_previous) {
+                uint16_t rpm[4];
+                int16_t  current[4], temp[8];
+                for (uint8_t j = 0; j < 4; ++j) rpm[j] = current[j] = (int16_t) (_generation * 61);     // (the extended block of each snapshot
+                for (uint8_t j = 0; j < 8; ++j) temp[j]             = (int16_t) (_generation * 61);     //    is likewise all the same)
+                _map.publish(_packed + MICRO_SNAPSHOT_RPM, _packed + MICRO_SNAPSHOT_CURRENT, _packed + MICRO_SNAPSHOT_TEMP,
+                             rpm, current, temp, ALTAIR_HAL::clockMillis());
+                _publishedMillis = ALTAIR_HAL::clockMillis();
+                _publishedGeneration = _generation;
+            }
+        }
+    }
+    uint8_t       generation(     ) { return (uint8_t) (_written == MICRO_SNAPSHOT_COMPACT_LENGTH ? _generation : _generation - 1); }
+    unsigned long publishedMillis() { return _publishedMillis; }
+    unsigned long publishedGeneration() { return _publishedGeneration; }
+
+    virtual bool i2cWrite( const uint8_t* bytes , uint8_t numBytes ) {
+        if (numBytes > 0 && !_previous) _map.select(bytes[0]);
+        return true;
+    }
+    virtual uint8_t i2cRead( uint8_t* bytes , uint8_t numBytes ) {
+        std::uniform_real_distribution<double> chance(0., 1.);
+        if (chance(_random) < resetChance) _map.select(MICRO_REG_LEGACY);          // (what a reset does to the selection)
+        byte    response[MICRO_REGMAP_MAX_RESPONSE];
+        uint8_t length;
+        if (_previous) { memcpy(response, _packed, MICRO_SNAPSHOT_COMPACT_LENGTH); length = MICRO_SNAPSHOT_COMPACT_LENGTH; }
+        else           length = _map.respond(response, ALTAIR_HAL::clockMillis());
+        for (uint8_t i = 0; i < numBytes; ++i) bytes[i] = (i < length) ? response[i] : 0xFF;   // (as the master sees an idle bus)
+        if (chance(_random) < flipChance) bytes[_random() % numBytes] ^= (byte) (1 << (_random() % 8));
+        if (chance(_random) < shortChance) return _random() % numBytes;
+        return numBytes;
+    }
+
+    double        flipChance, shortChance, resetChance;
+
+  private:
+    bool                     _previous;
+    std::mt19937&            _random;
+    ALTAIR_MicroRegisterMap  _map;
+    unsigned long            _generation;
+    uint8_t                  _written;
+    byte                     _packed[MICRO_SNAPSHOT_COMPACT_LENGTH];
+    unsigned long            _publishedMillis;
+    unsigned long            _publishedGeneration;
+};
+
+static bool consistent( const byte* data , uint8_t length ) {
+    for (uint8_t i = 1; i < length; ++i) if (data[i] != data[0]) return false;
+    return true;
+}
+
+struct Result {
+    Result() : reads(0), accepted(0), torn(0), wrong(0), rejected(0), maxAgeError(0), extended(0), tornExtended(0) {}
+    long reads, accepted, torn, wrong, rejected, maxAgeError, extended, tornExtended;
+};
+
+// The extended block read just after the packed bytes: all 12 words must be those of the snapshot published then.
+static bool extendedConsistent( ALTAIR_ArduinoMicro& mega , SimMicro& micro ) {
+    uint16_t expected = (uint16_t) (micro.publishedGeneration() * 61);
+    for (uint8_t i = 0; i < 4; ++i) if (mega.extendedRPM(i) != expected || (uint16_t) mega.extendedCurrent(i) != expected) return false;
+    for (uint8_t i = 0; i < 8; ++i) if ((uint16_t) mega.extendedTemp(i) != expected) return false;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+    Run a number of reads against a Micro whose loop() is at a random
+    point in writing a snapshot each time.
+*/
+/**************************************************************************/
+static Result run( bool previousFirmware , long numReads , double flipChance , double shortChance , double resetChance , std::mt19937& random ) {
+    ALTAIR_HALSim::reset();
+    SimMicro micro(previousFirmware, random);
+    micro.flipChance  = flipChance;
+    micro.shortChance = shortChance;
+    micro.resetChance = resetChance;
+    ALTAIR_HALSim::attachI2C(ARDUINOMICRO_I2CADDRESS, &micro);
+    ALTAIR_ArduinoMicro mega;
+    Result result;
+    for (long r = 0; r < numReads; ++r) {
+        micro.loopWrites(MICRO_SNAPSHOT_COMPACT_LENGTH - 1);                       // (finishing one snapshot, and part-way into the next)
+        micro.loopWrites(1 + random() % MICRO_SNAPSHOT_COMPACT_LENGTH);
+        ALTAIR_HALSim::advanceMicros(1000ULL * (random() % MICRO_LOOP_MILLIS));
+        ++result.reads;
+        byte got[MICRO_SNAPSHOT_COMPACT_LENGTH];
+        if (previousFirmware) {
+            ALTAIR_HAL::i2cRead(ARDUINOMICRO_I2CADDRESS, got, MICRO_SNAPSHOT_COMPACT_LENGTH);   // (the previous getData(): no checks)
+        } else {
+            if (!mega.readRegister(MICRO_REG_ALL)) { ++result.rejected; continue; }
+            memcpy(got,     mega.packedRPM(),     4);
+            memcpy(got + 4, mega.packedCurrent(), 4);
+            memcpy(got + 8, mega.packedTemp(),    8);
+            long ageError = labs((long) mega.dataAgeMillis() - (long) (ALTAIR_HAL::clockMillis() - micro.publishedMillis()));
+            if (ageError > result.maxAgeError) result.maxAgeError = ageError;
+            if (mega.readRegister(MICRO_REG_EXT_PROPULSION) && mega.readRegister(MICRO_REG_EXT_TEMP)) {
+                ++result.extended;
+                if (!extendedConsistent(mega, micro)) ++result.tornExtended;
+            }
+        }
+        ++result.accepted;
+        if (!consistent(got, MICRO_SNAPSHOT_COMPACT_LENGTH)) ++result.torn;
+        else if (got[0] != micro.generation() && got[0] != (byte) (micro.generation() - 1)) ++result.wrong;
+        ALTAIR_HALSim::advanceMicros(1000ULL * READ_INTERVAL_MILLIS);
+    }
+    return result;
+}
+
+/**************************************************************************/
+/*!
+    The bus bytes per read, for reading the data in different ways.
+*/
+/**************************************************************************/
+static double busBytesPerRead( bool previousFirmware , const uint8_t* registers , uint8_t numRegisters , long numReads , std::mt19937& random ) {
+    ALTAIR_HALSim::reset();
+    SimMicro micro(previousFirmware, random);
+    ALTAIR_HALSim::attachI2C(ARDUINOMICRO_I2CADDRESS, &micro);
+    micro.loopWrites(MICRO_SNAPSHOT_COMPACT_LENGTH);
+    ALTAIR_ArduinoMicro mega;
+    byte got[MICRO_SNAPSHOT_COMPACT_LENGTH];
+    for (long r = 0; r < numReads; ++r) {
+        if (previousFirmware) ALTAIR_HAL::i2cRead(ARDUINOMICRO_I2CADDRESS, got, MICRO_SNAPSHOT_COMPACT_LENGTH);
+        else                  mega.readRegister(registers[r % numRegisters]);
+    }
+    return (double) ALTAIR_HALSim::stats()->i2cBytes / numReads;
+}
+
+int main( int argc , char** argv )
+{
+    long         numReads = (argc > 1) ? atol(argv[1]) : 100000;
+    std::mt19937 random(17102026);
+    bool         ok = true;
+
+    printf("%ld reads, each at a random point in the Micro's loop()\n\n", numReads);
+    printf("                                      accepted    torn   wrong  rejected  max age error\n");
+    struct { const char* name; bool previous; double flip, shortRead, reset; } cases[] = {
+        { "previous, clean bus",              true,  0.,   0.,    0.    },
+        { "register map, clean bus",          false, 0.,   0.,    0.    },
+        { "previous, faulty bus",             true,  0.02, 0.,    0.    },
+        { "register map, faulty bus",         false, 0.02, 0.005, 0.005 },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        Result r = run(cases[c].previous, numReads, cases[c].flip, cases[c].shortRead, cases[c].reset, random);
+        printf("  %-32s  %9ld  %6ld  %6ld  %8ld", cases[c].name, r.accepted, r.torn, r.wrong, r.rejected);
+        if (cases[c].previous) printf("      (no age)\n");
+        else                   printf("  %10ld ms\n", r.maxAgeError);
+        if (!cases[c].previous) printf("  %-32s  %9ld  %6ld   (the extended block, read just after)\n", "", r.extended, r.tornExtended);
+        if (!cases[c].previous && (r.torn > 0 || r.wrong > 0 || r.tornExtended > 0 || r.maxAgeError > 1)) ok = false;
+    }
+
+    const uint8_t all[]        = { MICRO_REG_ALL };
+    const uint8_t rpm[]        = { MICRO_REG_RPM };
+    const uint8_t propulsion[] = { MICRO_REG_PROPULSION };
+    const uint8_t extended[]   = { MICRO_REG_ALL, MICRO_REG_EXT_PROPULSION, MICRO_REG_EXT_TEMP };
+    uint8_t       slowTemps[10];                                        // (the temps only every 10th read)
+    for (uint8_t i = 0; i < 10; ++i) slowTemps[i] = (i == 9) ? MICRO_REG_TEMP : MICRO_REG_PROPULSION;
+    struct { const char* name; bool previous; const uint8_t* registers; uint8_t numRegisters; uint8_t readsPerUpdate; } ways[] = {
+        { "previous: 16 bare bytes",                      true,  all,        1,  1 },
+        { "register map: everything",                     false, all,        1,  1 },
+        { "register map: everything, and extended",       false, extended,   3,  3 },
+        { "register map: RPMs and currents, temps 1/10",  false, slowTemps,  10, 1 },
+        { "register map: RPMs and currents only",         false, propulsion, 1,  1 },
+        { "register map: RPMs only",                      false, rpm,        1,  1 },
+    };
+    printf("\nI2C bus bytes (including address bytes), updating every %d ms:\n", READ_INTERVAL_MILLIS);
+    for (size_t w = 0; w < sizeof(ways) / sizeof(ways[0]); ++w) {
+        double perRead = busBytesPerRead(ways[w].previous, ways[w].registers, ways[w].numRegisters, 9999, random) * ways[w].readsPerUpdate;
+        printf("  %-46s  %5.1f per update  %6.1f per second\n", ways[w].name, perRead, perRead * 1000. / READ_INTERVAL_MILLIS);
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
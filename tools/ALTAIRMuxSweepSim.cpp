@@ -0,0 +1,319 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRMuxSweepSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) model of the I2C
+    bus with the TCA9548A multiplexer on it: the main bus, and the eight
+    channels behind the multiplexer, each with their own devices, on the
+    HAL's simulated I2C bus.  An address is answered by every device at it
+    that can be reached (those on the main bus, and those behind each
+    channel that is selected), so a transaction with the wrong channel
+    selected either reaches no device, or two at once (a collision).
+
+    The very same ALTAIR_BME280s, ALTAIR_TCA9548A, and ALTAIR_I2CBus as in
+    the flight code run sweeps of samples, in each of three ways:
+
+      - previously: each sample behind the multiplexer bracketed by
+        selecting its channel and then deselecting it again, writing to
+        the multiplexer every time;
+      - remembering the selected channel, but with the samples run in the
+        order queued (selecting each one's channel first);
+      - the bus manager, which also groups the samples by channel.
+
+    and counts the multiplexer writes (and their bus time) per sweep, for
+    ALTAIR's own sweep (the nav mast, balloon valve, and gondola BME280s),
+    and for a larger one (with two more BME280s, on two more channels,
+    queued interleaved).  It checks that no sample reaches the wrong
+    device, and that a multiplexer write that is not acknowledged is
+    recovered from (with the samples that needed it not being run).
+
+    (As wired, the nav mast's BME280, on the main bus, has the same
+    address as the gondola's, behind channel 0: the main bus is always
+    connected, so it answers too whenever channel 0 is selected.  These
+    collisions are the same whichever way the samples are run, and are
+    reported separately.)
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_Devices -o ALTAIRMuxSweepSim ALTAIRMuxSweepSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_I2CBus.cpp ../libraries/ALTAIR_Devices/ALTAIR_TCA9548A.cpp ../libraries/ALTAIR_Devices/ALTAIR_BME280.cpp ../libraries/ALTAIR_HAL/ALTAIR_HAL_Linux.cpp
+
+    To use:
+
+      ALTAIRMuxSweepSim [# of sweeps]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ALTAIR_HALSim.h"
+#include "ALTAIR_TCA9548A.h"
+#include "ALTAIR_I2CBus.h"
+#include "ALTAIR_BME280.h"
+
+#define  MAX_SIM_DEVICES             8
+#define  MAX_SWEEP                   8
+
+/**************************************************************************/
+/*!
+    A simulated BME280 (just enough of its registers for begin() and
+    sample()), which counts the samples that reach it.
+*/
+/**************************************************************************/
+class SimBME280 {
+  public:
+    SimBME280() : samples(0), _pointer(0) {
+        memset(_registers, 0, sizeof(_registers));
+        _registers[BME280_REG_CHIP_ID] = BME280_CHIP_ID;
+        _registers[BME280_REG_DATA]    = 0x50;                   // (a measurement: not the skipped markers)
+        _registers[BME280_REG_DATA + 3] = 0x7F;
+        _registers[BME280_REG_DATA + 6] = 0x60;
+    }
+    bool write( const uint8_t* bytes , uint8_t numBytes ) {
+        if (numBytes == 0) return true;
+        _pointer = bytes[0];
+        for (uint8_t i = 1; i < numBytes; ++i) {
+            if (_pointer != BME280_REG_RESET) _registers[_pointer] = bytes[i];
+            ++_pointer;
+        }
+        return true;
+    }
+    uint8_t read( uint8_t* bytes , uint8_t numBytes ) {
+        if (_pointer == BME280_REG_DATA) ++samples;
+        for (uint8_t i = 0; i < numBytes; ++i) bytes[i] = _registers[_pointer++];
+        return numBytes;
+    }
+
+    unsigned long samples;
+
+  private:
+    uint8_t _registers[256];
+    uint8_t _pointer;
+};
+
+/**************************************************************************/
+/*!
+    The multiplexer: it counts the writes, and remembers the channels
+    selected.  (It can be made to not acknowledge, as if it had browned
+    out.)
+*/
+/**************************************************************************/
+class SimMux : public ALTAIR_HALSimI2CDevice {
+  public:
+    SimMux() : channels(0), writes(0), dead(false) {}
+    virtual bool i2cWrite( const uint8_t* bytes , uint8_t numBytes ) {
+        if (dead || numBytes != 1) return false;
+        channels = bytes[0];
+        ++writes;
+        return true;
+    }
+    virtual uint8_t i2cRead( uint8_t* bytes , uint8_t numBytes ) {
+        if (dead || numBytes == 0) return 0;
+        bytes[0] = channels;
+        return 1;
+    }
+
+    uint8_t       channels;
+    unsigned long writes;
+    bool          dead;
+};
+
+static SimMux mux;
+
+/**************************************************************************/
+/*!
+    One address on the bus: the devices at it, each either on the main bus
+    (channel -1) or behind one of the multiplexer's channels.  A
+    transaction goes to every device that can be reached (the main bus
+    being always connected, upstream of the multiplexer); if more than one
+    can be, they all answer at once (the bytes read being the wired-AND of
+    theirs), and it is counted as a collision.
+*/
+/**************************************************************************/
+class SimAddress : public ALTAIR_HALSimI2CDevice {
+  public:
+    SimAddress() : unreached(0), collisions(0), _count(0) {}
+    void add( SimBME280* device , int8_t channel ) { _devices[_count] = device; _channels[_count] = channel; ++_count; }
+
+    virtual bool i2cWrite( const uint8_t* bytes , uint8_t numBytes ) {
+        uint8_t found = 0;
+        for (uint8_t i = 0; i < _count; ++i) {
+            if (reachable(i)) { _devices[i]->write(bytes, numBytes); ++found; }
+        }
+        return counted(found);
+    }
+    virtual uint8_t i2cRead( uint8_t* bytes , uint8_t numBytes ) {
+        uint8_t found = 0, answer[32];
+        memset(bytes, 0xFF, numBytes);
+        for (uint8_t i = 0; i < _count; ++i) {
+            if (!reachable(i)) continue;
+            _devices[i]->read(answer, numBytes);
+            for (uint8_t j = 0; j < numBytes; ++j) bytes[j] &= answer[j];
+            ++found;
+        }
+        return counted(found) ? numBytes : 0;
+    }
+
+    unsigned long unreached, collisions;
+
+  private:
+    bool reachable( uint8_t i ) { return _channels[i] < 0 || (mux.channels & (1 << _channels[i])); }
+    bool counted( uint8_t found ) {
+        if (found == 0) ++unreached;
+        if (found >  1) ++collisions;
+        return found > 0;
+    }
+
+    SimBME280* _devices[MAX_SIM_DEVICES];
+    int8_t     _channels[MAX_SIM_DEVICES];
+    uint8_t    _count;
+};
+
+/**************************************************************************/
+/*!
+    A sweep: the sensors, in the order queued, with the channel each needs.
+*/
+/**************************************************************************/
+struct Sweep {
+    const char*     name;
+    uint8_t         count;
+    ALTAIR_BME280*  sensors[MAX_SWEEP];
+    char            channels[MAX_SWEEP];
+    SimBME280*      sims[MAX_SWEEP];
+};
+
+enum Way { PREVIOUSLY, REMEMBERED, GROUPED };
+static const char* wayNames[] = { "previously (select, and deselect, every time)",
+                                  "remembering the channel, in the order queued",
+                                  "the bus manager (grouped by channel)" };
+
+static void runSweep( Sweep& sweep , Way way , ALTAIR_I2CBus& bus )
+{
+    if (way == GROUPED) {
+        for (uint8_t i = 0; i < sweep.count; ++i) bus.queue(sweep.sensors[i], sweep.channels[i]);
+        bus.runQueued();
+        return;
+    }
+    for (uint8_t i = 0; i < sweep.count; ++i) {
+        char channel = sweep.channels[i];
+        if (way == PREVIOUSLY) {
+            uint8_t select = (channel >= 0) ? (1 << channel) : 0, deselect = 0;
+            if (channel >= 0) ALTAIR_HAL::i2cWrite(TCA9548A_I2CADDRESS, &select, 1);
+            sweep.sensors[i]->sample();
+            if (channel >= 0) ALTAIR_HAL::i2cWrite(TCA9548A_I2CADDRESS, &deselect, 1);
+        } else {
+            if (channel != TCA9548A_ANYCHANNEL) ALTAIR_TCA9548A::tcaselect(channel);
+            sweep.sensors[i]->sample();
+        }
+    }
+}
+
+int main( int argc , char** argv )
+{
+    long numSweeps = (argc > 1) ? atol(argv[1]) : 1000;
+    bool ok        = true;
+
+    ALTAIR_HALSim::reset();
+    SimBME280  mast, balloon, gondola, extra1, extra2;
+    SimAddress at77, at76;
+    at77.add(&mast,    -1);
+    at77.add(&gondola,  0);
+    at77.add(&extra1,   1);
+    at77.add(&extra2,   2);
+    at76.add(&balloon, -1);
+    ALTAIR_HALSim::attachI2C(TCA9548A_I2CADDRESS,   &mux);
+    ALTAIR_HALSim::attachI2C(BME280_I2CADDRESS,     &at77);
+    ALTAIR_HALSim::attachI2C(BME280_I2CADDRESS_ALT, &at76);
+
+    ALTAIR_BME280 bmeMast, bmeBalloon, bmeGondola, bmeExtra1, bmeExtra2;
+    bool begun = true;
+    ALTAIR_TCA9548A::tcaselect(TCA9548A_EVERYTHINGELSE);
+    begun &= bmeMast.begin();
+    begun &= bmeBalloon.begin(BME280_I2CADDRESS_ALT);
+    ALTAIR_TCA9548A::tcaselect(0);  begun &= bmeGondola.begin();
+    ALTAIR_TCA9548A::tcaselect(1);  begun &= bmeExtra1.begin();
+    ALTAIR_TCA9548A::tcaselect(2);  begun &= bmeExtra2.begin();
+    ALTAIR_TCA9548A::tcaselect(TCA9548A_EVERYTHINGELSE);
+    if (!begun) { printf("begin() failed\n"); ok = false; }
+
+    Sweep altair = { "ALTAIR's sweep (nav mast, balloon valve, gondola)", 3,
+                     { &bmeMast, &bmeBalloon, &bmeGondola },
+                     { TCA9548A_EVERYTHINGELSE, TCA9548A_ANYCHANNEL, TCA9548A_BME280PAYLOAD },
+                     { &mast, &balloon, &gondola } };
+    Sweep larger = { "a larger sweep (two more BME280s, on channels 1 and 2, queued interleaved)", 5,
+                     { &bmeGondola, &bmeMast, &bmeExtra1, &bmeBalloon, &bmeExtra2 },
+                     { 0, TCA9548A_EVERYTHINGELSE, 1, TCA9548A_ANYCHANNEL, 2 },
+                     { &gondola, &mast, &extra1, &balloon, &extra2 } };
+    Sweep* sweeps[] = { &altair, &larger };
+
+    for (int s = 0; s < 2; ++s) {
+        Sweep&  sweep  = *sweeps[s];
+        uint8_t behind = 0;
+        for (uint8_t i = 0; i < sweep.count; ++i) behind += (sweep.channels[i] >= 0);
+        printf("%s, over %ld sweeps:\n", sweep.name, numSweeps);
+        printf("  %-48s  mux writes/sweep  bus time/sweep (us)  collided samples/sweep  misrouted\n", "");
+        double writesPerSweep[3];
+        for (int way = PREVIOUSLY; way <= GROUPED; ++way) {
+            ALTAIR_I2CBus bus;
+            ALTAIR_TCA9548A::tcaselect(TCA9548A_EVERYTHINGELSE);
+            unsigned long before[MAX_SWEEP];
+            for (uint8_t i = 0; i < sweep.count; ++i) before[i] = sweep.sims[i]->samples;
+            unsigned long writes     = mux.writes;
+            unsigned long unreached  = at77.unreached  + at76.unreached;
+            unsigned long collisions = at77.collisions + at76.collisions;
+            for (long n = 0; n < numSweeps; ++n) runSweep(sweep, (Way) way, bus);
+            writes     = mux.writes - writes;
+            unreached  = at77.unreached  + at76.unreached  - unreached;
+            collisions = at77.collisions + at76.collisions - collisions;
+            // (Each sample behind the multiplexer, i.e. its register address write and its read, also reaches the nav mast's
+            //    BME280, at the same address on the main bus: that is the wiring, whichever way the samples are run.  Any other
+            //    collision, or a transaction that reaches no device, was run with the wrong channel selected.)
+            unsigned long wired     = 2UL * behind * numSweeps;
+            unsigned long misrouted = unreached + ((collisions > wired) ? collisions - wired : wired - collisions);
+            bool          every     = true;
+            for (uint8_t i = 0; i < sweep.count; ++i) {
+                unsigned long expected = numSweeps + ((sweep.sims[i] == &mast) ? collisions / 2 : 0);
+                every &= (sweep.sims[i]->samples - before[i] == expected);
+            }
+            writesPerSweep[way] = (double) writes / numSweeps;
+            printf("  %-48s  %16.2f  %19.0f  %22.2f  %9lu%s\n", wayNames[way], writesPerSweep[way],
+                   writesPerSweep[way] * 2 * HAL_SIM_I2C_MICROS_PER_BYTE, (double) collisions / 2 / numSweeps, misrouted,
+                   every ? "" : "  (samples missed!)");
+            ok &= (misrouted == 0 && every);
+        }
+        printf("\n");
+        ok &= (writesPerSweep[GROUPED] <= writesPerSweep[REMEMBERED] && writesPerSweep[GROUPED] < writesPerSweep[PREVIOUSLY]);
+        if (s == 0) ok &= (writesPerSweep[GROUPED] <= 1.0);
+    }
+
+// The multiplexer not acknowledging: the samples that need a channel switch are not run (and so reach no other device).
+    ALTAIR_I2CBus bus;
+    ALTAIR_TCA9548A::tcaselect(TCA9548A_EVERYTHINGELSE);
+    unsigned long gondolaSamples = gondola.samples, balloonSamples = balloon.samples;
+    unsigned long unreached = at77.unreached, collisions = at77.collisions;
+    mux.dead = true;
+    for (int n = 0; n < 2; ++n) runSweep(altair, GROUPED, bus);
+    mux.dead = false;
+    bool skipped  = (gondola.samples == gondolaSamples && balloon.samples == balloonSamples + 2 &&
+                     ALTAIR_TCA9548A::selected() == TCA9548A_UNKNOWN && bus.stats()->failed == 3);   // (the gondola twice, and then the nav mast)
+    for (int n = 0; n < 2; ++n) runSweep(altair, GROUPED, bus);
+    bool recovers = (gondola.samples == gondolaSamples + 2 && at77.unreached == unreached && at77.collisions == collisions + 4);
+    printf("with the multiplexer not acknowledging, the samples that need it are not run: %s;  and afterwards, they are again: %s\n",
+           skipped ? "ok" : "FAILED", recovers ? "ok" : "FAILED");
+    ok &= skipped && recovers;
+
+    const ALTAIR_TCA9548AStats* stats = ALTAIR_TCA9548A::stats();
+    printf("(tcaselect: %lu writes, %lu elided, %lu not acknowledged)\n", stats->writes, stats->elided, stats->failedWrites);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
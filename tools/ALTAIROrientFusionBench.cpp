@@ -0,0 +1,261 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIROrientFusionBench.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) benchmark of the
+    orientation fusion engine (ALTAIR_OrientFusion, the very same code that
+    runs on the Mega), replaying a log of all four orientation sensors'
+    readings, at the rate that ALTAIROperation.ino fuses them.
+
+    The log is a text file, one line per update:
+
+      millis  truthYaw truthPitch truthRoll  (yaw pitch roll typeAndHealth) x 4
+
+    with the truth in degrees (or "-", if it is not known, as in a log from
+    the payload itself), and the four sensors (the BNO055, UM7, HMC6343 and
+    HMC5883L, in that order) as ALTAIR_OrientSensors::fuse() reads them.
+    If the log file given does not exist, a two-hour one is made up and
+    written to it (or, with no file given, just made up): a payload
+    swinging under the balloon and turning, with each sensor's own noise
+    and bias, the HMC5883L's heading off by the tilt, the BNO055 reporting
+    itself unhealthy (and reading nonsense) from 30 to 40 minutes in, and
+    the UM7's heading off by 90 degrees from 60 to 65 minutes in, while it
+    reports itself healthy.
+
+    It reports:
+
+      - the cost of an update, and of each reading in it (in host time);
+      - against the truth (if known): the RMS and worst error of the fused
+        yaw, pitch and roll, and of the BNO055's alone (the primary
+        sensor, which is what the telemetry used to send), over the whole
+        log and while the BNO055 is healthy; and how often the error is
+        within 2 sigma (i.e. whether the uncertainty can be trusted).
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIROrientFusionBench ALTAIROrientFusionBench.cpp ../libraries/ALTAIR_Devices/ALTAIR_OrientFusion.cpp
+
+    To use:
+
+      ALTAIROrientFusionBench [log file]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_OrientFusion.h"
+
+#define  NUM_SENSORS                    4
+#define  LOG_SECONDS                 7200
+#define  UPDATE_MILLIS                200           // as orientFusionInterval, in ALTAIROperation.ino
+#define  TIMING_PASSES                 20
+
+struct LogLine {
+    unsigned long         millis;
+    bool                  haveTruth;
+    double                truth[ORIENT_FUSION_NUM_AXES];
+    ALTAIR_OrientReading  readings[NUM_SENSORS];
+};
+
+static double wrap180( double angle ) {
+    while (angle >=  180.) angle -= 360.;
+    while (angle <  -180.) angle += 360.;
+    return angle;
+}
+
+static int16_t toUnits( double degrees ) { return (int16_t) lround(degrees * ORIENT_FUSION_UNITS_PER_DEGREE); }
+
+// As a sensor gives it: the yaw from 0 to 360 (just under), and the roll from -180 to 180.
+static ALTAIR_OrientReading reading( double yaw , double pitch , double roll , uint8_t typeAndHealth , uint8_t axes ) {
+    yaw = wrap180(yaw);
+    if (yaw < 0.) yaw += 360.;
+    if (yaw >= 359.99) yaw = 359.99;
+    ALTAIR_OrientReading r = { toUnits(yaw), toUnits(pitch), toUnits(wrap180(roll)), typeAndHealth, axes };
+    return r;
+}
+
+/**************************************************************************/
+/*!
+    Make up a log (see above).
+*/
+/**************************************************************************/
+static std::vector<LogLine> makeLog( ) {
+    std::mt19937                     random(17102026);
+    std::normal_distribution<double> gauss(0., 1.);
+    std::vector<LogLine>             log;
+    double yaw = 40., rate = 0.;
+    for (unsigned long ms = 0; ms <= 1000UL * LOG_SECONDS; ms += UPDATE_MILLIS) {
+        double t = ms / 1000.;
+        rate += 0.3 * gauss(random);                                            // (turning, as the wind and the props push it round)
+        if (rate >  6.) rate =  6.;
+        if (rate < -6.) rate = -6.;
+        yaw   = wrap180(yaw + rate * UPDATE_MILLIS / 1000.);
+        double pitch = 6. * sin(2. * M_PI * t / 6.3) + 1.5 * sin(2. * M_PI * t / 23.);   // (swinging under the balloon)
+        double roll  = 5. * sin(2. * M_PI * t / 7.1 + 1.);
+
+        LogLine line;
+        line.millis    = ms;
+        line.haveTruth = true;
+        line.truth[ORIENT_FUSION_YAW]   = (yaw < 0.) ? yaw + 360. : yaw;
+        line.truth[ORIENT_FUSION_PITCH] = pitch;
+        line.truth[ORIENT_FUSION_ROLL]  = roll;
+
+        bool bnoSick = (t >= 1800. && t < 2400.);
+        bool um7Off  = (t >= 3600. && t < 3900.);
+        line.readings[0] = bnoSick ? reading(0., 0., 0., 4, ORIENT_AXIS_ALL)
+                                   : reading(yaw + 1.0 + 2.5 * gauss(random), pitch + 1.0 * gauss(random), roll + 1.0 * gauss(random), 0, ORIENT_AXIS_ALL);
+        line.readings[1] = reading(yaw - 1.5 + (um7Off ? 90. : 0.) + 3.0 * gauss(random), pitch + 0.5 + 2.0 * gauss(random), roll + 2.0 * gauss(random), 1, ORIENT_AXIS_ALL);
+        line.readings[2] = reading(yaw + 0.5 + 2.0 * gauss(random), pitch + 1.0 * gauss(random), roll - 0.5 + 1.0 * gauss(random), 2, ORIENT_AXIS_ALL);
+        line.readings[3] = reading(yaw + 2.0 + 0.5 * pitch + 4.0 * gauss(random), 0., 0., 3, ORIENT_AXIS_YAW);   // (off by the tilt)
+        log.push_back(line);
+    }
+    return log;
+}
+
+static bool readLog( const char* fileName , std::vector<LogLine>& log ) {
+    FILE* file = fopen(fileName, "r");
+    if (file == NULL) return false;
+    char text[512];
+    while (fgets(text, sizeof(text), file)) {
+        if (text[0] == '#') continue;
+        LogLine line;
+        char    truth[ORIENT_FUSION_NUM_AXES][32];
+        int     v[NUM_SENSORS][4];
+        int     n = sscanf(text, "%lu %31s %31s %31s %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", &line.millis, truth[0], truth[1], truth[2],
+                           &v[0][0], &v[0][1], &v[0][2], &v[0][3], &v[1][0], &v[1][1], &v[1][2], &v[1][3],
+                           &v[2][0], &v[2][1], &v[2][2], &v[2][3], &v[3][0], &v[3][1], &v[3][2], &v[3][3]);
+        if (n != 20) continue;
+        line.haveTruth = (truth[0][0] != '-');
+        for (int a = 0; a < ORIENT_FUSION_NUM_AXES; ++a) line.truth[a] = line.haveTruth ? atof(truth[a]) : 0.;
+        for (int s = 0; s < NUM_SENSORS; ++s) {
+            ALTAIR_OrientReading r = { (int16_t) v[s][0], (int16_t) v[s][1], (int16_t) v[s][2], (uint8_t) v[s][3],
+                                       (uint8_t) ((s == 3) ? ORIENT_AXIS_YAW : ORIENT_AXIS_ALL) };
+            line.readings[s] = r;
+        }
+        log.push_back(line);
+    }
+    fclose(file);
+    return true;
+}
+
+static void writeLog( const char* fileName , const std::vector<LogLine>& log ) {
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL) return;
+    fprintf(file, "# millis truthYaw truthPitch truthRoll (yaw pitch roll typeAndHealth) x 4: BNO055 UM7 HMC6343 HMC5883L\n");
+    for (size_t i = 0; i < log.size(); ++i) {
+        const LogLine& line = log[i];
+        fprintf(file, "%lu %.3f %.3f %.3f", line.millis, line.truth[0], line.truth[1], line.truth[2]);
+        for (int s = 0; s < NUM_SENSORS; ++s) {
+            const ALTAIR_OrientReading& r = line.readings[s];
+            fprintf(file, "  %d %d %d %d", r.yaw, r.pitch, r.roll, r.typeAndHealth);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+struct Errors {
+    Errors() : n(0), sumSquares(0.), worst(0.), within2Sigma(0) {}
+    void add( double error , double sigma ) {
+        ++n;
+        sumSquares += error * error;
+        if (fabs(error) > worst) worst = fabs(error);
+        if (fabs(error) <= 2. * sigma) ++within2Sigma;
+    }
+    double rms( ) const { return n ? sqrt(sumSquares / n) : 0.; }
+    long   n;
+    double sumSquares, worst;
+    long   within2Sigma;
+};
+
+static double axisError( int axis , double estimate , double truth ) {
+    return (axis == ORIENT_FUSION_PITCH) ? estimate - truth : wrap180(estimate - truth);
+}
+
+int main( int argc , char** argv )
+{
+    std::vector<LogLine> log;
+    const char*          fileName = (argc > 1) ? argv[1] : NULL;
+    if (fileName == NULL || !readLog(fileName, log)) {
+        log = makeLog();
+        if (fileName) writeLog(fileName, log);
+        printf("A made-up log of %zu updates (%d s)%s%s\n\n", log.size(), LOG_SECONDS, fileName ? ", written to " : "", fileName ? fileName : "");
+    } else {
+        printf("Replaying %zu updates from %s\n\n", log.size(), fileName);
+    }
+    if (log.empty()) { printf("Nothing to replay.\n"); return 1; }
+
+// The cost of an update.
+    ALTAIR_OrientFusion fusion;
+    float               sink = 0.;
+    auto begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < TIMING_PASSES; ++pass) {
+        fusion.reset();
+        for (size_t i = 0; i < log.size(); ++i) {
+            fusion.update(log[i].readings, NUM_SENSORS, log[i].millis);
+            sink += fusion.degrees(ORIENT_FUSION_YAW);
+        }
+    }
+    double nanos   = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    double updates = (double) TIMING_PASSES * log.size();
+    printf("Cost (host): %.1f ns per update, %.1f ns per reading   (%s)\n\n", nanos / updates, nanos / updates / NUM_SENSORS, sink != 0. ? "ok" : "-");
+
+// The accuracy, against the truth.
+    fusion = ALTAIR_OrientFusion();
+    Errors fused[ORIENT_FUSION_NUM_AXES], primary[ORIENT_FUSION_NUM_AXES], fusedHealthy[ORIENT_FUSION_NUM_AXES], primaryHealthy[ORIENT_FUSION_NUM_AXES];
+    long   withTruth = 0;
+    for (size_t i = 0; i < log.size(); ++i) {
+        const LogLine& line = log[i];
+        fusion.update(line.readings, NUM_SENSORS, line.millis);
+        if (!line.haveTruth || i < 5) continue;                                // (a second to settle)
+        ++withTruth;
+        const ALTAIR_OrientReading& bno   = line.readings[0];
+        double                      bnoAngle[] = { bno.yaw / ORIENT_FUSION_UNITS_PER_DEGREE, bno.pitch / ORIENT_FUSION_UNITS_PER_DEGREE, bno.roll / ORIENT_FUSION_UNITS_PER_DEGREE };
+        for (int a = 0; a < ORIENT_FUSION_NUM_AXES; ++a) {
+            double fusedError   = axisError(a, fusion.degrees(a), line.truth[a]);
+            double primaryError = axisError(a, bnoAngle[a],       line.truth[a]);
+            fused[a].add(fusedError, fusion.sigma(a));
+            primary[a].add(primaryError, 0.);
+            if (bno.typeAndHealth < ORIENT_FUSION_NUM_TYPES) {
+                fusedHealthy[a].add(fusedError, fusion.sigma(a));
+                primaryHealthy[a].add(primaryError, 0.);
+            }
+        }
+    }
+    const ALTAIR_OrientFusionStats* stats = fusion.stats();
+    printf("Updates / readings / unhealthy / rejected: %lu / %lu / %lu / %lu\n\n", stats->updates, stats->readings, stats->unhealthy, stats->rejected);
+    if (withTruth == 0) {
+        printf("(No truth in the log, so no accuracy.)\n");
+        return 0;
+    }
+
+    bool        ok      = true;
+    const char* names[] = { "yaw", "pitch", "roll" };
+    printf("Error (degrees)        fused: RMS    worst   within 2 sigma     BNO055 alone: RMS    worst\n");
+    for (int a = 0; a < ORIENT_FUSION_NUM_AXES; ++a) {
+        printf("  %-6s whole log          %6.2f  %7.2f      %5.1f%%                     %7.2f  %7.2f\n", names[a],
+               fused[a].rms(), fused[a].worst, 100. * fused[a].within2Sigma / fused[a].n, primary[a].rms(), primary[a].worst);
+        printf("  %-6s BNO055 healthy     %6.2f  %7.2f      %5.1f%%                     %7.2f  %7.2f\n", "",
+               fusedHealthy[a].rms(), fusedHealthy[a].worst, 100. * fusedHealthy[a].within2Sigma / fusedHealthy[a].n, primaryHealthy[a].rms(), primaryHealthy[a].worst);
+        if (fusedHealthy[a].rms() >= primaryHealthy[a].rms())           ok = false;   // (better than the best sensor alone, even when it is healthy)
+        if (fused[a].worst > 15.)                                       ok = false;   // (and no faulty sensor ever drags it far off)
+        if (fused[a].within2Sigma < 0.9 * fused[a].n)                   ok = false;   // (and the uncertainty can be trusted)
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
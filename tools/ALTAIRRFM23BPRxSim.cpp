@@ -0,0 +1,451 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRRFM23BPRxSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the RFM23BP's command reception, with the very same receive queue as
+    in the flight code (ALTAIR_RFM23BPRxQueue), on a simulated clock.
+
+    The RH_RF22 is simulated as RadioHead's driver behaves: its interrupt
+    handler captures a packet once it has all arrived (its air time, at
+    RFM23BP_DATA_RATE, with RFM23BP_PACKET_OVERHEAD), and sets the flag
+    that available() returns; the radio then stays idle, so that a packet
+    that arrives before recv() has freed it is lost.  recv() copies (and
+    truncates) the packet into the buffer that it is given.
+
+    ALTAIR_RFM23BP's serviceRx() and readALTAIRInfo() (which depend upon
+    the Arduino libraries) are mirrored here, over the protected virtual
+    member functions that they go through (radioAvailable(), radioRecv()
+    and rxMillis()), as is the main loop: the "RFM23BP RX queue" task calls
+    serviceRx() every RX_SERVICE_INTERVAL, and readCommands() calls
+    readALTAIRInfo() every READ_COMMANDS_INTERVAL, and executes the
+    command that it returns.  The ground station sends commands at random
+    intervals (now and then as a burst, back to back), along with the
+    odd message that is not a command, or that is too long.  For
+    comparison, the previous readALTAIRInfo(), which polled available()
+    with delay(5) up to MAX_READ_TRIES times, is run on the same traffic.
+
+    It reports, for each:
+
+      - the commands executed (and lost, at the radio or in the queue);
+      - the time from each command's arrival until it was captured, and
+        until it was executed;
+      - the longest that a readCommands() pass held up the main loop.
+
+    It checks that every command is executed, once, in order, within a
+    service interval and a readCommands() interval of its arrival, that a
+    readCommands() pass never waits, that a message too long for a queue
+    slot is truncated into it (and counted as invalid), and that messages
+    that arrive when the queue is full are dropped, and counted.
+
+    It also runs the status frames that ALTAIR fans out to the RFM23BP
+    the other way, to a ground station: each is encoded by
+    ALTAIR_LinkEncoder (in full, or as a delta, and preceded by its
+    sequence #), received through the queue, and fed (as a ground
+    station's readALTAIRInfo() feeds it) to ALTAIR_DownlinkDecoder.  It
+    checks that the longest of them (a full frame 1, with its sequence
+    #) fits a queue slot whole, and that every frame is decoded, with
+    the same records as if its bytes had been fed straight to the
+    decoder.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRRFM23BPRxSim ALTAIRRFM23BPRxSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_RFM23BPRxQueue.cpp ../libraries/ALTAIR_Devices/ALTAIR_LinkEncoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_DownlinkDecoder.cpp ../libraries/ALTAIR_Devices/ALTAIR_CommandARQ.cpp
+
+    To use:
+
+      ALTAIRRFM23BPRxSim [# of commands]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ALTAIR_RFM23BPRxQueue.h"
+#include "ALTAIR_DownlinkDecoder.h"
+
+typedef  std::vector<byte>  Bytes;
+
+// As in ALTAIR_GenTelInt.h, ALTAIR_RFM23BP.h, and ALTAIROperation.ino (which depend upon the Arduino libraries).
+#define  RX_START_BYTE             0xFC
+#define  TX_START_BYTE             FRAME_START_BYTE
+#define  COMMAND_LENGTH               3
+#define  NO_COMMAND_SEQUENCE          0
+#define  MAX_READ_TRIES             100
+#define  RFM23BP_DATA_RATE         2400          // in bits per second
+#define  RFM23BP_PACKET_OVERHEAD     13          // bytes per packet
+#define  RX_SERVICE_INTERVAL         10          // in milliseconds (the "RFM23BP RX queue" task)
+#define  READ_COMMANDS_INTERVAL      50          // in milliseconds (the "read commands" task)
+
+#define  DEFAULT_NUM_COMMANDS       300
+#define  MEAN_COMMAND_INTERVAL     2000          // in milliseconds
+#define  BURST_LENGTH                 6          // commands sent back to back, now and then
+#define  RFM_MAX_MESSAGE_LENGTH      50          // RH_RF22_MAX_MESSAGE_LEN (what txRoom() offers the encoder)
+#define  FANOUT_CYCLES              400
+#define  FANOUT_INTERVAL           1000          // in milliseconds (the RFM23BP's link rate)
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+static unsigned long airMillis( size_t length ) { return (unsigned long) ((length + RFM23BP_PACKET_OVERHEAD) * 8 * 1000 / RFM23BP_DATA_RATE); }
+
+struct Message {
+    unsigned long  arrives;                                                 // (once all of it has)
+    Bytes          bytes;
+    long           command;                                                 // its #, or -1 if it is not a command
+};
+
+/**************************************************************************/
+/*!
+    The ground station's traffic: commands (each [RX_START_BYTE] [length]
+    [command] [argument] [sequence]), at random intervals, and now and
+    then in a burst, or with a message that is not a command (a frame
+    sent down, too long for a queue slot) in between.
+*/
+/**************************************************************************/
+static std::vector<Message> makeTraffic( long numCommands , std::mt19937& random ) {
+    std::vector<Message> traffic;
+    unsigned long        sendAt = 1000;
+    for (long n = 0; n < numCommands; ) {
+        int burst = (random() % 10 == 0) ? BURST_LENGTH : 1;
+        for (int b = 0; b < burst && n < numCommands; ++b, ++n) {
+            if (random() % 8 == 0) {
+                Message other;
+                other.bytes.assign(RFM_RX_MAX_MESSAGE_LENGTH + 15, 0x55);
+                other.bytes[0] = TX_START_BYTE;
+                other.bytes[1] = other.bytes.size() - FRAME_HEADER_LENGTH;
+                sendAt        += airMillis(other.bytes.size());
+                other.arrives  = sendAt;
+                other.command  = -1;
+                traffic.push_back(other);
+            }
+            Message command;
+            command.bytes   = { RX_START_BYTE, COMMAND_LENGTH, (byte) ('a' + n % 26), (byte) (n % 251), (byte) (1 + n % 255) };
+            sendAt         += airMillis(command.bytes.size());
+            command.arrives = sendAt;
+            command.command = n;
+            traffic.push_back(command);
+        }
+        sendAt += 1 + random() % (2 * MEAN_COMMAND_INTERVAL);
+    }
+    return traffic;
+}
+
+/**************************************************************************/
+/*!
+    The payload's side: the RH_RF22 (simulated), and ALTAIR_RFM23BP's
+    receive path (mirrored), on the simulated clock.
+*/
+/**************************************************************************/
+struct Rfm {
+    const std::vector<Message>& traffic;
+    size_t                 next;                                            // the next message to arrive
+    unsigned long          now;
+    bool                   rxBufValid;                                      // (RH_RF22's flag, set by its interrupt handler)
+    size_t                 held;                                            // the message it holds
+    ALTAIR_RFM23BPRxQueue  _rxQueue;
+    long                   lostAtRadio;
+    std::vector<unsigned long> captured;                                    // when each message was captured (by its index)
+
+    ALTAIR_DownlinkDecoder* _downlinkDecoder;
+
+    Rfm( const std::vector<Message>& t ) : traffic(t), next(0), now(0), rxBufValid(false), held(0), lostAtRadio(0), captured(t.size(), 0),
+                                           _downlinkDecoder(NULL) {}
+
+// The messages that have arrived by now (the RH_RF22's interrupt handler).
+    void arrivals() {
+        while (next < traffic.size() && traffic[next].arrives <= now) {
+            if (rxBufValid) ++lostAtRadio;
+            else            { rxBufValid = true;  held = next; }
+            ++next;
+        }
+    }
+    void advance( unsigned long millis ) { now += millis;  arrivals(); }
+
+// As RH_RF22::available() and recv().
+    bool radioAvailable() { return rxBufValid; }
+    bool radioRecv( unsigned char* buffer , unsigned char* length ) {
+        if (!rxBufValid) return false;
+        const Bytes& bytes = traffic[held].bytes;
+        if (*length > bytes.size()) *length = bytes.size();
+        memcpy(buffer, &bytes[0], *length);
+        rxBufValid    = false;
+        captured[held] = now;
+        return true;
+    }
+    unsigned long rxMillis() { return now; }
+
+// As ALTAIR_RFM23BP::serviceRx.
+    bool serviceRx() {
+        if (!radioAvailable()) return false;
+        byte*         slot = _rxQueue.back();
+        byte          none;
+        unsigned char length = slot ? RFM_RX_MAX_MESSAGE_LENGTH : 0;
+        if (!radioRecv(slot ? slot : &none, &length)) return false;
+        return _rxQueue.push(length, rxMillis());
+    }
+
+// As ALTAIR_RFM23BP::readMessage, and readALTAIRInfo (with isGroundStation false).
+    bool readMessage( unsigned char* buffer , unsigned char* length ) {
+        serviceRx();
+        return _rxQueue.pop(buffer, length, rxMillis());
+    }
+    void readALTAIRInfo( byte command[] ) {
+        byte buffer[RFM_RX_MAX_MESSAGE_LENGTH];
+        byte bufferLength;
+        command[0] = command[1] = 0;
+        command[2] = NO_COMMAND_SEQUENCE;
+        while (true) {
+            bufferLength = sizeof(buffer);
+            if (!readMessage(buffer, &bufferLength)) break;
+            int termLength = ((int) (buffer[1]));
+            if ((bufferLength >= 2) && (buffer[0] == RX_START_BYTE) && (termLength >= 2) && (termLength + 2 <= bufferLength)) {
+                command[0] = buffer[2];
+                command[1] = buffer[3];
+                if (termLength >= COMMAND_LENGTH) command[2] = buffer[4];
+                break;
+            }
+            ++_rxQueue.stats()->messagesInvalid;
+        }
+    }
+
+// As ALTAIR_RFM23BP::readALTAIRInfo, with isGroundStation true.
+    void readDownlink( ) {
+        byte buffer[RFM_RX_MAX_MESSAGE_LENGTH];
+        byte bufferLength;
+        while (true) {
+            bufferLength = sizeof(buffer);
+            if (!readMessage(buffer, &bufferLength)) break;
+            if (!_downlinkDecoder) ++_rxQueue.stats()->messagesInvalid;
+            else                   _downlinkDecoder->feed(buffer, bufferLength, rxMillis());
+        }
+    }
+
+// As the previous readALTAIRInfo: poll available() with delay(5), and recv() straight from the RH_RF22.
+    void previousReadALTAIRInfo( byte command[] ) {
+        command[0] = command[1] = 0;
+        command[2] = NO_COMMAND_SEQUENCE;
+        while (true) {
+            long readTry = 0;
+            while (!radioAvailable() && readTry < MAX_READ_TRIES) {
+                ++readTry;
+                advance(5);
+            }
+            if (readTry == MAX_READ_TRIES) break;
+            byte          buffer[255];
+            unsigned char bufferLength = sizeof(buffer);
+            radioRecv(buffer, &bufferLength);
+            if (buffer[0] == RX_START_BYTE && buffer[1] >= 2) {
+                command[0] = buffer[2];
+                command[1] = buffer[3];
+                command[2] = buffer[4];
+                break;
+            }
+        }
+    }
+};
+
+static long key( byte type , byte argument , byte sequence ) { return ((long) type << 16) | (argument << 8) | sequence; }
+
+struct Result {
+    long           executed, inOrder, lostAtRadio, dropped, invalid;
+    unsigned long  maxCapture, maxExecute, maxBlocked;
+    double         meanCapture, meanExecute;
+};
+
+/**************************************************************************/
+/*!
+    Run the main loop over the traffic, with the queue (or the previous
+    way), and collect the results.
+*/
+/**************************************************************************/
+static Result run( const std::vector<Message>& traffic , bool previous ) {
+    Rfm           rfm(traffic);
+    Result        r;
+    unsigned long end      = traffic.back().arrives + 2000;
+    long          expected = 0;
+    double        totalCapture = 0., totalExecute = 0.;
+    std::map<long, size_t> byKey;                                           // (which message each command was)
+    for (size_t m = 0; m < traffic.size(); ++m) if (traffic[m].command >= 0) byKey[key(traffic[m].bytes[2], traffic[m].bytes[3], traffic[m].bytes[4])] = m;
+    memset(&r, 0, sizeof(r));
+    while (rfm.now < end) {
+        if (!previous && rfm.now % RX_SERVICE_INTERVAL == 0) rfm.serviceRx();
+        if (rfm.now % READ_COMMANDS_INTERVAL == 0) {
+            byte          command[COMMAND_LENGTH];
+            unsigned long began = rfm.now;
+            if (previous) rfm.previousReadALTAIRInfo(command);
+            else          rfm.readALTAIRInfo(command);
+            r.maxBlocked = std::max(r.maxBlocked, rfm.now - began);
+            if (command[0] != 0) {
+                std::map<long, size_t>::const_iterator found = byKey.find(key(command[0], command[1], command[2]));
+                long n = (found == byKey.end()) ? -1 : (long) found->second;
+                if (n >= 0) {
+                    ++r.executed;
+                    if (traffic[n].command == expected) ++r.inOrder;
+                    expected = traffic[n].command + 1;
+                    unsigned long capture = rfm.captured[n] - traffic[n].arrives, execute = rfm.now - rfm.captured[n];
+                    totalCapture += capture;
+                    totalExecute += execute;
+                    r.maxCapture  = std::max(r.maxCapture, capture);
+                    r.maxExecute  = std::max(r.maxExecute, execute);
+                }
+            }
+        }
+        rfm.advance(1);
+    }
+    r.lostAtRadio = rfm.lostAtRadio;
+    r.dropped     = rfm._rxQueue.stats()->messagesDropped;
+    r.invalid     = rfm._rxQueue.stats()->messagesInvalid;
+    r.meanCapture = r.executed ? totalCapture / r.executed : 0.;
+    r.meanExecute = r.executed ? totalExecute / r.executed : 0.;
+    return r;
+}
+
+static void report( const char* name , const Result& r , long numCommands ) {
+    printf("  %s:\n", name);
+    printf("    %ld of %ld commands executed (%ld in order); %ld messages lost at the radio, %ld dropped from the queue, %ld invalid\n",
+           r.executed, numCommands, r.inOrder, r.lostAtRadio, r.dropped, r.invalid);
+    printf("    arrival to capture mean / max %.1f / %lu ms; capture to execution mean / max %.1f / %lu ms; readCommands held up the loop for up to %lu ms\n",
+           r.meanCapture, r.maxCapture, r.meanExecute, r.maxExecute, r.maxBlocked);
+}
+
+int main( int argc , char** argv )
+{
+    long          numCommands = (argc > 1) ? atol(argv[1]) : DEFAULT_NUM_COMMANDS;
+    std::mt19937  random(17102026);
+    if (numCommands < 1) numCommands = 1;
+
+    std::vector<Message> traffic = makeTraffic(numCommands, random);
+    long                 others  = 0;
+    for (size_t m = 0; m < traffic.size(); ++m) if (traffic[m].command < 0) ++others;
+    printf("%ld commands (each %lu ms on the air), and %ld messages too long for a queue slot, over %.0f s\n", numCommands,
+           airMillis(COMMAND_LENGTH + FRAME_HEADER_LENGTH), others, traffic.back().arrives / 1000.);
+
+    Result queued   = run(traffic, false);
+    Result previous = run(traffic, true);
+    report("Into the queue, by serviceRx (every 10 ms)", queued, numCommands);
+    report("Previously (polling available() with delay(5), in readCommands)", previous, numCommands);
+
+    check(queued.executed == numCommands && queued.inOrder == numCommands,    "every command is executed, once, in order");
+    check(queued.lostAtRadio == 0 && queued.dropped == 0,                     "... with none lost at the radio, or dropped from the queue");
+    check(queued.maxCapture < RX_SERVICE_INTERVAL,                            "each is captured within a service interval of its arrival");
+    check(queued.maxExecute < READ_COMMANDS_INTERVAL,                         "... and executed within a readCommands() interval of that");
+    check(queued.maxBlocked == 0,                                             "a readCommands() pass never waits");
+    check(queued.invalid == others,                                           "messages too long for a slot are truncated into it, and counted invalid");
+    check(previous.maxBlocked >= 5 * MAX_READ_TRIES,                          "(previously, a pass waited for up to 500 ms)");
+
+// A full queue.
+    printf("A full queue\n");
+    {
+        Message              command;
+        command.bytes   = { RX_START_BYTE, COMMAND_LENGTH, 'x', 0, 1 };
+        command.command = 0;
+        std::vector<Message> burst(RFM_RX_QUEUE_LENGTH + 2, command);
+        for (size_t m = 0; m < burst.size(); ++m) burst[m].arrives = 10 * (m + 1);
+        Rfm rfm(burst);
+        for (size_t m = 0; m < burst.size(); ++m) {
+            rfm.advance(10);
+            rfm.serviceRx();
+        }
+        const ALTAIR_RFM23BPRxStats* stats = rfm._rxQueue.stats();
+        check(rfm._rxQueue.depth() == RFM_RX_QUEUE_LENGTH && stats->maxQueueDepth == RFM_RX_QUEUE_LENGTH,
+                                                                              "messages are queued until the queue is full");
+        check(stats->messagesReceived == burst.size() && stats->messagesDropped == 2 && !rfm.radioAvailable(),
+                                                                              "... and then dropped (and counted), still freeing the RH_RF22");
+        byte    buffer[RFM_RX_MAX_MESSAGE_LENGTH];
+        uint8_t length = sizeof(buffer);
+        rfm.advance(100);
+        check(rfm._rxQueue.pop(buffer, &length, rfm.now) && length == 5 && stats->lastQueueLatency == 100 + 10 * (burst.size() - 1),
+                                                                              "the oldest is popped first, with the time it was queued");
+    }
+
+// Fanned-out frames, the other way: encoded, received through the queue, and decoded.
+    printf("Fanned-out status frames, to a ground station\n");
+    {
+        typedef ALTAIR_AllInfoFrame1 F1;
+        typedef ALTAIR_AllInfoFrame2 F2;
+        ALTAIR_LinkEncoder   encoder;
+        std::vector<Message> frames;
+        size_t               longest = 0;
+        for (int c = 0; c < FANOUT_CYCLES; ++c) {
+            byte frame1[F1::length], frame2[F2::length];
+            memset(frame1, 0, sizeof(frame1));
+            memset(frame2, 0, sizeof(frame2));
+            F1::latitude  ::encode(frame1, 48.4634 + c * 1e-5);
+            F1::longitude ::encode(frame1, -123.3117 - c * 3e-5);
+            F1::elevation ::put(   frame1, 10 + 5 * c);
+            F1::yaw       ::put(   frame1, (c * 7) & 0xFF);
+            F1::separator1::put(   frame1);
+            F1::separator2::put(   frame1);
+            F1::separator3::put(   frame1);
+            F2::occSpace  ::put(   frame2, 120 + c);
+            F2::separator1::put(   frame2);
+            F2::separator2::put(   frame2);
+            F2::separator3::put(   frame2);
+            encoder.beginCycle(frame1, frame2, NULL, c & FANOUT_SEQUENCE_MASK, 1);     // (as ALTAIR_GenTelInt::fanOutStatus does, for the RFM23BP)
+            Message message;
+            byte    out[LINK_ENCODER_MAX_LENGTH];
+            uint8_t length = encoder.nextFrame(out, RFM_MAX_MESSAGE_LENGTH);
+            if (length == 0) continue;
+            encoder.frameSent();
+            message.bytes.assign(out, out + length);
+            message.arrives = FANOUT_INTERVAL * (c + 1);
+            message.command = -1;
+            frames.push_back(message);
+            longest = std::max(longest, message.bytes.size());
+        }
+
+        struct Lines : public ALTAIR_RecordSink {
+            std::vector<std::string> lines;
+            virtual void write( const byte* data , uint16_t length ) {                // (without the time received, in the second column)
+                std::string line((const char*) data, length);
+                size_t first = line.find(','), second = line.find(',', first + 1);
+                lines.push_back(line.substr(0, first) + line.substr(second));
+            }
+        } received, direct;
+        ALTAIR_DownlinkDecoder viaQueue(&received), straight(&direct);
+        Rfm                    rfm(frames);
+        rfm._downlinkDecoder = &viaQueue;
+        while (rfm.now < frames.back().arrives + 1000) {
+            if (rfm.now % RX_SERVICE_INTERVAL == 0)    rfm.serviceRx();
+            if (rfm.now % READ_COMMANDS_INTERVAL == 0) rfm.readDownlink();
+            rfm.advance(1);
+        }
+        for (size_t m = 0; m < frames.size(); ++m) straight.feed(&frames[m].bytes[0], frames[m].bytes.size(), frames[m].arrives);
+
+        const ALTAIR_DownlinkStats* stats = viaQueue.stats();
+        printf("    %zu frames sent (%lu deltas), the longest %zu bytes (slot %d); %lu frame 1s and %lu frame 2s decoded, %lu bad, %lu bad deltas, %lu bytes skipped\n",
+               frames.size(), stats->deltaFrames, longest, RFM_RX_MAX_MESSAGE_LENGTH, stats->frame1Count, stats->frame2Count,
+               stats->badFrames, stats->badDeltas, stats->skippedBytes);
+        check(longest == LINK_ENCODER_MAX_LENGTH && longest > FRAME_HEADER_LENGTH + MAX_FRAME_DATA_LENGTH,
+                                                                              "a full frame 1, with its sequence #, is longer than a bare frame ...");
+        check(longest <= RFM_RX_MAX_MESSAGE_LENGTH && rfm._rxQueue.stats()->messagesInvalid == 0,
+                                                                              "... and still fits a queue slot whole");
+        check(stats->frame1Count + stats->frame2Count == frames.size() && stats->deltaFrames > 0 &&
+              stats->badFrames == 0 && stats->badDeltas == 0 && stats->skippedBytes == 0,
+                                                                              "every frame (full, or delta) is decoded, with nothing skipped");
+        check(received.lines == direct.lines && received.lines.size() == frames.size(),
+                                                                              "... with the same records as its bytes fed straight to the decoder");
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
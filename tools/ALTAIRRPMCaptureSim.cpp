@@ -0,0 +1,211 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRRPMCaptureSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) tool that
+    checks the Arduino Micro's interrupt-sampled RPM capture (i.e. the
+    very same ALTAIR_RPMCapture that the Micro runs) against the previous
+    digitalRead polling, on simulated pulse trains.  Each pulse train has
+    an asymmetric duty cycle, timing jitter on every edge, and a contact
+    bounce just after every edge; the polling is simulated read by read
+    (at the Micro's digitalRead and micros() speeds), with its truncated
+    mean, and the capture is simulated sample by sample.  Both are
+    compared with the true RPM, and the time that each takes to refresh
+    all 4 RPMs is shown as well.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../ALTAIRArduinoMicroRPMCurrentTempMon -o ALTAIRRPMCaptureSim ALTAIRRPMCaptureSim.cpp
+
+    To use:
+
+      ALTAIRRPMCaptureSim [trials per RPM] [edge jitter in microseconds]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "ALTAIR_RPMCapture.h"
+
+#define  DIGITAL_READ_MICROS           4.0          // a digitalRead() (and its loop) on the 16 MHz Micro
+#define  MICROS_RESOLUTION               4          // micros() counts in 4s at 16 MHz
+#define  DELAY_BTW_READS_MICROS         20          // the polling's debounce delay
+#define  DUTY_ASYMMETRY               0.10          // the high and low halves of each pulse differ by +/- 10%
+#define  BOUNCE_START_MICROS           3.0          // a bounce back to the previous level, just after each edge
+#define  BOUNCE_LENGTH_MICROS          6.0
+#define  OTHER_LOOP_MICROS          1400.0          // the 12 analogReads in each loop()
+
+/**************************************************************************/
+/*!
+    A simulated pulse train, i.e. its edges (in microseconds).
+*/
+/**************************************************************************/
+class PulseTrain {
+  public:
+    PulseTrain( double rpm , double jitterMicros , double lengthMicros , std::mt19937& random ) {
+        std::normal_distribution<double>       jitter(0., jitterMicros);
+        std::uniform_real_distribution<double> phase(0., 1.);
+        double interval = RPM_MICROS_PER_MINUTE / (RPM_EDGES_PER_REVOLUTION * rpm);
+        double t        = phase(random) * interval;
+        for (long i = 0; t < lengthMicros; ++i) {
+            _edges.push_back(t + jitter(random));
+            t += interval * ((i % 2) ? 1. - DUTY_ASYMMETRY : 1. + DUTY_ASYMMETRY);
+        }
+        std::sort(_edges.begin(), _edges.end());
+    }
+    int level( double t ) const {
+        std::vector<double>::const_iterator it = std::upper_bound(_edges.begin(), _edges.end(), t);
+        int    edges = it - _edges.begin();
+        int    theLevel = edges % 2;
+        double sinceEdge = (edges > 0) ? t - _edges[edges - 1] : 1.e9;
+        if (sinceEdge >= BOUNCE_START_MICROS && sinceEdge < BOUNCE_START_MICROS + BOUNCE_LENGTH_MICROS) theLevel = !theLevel;
+        return theLevel;
+    }
+  private:
+    std::vector<double> _edges;
+};
+
+/**************************************************************************/
+/*!
+    The previous getRPM() (and its averageNumMicrosPerPulse()), line for
+    line, with the clock advanced by each digitalRead and delay.  Returns
+    the RPM, and advances t to when it returned.
+*/
+/**************************************************************************/
+static long simMicros( double t ) { return ((long) t / MICROS_RESOLUTION) * MICROS_RESOLUTION; }
+
+static float oldAverageNumMicrosPerPulse( long *rpmPulseDuration ) {
+    long longestPulse = -999, secondLongestPulse = -999, shortestPulse = -999, secondShortestPulse = -999;
+    long truncatedSumOfPulseDurations, sumOfPulseDurations = 0;
+    for (int i = 0; i < RPM_EDGE_INTERVALS_TO_AVERAGE; ++i) {
+        sumOfPulseDurations += labs(rpmPulseDuration[i]);
+        if (labs(rpmPulseDuration[i]) > longestPulse) {
+            secondLongestPulse = longestPulse;
+            longestPulse = labs(rpmPulseDuration[i]);
+        }
+        if (labs(rpmPulseDuration[i]) < shortestPulse || shortestPulse == -999) {
+            secondShortestPulse = shortestPulse;
+            shortestPulse = labs(rpmPulseDuration[i]);
+        }
+    }
+    truncatedSumOfPulseDurations = sumOfPulseDurations - longestPulse - secondLongestPulse - shortestPulse - secondShortestPulse;
+    return truncatedSumOfPulseDurations / (RPM_EDGE_INTERVALS_TO_AVERAGE - 4.);
+}
+
+static float oldGetRPM( const PulseTrain& train , double& t ) {
+    int  presentReading = train.level(t); t += DIGITAL_READ_MICROS;
+    long initialTime = simMicros(t), previousTime = initialTime, presentTime = initialTime;
+    long rpmPulseDuration[RPM_EDGE_INTERVALS_TO_AVERAGE];
+    for (int i = 0; i < RPM_EDGE_INTERVALS_TO_AVERAGE; ++i) {
+        long j = 0;
+        while (1) {
+            int changed = (train.level(t) != presentReading); t += DIGITAL_READ_MICROS;
+            if (changed) {
+                t += DELAY_BTW_READS_MICROS;
+                changed = (train.level(t) != presentReading); t += DIGITAL_READ_MICROS;
+                if (changed) {
+                    t += DELAY_BTW_READS_MICROS;
+                    changed = (train.level(t) != presentReading); t += DIGITAL_READ_MICROS;
+                    if (changed) break;
+                }
+            }
+            ++j;
+            if (j%10000 == 0) presentTime = simMicros(t);
+            if (presentTime - initialTime > RPM_TIMEOUT_MICROS) return 0.;
+        }
+        presentTime = simMicros(t);
+        rpmPulseDuration[i] = presentTime - previousTime;
+        if (presentReading) rpmPulseDuration[i] = -rpmPulseDuration[i];
+        previousTime = presentTime;
+        presentReading = !presentReading;
+    }
+    return RPM_MICROS_PER_MINUTE / (RPM_EDGES_PER_REVOLUTION * oldAverageNumMicrosPerPulse(rpmPulseDuration));
+}
+
+/**************************************************************************/
+/*!
+    The capture: sample all 4 pulse trains, from t0 to t1.
+*/
+/**************************************************************************/
+static void capture( ALTAIR_RPMCapture& rpmCapture , const std::vector<PulseTrain>& trains , double& t , double t1 ) {
+    for (; t < t1; t += RPM_MICROS_PER_SAMPLE) {
+        uint8_t levels = 0;
+        for (size_t m = 0; m < trains.size(); ++m) if (trains[m].level(t)) levels |= (1 << m);
+        rpmCapture.sample(levels);
+    }
+}
+
+struct Errors {
+    Errors() : sum(0.), worst(0.), n(0) {}
+    void add( double measured , double truth ) {
+        double e = fabs(measured - truth) / truth * 100.;
+        sum += e; worst = std::max(worst, e); ++n;
+    }
+    double mean() const { return n ? sum / n : 0.; }
+    double sum, worst;
+    long   n;
+};
+
+int main( int argc , char** argv )
+{
+    int    trials       = (argc > 1) ? atoi(argv[1]) : 50;
+    double jitterMicros = (argc > 2) ? atof(argv[2]) : 10.;
+    const double rpms[] = { 300., 1000., 2000., 4000., 6000., 9000. };
+    std::mt19937 random(17102026);
+
+    printf("%d trials per RPM, %.0f us edge jitter, %.0f%% duty asymmetry, %.0f us bounce\n\n",
+           trials, jitterMicros, DUTY_ASYMMETRY * 100., BOUNCE_LENGTH_MICROS);
+    printf("   true RPM  |  polled: mean err  worst err  refresh all 4  |  captured: mean err  worst err  refresh all 4\n");
+    bool ok = true;
+    for (size_t r = 0; r < sizeof(rpms) / sizeof(rpms[0]); ++r) {
+        Errors oldErrors, newErrors;
+        double oldRefresh = 0.;
+        for (int trial = 0; trial < trials; ++trial) {
+            std::vector<PulseTrain> trains;
+            double                  motorRPM[RPM_NUM_MOTORS];
+            for (int m = 0; m < RPM_NUM_MOTORS; ++m) {
+                motorRPM[m] = rpms[r] * (1. + 0.02 * m);          // (the 4 motors differ a little)
+                trains.push_back(PulseTrain(motorRPM[m], jitterMicros, 5.e6, random));
+            }
+
+// The previous polling: one motor after another, as in the previous loop().
+            double t = 1.e6;
+            for (int m = 0; m < RPM_NUM_MOTORS; ++m) oldErrors.add(oldGetRPM(trains[m], t), motorRPM[m]);
+            oldRefresh += t - 1.e6 + OTHER_LOOP_MICROS;
+
+// The capture: sample for the same time, then read all 4.
+            ALTAIR_RPMCapture rpmCapture;
+            double tc = 0.;
+            capture(rpmCapture, trains, tc, t);
+            for (int m = 0; m < RPM_NUM_MOTORS; ++m) newErrors.add(rpmCapture.rpm(m), motorRPM[m]);
+        }
+        printf("   %8.0f  |       %6.2f%%     %6.2f%%     %7.1f ms  |          %6.2f%%     %6.2f%%     %7.1f ms\n",
+               rpms[r], oldErrors.mean(), oldErrors.worst, oldRefresh / trials / 1000.,
+               newErrors.mean(), newErrors.worst, OTHER_LOOP_MICROS / 1000.);
+        if (newErrors.mean() > oldErrors.mean() + 0.5) ok = false;
+    }
+
+// A motor that stops should read 0 RPM within the timeout, and a restart should not average across the stop.
+    std::vector<PulseTrain> running(1, PulseTrain(3000., jitterMicros, 0.5e6, random));
+    ALTAIR_RPMCapture rpmCapture;
+    double t = 0.;
+    capture(rpmCapture, running, t, 0.5e6 + RPM_TIMEOUT_MICROS + 1000.);
+    bool stopped = (rpmCapture.rpm(0) == 0.);
+    printf("\nstopped motor reads 0 RPM after the timeout: %s\n", stopped ? "yes" : "NO");
+
+    printf("%s\n", (ok && stopped) ? "PASS" : "FAIL");
+    return (ok && stopped) ? 0 : 1;
+}
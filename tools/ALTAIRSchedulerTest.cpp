@@ -0,0 +1,256 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRSchedulerTest.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) test of the
+    cooperative task scheduler (ALTAIR_TaskScheduler, the very same code
+    that runs the main loop of ALTAIROperation.ino), on a simulated clock:
+    the main loop calls runPending() once every millisecond, and each task
+    advances the clock by the time it takes to run.
+
+    It checks:
+
+      - ordering: when a slow task holds up the loop, the tasks that came
+        due meanwhile run in the order of their deadlines;
+      - drift: over an hour, a periodic task runs exactly once per period,
+        on its original cadence, however long it and the others take;
+      - jitter: a task that takes longer than its period (or that blocks
+        the loop for a while) delays the others by no more than it runs
+        for, is counted as overrunning, and does not starve them;
+      - rescheduling from inside a task's own callback (runOnceAfter,
+        enableTask, deferCurrentTask): a task is never queued twice, a
+        task that disables itself does not run again, and a one-shot
+        task runs only as often as it is rescheduled.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_Scheduler -o ALTAIRSchedulerTest ALTAIRSchedulerTest.cpp ../libraries/ALTAIR_Scheduler/ALTAIR_TaskScheduler.cpp
+
+    To use:
+
+      ALTAIRSchedulerTest
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <vector>
+
+#include "ALTAIR_TaskScheduler.h"
+
+static unsigned long          simMillis = 0;
+static unsigned long          simClock( ) { return simMillis; }
+
+static ALTAIR_TaskScheduler*  scheduler = NULL;
+static std::vector<int>       ran;                           // (the tasks that ran, in order)
+static std::vector<unsigned long> ranAt;                     // (and when each one started)
+
+static bool                   ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+// Run the main loop until the given time, a millisecond per pass.
+static void runUntil( unsigned long endMillis ) {
+    while (simMillis < endMillis) {
+        scheduler->runPending();
+        ++simMillis;
+    }
+}
+
+static void record( int id ) { ran.push_back(id);  ranAt.push_back(simMillis); }
+
+static void startTest( const char* name ) {
+    static ALTAIR_TaskScheduler* current = NULL;
+    delete current;
+    simMillis = 0;
+    current   = scheduler = new ALTAIR_TaskScheduler(simClock);
+    ran.clear();
+    ranAt.clear();
+    printf("%s\n", name);
+}
+
+static int8_t taskA, taskB, taskC, taskD;
+static int    countA;
+
+/**************************************************************************/
+/*!
+    Ordering.
+*/
+/**************************************************************************/
+static void slowA( ) { record(0);  simMillis += 300; }
+static void fastB( ) { record(1); }
+static void fastC( ) { record(2); }
+static void fastD( ) { record(3); }
+
+static void testOrdering( ) {
+    startTest("Ordering");
+    taskA = scheduler->addTask("slow",   slowA, 1000      );
+    taskB = scheduler->addTask("B",      fastB,  100 , 250);
+    taskC = scheduler->addTask("C",      fastC,  100 , 120);
+    taskD = scheduler->addTask("D",      fastD,    0 , 200);
+    runUntil(302);
+    std::vector<int> expected = { 0, 2, 3, 1 };               // (A, and then C, D and B by their deadlines: 120, 200, 250)
+    check(ran == expected,                                              "tasks held up by a slow one run in the order of their deadlines");
+    check(ranAt.size() == 4 && ranAt[1] == 301 && ranAt[3] == 301,      "... all on the next pass through the loop");
+    runUntil(1000);
+    check(scheduler->taskStats(taskD)->runCount == 1,                   "a one-shot task runs once");
+    check(scheduler->taskStats(taskC)->runCount == 8,                   "the missed periods are skipped, not run back-to-back");
+}
+
+/**************************************************************************/
+/*!
+    Drift.
+*/
+/**************************************************************************/
+static void takes7( ) { record(0);  simMillis += 7; }
+static void takes2( ) { record(1);  simMillis += 2; }
+static void takes1( ) { record(2);  simMillis += 1; }
+
+static void testDrift( ) {
+    startTest("Drift (an hour)");
+    taskA = scheduler->addTask("100 ms", takes7, 100);
+    taskB = scheduler->addTask("33 ms",  takes2,  33);
+    taskC = scheduler->addTask("1 s",    takes1, 1000, 5);
+    runUntil(3600000UL);
+    const ALTAIR_TaskStats* stats = scheduler->taskStats(taskA);
+    check(stats->runCount == 36000,                                     "the 100 ms task ran exactly once per period");
+    check(stats->overrunCount == 0,                                     "... with no overruns");
+    bool onCadence = true;
+    long n         = 0;
+    for (size_t i = 0; i < ran.size(); ++i) {
+        if (ran[i] != 0) continue;
+        if (ranAt[i] < 100UL * n || ranAt[i] > 100UL * n + stats->maxJitter) onCadence = false;
+        ++n;
+    }
+    check(onCadence,                                                    "... each run on its original cadence (no drift)");
+    check(stats->maxJitter <= 2 + 1 + 1,                                "... late by no more than the others take to run");
+    check(scheduler->taskStats(taskB)->runCount == 3600000UL / 33 + 1, "the 33 ms task ran exactly once per period");
+}
+
+/**************************************************************************/
+/*!
+    Jitter under an overrunning task.
+*/
+/**************************************************************************/
+static void blocks250( ) { record(0);  simMillis += 250; }
+static void takes150(  ) { record(1);  simMillis += 150; }
+
+static void testJitter( ) {
+    startTest("Jitter under an overrunning task");
+    taskA = scheduler->addTask("blocks",  blocks250, 1000, 500);
+    taskB = scheduler->addTask("100 ms",  fastB,      100);
+    runUntil(60000);
+    const ALTAIR_TaskStats* stats = scheduler->taskStats(taskB);
+    printf("    100 ms task: %lu runs, max jitter %lu ms, mean %.1f ms\n", stats->runCount, stats->maxJitter, (double) stats->totalJitter / stats->runCount);
+    check(stats->maxJitter <= 250,                                      "a task that blocks for 250 ms delays the others by no more than that");
+    bool onCadence = true;
+    for (size_t i = 0; i < ran.size(); ++i) {
+        if (ran[i] == 1 && ranAt[i] % 100 != 0 && ranAt[i] % 1000 != 750) onCadence = false;   // (only its run right after the blocking one is late)
+    }
+    check(onCadence,                                                    "... and they keep their cadence otherwise");
+    check(stats->overrunCount == 60,                                    "... missing a period each time, which is counted");
+
+    startTest("A task that takes longer than its period");
+    taskA = scheduler->addTask("overruns", takes150, 100);
+    taskB = scheduler->addTask("50 ms",    fastB,     50);
+    runUntil(60000);
+    const ALTAIR_TaskStats* over  = scheduler->taskStats(taskA);
+    const ALTAIR_TaskStats* other = scheduler->taskStats(taskB);
+    printf("    overrunning task: %lu runs, %lu overruns;  50 ms task: %lu runs, max jitter %lu ms\n", over->runCount, over->overrunCount, other->runCount, other->maxJitter);
+    check(over->overrunCount == over->runCount,                         "each of its runs is counted as an overrun (once)");
+    check(other->runCount >= over->runCount && other->maxJitter <= 150, "it does not starve the other task");
+}
+
+/**************************************************************************/
+/*!
+    Rescheduling from inside a callback.
+*/
+/**************************************************************************/
+static void reschedulesItself( ) {
+    record(0);
+    if (countA++ % 2 == 0) scheduler->runOnceAfter(taskA, 30);
+}
+static void oneShotAgain( ) {
+    record(0);
+    if (++countA < 3) scheduler->runOnceAfter(taskA, 10);
+}
+static void oneShotCancelled( ) {
+    record(1);
+    scheduler->runOnceAfter(taskB, 10);
+    scheduler->enableTask(taskB, false);
+}
+static void oneShotOnceMore( ) {
+    record(0);
+    if (countA++ == 0) scheduler->runOnceAfter(taskA, 100);
+}
+static void enablesA( ) { scheduler->enableTask(taskA, true); }
+static void disablesItself( ) { record(0);  scheduler->enableTask(taskA, false); }
+static void reenables( ) { scheduler->enableTask(taskA, true); }
+static void defers( ) {
+    if (++countA <= 3) { scheduler->deferCurrentTask(10);  return; }
+    record(0);
+}
+
+static void testRescheduling( ) {
+    startTest("Rescheduling from inside a callback");
+    countA = 0;
+    taskA  = scheduler->addTask("periodic", reschedulesItself, 100);
+    runUntil(1000);
+    std::vector<unsigned long> expected = { 0, 30, 130, 160, 260, 290, 390, 420, 520, 550, 650, 680, 780, 810, 910, 940 };
+    check(ranAt == expected,                                            "a periodic task that reschedules itself is queued once, at the new time");
+
+    startTest("One-shot tasks");
+    countA = 0;
+    taskA  = scheduler->addTask("again",     oneShotAgain,     0);
+    taskB  = scheduler->addTask("cancelled", oneShotCancelled, 0);
+    runUntil(1000);
+    check(scheduler->taskStats(taskA)->runCount == 3,                   "a one-shot task that reschedules itself runs only as often as that");
+    check(scheduler->taskStats(taskB)->runCount == 1,                   "a one-shot task that disables itself does not run again");
+    scheduler->enableTask(taskB, true);
+    runUntil(2000);
+    check(scheduler->taskStats(taskB)->runCount == 2,                   "... until it is enabled again (once)");
+
+    startTest("A one-shot task, rescheduled from its callback, then enabled");
+    countA = 0;
+    taskA  = scheduler->addTask("once more", oneShotOnceMore, 0);
+    taskB  = scheduler->addTask("enables",   enablesA,        0, 50);
+    runUntil(1000);
+    check(scheduler->taskStats(taskA)->runCount == 2,                   "a one-shot task rescheduled in its callback stays enabled, queued once");
+
+    startTest("Disabling and enabling");
+    taskA = scheduler->addTask("disables", disablesItself, 100);
+    taskB = scheduler->addTask("enables",  reenables,      1000, 500);
+    runUntil(3000);
+    check(scheduler->taskStats(taskA)->runCount == 4,                   "a task that disables itself runs only when it is enabled again");
+    scheduler->enableTask(taskA, true);
+    scheduler->enableTask(taskA, true);
+    runUntil(3001);
+    check(scheduler->taskStats(taskA)->runCount == 5,                   "... and enabling it twice queues it once");
+
+    startTest("Deferring");
+    countA = 0;
+    taskA  = scheduler->addTask("defers", defers, 100);
+    runUntil(100);
+    check(ranAt.size() == 1 && ranAt[0] == 30,                          "a deferred task is retried, and its retries do not count as runs");
+    check(scheduler->taskStats(taskA)->runCount == 1,                   "... and the run that did happen is counted once");
+}
+
+int main( )
+{
+    testOrdering();
+    testDrift();
+    testJitter();
+    testRescheduling();
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
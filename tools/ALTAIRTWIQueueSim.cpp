@@ -0,0 +1,264 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRTWIQueueSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) model of the
+    Mega's main loop, to see what queueing the Arduino Micro's I2C reads
+    (see ALTAIR_HAL::i2cSubmit) does for it.  The Mega's very same
+    ALTAIR_ArduinoMicro reads a simulated Micro (running the very same
+    ALTAIR_MicroRegisterMap) on the HAL's simulated bus, from a loop that
+    also runs the other scheduled tasks, each taking about the CPU time
+    that it takes on the Mega (see the table in main()).  The Micro is
+    read three ways:
+
+      - blocking: each block read in turn, waiting for the bus, as
+        getData() used to;
+      - queued, with the TWI interrupt (ALTAIR_HAL_TWI_ISR): the reads
+        go on in the background, and their callbacks are called from
+        i2cService() at the top of the loop;
+      - queued, polled (as built now, alongside Wire): the transfer only
+        moves on by a byte each time i2cService() is called.
+
+    It reports, for each:
+
+      - how long the Micro's task holds up the loop, and the worst time
+        that the 10 ms DNT900 TX task then runs late by;
+      - the bus utilization (the time the bus is busy, over the time);
+      - how long a read takes, from getData() to its last callback;
+
+    and checks that the data that arrives is the same (every block read
+    and checked, and the extended block consistent) whichever way it is
+    read.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_MicroRegisterMap -I../libraries/ALTAIR_Devices -o ALTAIRTWIQueueSim ALTAIRTWIQueueSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_ArduinoMicro.cpp ../libraries/ALTAIR_HAL/ALTAIR_HAL_Linux.cpp
+
+    To use:
+
+      ALTAIRTWIQueueSim [# of seconds]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ALTAIR_HALSim.h"
+#include "ALTAIR_ArduinoMicro.h"
+
+#define  MICRO_LOOP_MICROS           3000           // the Micro's loop(), i.e. how often it publishes a snapshot
+#define  IDLE_LOOP_MICROS              20           // the Mega's loop(), with no task due
+#define  MICRO_TASK                     0           // (the index of the Micro's task, in the table below)
+#define  DNT900_TASK                    1           // (and of the DNT900 TX task, whose lateness is reported)
+#define  TASK_STAGGER_MICROS         1237           // (between the tasks' first runs, so that they do not all fall due together)
+
+/**************************************************************************/
+/*!
+    The simulated Micro: it publishes a new snapshot each loop(), with all
+    of its bytes (and likewise all of its extended words) the same.
+*/
+/**************************************************************************/
+class SimMicro : public ALTAIR_HALSimI2CDevice {
+  public:
+    SimMicro( ) : _generation(0), _nextMicros(0) { }
+
+    virtual bool i2cWrite( const uint8_t* bytes , uint8_t numBytes ) {
+        catchUp();
+        if (numBytes > 0) _map.select(bytes[0]);
+        return true;
+    }
+    virtual uint8_t i2cRead( uint8_t* bytes , uint8_t numBytes ) {
+        catchUp();
+        byte    response[MICRO_REGMAP_MAX_RESPONSE];
+        uint8_t length = _map.respond(response, ALTAIR_HAL::clockMillis());
+        for (uint8_t i = 0; i < numBytes; ++i) bytes[i] = (i < length) ? response[i] : 0xFF;
+        return numBytes;
+    }
+
+  private:
+    void catchUp( ) {
+        while (ALTAIR_HALSim::micros() >= _nextMicros) {
+            ++_generation;
+            byte     packed[MICRO_SNAPSHOT_COMPACT_LENGTH];
+            uint16_t rpm[4];
+            int16_t  current[4], temp[8];
+            memset(packed, (byte) _generation, sizeof(packed));
+            for (uint8_t j = 0; j < 4; ++j) rpm[j] = current[j] = (int16_t) (_generation * 61);
+            for (uint8_t j = 0; j < 8; ++j) temp[j]             = (int16_t) (_generation * 61);
+            _map.publish(packed + MICRO_SNAPSHOT_RPM, packed + MICRO_SNAPSHOT_CURRENT, packed + MICRO_SNAPSHOT_TEMP,
+                         rpm, current, temp, ALTAIR_HAL::clockMillis());
+            _nextMicros += MICRO_LOOP_MICROS;
+        }
+    }
+
+    ALTAIR_MicroRegisterMap  _map;
+    unsigned long            _generation;
+    unsigned long long       _nextMicros;
+};
+
+enum Mode { blocking, queuedISR, queuedPolled };
+
+struct Task {
+    const char*    name;
+    unsigned long  periodMicros;
+    unsigned long  cpuMicros;                      // (on the Mega)
+};
+
+struct Result {
+    Result() : microTaskMicros(0), microTaskRuns(0), maxMicroTaskMicros(0), dnt900Late(0), dnt900Runs(0), maxDNT900Late(0), busUtilization(0.),
+               readsStarted(0), readsFinished(0), readMicros(0), maxReadMicros(0), reads(0), failed(0), bad(0), inconsistent(0) {}
+    unsigned long long microTaskMicros;
+    unsigned long      microTaskRuns, maxMicroTaskMicros;
+    unsigned long long dnt900Late;
+    unsigned long      dnt900Runs, maxDNT900Late;
+    double             busUtilization;
+    unsigned long      readsStarted, readsFinished;
+    unsigned long long readMicros;
+    unsigned long      maxReadMicros;
+    unsigned long      reads, failed, bad, inconsistent;
+};
+
+// The packed bytes, and each of the extended blocks, must each be all of the same snapshot.  (The two
+//    extended blocks are separate reads, so they can be of different ones.)
+static bool consistent( ALTAIR_ArduinoMicro& mega ) {
+    const byte* packed = mega.packedRPM();
+    for (uint8_t i = 1; i < MICRO_SNAPSHOT_COMPACT_LENGTH; ++i) if (packed[i] != packed[0]) return false;
+    uint16_t propulsion = mega.extendedRPM(0);
+    for (uint8_t i = 0; i < 4; ++i) if (mega.extendedRPM(i) != propulsion || (uint16_t) mega.extendedCurrent(i) != propulsion) return false;
+    uint16_t temp       = (uint16_t) mega.extendedTemp(0);
+    for (uint8_t i = 0; i < 8; ++i) if ((uint16_t) mega.extendedTemp(i) != temp) return false;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+    Run the loop for a number of seconds, reading the Micro one way.
+*/
+/**************************************************************************/
+static Result run( Mode mode , const Task* tasks , uint8_t numTasks , unsigned long seconds ) {
+    ALTAIR_HALSim::reset();
+    ALTAIR_HALSim::setI2CPolled(mode == queuedPolled);
+    SimMicro micro;
+    ALTAIR_HALSim::attachI2C(ARDUINOMICRO_I2CADDRESS, &micro);
+    ALTAIR_ArduinoMicro mega;
+    ALTAIR_HALSim::advanceMicros(MICRO_LOOP_MICROS);
+    mega.initialize();
+    mega.setExtended(true);
+    const ALTAIR_HALSimStats* bus = ALTAIR_HALSim::stats();
+    unsigned long long busyBefore = bus->i2cBusyMicros;
+    unsigned long long start      = ALTAIR_HALSim::micros();
+    unsigned long long end        = start + 1000000ULL * seconds;
+
+    Result             result;
+    unsigned long long due[16];
+    for (uint8_t t = 0; t < numTasks; ++t) due[t] = start + tasks[t].periodMicros + t * TASK_STAGGER_MICROS;
+    unsigned long long readStart = 0;
+    bool               wasReading = false;
+    while (ALTAIR_HALSim::micros() < end) {
+        ALTAIR_HAL::i2cService();
+        if (wasReading && !mega.reading()) {
+            unsigned long took = (unsigned long) (ALTAIR_HALSim::micros() - readStart);
+            ++result.readsFinished;
+            result.readMicros += took;
+            if (took > result.maxReadMicros) result.maxReadMicros = took;
+            if (!consistent(mega)) ++result.inconsistent;
+            wasReading = false;
+        }
+        bool ran = false;
+        for (uint8_t t = 0; t < numTasks; ++t) {
+            unsigned long long now = ALTAIR_HALSim::micros();
+            if (now < due[t]) continue;
+            if (t == DNT900_TASK) {
+                unsigned long late = (unsigned long) (now - due[t]);
+                result.dnt900Late += late;
+                ++result.dnt900Runs;
+                if (late > result.maxDNT900Late) result.maxDNT900Late = late;
+            }
+            due[t] += tasks[t].periodMicros;
+            ALTAIR_HALSim::advanceMicros(tasks[t].cpuMicros);
+            if (t == MICRO_TASK) {
+                unsigned long long before = now;
+                if (mode == blocking) {
+                    ++result.readsStarted;                                          // (the previous getData(), waiting for each block)
+                    readStart = before;
+                    if (mega.readRegister(MICRO_REG_ALL) && mega.readRegister(MICRO_REG_EXT_PROPULSION)) mega.readRegister(MICRO_REG_EXT_TEMP);
+                    wasReading = true;
+                } else if (!mega.reading()) {
+                    ++result.readsStarted;
+                    readStart = before;
+                    mega.getData();
+                    wasReading = mega.reading();
+                } else {
+                    mega.getData();                                                 // (counted as busy by the Mega)
+                }
+                unsigned long took = (unsigned long) (ALTAIR_HALSim::micros() - before);
+                result.microTaskMicros += took;
+                ++result.microTaskRuns;
+                if (took > result.maxMicroTaskMicros) result.maxMicroTaskMicros = took;
+            }
+            ran = true;
+            break;                                                                  // (one task per loop(), as runPending() does)
+        }
+        if (!ran) ALTAIR_HALSim::advanceMicros(IDLE_LOOP_MICROS);
+    }
+    ALTAIR_HAL::i2cFlush();
+
+    result.busUtilization = (double) (bus->i2cBusyMicros - busyBefore) / (double) (ALTAIR_HALSim::micros() - start);
+    result.reads          = mega.stats()->reads;
+    result.failed         = mega.stats()->failedReads;
+    result.bad            = mega.stats()->badReads;
+    return result;
+}
+
+int main( int argc , char** argv )
+{
+    unsigned long seconds = (argc > 1) ? strtoul(argv[1], NULL, 10) : 600;
+    bool          ok      = true;
+
+    // As scheduled in ALTAIROperation.ino, with (roughly) the CPU time that each takes on the Mega.
+    const Task tasks[] = {
+        { "Arduino Micro",      450000,    50 },
+        { "DNT900 TX queue",     10000,   200 },
+        { "RFM23BP RX queue",    10000,   150 },
+        { "SD card writes",      20000,  2500 },
+        { "read commands",       50000,   300 },
+        { "primary radio",      250000,  4000 },
+        { "backup radios",      250000,  3000 },
+        { "SD card",           1000000,  6000 },
+    };
+    const uint8_t numTasks = sizeof(tasks) / sizeof(tasks[0]);
+
+    printf("%lu s of the main loop, reading the Arduino Micro (everything, and the extended block) every 450 ms\n\n", seconds);
+    printf("                        Micro task (us)   DNT900 task late (us)   bus      read time (us)     reads\n");
+    printf("                        mean     max      mean     max            util.    mean      max      good  failed  bad  torn\n");
+    const char* names[] = { "blocking", "queued, TWI interrupt", "queued, polled" };
+    Result      results[3];
+    for (int m = blocking; m <= queuedPolled; ++m) {
+        Result& r = results[m];
+        r = run((Mode) m, tasks, numTasks, seconds);
+        printf("  %-21s %6.0f  %6lu   %6.1f  %6lu          %5.2f%%  %7.0f  %7lu   %6lu  %6lu  %3lu  %4lu\n", names[m],
+               (double) r.microTaskMicros / r.microTaskRuns, r.maxMicroTaskMicros,
+               (double) r.dnt900Late / r.dnt900Runs, r.maxDNT900Late, 100. * r.busUtilization,
+               r.readsFinished ? (double) r.readMicros / r.readsFinished : 0., r.maxReadMicros, r.reads, r.failed, r.bad, r.inconsistent);
+        if (r.failed > 0 || r.bad > 0 || r.inconsistent > 0 || r.readsFinished + 1 < r.readsStarted) ok = false;
+    }
+    for (int m = queuedISR; m <= queuedPolled; ++m) {
+        if (results[m].reads + 3 < results[blocking].reads)                          ok = false;   // (as many blocks read)
+        if (results[m].maxMicroTaskMicros >= results[blocking].maxMicroTaskMicros)   ok = false;   // (and the loop never held up as long)
+    }
+    printf("\nThe Micro's task holds up the loop for %.0f us at most when queued (from %lu us blocking), i.e. %.0f%% less.\n",
+           (double) results[queuedISR].maxMicroTaskMicros, results[blocking].maxMicroTaskMicros,
+           100. * (1. - (double) results[queuedISR].maxMicroTaskMicros / results[blocking].maxMicroTaskMicros));
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRTelemetryBandwidth.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) cost model of
+    the propulsion telemetry, in its compact mode (the packed RPM, current
+    and temp bytes only) and its extended mode (the Arduino Micro's 16-bit
+    readings as well, switched on by the 'P' device command).  For each
+    mode it works out, from the very same frame and register map layouts
+    that the flight code uses:
+
+      - the downlink bytes per second, for each kind of primary radio, and
+        the fraction of the DNT900's link that they take up;
+      - the I2C bus bytes per second between the Mega and the Micro, and
+        the fraction of the (100 kHz) bus that they take up;
+      - the resolution and the range of the RPMs, currents and temps.
+
+    It checks that every frame fits in the transmit buffer, and that the
+    extended mode still fits in the DNT900's transmit queue and link.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -I../libraries/ALTAIR_MicroRegisterMap -o ALTAIRTelemetryBandwidth ALTAIRTelemetryBandwidth.cpp
+
+    To use:
+
+      ALTAIRTelemetryBandwidth [primary radio period (ms)] [Arduino Micro period (ms)]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ALTAIR_TelemetryFrames.h"
+#include "ALTAIR_MicroRegisterMap.h"
+
+typedef  ALTAIR_AllInfoFrame1    F1;
+typedef  ALTAIR_AllInfoFrame2    F2;
+typedef  ALTAIR_PropulsionFrame  F3;
+
+#define  PRIMARY_RADIO_MILLIS       1000            // as scheduled in ALTAIROperation.ino
+#define  ARDUINO_MICRO_MILLIS        450
+#define  DNT900_BAUD_RATE        38400.0            // (10 bits per byte on the wire)
+#define  DNT900_TX_QUEUE_SIZE        256            // = DNT_TX_QUEUE_SIZE in ALTAIR_DNT900TxQueue.h
+#define  I2C_BIT_RATE           100000.0            // (9 bits per byte on the bus, with the ACK)
+
+/**************************************************************************/
+/*!
+    The bytes sent per sendAllALTAIRInfo() by each kind of primary radio.
+    (The RFM23BP sends frames 1 and 2 on alternate calls, and never the
+    extended propulsion frame.)
+*/
+/**************************************************************************/
+static double downlinkBytesPerSend( bool extended , bool isRFM23BP ) {
+    double frame1 = FRAME_HEADER_LENGTH + F1::length;
+    double frame2 = FRAME_HEADER_LENGTH + F2::length;
+    double frame3 = FRAME_HEADER_LENGTH + F3::length;
+    if (isRFM23BP) return (frame1 + frame2) / 2.;
+    return frame1 + frame2 + (extended ? frame3 : 0.);
+}
+
+/**************************************************************************/
+/*!
+    The I2C bus bytes (including the address bytes) per getData(), as
+    ALTAIR_ArduinoMicro reads them: a register is only written when it is
+    not the one already selected, so reading a single register costs just
+    the read, whereas reading several in turn costs a write before each.
+*/
+/**************************************************************************/
+static double i2cBytesPerUpdate( const uint8_t* registers , uint8_t numRegisters ) {
+    double bytes = 0.;
+    for (uint8_t i = 0; i < numRegisters; ++i) {
+        if (numRegisters > 1) bytes += 2;                                   // (the address, and the register)
+        bytes += 1 + MICRO_REGMAP_OVERHEAD + microRegisterLength(registers[i]);
+    }
+    return bytes;
+}
+
+int main( int argc , char** argv )
+{
+    double primaryMillis = (argc > 1) ? atof(argv[1]) : PRIMARY_RADIO_MILLIS;
+    double microMillis   = (argc > 2) ? atof(argv[2]) : ARDUINO_MICRO_MILLIS;
+    bool   ok            = true;
+
+    printf("frames (data bytes, plus %d header bytes each):  1: %d   2: %d   extended propulsion: %d   (buffer: %d)\n",
+           FRAME_HEADER_LENGTH, (int) F1::length, (int) F2::length, (int) F3::length, (int) MAX_FRAME_DATA_LENGTH);
+    if ((int) F3::length > (int) MAX_FRAME_DATA_LENGTH) ok = false;
+    if ((int) F3::length == (int) F1::length || (int) F3::length == (int) F2::length) ok = false;      // (the ground stations tell the frames apart by length)
+
+    const uint8_t compactRegisters[]  = { MICRO_REG_ALL };
+    const uint8_t extendedRegisters[] = { MICRO_REG_ALL, MICRO_REG_EXT_PROPULSION, MICRO_REG_EXT_TEMP };
+    struct { const char* name; bool extended; const uint8_t* registers; uint8_t numRegisters; } modes[] = {
+        { "compact",  false, compactRegisters,  1 },
+        { "extended", true,  extendedRegisters, 3 },
+    };
+
+    printf("\nsending every %.0f ms, and reading the Arduino Micro every %.0f ms:\n\n", primaryMillis, microMillis);
+    printf("  %-9s  %14s  %10s  %14s  %16s  %10s\n", "mode", "DNT900 bytes/s", "(of link)", "RFM23BP bytes/s", "I2C bytes/s", "(of bus)");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        double dntPerSend  = downlinkBytesPerSend(modes[m].extended, false);
+        double dntPerSec   = dntPerSend * 1000. / primaryMillis;
+        double rfmPerSec   = downlinkBytesPerSend(modes[m].extended, true) * 1000. / primaryMillis;
+        double i2cPerSec   = i2cBytesPerUpdate(modes[m].registers, modes[m].numRegisters) * 1000. / microMillis;
+        double linkShare   = dntPerSec * 10. / DNT900_BAUD_RATE;
+        double busShare    = i2cPerSec *  9. / I2C_BIT_RATE;
+        printf("  %-9s  %14.1f  %9.2f%%  %15.1f  %16.1f  %9.2f%%\n", modes[m].name, dntPerSec, 100. * linkShare, rfmPerSec, i2cPerSec, 100. * busShare);
+        if (linkShare > 1. || dntPerSend > DNT900_TX_QUEUE_SIZE) ok = false;
+    }
+
+    printf("\nresolution (and range):\n");
+    printf("  %-9s  %-26s  %-30s  %-30s\n", "mode", "RPM", "current", "temp");
+    printf("  %-9s  %-26s  %-30s  %-30s\n", "compact",  "60 RPM (0 to 7620)",    "0.25 A (-32 to 31.75 A)",        "0.5 C (-64 to 63.5 C)");
+    printf("  %-9s  %-26s  %-30s  %-30s\n", "extended", "1 RPM (0 to 65535)",    "0.01 A (-327.68 to 327.67 A)",   "0.1 C (-3276.8 to 3276.7 C)");
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRTelemetryFramesTest.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) golden-byte
+    test of the telemetry frame layouts (ALTAIR_TelemetryFrames.h): it
+    packs the two sendAllALTAIRInfo frames both as the original
+    sendAllALTAIRInfo did, by hand, byte by byte (copied here verbatim,
+    as the reference), and through the field table, with the very same
+    sequence of calls, and argument types, as
+    ALTAIR_GenTelInt::fillAllInfoFrame1 and fillAllInfoFrame2 (which
+    themselves need all of ALTAIR's devices, so cannot run here), for
+    random readings across (and at the ends of) their ranges.
+
+    It checks:
+
+      - that the two give identical bytes, for every field of both frames;
+      - in particular, that latitudes and longitudes are not rounded to
+        a float on the way (i.e. that they match, to the millionth of a
+        degree, what the hand-packing made of a double);
+      - that the ground station decodes each field back to the reading.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRTelemetryFramesTest ALTAIRTelemetryFramesTest.cpp
+
+    To use:
+
+      ALTAIRTelemetryFramesTest
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+
+#include "ALTAIR_TelemetryFrames.h"
+
+typedef  ALTAIR_AllInfoFrame1  F1;
+typedef  ALTAIR_AllInfoFrame2  F2;
+
+#define  TX_START_BYTE       0xFA
+#define  NUM_TRIALS        200000
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+/**************************************************************************/
+/*!
+    The readings, with the types that ALTAIR's devices return them as.
+*/
+/**************************************************************************/
+struct Readings {
+    double    lat, lon;                        // ALTAIR_GPSSensor
+    long      ele;
+    uint32_t  gpsAge;
+    byte      hdop;
+    float     pres[3], temp[3], hum[3];        // ALTAIR_BME280 (mast, payload, balloon)
+    uint8_t   accelZ, accelX, accelY;          // ALTAIR_OrientSensor
+    uint8_t   yaw, pitch, roll;
+    int8_t    oSensTemp;
+    uint8_t   typeInfo;
+    int8_t    packedRPM[4], packedCur[4], packedTemp[8];   // ALTAIR_ArduinoMicro
+    int8_t    rssi;
+    float     bat1V, bat2V;                    // ALTAIR_Battery
+    uint16_t  occSpace;
+    float     power[4];                        // ALTAIR_MotorAndESC
+    float     setting[3], position[3];         // ALTAIR_ServoMotor (axle rotation, bleed valve, cutdown)
+    uint8_t   lightStat;
+    uint16_t  pd[3];
+};
+
+/**************************************************************************/
+/*!
+    The reference: the original hand-packing from sendAllALTAIRInfo.
+*/
+/**************************************************************************/
+static void handPacked( const Readings& r , byte* sendString1 , byte* sendString2 )
+{
+    int32_t  latitude     = r.lat * 1000000;  // Latitude,  in millionths of a degree.
+    int32_t  longitude    = r.lon * 1000000;  // Longitude, in millionths of a degree.
+    uint16_t age          = r.gpsAge;         // Milliseconds since last GPS update (or default value USHRT_MAX if never received).
+    int16_t  elevation    = r.ele;            // Elevation above mean sea level in meters.
+    int8_t   hdop         = r.hdop;           // Horizontal degree of precision.  A number typically between 1 and 50.
+
+    uint16_t outPres   = (r.pres[0] / 2.0F) ; // in units of 2 Pa (fits nicely into a uint16_t)
+    int8_t   outTemp   =  r.temp[0]         ; // in degrees C
+    uint8_t  outHum    =  r.hum[0]          ; // in %
+    uint16_t inPres    = (r.pres[1] / 2.0F) ;
+    int8_t   inTemp    =  r.temp[1]         ;
+    uint8_t  inHum     =  r.hum[1]          ;
+    uint16_t balPres   = (r.pres[2] / 2.0F) ;
+    int8_t   balTemp   =  r.temp[2]         ;
+    uint8_t  balHum    =  r.hum[2]          ;
+
+    sendString1[0]  = (unsigned char)  TX_START_BYTE;
+    sendString1[1]  = (unsigned char)  (0x2B);           // Number of bytes of data that will be sent (0x2B = 43).
+
+    sendString1[2]  = byte((latitude  >> 24) & 0xFF);
+    sendString1[3]  = byte((latitude  >> 16) & 0xFF);
+    sendString1[4]  = byte((latitude  >>  8) & 0xFF);
+    sendString1[5]  = byte( latitude         & 0xFF);
+
+    sendString1[6]  = byte((longitude >> 24) & 0xFF);
+    sendString1[7]  = byte((longitude >> 16) & 0xFF);
+    sendString1[8]  = byte((longitude >>  8) & 0xFF);
+    sendString1[9]  = byte( longitude        & 0xFF);
+
+    sendString1[10] = byte((elevation >>  8) & 0xFF);
+    sendString1[11] = byte( elevation        & 0xFF);
+
+    sendString1[12] = byte((age       >>  8) & 0xFF);    // only send the upper byte of age (i.e., age / 256)
+    sendString1[13] = byte( hdop             & 0xFF);
+
+    sendString1[14] =       'T'                     ;
+
+    sendString1[15] = byte((outPres   >>  8) & 0xFF);
+    sendString1[16] = byte( outPres          & 0xFF);
+    sendString1[17] = byte( outTemp          & 0xFF);
+    sendString1[18] = byte( outHum           & 0xFF);
+    sendString1[19] = byte((inPres    >>  8) & 0xFF);
+    sendString1[20] = byte( inPres           & 0xFF);
+    sendString1[21] = byte( inTemp           & 0xFF);
+    sendString1[22] = byte( inHum            & 0xFF);
+    sendString1[23] = byte((balPres   >>  8) & 0xFF);
+    sendString1[24] = byte( balPres          & 0xFF);
+    sendString1[25] = byte( balTemp          & 0xFF);
+    sendString1[26] = byte( balHum           & 0xFF);
+
+    sendString1[27] = byte( r.accelZ         & 0xFF);
+    sendString1[28] = byte( r.accelX         & 0xFF);
+    sendString1[29] = byte( r.accelY         & 0xFF);
+
+    sendString1[30] =       'T'                     ;
+
+    sendString1[31] = byte( r.yaw            & 0xFF);
+    sendString1[32] = byte( r.pitch          & 0xFF);
+    sendString1[33] = byte( r.roll           & 0xFF);
+    sendString1[34] = byte( r.oSensTemp      & 0xFF);
+    sendString1[35] = byte( r.typeInfo       & 0xFF);
+
+    for (int i = 0; i < 4; ++i)     sendString1[36+i]  =  byte(  r.packedRPM[i]        & 0xFF);
+    for (int i = 0; i < 4; ++i)     sendString1[40+i]  =  byte(  r.packedCur[i]        & 0xFF);
+
+    sendString1[44] =       'T'                     ;
+
+    uint8_t  bat1V     = (r.bat1V * 18.18F) ; // in units of 55 mV (would turn over at 14 V)
+    uint8_t  bat2V     = (r.bat2V * 18.18F) ;
+    uint8_t  powerMot1 = (r.power[0] * 10.0F) ; // an integer containing 10x the present power setting
+    uint8_t  powerMot2 = (r.power[1] * 10.0F) ;
+    uint8_t  powerMot3 = (r.power[2] * 10.0F) ;
+    uint8_t  powerMot4 = (r.power[3] * 10.0F) ;
+    uint8_t  axlRotSet = (r.setting[0]  * 10.0F) ; // an integer containing 10x the present servo setting
+    uint8_t  axlRotAng = (r.position[0] * 50.0F) ; // in units of 1/50 V (i.e. 20 mV): 5.1 V is max
+    uint8_t  bleedVSet = (r.setting[1]  * 10.0F) ;
+    uint8_t  bleedVAng = (r.position[1] * 50.0F) ;
+    uint8_t  cutdwnSet = (r.setting[2]  * 10.0F) ;
+    uint8_t  cutdwnAng = (r.position[2] * 50.0F) ;
+
+    sendString2[0]  = (unsigned char)  TX_START_BYTE;
+    sendString2[1]  = (unsigned char)  (0x21);           // Number of bytes of data that will be sent (0x21 = 33).
+
+    for (int i = 0; i < 8; ++i)     sendString2[2+i]  =  byte(  r.packedTemp[i]        & 0xFF);
+
+    sendString2[10] = byte(  r.rssi          & 0xFF);
+
+    sendString2[11] = byte(  bat1V           & 0xFF);
+    sendString2[12] = byte(  bat2V           & 0xFF);
+
+    sendString2[13] =       'T'                     ;
+
+    sendString2[14] = byte(( r.occSpace >> 8) & 0xFF);
+    sendString2[15] = byte(  r.occSpace      & 0xFF);
+
+    sendString2[16] = byte(  powerMot1       & 0xFF);
+    sendString2[17] = byte(  powerMot2       & 0xFF);
+    sendString2[18] = byte(  powerMot3       & 0xFF);
+    sendString2[19] = byte(  powerMot4       & 0xFF);
+
+    sendString2[20] = byte(  axlRotSet       & 0xFF);
+    sendString2[21] = byte(  axlRotAng       & 0xFF);
+    sendString2[22] = byte(  bleedVSet       & 0xFF);
+    sendString2[23] = byte(  bleedVAng       & 0xFF);
+    sendString2[24] = byte(  cutdwnSet       & 0xFF);
+    sendString2[25] = byte(  cutdwnAng       & 0xFF);
+
+    sendString2[26] =       'T'                     ;
+
+    sendString2[27] = byte(  r.lightStat     & 0xFF);
+    sendString2[28] = byte(( r.pd[0] >> 8)   & 0xFF);
+    sendString2[29] = byte(  r.pd[0]         & 0xFF);
+    sendString2[30] = byte(( r.pd[1] >> 8)   & 0xFF);
+    sendString2[31] = byte(  r.pd[1]         & 0xFF);
+    sendString2[32] = byte(( r.pd[2] >> 8)   & 0xFF);
+    sendString2[33] = byte(  r.pd[2]         & 0xFF);
+
+    sendString2[34] =       'T'                     ;
+}
+
+/**************************************************************************/
+/*!
+    The field table, called as fillAllInfoFrame1 and fillAllInfoFrame2
+    call it (with the frame headers as sendAllALTAIRInfo writes them).
+*/
+/**************************************************************************/
+static void fieldTable( const Readings& r , byte* frame1 , byte* frame2 )
+{
+    byte*    data = frame1 + FRAME_HEADER_LENGTH;
+    frame1[0]     = (unsigned char)  TX_START_BYTE;
+    frame1[1]     = (unsigned char)  F1::length;
+
+    uint16_t age  = r.gpsAge;
+
+    F1::latitude  ::encode(data, r.lat);
+    F1::longitude ::encode(data, r.lon);
+    F1::elevation ::put(   data, r.ele);
+    F1::age       ::encode(data, age);
+    F1::hdop      ::put(   data, r.hdop);
+    F1::separator1::put(   data);
+    F1::outPres   ::encode(data, r.pres[0]);
+    F1::outTemp   ::encode(data, r.temp[0]);
+    F1::outHum    ::encode(data, r.hum[0] );
+    F1::inPres    ::encode(data, r.pres[1]);
+    F1::inTemp    ::encode(data, r.temp[1]);
+    F1::inHum     ::encode(data, r.hum[1] );
+    F1::balPres   ::encode(data, r.pres[2]);
+    F1::balTemp   ::encode(data, r.temp[2]);
+    F1::balHum    ::encode(data, r.hum[2] );
+    F1::accelZ    ::put(   data, r.accelZ );
+    F1::accelX    ::put(   data, r.accelX );
+    F1::accelY    ::put(   data, r.accelY );
+    F1::separator2::put(   data);
+    F1::yaw       ::put(   data, r.yaw    );
+    F1::pitch     ::put(   data, r.pitch  );
+    F1::roll      ::put(   data, r.roll   );
+    F1::oSensTemp ::put(   data, r.oSensTemp);
+    F1::typeInfo  ::put(   data, r.typeInfo );
+    F1::packedRPM ::put(   data, (const byte*) r.packedRPM);
+    F1::packedCur ::put(   data, (const byte*) r.packedCur);
+    F1::separator3::put(   data);
+
+    data          = frame2 + FRAME_HEADER_LENGTH;
+    frame2[0]     = (unsigned char)  TX_START_BYTE;
+    frame2[1]     = (unsigned char)  F2::length;
+
+    F2::packedTemp::put(   data, (const byte*) r.packedTemp);
+    F2::rssi      ::put(   data, r.rssi       );
+    F2::bat1V     ::encode(data, r.bat1V      );
+    F2::bat2V     ::encode(data, r.bat2V      );
+    F2::separator1::put(   data);
+    F2::occSpace  ::put(   data, r.occSpace   );
+    F2::powerMot1 ::encode(data, r.power[0]   );
+    F2::powerMot2 ::encode(data, r.power[1]   );
+    F2::powerMot3 ::encode(data, r.power[2]   );
+    F2::powerMot4 ::encode(data, r.power[3]   );
+    F2::axlRotSet ::encode(data, r.setting[0] );
+    F2::axlRotAng ::encode(data, r.position[0]);
+    F2::bleedVSet ::encode(data, r.setting[1] );
+    F2::bleedVAng ::encode(data, r.position[1]);
+    F2::cutdwnSet ::encode(data, r.setting[2] );
+    F2::cutdwnAng ::encode(data, r.position[2]);
+    F2::separator2::put(   data);
+    F2::lightStat ::put(   data, r.lightStat  );
+    F2::pd1ADRead ::put(   data, r.pd[0]      );
+    F2::pd2ADRead ::put(   data, r.pd[1]      );
+    F2::pd3ADRead ::put(   data, r.pd[2]      );
+    F2::separator3::put(   data);
+}
+
+/**************************************************************************/
+/*!
+    Random readings, across their ranges (and, now and then, at their
+    ends, or at exact decimal positions, as a GPS reports them).
+*/
+/**************************************************************************/
+static Readings randomReadings( std::mt19937& random )
+{
+    std::uniform_real_distribution<double> unit(0., 1.);
+    bool     edge = (random() % 8 == 0);
+    Readings r;
+    r.lat    = edge ? ((random() % 2) ? 90. : -90.) : -90.  + 180. * unit(random);
+    r.lon    = edge ? ((random() % 2) ? 179.999999 : -180.) : -180. + 360. * unit(random);
+    if (random() % 4 == 0) {                                                     // (a whole number of millionths of a degree, as from NMEA)
+        r.lat = (double) ((long) (r.lat * 1e6)) / 1e6;
+        r.lon = (double) ((long) (r.lon * 1e6)) / 1e6;
+    }
+    r.ele    = edge ? 32767 : -400 + (long) (random() % 33000);
+    r.gpsAge = edge ? 0xFFFF : random() % 0x10000;
+    r.hdop   = random() % 256;
+    for (int i = 0; i < 3; ++i) {
+        r.pres[i] = edge ? 131070.f : (float) (131070. * unit(random));
+        r.temp[i] = edge ? -128.f   : (float) (-80. + 140. * unit(random));
+        r.hum[i]  = edge ? 100.f    : (float) (100. * unit(random));
+    }
+    r.accelZ = random();  r.accelX = random();  r.accelY = random();
+    r.yaw    = random();  r.pitch  = random();  r.roll   = random();
+    r.oSensTemp = random();
+    r.typeInfo  = random();
+    for (int i = 0; i < 4; ++i) { r.packedRPM[i] = random();  r.packedCur[i] = random(); }
+    for (int i = 0; i < 8; ++i) r.packedTemp[i] = random();
+    r.rssi     = random();
+    r.bat1V    = edge ? 14.f : (float) (14. * unit(random));
+    r.bat2V    = (float) (14. * unit(random));
+    r.occSpace = random();
+    for (int i = 0; i < 4; ++i) r.power[i] = edge ? 25.5f : (float) (25.5 * unit(random));
+    for (int i = 0; i < 3; ++i) {
+        r.setting[i]  = (float) (25.5 * unit(random));
+        r.position[i] = edge ? 5.1f : (float) (5.1 * unit(random));
+    }
+    r.lightStat = random();
+    for (int i = 0; i < 3; ++i) r.pd[i] = random();
+    return r;
+}
+
+int main( )
+{
+    std::mt19937 random(17102026);
+    byte         golden1[FRAME_HEADER_LENGTH + F1::length], golden2[FRAME_HEADER_LENGTH + F2::length];
+    byte         frame1 [FRAME_HEADER_LENGTH + F1::length], frame2 [FRAME_HEADER_LENGTH + F2::length];
+    long         differ1 = 0, differ2 = 0, differLatLon = 0, badDecode = 0;
+    int          firstBad = -1;
+
+    printf("%d random sets of readings\n", NUM_TRIALS);
+    check(sizeof(golden1) == 45 && sizeof(golden2) == 35,                "the frames are 45 and 35 bytes long (with their headers)");
+    for (int trial = 0; trial < NUM_TRIALS; ++trial) {
+        Readings r = randomReadings(random);
+        handPacked(r, golden1, golden2);
+        fieldTable(r, frame1,  frame2 );
+        if (memcmp(golden1, frame1, sizeof(golden1)) != 0) {
+            ++differ1;
+            for (int i = 0; firstBad < 0 && i < (int) sizeof(golden1); ++i) if (golden1[i] != frame1[i]) firstBad = i;
+        }
+        if (memcmp(golden2, frame2, sizeof(golden2)) != 0) ++differ2;
+        if (memcmp(golden1 + FRAME_HEADER_LENGTH, frame1 + FRAME_HEADER_LENGTH, F1::elevation::offset) != 0) ++differLatLon;
+        const byte* data = frame1 + FRAME_HEADER_LENGTH;
+        if (fabs(F1::latitude::decode(data) - r.lat) > 1.000001e-6 || fabs(F1::longitude::decode(data) - r.lon) > 1.000001e-6 ||
+            F1::elevation::get(data) != r.ele) ++badDecode;
+    }
+    if (firstBad >= 0) printf("    (the first difference in frame 1 was at byte %d)\n", firstBad);
+    check(differ1 == 0,                                                   "frame 1 is byte-for-byte the hand-packed one");
+    check(differLatLon == 0,                                              "... including the latitude and longitude, to the millionth of a degree");
+    check(differ2 == 0,                                                   "frame 2 is byte-for-byte the hand-packed one");
+    check(badDecode == 0,                                                 "the ground station decodes the position back to within a millionth of a degree");
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRUM7ParserTest.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) test of the
+    UM7 packet parser (ALTAIR_UM7Parser, the very same code that
+    ALTAIR_UM7::serviceSerial() feeds on the Mega).
+
+    It makes up a stream of the packets that the UM7 sends ALTAIR (the
+    replies to its data, health and GPS batch reads, and the odd
+    zero-length command reply), laid out byte for byte as in the UM7
+    datasheet, or replays a raw capture of the UM7's serial output, and
+    feeds it to the parser in chunks of random sizes, as serviceSerial()
+    gets them (at most UM7_MAX_BYTES_PER_SERVICE at a time).
+
+    It checks:
+
+      - that every packet is parsed, once, with its data intact, however
+        the stream is split across calls (and that the result does not
+        depend upon the split at all);
+      - that a packet with a corrupt checksum is counted and dropped, and
+        that the packets after it are still parsed;
+      - that noise between packets (including partial `snp' headers) is
+        skipped, and never costs more than the packet it runs into;
+      - that random noise never yields a packet that was not sent;
+      - the throughput, against the UM7's 115200 baud (with a wide margin
+        for the Mega being so much slower than the host).
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_Devices -o ALTAIRUM7ParserTest ALTAIRUM7ParserTest.cpp ../libraries/ALTAIR_Devices/ALTAIR_UM7Parser.cpp
+
+    To use:
+
+      ALTAIRUM7ParserTest [raw capture file]
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_UM7Parser.h"
+
+#define  NUM_PACKETS                 20000
+#define  SERVICE_MAX_BYTES             128          // as UM7_MAX_BYTES_PER_SERVICE, in ALTAIR_UM7.h
+#define  UM7_BYTES_PER_SECOND        11520.         // 115200 baud
+#define  MEGA_SLOWDOWN                 200.         // (how much slower than the host the Mega is taken to be)
+#define  TIMING_PASSES                  20
+
+typedef std::vector<byte>  Bytes;
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-66s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+struct Sent {
+    byte   address, pt;
+    Bytes  data;
+};
+
+/**************************************************************************/
+/*!
+    One packet, as the UM7 sends it: `snp', the packet type, the address,
+    the data, and the 2-byte sum of all of them.
+*/
+/**************************************************************************/
+static void appendPacket( Bytes& stream , const Sent& packet , bool corrupt = false ) {
+    size_t       begin    = stream.size();
+    unsigned int checksum = 0;
+    stream.push_back('s');  stream.push_back('n');  stream.push_back('p');
+    stream.push_back(packet.pt);
+    stream.push_back(packet.address);
+    stream.insert(stream.end(), packet.data.begin(), packet.data.end());
+    for (size_t i = begin; i < stream.size(); ++i) checksum += stream[i];
+    if (corrupt) checksum ^= 0x0100;
+    stream.push_back((byte) (checksum >> 8));
+    stream.push_back((byte) (checksum & 0xFF));
+}
+
+static Sent makePacket( std::mt19937& random ) {
+    static const byte addresses[] = { 0x65 , 0x55 , 0x7D , 0xAD };       // data, health, GPS, and a command (e.g. a zero-gyros reply)
+    static const byte types[]     = { 0xFC , 0xFC , 0xF0 , 0x00 };       // (60, 60 and 48 data bytes, and none)
+    int  kind = random() % 10;
+    kind      = (kind < 4) ? 0 : (kind < 7) ? 1 : (kind < 9) ? 2 : 3;
+    Sent packet;
+    packet.address = addresses[kind];
+    packet.pt      = types[kind];
+    int  length    = (packet.pt & 0x80) ? ((packet.pt & 0x40) ? 4 * ((packet.pt >> 2) & 0x0F) : 4) : 0;
+    for (int i = 0; i < length; ++i) packet.data.push_back((byte) random());
+    return packet;
+}
+
+/**************************************************************************/
+/*!
+    Feed a stream to a parser, in chunks of random sizes (or all at
+    once), and collect the packets.
+*/
+/**************************************************************************/
+static std::vector<UM7packet> feed( const Bytes& stream , ALTAIR_UM7Parser& parser , std::mt19937* random ) {
+    std::vector<UM7packet> packets;
+    UM7packet              packet;
+    size_t                 i = 0;
+    while (i < stream.size()) {
+        size_t chunk = random ? 1 + (*random)() % SERVICE_MAX_BYTES : stream.size();
+        for (size_t end = (i + chunk < stream.size()) ? i + chunk : stream.size(); i < end; ++i) {
+            if (parser.parseByte(stream[i], &packet)) packets.push_back(packet);
+        }
+    }
+    return packets;
+}
+
+static bool same( const UM7packet& parsed , const Sent& sent ) {
+    return parsed.Address == sent.address && parsed.PT == sent.pt && parsed.data_length == sent.data.size() &&
+           (sent.data.empty() || memcmp(parsed.data, &sent.data[0], sent.data.size()) == 0);
+}
+
+static bool sameAll( const std::vector<UM7packet>& a , const std::vector<UM7packet>& b ) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].Address != b[i].Address || a[i].PT != b[i].PT || a[i].data_length != b[i].data_length ||
+            memcmp(a[i].data, b[i].data, a[i].data_length) != 0) return false;
+    }
+    return true;
+}
+
+int main( int argc , char** argv )
+{
+    std::mt19937 random(17102026);
+
+// A raw capture, if one was given: just what it holds.
+    if (argc > 1) {
+        FILE* file = fopen(argv[1], "rb");
+        if (file == NULL) { printf("Cannot open %s\n", argv[1]); return 1; }
+        Bytes stream;
+        int   c;
+        while ((c = fgetc(file)) != EOF) stream.push_back((byte) c);
+        fclose(file);
+        ALTAIR_UM7Parser whole, split;
+        std::vector<UM7packet> packets = feed(stream, whole, NULL);
+        printf("%s: %zu bytes, %lu packets, %lu checksum errors, %lu framing errors\n", argv[1], stream.size(),
+               whole.packetsParsed(), whole.checksumErrors(), whole.framingErrors());
+        check(sameAll(packets, feed(stream, split, &random)), "split across calls, it parses the same as all at once");
+        printf("\n%s\n", ok ? "PASS" : "FAIL");
+        return ok ? 0 : 1;
+    }
+
+// A clean stream.
+    printf("A clean stream of %d packets\n", NUM_PACKETS);
+    std::vector<Sent> sent;
+    Bytes             stream;
+    for (int i = 0; i < NUM_PACKETS; ++i) {
+        sent.push_back(makePacket(random));
+        appendPacket(stream, sent.back());
+    }
+    ALTAIR_UM7Parser       whole;
+    std::vector<UM7packet> packets = feed(stream, whole, NULL);
+    bool                   intact  = (packets.size() == sent.size());
+    for (size_t i = 0; intact && i < packets.size(); ++i) intact = same(packets[i], sent[i]);
+    check(intact,                                                          "every packet is parsed once, with its data intact");
+    check(whole.checksumErrors() == 0 && whole.framingErrors() == 0,       "... with no errors");
+    bool splitSame = true;
+    for (int pass = 0; pass < 10; ++pass) {
+        ALTAIR_UM7Parser split;
+        if (!sameAll(packets, feed(stream, split, &random))) splitSame = false;
+    }
+    check(splitSame,                                                       "split across calls at random, it parses exactly the same");
+    ALTAIR_UM7Parser byByte;
+    std::vector<UM7packet> oneAtATime;
+    UM7packet              packet;
+    for (size_t i = 0; i < stream.size(); ++i) if (byByte.parseByte(stream[i], &packet)) oneAtATime.push_back(packet);
+    check(sameAll(packets, oneAtATime),                                    "... and one byte per call, too");
+
+// Corrupt checksums.
+    printf("Corrupt checksums\n");
+    stream.clear();
+    std::vector<bool> corrupt;
+    int               numCorrupt = 0;
+    for (size_t i = 0; i < sent.size(); ++i) {
+        corrupt.push_back(random() % 20 == 0);
+        if (corrupt.back()) ++numCorrupt;
+        appendPacket(stream, sent[i], corrupt.back());
+    }
+    ALTAIR_UM7Parser badSums;
+    packets = feed(stream, badSums, &random);
+    intact  = (packets.size() == sent.size() - numCorrupt);
+    for (size_t i = 0, j = 0; intact && i < sent.size(); ++i) {
+        if (corrupt[i]) continue;
+        intact = same(packets[j++], sent[i]);
+    }
+    printf("    %d corrupted: %lu checksum errors, %zu packets parsed\n", numCorrupt, badSums.checksumErrors(), packets.size());
+    check(badSums.checksumErrors() == (unsigned long) numCorrupt,          "each corrupt packet is counted, and dropped");
+    check(intact,                                                          "... and every good packet around it is parsed");
+
+// Noise between packets.
+    printf("Noise between packets\n");
+    static const char* partials[] = { "x", "s", "sn", "snq", "ss", "sns", "spp", "junk" };
+    stream.clear();
+    for (size_t i = 0; i < sent.size(); ++i) {
+        if (random() % 5 == 0) {
+            const char* noise = partials[random() % (sizeof(partials) / sizeof(partials[0]))];
+            stream.insert(stream.end(), noise, noise + strlen(noise));
+        }
+        appendPacket(stream, sent[i]);
+    }
+    ALTAIR_UM7Parser noisy;
+    packets = feed(stream, noisy, &random);
+    intact  = (packets.size() == sent.size());
+    for (size_t i = 0; intact && i < packets.size(); ++i) intact = same(packets[i], sent[i]);
+    printf("    %lu framing errors\n", noisy.framingErrors());
+    check(intact,                                                          "noise without a whole `snp' in it costs no packets");
+
+// Random noise.
+    stream.clear();
+    for (size_t i = 0; i < sent.size(); ++i) {
+        if (random() % 5 == 0) for (int n = random() % 40; n > 0; --n) stream.push_back((byte) ("snp"[random() % 3] + ((random() % 4 == 0) ? random() % 256 : 0)));
+        appendPacket(stream, sent[i]);
+    }
+    ALTAIR_UM7Parser garbled;
+    packets = feed(stream, garbled, &random);
+    bool   allSent = true;
+    size_t j       = 0;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        while (j < sent.size() && !same(packets[i], sent[j])) ++j;           // (in order, as they were sent)
+        if (j == sent.size()) { allSent = false;  break; }
+        ++j;
+    }
+    printf("    random noise: %zu of %zu packets parsed; %lu checksum errors, %lu framing errors\n", packets.size(), sent.size(),
+           garbled.checksumErrors(), garbled.framingErrors());
+    check(allSent,                                                         "random noise (full of `s', `n' and `p') never yields a packet not sent");
+    check(packets.size() >= sent.size() * 9 / 10,                          "... and costs few of those that were");
+
+// Throughput.
+    printf("Throughput\n");
+    stream.clear();
+    for (size_t i = 0; i < sent.size(); ++i) appendPacket(stream, sent[i]);
+    unsigned long parsed = 0;
+    auto          begin  = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < TIMING_PASSES; ++pass) {
+        ALTAIR_UM7Parser timed;
+        for (size_t i = 0; i < stream.size(); ++i) if (timed.parseByte(stream[i], &packet)) ++parsed;
+    }
+    double seconds  = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double perByte  = seconds / ((double) TIMING_PASSES * stream.size());
+    printf("    %.1f ns per byte on the host (%lu packets); %.0f times the UM7's 115200 baud\n", perByte * 1e9, parsed, 1. / (perByte * UM7_BYTES_PER_SECOND));
+    check(1. / perByte > MEGA_SLOWDOWN * UM7_BYTES_PER_SECOND,             "it keeps up with 115200 baud, even on a Mega 200 times slower");
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
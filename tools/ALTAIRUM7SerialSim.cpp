@@ -0,0 +1,425 @@
+/**************************************************************************/
+/*!
+    @file     ALTAIRUM7SerialSim.cpp
+    @author   Justin Albert (jalbert@uvic.ca)
+    @license  GPL
+
+    This is a host-side (i.e. Linux or macOS, not Arduino) simulation of
+    the UM7's serial line into the Mega: the UM7's replies arrive at
+    115200 baud, a byte every 87 microseconds, into a serial RX ring
+    buffer of 64 bytes (which, as the Arduino core's, holds at most 63,
+    and drops each byte that arrives when it is full), which is drained
+    into the UM7 packet parser (ALTAIR_UM7Parser) as
+    ALTAIR_UM7::serviceSerial() drains it, with the requests paced by
+    ALTAIR_UM7Requests (the very same code as on the Mega).  Every data
+    and health reply is 67 bytes (`snp', the packet type, the address,
+    60 data bytes, and the checksum), and every GPS reply 55.
+
+    It checks:
+
+      - that a burst of the two 67-byte replies that update() asks for
+        survives the 64-byte ring when it is drained every 4 ms, but not
+        when it is only drained once the fusion loop next calls
+        getDataPacket();
+      - over ten minutes of the flight loop (update() every 200 ms, and
+        getGPS() every 400 ms), that with the requests paced, so that at
+        most one reply is on its way, and with the "UM7 serial" task
+        draining the ring every 2 to 5 ms (and every 4 ms, late by up to
+        1 ms), every request gets its packet, intact, and not a byte is
+        dropped; while, as before (each request written straight away,
+        and the ring only drained by the get calls), most are lost.
+
+    It then runs the driver itself (ALTAIR_UM7, over the simulated UART
+    of the HAL's Linux backend, with its simulated clock) against the
+    same simulated UM7: initialize() starts the UART at 115200 baud,
+    sets the GPS baud rate, and reads a health packet; and over a minute
+    of the flight loop (with the "UM7 serial" task every 4 ms), every
+    request is answered, with at most one reply on its way, and never
+    more bytes waiting in the UART than the Mega's ring would hold.
+
+    To build:
+
+      g++ -std=c++11 -O2 -I../libraries/ALTAIR_HAL -I../libraries/ALTAIR_Devices -o ALTAIRUM7SerialSim ALTAIRUM7SerialSim.cpp ../libraries/ALTAIR_Devices/ALTAIR_UM7Parser.cpp ../libraries/ALTAIR_Devices/ALTAIR_UM7Requests.cpp ../libraries/ALTAIR_Devices/ALTAIR_UM7.cpp ../libraries/ALTAIR_Devices/ALTAIR_OrientSensor.cpp ../libraries/ALTAIR_HAL/ALTAIR_HAL_Linux.cpp
+
+    To use:
+
+      ALTAIRUM7SerialSim
+
+    Justin Albert  jalbert@uvic.ca     began on 17 Oct. 2026
+
+    @section  HISTORY
+
+    v1.0  - First version
+*/
+/**************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "ALTAIR_UM7Parser.h"
+#include "ALTAIR_UM7Requests.h"
+#include "ALTAIR_UM7.h"
+#include "ALTAIR_HALSim.h"
+
+#define  RX_RING_SIZE                   64          // as SERIAL_RX_BUFFER_SIZE, in the Mega's HardwareSerial
+#define  BYTE_MICROS                    87          // at 115200 baud (10 bits a byte)
+#define  UM7_LATENCY_MICROS           1000          // from a request being written until its reply starts (the 7 request bytes take 0.6 ms)
+#define  SERVICE_MAX_BYTES             128          // as UM7_MAX_BYTES_PER_SERVICE, in ALTAIR_UM7.h
+#define  DATA_ADDRESS                 0x65          // as in ALTAIR_UM7.h
+#define  HEALTH_ADDRESS               0x55
+#define  GPS_ADDRESS                  0x7D
+#define  DATA_MINLENGTH                 50
+#define  HEALTH_MINLENGTH               44
+#define  GPS_MINLENGTH                  24
+#define  FUSION_MICROS              200000          // orientFusionInterval, in ALTAIROperation.ino
+#define  GPS_MICROS                 400000          // the "GPS and heading" task
+#define  RUN_MICROS             600000000ULL        // ten minutes
+#define  DRIVER_RUN_MILLIS           60000          // a minute, of the driver itself
+#define  DRIVER_SERIAL_ID                3          // DEFAULT_UM7_SERIALID
+
+typedef std::vector<byte>  Bytes;
+
+static bool ok = true;
+
+static void check( bool passed , const char* what ) {
+    printf("  %-72s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed) ok = false;
+}
+
+enum { DATA = 0, HEALTH = 1, GPS = 2, KINDS = 3 };
+static const char* kindName[KINDS] = { "data", "health", "GPS" };
+
+static int  kindOf(  byte address ) { return (address == DATA_ADDRESS) ? DATA : (address == HEALTH_ADDRESS) ? HEALTH : GPS; }
+static byte batchPT( byte address ) { return (address == GPS_ADDRESS) ? 0x70 : 0x7C; }                     // as ALTAIR_UM7::batchPT
+static int  minLength( int kind )   { return (kind == DATA) ? DATA_MINLENGTH : (kind == HEALTH) ? HEALTH_MINLENGTH : GPS_MINLENGTH; }
+
+/**************************************************************************/
+/*!
+    The Mega's serial RX ring buffer.
+*/
+/**************************************************************************/
+struct Ring {
+    byte           bytes[RX_RING_SIZE];
+    unsigned       head = 0, count = 0, maxCount = 0;
+    unsigned long  dropped = 0;
+
+    void push( byte b ) {
+        if (count == RX_RING_SIZE - 1) { ++dropped; return; }
+        bytes[(head + count++) % RX_RING_SIZE] = b;
+        if (count > maxCount) maxCount = count;
+    }
+    bool available( )   { return count > 0; }
+    byte read( )        { byte b = bytes[head]; head = (head + 1) % RX_RING_SIZE; --count; return b; }
+};
+
+/**************************************************************************/
+/*!
+    The UM7: it answers each batch read request (in turn, if they pile
+    up) with the registers' contents, a byte every BYTE_MICROS.  Each
+    reply's data starts with its serial #, and the rest follows from it,
+    so that a parsed packet can be checked to be intact.
+*/
+/**************************************************************************/
+struct SimUM7 {
+    std::deque<byte>                 line;                          // the bytes still to be sent, the first at nextByteMicros
+    unsigned long long               nextByteMicros = 0;
+    uint16_t                         serial         = 0;
+
+    static byte dataByte( uint16_t serial , int i ) { return (i == 0) ? serial >> 8 : (i == 1) ? serial & 0xFF : (byte) (serial * 7 + i * 13); }
+
+    void request( byte address , unsigned long long now ) {
+        byte  pt     = batchPT(address) | 0x80;                      // (the reply has data)
+        int   length = 4 * ((pt >> 2) & 0x0F);
+        Bytes packet = { 's', 'n', 'p', pt, address };
+        ++serial;
+        for (int i = 0; i < length; ++i) packet.push_back(dataByte(serial, i));
+        unsigned checksum = 0;
+        for (size_t i = 0; i < packet.size(); ++i) checksum += packet[i];
+        packet.push_back(checksum >> 8);
+        packet.push_back(checksum & 0xFF);
+        if (line.empty()) nextByteMicros = now + UM7_LATENCY_MICROS;
+        line.insert(line.end(), packet.begin(), packet.end());
+    }
+};
+
+static bool intact( const UM7packet& packet ) {
+    uint16_t serial = (packet.data[0] << 8) | packet.data[1];
+    for (int i = 2; i < packet.data_length; ++i) if (packet.data[i] != SimUM7::dataByte(serial, i)) return false;
+    return true;
+}
+
+/**************************************************************************/
+/*!
+    The Mega's side: the ring, and ALTAIR_UM7's handling of it, either
+    paced (as now) or as before (each request written straight away,
+    and the ring only drained by the get calls).
+*/
+/**************************************************************************/
+struct Mega {
+    bool                 paced;
+    Ring                 ring;
+    SimUM7               um7;
+    ALTAIR_UM7Parser     parser;
+    ALTAIR_UM7Requests   requests;
+    UM7packet            packet;
+    unsigned long        asked[KINDS]    = { 0, 0, 0 };             // get calls
+    unsigned long        written[KINDS]  = { 0, 0, 0 };             // requests written
+    unsigned long        good[KINDS]     = { 0, 0, 0 };             // good, intact packets parsed
+
+    Mega( bool isPaced ) : paced(isPaced) { }
+
+// As ALTAIR_UM7::requestPacket (the TX buffer always has room here)
+    void requestPacket( byte address , unsigned long long now ) {
+        ++written[kindOf(address)];
+        um7.request(address, now);
+    }
+
+// As ALTAIR_UM7::serviceSerial
+    void serviceSerial( unsigned long long now ) {
+        int nBytes = 0;
+        while (ring.available() && nBytes < SERVICE_MAX_BYTES) {
+            ++nBytes;
+            if (!parser.parseByte(ring.read(), &packet)) continue;
+            requests.arrived(packet.Address, now / 1000);
+            int kind = kindOf(packet.Address);
+            if (packet.data_length >= minLength(kind) && intact(packet)) ++good[kind];
+        }
+        if (!paced) return;
+        byte address = requests.due(now / 1000);
+        if (address != UM7_NO_REQUEST) {
+            requestPacket(address, now);
+            requests.sent(now / 1000);
+        }
+    }
+
+// As ALTAIR_UM7::getDataPacket, getHealthPacket, and getGPS
+    void get( byte address , unsigned long long now ) {
+        ++asked[kindOf(address)];
+        if (paced) {
+            requests.want(address);
+            serviceSerial(now);
+        } else {
+            serviceSerial(now);
+            requestPacket(address, now);
+        }
+    }
+
+// The UM7's bytes that arrive up to now
+    void receive( unsigned long long now ) {
+        while (!um7.line.empty() && um7.nextByteMicros <= now) {
+            ring.push(um7.line.front());
+            um7.line.pop_front();
+            um7.nextByteMicros += BYTE_MICROS;
+        }
+    }
+};
+
+/**************************************************************************/
+/*!
+    The flight loop: update() every FUSION_MICROS, getGPS() every
+    GPS_MICROS, and (if serviceMicros is not 0) the "UM7 serial" task
+    every serviceMicros, run late by up to lateMicros.  Returns the
+    Mega, to be looked at.
+*/
+/**************************************************************************/
+static Mega flightLoop( bool paced , unsigned long serviceMicros , unsigned long lateMicros ) {
+    Mega                 mega(paced);
+    std::mt19937         random(17102026);
+    unsigned long long   nextFusion  = 0, nextGPS = 100000, nextService = 0;
+    unsigned long long   serviceAt   = 0;                                       // (when the next service actually runs, lateness and all)
+    for (unsigned long long now = 0; now < RUN_MICROS; ) {
+        unsigned long long next = std::min(nextFusion, nextGPS);
+        if (serviceMicros) next = std::min(next, serviceAt);
+        if (!mega.um7.line.empty()) next = std::min(next, mega.um7.nextByteMicros);
+        now = next;
+        mega.receive(now);
+        if (serviceMicros && now >= serviceAt) {
+            mega.serviceSerial(now);
+            nextService += serviceMicros;
+            serviceAt    = nextService + (lateMicros ? random() % (lateMicros + 1) : 0);
+        }
+        if (now >= nextFusion) {
+            mega.get(DATA_ADDRESS,   now);                                       // (update())
+            mega.get(HEALTH_ADDRESS, now);
+            nextFusion += FUSION_MICROS;
+        }
+        if (now >= nextGPS) {
+            mega.get(GPS_ADDRESS, now);
+            nextGPS += GPS_MICROS;
+        }
+    }
+    return mega;
+}
+
+static void printLoop( const char* what , Mega& mega ) {
+    printf("    %-44s", what);
+    for (int k = 0; k < KINDS; ++k) printf(" %s %5lu/%5lu", kindName[k], mega.good[k], mega.asked[k]);
+    printf("  dropped %6lu  ring max %2u\n", mega.ring.dropped, mega.ring.maxCount);
+}
+
+static bool allAnswered( Mega& mega ) {
+    for (int k = 0; k < KINDS; ++k) if (mega.good[k] + 1 < mega.asked[k]) return false;     // (the last may still be on its way)
+    return mega.ring.dropped == 0 && mega.requests.stats()->replyTimeouts == 0;
+}
+
+int main( )
+{
+// The burst that update() asks for, drained every 4 ms, or not until the next update().
+    printf("A burst of a data and a health reply (2 x 67 bytes) into a %d-byte ring\n", RX_RING_SIZE);
+    {
+        const unsigned long drains[2] = { 4000, FUSION_MICROS };
+        Mega*               megas[2];
+        for (int d = 0; d < 2; ++d) {
+            Mega* mega = megas[d] = new Mega(false);
+            mega->requestPacket(DATA_ADDRESS,   0);
+            mega->requestPacket(HEALTH_ADDRESS, 0);
+            for (unsigned long long now = 0; now <= FUSION_MICROS; now += drains[d]) {
+                mega->receive(now);
+                mega->serviceSerial(now);
+            }
+            printf("    drained every %6lu us: data %lu, health %lu packets; %lu bytes dropped; ring max %u\n",
+                   drains[d], mega->good[DATA], mega->good[HEALTH], mega->ring.dropped, mega->ring.maxCount);
+        }
+        check(megas[0]->good[DATA] == 1 && megas[0]->good[HEALTH] == 1 && megas[0]->ring.dropped == 0,
+                                                                         "drained every 4 ms, both packets survive");
+        check(megas[1]->good[DATA] + megas[1]->good[HEALTH] == 0 && megas[1]->ring.dropped > 0,
+                                                                         "drained only by the next update(), neither does");
+        delete megas[0];  delete megas[1];
+    }
+
+// Ten minutes of the flight loop.
+    printf("Ten minutes of the flight loop\n");
+    {
+        Mega before = flightLoop(false, 0, 0);
+        printLoop("as before (no UM7 serial task):", before);
+        check(before.good[DATA] < before.asked[DATA] / 2 && before.ring.dropped > 0,
+                                                                         "as before, most of the packets are lost");
+
+        bool allGood = true;
+        for (unsigned long period = 2000; period <= 5000; period += 1000) {
+            Mega  paced = flightLoop(true, period, 0);
+            char  what[64];
+            snprintf(what, sizeof(what), "paced, with the UM7 serial task every %lu ms:", period / 1000);
+            printLoop(what, paced);
+            if (!allAnswered(paced)) allGood = false;
+        }
+        check(allGood,                                                   "paced, and drained every 2 to 5 ms, every request gets its packet");
+
+        Mega  late = flightLoop(true, 4000, 1000);
+        printLoop("paced, every 4 ms but up to 1 ms late:", late);
+        ALTAIR_UM7RequestStats* stats = late.requests.stats();
+        printf("    %lu requests, %lu replies, %lu timeouts; reply within %lu ms\n",
+               stats->requestsSent, stats->repliesReceived, stats->replyTimeouts, stats->maxReplyMillis);
+        check(allAnswered(late) && late.ring.maxCount < RX_RING_SIZE - 1, "... as when the task runs up to 1 ms late, with room to spare in the ring");
+        check(stats->maxReplyMillis < UM7_REPLY_TIMEOUT,                 "... and every reply arrives well within UM7_REPLY_TIMEOUT");
+    }
+
+// The pacing itself.
+    printf("The pacing\n");
+    {
+        ALTAIR_UM7Requests requests;
+        requests.want(DATA_ADDRESS);
+        requests.want(HEALTH_ADDRESS);
+        requests.want(DATA_ADDRESS);
+        check(requests.wanted() == 2 && requests.due(0) == DATA_ADDRESS,  "a batch wanted twice is requested once, in the order wanted");
+        requests.sent(0);
+        requests.want(DATA_ADDRESS);
+        check(requests.due(5) == UM7_NO_REQUEST && requests.wanted() == 1, "nothing more is requested while a reply is on its way");
+        requests.arrived(GPS_ADDRESS, 6);
+        check(requests.due(6) == UM7_NO_REQUEST,                        "... not even when an unasked-for packet arrives");
+        requests.arrived(DATA_ADDRESS, 7);
+        check(requests.due(7) == HEALTH_ADDRESS,                        "the next is requested once the reply is in");
+        requests.sent(7);
+        check(requests.due(7 + UM7_REPLY_TIMEOUT - 1) == UM7_NO_REQUEST &&
+              requests.due(7 + UM7_REPLY_TIMEOUT) == UM7_NO_REQUEST && requests.stats()->replyTimeouts == 1,
+                                                                         "a reply that never arrives times out (and is counted)");
+    }
+
+// The driver itself, over the HAL's simulated UART.
+    printf("ALTAIR_UM7 itself, over the HAL's simulated UART\n");
+    {
+        ALTAIR_HALSim::reset();
+        ALTAIR_HALSimUart* uart = ALTAIR_HALSim::uart(DRIVER_SERIAL_ID);
+        ALTAIR_UM7         driver(DRIVER_SERIAL_ID);
+        SimUM7             um7;
+        unsigned long      requests = 0, badRequests = 0, overlaps = 0, maxWaiting = 0;
+
+        // The UM7's side of the line, up to now: take each request written, and send back what is due.
+        auto line = [&]( ) {
+            unsigned long long now = ALTAIR_HALSim::micros();
+            byte               tx[HAL_SIM_UART_BUFFER_SIZE];
+            size_t             n  = uart->collect(tx, sizeof(tx));
+            for (size_t i = 0; i + 7 <= n; ) {
+                if (tx[i] != 's' || tx[i + 1] != 'n' || tx[i + 2] != 'p') { ++i; continue; }
+                byte     pt = tx[i + 3], address = tx[i + 4];
+                size_t   length   = 7 + ((pt & 0x80) ? 4 : 0);                   // (a write carries one register word)
+                unsigned checksum = 0;
+                if (i + length > n) break;
+                for (size_t j = i; j < i + length - 2; ++j) checksum += tx[j];
+                if (((unsigned) tx[i + length - 2] << 8 | tx[i + length - 1]) != checksum) ++badRequests;
+                else if (!(pt & 0x80)) {
+                    ++requests;
+                    if (pt != 0x00 && pt != batchPT(address)) ++badRequests;
+                    if (!um7.line.empty()) ++overlaps;                          // (another reply is still on its way)
+                    um7.request(address, now);
+                }
+                i += length;
+            }
+            while (!um7.line.empty() && um7.nextByteMicros <= now) {
+                byte b = um7.line.front();
+                uart->inject(&b, 1);
+                um7.line.pop_front();
+                um7.nextByteMicros += BYTE_MICROS;
+            }
+            maxWaiting = std::max(maxWaiting, (unsigned long) uart->available());
+        };
+
+        // initialize(): the UM7 is already broadcasting (its health), which is what it waits for.
+        um7.request(HEALTH_ADDRESS, 0);
+        ALTAIR_HALSim::advanceMicros(10000);
+        line();
+        driver.initialize();
+        byte   init[32];
+        size_t n = uart->collect(init, sizeof(init));
+        check(uart->baudRate() == UM7_BAUD_RATE && n == 18 && init[3] == 0x80 && init[4] == 0x00 && init[11 + 4] == UM7_HEALTH_ADDRESS,
+                                                                         "initialize() starts the UART, sets the GPS baud rate, and asks for health");
+
+        // A minute of the flight loop.
+        ALTAIR_HALSim::reset();
+        um7              = SimUM7();
+        requests         = badRequests = overlaps = maxWaiting = 0;
+        unsigned long gpsNew = 0, dataIntact = 0, healthIntact = 0, updates = 0;
+        for (unsigned long ms = 1; ms <= DRIVER_RUN_MILLIS; ++ms) {
+            ALTAIR_HALSim::advanceMicros(1000);
+            line();
+            if (ms % 4 == 0)   driver.serviceSerial();                          // (the "UM7 serial" task)
+            if (ms % 200 == 0) {                                                // (update(), as fuseOrientSensors() calls it)
+                ++updates;
+                if (intact(driver.getDataPacket()))   ++dataIntact;
+                if (intact(driver.getHealthPacket())) ++healthIntact;
+            }
+            if (ms % 400 == 100) {                                              // (the "GPS and heading" task)
+                double lat, lon, ele, time;
+                if (ALTAIR_UM7::getGPS(&lat, &lon, &ele, &time)) ++gpsNew;
+            }
+        }
+        ALTAIR_UM7RequestStats* stats = driver.requests()->stats();
+        printf("    %lu requests written (%lu replies, %lu timeouts), %lu bad, %lu while a reply was on its way; %lu updates (%lu / %lu intact), %lu new GPS fixes; at most %lu bytes waiting\n",
+               requests, stats->repliesReceived, stats->replyTimeouts, badRequests, overlaps, updates, dataIntact, healthIntact, gpsNew, maxWaiting);
+        check(badRequests == 0 && requests + 1 >= stats->requestsSent && stats->replyTimeouts == 0 && stats->repliesReceived + 1 >= requests,
+                                                                         "every request the driver writes is well formed, and answered");
+        check(overlaps == 0,                                             "... and none is written while another reply is on its way");
+        check(dataIntact + 1 >= updates && healthIntact + 1 >= updates && gpsNew + 1 >= DRIVER_RUN_MILLIS / 400,
+                                                                         "... each update() gets its packets, intact, as does getGPS()");
+        check(maxWaiting < RX_RING_SIZE - 1,                             "... and no more bytes wait in the UART than the Mega's ring holds");
+        check(ALTAIR_HAL::clockMillis() - driver.dataPacketMillis() < 200 && ALTAIR_HALSim::stats()->uartBytesRead > 0,
+                                                                         "... on the HAL's clock");
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}